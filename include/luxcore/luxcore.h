@@ -339,6 +339,18 @@ public:
 	static Film *Create(const luxrays::Properties &props,
 			const bool hasPixelNormalizedChannel,
 			const bool hasScreenNormalizedChannel);
+	/*!
+	 * \brief Merges a list of serialized films in a new stand alone Film. The
+	 * films are streamed from disk one channel block at time so the memory
+	 * usage doesn't grow with the number of merged films.
+	 *
+	 * \param fileNames is the list of the files with the serialized films. The
+	 * first one is used as base of the merge.
+	 * \param weights is the list of the weights used to scale each film. It can
+	 * be empty or must have the same size of fileNames.
+	 */
+	static Film *Merge(const std::vector<std::string> &fileNames,
+			const std::vector<float> &weights = std::vector<float>());
 
 	/*!
 	 * \brief Returns the Film width.
@@ -380,7 +392,7 @@ public:
 	 */
 	virtual void AddFilm(const Film &film) = 0;
 	/*!
-	 * \brief Add a film.
+	 * \brief Add a region of a film. The region is clipped to both films.
 	 *
 	 * \param film the film to add.
 	 * \param srcOffsetX the X offset of the region of the film to add.
@@ -395,6 +407,35 @@ public:
 		const unsigned int srcOffsetX, const unsigned int srcOffsetY,
 		const unsigned int srcWidth, const unsigned int srcHeight,
 		const unsigned int dstOffsetX, const unsigned int dstOffsetY) = 0;
+	/*!
+	 * \brief Add a serialized film streaming it from the disk.
+	 *
+	 * \param fileName is the name of the file with the serialized film to add.
+	 * \param weight is used to scale the values and the samples count of the
+	 * added film.
+	 *
+	 */
+	virtual void AddFilm(const std::string &fileName, const float weight = 1.f) = 0;
+	/*!
+	 * \brief Add a region of a serialized film streaming it from the disk.
+	 * The region is clipped to both films, like for the films in memory.
+	 *
+	 * \param fileName is the name of the file with the serialized film to add.
+	 * \param srcOffsetX the X offset of the region of the film to add.
+	 * \param srcOffsetY the y offset of the region of the film to add.
+	 * \param srcWidth the width of the region of the film to add.
+	 * \param srcHeight the height of the region of the film to add.
+	 * \param dstOffsetX the X offset of the destination film.
+	 * \param dstOffsetY the Y offset of the destination film.
+	 * \param weight is used to scale the values and the samples count of the
+	 * added film.
+	 *
+	 */
+	virtual void AddFilm(const std::string &fileName,
+		const unsigned int srcOffsetX, const unsigned int srcOffsetY,
+		const unsigned int srcWidth, const unsigned int srcHeight,
+		const unsigned int dstOffsetX, const unsigned int dstOffsetY,
+		const float weight = 1.f) = 0;
 	/*!
 	 * \brief Saves all Film output channels defined in the current
 	 * RenderSession. This method can not be used with a standalone film.
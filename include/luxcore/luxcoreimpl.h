@@ -58,6 +58,12 @@ public:
 		const unsigned int srcOffsetX, const unsigned int srcOffsetY,
 		const unsigned int srcWidth, const unsigned int srcHeight,
 		const unsigned int dstOffsetX, const unsigned int dstOffsetY);
+	void AddFilm(const std::string &fileName, const float weight = 1.f);
+	void AddFilm(const std::string &fileName,
+		const unsigned int srcOffsetX, const unsigned int srcOffsetY,
+		const unsigned int srcWidth, const unsigned int srcHeight,
+		const unsigned int dstOffsetX, const unsigned int dstOffsetY,
+		const float weight = 1.f);
 
 	void SaveOutputs() const;
 	void SaveOutput(const std::string &fileName, const FilmOutputType type, const luxrays::Properties &props) const;
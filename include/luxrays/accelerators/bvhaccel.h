@@ -66,6 +66,8 @@ private:
 	std::deque<const Mesh *> meshes;
 	u_longlong totalVertexCount, totalTriangleCount;
 
+	// False when built concurrently with other BVHs (i.e. MBVH leafs)
+	bool verbose;
 	bool initialized;
 };
 
@@ -53,9 +53,11 @@ public:
 	virtual void Update();
 
 	virtual bool Intersect(const Ray *ray, RayHit *hit) const;
+	virtual bool Occluded(const Ray *ray, OcclusionFilter *filter = nullptr) const;
 
 private:
 	static bool MeshPtrCompare(const Mesh *p0, const Mesh *p1);
+	static void OcclusionFilterFunc(const RTCFilterFunctionNArguments *args);
 	
 	void ExportTriangleMesh(const RTCScene embreeScene, const Mesh *mesh) const;
 	void ExportMotionTriangleMesh(const RTCScene embreeScene, const MotionTriangleMesh *mtm) const;
@@ -36,6 +36,18 @@ class IntersectionDevice;
 class HardwareIntersectionDevice;
 class HardwareIntersectionKernel;
 
+// Used by Accelerator::Occluded() to check each hit found along a ray. The
+// hits are reported in any order and the same hit can be reported more than
+// once.
+class OcclusionFilter {
+public:
+	OcclusionFilter() { }
+	virtual ~OcclusionFilter() { }
+
+	// Returns false if the hit has to be ignored
+	virtual bool IsOccluder(const Ray &ray, const RayHit &hit) = 0;
+};
+
 class Accelerator {
 public:
 	Accelerator() { }
@@ -53,6 +65,9 @@ public:
 	virtual void Update() { throw new std::runtime_error("Internal error in Accelerator::Update()"); }
 
 	virtual bool Intersect(const Ray *ray, RayHit *hit) const = 0;
+	// Returns true if there is any occluder along the ray. It stops at the
+	// first occluder found so it is faster than Intersect().
+	virtual bool Occluded(const Ray *ray, OcclusionFilter *filter = nullptr) const;
 
 	static std::string AcceleratorType2String(const AcceleratorType type);
 	static AcceleratorType String2AcceleratorType(const std::string &type);
@@ -37,6 +37,9 @@ namespace ocl {
 #include "luxrays/core/bvh/bvhbuild_types.cl"
 }
 
+// Ranges larger than this are binned with all threads by the CLASSIC builder
+#define BVH_PARALLEL_RANGE_SIZE 32768u
+
 #define BVHNodeData_IsLeaf(nodeData) ((nodeData) & 0x80000000u)
 #define BVHNodeData_GetSkipIndex(nodeData) ((nodeData) & 0x7fffffffu)
 
@@ -64,9 +67,7 @@ struct BVHTreeNode {
 	BVHTreeNode *rightSibling;
 };
 
-// Old classic BVH build
-extern BVHTreeNode *BuildBVH(u_int *nNodes, const BVHParams &params,
-	std::vector<BVHTreeNode *> &leafList);
+// Classic BVH build (parallel binned SAH)
 extern u_int BuildBVHArray(const std::deque<const Mesh *> *meshes, BVHTreeNode *node,
 		u_int offset, luxrays::ocl::BVHArrayNode *bvhArrayTree);
 extern luxrays::ocl::BVHArrayNode *BuildBVH(const BVHParams &params,
@@ -80,6 +81,10 @@ extern luxrays::ocl::BVHArrayNode *BuildEmbreeBVHBinnedSAH(const BVHParams &para
 extern luxrays::ocl::BVHArrayNode *BuildEmbreeBVHMorton(const BVHParams &params,
 		u_int *nNodes, const std::deque<const Mesh *> *meshes,
 		std::vector<BVHTreeNode *> &leafList);
+// All the Embree builds share the same device while a reference to it is
+// held, so the builds running at the same time use the same Embree threads
+extern void AcquireEmbreeBuilderDevice();
+extern void ReleaseEmbreeBuilderDevice();
 
 // Common functions
 extern void FreeBVH(BVHTreeNode *node);
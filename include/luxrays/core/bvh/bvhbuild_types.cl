@@ -60,3 +60,19 @@ typedef struct {
 
 #define IndexBVHNodeData_IsLeaf(nodeData) ((nodeData) & 0x80000000u)
 #define IndexBVHNodeData_GetSkipIndex(nodeData) ((nodeData) & 0x7fffffffu)
+
+// slg::IndexBvh leaf bucket: a leaf node holds the bounding box of up to
+// INDEXBVH_LEAF_BUCKET_SIZE entries and it is followed by
+// INDEXBVH_LEAF_BUCKET_NODES array nodes storing the entry positions and
+// indices in SoA order. Unused slots have a NULL_INDEX entry index and a far
+// away (but finite, OpenCL kernels may use fast relaxed math) position.
+#define INDEXBVH_LEAF_BUCKET_SIZE 4
+#define INDEXBVH_LEAF_BUCKET_NODES 2
+#define INDEXBVH_LEAF_BUCKET_EMPTY_POSITION 1e15f
+
+typedef struct {
+	float x[INDEXBVH_LEAF_BUCKET_SIZE];
+	float y[INDEXBVH_LEAF_BUCKET_SIZE];
+	float z[INDEXBVH_LEAF_BUCKET_SIZE];
+	unsigned int entryIndex[INDEXBVH_LEAF_BUCKET_SIZE];
+} IndexBVHLeafBucket;
@@ -19,6 +19,7 @@
 #ifndef _LUXRAYS_SPECTRUMGROUP_H
 #define _LUXRAYS_SPECTRUMGROUP_H
 
+#include <algorithm>
 #include <vector>
 
 #include "luxrays/core/color/color.h"
@@ -27,87 +28,119 @@ namespace luxrays {
 
 // Mostly used for Spectrum(s) related to light groups
 
+// Groups up to this size are stored inline, without any heap allocation, so
+// they can be created, copied and returned by value in the rendering hot loop
+#define SPECTRUMGROUP_INLINE_SIZE 8
+
 class SpectrumGroup {
 public:
-	SpectrumGroup(const u_int groupsCount = 0) : group(groupsCount) {
+	SpectrumGroup(const u_int groupsCount = 0) : size(0) {
+		Resize(groupsCount);
 	}
-	virtual ~SpectrumGroup() { }
-
-	u_int Size() const { return group.size(); }
-	void Resize(const u_int s) { group.resize(s); }
-	void Shrink(const u_int s) { group.shrink_to_fit(); }
+	~SpectrumGroup() { }
+
+	u_int Size() const { return size; }
+	void Resize(const u_int s) {
+		if (s <= SPECTRUMGROUP_INLINE_SIZE) {
+			if (size > SPECTRUMGROUP_INLINE_SIZE) {
+				// Move back to the inline storage
+				std::copy(heapGroup.begin(), heapGroup.begin() + s, inlineGroup);
+				heapGroup.clear();
+			} else {
+				for (u_int i = size; i < s; ++i)
+					inlineGroup[i] = Spectrum();
+			}
+		} else {
+			if (size <= SPECTRUMGROUP_INLINE_SIZE)
+				heapGroup.assign(inlineGroup, inlineGroup + size);
+			heapGroup.resize(s);
+		}
+
+		size = s;
+	}
+	void Shrink(const u_int s) { heapGroup.shrink_to_fit(); }
 
 	void Clear() {
-		for (auto &s : group)
-			s = Spectrum();
+		Spectrum *group = Data();
+		for (u_int i = 0; i < size; ++i)
+			group[i] = Spectrum();
 	}
 
 	Spectrum Sum() const {
+		const Spectrum *group = Data();
 		Spectrum sum;
 
-		for (auto const &s : group)
-			sum += s;
+		for (u_int i = 0; i < size; ++i)
+			sum += group[i];
 		
 		return sum;
 	}
 	
 	SpectrumGroup &Add(const u_int i, const Spectrum &s) {
 		// Auto expand the group if required
-		if (i >= group.size())
-			group.resize(i + 1);
+		if (i >= size)
+			Resize(i + 1);
 
-		group[i] += s;
+		Data()[i] += s;
 
 		return *this;
 	}
 
 	SpectrumGroup &AddWeighted(const float a, const SpectrumGroup &s2) {
 		// Auto expand the group if required
-		if (s2.group.size() > group.size())
-			group.resize(s2.group.size());
+		if (s2.size > size)
+			Resize(s2.size);
 		
-		for (u_int i = 0; i < s2.group.size(); ++i)
-			group[i] += a * s2.group[i];
+		Spectrum *group = Data();
+		const Spectrum *group2 = s2.Data();
+		for (u_int i = 0; i < s2.size; ++i)
+			group[i] += a * group2[i];
 
 		return *this;
 	}
 
 	SpectrumGroup &AddWeighted(const Spectrum &a, const SpectrumGroup &s2) {
 		// Auto expand the group if required
-		if (s2.group.size() > group.size())
-			group.resize(s2.group.size());
+		if (s2.size > size)
+			Resize(s2.size);
 		
-		for (u_int i = 0; i < s2.group.size(); ++i)
-			group[i] += a * s2.group[i];
+		Spectrum *group = Data();
+		const Spectrum *group2 = s2.Data();
+		for (u_int i = 0; i < s2.size; ++i)
+			group[i] += a * group2[i];
 
 		return *this;
 	}
 
 	bool Black() const {
-		for (auto const &s : group)
-			if (!s.Black())
+		const Spectrum *group = Data();
+		for (u_int i = 0; i < size; ++i)
+			if (!group[i].Black())
 				return false;
 		
 		return true;
 	}
 
 	bool IsNaN() const {
-		for (auto const &s : group)
-			if (s.IsNaN())
+		const Spectrum *group = Data();
+		for (u_int i = 0; i < size; ++i)
+			if (group[i].IsNaN())
 				return true;
 		
 		return false;
 	}
 	bool IsInf() const {
-		for (auto const &s : group)
-			if (s.IsInf())
+		const Spectrum *group = Data();
+		for (u_int i = 0; i < size; ++i)
+			if (group[i].IsInf())
 				return true;
 		
 		return false;
 	}
 	bool IsNeg() const {
-		for (auto const &s : group)
-			if (s.IsNeg())
+		const Spectrum *group = Data();
+		for (u_int i = 0; i < size; ++i)
+			if (group[i].IsNeg())
 				return true;
 		
 		return false;
@@ -116,8 +149,8 @@ public:
 		return !IsNaN() && !IsInf() && !IsNeg();
 	}
 
-	const Spectrum &operator[](int i) const { return group[i]; }
-	Spectrum &operator[](int i) { return group[i]; }
+	const Spectrum &operator[](int i) const { return Data()[i]; }
+	Spectrum &operator[](int i) { return Data()[i]; }
 
 	//--------------------------------------------------------------------------
 	// With SpectrumGroup operators
@@ -125,44 +158,52 @@ public:
 
 	SpectrumGroup &operator+=(const SpectrumGroup &s2) {
 		// Auto expand the group if required
-		if (s2.group.size() > group.size())
-			group.resize(s2.group.size());
+		if (s2.size > size)
+			Resize(s2.size);
 
-		for (u_int i = 0; i < s2.group.size(); ++i)
-			group[i] += s2.group[i];
+		Spectrum *group = Data();
+		const Spectrum *group2 = s2.Data();
+		for (u_int i = 0; i < s2.size; ++i)
+			group[i] += group2[i];
 
 		return *this;
 	}
 	
 	SpectrumGroup &operator-=(const SpectrumGroup &s2) {
 		// Auto expand the group if required
-		if (s2.group.size() > group.size())
-			group.resize(s2.group.size());
+		if (s2.size > size)
+			Resize(s2.size);
 
-		for (u_int i = 0; i < s2.group.size(); ++i)
-			group[i] -= s2.group[i];
+		Spectrum *group = Data();
+		const Spectrum *group2 = s2.Data();
+		for (u_int i = 0; i < s2.size; ++i)
+			group[i] -= group2[i];
 
 		return *this;
 	}
 
 	SpectrumGroup &operator*=(const SpectrumGroup &s2) {
 		// Auto expand the group if required
-		if (s2.group.size() > group.size())
-			group.resize(s2.group.size());
+		if (s2.size > size)
+			Resize(s2.size);
 
-		for (u_int i = 0; i < s2.group.size(); ++i)
-			group[i] *= s2.group[i];
+		Spectrum *group = Data();
+		const Spectrum *group2 = s2.Data();
+		for (u_int i = 0; i < s2.size; ++i)
+			group[i] *= group2[i];
 
 		return *this;
 	}
 	
 	SpectrumGroup &operator/=(const SpectrumGroup &s2) {
 		// Auto expand the group if required
-		if (s2.group.size() > group.size())
-			group.resize(s2.group.size());
+		if (s2.size > size)
+			Resize(s2.size);
 
-		for (u_int i = 0; i < s2.group.size(); ++i)
-			group[i] /= s2.group[i];
+		Spectrum *group = Data();
+		const Spectrum *group2 = s2.Data();
+		for (u_int i = 0; i < s2.size; ++i)
+			group[i] /= group2[i];
 
 		return *this;
 	}
@@ -172,28 +213,32 @@ public:
 	//--------------------------------------------------------------------------
 
 	SpectrumGroup &operator+=(const Spectrum &s) {
-		for (u_int i = 0; i < group.size(); ++i)
+		Spectrum *group = Data();
+		for (u_int i = 0; i < size; ++i)
 			group[i] += s;
 
 		return *this;
 	}
 
 	SpectrumGroup &operator-=(const Spectrum &s) {
-		for (u_int i = 0; i < group.size(); ++i)
+		Spectrum *group = Data();
+		for (u_int i = 0; i < size; ++i)
 			group[i] -= s;
 
 		return *this;
 	}
 
 	SpectrumGroup &operator*=(const Spectrum &s) {
-		for (u_int i = 0; i < group.size(); ++i)
+		Spectrum *group = Data();
+		for (u_int i = 0; i < size; ++i)
 			group[i] *= s;
 
 		return *this;
 	}
 
 	SpectrumGroup &operator/=(const Spectrum &s) {
-		for (u_int i = 0; i < group.size(); ++i)
+		Spectrum *group = Data();
+		for (u_int i = 0; i < size; ++i)
 			group[i] /= s;
 
 		return *this;
@@ -204,7 +249,8 @@ public:
 	//--------------------------------------------------------------------------
 
 	SpectrumGroup &operator+=(const float a) {
-		for (u_int i = 0; i < group.size(); ++i)
+		Spectrum *group = Data();
+		for (u_int i = 0; i < size; ++i)
 			group[i] += a;
 
 		return *this;
@@ -212,14 +258,16 @@ public:
 
 	SpectrumGroup &operator-=(const float a) {
 		const float factor = 1.f/ a;
-		for (u_int i = 0; i < group.size(); ++i)
+		Spectrum *group = Data();
+		for (u_int i = 0; i < size; ++i)
 			group[i] -= factor;
 
 		return *this;
 	}
 
 	SpectrumGroup &operator*=(const float a) {
-		for (u_int i = 0; i < group.size(); ++i)
+		Spectrum *group = Data();
+		for (u_int i = 0; i < size; ++i)
 			group[i] *= a;
 
 		return *this;
@@ -227,7 +275,8 @@ public:
 
 	SpectrumGroup &operator/=(const float a) {
 		const float factor = 1.f/ a;
-		for (u_int i = 0; i < group.size(); ++i)
+		Spectrum *group = Data();
+		for (u_int i = 0; i < size; ++i)
 			group[i] *= factor;
 
 		return *this;
@@ -236,11 +285,32 @@ public:
 	friend class boost::serialization::access;
 	
 private:
-	std::vector<Spectrum> group;
+	const Spectrum *Data() const {
+		return (size <= SPECTRUMGROUP_INLINE_SIZE) ? inlineGroup : &heapGroup[0];
+	}
+	Spectrum *Data() {
+		return (size <= SPECTRUMGROUP_INLINE_SIZE) ? inlineGroup : &heapGroup[0];
+	}
 
-	template<class Archive> void serialize(Archive & ar, const unsigned int version) {
+	template<class Archive> void save(Archive &ar, const unsigned int version) const {
+		// The same format of the old std::vector based storage
+		const std::vector<Spectrum> group(Data(), Data() + size);
 		ar & group;
 	}
+
+	template<class Archive>	void load(Archive &ar, const unsigned int version) {
+		std::vector<Spectrum> group;
+		ar & group;
+
+		Resize(group.size());
+		std::copy(group.begin(), group.end(), Data());
+	}
+	BOOST_SERIALIZATION_SPLIT_MEMBER()
+
+	u_int size;
+	Spectrum inlineGroup[SPECTRUMGROUP_INLINE_SIZE];
+	// Used only when the size is larger than SPECTRUMGROUP_INLINE_SIZE
+	std::vector<Spectrum> heapGroup;
 };
 
 }
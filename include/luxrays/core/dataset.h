@@ -56,6 +56,8 @@ public:
 	const Accelerator *GetAccelerator(const AcceleratorType accelType);
 	bool DoesAllAcceleratorsSupportUpdate() const;
 	void UpdateAccelerators();
+	// The total time spent building the accelerators
+	double GetAcceleratorsBuildTime() const { return accelsBuildTime; }
 
 	const BBox &GetBBox() const { return bbox; }
 	const BSphere &GetBSphere() const { return bsphere; }
@@ -83,6 +85,7 @@ private:
 
 	boost::mutex accelsMutex;
 	boost::unordered_map<AcceleratorType, Accelerator *> accels;
+	double accelsBuildTime;
 
 	AcceleratorType accelType;
 	bool preprocessed;
@@ -37,6 +37,7 @@
 #include "luxrays/core/namedobject.h"
 #include "luxrays/utils/properties.h"
 #include "luxrays/utils/serializationutils.h"
+#include "luxrays/utils/packing.h"
 
 namespace luxrays {
 
@@ -164,6 +165,8 @@ public:
 	}
 	float *GetTriAOVs(const u_int dataIndex) const { return triAOV[dataIndex]; }
 
+	// Note: GetNormals(), GetUVs() and GetColors() return nullptr if the mesh
+	// has been compressed, use the per vertex accessors in that case
 	Normal *GetNormals() const { return normals; }
 	Normal *GetTriNormals() const { return triNormals; }
 
@@ -200,11 +203,22 @@ public:
 
 	Normal *ComputeNormals();
 
+	// Replace vertex normals with octahedral encoded ones and vertex UVs/colors
+	// with half precision ones. Decoding is done on the fly by the accessors.
+	void Compress();
+	void Decompress();
+	bool IsCompressed() const { return compressed; }
+
+	// Memory used by vertex and triangle attributes
+	size_t GetMemoryUsage() const;
+	// Memory that would be used by the same attributes without compression
+	size_t GetUncompressedMemoryUsage() const;
+
 	virtual MeshType GetType() const { return TYPE_EXT_TRIANGLE; }
 
-	virtual bool HasNormals() const { return normals != nullptr; }
-	virtual bool HasUVs(const u_int dataIndex) const { return uvs[dataIndex] != nullptr; }
-	virtual bool HasColors(const u_int dataIndex) const { return cols[dataIndex] != nullptr; }
+	virtual bool HasNormals() const { return (normals != nullptr) || (packedNormals != nullptr); }
+	virtual bool HasUVs(const u_int dataIndex) const { return (uvs[dataIndex] != nullptr) || (packedUVs[dataIndex] != nullptr); }
+	virtual bool HasColors(const u_int dataIndex) const { return (cols[dataIndex] != nullptr) || (packedCols[dataIndex] != nullptr); }
 	virtual bool HasAlphas(const u_int dataIndex) const { return alphas[dataIndex] != nullptr; }
 
 	virtual bool HasVertexAOV(const u_int dataIndex) const { return vertAOV[dataIndex] != nullptr; }
@@ -215,14 +229,14 @@ public:
 		return triNormals[triIndex];
 	}
 	virtual Normal GetShadeNormal(const luxrays::Transform &local2World, const u_int triIndex, const u_int vertIndex) const {
-		return (appliedTransSwapsHandedness ? -1.f : 1.f) * normals[tris[triIndex].v[vertIndex]];
+		return (appliedTransSwapsHandedness ? -1.f : 1.f) * GetVertexNormal(tris[triIndex].v[vertIndex]);
 	}
 	virtual Normal GetShadeNormal(const luxrays::Transform &local2World, const u_int vertIndex) const {
-		return (appliedTransSwapsHandedness ? -1.f : 1.f) * normals[vertIndex];
+		return (appliedTransSwapsHandedness ? -1.f : 1.f) * GetVertexNormal(vertIndex);
 	}
 
-	virtual UV GetUV(const u_int vertIndex, const u_int dataIndex) const { return uvs[dataIndex][vertIndex]; }
-	virtual Spectrum GetColor(const u_int vertIndex, const u_int dataIndex) const { return cols[dataIndex][vertIndex]; }
+	virtual UV GetUV(const u_int vertIndex, const u_int dataIndex) const { return GetVertexUV(vertIndex, dataIndex); }
+	virtual Spectrum GetColor(const u_int vertIndex, const u_int dataIndex) const { return GetVertexColor(vertIndex, dataIndex); }
 	virtual float GetAlpha(const u_int vertIndex, const u_int dataIndex) const { return alphas[dataIndex][vertIndex]; }
 	
 	virtual float GetVertexAOV(const u_int vertIndex, const u_int dataIndex) const {
@@ -251,11 +265,12 @@ public:
 
 	virtual Normal InterpolateTriNormal(const luxrays::Transform &local2World, const u_int triIndex,
 			const float b1, const float b2) const {
-		if (!normals)
+		if (!HasNormals())
 			return GetGeometryNormal(local2World, triIndex);
 		const Triangle &tri = tris[triIndex];
 		const float b0 = 1.f - b1 - b2;
-		return (appliedTransSwapsHandedness ? -1.f : 1.f) * Normalize(b0 * normals[tri.v[0]] + b1 * normals[tri.v[1]] + b2 * normals[tri.v[2]]);
+		return (appliedTransSwapsHandedness ? -1.f : 1.f) * Normalize(b0 * GetVertexNormal(tri.v[0]) +
+				b1 * GetVertexNormal(tri.v[1]) + b2 * GetVertexNormal(tri.v[2]));
 	}
 
 	virtual UV InterpolateTriUV(const u_int triIndex, const float b1, const float b2,
@@ -263,7 +278,8 @@ public:
 		if (HasUVs(dataIndex)) {
 			const Triangle &tri = tris[triIndex];
 			const float b0 = 1.f - b1 - b2;
-			return b0 * uvs[dataIndex][tri.v[0]] + b1 * uvs[dataIndex][tri.v[1]] + b2 * uvs[dataIndex][tri.v[2]];
+			return b0 * GetVertexUV(tri.v[0], dataIndex) + b1 * GetVertexUV(tri.v[1], dataIndex) +
+					b2 * GetVertexUV(tri.v[2], dataIndex);
 		} else
 			return UV(0.f, 0.f);
 	}
@@ -273,7 +289,8 @@ public:
 		if (HasColors(dataIndex)) {
 			const Triangle &tri = tris[triIndex];
 			const float b0 = 1.f - b1 - b2;
-			return b0 * cols[dataIndex][tri.v[0]] + b1 * cols[dataIndex][tri.v[1]] + b2 * cols[dataIndex][tri.v[2]];
+			return b0 * GetVertexColor(tri.v[0], dataIndex) + b1 * GetVertexColor(tri.v[1], dataIndex) +
+					b2 * GetVertexColor(tri.v[2], dataIndex);
 		} else
 			return Spectrum(1.f);
 	}
@@ -375,6 +392,16 @@ public:
 
 	void Preprocess();
 	void PreprocessBevel();
+
+	Normal GetVertexNormal(const u_int vertIndex) const {
+		return normals ? normals[vertIndex] : UnpackOctahedralNormal(packedNormals[vertIndex]);
+	}
+	UV GetVertexUV(const u_int vertIndex, const u_int dataIndex) const {
+		return uvs[dataIndex] ? uvs[dataIndex][vertIndex] : UnpackUV(packedUVs[dataIndex][vertIndex]);
+	}
+	Spectrum GetVertexColor(const u_int vertIndex, const u_int dataIndex) const {
+		return cols[dataIndex] ? cols[dataIndex][vertIndex] : UnpackSpectrum(&packedCols[dataIndex][vertIndex * 3]);
+	}
 	
 	virtual void SavePly(const std::string &fileName) const;
 	virtual void SaveSerialized(const std::string &fileName) const;
@@ -383,22 +410,41 @@ public:
 		ar & BOOST_SERIALIZATION_BASE_OBJECT_NVP(TriangleMesh);
 		ar & BOOST_SERIALIZATION_BASE_OBJECT_NVP(ExtMesh);
 
+		// Compressed attributes are always saved decoded
 		const bool hasNormals = HasNormals();
 		ar & hasNormals;
 		if (HasNormals())
-			for (u_int i = 0; i < vertCount; ++i)
-				ar & normals[i];
+			for (u_int i = 0; i < vertCount; ++i) {
+				const Normal n = GetVertexNormal(i);
+				ar & n;
+			}
 
 		for (u_int i = 0; i < EXTMESH_MAX_DATA_COUNT; i++) {
 			const bool hasUVs = HasUVs(i);
 			ar & hasUVs;
-			if (hasUVs)
-				ar & boost::serialization::make_array<UV>(uvs[i], vertCount);
+			if (hasUVs) {
+				if (uvs[i])
+					ar & boost::serialization::make_array<UV>(uvs[i], vertCount);
+				else {
+					std::vector<UV> decodedUVs(vertCount);
+					for (u_int j = 0; j < vertCount; ++j)
+						decodedUVs[j] = GetVertexUV(j, i);
+					ar & boost::serialization::make_array<UV>(&decodedUVs[0], vertCount);
+				}
+			}
 
 			const bool hasColors = HasColors(i);
 			ar & hasColors;
-			if (hasColors)
-				ar & boost::serialization::make_array<Spectrum>(cols[i], vertCount);
+			if (hasColors) {
+				if (cols[i])
+					ar & boost::serialization::make_array<Spectrum>(cols[i], vertCount);
+				else {
+					std::vector<Spectrum> decodedCols(vertCount);
+					for (u_int j = 0; j < vertCount; ++j)
+						decodedCols[j] = GetVertexColor(j, i);
+					ar & boost::serialization::make_array<Spectrum>(&decodedCols[0], vertCount);
+				}
+			}
 
 			const bool hasAlphas = HasAlphas(i);
 			ar & hasAlphas;
@@ -415,6 +461,8 @@ public:
 			if (hasTriangleAOV)
 				ar & boost::serialization::make_array<float>(triAOV[i], triCount);
 		}
+
+		ar & compressed;
 	}
 
 	template<class Archive>	void load(Archive &ar, const unsigned int version) {
@@ -431,6 +479,11 @@ public:
 			normals = nullptr;
 		triNormals = new Normal[triCount];
 
+		packedNormals = nullptr;
+		std::fill(packedUVs.begin(), packedUVs.end(), nullptr);
+		std::fill(packedCols.begin(), packedCols.end(), nullptr);
+		compressed = false;
+
 		for (u_int i = 0; i < EXTMESH_MAX_DATA_COUNT; i++) {
 			bool hasUVs;
 			ar & hasUVs;
@@ -478,6 +531,13 @@ public:
 		bevelBVHArrayNodes = nullptr;
 		
 		Preprocess();
+
+		if (version >= 5) {
+			bool isCompressed;
+			ar & isCompressed;
+			if (isCompressed)
+				Compress();
+		}
 	}
 	BOOST_SERIALIZATION_SPLIT_MEMBER()
 
@@ -486,6 +546,12 @@ public:
 
 	std::array<UV *, EXTMESH_MAX_DATA_COUNT> uvs; // Vertex uvs
 	std::array<Spectrum *, EXTMESH_MAX_DATA_COUNT> cols; // Vertex colors
+
+	// Compressed vertex attributes, used in place of normals, uvs and cols
+	u_int *packedNormals; // Octahedral encoded vertices normals
+	std::array<u_int *, EXTMESH_MAX_DATA_COUNT> packedUVs; // Half precision vertex uvs
+	std::array<u_short *, EXTMESH_MAX_DATA_COUNT> packedCols; // Half precision vertex colors (3 values for each vertex)
+	bool compressed;
 	std::array<float *, EXTMESH_MAX_DATA_COUNT> alphas; // Vertex alphas
 
 	std::array<float *, EXTMESH_MAX_DATA_COUNT> vertAOV; // Vertex AOV
@@ -730,7 +796,7 @@ private:
 
 BOOST_SERIALIZATION_ASSUME_ABSTRACT(luxrays::ExtMesh)
 
-BOOST_CLASS_VERSION(luxrays::ExtTriangleMesh, 4)
+BOOST_CLASS_VERSION(luxrays::ExtTriangleMesh, 5)
 BOOST_CLASS_VERSION(luxrays::ExtInstanceTriangleMesh, 4)
 BOOST_CLASS_VERSION(luxrays::ExtMotionTriangleMesh, 4)
 
@@ -67,6 +67,11 @@ public:
 		return accel->Intersect(ray, rayHit);
 	}
 
+	virtual bool TraceOcclusionRay(const Ray *ray, OcclusionFilter *filter = nullptr) {
+		statsTotalSerialRayCount += 1;
+		return accel->Occluded(ray, filter);
+	}
+
 	friend class Context;
 
 protected:
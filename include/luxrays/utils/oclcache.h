@@ -59,7 +59,11 @@ public:
 	}
 };
 
-// WARNING: this class is not thread safe !
+// Version of the cache file format, increment it every time the format changes
+#define LUXRAYS_OCL_KERNEL_CACHE_VERSION 2
+
+// The cache can be used by multiple threads at the same time: a kernel
+// requested by more than one thread is compiled only once.
 class oclKernelPersistentCache : public oclKernelCache {
 public:
 	oclKernelPersistentCache(const std::string &applicationName);
@@ -73,6 +77,9 @@ public:
 	static u_int HashBin(const char *s, const size_t size);
 
 	static boost::filesystem::path GetCacheDir(const std::string &applicationName);
+	// The directory includes the platform, the device and the driver version
+	static boost::filesystem::path GetDeviceCacheDir(const std::string &applicationName,
+		cl_device_id device);
 
 private:
 	std::string appName;
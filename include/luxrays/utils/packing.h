@@ -0,0 +1,177 @@
+/***************************************************************************
+ * Copyright 1998-2020 by authors (see AUTHORS.txt)                        *
+ *                                                                         *
+ *   This file is part of LuxCoreRender.                                   *
+ *                                                                         *
+ * Licensed under the Apache License, Version 2.0 (the "License");         *
+ * you may not use this file except in compliance with the License.        *
+ * You may obtain a copy of the License at                                 *
+ *                                                                         *
+ *     http://www.apache.org/licenses/LICENSE-2.0                          *
+ *                                                                         *
+ * Unless required by applicable law or agreed to in writing, software     *
+ * distributed under the License is distributed on an "AS IS" BASIS,       *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.*
+ * See the License for the specific language governing permissions and     *
+ * limitations under the License.                                          *
+ ***************************************************************************/
+
+#ifndef _LUXRAYS_PACKING_H
+#define	_LUXRAYS_PACKING_H
+
+#include <cstring>
+#include <cmath>
+
+#include "luxrays/utils/utils.h"
+#include "luxrays/core/geometry/vector.h"
+#include "luxrays/core/geometry/normal.h"
+#include "luxrays/core/geometry/uv.h"
+#include "luxrays/core/color/color.h"
+
+namespace luxrays {
+
+//------------------------------------------------------------------------------
+// Half precision floating point (IEEE 754 binary16)
+//------------------------------------------------------------------------------
+
+inline u_short FloatToHalf(const float f) {
+	u_int bits;
+	memcpy(&bits, &f, sizeof(float));
+
+	const u_int sign = (bits >> 16) & 0x8000u;
+	const u_int exponent = (bits >> 23) & 0xffu;
+	u_int mantissa = bits & 0x7fffffu;
+
+	// NaN and infinity
+	if (exponent == 0xffu)
+		return (u_short)(sign | 0x7c00u | (mantissa ? 0x200u : 0u));
+
+	const int halfExponent = (int)exponent - 127 + 15;
+	// Overflow: clamp to infinity
+	if (halfExponent >= 0x1f)
+		return (u_short)(sign | 0x7c00u);
+
+	if (halfExponent <= 0) {
+		// Underflow to zero
+		if (halfExponent < -10)
+			return (u_short)sign;
+
+		// Denormalized half
+		mantissa |= 0x800000u;
+		const u_int shift = (u_int)(14 - halfExponent);
+		u_int halfMantissa = mantissa >> shift;
+		// Round to nearest even
+		const u_int remainder = mantissa & ((1u << shift) - 1u);
+		const u_int halfway = 1u << (shift - 1u);
+		if ((remainder > halfway) || ((remainder == halfway) && (halfMantissa & 1u)))
+			++halfMantissa;
+
+		return (u_short)(sign | halfMantissa);
+	}
+
+	u_int h = sign | ((u_int)halfExponent << 10) | (mantissa >> 13);
+	// Round to nearest even, a carry into the exponent is the correct result
+	const u_int remainder = mantissa & 0x1fffu;
+	if ((remainder > 0x1000u) || ((remainder == 0x1000u) && (h & 1u)))
+		++h;
+
+	return (u_short)h;
+}
+
+inline float HalfToFloat(const u_short h) {
+	const u_int sign = ((u_int)h & 0x8000u) << 16;
+	const u_int exponent = ((u_int)h >> 10) & 0x1fu;
+	u_int mantissa = (u_int)h & 0x3ffu;
+
+	u_int bits;
+	if (exponent == 0x1fu) {
+		// NaN and infinity
+		bits = sign | 0x7f800000u | (mantissa << 13);
+	} else if (exponent == 0u) {
+		if (mantissa == 0u)
+			bits = sign;
+		else {
+			// Normalize the denormalized half
+			int e = -1;
+			do {
+				++e;
+				mantissa <<= 1;
+			} while ((mantissa & 0x400u) == 0u);
+
+			bits = sign | ((u_int)(127 - 15 - e) << 23) | ((mantissa & 0x3ffu) << 13);
+		}
+	} else
+		bits = sign | ((exponent - 15u + 127u) << 23) | (mantissa << 13);
+
+	float f;
+	memcpy(&f, &bits, sizeof(float));
+
+	return f;
+}
+
+//------------------------------------------------------------------------------
+// Packed attributes
+//------------------------------------------------------------------------------
+
+// 2 x 16bit half precision UV
+inline u_int PackUV(const UV &uv) {
+	return (u_int)FloatToHalf(uv.u) | ((u_int)FloatToHalf(uv.v) << 16);
+}
+
+inline UV UnpackUV(const u_int packed) {
+	return UV(HalfToFloat((u_short)(packed & 0xffffu)), HalfToFloat((u_short)(packed >> 16)));
+}
+
+// 3 x 16bit half precision RGB
+inline void PackSpectrum(const Spectrum &s, u_short *packed) {
+	packed[0] = FloatToHalf(s.c[0]);
+	packed[1] = FloatToHalf(s.c[1]);
+	packed[2] = FloatToHalf(s.c[2]);
+}
+
+inline Spectrum UnpackSpectrum(const u_short *packed) {
+	return Spectrum(HalfToFloat(packed[0]), HalfToFloat(packed[1]), HalfToFloat(packed[2]));
+}
+
+// Octahedral encoding of a unit vector in 2 x 16bit signed normalized
+// integers. See "A Survey of Efficient Representations for Independent Unit
+// Vectors" by Cigolle et al. The maximum error is about 0.05 degrees.
+inline u_int PackOctahedralNormal(const Normal &n) {
+	const float l1Norm = fabsf(n.x) + fabsf(n.y) + fabsf(n.z);
+	// A degenerate (or NaN) normal is encoded as (0, 0, 1), u = v = 0
+	if (!(l1Norm > 0.f))
+		return 0u;
+	const float invL1Norm = 1.f / l1Norm;
+
+	float u, v;
+	if (n.z < 0.f) {
+		u = (1.f - fabsf(n.y * invL1Norm)) * ((n.x >= 0.f) ? 1.f : -1.f);
+		v = (1.f - fabsf(n.x * invL1Norm)) * ((n.y >= 0.f) ? 1.f : -1.f);
+	} else {
+		u = n.x * invL1Norm;
+		v = n.y * invL1Norm;
+	}
+
+	const int iu = (int)roundf(Clamp(u, -1.f, 1.f) * 32767.f);
+	const int iv = (int)roundf(Clamp(v, -1.f, 1.f) * 32767.f);
+
+	return ((u_int)iu & 0xffffu) | (((u_int)iv & 0xffffu) << 16);
+}
+
+inline Normal UnpackOctahedralNormal(const u_int packed) {
+	const float u = (short)(packed & 0xffffu) * (1.f / 32767.f);
+	const float v = (short)(packed >> 16) * (1.f / 32767.f);
+
+	Normal n(u, v, 1.f - fabsf(u) - fabsf(v));
+	if (n.z < 0.f) {
+		const float x = n.x;
+		n.x = (1.f - fabsf(n.y)) * ((x >= 0.f) ? 1.f : -1.f);
+		n.y = (1.f - fabsf(x)) * ((n.y >= 0.f) ? 1.f : -1.f);
+	}
+
+	return Normalize(n);
+}
+
+}
+
+#endif	/* _LUXRAYS_PACKING_H */
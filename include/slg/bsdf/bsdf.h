@@ -29,6 +29,7 @@
 #include "slg/volumes/volume.h"
 #include "slg/bsdf/bsdfevents.h"
 #include "slg/bsdf/hitpoint.h"
+#include "slg/textures/texturevaluecache.h"
 #include "slg/scene/sceneobject.h"
 #include "slg/utils/pathvolumeinfo.h"
 
@@ -51,7 +52,7 @@ class Scene;
 class BSDF {
 public:
 	// An empty BSDF
-	BSDF() : material(NULL) { };
+	BSDF() : material(NULL) { hitPoint.texValueCache = nullptr; };
 
 	// A BSDF initialized from a ray hit
 	BSDF(const bool fixedFromLight, const bool throughShadowTransparency,
@@ -97,6 +98,17 @@ public:
 	void Init(const bool fixedFromLight, const bool throughShadowTransparency,
 		const Scene &scene, const luxrays::Ray &ray,
 		const Volume &volume, const float t, const float passThroughEvent);
+	// Used to rebuild a light sampling only BSDF from a compact point
+	// (see VisibilityPoint): the material is not evaluated
+	void Init(const luxrays::Point &p, const luxrays::Normal &geometryN,
+		const luxrays::Normal &shadeN, const bool intoObject,
+		const Material *material);
+
+	// Enables the cache of the material texture values for this shading
+	// point (NULL to disable it). The cache is owned by the caller and it
+	// must not be used by other threads. It is disabled by Init() and
+	// MoveHitPoint().
+	void SetTextureValueCache(TextureValueCache *cache);
 
 	void MoveHitPoint(const luxrays::Point &p, const luxrays::Normal &n);
 	
@@ -122,6 +134,7 @@ public:
 	const Volume *GetMaterialExteriorVolume() const { return material->GetExteriorVolume(hitPoint, hitPoint.passThroughEvent); }
 	float GetGlossiness() const { return material->GetGlossiness(); }
 	const SceneObject *GetSceneObject() const { return sceneObject; }
+	const Material *GetMaterial() const { return material; }
 
 	BSDFEvent GetEventTypes() const { return material->GetEventTypes(); }
 	MaterialType GetMaterialType() const { return material->GetType(); }
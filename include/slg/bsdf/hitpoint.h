@@ -42,6 +42,7 @@ using luxrays::ocl::Spectrum;
 
 class Volume;
 class Scene;
+class TextureValueCache;
 
 typedef struct HitPoint_t {
 	// The incoming direction. It is the eyeDir when fromLight = false and
@@ -74,6 +75,9 @@ typedef struct HitPoint_t {
 	bool fromLight, intoObject;
 	// If I got here going trough a shadow transparency. It can be used to disable MIS.
 	bool throughShadowTransparency;
+	// The cache of the material texture values, owned by the caller of
+	// BSDF::SetTextureValueCache() (it can be NULL)
+	TextureValueCache *texValueCache;
 
 	// Used when hitting a surface
 	//
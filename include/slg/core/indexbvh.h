@@ -30,8 +30,16 @@ namespace slg {
 
 //------------------------------------------------------------------------------
 // Index BVH
+//
+// The tree is stored as a stackless array of nodes (the same format used by
+// OpenCL kernels). Leaves are buckets of up to INDEXBVH_LEAF_BUCKET_SIZE
+// entries with the positions stored inline in SoA order, so the distance
+// test doesn't touch the (large) entries.
 //------------------------------------------------------------------------------
 
+// Max. number of query points walked together by the batched look up
+#define INDEXBVH_QUERY_BATCH_SIZE 32
+
 template <class T>
 class IndexBvh {
 public:
@@ -47,19 +55,145 @@ public:
 		return arrayNodes;
 	}
 
+	// Returns all entry indices in leaf order, consecutive entries are
+	// spatially close
+	void GetLeafOrderEntryIndices(std::vector<u_int> &entryIndices) const;
+
+	// Calls nearEntryFunc(entryIndex, distance2) for each entry closer
+	// than the entry radius to p
+	template <class F> void ForEachNearEntry(const luxrays::Point &p, F &&nearEntryFunc) const {
+		u_int currentNode = 0; // Root Node
+		const u_int stopNode = nNodes ? IndexBVHNodeData_GetSkipIndex(arrayNodes[0].nodeData) : 0; // Non-existent
+
+		while (currentNode < stopNode) {
+			const luxrays::ocl::IndexBVHArrayNode &node = arrayNodes[currentNode];
+
+			const u_int nodeData = node.nodeData;
+			// Check the bounding box
+			if (p.x >= node.bvhNode.bboxMin[0] && p.x <= node.bvhNode.bboxMax[0] &&
+					p.y >= node.bvhNode.bboxMin[1] && p.y <= node.bvhNode.bboxMax[1] &&
+					p.z >= node.bvhNode.bboxMin[2] && p.z <= node.bvhNode.bboxMax[2]) {
+				if (IndexBVHNodeData_IsLeaf(nodeData)) {
+					// It is a leaf, check all the entries of the bucket
+					const luxrays::ocl::IndexBVHLeafBucket &bucket = GetLeafBucket(currentNode);
+
+					float distance2[INDEXBVH_LEAF_BUCKET_SIZE];
+					BucketDistanceSquared(bucket, p, distance2);
+
+					for (u_int i = 0; i < INDEXBVH_LEAF_BUCKET_SIZE; ++i) {
+						if (distance2[i] < entryRadius2)
+							nearEntryFunc(bucket.entryIndex[i], distance2[i]);
+					}
+
+					currentNode = IndexBVHNodeData_GetSkipIndex(nodeData);
+				} else
+					++currentNode;
+			} else
+				currentNode = IndexBVHNodeData_GetSkipIndex(nodeData);
+		}
+	}
+
+	// Batched version of ForEachNearEntry(): the tree is walked once for each
+	// group of INDEXBVH_QUERY_BATCH_SIZE points and nearEntryFunc(queryIndex,
+	// entryIndex, distance2) is called for each entry closer than the entry
+	// radius to p[queryIndex]. It works best with spatially coherent points.
+	template <class F> void ForEachNearEntry(const luxrays::Point *p, const u_int count,
+			F &&nearEntryFunc) const {
+		const u_int stopNode = nNodes ? IndexBVHNodeData_GetSkipIndex(arrayNodes[0].nodeData) : 0; // Non-existent
+
+		for (u_int batchStart = 0; batchStart < count; batchStart += INDEXBVH_QUERY_BATCH_SIZE) {
+			const u_int batchSize = luxrays::Min<u_int>(count - batchStart, INDEXBVH_QUERY_BATCH_SIZE);
+			const luxrays::Point *batchP = &p[batchStart];
+
+			u_int currentNode = 0; // Root Node
+			while (currentNode < stopNode) {
+				const luxrays::ocl::IndexBVHArrayNode &node = arrayNodes[currentNode];
+
+				// Check the bounding box with all the points of the batch
+				u_int insideMask = 0;
+				for (u_int i = 0; i < batchSize; ++i) {
+					const luxrays::Point &q = batchP[i];
+					if (q.x >= node.bvhNode.bboxMin[0] && q.x <= node.bvhNode.bboxMax[0] &&
+							q.y >= node.bvhNode.bboxMin[1] && q.y <= node.bvhNode.bboxMax[1] &&
+							q.z >= node.bvhNode.bboxMin[2] && q.z <= node.bvhNode.bboxMax[2])
+						insideMask |= 1u << i;
+				}
+
+				const u_int nodeData = node.nodeData;
+				if (insideMask) {
+					if (IndexBVHNodeData_IsLeaf(nodeData)) {
+						// It is a leaf, check all the entries of the bucket
+						const luxrays::ocl::IndexBVHLeafBucket &bucket = GetLeafBucket(currentNode);
+
+						for (u_int i = 0; i < batchSize; ++i) {
+							if (!(insideMask & (1u << i)))
+								continue;
+
+							float distance2[INDEXBVH_LEAF_BUCKET_SIZE];
+							BucketDistanceSquared(bucket, batchP[i], distance2);
+
+							for (u_int j = 0; j < INDEXBVH_LEAF_BUCKET_SIZE; ++j) {
+								if (distance2[j] < entryRadius2)
+									nearEntryFunc(batchStart + i, bucket.entryIndex[j], distance2[j]);
+							}
+						}
+
+						currentNode = IndexBVHNodeData_GetSkipIndex(nodeData);
+					} else
+						++currentNode;
+				} else
+					currentNode = IndexBVHNodeData_GetSkipIndex(nodeData);
+			}
+		}
+	}
+
 	friend class boost::serialization::access;
 
 protected:
 	// Used by serialization
 	IndexBvh();
 
+	const luxrays::ocl::IndexBVHLeafBucket &GetLeafBucket(const u_int leafNodeIndex) const {
+		return *((const luxrays::ocl::IndexBVHLeafBucket *)&arrayNodes[leafNodeIndex + 1]);
+	}
+
+	// Written to be auto-vectorized. Unused slots return a huge distance.
+	static void BucketDistanceSquared(const luxrays::ocl::IndexBVHLeafBucket &bucket,
+			const luxrays::Point &p, float *distance2) {
+		for (u_int i = 0; i < INDEXBVH_LEAF_BUCKET_SIZE; ++i) {
+			const float dx = bucket.x[i] - p.x;
+			const float dy = bucket.y[i] - p.y;
+			const float dz = bucket.z[i] - p.z;
+
+			distance2[i] = dx * dx + dy * dy + dz * dz;
+		}
+	}
+
 	template<class Archive> void save(Archive &ar, const unsigned int version) const {
 		ar & allEntries;
 		ar & entryRadius;
 		ar & entryRadius2;
 
 		ar & nNodes;
-		ar & boost::serialization::make_array<luxrays::ocl::IndexBVHArrayNode>(arrayNodes, nNodes);		
+		u_int nodeIndex = 0;
+		while (nodeIndex < nNodes) {
+			const luxrays::ocl::IndexBVHArrayNode &node = arrayNodes[nodeIndex];
+
+			ar & node.nodeData;
+			ar & boost::serialization::make_array<float>(const_cast<float *>(node.bvhNode.bboxMin), 3);
+			ar & boost::serialization::make_array<float>(const_cast<float *>(node.bvhNode.bboxMax), 3);
+
+			if (IndexBVHNodeData_IsLeaf(node.nodeData)) {
+				luxrays::ocl::IndexBVHLeafBucket &bucket = const_cast<luxrays::ocl::IndexBVHLeafBucket &>(GetLeafBucket(nodeIndex));
+				ar & boost::serialization::make_array<float>(bucket.x, INDEXBVH_LEAF_BUCKET_SIZE);
+				ar & boost::serialization::make_array<float>(bucket.y, INDEXBVH_LEAF_BUCKET_SIZE);
+				ar & boost::serialization::make_array<float>(bucket.z, INDEXBVH_LEAF_BUCKET_SIZE);
+				ar & boost::serialization::make_array<unsigned int>(bucket.entryIndex, INDEXBVH_LEAF_BUCKET_SIZE);
+
+				nodeIndex += 1 + INDEXBVH_LEAF_BUCKET_NODES;
+			} else
+				++nodeIndex;
+		}
 	}
 
 	template<class Archive>	void load(Archive &ar, const unsigned int version) {
@@ -69,7 +203,25 @@ protected:
 
 		ar & nNodes;
 		arrayNodes = new luxrays::ocl::IndexBVHArrayNode[nNodes];
-		ar & boost::serialization::make_array<luxrays::ocl::IndexBVHArrayNode>(arrayNodes, nNodes);
+		u_int nodeIndex = 0;
+		while (nodeIndex < nNodes) {
+			luxrays::ocl::IndexBVHArrayNode &node = arrayNodes[nodeIndex];
+
+			ar & node.nodeData;
+			ar & boost::serialization::make_array<float>(node.bvhNode.bboxMin, 3);
+			ar & boost::serialization::make_array<float>(node.bvhNode.bboxMax, 3);
+
+			if (IndexBVHNodeData_IsLeaf(node.nodeData)) {
+				luxrays::ocl::IndexBVHLeafBucket &bucket = const_cast<luxrays::ocl::IndexBVHLeafBucket &>(GetLeafBucket(nodeIndex));
+				ar & boost::serialization::make_array<float>(bucket.x, INDEXBVH_LEAF_BUCKET_SIZE);
+				ar & boost::serialization::make_array<float>(bucket.y, INDEXBVH_LEAF_BUCKET_SIZE);
+				ar & boost::serialization::make_array<float>(bucket.z, INDEXBVH_LEAF_BUCKET_SIZE);
+				ar & boost::serialization::make_array<unsigned int>(bucket.entryIndex, INDEXBVH_LEAF_BUCKET_SIZE);
+
+				nodeIndex += 1 + INDEXBVH_LEAF_BUCKET_NODES;
+			} else
+				++nodeIndex;
+		}
 	}
 	
 	BOOST_SERIALIZATION_SPLIT_MEMBER()
@@ -85,52 +237,4 @@ protected:
 
 BOOST_SERIALIZATION_ASSUME_ABSTRACT(slg::IndexBvh)
 
-//------------------------------------------------------------------------------
-// luxrays::ocl::IndexBVHArrayNode serialization
-//------------------------------------------------------------------------------
-
-BOOST_SERIALIZATION_SPLIT_FREE(luxrays::ocl::IndexBVHArrayNode)
-
-namespace boost {
-namespace serialization {
-
-template<class Archive>
-void save(Archive &ar, const luxrays::ocl::IndexBVHArrayNode &node, const unsigned int version) {
-	ar & node.nodeData;
-
-	if (IndexBVHNodeData_IsLeaf(node.nodeData))
-		ar & node.entryLeaf.entryIndex;
-	else {
-		ar & node.bvhNode.bboxMin[0];
-		ar & node.bvhNode.bboxMin[1];
-		ar & node.bvhNode.bboxMin[2];
-
-		ar & node.bvhNode.bboxMax[0];
-		ar & node.bvhNode.bboxMax[1];
-		ar & node.bvhNode.bboxMax[2];
-	}
-}
-
-template<class Archive>
-void load(Archive &ar, luxrays::ocl::IndexBVHArrayNode &node, const unsigned int version) {
-	ar & node.nodeData;
-
-	if (IndexBVHNodeData_IsLeaf(node.nodeData))
-		ar & node.entryLeaf.entryIndex;
-	else {
-		ar & node.bvhNode.bboxMin[0];
-		ar & node.bvhNode.bboxMin[1];
-		ar & node.bvhNode.bboxMin[2];
-
-		ar & node.bvhNode.bboxMax[0];
-		ar & node.bvhNode.bboxMax[1];
-		ar & node.bvhNode.bboxMax[2];
-	}
-}
-
-}
-}
-
-BOOST_CLASS_VERSION(luxrays::ocl::IndexBVHArrayNode, 1)
-		
 #endif	/* __SLG_INDEXBVH_H */
@@ -51,6 +51,52 @@ typedef struct {
 	PathVolumeInfo volInfo;
 } PathVertexVM;
 
+//------------------------------------------------------------------------------
+// Light path vertices storage
+//
+// Light path vertices are stored as a structure of arrays without the full
+// BSDF: the positions are used by the vertex merging k-NN search, the MIS data
+// by both vertex merging and connection. The BSDF is rebuilt only when a
+// vertex connection requires it.
+//------------------------------------------------------------------------------
+
+class LightPathVertices {
+public:
+	typedef struct {
+		luxrays::Vector fixedDir;
+		luxrays::Spectrum throughput;
+		u_int lightID, depth;
+
+		float dVCM, dVC, dVM;
+	} MISData;
+
+	typedef struct {
+		// Used to check if the hit point has been moved by bevel edges
+		luxrays::Normal geometryN;
+		const Volume *interiorVolume, *exteriorVolume;
+		// meshIndex is NULL_INDEX for volume scattering points
+		u_int meshIndex, triangleIndex;
+		float b1, b2;
+		float passThroughEvent;
+		bool throughShadowTransparency;
+	} BSDFData;
+
+	LightPathVertices() { }
+	~LightPathVertices() { }
+
+	u_int GetSize() const { return positions.size(); }
+
+	void Clear();
+	void Add(const PathVertexVM &vertex, const luxrays::RayHit &rayHit);
+
+	void GetBSDF(const Scene &scene, const u_int index, const float time,
+		BSDF &bsdf) const;
+
+	std::vector<luxrays::Point> positions;
+	std::vector<MISData> misData;
+	std::vector<BSDFData> bsdfData;
+};
+
 class BiDirCPURenderEngine;
 
 class BiDirCPURenderThread : public CPUNoTileRenderThread {
@@ -90,7 +136,12 @@ protected:
 		const PathVertexVM &eyeVertex, luxrays::Spectrum *radiance) const;
 
 	void ConnectVertices(const float time,
-		const PathVertexVM &eyeVertex, const PathVertexVM &BiDirVertex,
+		const PathVertexVM &eyeVertex, const LightPathVertices::MISData &lightVertex,
+		const BSDF &lightBSDF, SampleResult &eyeSampleResult, const float u0) const;
+	void ConnectVertices(const float time,
+		const PathVertexVM &eyeVertex, const LightPathVertices &lightPathVertices,
+		const u_int lightPathStart, const u_int lightPathEnd,
+		std::vector<BSDF> &lightPathBSDFs, bool &lightPathBSDFsReady,
 		SampleResult &eyeSampleResult, const float u0) const;
 	void ConnectToEye(const float time,
 		const PathVertexVM &BiDirVertex, const float u0,
@@ -98,7 +149,7 @@ protected:
 
 	bool TraceLightPath(const float time,
 		Sampler *sampler, const luxrays::Point &lensPoint,
-		std::vector<PathVertexVM> &lightPathVertices,
+		LightPathVertices &lightPathVertices,
 		std::vector<SampleResult> &sampleResults) const;
 	bool Bounce(const float time, Sampler *sampler, const u_int sampleOffset,
 		PathVertexVM *pathVertex, luxrays::Ray *nextEventRay) const;
@@ -33,12 +33,12 @@ class BiDirVMCPURenderThread;
 
 class HashGrid {
 public:
-	HashGrid() { }
+	HashGrid() : pathsVertices(nullptr) { }
 	~HashGrid() { }
 
 	u_int GetVertexCount() const { return vertexCount; }
 
-	void Build(std::vector<std::vector<PathVertexVM> > &pathsVertices, const float radius);
+	void Build(const LightPathVertices &pathsVertices, const float radius);
 
 	void Process(const BiDirVMCPURenderThread *thread,
 		const PathVertexVM &eyeVertex, luxrays::Spectrum *radiance) const;
@@ -50,7 +50,7 @@ private:
 		const PathVertexVM &eyeVertex, const int i0, const int i1,
 		luxrays::Spectrum *radiance) const;
 	void Process(const BiDirVMCPURenderThread *thread,
-		const PathVertexVM &eyeVertex, const PathVertexVM *lightVertex,
+		const PathVertexVM &eyeVertex, const u_int lightVertexIndex,
 		luxrays::Spectrum *radiance) const;
 
 	void HashRange(const u_int i, int *i0, int *i1) const {
@@ -82,7 +82,8 @@ private:
 	luxrays::BBox vertexBBox;
 	u_int vertexCount;
 
-	std::vector<const PathVertexVM *> lightVertices;
+	const LightPathVertices *pathsVertices;
+	std::vector<u_int> lightVertices;
     std::vector<int> cellEnds;
 
 	// Statistics
@@ -95,35 +95,37 @@ OPENCL_FORCE_INLINE __global const RadiancePhoton* restrict RadiancePhotonsBVH_G
 		__global const IndexBVHArrayNode* restrict node = &pgicRadiancePhotonsBVHNodes[currentNode];
 
 		const uint nodeData = node->nodeData;
-		if (IndexBVHNodeData_IsLeaf(nodeData)) {
-			// It is a leaf, check the entry
-			__global const RadiancePhoton* restrict entry = &pgicRadiancePhotons[node->entryLeaf.entryIndex];
-
-			const float distance2 = DistanceSquared(p, VLOAD3F(&entry->p.x));
-			if ((distance2 < nearestDistance2) && 
-					(entry->isVolume == isVolume) &&
-						(isVolume ||
-						(dot(n, VLOAD3F(&entry->n.x)) > pgicIndirectLookUpNormalCosAngle)
-						)
-				) {
-				// I have found a valid nearer entry
-				nearestEntry = entry;
-				nearestDistance2 = distance2;
-			}
-
-			++currentNode;
-		} else {
-			// It is a node, check the bounding box
-			if (p.x >= node->bvhNode.bboxMin[0] && p.x <= node->bvhNode.bboxMax[0] &&
-					p.y >= node->bvhNode.bboxMin[1] && p.y <= node->bvhNode.bboxMax[1] &&
-					p.z >= node->bvhNode.bboxMin[2] && p.z <= node->bvhNode.bboxMax[2])
+		// Check the bounding box
+		if (p.x >= node->bvhNode.bboxMin[0] && p.x <= node->bvhNode.bboxMax[0] &&
+				p.y >= node->bvhNode.bboxMin[1] && p.y <= node->bvhNode.bboxMax[1] &&
+				p.z >= node->bvhNode.bboxMin[2] && p.z <= node->bvhNode.bboxMax[2]) {
+			if (IndexBVHNodeData_IsLeaf(nodeData)) {
+				// It is a leaf, check all the entries of the bucket
+				__global const IndexBVHLeafBucket* restrict bucket = (__global const IndexBVHLeafBucket *)&pgicRadiancePhotonsBVHNodes[currentNode + 1];
+
+				for (uint i = 0; i < INDEXBVH_LEAF_BUCKET_SIZE; ++i) {
+					const float distance2 = DistanceSquared(p, MAKE_FLOAT3(bucket->x[i], bucket->y[i], bucket->z[i]));
+					if (distance2 < nearestDistance2) {
+						const uint entryIndex = bucket->entryIndex[i];
+						__global const RadiancePhoton* restrict entry = &pgicRadiancePhotons[entryIndex];
+
+						if ((isVolume == entry->isVolume) &&
+								(isVolume ||
+								(dot(n, VLOAD3F(&entry->n.x)) > pgicIndirectLookUpNormalCosAngle)
+								)
+							) {
+							// I have found a valid nearer entry
+							nearestEntry = entry;
+							nearestDistance2 = distance2;
+						}
+					}
+				}
+
+				currentNode = IndexBVHNodeData_GetSkipIndex(nodeData);
+			} else
 				++currentNode;
-			else {
-				// I don't need to use IndexBVHNodeData_GetSkipIndex() here because
-				// I already know the leaf flag is 0
-				currentNode = nodeData;
-			}
-		}
+		} else
+			currentNode = IndexBVHNodeData_GetSkipIndex(nodeData);
 	}
 
 	return nearestEntry;
@@ -200,37 +202,38 @@ OPENCL_FORCE_INLINE bool PGICPhotonBvh_ConnectAllNearEntries(__global const BSDF
 		__global const IndexBVHArrayNode* restrict node = &pgicCausticPhotonsBVHNodes[currentNode];
 
 		const uint nodeData = node->nodeData;
-		if (IndexBVHNodeData_IsLeaf(nodeData)) {
-			// It is a leaf, check the entry
-			const uint entryIndex = node->entryLeaf.entryIndex;
-			__global const Photon* restrict entry = &pgicCausticPhotons[entryIndex];
-
-			const float distance2 = DistanceSquared(p, VLOAD3F(&entry->p.x));
-			if ((distance2 < pgicCausticLookUpRadius2) &&
-					(entry->isVolume == isVolume) &&
-						(isVolume ||
-						((dot(n, -VLOAD3F(&entry->d.x)) > DEFAULT_COS_EPSILON_STATIC) &&
-						(dot(n, VLOAD3F(&entry->landingSurfaceNormal.x)) > pgicCausticLookUpNormalCosAngle))
-						)
-				) {
-				const float3 alpha = PGICPhotonBvh_ConnectCacheEntry(entry, bsdf MATERIALS_PARAM) * factor;
-				VADD3F(radiance[entry->lightID].c, alpha * scale);
-				isEmpty = false;
-			}
-
-			++currentNode;
-		} else {
-			// It is a node, check the bounding box
-			if (p.x >= node->bvhNode.bboxMin[0] && p.x <= node->bvhNode.bboxMax[0] &&
-					p.y >= node->bvhNode.bboxMin[1] && p.y <= node->bvhNode.bboxMax[1] &&
-					p.z >= node->bvhNode.bboxMin[2] && p.z <= node->bvhNode.bboxMax[2])
+		// Check the bounding box
+		if (p.x >= node->bvhNode.bboxMin[0] && p.x <= node->bvhNode.bboxMax[0] &&
+				p.y >= node->bvhNode.bboxMin[1] && p.y <= node->bvhNode.bboxMax[1] &&
+				p.z >= node->bvhNode.bboxMin[2] && p.z <= node->bvhNode.bboxMax[2]) {
+			if (IndexBVHNodeData_IsLeaf(nodeData)) {
+				// It is a leaf, check all the entries of the bucket
+				__global const IndexBVHLeafBucket* restrict bucket = (__global const IndexBVHLeafBucket *)&pgicCausticPhotonsBVHNodes[currentNode + 1];
+
+				for (uint i = 0; i < INDEXBVH_LEAF_BUCKET_SIZE; ++i) {
+					const float distance2 = DistanceSquared(p, MAKE_FLOAT3(bucket->x[i], bucket->y[i], bucket->z[i]));
+					if (distance2 < pgicCausticLookUpRadius2) {
+						const uint entryIndex = bucket->entryIndex[i];
+						__global const Photon* restrict entry = &pgicCausticPhotons[entryIndex];
+
+						if ((entry->isVolume == isVolume) &&
+								(isVolume ||
+								((dot(n, -VLOAD3F(&entry->d.x)) > DEFAULT_COS_EPSILON_STATIC) &&
+								(dot(n, VLOAD3F(&entry->landingSurfaceNormal.x)) > pgicCausticLookUpNormalCosAngle))
+								)
+							) {
+							const float3 alpha = PGICPhotonBvh_ConnectCacheEntry(entry, bsdf MATERIALS_PARAM) * factor;
+							VADD3F(radiance[entry->lightID].c, alpha * scale);
+							isEmpty = false;
+						}
+					}
+				}
+
+				currentNode = IndexBVHNodeData_GetSkipIndex(nodeData);
+			} else
 				++currentNode;
-			else {
-				// I don't need to use IndexBVHNodeData_GetSkipIndex() here because
-				// I already know the leaf flag is 0
-				currentNode = nodeData;
-			}
-		}
+		} else
+			currentNode = IndexBVHNodeData_GetSkipIndex(nodeData);
 	}
 
 	return isEmpty;
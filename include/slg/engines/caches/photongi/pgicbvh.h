@@ -93,8 +93,8 @@ private:
 
 }
 
-BOOST_CLASS_VERSION(slg::PGICPhotonBvh, 2)
-BOOST_CLASS_VERSION(slg::PGICRadiancePhotonBvh, 1)
+BOOST_CLASS_VERSION(slg::PGICPhotonBvh, 3)
+BOOST_CLASS_VERSION(slg::PGICRadiancePhotonBvh, 2)
 
 BOOST_CLASS_EXPORT_KEY(slg::PGICPhotonBvh)
 BOOST_CLASS_EXPORT_KEY(slg::PGICRadiancePhotonBvh)
@@ -20,9 +20,10 @@
 #define	_SLG_PHOTONGICACHE_H
 
 #include <vector>
+#include <memory>
 #include <boost/atomic.hpp>
+#include <boost/thread.hpp>
 #include <boost/thread/mutex.hpp>
-#include <boost/thread/barrier.hpp>
 #include <boost/function.hpp>
 
 #include "luxrays/core/color/spectrumgroup.h"
@@ -206,7 +207,7 @@ typedef struct PhotonGICacheParams_t {
 		u_int maxSize;
 		float lookUpRadius, lookUpRadius2, lookUpNormalAngle,
 				radiusReduction, minLookUpRadius;
-		u_int updateSpp;
+		u_int updateSpp, updateThreadCount;
 	} caustic;
 
 	PhotonGIDebugType debugType;
@@ -249,6 +250,10 @@ protected:
 		ar & caustic.radiusReduction;
 		ar & caustic.minLookUpRadius;
 		ar & caustic.updateSpp;
+		if (version >= 7)
+			ar & caustic.updateThreadCount;
+		else
+			caustic.updateThreadCount = 2;
 
 		ar & debugType;
 		
@@ -295,8 +300,8 @@ public:
 	const PGICRadiancePhotonBvh *GetRadiancePhotonsBVH() const { return radiancePhotonsBVH; }
 	const u_int GetRadiancePhotonTracedCount() const { return indirectPhotonTracedCount; }
 
-	const std::vector<Photon> &GetCausticPhotons() const { return causticPhotons; }
-	const PGICPhotonBvh *GetCausticPhotonsBVH() const { return causticPhotonsBVH; }
+	const std::vector<Photon> &GetCausticPhotons() const { return causticPhotons[causticPhotonsIndex]; }
+	const PGICPhotonBvh *GetCausticPhotonsBVH() const { return causticPhotonsBVH.load(boost::memory_order_acquire); }
 	const u_int GetCausticPhotonTracedCount() const { return causticPhotonTracedCount; }
 
 	static PhotonGISamplerType String2SamplerType(const std::string &type);
@@ -320,17 +325,26 @@ private:
 	void EvaluateBestRadiusImpl(const u_int threadIndex, const u_int workSize,
 			float &accumulatedRadiusSize, u_int &radiusSizeCount) const;
 	void TraceVisibilityParticles();
-	void TracePhotons(const u_int seedBase, const u_int photonTracedCount,
+	void TracePhotons(const u_int tracingThreadCount,
+		const u_int seedBase, const u_int photonTracedCount,
 		const bool indirectCacheDone, const bool causticCacheDone,
 		boost::atomic<u_int> &globalIndirectPhotonsTraced,
 		boost::atomic<u_int> &globalCausticPhotonsTraced,
 		boost::atomic<u_int> &globalIndirectSize,
-		boost::atomic<u_int> &globalCausticSize);
-	void TracePhotons(const bool indirectEnabled, const bool causticEnabled);
+		boost::atomic<u_int> &globalCausticSize,
+		std::vector<Photon> &newCausticPhotons);
+	void TracePhotons(const u_int tracingThreadCount,
+		const bool indirectEnabled, const bool causticEnabled,
+		std::vector<Photon> &newCausticPhotons, u_int &newCausticPhotonTracedCount);
 	void FilterVisibilityParticlesRadiance(const std::vector<luxrays::SpectrumGroup> &radianceValues,
 			std::vector<luxrays::SpectrumGroup> &filteredRadianceValues) const;
 	void CreateRadiancePhotons();
 
+	void InitUpdateState();
+	void CausticUpdateThreadFunc(const u_int filmSPP);
+	void ReclaimRetiredCausticPhotons();
+	void StopCausticUpdateThread();
+
 	void LoadPersistentCache(const std::string &fileName);
 	void SavePersistentCache(const std::string &fileName);
 
@@ -340,9 +354,8 @@ private:
 	PhotonGICacheParams params;
 
 	u_int threadCount;
-	std::unique_ptr<boost::barrier> threadsSyncBarrier;
 	u_int lastUpdateSpp, updateSeedBase;
-	bool finishUpdateFlag;
+	boost::atomic<bool> finishUpdateFlag;
 
 	// Visibility map
 	std::vector<PGICVisibilityParticle> visibilityParticles;
@@ -354,9 +367,25 @@ private:
 	u_int indirectPhotonTracedCount;
 
 	// Caustic photon maps
-	std::vector<Photon> causticPhotons;
-	PGICPhotonBvh *causticPhotonsBVH;
+	//
+	// The photons are double buffered: the background update traces the next
+	// pass in the buffer not referenced by the published BVH. The published
+	// BVH is swapped atomically and the old one is retired until all
+	// rendering threads have passed an update point (i.e. have seen the new
+	// epoch) and can not be using it anymore.
+	std::vector<Photon> causticPhotons[2];
+	u_int causticPhotonsIndex;
+	boost::atomic<PGICPhotonBvh *> causticPhotonsBVH;
 	u_int causticPhotonTracedCount, causticPhotonPass;
+
+	// Caustic cache background update
+	boost::mutex causticUpdateMutex;
+	std::unique_ptr<boost::thread> causticUpdateThread;
+	boost::atomic<bool> causticUpdateRunning;
+	boost::atomic<u_int> causticEpoch;
+	std::unique_ptr<boost::atomic<u_int>[]> threadEpochs;
+	PGICPhotonBvh *retiredCausticPhotonsBVH;
+	bool causticPhotonsRetired;
 };
 
 }
@@ -365,7 +394,7 @@ BOOST_CLASS_VERSION(slg::GenericPhoton, 1)
 BOOST_CLASS_VERSION(slg::PGICVisibilityParticle, 2)
 BOOST_CLASS_VERSION(slg::Photon, 2)
 BOOST_CLASS_VERSION(slg::RadiancePhoton, 2)
-BOOST_CLASS_VERSION(slg::PhotonGICacheParams, 6)
+BOOST_CLASS_VERSION(slg::PhotonGICacheParams, 7)
 BOOST_CLASS_VERSION(slg::PhotonGICache, 3)
 
 BOOST_CLASS_EXPORT_KEY(slg::GenericPhoton)
@@ -58,6 +58,7 @@ public:
 	virtual ~TracePhotonsThread();
 
 	void Start();
+	void Interrupt();
 	void Join();
 
 	std::vector<RadiancePhotonEntry> indirectPhotons;
@@ -174,6 +174,16 @@ protected:
 	void SetAllAdvancePathsKernelArgs(const u_int filmIndex);
 	void SetKernelArgs();
 
+	// Background kernel compilation: the program is compiled (or loaded from
+	// the persistent cache) while the engine is still busy with the scene
+	// preprocessing. InitKernels() picks up the result.
+	void StartKernelsCompilation();
+	void KernelsCompilationThreadImpl(const std::vector<std::string> kernelsParameters,
+			const std::string kernelSource, const std::string newKernelSrcHash);
+	luxrays::HardwareDeviceProgram *WaitForKernelsCompilation(const std::string &newKernelSrcHash);
+	void GetKernelsProgram(std::vector<std::string> &kernelsParameters,
+			std::string &kernelSource, std::string &newKernelSrcHash);
+
 	void CompileKernel(luxrays::HardwareIntersectionDevice *device,
 			luxrays::HardwareDeviceProgram *program,
 			luxrays::HardwareDeviceKernel **kernel,
@@ -194,6 +204,9 @@ protected:
 
 	// OpenCL variables
 	std::string kernelSrcHash;
+	boost::thread *kernelsCompilationThread;
+	luxrays::HardwareDeviceProgram *kernelsCompilationProgram;
+	std::string kernelsCompilationSrcHash;
 	luxrays::HardwareDeviceKernel *filmClearKernel;
 	size_t filmClearWorkGroupSize;
 
@@ -130,6 +130,8 @@ public:
 		return (t == 0.0) ? 0.0 : (raysCount / t);
 	}
 	double GetRenderingTime() const { return film->GetTotalTime(); }
+	// The time spent preprocessing the caches (i.e. PhotonGI) in the last Start()
+	double GetCachesPreprocessTime() const { return cachesPreprocessTime; }
 
 	//--------------------------------------------------------------------------
 
@@ -188,6 +190,7 @@ protected:
 	luxrays::RandomGenerator seedBaseGenerator;
 
 	double raysCount;
+	double cachesPreprocessTime;
 
 	RenderState *startRenderState;
 	Film *startFilm;
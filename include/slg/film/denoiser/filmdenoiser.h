@@ -46,6 +46,11 @@ public:
 	void SetEnabled(const bool v) { enabled = v; }
 	bool IsEnabled() const { return enabled; }
 
+	// The compact layout can not be used when the accumulator buffers are
+	// shared with OpenCL kernels
+	void SetCompactAccumulators(const bool v) { compactAccumulators = v; }
+	bool IsCompactAccumulators() const { return compactAccumulators; }
+
 	void CheckIfWarmUpDone();
 	bool IsWarmUpDone() const { return warmUpDone; }
 	void WarmUpDone();
@@ -59,21 +64,28 @@ public:
 	void AddDenoiser(const FilmDenoiser &filmDenoiser,
 		const u_int srcOffsetX, const u_int srcOffsetY,
 		const u_int srcWidth, const u_int srcHeight,
-		const u_int dstOffsetX, const u_int dstOffsetY);
+		const u_int dstOffsetX, const u_int dstOffsetY,
+		const float weight = 1.f);
 	void AddDenoiser(const FilmDenoiser &filmDenoiser);
+	// Scales the weight of all the samples accumulated so far
+	void Scale(const float weight);
 
 	void AddSample(const u_int x, const u_int y,
 			const SampleResult &sampleResult, const float weight);
 
 	bool HasSamplesStatistics(const bool pixelNormalizedSampleAccumulator) const;
 	bcd::SamplesStatisticsImages GetSamplesStatistics(const bool pixelNormalizedSampleAccumulator) const;
+	// Returns the statistics of a region in BCD line/column coordinates
+	bcd::SamplesStatisticsImages GetSamplesStatistics(const bool pixelNormalizedSampleAccumulator,
+			const int line, const int column, const int width, const int height) const;
 	float GetSampleScale() const { return sampleScale; }
 	float GetSampleGamma() const { return  bcd::HistogramParameters().m_gamma; }
 	float GetSampleMaxValue() const { return  bcd::HistogramParameters().m_maxValue; }
 	int GetHistogramBinsCount() const { return bcd::HistogramParameters().m_nbOfBins; }
 	const std::vector<RadianceChannelScale> &GetRadianceChannelScales() const { return radianceChannelScales; }
 	
-	// Used by OpenCL related code. Return samplesAccumulatorPixelNormalized images.
+	// Used by OpenCL related code. Return samplesAccumulatorPixelNormalized images
+	// (the histogram image is NULL with the compact layout).
 	float *GetNbOfSamplesImage();
 	float *GetSquaredWeightSumsImage();
 	float *GetMeanImage();
@@ -103,6 +115,8 @@ private:
 		ar & referenceFilmOffsetX;
 		ar & referenceFilmOffsetY;
 		ar & enabled;
+		if (version >= 6)
+			ar & compactAccumulators;
 	}
 
 	const Film *film;
@@ -125,11 +139,12 @@ private:
 	u_int referenceFilmOffsetX, referenceFilmOffsetY;
 	
 	bool enabled;
+	bool compactAccumulators;
 };
 
 }
 
-BOOST_CLASS_VERSION(slg::FilmDenoiser, 5)
+BOOST_CLASS_VERSION(slg::FilmDenoiser, 6)
 
 BOOST_CLASS_EXPORT_KEY(slg::FilmDenoiser)
 
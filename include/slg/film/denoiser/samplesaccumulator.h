@@ -29,38 +29,74 @@
 #ifndef _SLG_SAMPLESACCUMULATOR_H
 #define _SLG_SAMPLESACCUMULATOR_H
 
+#include <vector>
+
+#include <boost/thread/mutex.hpp>
+
 #include <bcd/core/SamplesAccumulator.h>
 
 #include "luxrays/utils/serializationutils.h"
 
 namespace slg {
 
+class SamplesAccumulatorStaging;
+
+//------------------------------------------------------------------------------
+// SamplesAccumulator
+//
+// The compact layout stores the histograms with 16 bits fixed point bins and
+// a power of 2 scale for each pixel channel, instead of a float for each bin.
+// The bins are rounded stochastically so the result is unbiased but slightly
+// noisier than the float layout.
+// The float layout is required when the buffers are shared with OpenCL
+// kernels.
+//
+// AddSampleAtomic() accumulates the samples in per-thread staging buffers that
+// are flushed in bulk, so render threads don't contend on every sample.
+//------------------------------------------------------------------------------
+
 class SamplesAccumulator {
 public:
 	SamplesAccumulator(
 			int i_width, int i_height,
-			const bcd::HistogramParameters& i_rHistogramParameters);
+			const bcd::HistogramParameters& i_rHistogramParameters,
+			const bool i_compactHistogram = false);
+	~SamplesAccumulator();
+
 	void Clear();
 
 	const bcd::HistogramParameters &GetHistogramParameters() const;
+	bool IsCompact() const { return m_compactHistogram; }
 
 	void AddSample(
 			int i_line, int i_column,
 			float i_sampleR, float i_sampleG, float i_sampleB,
 			float i_weight = 1.f);
+	// It can be called by multiple threads at the same time
 	void AddSampleAtomic(
 			int i_line, int i_column,
 			float i_sampleR, float i_sampleG, float i_sampleB,
 			float i_weight = 1.f);
+	// Moves all staged samples in the accumulator
+	void Flush() const;
+
+	// The statistics of samplesAccumulator are added as if all its samples
+	// had their weight scaled by weight
 	void AddAccumulator(const SamplesAccumulator &samplesAccumulator,
 		const int srcOffsetX, const int srcOffsetY,
 		const int srcWidth, const int srcHeight,
-		const int dstOffsetX, const int dstOffsetY);
+		const int dstOffsetX, const int dstOffsetY,
+		const float weight = 1.f);
 	void AddAccumulator(const SamplesAccumulator &samplesAccumulator) {
 		AddAccumulator(samplesAccumulator, 0, 0, m_width, m_height, 0, 0);
 	}
+	// Scales the weight of all accumulated samples
+	void Scale(const float weight);
 
 	bcd::SamplesStatisticsImages GetSamplesStatistics() const;
+	// Returns the statistics of only a region (used by the tiled denoiser)
+	bcd::SamplesStatisticsImages GetSamplesStatistics(
+			int i_line, int i_column, int i_width, int i_height) const;
 
 	bcd::SamplesStatisticsImages ExtractSamplesStatistics();
 
@@ -74,8 +110,26 @@ private:
 	template<class Archive> void save(Archive &ar, const unsigned int version) const;
 	template<class Archive>	void load(Archive &ar, const unsigned int version);
 	BOOST_SERIALIZATION_SPLIT_MEMBER()
-	
-	void ComputeSampleStatistics(bcd::SamplesStatisticsImages &io_sampleStats) const;
+
+	void InitStaging();
+	void AllocCompactHistogram();
+
+	void ComputeSampleStatistics(bcd::SamplesStatisticsImages &io_sampleStats,
+			int i_line, int i_column) const;
+
+	// A record holds the weight sum, the squared weight sum, the weighted
+	// color and covariance sums and the histograms of one or more samples
+	int GetRecordSize() const { return 11 + 3 * m_histogramParameters.m_nbOfBins; }
+	void AccumulateSample(float *io_record,
+			float i_sampleR, float i_sampleG, float i_sampleB,
+			float i_weight) const;
+	void AddRecord(int i_line, int i_column, const float *i_record);
+	void FlushStaging(SamplesAccumulatorStaging &staging);
+	SamplesAccumulatorStaging *GetThreadStaging();
+
+	void GetHistogram(int i_line, int i_column, int i_channel, float *o_bins) const;
+	void AddHistogram(int i_line, int i_column, int i_channel, const float *i_bins);
+	void ScaleHistogram(int i_line, int i_column, int i_channel, const float i_weight);
 
 	int m_width;
 	int m_height;
@@ -83,12 +137,26 @@ private:
 	bcd::SamplesStatisticsImages m_samplesStatisticsImages;
 	bcd::DeepImage<float> m_squaredWeightSumsImage;
 
+	// Used only by the compact layout, m_samplesStatisticsImages.m_histoImage
+	// is empty in this case
+	bool m_compactHistogram;
+	std::vector<u_short> m_compactHistoBins;
+	std::vector<float> m_compactHistoScales;
+
+	// Protects the accumulated statistics from concurrent flushes
+	mutable boost::mutex m_accumulatorMutex;
+
+	mutable boost::mutex m_stagingsMutex;
+	std::vector<SamplesAccumulatorStaging *> m_stagings;
+	// Used to find the thread staging buffer, it is never reused
+	u_longlong m_stagingKey;
+
 	bool m_isValid; ///< If you call extractSamplesStatistics, the object becomes invalid and should be destroyed
 };
 
 }
 
-BOOST_CLASS_VERSION(slg::SamplesAccumulator, 1)
+BOOST_CLASS_VERSION(slg::SamplesAccumulator, 2)
 
 BOOST_CLASS_EXPORT_KEY(slg::SamplesAccumulator)
 
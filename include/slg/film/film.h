@@ -29,6 +29,7 @@
 #include <unordered_set>
 
 #include <boost/thread/mutex.hpp>
+#include <boost/atomic.hpp>
 #include <bcd/core/SamplesAccumulator.h>
 
 #include "luxrays/core/hardwaredevice.h"
@@ -143,7 +144,9 @@ public:
 		ALBEDO,
 		AVG_SHADING_NORMAL,
 		NOISE,
-		USER_IMPORTANCE
+		USER_IMPORTANCE,
+		// Not a channel, the number of channel types
+		FILM_CHANNEL_TYPE_COUNT
 	} FilmChannelType;
 	
 	typedef std::unordered_set<FilmChannelType, std::hash<int> > FilmChannels;
@@ -186,10 +189,14 @@ public:
 		SetFilm(film, 0, 0, width, height, 0, 0);
 	}
 
+	// The values of the additive channels and the sample counts of the added
+	// film are scaled by weight. The channels are added with multiple threads
+	// only if parallel is true (i.e. not when called by render threads).
 	void AddFilm(const Film &film,
 		const u_int srcOffsetX, const u_int srcOffsetY,
 		const u_int srcWidth, const u_int srcHeight,
-		const u_int dstOffsetX, const u_int dstOffsetY);
+		const u_int dstOffsetX, const u_int dstOffsetY,
+		const float weight = 1.f, const bool parallel = false);
 	void AddFilm(const Film &film) {
 		AddFilm(film, 0, 0, width, height, 0, 0);
 	}
@@ -289,6 +296,9 @@ public:
 	// Convergence can be set by external source (like TileRepository convergence test)
 	void SetConvergence(const float conv) { statsConvergence = conv; }
 	float GetConvergence() { return statsConvergence; }
+	// Incremented each time the NOISE channel is updated, it is used by the
+	// adaptive samplers to know when their data must be rebuilt
+	u_int GetNoiseChannelVersion() const { return noiseChannelVersion; }
 
 	//--------------------------------------------------------------------------
 	// Used by BCD denoiser plugin
@@ -450,6 +460,8 @@ public:
 	luxrays::HardwareDeviceKernel *mergeFinalizeKernel;
 
 	static Film *LoadSerialized(const std::string &fileName);
+	// Loads only the listed channels, the film can be used only for merging
+	static Film *LoadSerialized(const std::string &fileName, const FilmChannels &channelsFilter);
 	static void SaveSerialized(const std::string &fileName, const Film *film);
 
 	static bool GetFilmSize(const luxrays::Properties &cfg,
@@ -463,6 +475,8 @@ public:
 	static const std::string FilmChannelType2String(const FilmChannelType type);
 
 	friend class FilmDenoiser;
+	friend class FilmChunkedFile;
+	friend class FilmMerger;
 	friend class boost::serialization::access;
 
 private:
@@ -473,7 +487,16 @@ private:
 	template<class Archive>	void load(Archive &ar, const unsigned int version);
 	BOOST_SERIALIZATION_SPLIT_MEMBER()
 
+	// Used by FilmChunkedFile to serialize only the film parameters: the
+	// channels are stored in their own blocks
+	static thread_local bool serializeChannelsData;
+
 	void FreeChannels();
+	// Returns nullptr if the channel buffer doesn't exist and alloc is false
+	void *GetChannelBufferPixels(const FilmChannelType type, const u_int index,
+			size_t &size, const bool alloc);
+	const void *GetChannelBufferPixels(const FilmChannelType type, const u_int index,
+			size_t &size) const;
 	void MergeSampleBuffers(const u_int imagePipelineIndex);
 
 	void ParseRadianceGroupsScale(const luxrays::Properties &props, const u_int imagePipelineIndex,
@@ -499,7 +522,8 @@ private:
 	void AddFilmImpl(const Film &film,
 		const u_int srcOffsetX, const u_int srcOffsetY,
 		const u_int srcWidth, const u_int srcHeight,
-		const u_int dstOffsetX, const u_int dstOffsetY);
+		const u_int dstOffsetX, const u_int dstOffsetY,
+		const float weight, const bool parallel);
 
 	FilmChannels channels;
 	u_int width, height, pixelCount, radianceGroupCount;
@@ -528,6 +552,8 @@ private:
 
 	// Adaptive sampling
 	FilmNoiseEstimation *noiseEstimation;
+	// Written by the film/stats thread and read by the render threads
+	boost::atomic<u_int> noiseChannelVersion;
 
 	u_int noiseEstimationWarmUp, noiseEstimationTestStep;
 	u_int noiseEstimationFilterScale;
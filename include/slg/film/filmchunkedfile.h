@@ -0,0 +1,95 @@
+/***************************************************************************
+ * Copyright 1998-2020 by authors (see AUTHORS.txt)                        *
+ *                                                                         *
+ *   This file is part of LuxCoreRender.                                   *
+ *                                                                         *
+ * Licensed under the Apache License, Version 2.0 (the "License");         *
+ * you may not use this file except in compliance with the License.        *
+ * You may obtain a copy of the License at                                 *
+ *                                                                         *
+ *     http://www.apache.org/licenses/LICENSE-2.0                          *
+ *                                                                         *
+ * Unless required by applicable law or agreed to in writing, software     *
+ * distributed under the License is distributed on an "AS IS" BASIS,       *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.*
+ * See the License for the specific language governing permissions and     *
+ * limitations under the License.                                          *
+ ***************************************************************************/
+
+#ifndef _SLG_FILMCHUNKEDFILE_H
+#define	_SLG_FILMCHUNKEDFILE_H
+
+#include <string>
+#include <vector>
+
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include "luxrays/luxrays.h"
+#include "slg/film/film.h"
+
+namespace slg {
+
+//------------------------------------------------------------------------------
+// FilmChunkedFile
+//
+// The serialized film container. The film parameters are stored in a small
+// Boost archive while the pixels of each channel are split in blocks,
+// compressed in parallel and indexed by a channel directory. The file is
+// memory mapped so single channels can be loaded (or streamed) without
+// decompressing the rest of the film.
+//------------------------------------------------------------------------------
+
+class FilmChunkedFile {
+public:
+	FilmChunkedFile(const std::string &fileName);
+	~FilmChunkedFile();
+
+	u_int GetWidth() const { return filmWidth; }
+	u_int GetHeight() const { return filmHeight; }
+
+	// Loads the film with all channels if channelsFilter is nullptr, otherwise
+	// only with the listed channels
+	Film *LoadFilm(const Film::FilmChannels *channelsFilter = nullptr) const;
+
+	// Used to stream the channels of the film, one at time
+	bool HasChannelBuffer(const Film::FilmChannelType type, const u_int index) const;
+	size_t GetChannelBufferSize(const Film::FilmChannelType type, const u_int index) const;
+	void ReadChannelBuffer(const Film::FilmChannelType type, const u_int index,
+			void *pixels, const size_t size) const;
+
+	// Used to stream a channel block by block. ReadChannelBlock() returns the
+	// offset, in bytes, of the block inside the channel buffer.
+	u_int GetChannelBlockCount(const Film::FilmChannelType type, const u_int index) const;
+	size_t ReadChannelBlock(const Film::FilmChannelType type, const u_int index,
+			const u_int block, std::vector<char> &buffer) const;
+
+	static bool IsChunkedFile(const std::string &fileName);
+	static void Save(const std::string &fileName, const Film &film);
+
+private:
+	struct ChannelInfo {
+		u_int type, index;
+		u_longlong size;
+		u_int firstBlock, blockCount;
+	};
+
+	struct BlockInfo {
+		u_longlong offset;
+		u_int size, storedSize;
+		u_int compressed, pad;
+	};
+
+	const ChannelInfo *GetChannelInfo(const Film::FilmChannelType type, const u_int index) const;
+
+	std::string fileName;
+	boost::iostreams::mapped_file_source file;
+
+	u_int filmWidth, filmHeight;
+	u_longlong metadataOffset, metadataSize;
+	std::vector<ChannelInfo> channelInfos;
+	std::vector<BlockInfo> blockInfos;
+};
+
+}
+
+#endif	/* _SLG_FILMCHUNKEDFILE_H */
@@ -0,0 +1,83 @@
+/***************************************************************************
+ * Copyright 1998-2020 by authors (see AUTHORS.txt)                        *
+ *                                                                         *
+ *   This file is part of LuxCoreRender.                                   *
+ *                                                                         *
+ * Licensed under the Apache License, Version 2.0 (the "License");         *
+ * you may not use this file except in compliance with the License.        *
+ * You may obtain a copy of the License at                                 *
+ *                                                                         *
+ *     http://www.apache.org/licenses/LICENSE-2.0                          *
+ *                                                                         *
+ * Unless required by applicable law or agreed to in writing, software     *
+ * distributed under the License is distributed on an "AS IS" BASIS,       *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.*
+ * See the License for the specific language governing permissions and     *
+ * limitations under the License.                                          *
+ ***************************************************************************/
+
+#ifndef _SLG_FILMMERGER_H
+#define	_SLG_FILMMERGER_H
+
+#include <string>
+#include <vector>
+
+#include "luxrays/luxrays.h"
+#include "slg/film/film.h"
+
+namespace slg {
+
+class FilmChunkedFile;
+
+//------------------------------------------------------------------------------
+// FilmMerger
+//
+// Merges serialized films without loading them in memory all at once. The
+// additive channels of films saved in the chunked format are streamed one
+// compressed block at time and directly added to the destination film.
+//------------------------------------------------------------------------------
+
+class FilmMerger {
+public:
+	// The values of the additive channels and the sample counts of the
+	// serialized film are scaled by weight, like in Film::AddFilm()
+	static void AddFilm(Film &dstFilm, const std::string &fileName,
+			const u_int srcOffsetX, const u_int srcOffsetY,
+			const u_int srcWidth, const u_int srcHeight,
+			const u_int dstOffsetX, const u_int dstOffsetY,
+			const float weight = 1.f);
+	static void AddFilm(Film &dstFilm, const std::string &fileName,
+			const float weight = 1.f);
+
+	// The first film is used as base of the merge. The weights vector can be
+	// empty or must have the same size of fileNames.
+	static Film *Merge(const std::vector<std::string> &fileNames,
+			const std::vector<float> &weights);
+
+	static void ScaleFilm(Film &film, const float weight);
+
+	// Clips the width and height of a region to add to the source and
+	// destination film sizes. Returns false if there is nothing to add.
+	static bool ClipRegion(const u_int srcFilmWidth, const u_int srcFilmHeight,
+			const u_int dstFilmWidth, const u_int dstFilmHeight,
+			const u_int srcOffsetX, const u_int srcOffsetY,
+			const u_int dstOffsetX, const u_int dstOffsetY,
+			u_int *srcWidth, u_int *srcHeight);
+
+private:
+	static void AddChunkedFilm(Film &dstFilm, const FilmChunkedFile &srcFile,
+			const u_int srcOffsetX, const u_int srcOffsetY,
+			const u_int srcWidth, const u_int srcHeight,
+			const u_int dstOffsetX, const u_int dstOffsetY,
+			const float weight);
+	template<class T> static void AddChannel(Film &dstFilm, const FilmChunkedFile &srcFile,
+			const Film::FilmChannelType type, const u_int dstIndex, const u_int srcIndex,
+			const u_int srcOffsetX, const u_int srcOffsetY,
+			const u_int srcWidth, const u_int srcHeight,
+			const u_int dstOffsetX, const u_int dstOffsetY,
+			const float weight);
+};
+
+}
+
+#endif	/* _SLG_FILMMERGER_H */
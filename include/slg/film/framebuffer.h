@@ -47,6 +47,61 @@ public:
 	const T *GetPixels() const { return &pixels[0]; }
 	T *GetPixels() { return &pixels[0]; }
 
+	//--------------------------------------------------------------------------
+	// Buffer Ops
+	//--------------------------------------------------------------------------
+
+	// Adds count values scaled by weight, written to be auto-vectorized
+	static void AddValues(T *dst, const T *src, const size_t count, const float weight = 1.f) {
+		if (weight == 1.f) {
+			for (size_t i = 0; i < count; ++i)
+				dst[i] += src[i];
+		} else {
+			for (size_t i = 0; i < count; ++i)
+				dst[i] += (T)(src[i] * weight);
+		}
+	}
+
+	static void ScaleValues(T *dst, const size_t count, const float weight) {
+		for (size_t i = 0; i < count; ++i)
+			dst[i] = (T)(dst[i] * weight);
+	}
+
+	// Adds (or copies if overwrite is true) a region of another frame buffer,
+	// one row at time. The rows are processed with multiple threads only if
+	// parallel is true: it is called by render threads too (i.e. to merge
+	// tiles) where an OpenMP team would only compete with other threads.
+	template<bool overwrite> void AddFrameBuffer(const GenericFrameBuffer<CHANNELS, WEIGHT_CHANNELS, T> &src,
+			const u_int srcOffsetX, const u_int srcOffsetY,
+			const u_int srcWidth, const u_int srcHeight,
+			const u_int dstOffsetX, const u_int dstOffsetY,
+			const float weight = 1.f, const bool parallel = false) {
+		assert (srcOffsetX + srcWidth <= src.width);
+		assert (srcOffsetY + srcHeight <= src.height);
+		assert (dstOffsetX + srcWidth <= width);
+		assert (dstOffsetY + srcHeight <= height);
+
+		const size_t rowCount = srcWidth * CHANNELS;
+
+		#pragma omp parallel for if (parallel)
+		for (
+				// Visual C++ 2013 supports only OpenMP 2.5
+#if _OPENMP >= 200805
+				unsigned
+#endif
+				int y = 0; y < srcHeight; ++y) {
+			const T *srcRow = &src.pixels[((srcOffsetY + y) * (size_t)src.width + srcOffsetX) * CHANNELS];
+			T *dstRow = &pixels[((dstOffsetY + y) * (size_t)width + dstOffsetX) * CHANNELS];
+
+			if (overwrite) {
+				std::copy(srcRow, srcRow + rowCount, dstRow);
+				if (weight != 1.f)
+					ScaleValues(dstRow, rowCount, weight);
+			} else
+				AddValues(dstRow, srcRow, rowCount, weight);
+		}
+	}
+
 	//--------------------------------------------------------------------------
 	// Normal Ops
 	//--------------------------------------------------------------------------
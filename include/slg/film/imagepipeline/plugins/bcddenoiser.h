@@ -19,6 +19,8 @@
 #ifndef _SLG_BCD_DENOISER_PLUGIN_H
 #define	_SLG_BCD_DENOISER_PLUGIN_H
 
+#include <vector>
+
 #include <bcd/core/SamplesAccumulator.h>
 
 #include "luxrays/utils/serializationutils.h"
@@ -44,7 +46,8 @@ public:
 			const int scales,
 			const bool applyDenoiseVal,
 			const bool filterSpikes,
-			const float prefilterThresholdStDevFactor);
+			const float prefilterThresholdStDevFactor,
+			const u_int tileSize);
 	virtual ~BCDDenoiserPlugin();
 
 	float GetWarmUpSPP() const { return warmUpSamplesPerPixel; }
@@ -54,6 +57,20 @@ public:
 
 	virtual void Apply(Film &film, const u_int index);
 
+	// A tile of the image and the region, the tile plus a margin, denoised
+	// to compute it. They are in BCD line/column coordinates.
+	typedef struct {
+		u_int regionLine, regionColumn, regionWidth, regionHeight;
+		u_int tileLine, tileColumn, tileWidth, tileHeight;
+	} Tile;
+
+	// The tiles are aligned to the coarsest scale pixels and the margin covers
+	// the patches and the search window at that scale, so the tiled result is
+	// the same of the one obtained by denoising the whole image at once
+	static void GetTiles(const u_int width, const u_int height, const u_int tileSize,
+			const int patchRadius, const int searchWindowRadius, const int scales,
+			std::vector<Tile> &tiles);
+
 	friend class boost::serialization::access;
 
 private:
@@ -61,7 +78,7 @@ private:
 	BCDDenoiserPlugin();
 
 	void CopyOutputToFilm(const Film &film, const u_int index,
-		const bcd::DeepImage<float> &outputImg) const;
+		const bcd::DeepImage<float> &outputImg, const Tile &tile) const;
 
 	template<class Archive> void serialize(Archive &ar, const u_int version) {
 		ar & BOOST_SERIALIZATION_BASE_OBJECT_NVP(ImagePipelinePlugin);
@@ -83,9 +100,14 @@ private:
 		ar & histogramParams.m_gamma;
 		ar & histogramParams.m_maxValue;
 		ar & histogramParams.m_nbOfBins;
+
+		if (version >= 6)
+			ar & tileSize;
 	}
 
 	void Apply(Film &film, const u_int index, const bool pixelNormalizedSampleAccumulator);
+	bool ApplyTile(Film &film, const u_int index, const bool pixelNormalizedSampleAccumulator,
+		const Tile &tile);
 
 	float warmUpSamplesPerPixel;
 	float histogramDistanceThreshold;
@@ -98,13 +120,16 @@ private:
 	int scales;
 	bool filterSpikes, applyDenoise;
 	float prefilterThresholdStDevFactor;
+	// The denoiser runs on tiles of this size to bound the memory usage, 0
+	// means the whole image at once
+	u_int tileSize;
 
 	bcd::HistogramParameters histogramParams;
 };
 
 }
 
-BOOST_CLASS_VERSION(slg::BCDDenoiserPlugin, 5)
+BOOST_CLASS_VERSION(slg::BCDDenoiserPlugin, 6)
 
 BOOST_CLASS_EXPORT_KEY(slg::BCDDenoiserPlugin)
 
@@ -37,7 +37,7 @@ namespace ocl {
 
 class SampleResult {
 public:
-	SampleResult() : useFilmSplat(true), channels(nullptr) { }
+	SampleResult() : useFilmSplat(true), channelsMask(0) { }
 	SampleResult(const Film::FilmChannels *channels, const u_int radianceGroupCount) {
 		Init(channels, radianceGroupCount);
 	}
@@ -45,7 +45,8 @@ public:
 
 	void Init(const Film::FilmChannels *channels, const u_int radianceGroupCount);
 
-	bool HasChannel(const Film::FilmChannelType type) const { return channels->count(type) > 0; }
+	// Called for each AOV of each sample so it uses the mask and not the set
+	bool HasChannel(const Film::FilmChannelType type) const { return (channelsMask & (1ull << type)) != 0; }
 
 	luxrays::Spectrum GetSpectrum(const std::vector<RadianceChannelScale> &radianceChannelScales) const;
 	float GetY(const std::vector<RadianceChannelScale> &radianceChannelScales) const;
@@ -108,7 +109,8 @@ public:
 	bool useFilmSplat;
 
 private:
-	const Film::FilmChannels *channels;
+	// A bit for each Film::FilmChannelType
+	unsigned long long channelsMask;
 };
 
 }
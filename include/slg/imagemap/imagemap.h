@@ -926,6 +926,10 @@ public:
 	u_int GetHeight() const { return pixelStorage->height; }
 	const ImageMapStorage *GetStorage() const { return pixelStorage; }
 	ImageMapStorage *GetStorage() { return pixelStorage; }
+	// Incremented each time the pixels are replaced or modified (i.e. by
+	// Reload() or Resize()), it is used to know when the data derived from
+	// the image must be rebuilt
+	u_int GetPixelsVersion() const { return pixelsVersion; }
 
 	float GetFloat(const luxrays::UV &uv) const;
 	luxrays::Spectrum GetSpectrum(const luxrays::UV &uv) const;
@@ -981,7 +985,10 @@ protected:
 			const ImageMapConfig &originalImgCfg);
 		~InstrumentationInfo();
 
-		void ThreadSetUp();
+		// Must be called before starting the rendering threads
+		void SetUpThreads(const u_int threadCount);
+
+		void ThreadSetUp(const u_int threadIndex);
 		void ThreadSetSampleIndex(const InstrumentationSampleIndex index);
 		void ThreadAddSample(const luxrays::UV &uv);
 		void ThreadAccumulateSamples();
@@ -1017,9 +1024,16 @@ protected:
 			ar & enabled;
 		}
 
-		std::map<boost::thread::id, ThreadData *> threadInfo;
+		ThreadData *GetThreadData() const {
+			return (currentThreadIndex < threadInfo.size()) ? threadInfo[currentThreadIndex] : nullptr;
+		}
+
+		// Indexed by the rendering thread index, each thread allocates and
+		// uses only its own slot so no lock is required
+		std::vector<ThreadData *> threadInfo;
 
-		boost::mutex classLock;
+		// The index of the rendering thread running the instrumentation
+		static thread_local u_int currentThreadIndex;
 	};
 	
 	// Used by serialization
@@ -1038,6 +1052,7 @@ protected:
 
 	// Cached image information
 	float imageMean, imageMeanY;
+	u_int pixelsVersion;
 	
 	InstrumentationInfo *instrumentationInfo;
 };
@@ -19,12 +19,14 @@
 #ifndef _SLG_IMAGEMAPCACHE_H
 #define	_SLG_IMAGEMAPCACHE_H
 
+#include <memory>
 #include <string>
 #include <vector>
 
 #include <boost/unordered_map.hpp>
 
 #include "luxrays/devices/ocldevice.h"
+#include "luxrays/utils/mcdistribution.h"
 #include "slg/imagemap/imagemap.h"
 #include "slg/imagemap/resizepolicies/resizepolicies.h"
 #include "slg/core/sdl.h"
@@ -59,6 +61,16 @@ public:
 	u_int GetSize()const { return static_cast<u_int>(mapByKey.size()); }
 	bool IsImageMapDefined(const std::string &name) const { return mapByKey.find(name) != mapByKey.end(); }
 
+	// Importance sampling distributions built from the image maps, they are
+	// shared by all the lights using the same image map. A distribution is
+	// returned only if the image map pixels haven't changed since it was
+	// defined.
+	std::shared_ptr<const luxrays::Distribution2D> GetImageMapDistribution(const ImageMap *im,
+			const u_int width, const u_int height, const bool upperHemisphereOnly) const;
+	void DefineImageMapDistribution(const ImageMap *im,
+			const u_int width, const u_int height, const bool upperHemisphereOnly,
+			const std::shared_ptr<const luxrays::Distribution2D> &dist);
+
 	friend class Scene;
 	friend class ImageMapResizePolicy;
 	friend class ImageMapResizeMinMemPolicy;
@@ -72,6 +84,7 @@ private:
 	std::string GetCacheKey(const std::string &fileName,
 				const ImageMapConfig &imgCfg) const;
 	std::string GetCacheKey(const std::string &fileName) const;
+	void DeleteImageMapDistributions(const ImageMap *im);
 	
 	template<class Archive> void save(Archive &ar, const unsigned int version) const;
 	template<class Archive>	void load(Archive &ar, const unsigned int version);
@@ -84,6 +97,16 @@ private:
 
 	ImageMapResizePolicy *resizePolicy;
 	std::vector<bool> resizePolicyToApply;
+
+	typedef struct {
+		const ImageMap *imageMap;
+		u_int imageMapPixelsVersion;
+		u_int width, height;
+		bool upperHemisphereOnly;
+
+		std::shared_ptr<const luxrays::Distribution2D> distribution;
+	} ImageMapDistribution;
+	std::vector<ImageMapDistribution> distributions;
 };
 
 }
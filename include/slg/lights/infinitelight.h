@@ -19,6 +19,8 @@
 #ifndef _SLG_INFINITELIGHT_H
 #define	_SLG_INFINITELIGHT_H
 
+#include <memory>
+
 #include "slg/lights/light.h"
 #include "slg/lights/visibility/envlightvisibilitycache.h"
 
@@ -67,12 +69,21 @@ public:
 	const ImageMap *imageMap;
 	bool sampleUpperHemisphereOnly;
 
+	// The resolution of the importance sampling distribution, 0 is for the
+	// image map resolution up to 4096x2048
+	u_int distributionWidth, distributionHeight;
+	// Used to share the distribution with the other lights using the same
+	// image map, it can be NULL
+	ImageMapCache *imageMapCache;
+
 	// Visibility map cache options
 	ELVCParams visibilityMapCacheParams;
 	bool useVisibilityMapCache;
 
 private:
-	luxrays::Distribution2D *imageMapDistribution;
+	luxrays::Distribution2D *BuildDistribution(const u_int width, const u_int height) const;
+
+	std::shared_ptr<const luxrays::Distribution2D> imageMapDistribution;
 
 	EnvLightVisibilityCache *visibilityMapCache;
 };
@@ -82,6 +82,9 @@ public:
 	const LightStrategy *GetEmitLightStrategy() const { return emitLightStrategy; }
 	const LightStrategy *GetIlluminateLightStrategy() const { return illuminateLightStrategy; }
 	const LightStrategy *GetInfiniteLightStrategy() const { return infiniteLightStrategy; }
+	// Stop and resume any background work of the light strategies
+	void StopPreprocess();
+	void ResumePreprocess();
 
 	friend class Scene;
 
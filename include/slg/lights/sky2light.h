@@ -19,6 +19,8 @@
 #ifndef _SLG_SKY2LIGHT_H
 #define	_SLG_SKY2LIGHT_H
 
+#include <memory>
+
 #include "slg/lights/light.h"
 #include "slg/lights/visibility/envlightvisibilitycache.h"
 
@@ -28,6 +30,9 @@ namespace slg {
 // Sky2 implementation
 //------------------------------------------------------------------------------
 
+class SkyLight2BakedDistribution;
+class SkyLight2BakedRadiance;
+
 class SkyLight2 : public EnvLightSource {
 public:
 	SkyLight2();
@@ -73,6 +78,11 @@ public:
 
 	u_int distributionWidth, distributionHeight;
 
+	// Baked sky radiance table used in place of the exact evaluation of the
+	// model for the CPU rendering
+	bool useRadianceTable;
+	u_int radianceTableWidth, radianceTableHeight;
+
 	// Visibility map cache options
 	ELVCParams visibilityMapCacheParams;
 	bool useVisibilityMapCache;
@@ -82,6 +92,9 @@ private:
 	void SampleSkyDomePdf(const Scene &scene, float *directPdf, float *emissionPdf) const;
 	luxrays::Spectrum ComputeSkyRadiance(const luxrays::Vector &w) const;
 	luxrays::Spectrum ComputeRadiance(const luxrays::Vector &w) const;
+	luxrays::Spectrum ComputeExactRadiance(const luxrays::Vector &w) const;
+	void BakeDistribution(SkyLight2BakedDistribution &bakedDist) const;
+	void BakeRadianceTable(SkyLight2BakedRadiance &bakedRadiance) const;
 
 	luxrays::Vector absoluteSunDir, absoluteUpDir;
 	luxrays::Spectrum scaledGroundColor;
@@ -92,7 +105,9 @@ private:
 
 	bool isGroundBlack;
 
-	luxrays::Distribution2D *skyDistribution;
+	// Both are shared with the other SkyLight2 with the same parameters
+	std::shared_ptr<const SkyLight2BakedDistribution> skyDistribution;
+	std::shared_ptr<const SkyLight2BakedRadiance> skyRadianceTable;
 
 	EnvLightVisibilityCache *visibilityMapCache;
 };
@@ -35,35 +35,37 @@ OPENCL_FORCE_INLINE __global const DLSCacheEntry* restrict DirectLightSamplingCa
 		__global const IndexBVHArrayNode* restrict node = &dlscBVHNodes[currentNode];
 
 		const uint nodeData = node->nodeData;
-		if (IndexBVHNodeData_IsLeaf(nodeData)) {
-			// It is a leaf, check the entry
-			__global const DLSCacheEntry* restrict entry = &dlscAllEntries[node->entryLeaf.entryIndex];
+		// Check the bounding box
+		if (p.x >= node->bvhNode.bboxMin[0] && p.x <= node->bvhNode.bboxMax[0] &&
+				p.y >= node->bvhNode.bboxMin[1] && p.y <= node->bvhNode.bboxMax[1] &&
+				p.z >= node->bvhNode.bboxMin[2] && p.z <= node->bvhNode.bboxMax[2]) {
+			if (IndexBVHNodeData_IsLeaf(nodeData)) {
+				// It is a leaf, check all the entries of the bucket
+				__global const IndexBVHLeafBucket* restrict bucket = (__global const IndexBVHLeafBucket *)&dlscBVHNodes[currentNode + 1];
 
-			const float distance2 = DistanceSquared(p, VLOAD3F(&entry->p.x));
-			if ((distance2 < nearestDistance2) &&
-					(isVolume == entry->isVolume) && 
-					(isVolume ||
-					(dot(n, VLOAD3F(&entry->n.x)) > dlscNormalCosAngle)
-					)
-				) {
-				// I have found a valid nearer entry
-				nearestEntry = entry;
-				nearestDistance2 = distance2;
-			}
+				for (uint i = 0; i < INDEXBVH_LEAF_BUCKET_SIZE; ++i) {
+					const float distance2 = DistanceSquared(p, MAKE_FLOAT3(bucket->x[i], bucket->y[i], bucket->z[i]));
+					if (distance2 < nearestDistance2) {
+						const uint entryIndex = bucket->entryIndex[i];
+						__global const DLSCacheEntry* restrict entry = &dlscAllEntries[entryIndex];
 
-			++currentNode;
-		} else {
-			// It is a node, check the bounding box
-			if (p.x >= node->bvhNode.bboxMin[0] && p.x <= node->bvhNode.bboxMax[0] &&
-					p.y >= node->bvhNode.bboxMin[1] && p.y <= node->bvhNode.bboxMax[1] &&
-					p.z >= node->bvhNode.bboxMin[2] && p.z <= node->bvhNode.bboxMax[2])
+						if ((isVolume == entry->isVolume) &&
+								(isVolume ||
+								(dot(n, VLOAD3F(&entry->n.x)) > dlscNormalCosAngle)
+								)
+							) {
+							// I have found a valid nearer entry
+							nearestEntry = entry;
+							nearestDistance2 = distance2;
+						}
+					}
+				}
+
+				currentNode = IndexBVHNodeData_GetSkipIndex(nodeData);
+			} else
 				++currentNode;
-			else {
-				// I don't need to use IndexBVHNodeData_GetSkipIndex() here because
-				// I already know the leaf flag is 0
-				currentNode = nodeData;
-			}
-		}
+		} else
+			currentNode = IndexBVHNodeData_GetSkipIndex(nodeData);
 	}
 
 	return nearestEntry;
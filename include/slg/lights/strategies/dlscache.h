@@ -42,6 +42,8 @@ public:
 
 	virtual void Preprocess(const Scene *scene, const LightStrategyTask taskType,
 			const bool useRTMode);
+	virtual void StopPreprocess();
+	virtual void ResumePreprocess();
 	
 	// Used for direct light sampling
 	virtual LightSource *SampleLights(const float u,
@@ -63,6 +65,7 @@ public:
 	// Used for OpenCL data translation
 	const luxrays::Distribution1D *GetLightsDistribution() const { return distributionStrategy.GetLightsDistribution(); }
 	const DLSCBvh *GetBVH() const { return DLSCache.GetBVH(); }
+	void WaitForCacheBuild() const { DLSCache.WaitForBuild(); }
 	bool UseRTMode() const { return useRTMode; }
 	float GetEntryRadius() const { return DLSCache.GetParams().visibility.lookUpRadius; }
 	float GetEntryNormalAngle() const { return DLSCache.GetParams().visibility.lookUpNormalAngle; }
@@ -20,6 +20,9 @@
 #define	_SLG_LIGHTSTRATEGY_DLSCACHEIMPL_H
 
 #include <vector>
+#include <memory>
+#include <boost/atomic.hpp>
+#include <boost/thread.hpp>
 
 #include "luxrays/utils/mcdistribution.h"
 #include "luxrays/utils/serializationutils.h"
@@ -29,6 +32,7 @@
 #include "slg/scene/scene.h"
 #include "slg/samplers/sampler.h"
 #include "slg/utils/pathdepthinfo.h"
+#include "slg/utils/visibilitypoint.h"
 
 namespace slg {
 
@@ -37,27 +41,20 @@ namespace slg {
 //------------------------------------------------------------------------------
 
 struct DLSCVisibilityParticle {
-	DLSCVisibilityParticle(const BSDF &bsdf, const PathVolumeInfo &vi) {
+	DLSCVisibilityParticle(const Scene &scene, const BSDF &bsdf, const PathVolumeInfo &vi) {
 		p = bsdf.hitPoint.p;
 
-		Add(bsdf, vi);
-	}
-
-	void Add(const BSDF &bsdf, const PathVolumeInfo &vi) {
-		bsdfList.push_back(bsdf);
-		volInfoList.push_back(vi);
+		pointList.Add(scene, bsdf, vi);
 	}
 
 	void Add(const DLSCVisibilityParticle &part) {
-		bsdfList.insert(bsdfList.end(), part.bsdfList.begin(), part.bsdfList.end());
-		volInfoList.insert(volInfoList.end(), part.volInfoList.begin(), part.volInfoList.end());
+		pointList.Add(part.pointList);
 	}
 
 	// Field required by IndexOctree<T> class
 	luxrays::Point p;
 
-	std::vector<BSDF> bsdfList;
-	std::vector<PathVolumeInfo> volInfoList;
+	VisibilityPointList pointList;
 };
 
 //------------------------------------------------------------------------------
@@ -68,10 +65,10 @@ class DLSCacheEntry {
 public:
 	DLSCacheEntry() : lightsDistribution(nullptr) {
 	}
-	DLSCacheEntry(const BSDF &bsdf) {
-		p = bsdf.hitPoint.p;
-		n = bsdf.hitPoint.GetLandingShadeN();
-		isVolume = bsdf.IsVolume();
+	DLSCacheEntry(const VisibilityPoint &vp) {
+		p = vp.p;
+		n = vp.GetLandingShadeN();
+		isVolume = vp.IsVolume();
 
 		lightsDistribution = nullptr;
 	}
@@ -114,6 +111,8 @@ struct DLSCParams {
 		visibility.targetHitRate = .99f;
 		visibility.lookUpRadius = 0.f;
 		visibility.lookUpNormalAngle = 25.f;
+
+		progressive = false;
 	}
 
 	struct {
@@ -132,6 +131,10 @@ struct DLSCParams {
 		bool safeSave;
 	} persistent;
 
+	// If enabled, the cache entries are filled in background while the
+	// rendering starts with the plain power based light sampling
+	bool progressive;
+
 	friend class boost::serialization::access;
 
 protected:
@@ -148,6 +151,11 @@ protected:
 
 		ar & persistent.fileName;
 		ar & persistent.safeSave;
+
+		if (version >= 2)
+			ar & progressive;
+		else
+			progressive = false;
 	}
 };
 
@@ -163,6 +171,13 @@ public:
 	const DLSCBvh *GetBVH() const { return cacheEntriesBVH; }
 
 	void Build(const Scene *scene);
+	// Used to stop a progressive build (i.e. before a scene edit). The
+	// entries not yet filled keep using the power based light sampling
+	// until the build is resumed.
+	void StopBuild();
+	void ResumeBuild();
+	void WaitForBuild() const;
+	bool IsBuildInProgress() const { return buildInProgress; }
 	
 	const luxrays::Distribution1D *GetLightDistribution(const luxrays::Point &p, const luxrays::Normal &n,
 			const bool isVolume) const;
@@ -176,9 +191,14 @@ private:
 	float EvaluateBestRadius();
 	void TraceVisibilityParticles();
 	void InitCacheEntry(const u_int entryIndex);
-	void ComputeCacheEntryReceivedLuminance(const u_int entryIndex);
-	void BuildCacheEntryLightDistribution(const u_int entryIndex, const DLSCBvh &bvh);
-	void BuildCacheEntries();
+	void ComputeCacheEntryReceivedLuminance(const u_int entryIndex,
+			const u_int lightIndexStart, const u_int lightIndexEnd);
+	void BuildCacheEntryLightDistribution(const u_int entryIndex,
+			const std::vector<u_int> &allNearEntryIndices);
+	void InitCacheEntries();
+	void FillCacheEntries();
+	void FinishBuild();
+	void BuildThreadFunc();
 
 	void DebugExport(const std::string &fileName, const float sphereRadius) const;
 
@@ -195,13 +215,24 @@ private:
 	// Used during the rendering phase
 	std::vector<DLSCacheEntry> cacheEntries;
 	DLSCBvh *cacheEntriesBVH;
+
+	// Used by the progressive build
+	boost::thread *buildThread;
+	// Protects buildThread
+	mutable boost::mutex buildThreadMutex;
+	boost::atomic<bool> buildInProgress, buildStopFlag;
+	std::unique_ptr<boost::atomic<bool>[]> cacheEntriesReady;
+	// The fill progress, used to resume a stopped build
+	std::vector<u_int> fillLeafOrderEntryIndices;
+	std::vector<bool> fillReceivedLuminanceDone;
+	u_int fillNextRegionStart;
 };
 
 }
 
 BOOST_CLASS_VERSION(slg::DLSCacheEntry, 1)
-BOOST_CLASS_VERSION(slg::DLSCBvh, 1)
-BOOST_CLASS_VERSION(slg::DLSCParams, 1)
+BOOST_CLASS_VERSION(slg::DLSCBvh, 2)
+BOOST_CLASS_VERSION(slg::DLSCParams, 2)
 
 BOOST_CLASS_EXPORT_KEY(slg::DLSCacheEntry)
 BOOST_CLASS_EXPORT_KEY(slg::DLSCBvh)
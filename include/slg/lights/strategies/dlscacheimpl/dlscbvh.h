@@ -38,6 +38,10 @@ public:
 	void GetAllNearEntries(std::vector<u_int> &allNearEntryIndices,
 			const luxrays::Point &p, const luxrays::Normal &n,
 			const bool isVolume) const;
+	// Batched version of GetAllNearEntries(), the query points are the
+	// cache entries listed in queryEntryIndices
+	void GetAllNearEntries(std::vector<u_int> *allNearEntryIndices,
+			const u_int *queryEntryIndices, const u_int count) const;
 
 	// Used for OpenCL data translation
 	const std::vector<DLSCacheEntry> *GetAllEntries() const { return allEntries; }
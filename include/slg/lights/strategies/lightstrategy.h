@@ -48,6 +48,12 @@ public:
 
 	virtual void Preprocess(const Scene *scn, const LightStrategyTask taskType,
 			const bool useRTMode) = 0;
+	// Used to stop any background work started by Preprocess() (i.e. before
+	// a scene edit)
+	virtual void StopPreprocess() { }
+	// Used to resume the background work stopped by StopPreprocess() when
+	// Preprocess() has not been called again (i.e. after a camera edit)
+	virtual void ResumePreprocess() { }
 
 	// Used for direct light sampling
 	virtual LightSource *SampleLights(const float u,
@@ -40,36 +40,39 @@ OPENCL_FORCE_INLINE __global const ELVCacheEntry* restrict EnvLightVisibilityCac
 		__global const IndexBVHArrayNode* restrict node = &elvcBVHNodes[currentNode];
 
 		const uint nodeData = node->nodeData;
-		if (IndexBVHNodeData_IsLeaf(nodeData)) {
-			// It is a leaf, check the entry
-			__global const ELVCacheEntry* restrict entry = &elvcAllEntries[node->entryLeaf.entryIndex];
-
-			const float distance2 = DistanceSquared(p, VLOAD3F(&entry->p.x));
-			if ((distance2 <= nearestDistance2) &&
-					(isVolume == entry->isVolume) && 
-					(isVolume ||
-					(dot(n, VLOAD3F(&entry->n.x)) >= elvcNormalCosAngle)
-					)
-				) {
-				// I have found a valid entry
-
-				nearestEntry = entry;
-				nearestDistance2 = distance2;
-			}
+		// Check the bounding box
+		if (p.x >= node->bvhNode.bboxMin[0] && p.x <= node->bvhNode.bboxMax[0] &&
+				p.y >= node->bvhNode.bboxMin[1] && p.y <= node->bvhNode.bboxMax[1] &&
+				p.z >= node->bvhNode.bboxMin[2] && p.z <= node->bvhNode.bboxMax[2]) {
+			if (IndexBVHNodeData_IsLeaf(nodeData)) {
+				// It is a leaf, check all the entries of the bucket
+				__global const IndexBVHLeafBucket* restrict bucket = (__global const IndexBVHLeafBucket *)&elvcBVHNodes[currentNode + 1];
+
+				for (uint i = 0; i < INDEXBVH_LEAF_BUCKET_SIZE; ++i) {
+					const float distance2 = DistanceSquared(p, MAKE_FLOAT3(bucket->x[i], bucket->y[i], bucket->z[i]));
+					// The same tests of ELVCBvh::GetNearestEntry(), so
+					// PATHOCL and PATHCPU use the same entry
+					if (distance2 < nearestDistance2) {
+						const uint entryIndex = bucket->entryIndex[i];
+						__global const ELVCacheEntry* restrict entry = &elvcAllEntries[entryIndex];
+
+						if ((isVolume == entry->isVolume) &&
+								(isVolume ||
+								(dot(n, VLOAD3F(&entry->n.x)) > elvcNormalCosAngle)
+								)
+							) {
+							// I have found a valid nearer entry
+							nearestEntry = entry;
+							nearestDistance2 = distance2;
+						}
+					}
+				}
 
-			++currentNode;
-		} else {
-			// It is a node, check the bounding box
-			if (p.x >= node->bvhNode.bboxMin[0] && p.x <= node->bvhNode.bboxMax[0] &&
-					p.y >= node->bvhNode.bboxMin[1] && p.y <= node->bvhNode.bboxMax[1] &&
-					p.z >= node->bvhNode.bboxMin[2] && p.z <= node->bvhNode.bboxMax[2])
+				currentNode = IndexBVHNodeData_GetSkipIndex(nodeData);
+			} else
 				++currentNode;
-			else {
-				// I don't need to use IndexBVHNodeData_GetSkipIndex() here because
-				// I already know the leaf flag is 0
-				currentNode = nodeData;
-			}
-		}
+		} else
+			currentNode = IndexBVHNodeData_GetSkipIndex(nodeData);
 	}
 
 	return nearestEntry;
@@ -85,6 +88,89 @@ OPENCL_FORCE_INLINE __global const float* restrict EnvLightVisibilityCache_GetVi
 	return (cacheEntry && (cacheEntry->distributionOffset != NULL_INDEX)) ? &elvcDistributions[cacheEntry->distributionOffset] : NULL;
 }
 
+//------------------------------------------------------------------------------
+// Visibility map
+//
+// The layout is: the function average, the marginal CDF and the 8bit
+// visibility values packed in 32bit. The base map shared by all visibility
+// maps is at the beginning of elvcDistributions.
+//------------------------------------------------------------------------------
+
+OPENCL_FORCE_INLINE float EnvLightVisibilityCache_GetMapValue(__global const float* restrict visibilityMap,
+		const uint index
+		LIGHTS_PARAM_DECL) {
+	__global const float* restrict packedVisibility = &visibilityMap[1 + elvcTilesYCount + 1];
+	const uint visibility = (as_uint(packedVisibility[index >> 2]) >> ((index & 3) * 8)) & 0xffu;
+
+	return visibility * (1.f / 255.f) * elvcDistributions[index];
+}
+
+OPENCL_FORCE_INLINE void EnvLightVisibilityCache_SampleDiscrete(__global const float* restrict visibilityMap,
+		const float u0, const float u1, uint xy[2], float *pdf, float *du0, float *du1
+		LIGHTS_PARAM_DECL) {
+	*pdf = 0.f;
+
+	const float funcInt = visibilityMap[0];
+	__global const float* restrict marginalCDF = &visibilityMap[1];
+
+	// Pick the row
+	__global const float* restrict cdfPtr = std_upper_bound(marginalCDF, marginalCDF + elvcTilesYCount + 1, u1);
+	const uint y = clamp((int)(cdfPtr - marginalCDF) - 1, 0, (int)elvcTilesYCount - 1);
+	const float cdfDelta = marginalCDF[y + 1] - marginalCDF[y];
+	*du1 = (cdfDelta > 0.f) ? clamp((u1 - marginalCDF[y]) / cdfDelta, 0.f, 1.f) : 0.f;
+
+	// Pick the column, the row is integrated on the fly
+	const uint rowOffset = y * elvcTilesXCount;
+	float rowSum = 0.f;
+	for (uint x = 0; x < elvcTilesXCount; ++x)
+		rowSum += EnvLightVisibilityCache_GetMapValue(visibilityMap, rowOffset + x LIGHTS_PARAM);
+	if (rowSum <= 0.f)
+		return;
+
+	const float target = u0 * rowSum;
+	float sum = 0.f;
+	uint x = 0;
+	float value = 0.f;
+	bool found = false;
+	for (uint i = 0; i < elvcTilesXCount; ++i) {
+		const float v = EnvLightVisibilityCache_GetMapValue(visibilityMap, rowOffset + i LIGHTS_PARAM);
+		if (v > 0.f) {
+			x = i;
+			value = v;
+
+			if (sum + v > target) {
+				found = true;
+				break;
+			}
+		}
+
+		sum += v;
+	}
+	// Because of float rounding, I may have run past the end of the row: use
+	// the last tile with a non zero value
+	if (!found)
+		sum -= value;
+
+	xy[0] = x;
+	xy[1] = y;
+	*du0 = clamp((target - sum) / value, 0.f, 1.f);
+	*pdf = value / (funcInt * elvcTilesXCount * elvcTilesYCount);
+}
+
+OPENCL_FORCE_INLINE float EnvLightVisibilityCache_MapPdf(__global const float* restrict visibilityMap,
+		const float u, const float v, float *du, float *dv, uint *offsetU, uint *offsetV
+		LIGHTS_PARAM_DECL) {
+	const uint x = min(elvcTilesXCount - 1, Floor2UInt(u * elvcTilesXCount));
+	const uint y = min(elvcTilesYCount - 1, Floor2UInt(v * elvcTilesYCount));
+
+	*du = u * elvcTilesXCount - x;
+	*dv = v * elvcTilesYCount - y;
+	*offsetU = x;
+	*offsetV = y;
+
+	return EnvLightVisibilityCache_GetMapValue(visibilityMap, x + y * elvcTilesXCount LIGHTS_PARAM) / visibilityMap[0];
+}
+
 //------------------------------------------------------------------------------
 // Sample
 //------------------------------------------------------------------------------
@@ -99,7 +185,8 @@ OPENCL_FORCE_INLINE void EnvLightVisibilityCache_Sample(__global const BSDF *bsd
 	if (cacheDist) {
 		uint cacheDistXY[2];
 		float cacheDistPdf, du0, du1;
-		Distribution2D_SampleDiscrete(cacheDist, u0, u1, cacheDistXY, &cacheDistPdf, &du0, &du1);
+		EnvLightVisibilityCache_SampleDiscrete(cacheDist, u0, u1, cacheDistXY, &cacheDistPdf, &du0, &du1
+				LIGHTS_PARAM);
 
 		if (cacheDistPdf > 0.f) {
 			if (elvcTileDistributionOffsets) {
@@ -140,7 +227,8 @@ OPENCL_FORCE_INLINE float EnvLightVisibilityCache_Pdf(__global const BSDF *bsdf,
 	if (cacheDist) {
 		uint offsetU, offsetV;
 		float du, dv;
-		const float cacheDistPdf = Distribution2D_PdfExt(cacheDist, u, v, &du, &dv, &offsetU, &offsetV);
+		const float cacheDistPdf = EnvLightVisibilityCache_MapPdf(cacheDist, u, v, &du, &dv, &offsetU, &offsetV
+				LIGHTS_PARAM);
 
 		if (cacheDistPdf > 0.f) {
 			if (elvcTileDistributionOffsets) {
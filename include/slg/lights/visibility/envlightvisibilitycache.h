@@ -32,6 +32,7 @@
 #include "slg/samplers/metropolis.h"
 #include "slg/bsdf/bsdf.h"
 #include "slg/utils/pathdepthinfo.h"
+#include "slg/utils/visibilitypoint.h"
 
 namespace slg {
 
@@ -45,27 +46,20 @@ namespace ocl {
 //------------------------------------------------------------------------------
 
 struct ELVCVisibilityParticle {
-	ELVCVisibilityParticle(const BSDF &bsdf, const PathVolumeInfo &vi) {
+	ELVCVisibilityParticle(const Scene &scene, const BSDF &bsdf, const PathVolumeInfo &vi) {
 		p = bsdf.hitPoint.p;
 
-		Add(bsdf, vi);
-	}
-
-	void Add(const BSDF &bsdf, const PathVolumeInfo &vi) {
-		bsdfList.push_back(bsdf);
-		volInfoList.push_back(vi);
+		pointList.Add(scene, bsdf, vi);
 	}
 
 	void Add(const ELVCVisibilityParticle &part) {
-		bsdfList.insert(bsdfList.end(), part.bsdfList.begin(), part.bsdfList.end());
-		volInfoList.insert(volInfoList.end(), part.volInfoList.begin(), part.volInfoList.end());
+		pointList.Add(part.pointList);
 	}
 
 	// Field required by IndexOctree<T> class
 	luxrays::Point p;
 
-	std::vector<BSDF> bsdfList;
-	std::vector<PathVolumeInfo> volInfoList;
+	VisibilityPointList pointList;
 };
 
 class ELVCOctree : public IndexOctree<ELVCVisibilityParticle> {
@@ -83,12 +77,72 @@ private:
 			u_int &nearestEntryIndex, float &nearestDistance2) const;
 };
 
+//------------------------------------------------------------------------------
+// ELVCVisibilityMap
+//
+// A compact visibility map: the 8bit quantized visibility of each tile. The
+// sampled function is the visibility multiplied by a base map shared by all
+// cache entries (i.e. the env. light luminance at tile resolution). Only the
+// marginal CDF is stored, the rows are integrated on the fly.
+//------------------------------------------------------------------------------
+
+class ELVCVisibilityMap {
+public:
+	// Returns nullptr if the resulting function is all 0.0
+	static ELVCVisibilityMap *Create(const float *visibility, const float *baseMap,
+			const u_int width, const u_int height);
+
+	~ELVCVisibilityMap() { }
+
+	// The pdf is the discrete one (i.e. the probability to pick the tile)
+	void SampleDiscrete(const float *baseMap, const float u0, const float u1,
+			u_int xy[2], float *pdf, float *du0, float *du1) const;
+	// The pdf is the continuous one over [0, 1)x[0, 1)
+	float Pdf(const float *baseMap, const float u, const float v,
+			float *du, float *dv, u_int *offsetU, u_int *offsetV) const;
+
+	size_t GetMemoryUsage() const {
+		return sizeof(ELVCVisibilityMap) + visibility.size() * sizeof(u_char) +
+				marginalCDF.size() * sizeof(float);
+	}
+
+	// Used for OpenCL data translation
+	float GetAverage() const { return funcInt; }
+	const std::vector<float> &GetMarginalCDF() const { return marginalCDF; }
+	const std::vector<u_char> &GetVisibility() const { return visibility; }
+
+	friend class boost::serialization::access;
+
+private:
+	// Used by serialization
+	ELVCVisibilityMap() { }
+
+	float GetValue(const float *baseMap, const u_int index) const {
+		return visibility[index] * (1.f / 255.f) * baseMap[index];
+	}
+
+	template<class Archive> void serialize(Archive &ar, const u_int version) {
+		ar & width;
+		ar & height;
+		ar & funcInt;
+		ar & visibility;
+		ar & marginalCDF;
+	}
+
+	u_int width, height;
+	// The average of the function
+	float funcInt;
+	std::vector<u_char> visibility;
+	// The normalized CDF of the row integrals
+	std::vector<float> marginalCDF;
+};
+
 class ELVCacheEntry {
 public:
 	ELVCacheEntry() : visibilityMap(nullptr) {
 	}
 	ELVCacheEntry(const luxrays::Point &pt, const luxrays::Normal &nm,
-		const bool isVol, luxrays::Distribution2D *vm) :
+		const bool isVol, ELVCVisibilityMap *vm) :
 			p(pt), n(nm), isVolume(isVol), visibilityMap(vm) {
 	}
 	
@@ -102,7 +156,7 @@ public:
 	bool isVolume;
 
 	// Cache information
-	luxrays::Distribution2D *visibilityMap;
+	ELVCVisibilityMap *visibilityMap;
 	
 	friend class boost::serialization::access;
 	
@@ -215,6 +269,7 @@ public:
 	const ELVCBvh *GetBVH() const { return cacheEntriesBVH; }
 	const u_int GetXTileCount() const { return tilesXCount; }
 	const u_int GetYTileCount() const { return tilesYCount; }
+	const std::vector<float> &GetBaseMap() const { return baseMap; }
 	bool HasTileDistributions() const { return (tileDistributions.size() > 0);}
 	const luxrays::Distribution2D *GetTileDistribution(const u_int index) const {
 		return tileDistributions[index];
@@ -238,11 +293,11 @@ private:
 
 	float EvaluateBestRadius();
 	void TraceVisibilityParticles();
-	void BuildCacheEntry(const u_int entryIndex, const ImageMap *luminanceMapImageScaled);
+	void BuildCacheEntry(const u_int entryIndex);
 	void BuildCacheEntries();
 	void BuildTileDistributions();
 
-	const luxrays::Distribution2D *GetVisibilityMap(const BSDF &bsdf) const;
+	const ELVCVisibilityMap *GetVisibilityMap(const BSDF &bsdf) const;
 
 	void LoadPersistentCache(const std::string &fileName);
 	void SavePersistentCache(const std::string &fileName);
@@ -261,15 +316,19 @@ private:
 	ELVCBvh *cacheEntriesBVH;
 	u_int mapWidth, mapHeight;
 	u_int tilesXCount, tilesYCount;
+	// The function shared by all visibility maps
+	std::vector<float> baseMap;
 	std::vector<luxrays::Distribution2D *> tileDistributions;
 };
 
 }
 
-BOOST_CLASS_VERSION(slg::ELVCacheEntry, 1)
-BOOST_CLASS_VERSION(slg::ELVCBvh, 1)
+BOOST_CLASS_VERSION(slg::ELVCVisibilityMap, 1)
+BOOST_CLASS_VERSION(slg::ELVCacheEntry, 2)
+BOOST_CLASS_VERSION(slg::ELVCBvh, 2)
 BOOST_CLASS_VERSION(slg::ELVCParams, 4)
 
+BOOST_CLASS_EXPORT_KEY(slg::ELVCVisibilityMap)
 BOOST_CLASS_EXPORT_KEY(slg::ELVCacheEntry)
 BOOST_CLASS_EXPORT_KEY(slg::ELVCBvh)
 BOOST_CLASS_EXPORT_KEY(slg::ELVCParams)
@@ -19,8 +19,14 @@
 #ifndef _SLG_SOBOL_SAMPLER_H
 #define	_SLG_SOBOL_SAMPLER_H
 
+#include <memory>
+
+#include <boost/atomic.hpp>
+#include <boost/thread/mutex.hpp>
+
 #include "luxrays/core/randomgen.h"
 #include "luxrays/utils/atomic.h"
+#include "luxrays/utils/mcdistribution.h"
 
 #include "slg/slg.h"
 #include "slg/film/film.h"
@@ -29,6 +35,39 @@
 
 namespace slg {
 
+//------------------------------------------------------------------------------
+// SobolAdaptiveDistribution
+//
+// The importance distribution used by adaptive sampling. It is built from the
+// NOISE and USER_IMPORTANCE channels: buckets are drawn in proportion of
+// their importance and pixels inside a bucket in proportion of the pixel
+// importance, so no pixel has to be rejected.
+//------------------------------------------------------------------------------
+
+class SobolAdaptiveDistribution {
+public:
+	SobolAdaptiveDistribution(const Film *film, const u_int *filmSubRegion,
+			const u_int bucketSize, const u_int tileSize,
+			const float adaptiveStrength, const float adaptiveUserImportanceWeight);
+	~SobolAdaptiveDistribution();
+
+	// True if all pixels have the same importance
+	bool IsUniform() const { return !bucketDistribution; }
+
+	// Returns the index of a group of bucketSize pixels
+	u_int SampleBucket(const float u) const;
+	// Returns the offset of a pixel inside the group
+	u_int SamplePixel(const u_int pixelBucketIndex, const float u) const;
+
+private:
+	u_int bucketSize;
+
+	// Pixel importance in bucket order, 0 for the pixels out of the film
+	// sub region
+	std::vector<float> pixelImportance;
+	luxrays::Distribution1D *bucketDistribution;
+};
+
 //------------------------------------------------------------------------------
 // SobolSamplerSharedData
 //
@@ -44,7 +83,18 @@ public:
 	virtual void Reset();
 
 	void GetNewBucket(const u_int bucketCount, u_int *bucketIndex, u_int *seed);
+	u_int GetBucketSeed(const u_int bucketIndex) const;
 	u_int GetNewPixelPass(const u_int pixelIndex = 0);
+
+	// The adaptive sampling distribution is rebuilt by one of the render
+	// threads at the start of a pass, only if the film NOISE channel has been
+	// updated since the last build. The others keep using the previous one in
+	// the meantime.
+	u_int GetAdaptiveDistributionVersion() const { return adaptiveDistributionVersion; }
+	std::shared_ptr<const SobolAdaptiveDistribution> GetAdaptiveDistribution(u_int *version);
+	bool IsAdaptiveDistributionOutdated();
+	void SetAdaptiveDistribution(const std::shared_ptr<const SobolAdaptiveDistribution> &dist,
+			const u_int noiseChannelVersion);
 	
 	u_int GetPassCount(const u_int bucketCount) const;
 	
@@ -61,6 +111,11 @@ private:
 	// Holds the current pass for each pixel when using adaptive sampling
 	std::vector<u_int> passPerPixel;
 
+	boost::mutex adaptiveDistributionMutex;
+	std::shared_ptr<const SobolAdaptiveDistribution> adaptiveDistribution;
+	boost::atomic<u_int> adaptiveDistributionVersion;
+	// The film NOISE channel version used to build adaptiveDistribution
+	u_int adaptiveDistributionNoiseVersion;
 };
 
 //------------------------------------------------------------------------------
@@ -75,7 +130,8 @@ public:
 			const FilmSampleSplatter *flmSplatter, const bool imgSamplesEnable,
 			const float adaptiveStr, const float adaptiveUserImpWeight,
 			const u_int bucketSize, const u_int tileSize, const u_int superSampling,
-			const u_int overlapping, SobolSamplerSharedData *samplerSharedData);
+			const u_int overlapping, const bool owenScrambling,
+			SobolSamplerSharedData *samplerSharedData);
 	virtual ~SobolSampler();
 
 	virtual SamplerType GetType() const { return GetObjectType(); }
@@ -103,6 +159,7 @@ public:
 
 private:
 	void InitNewSample();
+	void InitNewBucket(const u_int bucketCount, const u_int *filmSubRegion);
 	float GetSobolSample(const u_int index);
 
 	static const luxrays::Properties &GetDefaultProps();
@@ -115,6 +172,17 @@ private:
 	u_int bucketIndex, pixelOffset, passOffset, pass;
 	luxrays::TauswortheRandomGenerator rngGenerator;
 
+	// Adaptive sampling
+	std::shared_ptr<const SobolAdaptiveDistribution> adaptiveDistribution;
+	u_int adaptiveDistributionVersion;
+	// If the current bucket has been drawn from the importance distribution,
+	// the pixel of the bucket currently sampled and the rng0, rng1 and rngPass
+	// values of each sub-sample of each pixel of the bucket
+	bool adaptiveBucket;
+	u_int adaptivePixelOffset;
+	std::vector<float> bucketRng0, bucketRng1;
+	std::vector<u_int> bucketRngPass;
+
 	float sample0, sample1;
 };
 
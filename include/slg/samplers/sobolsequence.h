@@ -28,8 +28,18 @@ namespace slg {
 
 //------------------------------------------------------------------------------
 // SobolSequence
+//
+// All the dimensions of a pass are generated in one go, the first time one of
+// them is requested, with a table driven matrix multiplication: the index is
+// split in 4 bits digits and each digit selects a pre-computed XOR of 4
+// direction vectors. Tables are stored dimension-minor so the loop over the
+// dimensions runs over contiguous memory and is vectorized by the compiler.
 //------------------------------------------------------------------------------
 
+#define SOBOL_TABLE_DIGIT_BITS 4
+#define SOBOL_TABLE_DIGIT_VALUES (1u << SOBOL_TABLE_DIGIT_BITS)
+#define SOBOL_TABLE_DIGITS (SOBOL_BITS / SOBOL_TABLE_DIGIT_BITS)
+
 class SobolSequence {
 public:
 	SobolSequence();
@@ -38,14 +48,30 @@ public:
 	void RequestSamples(const u_int size);
 	float GetSample(const u_int pass, const u_int index);
 
+	// Generates the not scrambled values of all dimensions of a Sobol index
+	void GenerateSamples(const u_int index, u_int *values) const;
+	// The original one dimension at time version, used by the benchmark
+	u_int SobolDimension(const u_int index, const u_int dimension) const;
+
 	u_int rngPass;
 	float rng0, rng1;
 
+	// If enabled, hashed Owen scrambling is used instead of Cranley-Patterson
+	// rotation
+	bool owenScrambling;
+
 	static void GenerateDirectionVectors(u_int *vectors, const u_int dimensions);
-private:
-	u_int SobolDimension(const u_int index, const u_int dimension) const;
 
+private:
+	u_int dimensionCount;
 	u_int *directions;
+	// directionTables[(digit * SOBOL_TABLE_DIGIT_VALUES + value) * dimensionCount + dimension]
+	u_int *directionTables;
+
+	// The values of all dimensions of the last generated index
+	u_int *values;
+	u_int valuesIndex;
+	bool valuesValid;
 };
 
 }
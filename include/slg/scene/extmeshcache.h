@@ -62,6 +62,11 @@ public:
 	u_int GetExtMeshIndex(const std::string &meshName) const;
 	u_int GetExtMeshIndex(const luxrays::ExtMesh *m) const;
 
+	// Memory used by the attributes of all ExtTriangleMesh, with and without
+	// the compression of vertex attributes
+	size_t GetMemoryUsage() const;
+	size_t GetUncompressedMemoryUsage() const;
+
 	std::string GetRealFileName(const luxrays::ExtMesh *m) const;
 	std::string GetSequenceFileName(const luxrays::ExtMesh *m) const;
 
@@ -37,6 +37,7 @@
 #include "slg/lights/light.h"
 #include "slg/lights/lightsourcedefs.h"
 #include "slg/shapes/strands.h"
+#include "slg/shapes/shapecache.h"
 #include "slg/textures/texture.h"
 #include "slg/textures/texturedefs.h"
 #include "slg/textures/mapping/mapping.h"
@@ -73,6 +74,28 @@ typedef enum {
 // Note: keep aligned with the copy in scene_types.cl
 typedef int SceneRayType;
 
+// How a scene object is handled by the shadow ray occlusion query
+typedef enum {
+	// Always an occluder, the BSDF is never initialized
+	SHADOW_OPAQUE,
+	// Only the pass-through transparency has to be evaluated
+	SHADOW_PASSTHROUGH,
+	// Volumes, bevel edges or shadow transparency, it requires the complete
+	// Scene::Intersect() loop
+	SHADOW_COMPLEX
+} SceneObjectShadowType;
+
+// The time spent in the phases of the last Scene::Preprocess(), a phase
+// skipped because nothing has changed takes 0 secs
+typedef struct {
+	// Meshes preprocessing and DataSet update. The accelerators are built
+	// later, when the devices start, and their time is reported apart as
+	// stats.dataset.accelerators.time
+	double dataSetTime;
+	double lightsTime; // Including the light visibility caches
+	double imageMapsTime;
+} ScenePreprocessTimes;
+
 class SampleResult;
 
 class Scene {
@@ -89,6 +112,7 @@ public:
 		SampleResult *sampleResult = nullptr, const bool backTracing = false) const;
 
 	void PreprocessCamera(const u_int filmWidth, const u_int filmHeight, const u_int *filmSubRegion);
+	void PreprocessObjectShadowTypes();
 	void Preprocess(luxrays::Context *ctx,
 		const u_int filmWidth, const u_int filmHeight, const u_int *filmSubRegion,
 		const bool useRTMode);
@@ -172,6 +196,7 @@ public:
 
 	ExtMeshCache extMeshCache; // Mesh objects cache
 	ImageMapCache imgMapCache; // Image maps cache
+	ShapeCache shapeCache; // Persistent cache of preprocessed shapes
 
 	TextureDefinitions texDefs; // Texture definitions
 	MaterialDefinitions matDefs; // Material definitions
@@ -179,8 +204,12 @@ public:
 	LightSourceDefinitions lightDefs; // LightSource definitions
 
 	luxrays::DataSet *dataSet;
+	// Indexed by scene object, it is updated by Preprocess()
+	std::vector<SceneObjectShadowType> objShadowTypes;
 	// The bounding sphere of the scene (including the camera)
 	luxrays::BSphere sceneBSphere;
+	// It is updated by Preprocess()
+	ScenePreprocessTimes preprocessTimes;
 
 	EditActionList editActions;
 
@@ -0,0 +1,74 @@
+/***************************************************************************
+ * Copyright 1998-2020 by authors (see AUTHORS.txt)                        *
+ *                                                                         *
+ *   This file is part of LuxCoreRender.                                   *
+ *                                                                         *
+ * Licensed under the Apache License, Version 2.0 (the "License");         *
+ * you may not use this file except in compliance with the License.        *
+ * You may obtain a copy of the License at                                 *
+ *                                                                         *
+ *     http://www.apache.org/licenses/LICENSE-2.0                          *
+ *                                                                         *
+ * Unless required by applicable law or agreed to in writing, software     *
+ * distributed under the License is distributed on an "AS IS" BASIS,       *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.*
+ * See the License for the specific language governing permissions and     *
+ * limitations under the License.                                          *
+ ***************************************************************************/
+
+#ifndef _SLG_SHAPECACHE_H
+#define	_SLG_SHAPECACHE_H
+
+#include <string>
+
+#include "luxrays/luxrays.h"
+#include "luxrays/utils/properties.h"
+
+namespace luxrays {
+	class ExtTriangleMesh;
+}
+
+namespace slg {
+
+class Scene;
+
+//------------------------------------------------------------------------------
+// ShapeCache
+//
+// A persistent, content addressed, on-disk cache of the meshes produced by
+// the expensive shape modifiers (subdiv, displacement, simplify and
+// pointiness). The key is a hash of the source mesh data, of the modifier
+// parameters and of anything else the result depends on (textures, image
+// maps, camera). Meshes are stored in a flat binary layout that can be
+// directly memory mapped. It is configured by the scene.shapecache.* scene
+// properties.
+//------------------------------------------------------------------------------
+
+class ShapeCache {
+public:
+	ShapeCache();
+	~ShapeCache();
+
+	void Init(const luxrays::Properties &cfg);
+	bool IsEnabled() const { return enabled; }
+
+	// Returns an empty string if the shape type can not be cached
+	std::string GetKey(Scene *scene, const std::string &shapeType,
+			const std::string &propName, const luxrays::Properties &props) const;
+
+	// Returns nullptr if the mesh is not available in the cache
+	luxrays::ExtTriangleMesh *Load(const std::string &key) const;
+	void Save(const std::string &key, const luxrays::ExtTriangleMesh *mesh) const;
+
+	static bool IsCacheable(const std::string &shapeType);
+
+private:
+	std::string GetFileName(const std::string &key) const;
+
+	std::string path;
+	bool enabled;
+};
+
+}
+
+#endif	/* _SLG_SHAPECACHE_H */
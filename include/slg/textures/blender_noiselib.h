@@ -84,6 +84,19 @@ void cellNoiseV(float x, float y, float z, float *ca);
 
 float newPerlin(float x, float y, float z);
 
+/* batched versions: evaluate count points stored as separated x, y, z arrays,
+   in packets of 16/8/4 points. The results are the same of the scalar code,
+   aside from the rounding differences introduced when the compiler contracts
+   multiply and add in FMA instructions in a different way. They are not used
+   by the renderer yet: there is no batched texture evaluation path. */
+void newPerlin(const u_int count, const float *x, const float *y, const float *z, float *result);
+/* only ACTUAL_DISTANCE metric, any of the F1-F4 output arrays can be NULL */
+void voronoi(const u_int count, const float *x, const float *y, const float *z,
+		float *f1, float *f2, float *f3, float *f4);
+void cellNoise(const u_int count, const float *x, const float *y, const float *z, float *result);
+void BLI_gNoise(float noisesize, const u_int count, const float *x, const float *y, const float *z,
+		int hard, BlenderNoiseBasis noisebasis, float *result);
+
 } // namespace blender
 
 } // namespace slg
@@ -38,6 +38,7 @@
 #include "slg/imagemap/imagemapcache.h"
 #include "slg/textures/mapping/mapping.h"
 #include "slg/bsdf/hitpoint.h"
+#include "slg/textures/texturevaluecache.h"
 
 namespace slg {
 
@@ -99,8 +100,49 @@ public:
 	}
 
 	virtual luxrays::Properties ToProperties(const ImageMapCache &imgMapCache, const bool useRealFileName) const = 0;
+
+	// Like GetFloatValue() and GetSpectrumValue() but the value is looked up
+	// in the hit point texture value cache, if available. Used by materials.
+	float GetCachedFloatValue(const HitPoint &hitPoint) const;
+	luxrays::Spectrum GetCachedSpectrumValue(const HitPoint &hitPoint) const;
+
+private:
+	bool IsConstant() const {
+		const TextureType type = GetType();
+		return (type == CONST_FLOAT) || (type == CONST_FLOAT3);
+	}
 };
 
+inline float Texture::GetCachedFloatValue(const HitPoint &hitPoint) const {
+	// Constant textures are cheaper than a cache look up
+	if (!hitPoint.texValueCache || IsConstant())
+		return GetFloatValue(hitPoint);
+
+	const luxrays::Spectrum *cachedValue = hitPoint.texValueCache->Find(this, false);
+	if (cachedValue)
+		return cachedValue->c[0];
+
+	const float value = GetFloatValue(hitPoint);
+	hitPoint.texValueCache->Add(this, false, luxrays::Spectrum(value));
+
+	return value;
+}
+
+inline luxrays::Spectrum Texture::GetCachedSpectrumValue(const HitPoint &hitPoint) const {
+	// Constant textures are cheaper than a cache look up
+	if (!hitPoint.texValueCache || IsConstant())
+		return GetSpectrumValue(hitPoint);
+
+	const luxrays::Spectrum *cachedValue = hitPoint.texValueCache->Find(this, true);
+	if (cachedValue)
+		return *cachedValue;
+
+	const luxrays::Spectrum value = GetSpectrumValue(hitPoint);
+	hitPoint.texValueCache->Add(this, true, value);
+
+	return value;
+}
+
 //------------------------------------------------------------------------------
 // Texture utility functions
 //------------------------------------------------------------------------------
@@ -0,0 +1,85 @@
+/***************************************************************************
+ * Copyright 1998-2020 by authors (see AUTHORS.txt)                        *
+ *                                                                         *
+ *   This file is part of LuxCoreRender.                                   *
+ *                                                                         *
+ * Licensed under the Apache License, Version 2.0 (the "License");         *
+ * you may not use this file except in compliance with the License.        *
+ * You may obtain a copy of the License at                                 *
+ *                                                                         *
+ *     http://www.apache.org/licenses/LICENSE-2.0                          *
+ *                                                                         *
+ * Unless required by applicable law or agreed to in writing, software     *
+ * distributed under the License is distributed on an "AS IS" BASIS,       *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.*
+ * See the License for the specific language governing permissions and     *
+ * limitations under the License.                                          *
+ ***************************************************************************/
+
+#ifndef _SLG_TEXTUREVALUECACHE_H
+#define	_SLG_TEXTUREVALUECACHE_H
+
+#include "luxrays/luxrays.h"
+#include "luxrays/core/color/color.h"
+
+namespace slg {
+
+class Texture;
+
+//------------------------------------------------------------------------------
+// TextureValueCache
+//
+// A small flat cache of the texture values evaluated by the material of a
+// shading point, so Evaluate(), Sample() and Pdf() pay each texture input
+// only once. It is owned by the rendering thread and enabled with
+// BSDF::SetTextureValueCache(). Material::Bump() disables it on the bumped
+// copies of the hit point used by nested materials (i.e. Mix and
+// GlossyCoating) so the texture is the only key.
+//------------------------------------------------------------------------------
+
+#define TEXTURE_VALUE_CACHE_SIZE 16
+
+class TextureValueCache {
+public:
+	TextureValueCache() : size(0) { }
+
+	void Clear() { size = 0; }
+
+	const luxrays::Spectrum *Find(const Texture *tex, const bool isSpectrum) const {
+		for (u_int i = 0; i < size; ++i) {
+			const Entry &entry = entries[i];
+
+			if ((entry.tex == tex) && (entry.isSpectrum == isSpectrum))
+				return &entry.value;
+		}
+
+		return nullptr;
+	}
+
+	void Add(const Texture *tex, const bool isSpectrum,
+			const luxrays::Spectrum &value) {
+		// When full, values are just not cached anymore
+		if (size < TEXTURE_VALUE_CACHE_SIZE) {
+			Entry &entry = entries[size++];
+
+			entry.tex = tex;
+			entry.isSpectrum = isSpectrum;
+			entry.value = value;
+		}
+	}
+
+private:
+	typedef struct {
+		const Texture *tex;
+		// The float values are stored in value.c[0]
+		luxrays::Spectrum value;
+		bool isSpectrum;
+	} Entry;
+
+	Entry entries[TEXTURE_VALUE_CACHE_SIZE];
+	u_int size;
+};
+
+}
+
+#endif	/* _SLG_TEXTUREVALUECACHE_H */
@@ -65,6 +65,9 @@ public:
 		const Volume *matExteriorVolume,
 		const Volume *defaultWorldVolume) const;
 
+	bool operator==(const PathVolumeInfo &pvi) const;
+	bool operator!=(const PathVolumeInfo &pvi) const { return !(*this == pvi); }
+
 private:
 	static bool CompareVolumePriorities(const Volume *vol1, const Volume *vol2);
 
@@ -0,0 +1,113 @@
+/***************************************************************************
+ * Copyright 1998-2020 by authors (see AUTHORS.txt)                        *
+ *                                                                         *
+ *   This file is part of LuxCoreRender.                                   *
+ *                                                                         *
+ * Licensed under the Apache License, Version 2.0 (the "License");         *
+ * you may not use this file except in compliance with the License.        *
+ * You may obtain a copy of the License at                                 *
+ *                                                                         *
+ *     http://www.apache.org/licenses/LICENSE-2.0                          *
+ *                                                                         *
+ * Unless required by applicable law or agreed to in writing, software     *
+ * distributed under the License is distributed on an "AS IS" BASIS,       *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.*
+ * See the License for the specific language governing permissions and     *
+ * limitations under the License.                                          *
+ ***************************************************************************/
+
+
+#ifndef _SLG_PROFILER_H
+#define	_SLG_PROFILER_H
+
+#include <string>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <chrono>
+#endif
+
+#include "luxrays/luxrays.h"
+#include "luxrays/utils/properties.h"
+
+namespace slg {
+
+//------------------------------------------------------------------------------
+// Profiler
+//
+// Optional per-thread counters and cycle timers for the rendering hot paths.
+// They are compiled in only when SLG_ENABLE_PROFILER is defined (CMake option
+// LUXCORE_ENABLE_PROFILER), otherwise SLG_PROFILE() is a no-op.
+//------------------------------------------------------------------------------
+
+typedef enum {
+	PROFILER_PATH_EYE,
+	PROFILER_SCENE_INTERSECT,
+	PROFILER_BSDF_INIT,
+	PROFILER_LIGHT_SAMPLING,
+	PROFILER_VOLUME_SCATTER,
+	PROFILER_FILM_ADD_SAMPLE,
+
+	PROFILER_COUNTER_COUNT
+} ProfilerCounterType;
+
+class Profiler {
+public:
+	static bool IsEnabled();
+
+	// Restarts the reported counters from 0 and stops the timeline. The
+	// per-thread counters aren't written: their current values are recorded
+	// as the baseline subtracted by GetStats(). The timeline events are
+	// dropped later by their owner threads.
+	static void Reset();
+	// Adds the stats.profiler.* properties
+	static void GetStats(luxrays::Properties &stats);
+
+	// Each thread records at most maxEvents timeline events
+	static void StartTimeline(const u_int maxEvents);
+	// Writes the timeline in Chrome trace format (chrome://tracing). It must
+	// be called when the rendering threads are stopped.
+	static void SaveTimeline(const std::string &fileName);
+
+	static std::string CounterType2String(const ProfilerCounterType type);
+
+	static inline u_longlong ReadCycleCounter() {
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+		return __rdtsc();
+#else
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+	}
+
+	static void AddSample(const ProfilerCounterType type,
+			const u_longlong startCycles, const u_longlong endCycles);
+};
+
+class ProfilerScope {
+public:
+	ProfilerScope(const ProfilerCounterType t) : type(t),
+			startCycles(Profiler::ReadCycleCounter()) { }
+	~ProfilerScope() {
+		Profiler::AddSample(type, startCycles, Profiler::ReadCycleCounter());
+	}
+
+private:
+	const ProfilerCounterType type;
+	const u_longlong startCycles;
+};
+
+#if defined(SLG_ENABLE_PROFILER)
+#define SLG_PROFILE_CONCAT2(a, b) a ## b
+#define SLG_PROFILE_CONCAT(a, b) SLG_PROFILE_CONCAT2(a, b)
+#define SLG_PROFILE(type) slg::ProfilerScope SLG_PROFILE_CONCAT(slgProfilerScope, __LINE__)(type)
+#else
+#define SLG_PROFILE(type)
+#endif
+
+}
+
+#endif	/* _SLG_PROFILER_H */
@@ -21,6 +21,8 @@
 
 #include <vector>
 
+#include <boost/thread/shared_mutex.hpp>
+
 #include "slg/slg.h"
 #include "slg/core/indexoctree.h"
 #include "slg/samplers/sobol.h"
@@ -44,7 +46,7 @@ protected:
 	public:
 		TraceVisibilityThread(SceneVisibility<T> &sv, const u_int index,
 				SobolSamplerSharedData &visibilitySobolSharedData,
-				IndexOctree<T> *particlesOctree, boost::mutex &particlesOctreeMutex,
+				IndexOctree<T> *particlesOctree, boost::shared_mutex &particlesOctreeMutex,
 				boost::atomic<u_int> &globalVisibilityParticlesCount,
 				u_int &visibilityCacheLookUp, u_int &visibilityCacheHits,
 				bool &visibilityWarmUp);
@@ -64,7 +66,7 @@ protected:
 
 		SobolSamplerSharedData &visibilitySobolSharedData;
 		IndexOctree<T> *particlesOctree;
-		boost::mutex &particlesOctreeMutex;
+		boost::shared_mutex &particlesOctreeMutex;
 		boost::atomic<u_int> &globalVisibilityParticlesCount;
 		u_int &visibilityCacheLookUp;
 		u_int &visibilityCacheHits;
@@ -76,8 +78,16 @@ protected:
 	virtual IndexOctree<T> *AllocOctree() const = 0;
 	virtual bool ProcessHitPoint(const BSDF &bsdf, const PathVolumeInfo &volInfo,
 			std::vector<T> &visibilityParticles) const = 0;
-	virtual bool ProcessVisibilityParticle(const T &visibilityParticle, std::vector<T> &visibilityParticles,
-			IndexOctree<T> *particlesOctree, const float maxDistance2) const = 0;
+	// Returns the index of the nearest entry (and its squared distance) or
+	// NULL_INDEX. It is called by multiple threads at the same time so it
+	// must not modify anything.
+	virtual u_int GetNearestEntry(const T &visibilityParticle, const IndexOctree<T> *particlesOctree,
+			float *distance2) const = 0;
+	// Merges a visibility particle with an existing entry
+	virtual void AddToEntry(T &entry, const T &visibilityParticle, const float distance2) const = 0;
+
+	bool ProcessVisibilityParticle(const T &visibilityParticle, std::vector<T> &visibilityParticles,
+			IndexOctree<T> *particlesOctree, const float maxDistance2) const;
 
 	const Scene *scene;
 	std::vector<T> &visibilityParticles;
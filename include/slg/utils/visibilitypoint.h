@@ -0,0 +1,102 @@
+/***************************************************************************
+ * Copyright 1998-2020 by authors (see AUTHORS.txt)                        *
+ *                                                                         *
+ *   This file is part of LuxCoreRender.                                   *
+ *                                                                         *
+ * Licensed under the Apache License, Version 2.0 (the "License");         *
+ * you may not use this file except in compliance with the License.        *
+ * You may obtain a copy of the License at                                 *
+ *                                                                         *
+ *     http://www.apache.org/licenses/LICENSE-2.0                          *
+ *                                                                         *
+ * Unless required by applicable law or agreed to in writing, software     *
+ * distributed under the License is distributed on an "AS IS" BASIS,       *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.*
+ * See the License for the specific language governing permissions and     *
+ * limitations under the License.                                          *
+ ***************************************************************************/
+
+#ifndef _SLG_VISIBILITYPOINT_H
+#define	_SLG_VISIBILITYPOINT_H
+
+#include <vector>
+
+#include "luxrays/core/geometry/point.h"
+#include "luxrays/core/geometry/normal.h"
+#include "luxrays/utils/packing.h"
+
+#include "slg/slg.h"
+#include "slg/bsdf/bsdf.h"
+#include "slg/utils/pathvolumeinfo.h"
+
+namespace slg {
+
+class Scene;
+
+//------------------------------------------------------------------------------
+// VisibilityPoint
+//
+// A compact version of the BSDF of a visibility particle hit point. It stores
+// only what is required to sample light sources and to trace shadow rays:
+// a full BSDF can be rebuilt, without evaluating the material, with GetBSDF().
+//------------------------------------------------------------------------------
+
+class VisibilityPoint {
+public:
+	VisibilityPoint() { }
+	VisibilityPoint(const Scene &scene, const BSDF &bsdf, const u_int volInfoIndex);
+
+	luxrays::Normal GetGeometryN() const { return luxrays::UnpackOctahedralNormal(packedGeometryN); }
+	luxrays::Normal GetShadeN() const { return luxrays::UnpackOctahedralNormal(packedShadeN); }
+	luxrays::Normal GetLandingShadeN() const { return (IsIntoObject() ? 1.f : -1.f) * GetShadeN(); }
+	bool IsVolume() const { return (flags & VOLUME) != 0; }
+	bool IsIntoObject() const { return (flags & INTO_OBJECT) != 0; }
+
+	void GetBSDF(const Scene &scene, BSDF &bsdf) const;
+
+	luxrays::Point p;
+	u_int packedGeometryN, packedShadeN;
+	// Index in the scene material definitions (volumes included)
+	u_int materialIndex;
+	u_short volInfoIndex;
+
+private:
+	enum {
+		VOLUME = 1,
+		INTO_OBJECT = 2
+	};
+
+	u_char flags;
+};
+
+//------------------------------------------------------------------------------
+// VisibilityPointList
+//
+// The list of points merged in a visibility particle. The PathVolumeInfo are
+// shared among the points because they are usually all the same.
+//------------------------------------------------------------------------------
+
+class VisibilityPointList {
+public:
+	VisibilityPointList() { }
+
+	void Add(const Scene &scene, const BSDF &bsdf, const PathVolumeInfo &volInfo);
+	void Add(const VisibilityPointList &list);
+
+	size_t GetSize() const { return points.size(); }
+	const VisibilityPoint &GetPoint(const u_int index) const { return points[index]; }
+	const PathVolumeInfo &GetVolInfo(const u_int index) const { return volInfos[points[index].volInfoIndex]; }
+
+	std::vector<VisibilityPoint>::const_iterator begin() const { return points.begin(); }
+	std::vector<VisibilityPoint>::const_iterator end() const { return points.end(); }
+
+private:
+	u_short AddVolInfo(const PathVolumeInfo &volInfo);
+
+	std::vector<VisibilityPoint> points;
+	std::vector<PathVolumeInfo> volInfos;
+};
+
+}
+
+#endif	/* _SLG_VISIBILITYPOINT_H */
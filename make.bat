@@ -38,6 +38,10 @@ if "%COMMAND%" == "" (
     call :Config
     call :BuildAndInstall luxcore
     call :BuildAndInstall luxcoreconsole
+) else if "%COMMAND%" == "luxcorebench" (
+    call :Config
+    call :BuildAndInstall luxcore
+    call :BuildAndInstall luxcorebench
 ) else if "%COMMAND%" == "doc" (
     call :Config
     call :BuildAndInstall doc
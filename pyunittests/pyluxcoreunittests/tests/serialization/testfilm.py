@@ -62,3 +62,41 @@ class TestFilm(unittest.TestCase):
 		
 		os.unlink("simple.flm")
 
+
+	def test_Film_AddFilmOutOfBoundRegion(self):
+		# Load the configuration from file
+		props = pyluxcore.Properties("resources/scenes/simple/simple.cfg")
+
+		# Change the render engine to PATHCPU
+		props.Set(pyluxcore.Property("renderengine.type", ["PATHCPU"]))
+		props.Set(pyluxcore.Property("sampler.type", ["RANDOM"]))
+		props.Set(GetDefaultEngineProperties("PATHCPU"))
+
+		config = pyluxcore.RenderConfig(props)
+		session = DoRenderSession(config)
+
+		# Save the film
+		session.GetFilm().SaveFilm("simple.flm")
+
+		filmSrc = pyluxcore.Film("simple.flm")
+		width = filmSrc.GetWidth()
+		height = filmSrc.GetHeight()
+
+		# A region partially out of both films is clipped by the film in
+		# memory and by the serialized film version of AddFilm()
+		filmA = pyluxcore.Film("simple.flm")
+		filmA.AddFilm(filmSrc, width // 2, height // 2, width, height, width // 4, height // 4)
+		filmB = pyluxcore.Film("simple.flm")
+		filmB.AddFilm("simple.flm", width // 2, height // 2, width, height, width // 4, height // 4, 1.0)
+
+		(sameImage, diffCount, diffImage) = CompareImage(GetImagePipelineImage(filmA), GetImagePipelineImage(filmB))
+		self.assertTrue(sameImage)
+
+		# A region completely out of the films is ignored
+		filmA.AddFilm(filmSrc, width, 0, width, height, 0, 0)
+		filmB.AddFilm("simple.flm", width, 0, width, height, 0, 0, 1.0)
+
+		(sameImage, diffCount, diffImage) = CompareImage(GetImagePipelineImage(filmA), GetImagePipelineImage(filmB))
+		self.assertTrue(sameImage)
+
+		os.unlink("simple.flm")
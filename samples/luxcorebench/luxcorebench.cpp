@@ -0,0 +1,391 @@
+/***************************************************************************
+ * Copyright 1998-2020 by authors (see AUTHORS.txt)                        *
+ *                                                                         *
+ *   This file is part of LuxCoreRender.                                   *
+ *                                                                         *
+ * Licensed under the Apache License, Version 2.0 (the "License");         *
+ * you may not use this file except in compliance with the License.        *
+ * You may obtain a copy of the License at                                 *
+ *                                                                         *
+ *     http://www.apache.org/licenses/LICENSE-2.0                          *
+ *                                                                         *
+ * Unless required by applicable law or agreed to in writing, software     *
+ * distributed under the License is distributed on an "AS IS" BASIS,       *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.*
+ * See the License for the specific language governing permissions and     *
+ * limitations under the License.                                          *
+ ***************************************************************************/
+
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+#if defined(WIN32)
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#include <boost/filesystem.hpp>
+#include <boost/algorithm/string.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/thread.hpp>
+#include <nlohmann/json.hpp>
+
+#include "luxrays/utils/utils.h"
+#include "luxcore/luxcore.h"
+
+using namespace std;
+using namespace luxrays;
+using namespace luxcore;
+using json = nlohmann::json;
+
+//------------------------------------------------------------------------------
+// Benchmark settings
+//------------------------------------------------------------------------------
+
+typedef struct {
+	vector<string> sceneFileNames;
+	vector<string> engines;
+	unsigned int haltSpp, haltTime, repeatCount;
+	Properties cmdLineProp;
+} BenchSettings;
+
+// Resets the peak resident set size of the process to the current one.
+// Returns false if the platform doesn't support it.
+static bool ResetPeakRSS() {
+#if defined(__linux__)
+	ofstream clearRefs("/proc/self/clear_refs");
+	clearRefs << "5";
+	clearRefs.close();
+
+	return !clearRefs.fail();
+#else
+	return false;
+#endif
+}
+
+// Returns the peak resident set size of the process in bytes
+static unsigned long long GetPeakRSS() {
+#if defined(WIN32)
+	PROCESS_MEMORY_COUNTERS info;
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &info, sizeof(info)))
+		return (unsigned long long)info.PeakWorkingSetSize;
+	else
+		return 0ull;
+#else
+#if defined(__linux__)
+	// VmHWM is the peak since the last ResetPeakRSS(), ru_maxrss is never reset
+	ifstream status("/proc/self/status");
+	string line;
+	while (getline(status, line)) {
+		if (boost::starts_with(line, "VmHWM:")) {
+			// The value is in Kbytes
+			unsigned long long peakRSS;
+			istringstream ss(line.substr(6));
+			if (ss >> peakRSS)
+				return peakRSS * 1024ull;
+			break;
+		}
+	}
+#endif
+
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0)
+		return 0ull;
+#if defined(__APPLE__)
+	// ru_maxrss is in bytes on MacOS
+	return (unsigned long long)usage.ru_maxrss;
+#else
+	// ru_maxrss is in Kbytes on Linux
+	return (unsigned long long)usage.ru_maxrss * 1024ull;
+#endif
+#endif
+}
+
+static json PropertyToJSON(const Property &prop) {
+	json values = json::array();
+
+	for (unsigned int i = 0; i < prop.GetSize(); ++i) {
+		switch (prop.GetValueType(i)) {
+			case PropertyValue::BOOL_VAL:
+				values.push_back(prop.Get<bool>(i));
+				break;
+			case PropertyValue::INT_VAL:
+			case PropertyValue::LONGLONG_VAL:
+				values.push_back(prop.Get<long long>(i));
+				break;
+			case PropertyValue::UINT_VAL:
+			case PropertyValue::ULONGLONG_VAL:
+				values.push_back(prop.Get<unsigned long long>(i));
+				break;
+			case PropertyValue::FLOAT_VAL:
+			case PropertyValue::DOUBLE_VAL:
+				values.push_back(prop.Get<double>(i));
+				break;
+			case PropertyValue::STRING_VAL:
+				values.push_back(prop.Get<string>(i));
+				break;
+			default:
+				// Blobs are not exported
+				break;
+		}
+	}
+
+	return (values.size() == 1) ? values[0] : values;
+}
+
+//------------------------------------------------------------------------------
+// A single benchmark run
+//------------------------------------------------------------------------------
+
+static Properties GetEngineProperties(const BenchSettings &settings,
+		const Properties &sceneCfg, const string &engine) {
+	Properties props;
+
+	props << Property("renderengine.type")(engine);
+	// Use always the same seed to have reproducible results
+	props << Property("renderengine.seed")(1u);
+
+	// Tile engines require the tile sampler and the other engines can not use it
+	if (engine == "TILEPATHCPU")
+		props << Property("sampler.type")("TILEPATHSAMPLER");
+	else if (sceneCfg.Get(Property("sampler.type")("SOBOL")).Get<string>() == "TILEPATHSAMPLER")
+		props << Property("sampler.type")("SOBOL");
+
+	props << Property("batch.haltspp")(settings.haltSpp);
+	props << Property("batch.halttime")(settings.haltTime);
+
+	// Periodic saves would be included in the measured time
+	props << Property("periodicsave.film.outputs.period")(0.f);
+	props << Property("periodicsave.resumerendering.period")(0.f);
+
+	return props;
+}
+
+static json BenchRun(const BenchSettings &settings, const string &sceneFileName,
+		const string &engine) {
+	LC_LOG("Benchmarking " << sceneFileName << " with " << engine);
+
+	// The peak memory usage of this run doesn't include the previous runs
+	// only if it can be reset
+	const bool peakRSSReset = ResetPeakRSS();
+
+	// Clear the file name resolver list
+	luxcore::ClearFileNameResolverPaths();
+	// Add the current directory to the list of place where to look for files
+	luxcore::AddFileNameResolverPath(".");
+	// Add the .cfg directory to the list of place where to look for files
+	boost::filesystem::path path(sceneFileName);
+	luxcore::AddFileNameResolverPath(path.parent_path().generic_string());
+
+	//--------------------------------------------------------------------------
+	// Parsing
+	//--------------------------------------------------------------------------
+
+	const double parseStartTime = WallClockTime();
+
+	const Properties sceneCfg(sceneFileName);
+	Properties cfg = sceneCfg;
+	cfg.Set(GetEngineProperties(settings, sceneCfg, engine));
+	cfg.Set(settings.cmdLineProp);
+	RenderConfig *config = RenderConfig::Create(cfg);
+
+	const double parseTime = WallClockTime() - parseStartTime;
+
+	//--------------------------------------------------------------------------
+	// Preprocessing (meshes, accelerators, light sources, caches, etc.)
+	//--------------------------------------------------------------------------
+
+	RenderSession *session = RenderSession::Create(config);
+
+	const double startStartTime = WallClockTime();
+	session->Start();
+	const double startTime = WallClockTime() - startStartTime;
+
+	//--------------------------------------------------------------------------
+	// Rendering
+	//--------------------------------------------------------------------------
+
+	const Properties &stats = session->GetStats();
+	do {
+		boost::this_thread::sleep(boost::posix_time::millisec(250));
+		session->UpdateStats();
+	} while (!session->HasDone());
+
+	session->Stop();
+	session->UpdateStats();
+
+	//--------------------------------------------------------------------------
+	// Collect the results
+	//--------------------------------------------------------------------------
+
+	json result;
+	result["scene"] = sceneFileName;
+	result["engine"] = engine;
+
+	result["time"]["parse"] = parseTime;
+	result["time"]["start"] = startTime;
+	result["time"]["preprocess"]["dataset"] = stats.Get("stats.scene.preprocess.dataset.time").Get<double>();
+	result["time"]["preprocess"]["accelerators"] = stats.Get("stats.dataset.accelerators.time").Get<double>();
+	result["time"]["preprocess"]["lights"] = stats.Get("stats.scene.preprocess.lights.time").Get<double>();
+	result["time"]["preprocess"]["imagemaps"] = stats.Get("stats.scene.preprocess.imagemaps.time").Get<double>();
+	result["time"]["preprocess"]["caches"] = stats.Get("stats.renderengine.caches.preprocess.time").Get<double>();
+	result["time"]["render"] = stats.Get("stats.renderengine.time").Get<double>();
+
+	result["samples"]["pass"] = stats.Get("stats.renderengine.pass").Get<unsigned int>();
+	result["samples"]["count"] = stats.Get("stats.renderengine.total.samplecount").Get<double>();
+	result["samples"]["sec"] = stats.Get("stats.renderengine.total.samplesec").Get<double>();
+	result["samples"]["sec.eye"] = stats.Get("stats.renderengine.total.samplesec.eye").Get<double>();
+	result["samples"]["sec.light"] = stats.Get("stats.renderengine.total.samplesec.light").Get<double>();
+
+	result["rays"]["sec"] = stats.Get("stats.renderengine.total.raysec").Get<double>();
+	const Property &deviceNames = stats.Get("stats.renderengine.devices");
+	for (unsigned int i = 0; i < deviceNames.GetSize(); ++i) {
+		const string deviceName = deviceNames.Get<string>(i);
+		const string prefix = "stats.renderengine.devices." + deviceName;
+
+		json &dev = result["rays"]["devices"][deviceName];
+		dev["sec"] = stats.Get(prefix + ".performance.total").Get<double>();
+		dev["sec.serial"] = stats.Get(prefix + ".performance.serial").Get<double>();
+		dev["sec.dataparallel"] = stats.Get(prefix + ".performance.dataparallel").Get<double>();
+	}
+
+	result["dataset"]["trianglecount"] = stats.Get("stats.dataset.trianglecount").Get<double>();
+
+	if (peakRSSReset)
+		result["memory"]["peak.rss"] = GetPeakRSS();
+
+	// All statistics, including the one not listed above
+	const vector<string> &statNames = stats.GetAllNames();
+	for (const string &name : statNames)
+		result["stats"][name] = PropertyToJSON(stats.Get(name));
+
+	delete session;
+	delete config;
+
+	return result;
+}
+
+//------------------------------------------------------------------------------
+// main
+//------------------------------------------------------------------------------
+
+int main(int argc, char *argv[]) {
+	try {
+		// Initialize LuxCore
+		luxcore::Init();
+
+		BenchSettings settings;
+		settings.haltSpp = 0;
+		settings.haltTime = 0;
+		settings.repeatCount = 1;
+		// The log is printed on the standard output so the results go to a file
+		string outputFileName = "luxcorebench.json";
+
+		for (int i = 1; i < argc; i++) {
+			if (argv[i][0] == '-') {
+				// I should check for out of range array index...
+
+				if (argv[i][1] == 'h') {
+					LC_LOG("Usage: " << argv[0] << " [options] [scene configuration files]" << endl <<
+							" -e [render engine list: PATHCPU,TILEPATHCPU,BIDIRCPU,LIGHTCPU,BAKECPU]" << endl <<
+							" -s [halt samples per pixel]" << endl <<
+							" -t [halt time in secs]" << endl <<
+							" -r [number of times each run is repeated]" << endl <<
+							" -o [JSON output file (default: luxcorebench.json)]" << endl <<
+							" -D [property name] [property value]" << endl <<
+							" -d [current directory path]" << endl <<
+							" -h <display this help and exit>" << endl <<
+							"Note: BAKECPU requires scenes defining the bake.* properties");
+					exit(EXIT_SUCCESS);
+				}
+
+				else if (argv[i][1] == 'e') boost::split(settings.engines, argv[++i], boost::is_any_of(","));
+
+				else if (argv[i][1] == 's') settings.haltSpp = boost::lexical_cast<unsigned int>(argv[++i]);
+
+				else if (argv[i][1] == 't') settings.haltTime = boost::lexical_cast<unsigned int>(argv[++i]);
+
+				else if (argv[i][1] == 'r') settings.repeatCount = Max(1u, boost::lexical_cast<unsigned int>(argv[++i]));
+
+				else if (argv[i][1] == 'o') outputFileName = string(argv[++i]);
+
+				else if (argv[i][1] == 'D') {
+					settings.cmdLineProp.Set(Property(argv[i + 1]).Add(argv[i + 2]));
+					i += 2;
+				}
+
+				else if (argv[i][1] == 'd') boost::filesystem::current_path(boost::filesystem::path(argv[++i]));
+
+				else {
+					LC_LOG("Invalid option: " << argv[i]);
+					exit(EXIT_FAILURE);
+				}
+			} else {
+				const string fileName = argv[i];
+				if (boost::algorithm::to_lower_copy(boost::filesystem::path(fileName).extension().string()) != ".cfg")
+					throw runtime_error("Only .cfg scene configuration files are supported: " + fileName);
+
+				settings.sceneFileNames.push_back(fileName);
+			}
+		}
+
+		if (settings.sceneFileNames.size() == 0)
+			throw runtime_error("You must specify at least a scene configuration file");
+		if (settings.engines.size() == 0)
+			settings.engines.push_back("PATHCPU");
+		if ((settings.haltSpp == 0) && (settings.haltTime == 0)) {
+			// A default halt condition is required to end the benchmark
+			settings.haltSpp = 64;
+		}
+
+		//----------------------------------------------------------------------
+		// Run the benchmark
+		//----------------------------------------------------------------------
+
+		json results;
+		results["version"] = luxcore::GetPlatformDesc().Get("version.number").Get<string>();
+		results["halt"]["spp"] = settings.haltSpp;
+		results["halt"]["time"] = settings.haltTime;
+		results["runs"] = json::array();
+
+		for (const string &sceneFileName : settings.sceneFileNames) {
+			for (const string &engine : settings.engines) {
+				for (unsigned int i = 0; i < settings.repeatCount; ++i)
+					results["runs"].push_back(BenchRun(settings, sceneFileName, engine));
+			}
+		}
+
+		// The peak resident set size of the whole process, it covers all the
+		// runs. The peak of each run is reported too if the platform allows
+		// to reset it.
+		results["process"]["peak.rss"] = GetPeakRSS();
+
+		ofstream outputFile(outputFileName.c_str());
+		if (!outputFile.is_open())
+			throw runtime_error("Unable to open the JSON output file: " + outputFileName);
+
+		outputFile << results.dump(4) << endl;
+		if (!outputFile.good())
+			throw runtime_error("Error while writing the JSON output file: " + outputFileName);
+
+		LC_LOG("Results saved in: " << outputFileName);
+		LC_LOG("Done.");
+	} catch (runtime_error &err) {
+		LC_LOG("RUNTIME ERROR: " << err.what());
+		return EXIT_FAILURE;
+	} catch (exception &err) {
+		LC_LOG("ERROR: " << err.what());
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -327,6 +327,11 @@ void FilmChannelsWindow::DrawChannelInfo(const string &label, const Film::FilmCh
 						if (ImGui::InputInt("Scales", &ival))
 							props << Property(denoiserPrefix + ".scales")(ival);
 						LuxCoreApp::HelpMarker((denoiserPrefix + ".scales").c_str());
+
+						ival = Max(props.Get(Property(denoiserPrefix + ".tilesize")(512)).Get<int>(), 0);
+						if (ImGui::InputInt("Tile size", &ival))
+							props << Property(denoiserPrefix + ".tilesize")(ival);
+						LuxCoreApp::HelpMarker((denoiserPrefix + ".tilesize").c_str());
 						
 						if (ImGui::Button("Apply")) {
 							const Properties &cfgProps = app->config->ToProperties();
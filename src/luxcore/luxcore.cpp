@@ -27,6 +27,7 @@
 #include "slg/engines/oclrenderengine.h"
 #include "slg/engines/tilepathocl/tilepathocl.h"
 #include "slg/engines/rtpathocl/rtpathocl.h"
+#include "slg/film/filmmerger.h"
 #include "slg/utils/filenameresolver.h"
 #include "luxcore/luxcore.h"
 #include "luxcore/luxcoreimpl.h"
@@ -162,6 +163,12 @@ Properties luxcore::GetPlatformDesc() {
 	props << Property("compile.LUXCORE_DISABLE_OIDN")(true);
 #endif
 
+#if defined(SLG_ENABLE_PROFILER)
+	props << Property("compile.SLG_ENABLE_PROFILER")(true);
+#else
+	props << Property("compile.SLG_ENABLE_PROFILER")(false);
+#endif
+
 	props << Property("compile.LUXCORE_DISABLE_EMBREE_BVH_BUILDER")(false);
 	props << Property("compile.LC_MESH_MAX_DATA_COUNT")(LC_MESH_MAX_DATA_COUNT);
 
@@ -294,6 +301,17 @@ Film *Film::Create(const luxrays::Properties &props,
 	return result;
 }
 
+Film *Film::Merge(const std::vector<std::string> &fileNames,
+		const std::vector<float> &weights) {
+	API_BEGIN("{}, {}", ToArgString(fileNames), ToArgString(weights));
+
+	Film *result = new luxcore::detail::FilmImpl(slg::FilmMerger::Merge(fileNames, weights));
+
+	API_RETURN("{}", (void *)result);
+
+	return result;
+}
+
 Film::~Film() {
 	API_BEGIN_NOARGS();
 	API_END();
@@ -35,6 +35,8 @@
 #include "slg/engines/tilepathocl/tilepathocl.h"
 #include "slg/engines/rtpathocl/rtpathocl.h"
 #include "slg/engines/filesaver/filesaver.h"
+#include "slg/film/filmmerger.h"
+#include "slg/utils/profiler.h"
 #include "luxcore/luxcore.h"
 #include "luxcore/luxcoreimpl.h"
 
@@ -159,31 +161,36 @@ void FilmImpl::AddFilm(const Film &film,
 	const FilmImpl *dstFilmImpl = this;
 
 	// I have to clip the parameters to avoid an out of bound memory access
+	u_int clippedSrcWidth = srcWidth;
+	u_int clippedSrcHeight = srcHeight;
+	if (slg::FilmMerger::ClipRegion(srcFilmImpl->GetWidth(), srcFilmImpl->GetHeight(),
+			dstFilmImpl->GetWidth(), dstFilmImpl->GetHeight(),
+			srcOffsetX, srcOffsetY, dstOffsetX, dstOffsetY,
+			&clippedSrcWidth, &clippedSrcHeight)) {
+		GetSLGFilm()->AddFilm(*(srcFilmImpl->GetSLGFilm()), srcOffsetX, srcOffsetY,
+				clippedSrcWidth, clippedSrcHeight, dstOffsetX, dstOffsetY);
+	}
 
-	// Check the cases where I have nothing to do
-	if (srcOffsetX >= srcFilmImpl->GetWidth())
-		return;
-	if (srcOffsetY >= srcFilmImpl->GetHeight())
-		return;
-	if (dstOffsetX >= dstFilmImpl->GetWidth())
-		return;
-	if (dstOffsetY >= dstFilmImpl->GetHeight())
-		return;
+	API_END();
+}
 
-	u_int clippedSrcWidth;
-	// Clip with the src film
-	clippedSrcWidth = Min(srcOffsetX + srcWidth, srcFilmImpl->GetWidth()) - srcOffsetX;
-	// Clip with the dst film
-	clippedSrcWidth = Min(dstOffsetX + clippedSrcWidth, dstFilmImpl->GetWidth()) - dstOffsetX;
+void FilmImpl::AddFilm(const string &fileName, const float weight) {
+	API_BEGIN("{}, {}", ToArgString(fileName), weight);
 
-	u_int clippedSrcHeight;
-	// Clip with the src film
-	clippedSrcHeight = Min(srcOffsetY + srcHeight, srcFilmImpl->GetHeight()) - srcOffsetY;
-	// Clip with the dst film
-	clippedSrcHeight = Min(dstOffsetY + clippedSrcHeight, dstFilmImpl->GetHeight()) - dstOffsetY;
+	slg::FilmMerger::AddFilm(*GetSLGFilm(), fileName, weight);
+
+	API_END();
+}
+
+void FilmImpl::AddFilm(const string &fileName,
+		const u_int srcOffsetX, const u_int srcOffsetY,
+		const u_int srcWidth, const u_int srcHeight,
+		const u_int dstOffsetX, const u_int dstOffsetY,
+		const float weight) {
+	API_BEGIN("{}, {}, {}, {}, {}, {}, {}, {}", ToArgString(fileName), srcOffsetX, srcOffsetY, srcWidth, srcHeight, dstOffsetX, dstOffsetY, weight);
 
-	GetSLGFilm()->AddFilm(*(srcFilmImpl->GetSLGFilm()),srcOffsetX, srcOffsetY,
-			clippedSrcWidth, clippedSrcHeight, dstOffsetX, dstOffsetY);
+	slg::FilmMerger::AddFilm(*GetSLGFilm(), fileName, srcOffsetX, srcOffsetY,
+			srcWidth, srcHeight, dstOffsetX, dstOffsetY, weight);
 
 	API_END();
 }
@@ -1701,6 +1708,22 @@ void RenderSessionImpl::UpdateStats() {
 
 	// The explicit cast to size_t is required by VisualC++
 	stats.Set(Property("stats.dataset.trianglecount")(renderSession->renderConfig->scene->dataSet->GetTotalTriangleCount()));
+	// Memory used by mesh attributes and the amount saved by the compression
+	const slg::ExtMeshCache &extMeshCache = renderSession->renderConfig->scene->extMeshCache;
+	const u_longlong meshMemory = extMeshCache.GetMemoryUsage();
+	stats.Set(Property("stats.dataset.meshes.memory")(meshMemory));
+	stats.Set(Property("stats.dataset.meshes.memory.saved")(extMeshCache.GetUncompressedMemoryUsage() - meshMemory));
+
+	// Time spent in the preprocessing phases
+	const slg::ScenePreprocessTimes &preprocessTimes = renderSession->renderConfig->scene->preprocessTimes;
+	stats.Set(Property("stats.scene.preprocess.dataset.time")(preprocessTimes.dataSetTime));
+	stats.Set(Property("stats.scene.preprocess.lights.time")(preprocessTimes.lightsTime));
+	stats.Set(Property("stats.scene.preprocess.imagemaps.time")(preprocessTimes.imageMapsTime));
+	stats.Set(Property("stats.dataset.accelerators.time")(renderSession->renderConfig->scene->dataSet->GetAcceleratorsBuildTime()));
+	stats.Set(Property("stats.renderengine.caches.preprocess.time")(renderSession->renderEngine->GetCachesPreprocessTime()));
+
+	// Hot-path profiler counters
+	slg::Profiler::GetStats(stats);
 
 	// Some engine specific statistic
 	switch (renderSession->renderEngine->GetType()) {
@@ -38,6 +38,7 @@ namespace luxrays {
 BVHAccel::BVHAccel(const Context *context) : ctx(context) {
 	params = ToBVHParams(ctx->GetConfig());
 
+	verbose = true;
 	initialized = false;
 }
 
@@ -79,7 +80,8 @@ void BVHAccel::Init(const deque<const Mesh *> &ms, const u_longlong totVert,
 
 	// Handle the empty DataSet case
 	if (totalTriangleCount == 0) {
-		LR_LOG(ctx, "Empty BVH");
+		if (verbose)
+			LR_LOG(ctx, "Empty BVH");
 		nNodes = 0;
 		bvhTree = NULL;
 		initialized = true;
@@ -133,7 +135,8 @@ void BVHAccel::Init(const deque<const Mesh *> &ms, const u_longlong totVert,
 		++meshIndex;
 	}
 
-	LR_LOG(ctx, "BVH Dataset preprocessing time: " << int((WallClockTime() - t0) * 1000) << "ms");
+	if (verbose)
+		LR_LOG(ctx, "BVH Dataset preprocessing time: " << int((WallClockTime() - t0) * 1000) << "ms");
 
 	//--------------------------------------------------------------------------
 	// Build the BVH hierarchy
@@ -145,7 +148,8 @@ void BVHAccel::Init(const deque<const Mesh *> &ms, const u_longlong totVert,
 		"EMBREE_BINNED_SAH"
 		)).Get<string>();
 
-	LR_LOG(ctx, "BVH builder: " << builderType);
+	if (verbose)
+		LR_LOG(ctx, "BVH builder: " << builderType);
 	if (builderType == "CLASSIC")
 		bvhTree = BuildBVH(params, &nNodes, &meshes, bvList);
 	else if (builderType == "EMBREE_BINNED_SAH")
@@ -155,14 +159,17 @@ void BVHAccel::Init(const deque<const Mesh *> &ms, const u_longlong totVert,
 	else
 		throw runtime_error("Unknown BVH builder type in BVHAccel::Init(): " + builderType);
 
-	LR_LOG(ctx, "BVH build hierarchy time: " << int((WallClockTime() - t1) * 1000) << "ms");
+	if (verbose)
+		LR_LOG(ctx, "BVH build hierarchy time: " << int((WallClockTime() - t1) * 1000) << "ms");
 
 	//--------------------------------------------------------------------------
 	// Done
 	//--------------------------------------------------------------------------
 
-	LR_LOG(ctx, "BVH total build time: " << int((WallClockTime() - t0) * 1000) << "ms");
-	LR_LOG(ctx, "Total BVH memory usage: " << nNodes * sizeof(luxrays::ocl::BVHArrayNode) / 1024 << "Kbytes");
+	if (verbose) {
+		LR_LOG(ctx, "BVH total build time: " << int((WallClockTime() - t0) * 1000) << "ms");
+		LR_LOG(ctx, "Total BVH memory usage: " << nNodes * sizeof(luxrays::ocl::BVHArrayNode) / 1024 << "Kbytes");
+	}
 
 	initialized = true;
 }
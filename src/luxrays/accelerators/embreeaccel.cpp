@@ -31,6 +31,15 @@
 
 namespace luxrays {
 
+// RTCIntersectContext has to be the first field, Embree passes a pointer to
+// it to the filter function
+struct EmbreeOcclusionContext {
+	RTCIntersectContext context;
+
+	const Ray *ray;
+	OcclusionFilter *filter;
+};
+
 EmbreeAccel::EmbreeAccel(const Context *context) : ctx(context),
 		uniqueRTCSceneByMesh(MeshPtrCompare), uniqueGeomByMesh(MeshPtrCompare),
 		uniqueInstMatrixByMesh(MeshPtrCompare) {
@@ -142,7 +151,8 @@ void EmbreeAccel::Init(const std::deque<const Mesh *> &meshes,
 
 	embreeScene = rtcNewScene(embreeDevice);
 	rtcSetSceneBuildQuality(embreeScene, RTC_BUILD_QUALITY_HIGH);
-	rtcSetSceneFlags(embreeScene, RTC_SCENE_FLAG_DYNAMIC);
+	// The context filter function is used only by Occluded()
+	rtcSetSceneFlags(embreeScene, (RTCSceneFlags)(RTC_SCENE_FLAG_DYNAMIC | RTC_SCENE_FLAG_CONTEXT_FILTER_FUNCTION));
 
 	BOOST_FOREACH(const Mesh *mesh, meshes) {
 		switch (mesh->GetType()) {
@@ -164,6 +174,7 @@ void EmbreeAccel::Init(const std::deque<const Mesh *> &meshes,
 
 					// Create a new RTCScene
 					instScene = rtcNewScene(embreeDevice);
+					rtcSetSceneFlags(instScene, RTC_SCENE_FLAG_CONTEXT_FILTER_FUNCTION);
 					ExportTriangleMesh(instScene, instancedMesh);
 					rtcCommitScene(instScene);
 
@@ -272,4 +283,60 @@ bool EmbreeAccel::Intersect(const Ray *ray, RayHit *hit) const {
 		return false;
 }
 
+void EmbreeAccel::OcclusionFilterFunc(const RTCFilterFunctionNArguments *args) {
+	const EmbreeOcclusionContext *context = (const EmbreeOcclusionContext *)args->context;
+
+	for (u_int i = 0; i < args->N; ++i) {
+		if (!args->valid[i])
+			continue;
+
+		RayHit hit;
+		const u_int instID = RTCHitN_instID(args->hit, args->N, i, 0);
+		hit.meshIndex = (instID == RTC_INVALID_GEOMETRY_ID) ? RTCHitN_geomID(args->hit, args->N, i) : instID;
+		hit.triangleIndex = RTCHitN_primID(args->hit, args->N, i);
+		hit.t = RTCRayN_tfar(args->ray, args->N, i);
+		hit.b1 = RTCHitN_u(args->hit, args->N, i);
+		hit.b2 = RTCHitN_v(args->hit, args->N, i);
+
+		// The same safety check used in Intersect()
+		if ((hit.t < context->ray->mint) || (hit.t > context->ray->maxt) ||
+				!context->filter->IsOccluder(*(context->ray), hit))
+			args->valid[i] = 0;
+	}
+}
+
+bool EmbreeAccel::Occluded(const Ray *ray, OcclusionFilter *filter) const {
+	if (isnan(ray->o.x) || isnan(ray->o.y) || isnan(ray->o.z) || isnan(ray->d.x) || isnan(ray->d.y) || isnan(ray->d.z))
+		return false;
+
+	EmbreeOcclusionContext context;
+	rtcInitIntersectContext(&context.context);
+	context.ray = ray;
+	context.filter = filter;
+	if (filter)
+		context.context.filter = OcclusionFilterFunc;
+
+	RTCRay embreeRay;
+
+	embreeRay.org_x = ray->o.x;
+	embreeRay.org_y = ray->o.y;
+	embreeRay.org_z = ray->o.z;
+
+	embreeRay.dir_x = ray->d.x;
+	embreeRay.dir_y = ray->d.y;
+	embreeRay.dir_z = ray->d.z;
+
+	embreeRay.tnear = ray->mint;
+	embreeRay.tfar = ray->maxt;
+
+	embreeRay.mask = 0xFFFFFFFF;
+	embreeRay.time = (ray->time - minTime) * timeScale;
+	embreeRay.flags = 0;
+
+	rtcOccluded1(embreeScene, &context.context, &embreeRay);
+
+	// Embree sets tfar to -inf if an occluder has been found
+	return (embreeRay.tfar < 0.f);
+}
+
 }
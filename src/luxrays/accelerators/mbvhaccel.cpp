@@ -87,27 +87,18 @@ void MBVHAccel::Init(const deque<const Mesh *> &ms, const u_longlong totalVertex
 	leafsIndex.reserve(nLeafs);
 
 	map<const Mesh *, u_int, bool (*)(const Mesh *, const Mesh *)> uniqueLeafIndexByMesh(MeshPtrCompare);
+	// The meshes of the unique BVH leafs to build
+	vector<const Mesh *> uniqueLeafMeshes;
 
-	double lastPrint = WallClockTime();
 	for (u_int i = 0; i < nLeafs; ++i) {
-		const double now = WallClockTime();
-		if (now - lastPrint > 2.0) {
-			LR_LOG(ctx, "Building BVH for MBVH leaf: " << i << "/" << nLeafs);
-			lastPrint = now;
-		}
-
 		const Mesh *mesh = meshes[i];
 
 		switch (mesh->GetType()) {
 			case TYPE_TRIANGLE:
 			case TYPE_EXT_TRIANGLE: {
-				BVHAccel *leaf = new BVHAccel(ctx);
-				deque<const Mesh *> mlist(1, mesh);
-				leaf->Init(mlist, mesh->GetTotalVertexCount(), mesh->GetTotalTriangleCount());
-
-				const u_int uniqueLeafIndex = uniqueLeafs.size();
+				const u_int uniqueLeafIndex = uniqueLeafMeshes.size();
 				uniqueLeafIndexByMesh[mesh] = uniqueLeafIndex;
-				uniqueLeafs.push_back(leaf);
+				uniqueLeafMeshes.push_back(mesh);
 				leafsIndex.push_back(uniqueLeafIndex);
 				leafsTransformIndex.push_back(NULL_INDEX);
 				leafsMotionSystemIndex.push_back(NULL_INDEX);
@@ -117,21 +108,17 @@ void MBVHAccel::Init(const deque<const Mesh *> &ms, const u_longlong totalVertex
 			case TYPE_EXT_TRIANGLE_INSTANCE: {
 				const InstanceTriangleMesh *itm = dynamic_cast<const InstanceTriangleMesh *>(mesh);
 
-				// Check if a BVH has already been created
+				// Check if a BVH has already been scheduled
 				map<const Mesh *, u_int, bool (*)(const Mesh *, const Mesh *)>::iterator it =
 						uniqueLeafIndexByMesh.find(itm->GetTriangleMesh());
 
 				if (it == uniqueLeafIndexByMesh.end()) {
 					TriangleMesh *instancedMesh = itm->GetTriangleMesh();
 
-					// Create a new BVH
-					BVHAccel *leaf = new BVHAccel(ctx);
-					deque<const Mesh *> mlist(1, instancedMesh);
-					leaf->Init(mlist, instancedMesh->GetTotalVertexCount(), instancedMesh->GetTotalTriangleCount());
-
-					const u_int uniqueLeafIndex = uniqueLeafs.size();
+					// Schedule a new BVH
+					const u_int uniqueLeafIndex = uniqueLeafMeshes.size();
 					uniqueLeafIndexByMesh[instancedMesh] = uniqueLeafIndex;
-					uniqueLeafs.push_back(leaf);
+					uniqueLeafMeshes.push_back(instancedMesh);
 					leafsIndex.push_back(uniqueLeafIndex);
 				} else {
 					//LR_LOG(ctx, "Cached BVH leaf");
@@ -147,21 +134,17 @@ void MBVHAccel::Init(const deque<const Mesh *> &ms, const u_longlong totalVertex
 			case TYPE_EXT_TRIANGLE_MOTION: {
 				const MotionTriangleMesh *mtm = dynamic_cast<const MotionTriangleMesh *>(mesh);
 
-				// Check if a BVH has already been created
+				// Check if a BVH has already been scheduled
 				map<const Mesh *, u_int, bool (*)(const Mesh *, const Mesh *)>::iterator it =
 						uniqueLeafIndexByMesh.find(mtm->GetTriangleMesh());
 
 				if (it == uniqueLeafIndexByMesh.end()) {
 					TriangleMesh *motionMesh = mtm->GetTriangleMesh();
 
-					// Create a new BVH
-					BVHAccel *leaf = new BVHAccel(ctx);
-					deque<const Mesh *> mlist(1, motionMesh);
-					leaf->Init(mlist, motionMesh->GetTotalVertexCount(), motionMesh->GetTotalTriangleCount());
-
-					const u_int uniqueLeafIndex = uniqueLeafs.size();
+					// Schedule a new BVH
+					const u_int uniqueLeafIndex = uniqueLeafMeshes.size();
 					uniqueLeafIndexByMesh[motionMesh] = uniqueLeafIndex;
-					uniqueLeafs.push_back(leaf);
+					uniqueLeafMeshes.push_back(motionMesh);
 					leafsIndex.push_back(uniqueLeafIndex);
 				} else {
 					//LR_LOG(ctx, "Cached BVH leaf");
@@ -178,6 +161,93 @@ void MBVHAccel::Init(const deque<const Mesh *> &ms, const u_longlong totalVertex
 		}
 	}
 
+	//--------------------------------------------------------------------------
+	// Build all unique BVH leafs
+	//--------------------------------------------------------------------------
+
+	const u_int nUniqueLeafs = uniqueLeafMeshes.size();
+	LR_LOG(ctx, "Building " << nUniqueLeafs << " unique BVH leafs");
+
+	// Start from the largest meshes to better balance the work between threads
+	vector<u_int> buildOrder(nUniqueLeafs);
+	for (u_int i = 0; i < nUniqueLeafs; ++i)
+		buildOrder[i] = i;
+	sort(buildOrder.begin(), buildOrder.end(), [&](const u_int a, const u_int b) {
+		return uniqueLeafMeshes[a]->GetTotalTriangleCount() > uniqueLeafMeshes[b]->GetTotalTriangleCount();
+	});
+
+	uniqueLeafs.resize(nUniqueLeafs, NULL);
+
+	// The leafs built at the same time by the Embree builders share the same
+	// Embree device, and so the same Embree threads
+	const string builderType = ctx->GetConfig().Get(Property("accelerator.bvh.builder.type")(
+		"EMBREE_BINNED_SAH"
+		)).Get<string>();
+	const bool embreeBuilder = (builderType != "CLASSIC");
+	if (embreeBuilder)
+		AcquireEmbreeBuilderDevice();
+
+	u_int builtLeafs = 0;
+	double lastPrint = WallClockTime();
+
+	// Large leafs are built one at a time: the BVH builder is already able to
+	// use all threads for them and it would run single threaded inside the
+	// parallel loop below
+	u_int nLargeLeafs = 0;
+	while ((nLargeLeafs < nUniqueLeafs) &&
+			(uniqueLeafMeshes[buildOrder[nLargeLeafs]]->GetTotalTriangleCount() >= BVH_PARALLEL_RANGE_SIZE)) {
+		const u_int uniqueLeafIndex = buildOrder[nLargeLeafs];
+		const Mesh *mesh = uniqueLeafMeshes[uniqueLeafIndex];
+
+		BVHAccel *leaf = new BVHAccel(ctx);
+		leaf->verbose = false;
+		deque<const Mesh *> mlist(1, mesh);
+		leaf->Init(mlist, mesh->GetTotalVertexCount(), mesh->GetTotalTriangleCount());
+		uniqueLeafs[uniqueLeafIndex] = leaf;
+
+		++nLargeLeafs;
+		++builtLeafs;
+
+		const double now = WallClockTime();
+		if (now - lastPrint > 2.0) {
+			LR_LOG(ctx, "Building BVH for MBVH leaf: " << builtLeafs << "/" << nUniqueLeafs);
+			lastPrint = now;
+		}
+	}
+
+	// All the small leafs are built in parallel, one for each thread
+	#pragma omp parallel for schedule(dynamic, 1)
+	for (
+			// Visual C++ 2013 supports only OpenMP 2.5
+#if _OPENMP >= 200805
+			unsigned
+#endif
+			int i = nLargeLeafs; i < nUniqueLeafs; ++i) {
+		const u_int uniqueLeafIndex = buildOrder[i];
+		const Mesh *mesh = uniqueLeafMeshes[uniqueLeafIndex];
+
+		BVHAccel *leaf = new BVHAccel(ctx);
+		// Log only from the critical section below
+		leaf->verbose = false;
+		deque<const Mesh *> mlist(1, mesh);
+		leaf->Init(mlist, mesh->GetTotalVertexCount(), mesh->GetTotalTriangleCount());
+		uniqueLeafs[uniqueLeafIndex] = leaf;
+
+		#pragma omp critical
+		{
+			++builtLeafs;
+
+			const double now = WallClockTime();
+			if (now - lastPrint > 2.0) {
+				LR_LOG(ctx, "Building BVH for MBVH leaf: " << builtLeafs << "/" << nUniqueLeafs);
+				lastPrint = now;
+			}
+		}
+	}
+
+	if (embreeBuilder)
+		ReleaseEmbreeBuilderDevice();
+
 	//--------------------------------------------------------------------------
 	// Build the root BVH
 	//--------------------------------------------------------------------------
@@ -18,6 +18,7 @@
 
 #include "luxrays/utils/strutils.h"
 #include "luxrays/core/accelerator.h"
+#include "luxrays/core/epsilon.h"
 
 using namespace std;
 using namespace luxrays;
@@ -53,3 +54,21 @@ AcceleratorType Accelerator::String2AcceleratorType(const string &type) {
 	else
 		throw runtime_error("Unknown accelerator type in String2AcceleratorType(): " + type);
 }
+
+bool Accelerator::Occluded(const Ray *ray, OcclusionFilter *filter) const {
+	// The default implementation, for accelerators without a native occlusion
+	// query, is a loop over the closest hits
+	Ray occlusionRay(*ray);
+	RayHit hit;
+	while (Intersect(&occlusionRay, &hit)) {
+		if (!filter || filter->IsOccluder(occlusionRay, hit))
+			return true;
+
+		occlusionRay.mint = hit.t + MachineEpsilon::E(hit.t);
+		// A safety check in case of not enough numerical precision
+		if ((occlusionRay.mint == hit.t) || (occlusionRay.mint >= occlusionRay.maxt))
+			return false;
+	}
+
+	return false;
+}
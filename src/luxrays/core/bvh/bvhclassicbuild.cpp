@@ -17,8 +17,8 @@
  ***************************************************************************/
 
 // Boundary Volume Hierarchy
-// Based of "Efficiency Issues for Ray Tracing" by Brian Smits
-// Available at http://www.cs.utah.edu/~bes/papers/fastRT/paper.html
+// Binned SAH builder, the tree is built one level at time: large ranges are
+// binned with all threads while small ranges are processed in parallel.
 
 #include <iostream>
 #include <functional>
@@ -32,154 +32,339 @@ using namespace std;
 
 namespace luxrays {
 
-// Build an array of comparators for each axis
+//------------------------------------------------------------------------------
+// Binned SAH split
+//------------------------------------------------------------------------------
 
-static bool bvh_ltf_x(BVHTreeNode *n, float v) {
-	return n->bbox.pMax.x + n->bbox.pMin.x < v;
-}
+#define BVH_DEFAULT_BIN_COUNT 16u
+#define BVH_MAX_BIN_COUNT 64u
+#define BVH_MAX_TREE_TYPE 8u
 
-static bool bvh_ltf_y(BVHTreeNode *n, float v) {
-	return n->bbox.pMax.y + n->bbox.pMin.y < v;
-}
+namespace {
+
+class BVHBins {
+public:
+	BVHBins() {
+		for (u_int axis = 0; axis < 3; ++axis) {
+			for (u_int i = 0; i < BVH_MAX_BIN_COUNT; ++i)
+				counts[axis][i] = 0;
+		}
+	}
+
+	void Add(const BVHBins &bins, const u_int binCount) {
+		for (u_int axis = 0; axis < 3; ++axis) {
+			for (u_int i = 0; i < binCount; ++i) {
+				bboxes[axis][i] = Union(bboxes[axis][i], bins.bboxes[axis][i]);
+				counts[axis][i] += bins.counts[axis][i];
+			}
+		}
+	}
 
-static bool bvh_ltf_z(BVHTreeNode *n, float v) {
-	return n->bbox.pMax.z + n->bbox.pMin.z < v;
+	BBox bboxes[3][BVH_MAX_BIN_COUNT];
+	u_int counts[3][BVH_MAX_BIN_COUNT];
+};
+
+class BVHBinner {
+public:
+	BVHBinner(const BBox &centroidBBox, const u_int count) : binCount(count) {
+		pMin = centroidBBox.pMin;
+		for (u_int axis = 0; axis < 3; ++axis) {
+			const float extent = centroidBBox.pMax[axis] - centroidBBox.pMin[axis];
+			scale[axis] = (extent > 0.f) ? (binCount / extent) : 0.f;
+		}
+	}
+
+	u_int GetBin(const BVHTreeNode *node, const u_int axis) const {
+		const float c = node->bbox.pMin[axis] + node->bbox.pMax[axis];
+		const int bin = (int)((c - pMin[axis]) * scale[axis]);
+
+		return (u_int)Clamp<int>(bin, 0, binCount - 1);
+	}
+
+	void Bin(const BVHTreeNode *node, BVHBins &bins) const {
+		for (u_int axis = 0; axis < 3; ++axis) {
+			const u_int bin = GetBin(node, axis);
+			bins.bboxes[axis][bin] = Union(bins.bboxes[axis][bin], node->bbox);
+			++bins.counts[axis][bin];
+		}
+	}
+
+	Point pMin;
+	float scale[3];
+	u_int binCount;
+};
+
+static BBox CentroidBBox(const BVHTreeNode *node) {
+	return BBox(node->bbox.pMin + node->bbox.pMax);
 }
 
-static bool (* const bvh_ltf[3])(BVHTreeNode *n, float v) = { bvh_ltf_x, bvh_ltf_y, bvh_ltf_z };
+static void ComputeRangeBBoxes(const vector<BVHTreeNode *> &list,
+		const u_int begin, const u_int end, const bool parallel,
+		BBox &rangeBBox, BBox &centroidBBox) {
+	rangeBBox = BBox();
+	centroidBBox = BBox();
+
+	if (parallel) {
+		#pragma omp parallel
+		{
+			BBox threadRangeBBox, threadCentroidBBox;
+
+			#pragma omp for
+			for (
+					// Visual C++ 2013 supports only OpenMP 2.5
+#if _OPENMP >= 200805
+					unsigned
+#endif
+					int i = begin; i < end; ++i) {
+				threadRangeBBox = Union(threadRangeBBox, list[i]->bbox);
+				threadCentroidBBox = Union(threadCentroidBBox, CentroidBBox(list[i]));
+			}
 
-static void FindBestSplit(const BVHParams &params, vector<BVHTreeNode *> &list,
-		u_int begin, u_int end, float *splitValue, u_int *bestAxis) {
-	if (end - begin == 2) {
-		// Trivial case with two elements
-		*splitValue = (list[begin]->bbox.pMax[0] + list[begin]->bbox.pMin[0] +
-				list[end - 1]->bbox.pMax[0] + list[end - 1]->bbox.pMin[0]) / 2;
-		*bestAxis = 0;
+			#pragma omp critical
+			{
+				rangeBBox = Union(rangeBBox, threadRangeBBox);
+				centroidBBox = Union(centroidBBox, threadCentroidBBox);
+			}
+		}
 	} else {
-		// Calculate BBs mean center (times 2)
-		Point mean2(0, 0, 0), var(0, 0, 0);
-		for (u_int i = begin; i < end; i++)
-			mean2 += list[i]->bbox.pMax + list[i]->bbox.pMin;
-		mean2 /= static_cast<float>(end - begin);
-
-		// Calculate variance
-		for (u_int i = begin; i < end; i++) {
-			Vector v = list[i]->bbox.pMax + list[i]->bbox.pMin - mean2;
-			v.x *= v.x;
-			v.y *= v.y;
-			v.z *= v.z;
-			var += v;
+		for (u_int i = begin; i < end; ++i) {
+			rangeBBox = Union(rangeBBox, list[i]->bbox);
+			centroidBBox = Union(centroidBBox, CentroidBBox(list[i]));
 		}
-		// Select axis with more variance
-		if (var.x > var.y && var.x > var.z)
-			*bestAxis = 0;
-		else if (var.y > var.z)
-			*bestAxis = 1;
-		else
-			*bestAxis = 2;
-
-		if (params.costSamples > 1) {
-			BBox nodeBounds;
-			for (u_int i = begin; i < end; i++)
-				nodeBounds = Union(nodeBounds, list[i]->bbox);
-
-			Vector d = nodeBounds.pMax - nodeBounds.pMin;
-			const float invTotalSA = 1.f / nodeBounds.SurfaceArea();
-
-			// Sample cost for split at some points
-			const float increment = 2 * d[*bestAxis] / (params.costSamples + 1);
-			float bestCost = INFINITY;
-			for (float splitVal = 2 * nodeBounds.pMin[*bestAxis] + increment; splitVal < 2 * nodeBounds.pMax[*bestAxis]; splitVal += increment) {
-				int nBelow = 0, nAbove = 0;
-				BBox bbBelow, bbAbove;
-				for (u_int j = begin; j < end; j++) {
-					if ((list[j]->bbox.pMax[*bestAxis] + list[j]->bbox.pMin[*bestAxis]) < splitVal) {
-						nBelow++;
-						bbBelow = Union(bbBelow, list[j]->bbox);
-					} else {
-						nAbove++;
-						bbAbove = Union(bbAbove, list[j]->bbox);
-					}
-				}
-				const float pBelow = bbBelow.SurfaceArea() * invTotalSA;
-				const float pAbove = bbAbove.SurfaceArea() * invTotalSA;
-				const float eb = (nAbove == 0 || nBelow == 0) ? params.emptyBonus : 0.f;
-				const float cost = params.traversalCost + params.isectCost * (1.f - eb) * (pBelow * nBelow + pAbove * nAbove);
-				// Update best split if this is lowest cost so far
-				if (cost < bestCost) {
-					bestCost = cost;
-					*splitValue = splitVal;
-				}
+	}
+}
+
+static void ComputeRangeBins(const vector<BVHTreeNode *> &list,
+		const u_int begin, const u_int end, const bool parallel,
+		const BVHBinner &binner, BVHBins &bins) {
+	if (parallel) {
+		#pragma omp parallel
+		{
+			BVHBins threadBins;
+
+			#pragma omp for
+			for (
+					// Visual C++ 2013 supports only OpenMP 2.5
+#if _OPENMP >= 200805
+					unsigned
+#endif
+					int i = begin; i < end; ++i)
+				binner.Bin(list[i], threadBins);
+
+			#pragma omp critical
+			{
+				bins.Add(threadBins, binner.binCount);
 			}
-		} else {
-			// Split in half around the mean center
-			*splitValue = mean2[*bestAxis];
 		}
+	} else {
+		for (u_int i = begin; i < end; ++i)
+			binner.Bin(list[i], bins);
 	}
 }
 
-static BVHTreeNode *BuildBVH(u_int *nNodes, const BVHParams &params,
-		vector<BVHTreeNode *> &leafList, u_int begin, u_int end, u_int axis) {
-	u_int splitAxis = axis;
-	float splitValue;
-
-	*nNodes += 1;
-	if (end - begin == 1) {
-		// Only a single item in list so return it
-		BVHTreeNode *node = new BVHTreeNode();
-		*node = *(leafList[begin]);
-		return node;
+// Splits the range in two and returns the index of the first element of
+// the second half
+static u_int SplitRange(const BVHParams &params, vector<BVHTreeNode *> &list,
+		const u_int begin, const u_int end, BBox *rangeBBox) {
+	const bool parallel = (end - begin >= BVH_PARALLEL_RANGE_SIZE);
+
+	BBox bbox, centroidBBox;
+	ComputeRangeBBoxes(list, begin, end, parallel, bbox, centroidBBox);
+	if (rangeBBox)
+		*rangeBBox = bbox;
+
+	const u_int binCount = (params.costSamples > 1) ?
+		Min<u_int>(params.costSamples, BVH_MAX_BIN_COUNT) : BVH_DEFAULT_BIN_COUNT;
+	const BVHBinner binner(centroidBBox, binCount);
+
+	BVHBins bins;
+	ComputeRangeBins(list, begin, end, parallel, binner, bins);
+
+	// Evaluate the SAH cost of all bin boundaries along the 3 axis
+	const float sa = bbox.SurfaceArea();
+	const float invTotalSA = (sa > 0.f) ? (1.f / sa) : 0.f;
+
+	float bestCost = numeric_limits<float>::infinity();
+	u_int bestAxis = 0;
+	u_int bestBin = 0;
+	for (u_int axis = 0; axis < 3; ++axis) {
+		if (binner.scale[axis] == 0.f)
+			continue;
+
+		// Sweep from right to left to get the areas of the right sides
+		float rightArea[BVH_MAX_BIN_COUNT];
+		u_int rightCount[BVH_MAX_BIN_COUNT];
+		BBox rightBBox;
+		u_int count = 0;
+		for (u_int i = binCount - 1; i > 0; --i) {
+			rightBBox = Union(rightBBox, bins.bboxes[axis][i]);
+			count += bins.counts[axis][i];
+			rightArea[i] = rightBBox.SurfaceArea();
+			rightCount[i] = count;
+		}
+
+		// Sweep from left to right and evaluate the cost
+		BBox leftBBox;
+		u_int leftCount = 0;
+		for (u_int i = 0; i < binCount - 1; ++i) {
+			leftBBox = Union(leftBBox, bins.bboxes[axis][i]);
+			leftCount += bins.counts[axis][i];
+
+			if ((leftCount == 0) || (rightCount[i + 1] == 0))
+				continue;
+
+			const float pLeft = leftBBox.SurfaceArea() * invTotalSA;
+			const float pRight = rightArea[i + 1] * invTotalSA;
+			const float cost = params.traversalCost + params.isectCost *
+					(pLeft * leftCount + pRight * rightCount[i + 1]);
+			if (cost < bestCost) {
+				bestCost = cost;
+				bestAxis = axis;
+				bestBin = i;
+			}
+		}
 	}
 
-	BVHTreeNode *parent = new BVHTreeNode();
-	parent->leftChild = NULL;
-	parent->rightSibling = NULL;
-
-	vector<u_int> splits;
-	splits.reserve(params.treeType + 1);
-	splits.push_back(begin);
-	splits.push_back(end);
-	for (u_int i = 2; i <= params.treeType; i *= 2) { // Calculate splits, according to tree type and do partition
-		for (u_int j = 0, offset = 0; j + offset < i && splits.size() > j + 1; j += 2) {
-			if (splits[j + 1] - splits[j] < 2) {
-				j--;
-				offset++;
-				continue; // Less than two elements: no need to split
+	u_int middle;
+	if (bestCost == numeric_limits<float>::infinity()) {
+		// All centroids are coincidental, just split in half
+		middle = (begin + end) / 2;
+	} else {
+		vector<BVHTreeNode *>::iterator it = partition(list.begin() + begin, list.begin() + end,
+				[&](const BVHTreeNode *node) { return binner.GetBin(node, bestAxis) <= bestBin; });
+		middle = distance(list.begin(), it);
+	}
+
+	// Make sure coincidental BBs are still split
+	return Max(begin + 1, Min(end - 1, middle));
+}
+
+//------------------------------------------------------------------------------
+// Level by level build
+//------------------------------------------------------------------------------
+
+class BVHBuildItem {
+public:
+	BVHBuildItem() { }
+	BVHBuildItem(BVHTreeNode *n, const u_int b, const u_int e) :
+		node(n), begin(b), end(e), splitCount(0) { }
+
+	BVHTreeNode *node;
+	u_int begin, end;
+
+	// The children ranges
+	u_int splits[BVH_MAX_TREE_TYPE + 1];
+	u_int splitCount;
+};
+
+static void BuildItem(const BVHParams &params, vector<BVHTreeNode *> &leafList,
+		BVHBuildItem &item) {
+	BVHTreeNode *node = item.node;
+
+	if (item.end - item.begin == 1) {
+		// Only a single item in list so copy it. The rightSibling has been
+		// already set by the parent.
+		BVHTreeNode *rightSibling = node->rightSibling;
+		*node = *(leafList[item.begin]);
+		node->leftChild = NULL;
+		node->rightSibling = rightSibling;
+		return;
+	}
+
+	item.splits[0] = item.begin;
+	item.splits[1] = item.end;
+	item.splitCount = 2;
+
+	// Calculate splits, according to tree type and do partition
+	for (u_int i = 2; i <= params.treeType; i *= 2) {
+		const u_int rangeCount = item.splitCount - 1;
+		for (u_int r = 0, j = 0; r < rangeCount; ++r) {
+			const u_int begin = item.splits[j];
+			const u_int end = item.splits[j + 1];
+
+			if (end - begin < 2) {
+				// Less than two elements: no need to split
+				++j;
+				continue;
 			}
 
-			FindBestSplit(params, leafList, splits[j], splits[j + 1], &splitValue, &splitAxis);
+			const u_int middle = SplitRange(params, leafList, begin, end,
+					(i == 2) ? &node->bbox : NULL);
+
+			for (u_int k = item.splitCount; k > j + 1; --k)
+				item.splits[k] = item.splits[k - 1];
+			item.splits[j + 1] = middle;
+			++item.splitCount;
 
-			vector<BVHTreeNode *>::iterator it =
-				//C++17 compatibility: replace bind2nd and ptr_fun by lambda funciton
-				//partition(leafList.begin() + splits[j], leafList.begin() + splits[j + 1], bind2nd(ptr_fun(bvh_ltf[splitAxis]), splitValue));
-				partition(leafList.begin() + splits[j], leafList.begin() + splits[j + 1], [&](auto elem) { return bvh_ltf[splitAxis](elem, splitValue); });
-			u_int middle = distance(leafList.begin(), it);
-			middle = Max(splits[j] + 1, Min(splits[j + 1] - 1, middle)); // Make sure coincidental BBs are still split
-			splits.insert(splits.begin() + j + 1, middle);
+			j += 2;
 		}
 	}
+}
+
+static BVHTreeNode *BuildBVH(u_int *nNodes, const BVHParams &params,
+		vector<BVHTreeNode *> &leafList, vector<BVHTreeNode> &arena) {
+	// A tree with N leafs has at most 2N - 1 nodes
+	arena.resize(2 * leafList.size() - 1);
+
+	BVHTreeNode *root = &arena[0];
+	root->leftChild = NULL;
+	root->rightSibling = NULL;
+	u_int arenaIndex = 1;
+
+	vector<BVHBuildItem> items(1, BVHBuildItem(root, 0, leafList.size()));
+	vector<BVHBuildItem> nextItems;
+	while (items.size() > 0) {
+		// Few large ranges are split one at time using all threads
+		for (u_int i = 0; i < items.size(); ++i) {
+			if (items[i].end - items[i].begin >= BVH_PARALLEL_RANGE_SIZE)
+				BuildItem(params, leafList, items[i]);
+		}
 
-	// Left Child
-	BVHTreeNode *child = BuildBVH(nNodes, params, leafList, splits[0], splits[1], splitAxis);
-	parent->leftChild = child;
-	parent->bbox = child->bbox;
-	BVHTreeNode *lastChild = child;
-
-	// Add remaining children
-	for (u_int i = 1; i < splits.size() - 1; i++) {
-		child = BuildBVH(nNodes, params, leafList, splits[i], splits[i + 1], splitAxis);
-		lastChild->rightSibling = child;
-		parent->bbox = Union(parent->bbox, child->bbox);
-		lastChild = child;
+		// All small ranges are split in parallel
+		#pragma omp parallel for schedule(dynamic, 16)
+		for (
+				// Visual C++ 2013 supports only OpenMP 2.5
+#if _OPENMP >= 200805
+				unsigned
+#endif
+				int i = 0; i < items.size(); ++i) {
+			if (items[i].end - items[i].begin < BVH_PARALLEL_RANGE_SIZE)
+				BuildItem(params, leafList, items[i]);
+		}
+
+		// Allocate the children of the current level from the arena
+		nextItems.clear();
+		for (u_int i = 0; i < items.size(); ++i) {
+			const BVHBuildItem &item = items[i];
+			if (item.splitCount == 0)
+				continue;
+
+			BVHTreeNode *firstChild = &arena[arenaIndex];
+			const u_int childCount = item.splitCount - 1;
+			for (u_int j = 0; j < childCount; ++j) {
+				BVHTreeNode *child = &arena[arenaIndex++];
+				child->leftChild = NULL;
+				child->rightSibling = (j < childCount - 1) ? &arena[arenaIndex] : NULL;
+
+				nextItems.push_back(BVHBuildItem(child, item.splits[j], item.splits[j + 1]));
+			}
+			item.node->leftChild = firstChild;
+		}
+
+		items.swap(nextItems);
 	}
 
-	return parent;
+	*nNodes = arenaIndex;
+
+	return root;
 }
 
-BVHTreeNode *BuildBVH(u_int *nNodes, const BVHParams &params, vector<BVHTreeNode *> &leafList) {
-	return BuildBVH(nNodes, params, leafList, 0, leafList.size(), 2);
 }
 
+//------------------------------------------------------------------------------
+// BuildBVHArray
+//------------------------------------------------------------------------------
+
 u_int BuildBVHArray(const deque<const Mesh *> *meshes, BVHTreeNode *node,
 		u_int offset, luxrays::ocl::BVHArrayNode *bvhArrayTree) {
 	// Build array by recursively traversing the tree depth-first
@@ -225,11 +410,15 @@ luxrays::ocl::BVHArrayNode *BuildBVH(const BVHParams &params,
 		u_int *nNodes, const std::deque<const Mesh *> *meshes,
 		std::vector<BVHTreeNode *> &leafList) {
 	*nNodes = 0;
-	BVHTreeNode *rootNode = BuildBVH(nNodes, params, leafList);
-	
+	if (leafList.size() == 0)
+		return NULL;
+
+	// All nodes are allocated from the arena and freed all together
+	vector<BVHTreeNode> arena;
+	BVHTreeNode *rootNode = BuildBVH(nNodes, params, leafList, arena);
+
 	luxrays::ocl::BVHArrayNode *bvhArrayTree = new luxrays::ocl::BVHArrayNode[*nNodes];
 	BuildBVHArray(meshes, rootNode, 0, bvhArrayTree);
-	FreeBVH(rootNode);
 
 	return bvhArrayTree;
 }
@@ -75,9 +75,35 @@ public:
 	u_int nodeCounter;
 };
 
+// The shared Embree device
+static boost::mutex embreeBuilderDeviceMutex;
+static RTCDevice embreeBuilderDevice = NULL;
+static u_int embreeBuilderDeviceRefCount = 0;
+
+void AcquireEmbreeBuilderDevice() {
+	boost::unique_lock<boost::mutex> lock(embreeBuilderDeviceMutex);
+
+	if (embreeBuilderDeviceRefCount == 0)
+		embreeBuilderDevice = rtcNewDevice(NULL);
+	++embreeBuilderDeviceRefCount;
+}
+
+void ReleaseEmbreeBuilderDevice() {
+	boost::unique_lock<boost::mutex> lock(embreeBuilderDeviceMutex);
+
+	assert (embreeBuilderDeviceRefCount > 0);
+	--embreeBuilderDeviceRefCount;
+	if (embreeBuilderDeviceRefCount == 0) {
+		rtcReleaseDevice(embreeBuilderDevice);
+		embreeBuilderDevice = NULL;
+	}
+}
+
 // BVHEmbreeBuilderGlobalData
 BVHEmbreeBuilderGlobalData::BVHEmbreeBuilderGlobalData() {
-	embreeDevice = rtcNewDevice(NULL);
+	AcquireEmbreeBuilderDevice();
+	// The device can not change while I hold a reference to it
+	embreeDevice = embreeBuilderDevice;
 	embreeBVH = rtcNewBVH(embreeDevice);
 
 	nodeCounter = 0;
@@ -85,7 +111,7 @@ BVHEmbreeBuilderGlobalData::BVHEmbreeBuilderGlobalData() {
 
 BVHEmbreeBuilderGlobalData::~BVHEmbreeBuilderGlobalData() {
 	rtcReleaseBVH(embreeBVH);
-	rtcReleaseDevice(embreeDevice);
+	ReleaseEmbreeBuilderDevice();
 }
 
 //------------------------------------------------------------------------------
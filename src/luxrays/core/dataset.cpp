@@ -47,6 +47,8 @@ DataSet::DataSet(const Context *luxRaysContext) {
 	totalVertexCount = 0;
 	totalTriangleCount = 0;
 
+	accelsBuildTime = 0.0;
+
 	preprocessed = false;
 	hasInstances = false;
 	hasMotionBlur = false;
@@ -144,7 +146,9 @@ const Accelerator *DataSet::GetAccelerator(const AcceleratorType accelType) {
 					throw runtime_error("Unknown AcceleratorType in DataSet::AddAccelerator()");
 			}
 
+			const double startTime = WallClockTime();
 			accel->Init(meshes, totalVertexCount, totalTriangleCount);
+			accelsBuildTime += WallClockTime() - startTime;
 
 			accels[accelType] = accel;
 
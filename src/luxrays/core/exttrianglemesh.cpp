@@ -135,6 +135,11 @@ ExtTriangleMesh::ExtTriangleMesh(const u_int meshVertCount, const u_int meshTriC
 	fill(vertAOV.begin(), vertAOV.end(), nullptr);
 	fill(triAOV.begin(), triAOV.end(), nullptr);
 
+	packedNormals = nullptr;
+	fill(packedUVs.begin(), packedUVs.end(), nullptr);
+	fill(packedCols.begin(), packedCols.end(), nullptr);
+	compressed = false;
+
 	array<UV *, EXTMESH_MAX_DATA_COUNT> meshUVs;
 	fill(meshUVs.begin(), meshUVs.end(), nullptr);
 	if (mUVs)
@@ -171,6 +176,11 @@ ExtTriangleMesh::ExtTriangleMesh(const u_int meshVertCount, const u_int meshTriC
 	fill(vertAOV.begin(), vertAOV.end(), nullptr);
 	fill(triAOV.begin(), triAOV.end(), nullptr);
 
+	packedNormals = nullptr;
+	fill(packedUVs.begin(), packedUVs.end(), nullptr);
+	fill(packedCols.begin(), packedCols.end(), nullptr);
+	compressed = false;
+
 	Init(meshNormals, meshUVs, meshCols, meshAlphas);
 }
 
@@ -223,6 +233,12 @@ void ExtTriangleMesh::Delete() {
 		delete[] uv;
 	for (Spectrum *c : cols)
 		delete[] c;
+
+	delete[] packedNormals;
+	for (u_int *uv : packedUVs)
+		delete[] uv;
+	for (u_short *c : packedCols)
+		delete[] c;
 	for (float *a : alphas)
 		delete[] a;
 	for (float *v : vertAOV)
@@ -236,6 +252,11 @@ void ExtTriangleMesh::Delete() {
 }
 
 Normal *ExtTriangleMesh::ComputeNormals() {
+	// The normals are going to be overwritten so there is no need to decode
+	// the compressed ones
+	delete[] packedNormals;
+	packedNormals = nullptr;
+
 	bool allocated;
 	if (!normals) {
 		allocated = true;
@@ -280,11 +301,132 @@ void ExtTriangleMesh::ApplyTransform(const Transform &trans) {
 			normals[i] *= trans;
 			normals[i] = Normalize(normals[i]);
 		}
+	} else if (packedNormals) {
+		for (u_int i = 0; i < vertCount; ++i)
+			packedNormals[i] = PackOctahedralNormal(Normalize(trans * UnpackOctahedralNormal(packedNormals[i])));
 	}
 
 	Preprocess();
 }
 
+void ExtTriangleMesh::Compress() {
+	if (normals) {
+		packedNormals = new u_int[vertCount];
+		for (u_int i = 0; i < vertCount; ++i)
+			packedNormals[i] = PackOctahedralNormal(normals[i]);
+
+		delete[] normals;
+		normals = nullptr;
+	}
+
+	for (u_int i = 0; i < EXTMESH_MAX_DATA_COUNT; ++i) {
+		if (uvs[i]) {
+			packedUVs[i] = new u_int[vertCount];
+			for (u_int j = 0; j < vertCount; ++j)
+				packedUVs[i][j] = PackUV(uvs[i][j]);
+
+			delete[] uvs[i];
+			uvs[i] = nullptr;
+		}
+
+		if (cols[i]) {
+			packedCols[i] = new u_short[vertCount * 3];
+			for (u_int j = 0; j < vertCount; ++j)
+				PackSpectrum(cols[i][j], &packedCols[i][j * 3]);
+
+			delete[] cols[i];
+			cols[i] = nullptr;
+		}
+	}
+
+	compressed = true;
+}
+
+void ExtTriangleMesh::Decompress() {
+	if (packedNormals) {
+		normals = new Normal[vertCount];
+		for (u_int i = 0; i < vertCount; ++i)
+			normals[i] = UnpackOctahedralNormal(packedNormals[i]);
+
+		delete[] packedNormals;
+		packedNormals = nullptr;
+	}
+
+	for (u_int i = 0; i < EXTMESH_MAX_DATA_COUNT; ++i) {
+		if (packedUVs[i]) {
+			uvs[i] = new UV[vertCount];
+			for (u_int j = 0; j < vertCount; ++j)
+				uvs[i][j] = UnpackUV(packedUVs[i][j]);
+
+			delete[] packedUVs[i];
+			packedUVs[i] = nullptr;
+		}
+
+		if (packedCols[i]) {
+			cols[i] = new Spectrum[vertCount];
+			for (u_int j = 0; j < vertCount; ++j)
+				cols[i][j] = UnpackSpectrum(&packedCols[i][j * 3]);
+
+			delete[] packedCols[i];
+			packedCols[i] = nullptr;
+		}
+	}
+
+	compressed = false;
+}
+
+size_t ExtTriangleMesh::GetMemoryUsage() const {
+	size_t size = vertCount * sizeof(Point) + triCount * (sizeof(Triangle) + sizeof(Normal));
+
+	if (normals)
+		size += vertCount * sizeof(Normal);
+	else if (packedNormals)
+		size += vertCount * sizeof(u_int);
+
+	for (u_int i = 0; i < EXTMESH_MAX_DATA_COUNT; ++i) {
+		if (uvs[i])
+			size += vertCount * sizeof(UV);
+		else if (packedUVs[i])
+			size += vertCount * sizeof(u_int);
+
+		if (cols[i])
+			size += vertCount * sizeof(Spectrum);
+		else if (packedCols[i])
+			size += vertCount * 3 * sizeof(u_short);
+
+		if (alphas[i])
+			size += vertCount * sizeof(float);
+		if (vertAOV[i])
+			size += vertCount * sizeof(float);
+		if (triAOV[i])
+			size += triCount * sizeof(float);
+	}
+
+	return size;
+}
+
+size_t ExtTriangleMesh::GetUncompressedMemoryUsage() const {
+	size_t size = vertCount * sizeof(Point) + triCount * (sizeof(Triangle) + sizeof(Normal));
+
+	if (HasNormals())
+		size += vertCount * sizeof(Normal);
+
+	for (u_int i = 0; i < EXTMESH_MAX_DATA_COUNT; ++i) {
+		if (HasUVs(i))
+			size += vertCount * sizeof(UV);
+		if (HasColors(i))
+			size += vertCount * sizeof(Spectrum);
+		if (HasAlphas(i))
+			size += vertCount * sizeof(float);
+		if (HasVertexAOV(i))
+			size += vertCount * sizeof(float);
+		if (HasTriAOV(i))
+			size += triCount * sizeof(float);
+	}
+
+	return size;
+}
+
 void ExtTriangleMesh::CopyAOV(ExtTriangleMesh *destMesh) const {
 	for (u_int i = 0; i < EXTMESH_MAX_DATA_COUNT; ++i) {
 		if (HasVertexAOV(i)) {
@@ -325,7 +467,8 @@ ExtTriangleMesh *ExtTriangleMesh::CopyExt(Point *meshVertices, Triangle *meshTri
 	Normal *ns = meshNormals;
 	if (!ns && HasNormals()) {
 		ns = new Normal[vertCount];
-		copy(normals, normals + vertCount, ns);
+		for (u_int i = 0; i < vertCount; ++i)
+			ns[i] = GetVertexNormal(i);
 	}
 
 	array<UV *, EXTMESH_MAX_DATA_COUNT> us;
@@ -334,13 +477,15 @@ ExtTriangleMesh *ExtTriangleMesh::CopyExt(Point *meshVertices, Triangle *meshTri
 	for (u_int i = 0; i < EXTMESH_MAX_DATA_COUNT; ++i) {
 		if (HasUVs(i) && (!meshUVs || !(*meshUVs)[i])) {
 			us[i] = new UV[vertCount];
-			copy(uvs[i], uvs[i] + vertCount, us[i]);
+			for (u_int j = 0; j < vertCount; ++j)
+				us[i][j] = GetVertexUV(j, i);
 		} else
 			us[i] = meshUVs ? (*meshUVs)[i] : nullptr;
 
 		if (HasColors(i) && (!meshCols || !(*meshCols)[i])) {
 			cs[i] = new Spectrum[vertCount];
-			copy(cols[i], cols[i] + vertCount, cs[i]);
+			for (u_int j = 0; j < vertCount; ++j)
+				cs[i][j] = GetVertexColor(j, i);
 		} else
 			cs[i] = meshCols ? (*meshCols)[i] : nullptr;
 
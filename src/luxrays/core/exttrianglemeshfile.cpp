@@ -525,14 +525,20 @@ void ExtTriangleMesh::SavePly(const string &fileName) const {
 	// Write all vertex data
 	for (u_int i = 0; i < vertCount; ++i) {
 		plyFile.write((char *)&vertices[i], sizeof(Point));
-		if (HasNormals())
-			plyFile.write((char *)&normals[i], sizeof(Normal));
+		if (HasNormals()) {
+			const Normal n = GetVertexNormal(i);
+			plyFile.write((char *)&n, sizeof(Normal));
+		}
 
 		for (u_int j = 0; j < EXTMESH_MAX_DATA_COUNT; ++j) {
-			if (HasUVs(j))
-				plyFile.write((char *)&uvs[j][i], sizeof(UV));
-			if (HasColors(j))
-				plyFile.write((char *)&cols[j][i], sizeof(Spectrum));
+			if (HasUVs(j)) {
+				const UV uv = GetVertexUV(i, j);
+				plyFile.write((char *)&uv, sizeof(UV));
+			}
+			if (HasColors(j)) {
+				const Spectrum c = GetVertexColor(i, j);
+				plyFile.write((char *)&c, sizeof(Spectrum));
+			}
 			if (HasAlphas(j))
 				plyFile.write((char *)&alphas[j][i], sizeof(float));
 			if (HasVertexAOV(j))
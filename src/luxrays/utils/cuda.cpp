@@ -28,6 +28,7 @@
 #include "luxrays/luxrays.h"
 #include "luxrays/utils/utils.h"
 #include "luxrays/utils/config.h"
+#include "luxrays/utils/safesave.h"
 #include "luxrays/utils/cudacache.h"
 #include "luxrays/utils/oclcache.h"
 
@@ -175,26 +176,34 @@ bool cudaKernelPersistentCache::CompilePTX(const vector<string> &kernelsParamete
 			// Add the kernel to the cache
 			boost::filesystem::create_directories(dirPath);
 
-			// The use of boost::filesystem::path is required for UNICODE support: fileName
-			// is supposed to be UTF-8 encoded.
-			boost::filesystem::ofstream file(boost::filesystem::path(fileName),
-					boost::filesystem::ofstream::out |
-					boost::filesystem::ofstream::binary |
-					boost::filesystem::ofstream::trunc);
-
-			// Write the binary hash
-			const u_int hashBin = oclKernelPersistentCache::HashBin(*ptx, *ptxSize);
-			file.write((char *)&hashBin, sizeof(int));
-
-			file.write(*ptx, *ptxSize);
-			// Check for errors
-			char buf[512];
-			if (file.fail()) {
-				sprintf(buf, "Unable to write kernel file cache %s", fileName.c_str());
-				throw runtime_error(buf);
+			// The file is written with a temporary name and renamed at the end
+			// so other threads never read a partially written kernel
+			SafeSave safeSave(fileName);
+
+			{
+				// The use of boost::filesystem::path is required for UNICODE support: fileName
+				// is supposed to be UTF-8 encoded.
+				boost::filesystem::ofstream file(boost::filesystem::path(safeSave.GetSaveFileName()),
+						boost::filesystem::ofstream::out |
+						boost::filesystem::ofstream::binary |
+						boost::filesystem::ofstream::trunc);
+
+				// Write the binary hash
+				const u_int hashBin = oclKernelPersistentCache::HashBin(*ptx, *ptxSize);
+				file.write((char *)&hashBin, sizeof(int));
+
+				file.write(*ptx, *ptxSize);
+				// Check for errors
+				char buf[512];
+				if (file.fail()) {
+					sprintf(buf, "Unable to write kernel file cache %s", fileName.c_str());
+					throw runtime_error(buf);
+				}
+
+				file.close();
 			}
 
-			file.close();
+			safeSave.Process();
 
 			return true;
 		} else
@@ -19,17 +19,21 @@
 #if !defined(LUXRAYS_DISABLE_OPENCL)
 
 #include <iostream>
+#include <set>
 #include <string.h>
 
 #include <boost/algorithm/string/replace.hpp>
 #include <boost/algorithm/string/trim.hpp>
 #include <boost/filesystem/fstream.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
 
 #include "luxrays/luxrays.h"
 #include "luxrays/utils/utils.h"
 #include "luxrays/utils/oclerror.h"
 #include "luxrays/utils/oclcache.h"
 #include "luxrays/utils/config.h"
+#include "luxrays/utils/safesave.h"
 
 using namespace std;
 using namespace luxrays;
@@ -243,6 +247,91 @@ u_int oclKernelPersistentCache::HashBin(const char *s, const size_t size) {
 	return hash;
 }
 
+//------------------------------------------------------------------------------
+// The set of cache files under compilation. It is used to compile a program
+// only once when the same kernel is requested by multiple threads (i.e.
+// multiple identical devices or the background kernel compilation).
+//------------------------------------------------------------------------------
+
+namespace {
+
+boost::mutex compilingFilesMutex;
+boost::condition_variable compilingFilesCondition;
+set<string> compilingFiles;
+
+class CompilingFileLock {
+public:
+	CompilingFileLock(const string &name) : fileName(name), owner(false) {
+		boost::unique_lock<boost::mutex> lock(compilingFilesMutex);
+
+		// Wait for any other thread compiling the same kernel
+		while (compilingFiles.count(fileName) > 0)
+			compilingFilesCondition.wait(lock);
+
+		if (!boost::filesystem::exists(boost::filesystem::path(fileName))) {
+			compilingFiles.insert(fileName);
+			owner = true;
+		}
+	}
+
+	~CompilingFileLock() {
+		if (owner) {
+			{
+				boost::unique_lock<boost::mutex> lock(compilingFilesMutex);
+				compilingFiles.erase(fileName);
+			}
+
+			compilingFilesCondition.notify_all();
+		}
+	}
+
+	// Return true if the kernel has to be compiled by this thread
+	bool IsOwner() const { return owner; }
+
+private:
+	const string fileName;
+	bool owner;
+};
+
+string GetPlatformInfo(cl_platform_id platform, cl_platform_info param) {
+	size_t valueSize;
+	CHECK_OCL_ERROR(clGetPlatformInfo(platform, param, 0, nullptr, &valueSize));
+	vector<char> value(valueSize + 1, 0);
+	CHECK_OCL_ERROR(clGetPlatformInfo(platform, param, valueSize, &value[0], nullptr));
+
+	return boost::trim_copy(string(&value[0]));
+}
+
+string GetDeviceInfo(cl_device_id device, cl_device_info param) {
+	size_t valueSize;
+	CHECK_OCL_ERROR(clGetDeviceInfo(device, param, 0, nullptr, &valueSize));
+	vector<char> value(valueSize + 1, 0);
+	CHECK_OCL_ERROR(clGetDeviceInfo(device, param, valueSize, &value[0], nullptr));
+
+	return boost::trim_copy(string(&value[0]));
+}
+
+}
+
+boost::filesystem::path oclKernelPersistentCache::GetDeviceCacheDir(const string &applicationName,
+		cl_device_id device) {
+	cl_platform_id platform;
+	CHECK_OCL_ERROR(clGetDeviceInfo(device, CL_DEVICE_PLATFORM, sizeof(cl_platform_id), &platform, nullptr));
+
+	const string platformName = GetPlatformInfo(platform, CL_PLATFORM_VENDOR);
+	const string deviceName = GetDeviceInfo(device, CL_DEVICE_NAME);
+	// Binaries are not portable across driver updates
+	const string driverVersion = GetDeviceInfo(device, CL_DRIVER_VERSION);
+
+	cl_uint deviceUnitsUInt;
+	CHECK_OCL_ERROR(clGetDeviceInfo(device, CL_DEVICE_MAX_COMPUTE_UNITS, sizeof(cl_uint), &deviceUnitsUInt, nullptr));
+	const string deviceUnits = ToString(deviceUnitsUInt);
+
+	return GetCacheDir(applicationName) / SanitizeFileName(platformName) /
+		SanitizeFileName(deviceName) / SanitizeFileName(deviceUnits) /
+		SanitizeFileName(driverVersion);
+}
+
 cl_program oclKernelPersistentCache::Compile(cl_context context, cl_device_id device,
 		const vector<string> &kernelsParameters, const string &kernelSource,
 		bool *cached, string *errorStr) {
@@ -251,32 +340,14 @@ cl_program oclKernelPersistentCache::Compile(cl_context context, cl_device_id de
 
 	// Check if the kernel is available inside the cache
 
-	cl_platform_id platform;
-	CHECK_OCL_ERROR(clGetDeviceInfo(device, CL_DEVICE_PLATFORM, sizeof(cl_platform_id), &platform, nullptr));
-	
-	size_t platformNameSize;
-	CHECK_OCL_ERROR(clGetPlatformInfo(platform, CL_PLATFORM_VENDOR, 0, nullptr, &platformNameSize));
-	char *platformNameChar = (char *)alloca(platformNameSize * sizeof(char));
-	CHECK_OCL_ERROR(clGetPlatformInfo(platform, CL_PLATFORM_VENDOR, platformNameSize, platformNameChar, nullptr));
-	string platformName = boost::trim_copy(string(platformNameChar));
-
-	size_t deviceNameSize;
-	CHECK_OCL_ERROR(clGetDeviceInfo(device, CL_DEVICE_NAME, 0, nullptr, &deviceNameSize));
-	char *deviceNameChar = (char *)alloca(deviceNameSize * sizeof(char));
-	CHECK_OCL_ERROR(clGetDeviceInfo(device, CL_DEVICE_NAME, deviceNameSize, deviceNameChar, nullptr));
-	string deviceName = boost::trim_copy(string(deviceNameChar));
-	
-	cl_uint deviceUnitsUInt;
-	CHECK_OCL_ERROR(clGetDeviceInfo(device, CL_DEVICE_MAX_COMPUTE_UNITS, sizeof(cl_uint), &deviceUnitsUInt, nullptr));
-	string deviceUnits = ToString(deviceUnitsUInt);
-
 	const string kernelName = HashString(ToOptsString(kernelsParameters)) + "-" + HashString(kernelSource) + ".ocl";
-	const boost::filesystem::path dirPath = GetCacheDir(appName) / SanitizeFileName(platformName) /
-		SanitizeFileName(deviceName) / SanitizeFileName(deviceUnits);
+	const boost::filesystem::path dirPath = GetDeviceCacheDir(appName, device);
 	const boost::filesystem::path filePath = dirPath / kernelName;
 	const string fileName = filePath.generic_string();
-	
-	if (!boost::filesystem::exists(filePath)) {
+
+	CompilingFileLock compilingFileLock(fileName);
+
+	if (compilingFileLock.IsOwner()) {
 		// It isn't available, compile the source
 		cl_program program = ForcedCompile(context, device,
 				kernelsParameters, kernelSource, errorStr);
@@ -294,34 +365,43 @@ cl_program oclKernelPersistentCache::Compile(cl_context context, cl_device_id de
 		if (binsSizes[0] > 0) {
 			// Using here alloca() can trigger a stack overflow on Windows for
 			// large kernel binaries
-			unique_ptr<char> bin(new char[binsSizes[0]]);
+			unique_ptr<char[]> bin(new char[binsSizes[0]]);
 			char *bins = bin.get();
 			CHECK_OCL_ERROR(clGetProgramInfo(program, CL_PROGRAM_BINARIES, sizeof(char *), &bins, nullptr));
 
 			// Add the kernel to the cache
 			boost::filesystem::create_directories(dirPath);
 
-			// The use of boost::filesystem::path is required for UNICODE support: fileName
-			// is supposed to be UTF-8 encoded.
-			
-			boost::filesystem::ofstream file(boost::filesystem::path(fileName),
-				boost::filesystem::ofstream::out |
-				boost::filesystem::ofstream::binary |
-				boost::filesystem::ofstream::trunc);
-
-			// Write the binary hash
-			const u_int hashBin = HashBin(bins, binsSizes[0]);
-			file.write((char *)&hashBin, sizeof(int));
-
-			file.write(bins, binsSizes[0]);
-			// Check for errors
-			char buf[512];
-			if (file.fail()) {
-				sprintf(buf, "Unable to write kernel file cache %s", fileName.c_str());
-				throw runtime_error(buf);
+			// The file is written with a temporary name and renamed at the end
+			// so other processes never read a partially written kernel
+			SafeSave safeSave(fileName);
+
+			{
+				// The use of boost::filesystem::path is required for UNICODE support: fileName
+				// is supposed to be UTF-8 encoded.
+				boost::filesystem::ofstream file(boost::filesystem::path(safeSave.GetSaveFileName()),
+					boost::filesystem::ofstream::out |
+					boost::filesystem::ofstream::binary |
+					boost::filesystem::ofstream::trunc);
+
+				// Write the file format version and the binary hash
+				const u_int version = LUXRAYS_OCL_KERNEL_CACHE_VERSION;
+				file.write((char *)&version, sizeof(u_int));
+				const u_int hashBin = HashBin(bins, binsSizes[0]);
+				file.write((char *)&hashBin, sizeof(u_int));
+
+				file.write(bins, binsSizes[0]);
+				// Check for errors
+				char buf[512];
+				if (file.fail()) {
+					sprintf(buf, "Unable to write kernel file cache %s", fileName.c_str());
+					throw runtime_error(buf);
+				}
+
+				file.close();
 			}
 
-			file.close();
+			safeSave.Process();
 		}
 
 		if (cached)
@@ -329,10 +409,11 @@ cl_program oclKernelPersistentCache::Compile(cl_context context, cl_device_id de
 
 		return program;
 	} else {
+		const size_t headerSize = 2 * sizeof(u_int);
 		const size_t fileSize = boost::filesystem::file_size(filePath);
 
-		if (fileSize > 4) {
-			const size_t kernelSize = fileSize - 4;
+		if (fileSize > headerSize) {
+			const size_t kernelSize = fileSize - headerSize;
 
 			vector<char> kernelBin(kernelSize);
 
@@ -341,9 +422,10 @@ cl_program oclKernelPersistentCache::Compile(cl_context context, cl_device_id de
 			boost::filesystem::ifstream file(boost::filesystem::path(fileName),
 				boost::filesystem::ifstream::in | boost::filesystem::ifstream::binary);
 
-			// Read the binary hash
-			u_int hashBin;
-			file.read((char *)&hashBin, sizeof(int));
+			// Read the file format version and the binary hash
+			u_int version, hashBin;
+			file.read((char *)&version, sizeof(u_int));
+			file.read((char *)&hashBin, sizeof(u_int));
 
 			file.read(&kernelBin[0], kernelSize);
 
@@ -356,8 +438,9 @@ cl_program oclKernelPersistentCache::Compile(cl_context context, cl_device_id de
 
 			file.close();
 
-			// Check the binary hash
-			if (hashBin != HashBin(&kernelBin[0], kernelSize)) {
+			// Check the version and the binary hash
+			if ((version != LUXRAYS_OCL_KERNEL_CACHE_VERSION) ||
+					(hashBin != HashBin(&kernelBin[0], kernelSize))) {
 				// Something wrong in the file, remove the file and retry
 				boost::filesystem::remove(filePath);
 				return Compile(context, device, kernelsParameters, kernelSource, cached, errorStr);
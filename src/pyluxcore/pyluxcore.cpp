@@ -784,6 +784,30 @@ static void Film_AddFilm2(luxcore::detail::FilmImpl *film, luxcore::detail::Film
   film->AddFilm(*srcFilm, srcOffsetX,  srcOffsetY, srcWidth,  srcHeight, dstOffsetX,  dstOffsetY);
 }
 
+static void Film_AddFilm3(luxcore::detail::FilmImpl *film, const string &fileName) {
+  film->AddFilm(fileName);
+}
+
+static void Film_AddFilm4(luxcore::detail::FilmImpl *film, const string &fileName, const float weight) {
+  film->AddFilm(fileName, weight);
+}
+
+static void Film_AddFilm5(luxcore::detail::FilmImpl *film, const string &fileName,
+    const size_t srcOffsetX, const size_t srcOffsetY,
+    const size_t srcWidth, const size_t srcHeight,
+    const size_t dstOffsetX, const size_t dstOffsetY,
+    const float weight) {
+  film->AddFilm(fileName, srcOffsetX,  srcOffsetY, srcWidth,  srcHeight, dstOffsetX,  dstOffsetY, weight);
+}
+
+static luxcore::detail::FilmImpl *Film_Merge1(const vector<string> &fileNames) {
+  return (luxcore::detail::FilmImpl *)luxcore::Film::Merge(fileNames);
+}
+
+static luxcore::detail::FilmImpl *Film_Merge2(const vector<string> &fileNames, const vector<float> &weights) {
+  return (luxcore::detail::FilmImpl *)luxcore::Film::Merge(fileNames, weights);
+}
+
 static float Film_GetFilmY1(luxcore::detail::FilmImpl *film) {
   return film->GetFilmY();
 }
@@ -1940,6 +1964,11 @@ PYBIND11_MODULE(pyluxcore, m) {
     .def("Clear", &luxcore::detail::FilmImpl::Clear)
     .def("AddFilm", &Film_AddFilm1)
     .def("AddFilm", &Film_AddFilm2)
+    .def("AddFilm", &Film_AddFilm3)
+    .def("AddFilm", &Film_AddFilm4)
+    .def("AddFilm", &Film_AddFilm5)
+    .def_static("Merge", &Film_Merge1, py::return_value_policy::take_ownership)
+    .def_static("Merge", &Film_Merge2, py::return_value_policy::take_ownership)
     .def("HasOutput", &luxcore::detail::FilmImpl::HasOutput)
     .def("GetOutputCount", &luxcore::detail::FilmImpl::GetOutputCount)
     .def("SaveOutputs", &luxcore::detail::FilmImpl::SaveOutputs)
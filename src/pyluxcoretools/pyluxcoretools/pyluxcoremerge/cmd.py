@@ -64,6 +64,8 @@ def LuxCoreMerge(argv):
 							"SRC_WIDTH", "SRC_HEIGHT", "DST_OFFSET_X", "DST_OFFSET_Y"),
 							nargs=6, type=int,
 							help = "Define the origin and the size of the region in the source film and the placement in the destination film where the it will be merged")
+	filmParser.add_argument("-w", "--weight", metavar="WEIGHT", type=float, default=1.0,
+							help = "Scale the values and the samples count of the film (only for .flm files)")
 
 	# Prepare the general options parser
 	generalParser = argparse.ArgumentParser(description="PyLuxCoreMerge", add_help=False)
@@ -112,18 +114,30 @@ def LuxCoreMerge(argv):
 		filmArgs = filmParser.parse_args(filmArgs)
 
 		filmFileName = filmArgs.fileFilm
+		isStandAloneFilm = (os.path.splitext(filmFileName)[1] == ".flm")
 		if not baseFilm:
 			logger.info("Processing the base Film: " + filmFileName)
 		else:
 			logger.info("Merging the Film: " + filmFileName)
-		
-		# Load the film
-		film = LoadFilm(filmFileName, filmArgs.pixel_normalized_channel, filmArgs.screen_normalized_channel)
+
+		if (filmArgs.weight != 1.0) and (not isStandAloneFilm):
+			raise TypeError("A weight can be used only with .flm files: " + filmFileName)
+
 		if not baseFilm:
 			# Set the base film
-			baseFilm = film
+			if isStandAloneFilm and (filmArgs.weight != 1.0):
+				baseFilm = pyluxcore.Film.Merge([filmFileName], [filmArgs.weight])
+			else:
+				baseFilm = LoadFilm(filmFileName, filmArgs.pixel_normalized_channel, filmArgs.screen_normalized_channel)
+		elif isStandAloneFilm:
+			# Stream the film from the disk, without loading it all in memory
+			if (filmArgs.region):
+				baseFilm.AddFilm(filmFileName, *filmArgs.region, filmArgs.weight)
+			else:
+				baseFilm.AddFilm(filmFileName, filmArgs.weight)
 		else:
-			# Add the current film to the base film
+			# Load the film and add it to the base film
+			film = LoadFilm(filmFileName, filmArgs.pixel_normalized_channel, filmArgs.screen_normalized_channel)
 			if (filmArgs.region):
 				baseFilm.AddFilm(film, *filmArgs.region)
 			else:
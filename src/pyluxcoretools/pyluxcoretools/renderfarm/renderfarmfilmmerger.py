@@ -98,19 +98,16 @@ class RenderFarmFilmMerger:
 					continue
 
 				logger.info("Merging film: " + nodeThread.thread.name + " (" + filmThreadFileName + ")")
-				filmThread = pyluxcore.Film(filmThreadFileName)
-
-				if filmThread:
-					stats = filmThread.GetStats()
-					spp = stats.Get("stats.film.spp").GetFloat()
-					logger.info("  Samples per pixel: " + "%.1f" % (spp))
-
 				if film:
-					# Merge the film
-					film.AddFilm(filmThread)
+					# Merge the film streaming it from the disk
+					film.AddFilm(filmThreadFileName)
 				else:
 					# Read the first film
-					film = filmThread
+					film = pyluxcore.Film(filmThreadFileName)
+
+				stats = film.GetStats()
+				spp = stats.Get("stats.film.spp").GetFloat()
+				logger.info("  Merged samples per pixel: " + "%.1f" % (spp))
 
 		return film
 	
@@ -19,6 +19,7 @@
 #include "slg/bsdf/bsdf.h"
 #include "slg/scene/scene.h"
 #include "slg/materials/glass.h"
+#include "slg/utils/profiler.h"
 
 using namespace luxrays;
 using namespace slg;
@@ -28,6 +29,8 @@ using namespace std;
 void BSDF::Init(const bool fixedFromLight, const bool throughShadowTransparency,
 		const Scene &scene, const Ray &ray, const RayHit &rayHit,
 		const float passThroughEvent, const PathVolumeInfo *volInfo) {
+	SLG_PROFILE(PROFILER_BSDF_INIT);
+
 	// Get the scene object
 	sceneObject = scene.objDefs.GetSceneObject(rayHit.meshIndex);
 
@@ -70,6 +73,8 @@ void BSDF::Init(const Scene &scene,
 		const float surfacePointBary1, const float surfacePointBary2, 
 		const float time,
 		const float passThroughEvent, const PathVolumeInfo *volInfo) {
+	SLG_PROFILE(PROFILER_BSDF_INIT);
+
 	// Get the scene object
 	sceneObject = scene.objDefs.GetSceneObject(meshIndex);
 
@@ -140,12 +145,55 @@ void BSDF::Init(const bool fixedFromLight, const bool throughShadowTransparency,
 	hitPoint.triangleBariCoord1 = 0.f;
 	hitPoint.triangleBariCoord2 = 0.f;
 
+	hitPoint.objectID = NULL_INDEX;
+	hitPoint.texValueCache = nullptr;
+
+	// Build the local reference system
+	frame.SetFromZ(hitPoint.shadeN);
+}
+
+// Used to rebuild a light sampling only BSDF from a compact point
+void BSDF::Init(const Point &p, const Normal &geometryN,
+		const Normal &shadeN, const bool intoObject,
+		const Material *mat) {
+	hitPoint.Init();
+
+	hitPoint.p = p;
+	hitPoint.fixedDir = Vector(intoObject ? geometryN : -geometryN);
+	hitPoint.geometryN = geometryN;
+	hitPoint.interpolatedN = shadeN;
+	hitPoint.shadeN = shadeN;
+	hitPoint.intoObject = intoObject;
+
+	sceneObject = NULL;
+	material = mat;
+	triangleLightSource = NULL;
+
+	hitPoint.defaultUV = UV(0.f, 0.f);
+
+	CoordinateSystem(Vector(hitPoint.shadeN), &hitPoint.dpdu, &hitPoint.dpdv);
+	hitPoint.dndu = Normal();
+	hitPoint.dndv = Normal();
+
+	hitPoint.triangleIndex = NULL_INDEX;
+	hitPoint.triangleBariCoord1 = 0.f;
+	hitPoint.triangleBariCoord2 = 0.f;
+
 	hitPoint.objectID = NULL_INDEX;
 
 	// Build the local reference system
 	frame.SetFromZ(hitPoint.shadeN);
 }
 
+void BSDF::SetTextureValueCache(TextureValueCache *cache) {
+	// Volumes run without a cache
+	if (cache && !IsVolume()) {
+		cache->Clear();
+		hitPoint.texValueCache = cache;
+	} else
+		hitPoint.texValueCache = nullptr;
+}
+
 void BSDF::MoveHitPoint(const Point &p, const Normal &n) {
 	hitPoint.p = p;
 	hitPoint.geometryN = n;
@@ -155,6 +203,10 @@ void BSDF::MoveHitPoint(const Point &p, const Normal &n) {
 	Vector x, y;
 	CoordinateSystem(Vector(n), &x, &y);
 	frame = Frame(x, y, n);
+
+	// The cached values are not valid anymore and the cache could be shared
+	// with a copy of this BSDF so it is just disabled
+	hitPoint.texValueCache = nullptr;
 }
 
 bool BSDF::IsAlbedoEndPoint(const AlbedoSpecularSetting albedoSpecularSetting,
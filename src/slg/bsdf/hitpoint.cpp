@@ -70,6 +70,8 @@ void HitPoint::Init(const bool fixedFromLight, const bool throughShadowTransp,
 	// Note: I'm not initializing volume related information here
 	interiorVolume = nullptr;
 	exteriorVolume = nullptr;
+
+	texValueCache = nullptr;
 }
 
 // Initialize all fields (i.e. the one missing a default constructor)
@@ -83,4 +85,5 @@ void HitPoint::Init() {
 	fromLight = false;
 	intoObject = true;
 	throughShadowTransparency = false;
+	texValueCache = nullptr;
 }
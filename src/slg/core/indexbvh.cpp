@@ -17,6 +17,7 @@
  ***************************************************************************/
 
 #include <algorithm>
+#include <cstring>
 
 #include "luxrays/core/bvh/bvhbuild.h"
 #include "slg/core/indexbvh.h"
@@ -64,6 +65,142 @@ template<u_int CHILDREN_COUNT, class T> static luxrays::ocl::IndexBVHArrayNode *
 	return luxrays::buildembreebvh::BuildEmbreeBVH<CHILDREN_COUNT>(quality, prims, nNodes);
 }
 
+//------------------------------------------------------------------------------
+// BuildLeafBuckets
+//
+// Rewrites a tree with one entry per leaf in a tree where leaves are buckets
+// of up to INDEXBVH_LEAF_BUCKET_SIZE entries.
+//------------------------------------------------------------------------------
+
+static_assert(sizeof(luxrays::ocl::IndexBVHLeafBucket) == INDEXBVH_LEAF_BUCKET_NODES * sizeof(luxrays::ocl::IndexBVHArrayNode),
+		"IndexBVHLeafBucket must fill exactly INDEXBVH_LEAF_BUCKET_NODES nodes");
+
+namespace {
+
+template <class T> class LeafBucketsBuilder {
+public:
+	LeafBucketsBuilder(const luxrays::ocl::IndexBVHArrayNode *nodes, const u_int count,
+			const vector<T> *entries, const float radius) :
+			srcNodes(nodes), srcNodesCount(count), allEntries(entries),
+			entryRadius(radius) {
+		// Used to count the leaves of a sub-tree in constant time
+		leafCountPrefix.resize(srcNodesCount + 1);
+		leafCountPrefix[0] = 0;
+		for (u_int i = 0; i < srcNodesCount; ++i)
+			leafCountPrefix[i + 1] = leafCountPrefix[i] + (IndexBVHNodeData_IsLeaf(srcNodes[i].nodeData) ? 1 : 0);
+	}
+
+	void Build(vector<luxrays::ocl::IndexBVHArrayNode> &dstNodes) {
+		if (srcNodesCount > 0)
+			BuildNode(0, dstNodes);
+	}
+
+private:
+	u_int GetSubTreeEnd(const u_int nodeIndex) const {
+		const u_int nodeData = srcNodes[nodeIndex].nodeData;
+
+		return IndexBVHNodeData_IsLeaf(nodeData) ?
+			(nodeIndex + 1) : IndexBVHNodeData_GetSkipIndex(nodeData);
+	}
+
+	u_int GetLeafCount(const u_int nodeIndex) const {
+		return leafCountPrefix[GetSubTreeEnd(nodeIndex)] - leafCountPrefix[nodeIndex];
+	}
+
+	void AddSubTreeEntries(const u_int nodeIndex, vector<u_int> &entryIndices) const {
+		const u_int end = GetSubTreeEnd(nodeIndex);
+		for (u_int i = nodeIndex; i < end; ++i) {
+			if (IndexBVHNodeData_IsLeaf(srcNodes[i].nodeData))
+				entryIndices.push_back(srcNodes[i].entryLeaf.entryIndex);
+		}
+	}
+
+	void AddBucket(const vector<u_int> &entryIndices,
+			vector<luxrays::ocl::IndexBVHArrayNode> &dstNodes) const {
+		assert (entryIndices.size() > 0);
+		assert (entryIndices.size() <= INDEXBVH_LEAF_BUCKET_SIZE);
+
+		luxrays::ocl::IndexBVHLeafBucket bucket;
+		BBox bbox;
+		for (u_int i = 0; i < INDEXBVH_LEAF_BUCKET_SIZE; ++i) {
+			if (i < entryIndices.size()) {
+				const Point &p = (*allEntries)[entryIndices[i]].p;
+
+				bucket.x[i] = p.x;
+				bucket.y[i] = p.y;
+				bucket.z[i] = p.z;
+				bucket.entryIndex[i] = entryIndices[i];
+
+				bbox = Union(bbox, p);
+			} else {
+				bucket.x[i] = INDEXBVH_LEAF_BUCKET_EMPTY_POSITION;
+				bucket.y[i] = INDEXBVH_LEAF_BUCKET_EMPTY_POSITION;
+				bucket.z[i] = INDEXBVH_LEAF_BUCKET_EMPTY_POSITION;
+				bucket.entryIndex[i] = NULL_INDEX;
+			}
+		}
+		bbox.Expand(entryRadius);
+
+		const u_int leafIndex = dstNodes.size();
+		dstNodes.resize(leafIndex + 1 + INDEXBVH_LEAF_BUCKET_NODES);
+
+		luxrays::ocl::IndexBVHArrayNode &leaf = dstNodes[leafIndex];
+		luxrays::buildembreebvh::CopyBBox(&bbox.pMin.x, &leaf.bvhNode.bboxMin[0]);
+		// Mark as a leaf
+		leaf.nodeData = dstNodes.size() | 0x80000000u;
+		leaf.pad = 0;
+
+		memcpy(&dstNodes[leafIndex + 1], &bucket, sizeof(luxrays::ocl::IndexBVHLeafBucket));
+	}
+
+	void BuildNode(const u_int nodeIndex, vector<luxrays::ocl::IndexBVHArrayNode> &dstNodes) const {
+		if (GetLeafCount(nodeIndex) <= INDEXBVH_LEAF_BUCKET_SIZE) {
+			// The whole sub-tree fits in a bucket
+			vector<u_int> entryIndices;
+			AddSubTreeEntries(nodeIndex, entryIndices);
+			AddBucket(entryIndices, dstNodes);
+
+			return;
+		}
+
+		// It is an inner node
+		const u_int dstIndex = dstNodes.size();
+		dstNodes.push_back(srcNodes[nodeIndex]);
+
+		// Small children are packed together in the same bucket
+		vector<u_int> pendingEntryIndices;
+		const u_int end = GetSubTreeEnd(nodeIndex);
+		for (u_int childIndex = nodeIndex + 1; childIndex < end; childIndex = GetSubTreeEnd(childIndex)) {
+			const u_int childLeafCount = GetLeafCount(childIndex);
+
+			if (childLeafCount <= INDEXBVH_LEAF_BUCKET_SIZE) {
+				if (pendingEntryIndices.size() + childLeafCount > INDEXBVH_LEAF_BUCKET_SIZE) {
+					AddBucket(pendingEntryIndices, dstNodes);
+					pendingEntryIndices.clear();
+				}
+
+				AddSubTreeEntries(childIndex, pendingEntryIndices);
+			} else
+				BuildNode(childIndex, dstNodes);
+		}
+
+		if (pendingEntryIndices.size() > 0)
+			AddBucket(pendingEntryIndices, dstNodes);
+
+		// Set the skip index
+		dstNodes[dstIndex].nodeData = dstNodes.size();
+	}
+
+	const luxrays::ocl::IndexBVHArrayNode *srcNodes;
+	const u_int srcNodesCount;
+	const vector<T> *allEntries;
+	const float entryRadius;
+
+	vector<u_int> leafCountPrefix;
+};
+
+}
+
 //------------------------------------------------------------------------------
 // IndexBvh
 //------------------------------------------------------------------------------
@@ -74,8 +211,24 @@ IndexBvh<T>::IndexBvh() : arrayNodes(nullptr) {
 
 template <class T>
 IndexBvh<T>::IndexBvh(const vector<T> *entries, const float radius) :
-		allEntries(entries), entryRadius(radius), entryRadius2(radius * radius) {
-	arrayNodes = BuildEmbreeBVH<4, T>(RTC_BUILD_QUALITY_HIGH, allEntries, entryRadius, &nNodes);
+		allEntries(entries), entryRadius(radius), entryRadius2(radius * radius),
+		arrayNodes(nullptr), nNodes(0) {
+	if (allEntries->size() == 0)
+		return;
+
+	u_int singleEntryNodesCount;
+	luxrays::ocl::IndexBVHArrayNode *singleEntryNodes = BuildEmbreeBVH<4, T>(RTC_BUILD_QUALITY_HIGH,
+			allEntries, entryRadius, &singleEntryNodesCount);
+
+	vector<luxrays::ocl::IndexBVHArrayNode> nodes;
+	nodes.reserve(singleEntryNodesCount);
+	LeafBucketsBuilder<T> builder(singleEntryNodes, singleEntryNodesCount, allEntries, entryRadius);
+	builder.Build(nodes);
+	delete [] singleEntryNodes;
+
+	nNodes = nodes.size();
+	arrayNodes = new luxrays::ocl::IndexBVHArrayNode[nNodes];
+	copy(nodes.begin(), nodes.end(), arrayNodes);
 }
 
 template <class T>
@@ -83,6 +236,28 @@ IndexBvh<T>::~IndexBvh() {
 	delete [] arrayNodes;
 }
 
+template <class T>
+void IndexBvh<T>::GetLeafOrderEntryIndices(vector<u_int> &entryIndices) const {
+	entryIndices.clear();
+	entryIndices.reserve(allEntries->size());
+
+	u_int nodeIndex = 0;
+	while (nodeIndex < nNodes) {
+		const u_int nodeData = arrayNodes[nodeIndex].nodeData;
+
+		if (IndexBVHNodeData_IsLeaf(nodeData)) {
+			const luxrays::ocl::IndexBVHLeafBucket &bucket = GetLeafBucket(nodeIndex);
+			for (u_int i = 0; i < INDEXBVH_LEAF_BUCKET_SIZE; ++i) {
+				if (bucket.entryIndex[i] != NULL_INDEX)
+					entryIndices.push_back(bucket.entryIndex[i]);
+			}
+
+			nodeIndex += 1 + INDEXBVH_LEAF_BUCKET_NODES;
+		} else
+			++nodeIndex;
+	}
+}
+
 //------------------------------------------------------------------------------
 // Explicit instantiations
 //------------------------------------------------------------------------------
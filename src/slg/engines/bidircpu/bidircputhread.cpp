@@ -30,6 +30,83 @@ using namespace std;
 using namespace luxrays;
 using namespace slg;
 
+//------------------------------------------------------------------------------
+// LightPathVertices
+//------------------------------------------------------------------------------
+
+void LightPathVertices::Clear() {
+	positions.clear();
+	misData.clear();
+	bsdfData.clear();
+}
+
+void LightPathVertices::Add(const PathVertexVM &vertex, const RayHit &rayHit) {
+	const HitPoint &hitPoint = vertex.bsdf.hitPoint;
+
+	positions.push_back(hitPoint.p);
+
+	MISData mis;
+	mis.fixedDir = hitPoint.fixedDir;
+	mis.throughput = vertex.throughput;
+	mis.lightID = vertex.lightID;
+	mis.depth = vertex.depth;
+	mis.dVCM = vertex.dVCM;
+	mis.dVC = vertex.dVC;
+	mis.dVM = vertex.dVM;
+	misData.push_back(mis);
+
+	BSDFData data;
+	data.geometryN = hitPoint.geometryN;
+	data.interiorVolume = hitPoint.interiorVolume;
+	data.exteriorVolume = hitPoint.exteriorVolume;
+	if (vertex.bsdf.IsVolume()) {
+		data.meshIndex = NULL_INDEX;
+		data.triangleIndex = NULL_INDEX;
+	} else {
+		data.meshIndex = rayHit.meshIndex;
+		data.triangleIndex = rayHit.triangleIndex;
+	}
+	data.b1 = hitPoint.triangleBariCoord1;
+	data.b2 = hitPoint.triangleBariCoord2;
+	data.passThroughEvent = hitPoint.passThroughEvent;
+	data.throughShadowTransparency = hitPoint.throughShadowTransparency;
+	bsdfData.push_back(data);
+}
+
+void LightPathVertices::GetBSDF(const Scene &scene, const u_int index, const float time,
+		BSDF &bsdf) const {
+	const Point &p = positions[index];
+	const MISData &mis = misData[index];
+	const BSDFData &data = bsdfData[index];
+
+	// A ray ending exactly on the vertex
+	const Ray ray(p, -mis.fixedDir, 0.f, numeric_limits<float>::infinity(), time);
+
+	if (data.meshIndex == NULL_INDEX) {
+		// A volume scattering point
+		bsdf.Init(true, data.throughShadowTransparency, scene, ray,
+				*data.interiorVolume, 0.f, data.passThroughEvent);
+	} else {
+		RayHit rayHit;
+		rayHit.t = 0.f;
+		rayHit.b1 = data.b1;
+		rayHit.b2 = data.b2;
+		rayHit.meshIndex = data.meshIndex;
+		rayHit.triangleIndex = data.triangleIndex;
+
+		// The volumes are restored below
+		const PathVolumeInfo volInfo;
+		bsdf.Init(true, data.throughShadowTransparency, scene, ray, rayHit,
+				data.passThroughEvent, &volInfo);
+		bsdf.hitPoint.interiorVolume = data.interiorVolume;
+		bsdf.hitPoint.exteriorVolume = data.exteriorVolume;
+
+		// Check if the hit point was on a bevel edge
+		if (bsdf.hitPoint.geometryN != data.geometryN)
+			bsdf.MoveHitPoint(p, data.geometryN);
+	}
+}
+
 //------------------------------------------------------------------------------
 // BiDirCPU RenderThread
 //------------------------------------------------------------------------------
@@ -62,7 +139,7 @@ void BiDirCPURenderThread::AOVWarmUp(RandomGenerator *rndGen) {
 	Camera *camera = scene->camera;
 
 	SobolSampler sampler(rndGen, engine->film, engine->sampleSplatter, true, 0.f, 0.f,
-		16, 16, 1, 1,
+		16, 16, 1, 1, false,
 		engine->aovWarmupSamplerSharedData);
 
 	// Request the samples
@@ -229,12 +306,12 @@ SampleResult &BiDirCPURenderThread::AddResult(vector<SampleResult> &sampleResult
 }
 
 void BiDirCPURenderThread::ConnectVertices(const float time,
-		const PathVertexVM &eyeVertex, const PathVertexVM &lightVertex,
-		SampleResult &eyeSampleResult, const float u0) const {
+		const PathVertexVM &eyeVertex, const LightPathVertices::MISData &lightVertex,
+		const BSDF &lightBSDF, SampleResult &eyeSampleResult, const float u0) const {
 	BiDirCPURenderEngine *engine = (BiDirCPURenderEngine *)renderEngine;
 	Scene *scene = engine->renderConfig->scene;
 
-	Vector p2pDir(lightVertex.bsdf.hitPoint.p - eyeVertex.bsdf.hitPoint.p);
+	Vector p2pDir(lightBSDF.hitPoint.p - eyeVertex.bsdf.hitPoint.p);
 	const float p2pDistance2 = p2pDir.LengthSquared();
 	const float p2pDistance = sqrtf(p2pDistance2);
 	p2pDir /= p2pDistance;
@@ -248,12 +325,12 @@ void BiDirCPURenderThread::ConnectVertices(const float time,
 		// Check light vertex BSDF
 		float lightBsdfPdfW, lightBsdfRevPdfW;
 		BSDFEvent lightEvent;
-		const Spectrum lightBsdfEval = lightVertex.bsdf.Evaluate(-p2pDir, &lightEvent, &lightBsdfPdfW, &lightBsdfRevPdfW);
+		const Spectrum lightBsdfEval = lightBSDF.Evaluate(-p2pDir, &lightEvent, &lightBsdfPdfW, &lightBsdfRevPdfW);
 
 		if (!lightBsdfEval.Black()) {
 			// Check if the 2 surfaces can see each other
 			const float cosThetaAtCamera = Dot(eyeVertex.bsdf.hitPoint.shadeN, p2pDir);
-			const float cosThetaAtLight = Dot(lightVertex.bsdf.hitPoint.shadeN, -p2pDir);
+			const float cosThetaAtLight = Dot(lightBSDF.hitPoint.shadeN, -p2pDir);
 			// Was:
 			//  const float geometryTerm = cosThetaAtCamera * cosThetaAtLight / eyeDistance2;
 			//
@@ -263,7 +340,7 @@ void BiDirCPURenderThread::ConnectVertices(const float time,
 
 			// Trace ray between the two vertices
 			const Point shadowRayOrig = eyeVertex.bsdf.GetRayOrigin(p2pDir);
-			const Vector shadowRayOrigP2P(lightVertex.bsdf.hitPoint.p - shadowRayOrig);
+			const Vector shadowRayOrigP2P(lightBSDF.hitPoint.p - shadowRayOrig);
 			const float shadowRayDistanceSquared = shadowRayOrigP2P.LengthSquared();
 			const float shadowRayDistance = sqrtf(shadowRayDistanceSquared);
 			const Vector shadowRayDir = shadowRayOrigP2P / shadowRayDistance;
@@ -315,6 +392,31 @@ void BiDirCPURenderThread::ConnectVertices(const float time,
 	}
 }
 
+void BiDirCPURenderThread::ConnectVertices(const float time,
+		const PathVertexVM &eyeVertex, const LightPathVertices &lightPathVertices,
+		const u_int lightPathStart, const u_int lightPathEnd,
+		vector<BSDF> &lightPathBSDFs, bool &lightPathBSDFsReady,
+		SampleResult &eyeSampleResult, const float u0) const {
+	if (lightPathStart == lightPathEnd)
+		return;
+
+	// The light vertex BSDFs are rebuilt only once and used by all eye vertices
+	if (!lightPathBSDFsReady) {
+		BiDirCPURenderEngine *engine = (BiDirCPURenderEngine *)renderEngine;
+		const Scene *scene = engine->renderConfig->scene;
+
+		lightPathBSDFs.resize(lightPathEnd - lightPathStart);
+		for (u_int i = lightPathStart; i < lightPathEnd; ++i)
+			lightPathVertices.GetBSDF(*scene, i, time, lightPathBSDFs[i - lightPathStart]);
+
+		lightPathBSDFsReady = true;
+	}
+
+	for (u_int i = lightPathStart; i < lightPathEnd; ++i)
+		ConnectVertices(time, eyeVertex, lightPathVertices.misData[i],
+				lightPathBSDFs[i - lightPathStart], eyeSampleResult, u0);
+}
+
 void BiDirCPURenderThread::ConnectToEye(const float time,
 		const PathVertexVM &lightVertex, const float u0,
 		const Point &lensPoint, vector<SampleResult> &sampleResults) const {
@@ -534,7 +636,7 @@ void BiDirCPURenderThread::DirectHitLight(const bool finiteLightSource,
 
 bool BiDirCPURenderThread::TraceLightPath(const float time,
 		Sampler *sampler, const Point &lensPoint,
-		vector<PathVertexVM> &lightPathVertices,
+		LightPathVertices &lightPathVertices,
 		vector<SampleResult> &sampleResults) const {
 	BiDirCPURenderEngine *engine = (BiDirCPURenderEngine *)renderEngine;
 	Scene *scene = engine->renderConfig->scene;
@@ -612,7 +714,7 @@ bool BiDirCPURenderThread::TraceLightPath(const float time,
 
 				// Store the vertex only if it isn't specular
 				if (!lightVertex.bsdf.IsDelta()) {
-					lightPathVertices.push_back(lightVertex);
+					lightPathVertices.Add(lightVertex, nextEventRayHit);
 
 					//----------------------------------------------------------
 					// Try to connect the light path vertex with the eye
@@ -748,7 +850,8 @@ void BiDirCPURenderThread::RenderFunc() {
 	misVcWeightFactor = 0.f;
 
 	vector<SampleResult> sampleResults;
-	vector<PathVertexVM> lightPathVertices;
+	LightPathVertices lightPathVertices;
+	vector<BSDF> lightPathBSDFs;
 
 	for(u_int steps = 0; !boost::this_thread::interruption_requested(); ++steps) {
 		// Check if we are in pause mode
@@ -762,7 +865,8 @@ void BiDirCPURenderThread::RenderFunc() {
 		}
 
 		sampleResults.clear();
-		lightPathVertices.clear();
+		lightPathVertices.Clear();
+		bool lightPathBSDFsReady = false;
 
 		const float timeSample = sampler->GetSample(12);
 		const float time = scene->camera->GenerateRayTime(timeSample);
@@ -938,10 +1042,10 @@ void BiDirCPURenderThread::RenderFunc() {
 				//--------------------------------------------------------------
 
 				if (!eyeVertex.bsdf.IsDelta()) {
-					for (vector<PathVertexVM>::const_iterator lightPathVertex = lightPathVertices.begin();
-							lightPathVertex < lightPathVertices.end(); ++lightPathVertex)
-						ConnectVertices(time, eyeVertex, *lightPathVertex, eyeSampleResult,
-								sampler->GetSample(sampleOffset + 6));
+					ConnectVertices(time, eyeVertex,
+							lightPathVertices, 0, lightPathVertices.GetSize(),
+							lightPathBSDFs, lightPathBSDFsReady,
+							eyeSampleResult, sampler->GetSample(sampleOffset + 6));
 					
 					assert (eyeSampleResult.IsValid());
 				}
@@ -994,9 +1098,8 @@ void BiDirCPURenderThread::RenderFunc() {
 
 	threadDone = true;
 
-	// This is done to stop threads pending on barrier wait
-	// inside engine->photonGICache->Update(). This can happen when an
-	// halt condition is satisfied.
+	// This is done to stop any background PhotonGI caustic cache update
+	// started by engine->photonGICache->Update().
 	if (photonGICache)
 		photonGICache->FinishUpdate(threadIndex);
 
@@ -70,7 +70,11 @@ void BiDirVMCPURenderThread::RenderFuncVM() {
 
 	u_int iteration = 0;
 	vector<vector<SampleResult> > samplesResults(samplers.size());
-	vector<vector<PathVertexVM> > lightPathsVertices(samplers.size());
+	// All light paths vertices, the vertices of light path i are in the
+	// [lightPathsStart[i], lightPathsStart[i + 1]) range
+	LightPathVertices lightPathsVertices;
+	vector<u_int> lightPathsStart(samplers.size() + 1, 0);
+	vector<BSDF> lightPathBSDFs;
 	vector<Point> lensPoints(samplers.size());
 	HashGrid hashGrid;
 
@@ -86,10 +90,9 @@ void BiDirVMCPURenderThread::RenderFuncVM() {
 		}
 
 		// Clear the arrays
-		for (u_int samplerIndex = 0; samplerIndex < samplers.size(); ++samplerIndex) {
+		for (u_int samplerIndex = 0; samplerIndex < samplers.size(); ++samplerIndex)
 			samplesResults[samplerIndex].clear();
-			lightPathsVertices[samplerIndex].clear();
-		}
+		lightPathsVertices.Clear();
 
 		// Setup vertex merging
 		float radius = engine->baseRadius;
@@ -116,6 +119,7 @@ void BiDirVMCPURenderThread::RenderFuncVM() {
 
 		for (u_int samplerIndex = 0; samplerIndex < samplers.size(); ++samplerIndex) {
 			Sampler *sampler = samplers[samplerIndex];
+			lightPathsStart[samplerIndex] = lightPathsVertices.GetSize();
 
 			// Sample a point on the camera lens
 			if (!camera->SampleLens(time, sampler->GetSample(3), sampler->GetSample(4),
@@ -123,9 +127,10 @@ void BiDirVMCPURenderThread::RenderFuncVM() {
 				continue;
 
 			if (!TraceLightPath(time, sampler, lensPoints[samplerIndex],
-					lightPathsVertices[samplerIndex], samplesResults[samplerIndex]))
+					lightPathsVertices, samplesResults[samplerIndex]))
 				continue;
 		}
+		lightPathsStart[samplers.size()] = lightPathsVertices.GetSize();
 
 		//----------------------------------------------------------------------
 		// Store all light path vertices in the k-NN accelerator
@@ -145,6 +150,7 @@ void BiDirVMCPURenderThread::RenderFuncVM() {
 
 			PathVertexVM eyeVertex;
 			SampleResult &eyeSampleResult = AddResult(samplesResults[samplerIndex], false);
+			bool lightPathBSDFsReady = false;
 
 			eyeSampleResult.filmX = sampler->GetSample(0);
 			eyeSampleResult.filmY = sampler->GetSample(1);
@@ -232,12 +238,10 @@ void BiDirVMCPURenderThread::RenderFuncVM() {
 					// Connect vertex path ray with all light path vertices
 					//----------------------------------------------------------
 			
-					const vector<PathVertexVM> &lightPathVertices = lightPathsVertices[samplerIndex];
-					for (vector<PathVertexVM>::const_iterator lightPathVertex = lightPathVertices.begin();
-							lightPathVertex < lightPathVertices.end(); ++lightPathVertex)
-						ConnectVertices(time,
-								eyeVertex, *lightPathVertex, eyeSampleResult,
-								sampler->GetSample(sampleOffset + 6));
+					ConnectVertices(time, eyeVertex, lightPathsVertices,
+							lightPathsStart[samplerIndex], lightPathsStart[samplerIndex + 1],
+							lightPathBSDFs, lightPathBSDFsReady,
+							eyeSampleResult, sampler->GetSample(sampleOffset + 6));
 
 					//----------------------------------------------------------
 					// Vertex Merging step
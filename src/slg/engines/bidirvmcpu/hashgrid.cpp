@@ -24,7 +24,7 @@ using namespace std;
 using namespace luxrays;
 using namespace slg;
 
-void HashGrid::Build(vector<vector<PathVertexVM> > &pathsVertices, const float radius) {
+void HashGrid::Build(const LightPathVertices &lightPathsVertices, const float radius) {
 	// Reset statistic counters
 	//mergeHitsV2V = 0;
 	//mergeHitsV2S = 0;
@@ -32,15 +32,14 @@ void HashGrid::Build(vector<vector<PathVertexVM> > &pathsVertices, const float r
 
 	radius2 = radius * radius;
 
+	pathsVertices = &lightPathsVertices;
+	const vector<Point> &positions = pathsVertices->positions;
+
 	// Build the vertices bounding box
-	vertexCount = 0;
+	vertexCount = positions.size();
 	vertexBBox = BBox();
-	for (u_int i = 0; i < pathsVertices.size(); ++i) {
-		vertexCount += pathsVertices[i].size();
-
-		for (u_int j = 0; j < pathsVertices[i].size(); ++j)
-			vertexBBox = Union(vertexBBox, pathsVertices[i][j].bsdf.hitPoint.p);
-	}
+	for (u_int i = 0; i < vertexCount; ++i)
+		vertexBBox = Union(vertexBBox, positions[i]);
 
 	if (vertexCount <= 0)
 		return;
@@ -54,15 +53,10 @@ void HashGrid::Build(vector<vector<PathVertexVM> > &pathsVertices, const float r
 	gridSize = vertexCount;	
 	cellEnds.resize(gridSize);
 	fill(cellEnds.begin(), cellEnds.end(), 0);
-	lightVertices.resize(gridSize, NULL);
+	lightVertices.resize(gridSize, NULL_INDEX);
 
-	for (u_int i = 0, k = 0; i < pathsVertices.size(); ++i) {
-		for (u_int j = 0; j < pathsVertices[i].size(); ++j, ++k) {
-			const PathVertexVM *vertex = &pathsVertices[i][j];
-
-			cellEnds[Hash(vertex->bsdf.hitPoint.p)]++;
-		}
-	}
+	for (u_int i = 0; i < vertexCount; ++i)
+		cellEnds[Hash(positions[i])]++;
 
 	int sum = 0;
 	for (u_int i = 0; i < cellEnds.size(); ++i) {
@@ -71,13 +65,9 @@ void HashGrid::Build(vector<vector<PathVertexVM> > &pathsVertices, const float r
 		sum += temp;
 	}
 	
-	for (u_int i = 0; i < pathsVertices.size(); ++i) {
-		for (u_int j = 0; j < pathsVertices[i].size(); ++j) {
-			const PathVertexVM *vertex = &pathsVertices[i][j];
-
-			const int targetIdx = cellEnds[Hash(vertex->bsdf.hitPoint.p)]++;
-            lightVertices[targetIdx] = vertex;
-		}
+	for (u_int i = 0; i < vertexCount; ++i) {
+		const int targetIdx = cellEnds[Hash(positions[i])]++;
+		lightVertices[targetIdx] = i;
 	}
 }
 
@@ -123,22 +113,22 @@ void HashGrid::Process(const BiDirVMCPURenderThread *thread,
 void HashGrid::Process(const BiDirVMCPURenderThread *thread,
 		const PathVertexVM &eyeVertex, const int i0, const int i1,
 		Spectrum *radiance) const {
-	for (int i = i0; i < i1; ++i) {
-		const PathVertexVM *lightVertex = lightVertices[i];
-		Process(thread, eyeVertex, lightVertex, radiance);
-	}
+	for (int i = i0; i < i1; ++i)
+		Process(thread, eyeVertex, lightVertices[i], radiance);
 }
 
 void HashGrid::Process(const BiDirVMCPURenderThread *thread,
-		const PathVertexVM &eyeVertex, const PathVertexVM *lightVertex,
+		const PathVertexVM &eyeVertex, const u_int lightVertexIndex,
 		Spectrum *radiance) const {
-	const float distance2 = (lightVertex->bsdf.hitPoint.p - eyeVertex.bsdf.hitPoint.p).LengthSquared();
+	const float distance2 = (pathsVertices->positions[lightVertexIndex] - eyeVertex.bsdf.hitPoint.p).LengthSquared();
 
 	if (distance2 <= radius2) {
+		const LightPathVertices::MISData *lightVertex = &pathsVertices->misData[lightVertexIndex];
+
 		float eyeBsdfPdfW, eyeBsdfRevPdfW;
 		BSDFEvent eyeEvent;
 		// I need to remove the dotN term from the result (see below)
-		Spectrum eyeBsdfEval = eyeVertex.bsdf.Evaluate(lightVertex->bsdf.hitPoint.fixedDir,
+		Spectrum eyeBsdfEval = eyeVertex.bsdf.Evaluate(lightVertex->fixedDir,
 				&eyeEvent, &eyeBsdfPdfW, &eyeBsdfRevPdfW);
 		if(eyeBsdfEval.Black())
 			return;
@@ -146,7 +136,7 @@ void HashGrid::Process(const BiDirVMCPURenderThread *thread,
 		// Volume BSDF doesn't multiply BSDF::Evaluate() by dotN so I need
 		// to remove the term only if it isn't a Volume
 		if (!eyeVertex.bsdf.IsVolume())
-			eyeBsdfEval /= AbsDot(lightVertex->bsdf.hitPoint.fixedDir, eyeVertex.bsdf.hitPoint.geometryN);
+			eyeBsdfEval /= AbsDot(lightVertex->fixedDir, eyeVertex.bsdf.hitPoint.geometryN);
 
 		BiDirVMCPURenderEngine *engine = (BiDirVMCPURenderEngine *)thread->renderEngine;
 		if (eyeVertex.depth >= engine->rrDepth) {
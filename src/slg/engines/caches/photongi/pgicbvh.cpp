@@ -70,41 +70,18 @@ SpectrumGroup PGICPhotonBvh::ConnectAllNearEntries(const BSDF &bsdf) const {
 
 	SpectrumGroup result;
 
-	u_int currentNode = 0; // Root Node
-	const u_int stopNode = IndexBVHNodeData_GetSkipIndex(arrayNodes[0].nodeData); // Non-existent
-
-	while (currentNode < stopNode) {
-		const luxrays::ocl::IndexBVHArrayNode &node = arrayNodes[currentNode];
-
-		const u_int nodeData = node.nodeData;
-		if (IndexBVHNodeData_IsLeaf(nodeData)) {
-			// It is a leaf, check the entry
-			const Photon &entry = ((*allEntries)[node.entryLeaf.entryIndex]);
-
-			const float distance2 = DistanceSquared(p, entry.p);
-			if ((distance2 < entryRadius2) && (entry.isVolume == isVolume) &&
-					(isVolume ||
-						((Dot(n, -entry.d) > DEFAULT_COS_EPSILON_STATIC) &&
-						(Dot(n, entry.landingSurfaceNormal) > entryNormalCosAngle)))) {
-				// I have found a valid entry
-
-				result += ConnectCacheEntry(entry, bsdf);
-			}
-
-			++currentNode;
-		} else {
-			// It is a node, check the bounding box
-			if (p.x >= node.bvhNode.bboxMin[0] && p.x <= node.bvhNode.bboxMax[0] &&
-					p.y >= node.bvhNode.bboxMin[1] && p.y <= node.bvhNode.bboxMax[1] &&
-					p.z >= node.bvhNode.bboxMin[2] && p.z <= node.bvhNode.bboxMax[2])
-				++currentNode;
-			else {
-				// I don't need to use IndexBVHNodeData_GetSkipIndex() here because
-				// I already know the leaf flag is 0
-				currentNode = nodeData;
-			}
+	ForEachNearEntry(p, [&](const u_int entryIndex, const float) {
+		const Photon &entry = (*allEntries)[entryIndex];
+
+		if ((entry.isVolume == isVolume) &&
+				(isVolume ||
+					((Dot(n, -entry.d) > DEFAULT_COS_EPSILON_STATIC) &&
+					(Dot(n, entry.landingSurfaceNormal) > entryNormalCosAngle)))) {
+			// I have found a valid entry
+
+			result += ConnectCacheEntry(entry, bsdf);
 		}
-	}
+	});
 
 	if (isVolume)
 		result /= photonTracedCount * (4.f / 3.f * M_PI * entryRadius2 * entryRadius);
@@ -133,39 +110,16 @@ const RadiancePhoton *PGICRadiancePhotonBvh::GetNearestEntry(const Point &p, con
 	const RadiancePhoton *nearestEntry = nullptr;
 	float nearestDistance2 = entryRadius2;
 
-	u_int currentNode = 0; // Root Node
-	const u_int stopNode = BVHNodeData_GetSkipIndex(arrayNodes[0].nodeData); // Non-existent
-
-	while (currentNode < stopNode) {
-		const luxrays::ocl::IndexBVHArrayNode &node = arrayNodes[currentNode];
-
-		const u_int nodeData = node.nodeData;
-		if (BVHNodeData_IsLeaf(nodeData)) {
-			// It is a leaf, check the entry
-			const RadiancePhoton *entry = &((*allEntries)[node.entryLeaf.entryIndex]);
-
-			const float distance2 = DistanceSquared(p, entry->p);
-			if ((distance2 < nearestDistance2) && (entry->isVolume == isVolume) &&
-					(isVolume || (Dot(n, entry->n) > entryNormalCosAngle))) {
-				// I have found a valid nearer entry
-				nearestEntry = entry;
-				nearestDistance2 = distance2;
-			}
-
-			++currentNode;
-		} else {
-			// It is a node, check the bounding box
-			if (p.x >= node.bvhNode.bboxMin[0] && p.x <= node.bvhNode.bboxMax[0] &&
-					p.y >= node.bvhNode.bboxMin[1] && p.y <= node.bvhNode.bboxMax[1] &&
-					p.z >= node.bvhNode.bboxMin[2] && p.z <= node.bvhNode.bboxMax[2])
-				++currentNode;
-			else {
-				// I don't need to use IndexBVHNodeData_GetSkipIndex() here because
-				// I already know the leaf flag is 0
-				currentNode = nodeData;
-			}
+	ForEachNearEntry(p, [&](const u_int entryIndex, const float distance2) {
+		const RadiancePhoton *entry = &((*allEntries)[entryIndex]);
+
+		if ((distance2 < nearestDistance2) && (entry->isVolume == isVolume) &&
+				(isVolume || (Dot(n, entry->n) > entryNormalCosAngle))) {
+			// I have found a valid nearer entry
+			nearestEntry = entry;
+			nearestDistance2 = distance2;
 		}
-	}
+	});
 
 	return nearestEntry;
 }
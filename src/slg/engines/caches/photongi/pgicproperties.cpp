@@ -52,6 +52,7 @@ Properties PhotonGICache::ToProperties(const Properties &cfg) {
 			cfg.Get(GetDefaultProps().Get("path.photongi.caustic.updatespp")) <<
 			cfg.Get(GetDefaultProps().Get("path.photongi.caustic.updatespp.radiusreduction")) <<
 			cfg.Get(GetDefaultProps().Get("path.photongi.caustic.updatespp.minradius")) <<
+			cfg.Get(GetDefaultProps().Get("path.photongi.caustic.updatespp.threads.count")) <<
 			cfg.Get(GetDefaultProps().Get("path.photongi.caustic.lookup.radius")) <<
 			cfg.Get(GetDefaultProps().Get("path.photongi.caustic.lookup.normalangle")) <<
 			cfg.Get(GetDefaultProps().Get("path.photongi.debug.type")) <<
@@ -86,6 +87,8 @@ const Properties &PhotonGICache::GetDefaultProps() {
 			Property("path.photongi.caustic.updatespp")(8) <<
 			Property("path.photongi.caustic.updatespp.radiusreduction")(.96f) <<
 			Property("path.photongi.caustic.updatespp.minradius")(.003f) <<
+			// The caustic cache is updated while the rendering is running
+			Property("path.photongi.caustic.updatespp.threads.count")(2) <<
 			Property("path.photongi.caustic.lookup.radius")(.15f) <<
 			Property("path.photongi.caustic.lookup.normalangle")(10.f) <<
 			Property("path.photongi.debug.type")("none") <<
@@ -137,6 +140,7 @@ PhotonGICache *PhotonGICache::FromProperties(const Scene *scn, const Properties
 
 			params.caustic.radiusReduction = Max(0.f, cfg.Get(GetDefaultProps().Get("path.photongi.caustic.updatespp.radiusreduction")).Get<float>());
 			params.caustic.minLookUpRadius = Max(0.f, cfg.Get(GetDefaultProps().Get("path.photongi.caustic.updatespp.minradius")).Get<float>());
+			params.caustic.updateThreadCount = Max(1u, cfg.Get(GetDefaultProps().Get("path.photongi.caustic.updatespp.threads.count")).Get<u_int>());
 		}
 
 		params.debugType = String2DebugType(cfg.Get(GetDefaultProps().Get("path.photongi.debug.type")).Get<string>());
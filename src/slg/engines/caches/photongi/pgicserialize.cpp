@@ -42,8 +42,11 @@ void PhotonGICache::LoadPersistentCache(const std::string &fileName) {
 	sif.GetArchive() >> radiancePhotonsBVH;
 	sif.GetArchive() >> indirectPhotonTracedCount;
 
-	sif.GetArchive() >> causticPhotons;
-	sif.GetArchive() >> causticPhotonsBVH;
+	PGICPhotonBvh *bvh;
+	causticPhotonsIndex = 0;
+	sif.GetArchive() >> causticPhotons[causticPhotonsIndex];
+	sif.GetArchive() >> bvh;
+	causticPhotonsBVH = bvh;
 	sif.GetArchive() >> causticPhotonTracedCount;
 	sif.GetArchive() >> causticPhotonPass;
 
@@ -67,8 +70,9 @@ void PhotonGICache::SavePersistentCache(const std::string &fileName) {
 		sof.GetArchive() << radiancePhotonsBVH;
 		sof.GetArchive() << indirectPhotonTracedCount;
 
-		sof.GetArchive() << causticPhotons;
-		sof.GetArchive() << causticPhotonsBVH;
+		const PGICPhotonBvh *bvh = causticPhotonsBVH;
+		sof.GetArchive() << causticPhotons[causticPhotonsIndex];
+		sof.GetArchive() << bvh;
 		sof.GetArchive() << causticPhotonTracedCount;
 		sof.GetArchive() << causticPhotonPass;
 
@@ -109,12 +113,17 @@ template<class Archive> void PhotonGICache::serialize(Archive &ar, const u_int v
 	ar & radiancePhotonsBVH;
 	ar & indirectPhotonTracedCount;
 
-	ar & causticPhotons;	
-	ar & causticPhotonsBVH;
+	if (Archive::is_loading::value)
+		causticPhotonsIndex = 0;
+	PGICPhotonBvh *bvh = causticPhotonsBVH;
+	ar & causticPhotons[causticPhotonsIndex];
+	ar & bvh;
+	causticPhotonsBVH = bvh;
 	ar & causticPhotonTracedCount;
 	ar & causticPhotonPass;
 
-	threadsSyncBarrier.reset(new boost::barrier(threadCount));
+	if (Archive::is_loading::value)
+		InitUpdateState();
 }
 
 namespace slg {
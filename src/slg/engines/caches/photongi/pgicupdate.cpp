@@ -16,88 +16,205 @@
  * limitations under the License.                                          *
  ***************************************************************************/
 
+#include <limits>
+
 #include "slg/engines/caches/photongi/photongicache.h"
 
 using namespace std;
 using namespace luxrays;
 using namespace slg;
 
-bool PhotonGICache::Update(const u_int threadIndex, const u_int filmSPP,
-		const boost::function<void()> &threadZeroCallback) {
-	if (!params.caustic.enabled || (params.caustic.updateSpp == 0) || finishUpdateFlag)
-		return false;
+//------------------------------------------------------------------------------
+// Caustic cache update
+//
+// The next caustic pass is traced and its BVH built by a background thread
+// while the rendering continues with the current cache. The new BVH is then
+// published with an atomic pointer swap. The old one is retired and freed
+// only once all rendering threads have gone trough an update point after the
+// swap (epoch based reclamation).
+//
+// The current look up radius is the one of the published BVH so it is
+// swapped together with it. params.caustic.lookUpRadius is never written
+// during the rendering.
+//------------------------------------------------------------------------------
+
+void PhotonGICache::InitUpdateState() {
+	finishUpdateFlag = false;
+	causticUpdateRunning = false;
+	causticEpoch = 0;
+
+	threadEpochs.reset(new boost::atomic<u_int>[threadCount]);
+	for (u_int i = 0; i < threadCount; ++i)
+		threadEpochs[i] = 0;
+}
 
-	// Check if it is time to update the caustic cache
-	const u_int deltaSpp = filmSPP - lastUpdateSpp;
-	if (deltaSpp > params.caustic.updateSpp) {
-		// Time to update the caustic cache
+void PhotonGICache::ReclaimRetiredCausticPhotons() {
+	// Must be called with causticUpdateMutex locked
 
-		threadsSyncBarrier->wait();
+	if (!causticPhotonsRetired)
+		return;
 
-		bool result = false;
-		if ((threadIndex == 0) && !finishUpdateFlag) {
-			// To avoid the interruption of the following code
-			boost::this_thread::disable_interruption di;
+	// A new BVH can not be published while the old one is retired so all
+	// threads must have reached the current epoch
+	const u_int epoch = causticEpoch.load(boost::memory_order_acquire);
+	for (u_int i = 0; i < threadCount; ++i) {
+		if (threadEpochs[i].load(boost::memory_order_acquire) < epoch)
+			return;
+	}
 
-			const double startTime = WallClockTime();
+	delete retiredCausticPhotonsBVH;
+	retiredCausticPhotonsBVH = nullptr;
 
-			SLG_LOG("Updating PhotonGI caustic cache after " << filmSPP << " samples/pixel (Pass " << causticPhotonPass << ")");
+	vector<Photon> &retiredCausticPhotons = causticPhotons[1 - causticPhotonsIndex];
+	retiredCausticPhotons.clear();
+	retiredCausticPhotons.shrink_to_fit();
 
-			// A safety check to avoid the update if visibility map has been deallocated
-			if (visibilityParticles.size() == 0) {
-				SLG_LOG("ERROR: Updating PhotonGI caustic cache is not possible without visibility information");
-				lastUpdateSpp = filmSPP;
-			} else {
-				// Drop previous cache
-				delete causticPhotonsBVH;
-				causticPhotonsBVH = nullptr;
-				causticPhotons.clear();
+	causticPhotonsRetired = false;
+}
 
-				// Reduce the look up radius
-				params.caustic.lookUpRadius = params.caustic.lookUpRadius /
-						powf(float(causticPhotonPass + 1), .5f * (1.f - params.caustic.radiusReduction));
-				// Place a cap to radius reduction
-				params.caustic.lookUpRadius = Max(params.caustic.lookUpRadius, params.caustic.minLookUpRadius);
-				params.caustic.lookUpRadius2 = Sqr(params.caustic.lookUpRadius);
-				SLG_LOG("New PhotonGI caustic cache lookup radius: " << params.caustic.lookUpRadius);
-				++causticPhotonPass;
+void PhotonGICache::CausticUpdateThreadFunc(const u_int filmSPP) {
+	const double startTime = WallClockTime();
+
+	SLG_LOG("Updating PhotonGI caustic cache after " << filmSPP << " samples/pixel (Pass " << causticPhotonPass << ")");
+
+	// The next pass is traced in the buffer not used by the published BVH
+	const u_int nextIndex = 1 - causticPhotonsIndex;
+	vector<Photon> &nextCausticPhotons = causticPhotons[nextIndex];
+	nextCausticPhotons.clear();
+
+	// Reduce the look up radius of the published cache. Only this thread
+	// can publish a new one so it can not change in the meantime.
+	const PGICPhotonBvh *currentCausticPhotonsBVH = causticPhotonsBVH.load(boost::memory_order_acquire);
+	const float currentLookUpRadius = currentCausticPhotonsBVH ?
+		currentCausticPhotonsBVH->GetEntryRadius() : params.caustic.lookUpRadius;
+	float lookUpRadius = currentLookUpRadius /
+			powf(float(causticPhotonPass + 1), .5f * (1.f - params.caustic.radiusReduction));
+	// Place a cap to radius reduction
+	lookUpRadius = Max(lookUpRadius, params.caustic.minLookUpRadius);
+	SLG_LOG("New PhotonGI caustic cache lookup radius: " << lookUpRadius);
+
+	PGICPhotonBvh *nextCausticPhotonsBVH = nullptr;
+	u_int nextCausticPhotonTracedCount = 0;
+	try {
+		// Trace the photons for a new cache, using only a few threads
+		// because the rendering is still running
+		TracePhotons(params.caustic.updateThreadCount, false, true,
+				nextCausticPhotons, nextCausticPhotonTracedCount);
+	} catch (boost::thread_interrupted &) {
+		SLG_LOG("PhotonGI caustic cache update interrupted");
+
+		nextCausticPhotons.clear();
+		nextCausticPhotons.shrink_to_fit();
+		causticUpdateRunning = false;
+		return;
+	}
+
+	if (nextCausticPhotons.size() > 0) {
+		// Build a new BVH
+		SLG_LOG("PhotonGI building caustic photons BVH");
+		nextCausticPhotonsBVH = new PGICPhotonBvh(&nextCausticPhotons, nextCausticPhotonTracedCount,
+				lookUpRadius, params.caustic.lookUpNormalAngle);
+	}
 
-				// Trace the photons for a new one
-				TracePhotons(false, params.caustic.enabled);
+	// Publish the new cache
+	{
+		boost::unique_lock<boost::mutex> lock(causticUpdateMutex);
 
-				if (causticPhotons.size() > 0) {
-					// Build a new BVH
-					SLG_LOG("PhotonGI building caustic photons BVH");
-					causticPhotonsBVH = new PGICPhotonBvh(&causticPhotons, causticPhotonTracedCount,
-							params.caustic.lookUpRadius, params.caustic.lookUpNormalAngle);
-				}
+		causticPhotonTracedCount = nextCausticPhotonTracedCount;
+		++causticPhotonPass;
 
-				lastUpdateSpp = filmSPP;
+		causticPhotonsIndex = nextIndex;
+		retiredCausticPhotonsBVH = causticPhotonsBVH.exchange(nextCausticPhotonsBVH, boost::memory_order_acq_rel);
+		causticPhotonsRetired = true;
+		causticEpoch.fetch_add(1, boost::memory_order_release);
+	}
+
+	const float dt = WallClockTime() - startTime;
+	SLG_LOG("Updating PhotonGI caustic cache done in: " << std::setprecision(3) << dt << " secs");
 
-				if (threadZeroCallback)
-					threadZeroCallback();
+	causticUpdateRunning = false;
+}
+
+void PhotonGICache::StopCausticUpdateThread() {
+	boost::thread *thread;
+	{
+		boost::unique_lock<boost::mutex> lock(causticUpdateMutex);
+		thread = causticUpdateThread.release();
+	}
+
+	if (thread) {
+		thread->interrupt();
+		thread->join();
+		delete thread;
+	}
+}
 
-				result = true;
+bool PhotonGICache::Update(const u_int threadIndex, const u_int filmSPP,
+		const boost::function<void()> &threadZeroCallback) {
+	if (!params.caustic.enabled || (params.caustic.updateSpp == 0) || finishUpdateFlag)
+		return false;
+
+	// Check if a new caustic cache has been published since the last time
+	bool result = false;
+	const u_int epoch = causticEpoch.load(boost::memory_order_acquire);
+	if (threadEpochs[threadIndex].load(boost::memory_order_relaxed) != epoch) {
+		if (threadIndex == 0) {
+			// The cache can not be replaced again before this thread has
+			// reached the new epoch so it is safe to use it here
+			if (threadZeroCallback) {
+				// To avoid the interruption of the following code
+				boost::this_thread::disable_interruption di;
+
+				threadZeroCallback();
 			}
 
-			const float dt = WallClockTime() - startTime;
-			SLG_LOG("Updating PhotonGI caustic cache done in: " << std::setprecision(3) << dt << " secs");
+			result = true;
 		}
 
-		threadsSyncBarrier->wait();
+		// This thread is not using the old cache anymore
+		threadEpochs[threadIndex].store(epoch, boost::memory_order_release);
+	}
 
+	// Only one thread at time has to do the following work, the others can
+	// just go on rendering
+	boost::unique_lock<boost::mutex> lock(causticUpdateMutex, boost::try_to_lock);
+	if (!lock.owns_lock())
 		return result;
-	} else
-		return false;
+
+	ReclaimRetiredCausticPhotons();
+
+	// Check if it is time to update the caustic cache
+	const u_int deltaSpp = filmSPP - lastUpdateSpp;
+	if ((deltaSpp > params.caustic.updateSpp) && !causticUpdateRunning &&
+			!causticPhotonsRetired && !finishUpdateFlag) {
+		// Time to update the caustic cache
+
+		// A safety check to avoid the update if visibility map has been deallocated
+		if (visibilityParticles.size() == 0) {
+			SLG_LOG("ERROR: Updating PhotonGI caustic cache is not possible without visibility information");
+		} else {
+			// Free the thread of the previous update (it has already finished)
+			if (causticUpdateThread) {
+				causticUpdateThread->join();
+				causticUpdateThread.reset();
+			}
+
+			causticUpdateRunning = true;
+			causticUpdateThread.reset(new boost::thread(&PhotonGICache::CausticUpdateThreadFunc, this, filmSPP));
+		}
+
+		lastUpdateSpp = filmSPP;
+	}
+
+	return result;
 }
 
 void PhotonGICache::FinishUpdate(const u_int threadIndex) {
-	for (;;) {
-		if (finishUpdateFlag)
-			return;
+	finishUpdateFlag = true;
 
-		threadsSyncBarrier->wait();
-		finishUpdateFlag = true;
-		threadsSyncBarrier->wait();
-	}
+	// This thread is not going to use the cache anymore
+	if (threadEpochs)
+		threadEpochs[threadIndex] = numeric_limits<u_int>::max();
+
+	StopCausticUpdateThread();
 }
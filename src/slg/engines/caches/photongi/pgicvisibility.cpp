@@ -65,38 +65,23 @@ protected:
 		return true;
 	}
 
-	virtual bool ProcessVisibilityParticle(const PGICVisibilityParticle &vp,
-			vector<PGICVisibilityParticle> &visibilityParticles,
-			IndexOctree<PGICVisibilityParticle> *octree, const float maxDistance2) const {
-		PGICOctree *particlesOctree = (PGICOctree *)octree;
+	virtual u_int GetNearestEntry(const PGICVisibilityParticle &vp,
+			const IndexOctree<PGICVisibilityParticle> *octree, float *distance2) const {
+		const PGICOctree *particlesOctree = (const PGICOctree *)octree;
 
 		// Check if a cache entry is available for this point
 		const u_int entryIndex = particlesOctree->GetNearestEntry(vp.p, vp.n, vp.isVolume);
+		if (entryIndex != NULL_INDEX)
+			*distance2 = DistanceSquared(vp.p, visibilityParticles[entryIndex].p);
 
-		if (entryIndex == NULL_INDEX) {
-			// Add as a new entry
-			visibilityParticles.push_back(vp);
-			particlesOctree->Add(visibilityParticles.size() - 1);
-
-			return false;
-		} else {
-			PGICVisibilityParticle &entry = visibilityParticles[entryIndex];
-			const float distance2 = DistanceSquared(vp.p, entry.p);
-
-			if (distance2 > maxDistance2) {
-				// Add as a new entry
-				visibilityParticles.push_back(vp);
-				particlesOctree->Add(visibilityParticles.size() - 1);
-				
-				return false;
-			} else {
-				// Update the statistics about the area covered by this entry
-				entry.hitsAccumulatedDistance += sqrtf(distance2);
-				entry.hitsCount += 1;
-				
-				return true;
-			}
-		}
+		return entryIndex;
+	}
+
+	virtual void AddToEntry(PGICVisibilityParticle &entry, const PGICVisibilityParticle &vp,
+			const float distance2) const {
+		// Update the statistics about the area covered by this entry
+		entry.hitsAccumulatedDistance += sqrtf(distance2);
+		entry.hitsCount += 1;
 	}
 	
 	PhotonGICache &pgic;
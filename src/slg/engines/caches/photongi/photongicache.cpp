@@ -42,7 +42,12 @@ PhotonGICache::PhotonGICache() :
 		scene(nullptr),
 		visibilityParticlesKdTree(nullptr),
 		radiancePhotonsBVH(nullptr) ,
-		causticPhotonsBVH(nullptr) {
+		causticPhotonsIndex(0),
+		causticPhotonsBVH(nullptr),
+		causticUpdateRunning(false),
+		causticEpoch(0),
+		retiredCausticPhotonsBVH(nullptr),
+		causticPhotonsRetired(false) {
 }
 
 PhotonGICache::PhotonGICache(const Scene *scn, const PhotonGICacheParams &p) :
@@ -50,15 +55,23 @@ PhotonGICache::PhotonGICache(const Scene *scn, const PhotonGICacheParams &p) :
 		visibilityParticlesKdTree(nullptr),
 		radiancePhotonsBVH(nullptr) ,
 		indirectPhotonTracedCount(0),
+		causticPhotonsIndex(0),
 		causticPhotonsBVH(nullptr),
 		causticPhotonTracedCount(0),
-		causticPhotonPass(0) {
+		causticPhotonPass(0),
+		causticUpdateRunning(false),
+		causticEpoch(0),
+		retiredCausticPhotonsBVH(nullptr),
+		causticPhotonsRetired(false) {
 }
 
 PhotonGICache::~PhotonGICache() {
+	StopCausticUpdateThread();
+
 	delete visibilityParticlesKdTree;
 
-	delete causticPhotonsBVH;
+	delete causticPhotonsBVH.load();
+	delete retiredCausticPhotonsBVH;
 	delete radiancePhotonsBVH;
 }
 
@@ -103,11 +116,13 @@ bool PhotonGICache::IsDirectLightHitVisible(const EyePathInfo &pathInfo,
 		return false;
 }
 
-void PhotonGICache::TracePhotons(const u_int seedBase, const u_int photonTracedCount,
+void PhotonGICache::TracePhotons(const u_int tracingThreadCount,
+		const u_int seedBase, const u_int photonTracedCount,
 		const bool indirectCacheDone, const bool causticCacheDone,
 		boost::atomic<u_int> &globalIndirectPhotonsTraced, boost::atomic<u_int> &globalCausticPhotonsTraced,
-		boost::atomic<u_int> &globalIndirectSize, boost::atomic<u_int> &globalCausticSize) {
-	const size_t renderThreadCount = GetHardwareThreadCount();
+		boost::atomic<u_int> &globalIndirectSize, boost::atomic<u_int> &globalCausticSize,
+		vector<Photon> &newCausticPhotons) {
+	const size_t renderThreadCount = tracingThreadCount;
 	vector<TracePhotonsThread *> renderThreads(renderThreadCount, nullptr);
 
 	boost::atomic<u_int> globalPhotonsCounter(0);
@@ -127,11 +142,25 @@ void PhotonGICache::TracePhotons(const u_int seedBase, const u_int photonTracedC
 		renderThreads[i]->Start();
 	
 	// Wait for the end of photon tracing threads
+	try {
+		for (size_t i = 0; i < renderThreadCount; ++i)
+			renderThreads[i]->Join();
+	} catch (boost::thread_interrupted &) {
+		// I have been interrupted (i.e. by a background caustic cache update
+		// being stopped), stop the photon tracing threads too
+		boost::this_thread::disable_interruption di;
+
+		for (size_t i = 0; i < renderThreadCount; ++i)
+			renderThreads[i]->Interrupt();
+		for (size_t i = 0; i < renderThreadCount; ++i)
+			delete renderThreads[i];
+
+		throw;
+	}
+
 	u_int indirectPhotonStored = 0;
 	u_int causticPhotonStored = 0;
 	for (size_t i = 0; i < renderThreadCount; ++i) {
-		renderThreads[i]->Join();
-
 		// Copy all photons
 		for (auto const &p : renderThreads[i]->indirectPhotons) {
 			PGICVisibilityParticle &vp = visibilityParticles[p.visibilityParticelIndex];
@@ -140,7 +169,7 @@ void PhotonGICache::TracePhotons(const u_int seedBase, const u_int photonTracedC
 		}
 		indirectPhotonStored += renderThreads[i]->indirectPhotons.size();
 
-		causticPhotons.insert(causticPhotons.end(), renderThreads[i]->causticPhotons.begin(),
+		newCausticPhotons.insert(newCausticPhotons.end(), renderThreads[i]->causticPhotons.begin(),
 				renderThreads[i]->causticPhotons.end());
 		causticPhotonStored += renderThreads[i]->causticPhotons.size();
 
@@ -150,18 +179,17 @@ void PhotonGICache::TracePhotons(const u_int seedBase, const u_int photonTracedC
 	// Update the count only if I have traced this kind of photons
 	if (!indirectCacheDone)
 		indirectPhotonTracedCount = globalIndirectPhotonsTraced;
-	// Update the count only if I have traced this kind of photons
-	if (!causticCacheDone)
-		causticPhotonTracedCount = globalCausticPhotonsTraced;
 
 	SLG_LOG("PhotonGI additional indirect photon stored: " << indirectPhotonStored);
 	SLG_LOG("PhotonGI additional caustic photon stored: " << causticPhotonStored);
 	// photonReacedCount isn't exactly but it is quite near
-	SLG_LOG("PhotonGI total photon traced: " << Max(indirectPhotonTracedCount, causticPhotonTracedCount));
+	SLG_LOG("PhotonGI total photon traced: " << Max<u_int>(globalIndirectPhotonsTraced, globalCausticPhotonsTraced));
 }
 
-void PhotonGICache::TracePhotons(const bool indirectEnabled, const bool causticEnabled) {
-	const size_t renderThreadCount = GetHardwareThreadCount();
+void PhotonGICache::TracePhotons(const u_int tracingThreadCount,
+		const bool indirectEnabled, const bool causticEnabled,
+		vector<Photon> &newCausticPhotons, u_int &newCausticPhotonTracedCount) {
+	const size_t renderThreadCount = tracingThreadCount;
 
 	boost::atomic<u_int> globalIndirectPhotonsTraced(0);
 	boost::atomic<u_int> globalCausticPhotonsTraced(0);
@@ -171,10 +199,6 @@ void PhotonGICache::TracePhotons(const bool indirectEnabled, const bool causticE
 	// Update the count only if I have traced this kind of photons
 	if (indirectEnabled)
 		indirectPhotonTracedCount = 0;
-	// Update the count only if I have traced this kind of photons
-	if (causticEnabled)
-		causticPhotonTracedCount = 0;
-
 	if (indirectEnabled && (params.indirect.maxSize == 0)) {
 		// Automatic indirect cache convergence test is required
 
@@ -187,9 +211,9 @@ void PhotonGICache::TracePhotons(const bool indirectEnabled, const bool causticE
 			// Trace additional photons
 			//------------------------------------------------------------------
 
-			TracePhotons(updateSeedBase, photonTracedStep, false, !causticEnabled,
+			TracePhotons(tracingThreadCount, updateSeedBase, photonTracedStep, false, !causticEnabled,
 				globalIndirectPhotonsTraced, globalCausticPhotonsTraced,
-				globalIndirectSize, globalCausticSize);
+				globalIndirectSize, globalCausticSize, newCausticPhotons);
 			photonTracedCount += photonTracedStep;
 
 			//------------------------------------------------------------------
@@ -250,14 +274,14 @@ void PhotonGICache::TracePhotons(const bool indirectEnabled, const bool causticE
 				if (maxError < params.indirect.haltThreshold) {
 					// Finish the work for caustic cache too
 					if (causticEnabled &&
-							(causticPhotons.size() < params.caustic.maxSize) &&
+							(newCausticPhotons.size() < params.caustic.maxSize) &&
 							(photonTracedCount < params.photon.maxTracedCount)) {
 						updateSeedBase += renderThreadCount;
 
-						TracePhotons(updateSeedBase,
+						TracePhotons(tracingThreadCount, updateSeedBase,
 								params.photon.maxTracedCount - photonTracedCount, true, false,
 								globalIndirectPhotonsTraced, globalCausticPhotonsTraced,
-								globalIndirectSize, globalCausticSize);
+								globalIndirectSize, globalCausticSize, newCausticPhotons);
 					}
 
 					break;
@@ -276,15 +300,19 @@ void PhotonGICache::TracePhotons(const bool indirectEnabled, const bool causticE
 		}
 	} else {
 		// Just trace the asked amount of photon paths
-		TracePhotons(updateSeedBase, params.photon.maxTracedCount, !indirectEnabled, !causticEnabled,
+		TracePhotons(tracingThreadCount, updateSeedBase, params.photon.maxTracedCount, !indirectEnabled, !causticEnabled,
 				globalIndirectPhotonsTraced, globalCausticPhotonsTraced,
-				globalIndirectSize, globalCausticSize);
+				globalIndirectSize, globalCausticSize, newCausticPhotons);
 
 	}
 
 	updateSeedBase += renderThreadCount;
 
-	causticPhotons.shrink_to_fit();
+	// Update the count only if I have traced this kind of photons
+	if (causticEnabled)
+		newCausticPhotonTracedCount = globalCausticPhotonsTraced;
+
+	newCausticPhotons.shrink_to_fit();
 }
 
 void PhotonGICache::FilterVisibilityParticlesRadiance(const vector<SpectrumGroup> &radianceValues,
@@ -365,10 +393,9 @@ void PhotonGICache::CreateRadiancePhotons() {
 
 void PhotonGICache::Preprocess(const u_int threadCnt) {
 	threadCount = threadCnt;
-	threadsSyncBarrier.reset(new boost::barrier(threadCount));
+	InitUpdateState();
 	lastUpdateSpp = 0;
 	updateSeedBase = 1;
-	finishUpdateFlag = false;
 
 	if (params.persistent.fileName != "") {
 		// Check if the file already exist
@@ -442,12 +469,14 @@ void PhotonGICache::Preprocess(const u_int threadCnt) {
 
 	if (params.indirect.enabled) {
 		SLG_LOG("PhotonGI tracing indirect cache photons");
-		TracePhotons(true, false);
+		TracePhotons(GetHardwareThreadCount(), true, false,
+				causticPhotons[causticPhotonsIndex], causticPhotonTracedCount);
 	}
 
 	if (params.caustic.enabled) {
 		SLG_LOG("PhotonGI tracing caustic cache photons");
-		TracePhotons(false, true);
+		TracePhotons(GetHardwareThreadCount(), false, true,
+				causticPhotons[causticPhotonsIndex], causticPhotonTracedCount);
 	}
 
 	//--------------------------------------------------------------------------
@@ -469,9 +498,9 @@ void PhotonGICache::Preprocess(const u_int threadCnt) {
 	// Caustic photon map
 	//--------------------------------------------------------------------------
 
-	if ((causticPhotons.size() > 0) && params.caustic.enabled) {
+	if ((causticPhotons[causticPhotonsIndex].size() > 0) && params.caustic.enabled) {
 		SLG_LOG("PhotonGI building caustic photons BVH");
-		causticPhotonsBVH = new PGICPhotonBvh(&causticPhotons, causticPhotonTracedCount,
+		causticPhotonsBVH = new PGICPhotonBvh(&causticPhotons[causticPhotonsIndex], causticPhotonTracedCount,
 				params.caustic.lookUpRadius, params.caustic.lookUpNormalAngle);
 	}
 
@@ -492,11 +521,13 @@ void PhotonGICache::Preprocess(const u_int threadCnt) {
 
 	size_t totalMemUsage = 0;
 
-	if (causticPhotonsBVH) {
-		SLG_LOG("PhotonGI caustic cache photons memory usage: " << ToMemString(causticPhotons.size() * sizeof(Photon)));
-		SLG_LOG("PhotonGI caustic cache BVH memory usage: " << ToMemString(causticPhotonsBVH->GetMemoryUsage()));
+	const PGICPhotonBvh *bvh = causticPhotonsBVH;
+	if (bvh) {
+		const size_t causticPhotonsSize = causticPhotons[causticPhotonsIndex].size();
+		SLG_LOG("PhotonGI caustic cache photons memory usage: " << ToMemString(causticPhotonsSize * sizeof(Photon)));
+		SLG_LOG("PhotonGI caustic cache BVH memory usage: " << ToMemString(bvh->GetMemoryUsage()));
 
-		totalMemUsage += causticPhotons.size() * sizeof(Photon) + causticPhotonsBVH->GetMemoryUsage();
+		totalMemUsage += causticPhotonsSize * sizeof(Photon) + bvh->GetMemoryUsage();
 	}
 
 	if (radiancePhotonsBVH) {
@@ -543,8 +574,10 @@ SpectrumGroup PhotonGICache::ConnectWithCausticPaths(const BSDF &bsdf) const {
 	assert (IsPhotonGIEnabled(bsdf));
 
 	SpectrumGroup result;
-	if (causticPhotonsBVH) {
-		result = causticPhotonsBVH->ConnectAllNearEntries(bsdf);
+	// The BVH can be replaced by a background update, read it only once
+	const PGICPhotonBvh *bvh = causticPhotonsBVH.load(boost::memory_order_acquire);
+	if (bvh) {
+		result = bvh->ConnectAllNearEntries(bsdf);
 
 		assert (result.IsValid());
 	}
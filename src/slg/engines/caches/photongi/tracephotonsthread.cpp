@@ -62,6 +62,11 @@ void TracePhotonsThread::Start() {
 	renderThread = new boost::thread(&TracePhotonsThread::RenderFunc, this);
 }
 
+void TracePhotonsThread::Interrupt() {
+	if (renderThread)
+		renderThread->interrupt();
+}
+
 void TracePhotonsThread::Join() {
 	if (renderThread) {
 		renderThread->join();
@@ -211,9 +211,13 @@ void FileSaverRenderEngine::ExportSceneGLTF(const RenderConfig *renderConfig,
 
 		u_int vertexUVsAccessorIndex = NULL_INDEX;
 		if (scnObj->HasBakeMap(COMBINED) && triMesh->HasUVs(scnObj->GetBakeMapUVIndex())) {
+			// Compressed meshes don't have a UV array to export
+			vector<UV> vertexUVs(triMesh->GetTotalVertexCount());
+			for (u_int uvIndex = 0; uvIndex < triMesh->GetTotalVertexCount(); ++uvIndex)
+				vertexUVs[uvIndex] = triMesh->GetUV(uvIndex, scnObj->GetBakeMapUVIndex());
+
 			const size_t encodedVertexUVsSize = sizeof(UV) * triMesh->GetTotalVertexCount();
-			const string encodedVertexUVs = Base64Encode(
-					(const char *)(triMesh->GetAllUVs()[scnObj->GetBakeMapUVIndex()]),
+			const string encodedVertexUVs = Base64Encode((const char *)&vertexUVs[0],
 					encodedVertexUVsSize);
 
 			j["buffers"].push_back(json::object({
@@ -234,7 +238,7 @@ void FileSaverRenderEngine::ExportSceneGLTF(const RenderConfig *renderConfig,
 
 			UV minUV(numeric_limits<float>::infinity(), numeric_limits<float>::infinity());
 			UV maxUV(-numeric_limits<float>::infinity(), -numeric_limits<float>::infinity());
-			UV *uv = triMesh->GetAllUVs()[scnObj->GetBakeMapUVIndex()];
+			const UV *uv = &vertexUVs[0];
 			for (u_int uvIndex = 0; uvIndex < triMesh->GetTotalVertexCount(); ++uvIndex) {
 				minUV.u = Min(minUV.u, uv[uvIndex].u);
 				minUV.v = Min(minUV.v, uv[uvIndex].v);
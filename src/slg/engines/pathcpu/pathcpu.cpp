@@ -123,8 +123,11 @@ void PathCPURenderEngine::StartLockLess() {
 		photonGICache = PhotonGICache::FromProperties(renderConfig->scene, cfg);
 
 		// photonGICache will be nullptr if the cache is disabled
-		if (photonGICache)
+		if (photonGICache) {
+			const double startTime = WallClockTime();
 			photonGICache->Preprocess(renderThreads.size());
+			cachesPreprocessTime = WallClockTime() - startTime;
+		}
 	}
 
 	//--------------------------------------------------------------------------
@@ -130,9 +130,8 @@ void PathCPURenderThread::RenderFunc() {
 
 	threadDone = true;
 
-	// This is done to stop threads pending on barrier wait
-	// inside engine->photonGICache->Update(). This can happen when an
-	// halt condition is satisfied.
+	// This is done to stop any background PhotonGI caustic cache update
+	// started by engine->photonGICache->Update().
 	if (engine->photonGICache)
 		engine->photonGICache->FinishUpdate(threadIndex);
 
@@ -230,8 +230,14 @@ void CompiledScene::CompileGeometry() {
 			//------------------------------------------------------------------
 
 			if (baseMesh->HasNormals()) {
-				const Normal *n = baseMesh->GetNormals();
-				normals.insert(normals.end(), n, n + baseMesh->GetTotalVertexCount());
+				if (baseMesh->IsCompressed()) {
+					// Compressed attributes are decoded for the OpenCL kernels
+					for (u_int i = 0; i < baseMesh->GetTotalVertexCount(); ++i)
+						normals.push_back(baseMesh->GetVertexNormal(i));
+				} else {
+					const Normal *n = baseMesh->GetNormals();
+					normals.insert(normals.end(), n, n + baseMesh->GetTotalVertexCount());
+				}
 			}
 
 			//------------------------------------------------------------------
@@ -247,8 +253,13 @@ void CompiledScene::CompileGeometry() {
 				//--------------------------------------------------------------
 
 				if (baseMesh->HasUVs(dataIndex)) {
-					const UV *u = baseMesh->GetUVs(dataIndex);
-					uvs.insert(uvs.end(), u, u + baseMesh->GetTotalVertexCount());
+					if (baseMesh->IsCompressed()) {
+						for (u_int i = 0; i < baseMesh->GetTotalVertexCount(); ++i)
+							uvs.push_back(baseMesh->GetVertexUV(i, dataIndex));
+					} else {
+						const UV *u = baseMesh->GetUVs(dataIndex);
+						uvs.insert(uvs.end(), u, u + baseMesh->GetTotalVertexCount());
+					}
 				}
 
 				//--------------------------------------------------------------
@@ -256,8 +267,13 @@ void CompiledScene::CompileGeometry() {
 				//--------------------------------------------------------------
 
 				if (baseMesh->HasColors(dataIndex)) {
-					const Spectrum *c = baseMesh->GetColors(dataIndex);
-					cols.insert(cols.end(), c, c + baseMesh->GetTotalVertexCount());
+					if (baseMesh->IsCompressed()) {
+						for (u_int i = 0; i < baseMesh->GetTotalVertexCount(); ++i)
+							cols.push_back(baseMesh->GetVertexColor(i, dataIndex));
+					} else {
+						const Spectrum *c = baseMesh->GetColors(dataIndex);
+						cols.insert(cols.end(), c, c + baseMesh->GetTotalVertexCount());
+					}
 				}
 
 				//--------------------------------------------------------------
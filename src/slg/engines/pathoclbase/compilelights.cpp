@@ -20,6 +20,7 @@
 
 #include <iosfwd>
 #include <limits>
+#include <cstring>
 
 #include <boost/lexical_cast.hpp>
 #include <boost/algorithm/string.hpp>
@@ -64,6 +65,10 @@ void CompiledScene::CompileDLSC(const LightStrategyDLSCache *dlscLightStrategy)
 		return;
 	}
 
+	// The OpenCL data can not be updated while rendering so a progressive
+	// build must be finished
+	dlscLightStrategy->WaitForCacheBuild();
+
 	dlscRadius2 = dlscLightStrategy->GetEntryRadius() * dlscLightStrategy->GetEntryRadius();
 	dlscNormalCosAngle = cosf(Radians(dlscLightStrategy->GetEntryNormalAngle()));
 
@@ -218,7 +223,12 @@ void CompiledScene::CompileELVC(const EnvLightVisibilityCache *visibilityMapCach
 		const u_int entriesCount = allEntries->size();
 
 		elvcAllEntries.resize(entriesCount);
-		elvcDistributions.clear();
+
+		// The base map shared by all visibility maps is at the beginning of
+		// the table
+		const vector<float> &baseMap = visibilityMapCache->GetBaseMap();
+		elvcDistributions = baseMap;
+
 		for (u_int i = 0; i < entriesCount; ++i) {
 			const ELVCacheEntry &entry = (*allEntries)[i];
 			slg::ocl::ELVCacheEntry &oclEntry = elvcAllEntries[i];
@@ -231,20 +241,27 @@ void CompiledScene::CompileELVC(const EnvLightVisibilityCache *visibilityMapCach
 			if (!entry.visibilityMap)
 				oclEntry.distributionOffset = NULL_INDEX;
 			else {
-				// Compile the light Distribution2D
+				// Compile the visibility map: the function average, the
+				// marginal CDF and the 8bit visibility values packed in 32bit
 				const u_int size = elvcDistributions.size();
 				oclEntry.distributionOffset = size;
 
-				u_int distributionSize;
-				float *dist = CompileDistribution2D(entry.visibilityMap, &distributionSize);
+				const vector<float> &marginalCDF = entry.visibilityMap->GetMarginalCDF();
+				const vector<u_char> &visibility = entry.visibilityMap->GetVisibility();
+				const u_int visibilitySize4 = (visibility.size() + 3) / 4;
+				elvcDistributions.resize(size + 1 + marginalCDF.size() + visibilitySize4, 0.f);
 
-				const u_int distributionSize4 = distributionSize / sizeof(float);
-				elvcDistributions.resize(size + distributionSize4);
+				elvcDistributions[size] = entry.visibilityMap->GetAverage();
+				copy(marginalCDF.begin(), marginalCDF.end(), &elvcDistributions[size + 1]);
 
-				copy(dist, dist + distributionSize4,
-						&elvcDistributions[size]);
+				float *packedVisibility = &elvcDistributions[size + 1 + marginalCDF.size()];
+				for (u_int j = 0; j < visibilitySize4; ++j) {
+					u_int packed = 0;
+					for (u_int k = 0; (k < 4) && (j * 4 + k < visibility.size()); ++k)
+						packed |= ((u_int)visibility[j * 4 + k]) << (k * 8);
 
-				delete[] dist;
+					memcpy(&packedVisibility[j], &packed, sizeof(u_int));
+				}
 			}
 		}
 	
@@ -301,6 +301,20 @@ void PathOCLBaseRenderEngine::StartLockLess() {
 	
 	writeKernelsToFile = cfg.Get(Property("opencl.kernel.writetofile")(false)).Get<bool>();
 
+	//--------------------------------------------------------------------------
+	// Allocate OpenCL render threads and start the background compilation of
+	// the kernels, it runs in parallel with the scene preprocessing
+	//--------------------------------------------------------------------------
+
+	for (size_t i = 0; i < oclRenderThreadCount; ++i) {
+		if (!renderOCLThreads[i]) {
+			renderOCLThreads[i] = CreateOCLThread(i,
+					(HardwareIntersectionDevice *)(intersectionDevices[i]));
+		}
+
+		renderOCLThreads[i]->StartKernelsCompilation();
+	}
+
 	//--------------------------------------------------------------------------
 	// Allocate PhotonGICache if enabled
 	//--------------------------------------------------------------------------
@@ -311,8 +325,11 @@ void PathOCLBaseRenderEngine::StartLockLess() {
 		photonGICache = PhotonGICache::FromProperties(renderConfig->scene, cfg);
 		
 		// photonGICache will be nullptr if the cache is disabled
-		if (photonGICache)
+		if (photonGICache) {
+			const double startTime = WallClockTime();
 			photonGICache->Preprocess(renderNativeThreads.size() + renderOCLThreads.size());
+			cachesPreprocessTime = WallClockTime() - startTime;
+		}
 	}
 
 	pathTracer.SetPhotonGICache(photonGICache);
@@ -337,13 +354,6 @@ void PathOCLBaseRenderEngine::StartLockLess() {
 	//--------------------------------------------------------------------------
 
 	SLG_LOG("Starting "<< oclRenderThreadCount << " OpenCL render threads");
-	for (size_t i = 0; i < oclRenderThreadCount; ++i) {
-		if (!renderOCLThreads[i]) {
-			renderOCLThreads[i] = CreateOCLThread(i,
-					(HardwareIntersectionDevice *)(intersectionDevices[i]));
-		}
-	}
-
 	for (size_t i = 0; i < renderOCLThreads.size(); ++i) {
 		renderOCLThreads[i]->intersectionDevice->PushThreadCurrentDevice();
 		renderOCLThreads[i]->Start();
@@ -415,6 +425,13 @@ void PathOCLBaseRenderEngine::BeginSceneEditLockLess() {
 }
 
 void PathOCLBaseRenderEngine::EndSceneEditLockLess(const EditActionList &editActions) {
+	// Kernels, if required, are compiled in parallel with the scene compilation
+	// (RTPATHOCL threads update the kernels asynchronously on their own)
+	if (GetType() != RTPATHOCL) {
+		for (size_t i = 0; i < renderOCLThreads.size(); ++i)
+			renderOCLThreads[i]->StartKernelsCompilation();
+	}
+
 	compiledScene->Recompile(editActions);
 
 	for (size_t i = 0; i < renderOCLThreads.size(); ++i) {
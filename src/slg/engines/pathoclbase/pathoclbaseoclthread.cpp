@@ -54,6 +54,8 @@ PathOCLBaseOCLRenderThread::PathOCLBaseOCLRenderThread(const u_int index,
 	threadDone = false;
 
 	kernelSrcHash = "";
+	kernelsCompilationThread = nullptr;
+	kernelsCompilationProgram = nullptr;
 	filmClearKernel = nullptr;
 
 	// Scene buffers
@@ -141,6 +143,9 @@ PathOCLBaseOCLRenderThread::~PathOCLBaseOCLRenderThread() {
 
 	FreeThreadFilms();
 
+	// Wait for any pending background compilation
+	WaitForKernelsCompilation("");
+
 	delete filmClearKernel;
 	delete initSeedKernel;
 	delete initKernel;
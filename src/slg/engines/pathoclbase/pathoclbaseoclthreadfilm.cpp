@@ -123,6 +123,8 @@ void PathOCLBaseOCLRenderThread::ThreadFilm::Init(Film *engineFlm,
 	// hybrid back/forward path tracing
 	film->RemoveChannel(Film::RADIANCE_PER_SCREEN_NORMALIZED);
 	film->Init();
+	// The OpenCL kernels accumulate the denoiser statistics in float buffers
+	film->GetDenoiser().SetCompactAccumulators(false);
 
 	//--------------------------------------------------------------------------
 	// Film channel buffers
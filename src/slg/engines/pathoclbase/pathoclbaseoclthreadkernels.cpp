@@ -239,13 +239,8 @@ string PathOCLBaseOCLRenderThread::GetKernelSources() {
 	return ssKernel.str();
 }
 
-void PathOCLBaseOCLRenderThread::InitKernels() {
-	//--------------------------------------------------------------------------
-	// Compile kernels
-	//--------------------------------------------------------------------------
-
-	const double tStart = WallClockTime();
-
+void PathOCLBaseOCLRenderThread::GetKernelsProgram(vector<string> &kernelsParameters,
+		string &kernelSource, string &newKernelSrcHash) {
 	// A safety check
 	switch (intersectionDevice->GetAccelerator()->GetType()) {
 		case ACCEL_BVH:
@@ -260,12 +255,12 @@ void PathOCLBaseOCLRenderThread::InitKernels() {
 			throw runtime_error("Unknown accelerator in PathOCLBaseRenderThread::InitKernels()");
 	}
 
-	vector<string> kernelsParameters;
+	kernelsParameters.clear();
 	GetKernelParamters(kernelsParameters, intersectionDevice,
 			RenderEngine::RenderEngineType2String(renderEngine->GetType()),
 			MachineEpsilon::GetMin(), MachineEpsilon::GetMax());
 
-	const string kernelSource = GetKernelSources();
+	kernelSource = GetKernelSources();
 
 	if (renderEngine->writeKernelsToFile) {
 		// Some debug code to write the OpenCL kernel source to a file
@@ -286,19 +281,96 @@ void PathOCLBaseOCLRenderThread::InitKernels() {
 		kernelsParameters.insert(kernelsParameters.end(), renderEngine->additionalCUDAKernelOptions.begin(), renderEngine->additionalCUDAKernelOptions.end());
 
 	// Build the kernel source/parameters hash
-	const string newKernelSrcHash = oclKernelPersistentCache::HashString(oclKernelPersistentCache::ToOptsString(kernelsParameters))
+	newKernelSrcHash = oclKernelPersistentCache::HashString(oclKernelPersistentCache::ToOptsString(kernelsParameters))
 			+ "-" +
 			oclKernelPersistentCache::HashString(kernelSource);
+}
+
+void PathOCLBaseOCLRenderThread::StartKernelsCompilation() {
+	if (kernelsCompilationThread)
+		return;
+
+	vector<string> kernelsParameters;
+	string kernelSource, newKernelSrcHash;
+	GetKernelsProgram(kernelsParameters, kernelSource, newKernelSrcHash);
+
 	if (newKernelSrcHash == kernelSrcHash) {
 		// There is no need to re-compile the kernel
 		return;
-	} else
-		kernelSrcHash = newKernelSrcHash;
+	}
 
-	SLG_LOG("[PathOCLBaseRenderThread::" << threadIndex << "] Compiling kernels ");
+	SLG_LOG("[PathOCLBaseRenderThread::" << threadIndex << "] Starting background kernels compilation");
+	kernelsCompilationThread = new boost::thread(&PathOCLBaseOCLRenderThread::KernelsCompilationThreadImpl,
+			this, kernelsParameters, kernelSource, newKernelSrcHash);
+}
 
+void PathOCLBaseOCLRenderThread::KernelsCompilationThreadImpl(const vector<string> kernelsParameters,
+		const string kernelSource, const string newKernelSrcHash) {
 	HardwareDeviceProgram *program = nullptr;
-	intersectionDevice->CompileProgram(&program, kernelsParameters, kernelSource, "PathOCL kernel");
+
+	intersectionDevice->PushThreadCurrentDevice();
+	try {
+		intersectionDevice->CompileProgram(&program, kernelsParameters, kernelSource, "PathOCL kernel");
+	} catch (exception &e) {
+		// InitKernels() will compile the program again and report the error
+		SLG_LOG("[PathOCLBaseRenderThread::" << threadIndex << "] Background kernels compilation error: " << e.what());
+
+		delete program;
+		program = nullptr;
+	}
+	intersectionDevice->PopThreadCurrentDevice();
+
+	kernelsCompilationProgram = program;
+	kernelsCompilationSrcHash = newKernelSrcHash;
+}
+
+HardwareDeviceProgram *PathOCLBaseOCLRenderThread::WaitForKernelsCompilation(const string &newKernelSrcHash) {
+	if (!kernelsCompilationThread)
+		return nullptr;
+
+	kernelsCompilationThread->join();
+	delete kernelsCompilationThread;
+	kernelsCompilationThread = nullptr;
+
+	HardwareDeviceProgram *program = kernelsCompilationProgram;
+	kernelsCompilationProgram = nullptr;
+
+	// Discard the program if the kernel parameters have changed in the meantime
+	if (program && (kernelsCompilationSrcHash != newKernelSrcHash)) {
+		delete program;
+		program = nullptr;
+	}
+
+	return program;
+}
+
+void PathOCLBaseOCLRenderThread::InitKernels() {
+	//--------------------------------------------------------------------------
+	// Compile kernels
+	//--------------------------------------------------------------------------
+
+	const double tStart = WallClockTime();
+
+	vector<string> kernelsParameters;
+	string kernelSource, newKernelSrcHash;
+	GetKernelsProgram(kernelsParameters, kernelSource, newKernelSrcHash);
+
+	// Pick up the result of the background compilation, if there is one
+	HardwareDeviceProgram *program = WaitForKernelsCompilation(newKernelSrcHash);
+
+	if (newKernelSrcHash == kernelSrcHash) {
+		// There is no need to re-compile the kernel
+		delete program;
+		return;
+	} else
+		kernelSrcHash = newKernelSrcHash;
+
+	if (program) {
+		SLG_LOG("[PathOCLBaseRenderThread::" << threadIndex << "] Using background compiled kernels");
+	} else {
+		SLG_LOG("[PathOCLBaseRenderThread::" << threadIndex << "] Compiling kernels ");
+		intersectionDevice->CompileProgram(&program, kernelsParameters, kernelSource, "PathOCL kernel");
+	}
 
 	// Film clear kernel
 	CompileKernel(intersectionDevice, program, &filmClearKernel, &filmClearWorkGroupSize, "Film_Clear");
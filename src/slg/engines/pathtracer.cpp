@@ -22,6 +22,7 @@
 #include "slg/engines/caches/photongi/photongicache.h"
 #include "slg/samplers/metropolis.h"
 #include "slg/utils/varianceclamping.h"
+#include "slg/utils/profiler.h"
 
 using namespace std;
 using namespace luxrays;
@@ -104,8 +105,7 @@ void PathTracer::ResetEyeSampleResults(vector<SampleResult> &sampleResults) {
 
 	// Set to 0.0 all result colors
 	sampleResult.emission = Spectrum();
-	for (u_int i = 0; i < sampleResult.radiance.Size(); ++i)
-		sampleResult.radiance[i] = Spectrum();
+	sampleResult.radiance.Clear();
 	sampleResult.directDiffuseReflect = Spectrum();
 	sampleResult.directDiffuseTransmit = Spectrum();
 	sampleResult.directGlossyReflect = Spectrum();
@@ -148,8 +148,12 @@ PathTracer::DirectLightResult PathTracer::DirectLightSampling(
 		// Pick a light source to sample
 		const Normal landingNormal = bsdf.hitPoint.intoObject ? bsdf.hitPoint.shadeN : -bsdf.hitPoint.shadeN;
 		float lightPickPdf;
-		const LightSource *light = lightStrategy->SampleLights(u0,
-				bsdf.hitPoint.p, landingNormal, bsdf.IsVolume(), &lightPickPdf);
+		const LightSource *light;
+		{
+			SLG_PROFILE(PROFILER_LIGHT_SAMPLING);
+			light = lightStrategy->SampleLights(u0,
+					bsdf.hitPoint.p, landingNormal, bsdf.IsVolume(), &lightPickPdf);
+		}
 
 		if (light) {
 			Ray shadowRay;
@@ -375,6 +379,8 @@ void PathTracer::RenderEyePath(IntersectionDevice *device,
 		const Scene *scene, Sampler *sampler, EyePathInfo &pathInfo,
 		Ray &eyeRay,  const luxrays::Spectrum &eyeTroughput,
 		vector<SampleResult> &sampleResults) const {
+	SLG_PROFILE(PROFILER_PATH_EYE);
+
 	// To keep track of the number of rays traced
 	const double deviceRayCount = device->GetTotalRaysCount();
 
@@ -390,6 +396,8 @@ void PathTracer::RenderEyePath(IntersectionDevice *device,
 	sampleResult.shadingNormal = Normal();
 	Spectrum pathThroughput(eyeTroughput);
 	BSDF bsdf;
+	// The texture values of the current path vertex material
+	TextureValueCache texValueCache;
 	for (;;) {
 		sampleResult.firstPathVertex = (pathInfo.depth.depth == 0);
 		const u_int sampleOffset = eyeSampleBootSize + pathInfo.depth.depth * eyeSampleStepSize;
@@ -443,6 +451,8 @@ void PathTracer::RenderEyePath(IntersectionDevice *device,
 
 		// Something was hit
 
+		bsdf.SetTextureValueCache(&texValueCache);
+
 		if (albedoToDo && bsdf.IsAlbedoEndPoint(albedoSpecularSetting, albedoSpecularGlossinessThreshold)) {
 			sampleResult.albedo = pathThroughput * bsdf.Albedo();
 			sampleResult.shadingNormal = bsdf.hitPoint.shadeN;
@@ -770,6 +780,12 @@ void PathTracer::RenderLightSample(IntersectionDevice *device,
 		const Scene *scene, const Film *film,
 		Sampler *sampler, vector<SampleResult> &sampleResults,
 		const ConnectToEyeCallBackType &ConnectToEyeCallBack) const {
+	// A light path adds at most one SampleResult for each vertex. The vector
+	// is sized once and then reused, SampleResult has no heap allocated data
+	// up to SPECTRUMGROUP_INLINE_SIZE radiance groups.
+	const u_int maxSampleResults = maxPathDepth.depth + 2;
+	if (sampleResults.capacity() < maxSampleResults)
+		sampleResults.reserve(maxSampleResults);
 	sampleResults.clear();
 
 	Spectrum lightPathFlux;
@@ -779,8 +795,12 @@ void PathTracer::RenderLightSample(IntersectionDevice *device,
 
 	// Select one light source
 	float lightPickPdf;
-	const LightSource *light = scene->lightDefs.GetEmitLightStrategy()->
-			SampleLights(sampler->GetSample(0), &lightPickPdf);
+	const LightSource *light;
+	{
+		SLG_PROFILE(PROFILER_LIGHT_SAMPLING);
+		light = scene->lightDefs.GetEmitLightStrategy()->
+				SampleLights(sampler->GetSample(0), &lightPickPdf);
+	}
 
 	if (light) {
 		// Initialize the light path
@@ -798,6 +818,8 @@ void PathTracer::RenderLightSample(IntersectionDevice *device,
 		assert (!lightPathFlux.IsNaN() && !lightPathFlux.IsInf());
 
 		LightPathInfo pathInfo;
+		// The texture values of the current path vertex material
+		TextureValueCache texValueCache;
 
 		// Sample a point on the camera lens
 		if (!scene->camera->SampleLens(time, sampler->GetSample(6), sampler->GetSample(7),
@@ -824,6 +846,8 @@ void PathTracer::RenderLightSample(IntersectionDevice *device,
 
 			// Something was hit
 
+			bsdf.SetTextureValueCache(&texValueCache);
+
 			lightPathFlux *= connectionThroughput;
 
 			//--------------------------------------------------------------
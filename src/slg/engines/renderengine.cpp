@@ -58,6 +58,7 @@ RenderEngine::RenderEngine(const RenderConfig *cfg) :
 	started = false;
 	editMode = false;
 	pauseMode = false;
+	cachesPreprocessTime = 0.0;
 
 	if (renderConfig->cfg.IsDefined("renderengine.seed")) {
 		const u_int seed = Max(1u, renderConfig->cfg.Get("renderengine.seed").Get<u_int>());
@@ -132,6 +133,11 @@ void RenderEngine::Start(Film *flm, boost::mutex *flmMutex) {
 		startFilm = nullptr;
 	}
 
+	// Resume any background work of the light strategies stopped by Stop()
+	// (i.e. if the light sources have not been preprocessed again)
+	scene->lightDefs.ResumePreprocess();
+
+	cachesPreprocessTime = 0.0;
 	StartLockLess();
 
 	film->ResetTests();
@@ -142,6 +148,10 @@ void RenderEngine::Stop() {
 
 	StopLockLess();
 
+	// Stop any background work of the light strategies (i.e. a progressive
+	// DLSC build)
+	renderConfig->scene->lightDefs.StopPreprocess();
+
 	assert (started);
 	started = false;
 
@@ -162,6 +172,10 @@ void RenderEngine::BeginSceneEdit() {
 	editMode = true;
 
 	BeginSceneEditLockLess();
+
+	// The scene is going to be edited, stop any background work of the
+	// light strategies (i.e. a progressive DLSC build)
+	renderConfig->scene->lightDefs.StopPreprocess();
 }
 
 void RenderEngine::EndSceneEdit(const EditActionList &editActions) {
@@ -173,6 +187,9 @@ void RenderEngine::EndSceneEdit(const EditActionList &editActions) {
 	// Pre-process scene data
 	renderConfig->scene->Preprocess(ctx, film->GetWidth(), film->GetHeight(), film->GetSubRegion(),
 			IsRTMode());
+	// The lights are preprocessed again only after a light or geometry edit,
+	// resume the background work stopped by BeginSceneEdit() otherwise
+	renderConfig->scene->lightDefs.ResumePreprocess();
 
 	// Reset halt conditions
 	film->ResetTests();
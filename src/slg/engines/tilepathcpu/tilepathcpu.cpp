@@ -112,8 +112,11 @@ void TilePathCPURenderEngine::StartLockLess() {
 		photonGICache = PhotonGICache::FromProperties(renderConfig->scene, cfg);
 
 		// photonGICache will be nullptr if the cache is disabled
-		if (photonGICache)
+		if (photonGICache) {
+			const double startTime = WallClockTime();
 			photonGICache->Preprocess(renderThreads.size());
+			cachesPreprocessTime = WallClockTime() - startTime;
+		}
 	}
 
 	//--------------------------------------------------------------------------
@@ -64,6 +64,7 @@ void FilmDenoiser::Init() {
 	referenceFilmOffsetY = 0;
 
 	enabled = false;
+	compactAccumulators = true;
 }
 
 void FilmDenoiser::Clear() {
@@ -111,7 +112,7 @@ float *FilmDenoiser::GetCovarImage() {
 }
 
 float *FilmDenoiser::GetHistoImage() {
-	if (samplesAccumulatorPixelNormalized)
+	if (samplesAccumulatorPixelNormalized && !samplesAccumulatorPixelNormalized->IsCompact())
 		return samplesAccumulatorPixelNormalized->m_samplesStatisticsImages.m_histoImage.getDataPtr();
 	else
 		return NULL;
@@ -159,10 +160,10 @@ void FilmDenoiser::CopyReferenceFilm(const Film *refFilm) {
 		// Allocate denoiser samples collectors
 		if (film->HasChannel(Film::RADIANCE_PER_PIXEL_NORMALIZED))
 			samplesAccumulatorPixelNormalized = new SamplesAccumulator(film->GetWidth(), film->GetHeight(),
-					histogramParameters);
+					histogramParameters, compactAccumulators);
 		if (film->HasChannel(Film::RADIANCE_PER_SCREEN_NORMALIZED))
 			samplesAccumulatorScreenNormalized = new SamplesAccumulator(film->GetWidth(), film->GetHeight(),
-					histogramParameters);
+					histogramParameters, compactAccumulators);
 
 		warmUpDone = true;
 	}
@@ -225,10 +226,10 @@ void FilmDenoiser::WarmUpDone() {
 	// Allocate denoiser samples collectors
 	if (film->HasChannel(Film::RADIANCE_PER_PIXEL_NORMALIZED))
 		samplesAccumulatorPixelNormalized = new SamplesAccumulator(film->GetWidth(), film->GetHeight(),
-				histogramParameters);
+				histogramParameters, compactAccumulators);
 	if (film->HasChannel(Film::RADIANCE_PER_SCREEN_NORMALIZED))
 		samplesAccumulatorScreenNormalized = new SamplesAccumulator(film->GetWidth(), film->GetHeight(),
-				histogramParameters);
+				histogramParameters, compactAccumulators);
 
 	// This will trigger the thread using this film as reference
 	warmUpDone = true;
@@ -252,10 +253,21 @@ bcd::SamplesStatisticsImages FilmDenoiser::GetSamplesStatistics(const bool pixel
 		return bcd::SamplesStatisticsImages();
 }
 
+bcd::SamplesStatisticsImages FilmDenoiser::GetSamplesStatistics(const bool pixelNormalizedSampleAccumulator,
+		const int line, const int column, const int width, const int height) const {
+	if (pixelNormalizedSampleAccumulator && samplesAccumulatorPixelNormalized)
+		return samplesAccumulatorPixelNormalized->GetSamplesStatistics(line, column, width, height);
+	else if (!pixelNormalizedSampleAccumulator && samplesAccumulatorScreenNormalized)
+		return samplesAccumulatorScreenNormalized->GetSamplesStatistics(line, column, width, height);
+	else
+		return bcd::SamplesStatisticsImages();
+}
+
 void FilmDenoiser::AddDenoiser(const FilmDenoiser &filmDenoiser,
 		const u_int srcOffsetX, const u_int srcOffsetY,
 		const u_int srcWidth, const u_int srcHeight,
-		const u_int dstOffsetX, const u_int dstOffsetY) {
+		const u_int dstOffsetX, const u_int dstOffsetY,
+		const float weight) {
 	if (enabled &&
 			samplesAccumulatorPixelNormalized &&
 			filmDenoiser.enabled &&
@@ -265,12 +277,12 @@ void FilmDenoiser::AddDenoiser(const FilmDenoiser &filmDenoiser,
 			samplesAccumulatorPixelNormalized->AddAccumulator(*filmDenoiser.samplesAccumulatorPixelNormalized,
 					(int)srcOffsetX, (int)srcOffsetY,
 					(int)srcWidth, (int)srcHeight,
-					(int)dstOffsetX, (int)dstOffsetY);
+					(int)dstOffsetX, (int)dstOffsetY, weight);
 		if (samplesAccumulatorScreenNormalized && filmDenoiser.samplesAccumulatorScreenNormalized)
 			samplesAccumulatorScreenNormalized->AddAccumulator(*filmDenoiser.samplesAccumulatorScreenNormalized,
 					(int)srcOffsetX, (int)srcOffsetY,
 					(int)srcWidth, (int)srcHeight,
-					(int)dstOffsetX, (int)dstOffsetY);
+					(int)dstOffsetX, (int)dstOffsetY, weight);
 	}
 }
 
@@ -278,6 +290,16 @@ void FilmDenoiser::AddDenoiser(const FilmDenoiser &filmDenoiser) {
 	AddDenoiser(filmDenoiser, 0, 0, film->GetWidth(), film->GetHeight(), 0, 0);
 }
 
+void FilmDenoiser::Scale(const float weight) {
+	if (!enabled || HasReferenceFilm())
+		return;
+
+	if (samplesAccumulatorPixelNormalized)
+		samplesAccumulatorPixelNormalized->Scale(weight);
+	if (samplesAccumulatorScreenNormalized)
+		samplesAccumulatorScreenNormalized->Scale(weight);
+}
+
 void FilmDenoiser::AddSample(const u_int x, const u_int y,
 		const SampleResult &sampleResult, const float weight) {
 	if (!enabled)
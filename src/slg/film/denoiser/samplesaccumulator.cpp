@@ -27,16 +27,141 @@
 // BSD-style license that can be found in the LICENSE.txt file.
 
 #include <cassert>
+#include <algorithm>
+#include <stdexcept>
+
+#include <boost/atomic.hpp>
 
 #include <bcd/core/CovarianceMatrix.h>
 
-#include "luxrays/utils/atomic.h"
+#include "luxrays/utils/utils.h"
+#include "luxrays/utils/strutils.h"
 #include "slg/film/denoiser/samplesaccumulator.h"
 
 using namespace std;
 using namespace luxrays;
 using namespace slg;
 
+//------------------------------------------------------------------------------
+// SamplesAccumulatorStaging
+//------------------------------------------------------------------------------
+
+// The number of pixels a staging buffer can hold before being flushed
+#define SAMPLES_STAGING_CAPACITY 1024
+#define SAMPLES_STAGING_SLOTS_BITS 11
+#define SAMPLES_STAGING_SLOTS (1u << SAMPLES_STAGING_SLOTS_BITS)
+
+// The value of one unit of the compact histogram bins at the beginning
+#define COMPACT_HISTO_INITIAL_SCALE (1.f / 1024.f)
+
+// The max. number of histogram bins, it is used to allocate the records of
+// the single samples on the stack
+#define SAMPLES_MAX_BINS_COUNT 64
+#define SAMPLES_MAX_RECORD_SIZE (11 + 3 * SAMPLES_MAX_BINS_COUNT)
+
+namespace slg {
+
+class SamplesAccumulatorStaging {
+public:
+	SamplesAccumulatorStaging(const int recSize) :
+			recordSize(recSize),
+			records(SAMPLES_STAGING_CAPACITY * recSize),
+			pixelIndices(SAMPLES_STAGING_CAPACITY),
+			slots(SAMPLES_STAGING_SLOTS, -1),
+			usedCount(0) {
+	}
+
+	// Returns nullptr if the buffer is full
+	float *GetRecord(const u_int pixelIndex) {
+		// Open addressing with linear probing, the table is never more
+		// than half full
+		u_int slot = (pixelIndex * 2654435761u) >> (32 - SAMPLES_STAGING_SLOTS_BITS);
+		for (;;) {
+			const int recordIndex = slots[slot];
+			if (recordIndex < 0)
+				break;
+			if (pixelIndices[recordIndex] == pixelIndex)
+				return &records[recordIndex * recordSize];
+
+			slot = (slot + 1) & (SAMPLES_STAGING_SLOTS - 1);
+		}
+
+		if (usedCount >= SAMPLES_STAGING_CAPACITY)
+			return nullptr;
+
+		const u_int recordIndex = usedCount++;
+		slots[slot] = recordIndex;
+		pixelIndices[recordIndex] = pixelIndex;
+
+		float *record = &records[recordIndex * recordSize];
+		fill(record, record + recordSize, 0.f);
+
+		return record;
+	}
+
+	void Clear() {
+		fill(slots.begin(), slots.end(), -1);
+		usedCount = 0;
+	}
+
+	// Locked by the owner thread for each sample and by Flush()
+	boost::mutex mutex;
+
+	const int recordSize;
+	vector<float> records;
+	vector<u_int> pixelIndices;
+	vector<int> slots;
+	u_int usedCount;
+};
+
+}
+
+namespace {
+
+// A small per-thread cache to find the staging buffer of an accumulator
+// without locking
+typedef struct {
+	u_longlong key;
+	SamplesAccumulatorStaging *staging;
+} StagingCacheEntry;
+
+#define STAGING_CACHE_SIZE 4
+
+thread_local StagingCacheEntry stagingCache[STAGING_CACHE_SIZE] = {};
+thread_local u_int stagingCacheNext = 0;
+
+boost::atomic<u_longlong> stagingKeyCounter(1);
+
+// A per-thread xorshift generator used for the stochastic rounding of the
+// compact histogram bins. Each thread has its own seed, otherwise all threads
+// would make the same rounding decisions and the errors wouldn't average out.
+boost::atomic<u_int> compactHistoRoundingSeedCounter(0);
+
+u_int NewCompactHistoRoundingSeed() {
+	// The MurmurHash3 finalizer spreads the bits of a per-thread counter
+	u_int x = ++compactHistoRoundingSeedCounter;
+	x ^= x >> 16;
+	x *= 0x85ebca6bu;
+	x ^= x >> 13;
+	x *= 0xc2b2ae35u;
+	x ^= x >> 16;
+
+	return (x == 0) ? 0x9e3779b9u : x;
+}
+
+thread_local u_int compactHistoRoundingSeed = NewCompactHistoRoundingSeed();
+
+inline float CompactHistoRoundingValue() {
+	u_int &x = compactHistoRoundingSeed;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+
+	return (x >> 8) * (1.f / 16777216.f);
+}
+
+}
+
 //------------------------------------------------------------------------------
 // BCD samples accumulator
 //------------------------------------------------------------------------------
@@ -45,42 +170,64 @@ BOOST_CLASS_EXPORT_IMPLEMENT(slg::SamplesAccumulator)
 
 SamplesAccumulator::SamplesAccumulator(
 		int i_width, int i_height,
-		const bcd::HistogramParameters &i_rHistogramParameters) :
+		const bcd::HistogramParameters &i_rHistogramParameters,
+		const bool i_compactHistogram) :
 		m_width(i_width), m_height(i_height),
 		m_histogramParameters(i_rHistogramParameters),
-		m_samplesStatisticsImages(i_width, i_height, i_rHistogramParameters.m_nbOfBins),
+		m_samplesStatisticsImages(i_width, i_height, i_compactHistogram ? 0 : i_rHistogramParameters.m_nbOfBins),
 		m_squaredWeightSumsImage(i_width, i_height, 1),
+		m_compactHistogram(i_compactHistogram),
 		m_isValid(true) {
+	if (m_histogramParameters.m_nbOfBins > SAMPLES_MAX_BINS_COUNT)
+		throw runtime_error("Too many histogram bins in SamplesAccumulator: " + ToString(m_histogramParameters.m_nbOfBins));
+
+	InitStaging();
+	if (m_compactHistogram)
+		AllocCompactHistogram();
+
 	Clear();
 }
 
-SamplesAccumulator::SamplesAccumulator() {
+SamplesAccumulator::SamplesAccumulator() : m_compactHistogram(false) {
+	InitStaging();
 }
 
-void SamplesAccumulator::AddSample(
-		int i_line, int i_column,
-		float i_sampleR, float i_sampleG, float i_sampleB,
-		float i_weight) {
-	assert(m_isValid);
+SamplesAccumulator::~SamplesAccumulator() {
+	for (auto staging : m_stagings)
+		delete staging;
+}
 
+void SamplesAccumulator::InitStaging() {
+	m_stagingKey = stagingKeyCounter++;
+}
+
+void SamplesAccumulator::AllocCompactHistogram() {
+	const size_t channelCount = (size_t)m_width * (size_t)m_height * 3;
+
+	m_compactHistoBins.resize(channelCount * m_histogramParameters.m_nbOfBins);
+	m_compactHistoScales.resize(channelCount);
+}
+
+void SamplesAccumulator::AccumulateSample(float *io_record,
+		float i_sampleR, float i_sampleG, float i_sampleB,
+		float i_weight) const {
 	const float sample[3] = {i_sampleR, i_sampleG, i_sampleB};
 	const float satureLevelGamma = 2.f; // used for determining the weight to give to the sample in the highest two bins, when the sample is saturated
 
-	m_samplesStatisticsImages.m_nbOfSamplesImage.get(i_line, i_column, 0) += i_weight;
-	m_squaredWeightSumsImage.get(i_line, i_column, 0) += i_weight * i_weight;
+	io_record[0] += i_weight;
+	io_record[1] += i_weight * i_weight;
 
-	bcd::DeepImage<float>& rSum = m_samplesStatisticsImages.m_meanImage;
-	rSum.get(i_line, i_column, 0) += i_weight * i_sampleR;
-	rSum.get(i_line, i_column, 1) += i_weight * i_sampleG;
-	rSum.get(i_line, i_column, 2) += i_weight * i_sampleB;
+	io_record[2] += i_weight * i_sampleR;
+	io_record[3] += i_weight * i_sampleG;
+	io_record[4] += i_weight * i_sampleB;
 
-	bcd::DeepImage<float>& rCovSum = m_samplesStatisticsImages.m_covarImage;
-	rCovSum.get(i_line, i_column, int(bcd::ESymMatData::e_xx)) += i_weight * i_sampleR * i_sampleR;
-	rCovSum.get(i_line, i_column, int(bcd::ESymMatData::e_yy)) += i_weight * i_sampleG * i_sampleG;
-	rCovSum.get(i_line, i_column, int(bcd::ESymMatData::e_zz)) += i_weight * i_sampleB * i_sampleB;
-	rCovSum.get(i_line, i_column, int(bcd::ESymMatData::e_yz)) += i_weight * i_sampleG * i_sampleB;
-	rCovSum.get(i_line, i_column, int(bcd::ESymMatData::e_xz)) += i_weight * i_sampleR * i_sampleB;
-	rCovSum.get(i_line, i_column, int(bcd::ESymMatData::e_xy)) += i_weight * i_sampleR * i_sampleG;
+	float *rCovSum = &io_record[5];
+	rCovSum[int(bcd::ESymMatData::e_xx)] += i_weight * i_sampleR * i_sampleR;
+	rCovSum[int(bcd::ESymMatData::e_yy)] += i_weight * i_sampleG * i_sampleG;
+	rCovSum[int(bcd::ESymMatData::e_zz)] += i_weight * i_sampleB * i_sampleB;
+	rCovSum[int(bcd::ESymMatData::e_yz)] += i_weight * i_sampleG * i_sampleB;
+	rCovSum[int(bcd::ESymMatData::e_xz)] += i_weight * i_sampleR * i_sampleB;
+	rCovSum[int(bcd::ESymMatData::e_xy)] += i_weight * i_sampleR * i_sampleG;
 
 	int floorBinIndex;
 	int ceilBinIndex;
@@ -88,6 +235,7 @@ void SamplesAccumulator::AddSample(
 	float floorBinWeight;
 	float ceilBinWeight;
 
+	float *histo = &io_record[11];
 	for (int32_t channelIndex = 0; channelIndex < 3; ++channelIndex) { // fill histogram; code refactored from Ray Histogram Fusion PBRT code
 		float value = sample[channelIndex];
 		value = (value > 0 ? value : 0);
@@ -111,76 +259,197 @@ void SamplesAccumulator::AddSample(
 			ceilBinWeight = (value - 1.0f) / (satureLevelGamma - 1.f);
 			floorBinWeight = 1.0f - ceilBinWeight;
 		}
-		m_samplesStatisticsImages.m_histoImage.get(i_line, i_column, channelIndex * m_histogramParameters.m_nbOfBins + floorBinIndex) += i_weight * floorBinWeight;
-		m_samplesStatisticsImages.m_histoImage.get(i_line, i_column, channelIndex * m_histogramParameters.m_nbOfBins + ceilBinIndex) += i_weight * ceilBinWeight;
+		histo[channelIndex * m_histogramParameters.m_nbOfBins + floorBinIndex] += i_weight * floorBinWeight;
+		histo[channelIndex * m_histogramParameters.m_nbOfBins + ceilBinIndex] += i_weight * ceilBinWeight;
 	}
 }
 
-void SamplesAccumulator::AddSampleAtomic(
+void SamplesAccumulator::GetHistogram(int i_line, int i_column, int i_channel, float *o_bins) const {
+	const int nbOfBins = m_histogramParameters.m_nbOfBins;
+
+	if (m_compactHistogram) {
+		const size_t index = ((size_t)i_line * m_width + i_column) * 3 + i_channel;
+		const u_short *storedBins = &m_compactHistoBins[index * nbOfBins];
+		const float scale = m_compactHistoScales[index];
+
+		for (int binIndex = 0; binIndex < nbOfBins; ++binIndex)
+			o_bins[binIndex] = storedBins[binIndex] * scale;
+	} else {
+		for (int binIndex = 0; binIndex < nbOfBins; ++binIndex)
+			o_bins[binIndex] = m_samplesStatisticsImages.m_histoImage.get(i_line, i_column, i_channel * nbOfBins + binIndex);
+	}
+}
+
+void SamplesAccumulator::AddHistogram(int i_line, int i_column, int i_channel, const float *i_bins) {
+	const int nbOfBins = m_histogramParameters.m_nbOfBins;
+
+	if (m_compactHistogram) {
+		const size_t index = ((size_t)i_line * m_width + i_column) * 3 + i_channel;
+		u_short *storedBins = &m_compactHistoBins[index * nbOfBins];
+		const float scale = m_compactHistoScales[index];
+
+		// Double the scale until the largest bin fits in 16 bits. Negative
+		// filter weights are clamped to 0.
+		float maxValue = 0.f;
+		for (int binIndex = 0; binIndex < nbOfBins; ++binIndex)
+			maxValue = Max(maxValue, storedBins[binIndex] * scale + i_bins[binIndex]);
+		float newScale = scale;
+		while (maxValue > 65535.f * newScale)
+			newScale *= 2.f;
+
+		// The bins are rounded stochastically: rounding to the nearest value
+		// would drop all the contributions smaller than half a unit, which
+		// is the common case once the scale has grown on a long render.
+		// Bins with an exact value are left untouched.
+		const float invNewScale = 1.f / newScale;
+		for (int binIndex = 0; binIndex < nbOfBins; ++binIndex) {
+			const float value = Max(0.f, (storedBins[binIndex] * scale + i_bins[binIndex]) * invNewScale);
+			const float floorValue = floorf(value);
+			const float roundedValue = (CompactHistoRoundingValue() < value - floorValue) ?
+				(floorValue + 1.f) : floorValue;
+			storedBins[binIndex] = (u_short)Min(roundedValue, 65535.f);
+		}
+
+		m_compactHistoScales[index] = newScale;
+	} else {
+		for (int binIndex = 0; binIndex < nbOfBins; ++binIndex)
+			m_samplesStatisticsImages.m_histoImage.get(i_line, i_column, i_channel * nbOfBins + binIndex) += i_bins[binIndex];
+	}
+}
+
+void SamplesAccumulator::ScaleHistogram(int i_line, int i_column, int i_channel, const float i_weight) {
+	const int nbOfBins = m_histogramParameters.m_nbOfBins;
+
+	if (m_compactHistogram) {
+		// Scaling all the bins is the same as scaling the fixed point unit
+		const size_t index = ((size_t)i_line * m_width + i_column) * 3 + i_channel;
+		if (i_weight > 0.f)
+			m_compactHistoScales[index] *= i_weight;
+		else {
+			// A null scale could never grow again
+			fill(&m_compactHistoBins[index * nbOfBins], &m_compactHistoBins[(index + 1) * nbOfBins], 0);
+			m_compactHistoScales[index] = COMPACT_HISTO_INITIAL_SCALE;
+		}
+	} else {
+		for (int binIndex = 0; binIndex < nbOfBins; ++binIndex)
+			m_samplesStatisticsImages.m_histoImage.get(i_line, i_column, i_channel * nbOfBins + binIndex) *= i_weight;
+	}
+}
+
+void SamplesAccumulator::AddRecord(int i_line, int i_column, const float *i_record) {
+	m_samplesStatisticsImages.m_nbOfSamplesImage.get(i_line, i_column, 0) += i_record[0];
+	m_squaredWeightSumsImage.get(i_line, i_column, 0) += i_record[1];
+
+	for (int i = 0; i < 3; ++i)
+		m_samplesStatisticsImages.m_meanImage.get(i_line, i_column, i) += i_record[2 + i];
+	for (int i = 0; i < 6; ++i)
+		m_samplesStatisticsImages.m_covarImage.get(i_line, i_column, i) += i_record[5 + i];
+
+	for (int channelIndex = 0; channelIndex < 3; ++channelIndex)
+		AddHistogram(i_line, i_column, channelIndex, &i_record[11 + channelIndex * m_histogramParameters.m_nbOfBins]);
+}
+
+void SamplesAccumulator::AddSample(
 		int i_line, int i_column,
 		float i_sampleR, float i_sampleG, float i_sampleB,
 		float i_weight) {
 	assert(m_isValid);
 
-	const float sample[3] = {i_sampleR, i_sampleG, i_sampleB};
-	const float satureLevelGamma = 2.f; // used for determining the weight to give to the sample in the highest two bins, when the sample is saturated
+	float record[SAMPLES_MAX_RECORD_SIZE];
+	fill(record, record + GetRecordSize(), 0.f);
+	AccumulateSample(record, i_sampleR, i_sampleG, i_sampleB, i_weight);
 
-	AtomicAdd(&m_samplesStatisticsImages.m_nbOfSamplesImage.get(i_line, i_column, 0), i_weight);
-	AtomicAdd(&m_squaredWeightSumsImage.get(i_line, i_column, 0), i_weight * i_weight);
+	boost::unique_lock<boost::mutex> lock(m_accumulatorMutex);
+	AddRecord(i_line, i_column, record);
+}
 
-	bcd::DeepImage<float>& rSum = m_samplesStatisticsImages.m_meanImage;
-	AtomicAdd(&rSum.get(i_line, i_column, 0), i_weight * i_sampleR);
-	AtomicAdd(&rSum.get(i_line, i_column, 1), i_weight * i_sampleG);
-	AtomicAdd(&rSum.get(i_line, i_column, 2), i_weight * i_sampleB);
+SamplesAccumulatorStaging *SamplesAccumulator::GetThreadStaging() {
+	for (u_int i = 0; i < STAGING_CACHE_SIZE; ++i) {
+		if (stagingCache[i].key == m_stagingKey)
+			return stagingCache[i].staging;
+	}
 
-	bcd::DeepImage<float>& rCovSum = m_samplesStatisticsImages.m_covarImage;
-	AtomicAdd(&rCovSum.get(i_line, i_column, int(bcd::ESymMatData::e_xx)), i_weight * i_sampleR * i_sampleR);
-	AtomicAdd(&rCovSum.get(i_line, i_column, int(bcd::ESymMatData::e_yy)), i_weight * i_sampleG * i_sampleG);
-	AtomicAdd(&rCovSum.get(i_line, i_column, int(bcd::ESymMatData::e_zz)), i_weight * i_sampleB * i_sampleB);
-	AtomicAdd(&rCovSum.get(i_line, i_column, int(bcd::ESymMatData::e_yz)), i_weight * i_sampleG * i_sampleB);
-	AtomicAdd(&rCovSum.get(i_line, i_column, int(bcd::ESymMatData::e_xz)), i_weight * i_sampleR * i_sampleB);
-	AtomicAdd(&rCovSum.get(i_line, i_column, int(bcd::ESymMatData::e_xy)), i_weight * i_sampleR * i_sampleG);
+	// Allocate a new staging buffer for this thread. The buffers are owned
+	// by the accumulator so the ones of terminated threads are still flushed.
+	SamplesAccumulatorStaging *staging = new SamplesAccumulatorStaging(GetRecordSize());
+	{
+		boost::unique_lock<boost::mutex> lock(m_stagingsMutex);
+		m_stagings.push_back(staging);
+	}
 
-	int floorBinIndex;
-	int ceilBinIndex;
-	float binFloatIndex;
-	float floorBinWeight;
-	float ceilBinWeight;
+	StagingCacheEntry &entry = stagingCache[stagingCacheNext];
+	stagingCacheNext = (stagingCacheNext + 1) % STAGING_CACHE_SIZE;
+	entry.key = m_stagingKey;
+	entry.staging = staging;
 
-	for (int32_t channelIndex = 0; channelIndex < 3; ++channelIndex) { // fill histogram; code refactored from Ray Histogram Fusion PBRT code
-		float value = sample[channelIndex];
-		value = (value > 0 ? value : 0);
-		if (m_histogramParameters.m_gamma > 1)
-			value = pow(value, 1.f / m_histogramParameters.m_gamma); // exponential scaling
-		if (m_histogramParameters.m_maxValue > 0)
-			value = (value / m_histogramParameters.m_maxValue); // normalize to the maximum value
-		value = value > satureLevelGamma ? satureLevelGamma : value;
+	return staging;
+}
 
-		binFloatIndex = value * (m_histogramParameters.m_nbOfBins - 2);
-		floorBinIndex = int(binFloatIndex);
+// The staging buffer mutex must be already locked
+void SamplesAccumulator::FlushStaging(SamplesAccumulatorStaging &staging) {
+	if (staging.usedCount == 0)
+		return;
 
-		if (floorBinIndex < m_histogramParameters.m_nbOfBins - 2) // in bounds
-		{
-			ceilBinIndex = floorBinIndex + 1;
-			ceilBinWeight = binFloatIndex - floorBinIndex;
-			floorBinWeight = 1.0f - ceilBinWeight;
-		} else { //out of bounds... v >= 1
-			floorBinIndex = m_histogramParameters.m_nbOfBins - 2;
-			ceilBinIndex = floorBinIndex + 1;
-			ceilBinWeight = (value - 1.0f) / (satureLevelGamma - 1.f);
-			floorBinWeight = 1.0f - ceilBinWeight;
-		}
-		AtomicAdd(&m_samplesStatisticsImages.m_histoImage.get(i_line, i_column, channelIndex * m_histogramParameters.m_nbOfBins + floorBinIndex), i_weight * floorBinWeight);
-		AtomicAdd(&m_samplesStatisticsImages.m_histoImage.get(i_line, i_column, channelIndex * m_histogramParameters.m_nbOfBins + ceilBinIndex), i_weight * ceilBinWeight);
+	boost::unique_lock<boost::mutex> lock(m_accumulatorMutex);
+
+	for (u_int i = 0; i < staging.usedCount; ++i) {
+		const u_int pixelIndex = staging.pixelIndices[i];
+		AddRecord(pixelIndex / m_width, pixelIndex % m_width, &staging.records[i * staging.recordSize]);
+	}
+
+	staging.Clear();
+}
+
+void SamplesAccumulator::AddSampleAtomic(
+		int i_line, int i_column,
+		float i_sampleR, float i_sampleG, float i_sampleB,
+		float i_weight) {
+	assert(m_isValid);
+
+	SamplesAccumulatorStaging *staging = GetThreadStaging();
+	boost::unique_lock<boost::mutex> lock(staging->mutex);
+
+	const u_int pixelIndex = i_line * m_width + i_column;
+	float *record = staging->GetRecord(pixelIndex);
+	if (!record) {
+		FlushStaging(*staging);
+		record = staging->GetRecord(pixelIndex);
+	}
+
+	AccumulateSample(record, i_sampleR, i_sampleG, i_sampleB, i_weight);
+}
+
+void SamplesAccumulator::Flush() const {
+	// Flushing doesn't change the accumulated statistics, it only moves
+	// samples from the staging buffers
+	SamplesAccumulator *self = const_cast<SamplesAccumulator *>(this);
+
+	boost::unique_lock<boost::mutex> lock(m_stagingsMutex);
+	for (auto staging : m_stagings) {
+		boost::unique_lock<boost::mutex> stagingLock(staging->mutex);
+		self->FlushStaging(*staging);
 	}
 }
 
 void SamplesAccumulator::Clear() {
+	{
+		boost::unique_lock<boost::mutex> lock(m_stagingsMutex);
+		for (auto staging : m_stagings) {
+			boost::unique_lock<boost::mutex> stagingLock(staging->mutex);
+			staging->Clear();
+		}
+	}
+
+	boost::unique_lock<boost::mutex> lock(m_accumulatorMutex);
+
 	m_samplesStatisticsImages.m_nbOfSamplesImage.fill(0.f);
 	m_samplesStatisticsImages.m_meanImage.fill(0.f);
 	m_samplesStatisticsImages.m_covarImage.fill(0.f);
 	m_samplesStatisticsImages.m_histoImage.fill(0.f);
 	m_squaredWeightSumsImage.fill(0.f);
+
+	fill(m_compactHistoBins.begin(), m_compactHistoBins.end(), 0);
+	fill(m_compactHistoScales.begin(), m_compactHistoScales.end(), COMPACT_HISTO_INITIAL_SCALE);
 }
 
 const bcd::HistogramParameters &SamplesAccumulator::GetHistogramParameters() const {
@@ -190,17 +459,25 @@ const bcd::HistogramParameters &SamplesAccumulator::GetHistogramParameters() con
 void SamplesAccumulator::AddAccumulator(const SamplesAccumulator &samplesAccumulator,
 		const int srcOffsetX, const int srcOffsetY,
 		const int srcWidth, const int srcHeight,
-		const int dstOffsetX, const int dstOffsetY) {
+		const int dstOffsetX, const int dstOffsetY,
+		const float weight) {
 	assert(m_isValid);
 	assert(m_histogramParameters.m_nbOfBins == samplesAccumulator.m_histogramParameters.m_nbOfBins);
 	assert(m_histogramParameters.m_gamma == samplesAccumulator.m_histogramParameters.m_gamma);
 	assert(m_histogramParameters.m_maxValue == samplesAccumulator.m_histogramParameters.m_maxValue);
 
-	const int srcTotalHeight = samplesAccumulator.m_samplesStatisticsImages.m_nbOfSamplesImage.getHeight();
-	const int dstTotalHeight = m_samplesStatisticsImages.m_nbOfSamplesImage.getHeight();
+	samplesAccumulator.Flush();
+
+	boost::unique_lock<boost::mutex> lock(m_accumulatorMutex);
+
+	const int srcTotalHeight = samplesAccumulator.m_height;
+	const int dstTotalHeight = m_height;
+	const float squaredWeight = weight * weight;
 
 #pragma omp parallel for
 	for (int line = 0; line < srcHeight; ++line) {
+		vector<float> bins(m_histogramParameters.m_nbOfBins);
+
 		for (int column = 0; column < srcWidth; ++column) {
 			const int srcLine = line + (srcTotalHeight - (srcOffsetY + srcHeight));
 			const int srcColumn = column + srcOffsetX;
@@ -208,45 +485,73 @@ void SamplesAccumulator::AddAccumulator(const SamplesAccumulator &samplesAccumul
 			const int dstColumn = column + dstOffsetX;
 			
 			m_samplesStatisticsImages.m_nbOfSamplesImage.get(dstLine, dstColumn, 0) +=
-					samplesAccumulator.m_samplesStatisticsImages.m_nbOfSamplesImage.get(srcLine, srcColumn, 0);
+					weight * samplesAccumulator.m_samplesStatisticsImages.m_nbOfSamplesImage.get(srcLine, srcColumn, 0);
 
 			m_squaredWeightSumsImage.get(dstLine, dstColumn, 0) +=
-					samplesAccumulator.m_squaredWeightSumsImage.get(srcLine, srcColumn, 0);
+					squaredWeight * samplesAccumulator.m_squaredWeightSumsImage.get(srcLine, srcColumn, 0);
 
 			bcd::DeepImage<float> &rSumDst = m_samplesStatisticsImages.m_meanImage;
 			const bcd::DeepImage<float> &rSumSrc = samplesAccumulator.m_samplesStatisticsImages.m_meanImage;
-			rSumDst.get(dstLine, dstColumn, 0) += rSumSrc.get(srcLine, srcColumn, 0);
-			rSumDst.get(dstLine, dstColumn, 1) += rSumSrc.get(srcLine, srcColumn, 1);
-			rSumDst.get(dstLine, dstColumn, 2) += rSumSrc.get(srcLine, srcColumn, 2);
+			for (int i = 0; i < 3; ++i)
+				rSumDst.get(dstLine, dstColumn, i) += weight * rSumSrc.get(srcLine, srcColumn, i);
 
 			bcd::DeepImage<float> &rCovSumDst = m_samplesStatisticsImages.m_covarImage;
 			const bcd::DeepImage<float> &rCovSumSrc = samplesAccumulator.m_samplesStatisticsImages.m_covarImage;
-			rCovSumDst.get(dstLine, dstColumn, int(bcd::ESymMatData::e_xx)) += rCovSumSrc.get(srcLine, srcColumn, int(bcd::ESymMatData::e_xx));
-			rCovSumDst.get(dstLine, dstColumn, int(bcd::ESymMatData::e_yy)) += rCovSumSrc.get(srcLine, srcColumn, int(bcd::ESymMatData::e_yy));
-			rCovSumDst.get(dstLine, dstColumn, int(bcd::ESymMatData::e_zz)) += rCovSumSrc.get(srcLine, srcColumn, int(bcd::ESymMatData::e_zz));
-			rCovSumDst.get(dstLine, dstColumn, int(bcd::ESymMatData::e_yz)) += rCovSumSrc.get(srcLine, srcColumn, int(bcd::ESymMatData::e_yz));
-			rCovSumDst.get(dstLine, dstColumn, int(bcd::ESymMatData::e_xz)) += rCovSumSrc.get(srcLine, srcColumn, int(bcd::ESymMatData::e_xz));
-			rCovSumDst.get(dstLine, dstColumn, int(bcd::ESymMatData::e_xy)) += rCovSumSrc.get(srcLine, srcColumn, int(bcd::ESymMatData::e_xy));
+			for (int i = 0; i < 6; ++i)
+				rCovSumDst.get(dstLine, dstColumn, i) += weight * rCovSumSrc.get(srcLine, srcColumn, i);
 
 			for (int32_t channelIndex = 0; channelIndex < 3; ++channelIndex) {
-				for (int32_t binIndex = 0; binIndex < m_histogramParameters.m_nbOfBins; ++binIndex) {
-					m_samplesStatisticsImages.m_histoImage.get(dstLine, dstColumn, channelIndex * m_histogramParameters.m_nbOfBins + binIndex) +=
-							samplesAccumulator.m_samplesStatisticsImages.m_histoImage.get(srcLine, srcColumn, channelIndex * m_histogramParameters.m_nbOfBins + binIndex);
+				samplesAccumulator.GetHistogram(srcLine, srcColumn, channelIndex, &bins[0]);
+				if (weight != 1.f) {
+					for (auto &bin : bins)
+						bin *= weight;
 				}
+				AddHistogram(dstLine, dstColumn, channelIndex, &bins[0]);
 			}
 		}
 	}
 }
 
-void SamplesAccumulator::ComputeSampleStatistics(bcd::SamplesStatisticsImages &io_sampleStats) const {
+void SamplesAccumulator::Scale(const float weight) {
+	assert(m_isValid);
+
+	Flush();
+
+	boost::unique_lock<boost::mutex> lock(m_accumulatorMutex);
+
+	const float squaredWeight = weight * weight;
+
 #pragma omp parallel for
 	for (int line = 0; line < m_height; ++line) {
+		for (int column = 0; column < m_width; ++column) {
+			m_samplesStatisticsImages.m_nbOfSamplesImage.get(line, column, 0) *= weight;
+			m_squaredWeightSumsImage.get(line, column, 0) *= squaredWeight;
+
+			for (int i = 0; i < 3; ++i)
+				m_samplesStatisticsImages.m_meanImage.get(line, column, i) *= weight;
+			for (int i = 0; i < 6; ++i)
+				m_samplesStatisticsImages.m_covarImage.get(line, column, i) *= weight;
+
+			for (int32_t channelIndex = 0; channelIndex < 3; ++channelIndex)
+				ScaleHistogram(line, column, channelIndex, weight);
+		}
+	}
+}
+
+// The accumulator mutex must be already locked
+void SamplesAccumulator::ComputeSampleStatistics(bcd::SamplesStatisticsImages &io_sampleStats,
+		int i_line, int i_column) const {
+	const int width = io_sampleStats.m_nbOfSamplesImage.getWidth();
+	const int height = io_sampleStats.m_nbOfSamplesImage.getHeight();
+
+#pragma omp parallel for
+	for (int line = 0; line < height; ++line) {
 		float mean[3];
 		float cov[6];
 
-		for (int column = 0; column < m_width; ++column) {
+		for (int column = 0; column < width; ++column) {
 			float weightSum = io_sampleStats.m_nbOfSamplesImage.get(line, column, 0);
-			float squaredWeightSum = m_squaredWeightSumsImage.get(line, column, 0);
+			float squaredWeightSum = m_squaredWeightSumsImage.get(i_line + line, i_column + column, 0);
 
 			float invWeightSum = 1.f / weightSum;
 
@@ -270,14 +575,60 @@ void SamplesAccumulator::ComputeSampleStatistics(bcd::SamplesStatisticsImages &i
 	}
 }
 
+bcd::SamplesStatisticsImages SamplesAccumulator::GetSamplesStatistics(
+		int i_line, int i_column, int i_width, int i_height) const {
+	Flush();
+
+	boost::unique_lock<boost::mutex> lock(m_accumulatorMutex);
+
+	const int nbOfBins = m_histogramParameters.m_nbOfBins;
+	bcd::SamplesStatisticsImages stats(i_width, i_height, nbOfBins);
+
+#pragma omp parallel for
+	for (int line = 0; line < i_height; ++line) {
+		for (int column = 0; column < i_width; ++column) {
+			const int srcLine = i_line + line;
+			const int srcColumn = i_column + column;
+
+			stats.m_nbOfSamplesImage.set(line, column, 0,
+					m_samplesStatisticsImages.m_nbOfSamplesImage.get(srcLine, srcColumn, 0));
+			for (int i = 0; i < 3; ++i)
+				stats.m_meanImage.set(line, column, i,
+						m_samplesStatisticsImages.m_meanImage.get(srcLine, srcColumn, i));
+			for (int i = 0; i < 6; ++i)
+				stats.m_covarImage.set(line, column, i,
+						m_samplesStatisticsImages.m_covarImage.get(srcLine, srcColumn, i));
+
+			// The bins of a pixel are stored contiguously
+			for (int channelIndex = 0; channelIndex < 3; ++channelIndex)
+				GetHistogram(srcLine, srcColumn, channelIndex,
+						&stats.m_histoImage.get(line, column, channelIndex * nbOfBins));
+		}
+	}
+
+	ComputeSampleStatistics(stats, i_line, i_column);
+
+	return stats;
+}
+
 bcd::SamplesStatisticsImages SamplesAccumulator::GetSamplesStatistics() const {
-	bcd::SamplesStatisticsImages stats(m_samplesStatisticsImages);
-	ComputeSampleStatistics(stats);
-	return move(stats);
+	return GetSamplesStatistics(0, 0, m_width, m_height);
 }
 
 bcd::SamplesStatisticsImages SamplesAccumulator::ExtractSamplesStatistics() {
-	ComputeSampleStatistics(m_samplesStatisticsImages);
+	if (m_compactHistogram) {
+		bcd::SamplesStatisticsImages stats = GetSamplesStatistics();
+		m_isValid = false;
+
+		return stats;
+	}
+
+	Flush();
+
+	boost::unique_lock<boost::mutex> lock(m_accumulatorMutex);
+	ComputeSampleStatistics(m_samplesStatisticsImages, 0, 0);
+	m_isValid = false;
+
 	return move(m_samplesStatisticsImages);
 }
 
@@ -286,17 +637,27 @@ bcd::SamplesStatisticsImages SamplesAccumulator::ExtractSamplesStatistics() {
 //------------------------------------------------------------------------------
 
 template<class Archive> void SamplesAccumulator::save(Archive &ar, const unsigned int version) const {
+	Flush();
+
 	ar & m_width;
 	ar & m_height;
 
 	ar & m_histogramParameters.m_gamma;
 	ar & m_histogramParameters.m_maxValue;
 	ar & m_histogramParameters.m_nbOfBins;
+
+	ar & m_compactHistogram;
 	
 	ar & boost::serialization::make_array<const float>(m_samplesStatisticsImages.m_covarImage.getDataPtr(),
 			m_samplesStatisticsImages.m_covarImage.getSize());
-	ar & boost::serialization::make_array<const float>(m_samplesStatisticsImages.m_histoImage.getDataPtr(),
-			m_samplesStatisticsImages.m_histoImage.getSize());
+	if (m_compactHistogram) {
+		ar & boost::serialization::make_array<const u_short>(&m_compactHistoBins[0],
+				m_compactHistoBins.size());
+		ar & boost::serialization::make_array<const float>(&m_compactHistoScales[0],
+				m_compactHistoScales.size());
+	} else
+		ar & boost::serialization::make_array<const float>(m_samplesStatisticsImages.m_histoImage.getDataPtr(),
+				m_samplesStatisticsImages.m_histoImage.getSize());
 	ar & boost::serialization::make_array<const float>(m_samplesStatisticsImages.m_meanImage.getDataPtr(),
 			m_samplesStatisticsImages.m_meanImage.getSize());
 	ar & boost::serialization::make_array<const float>(m_samplesStatisticsImages.m_nbOfSamplesImage.getDataPtr(),
@@ -315,14 +676,30 @@ template<class Archive>	void SamplesAccumulator::load(Archive &ar, const unsigne
 	ar & m_histogramParameters.m_gamma;
 	ar & m_histogramParameters.m_maxValue;
 	ar & m_histogramParameters.m_nbOfBins;
+	if (m_histogramParameters.m_nbOfBins > SAMPLES_MAX_BINS_COUNT)
+		throw runtime_error("Too many histogram bins in SamplesAccumulator: " + ToString(m_histogramParameters.m_nbOfBins));
+
+	// Version 1 has only the float layout
+	if (version >= 2)
+		ar & m_compactHistogram;
+	else
+		m_compactHistogram = false;
 	
 	m_samplesStatisticsImages.m_covarImage.resize(m_width, m_height, 6);
 	ar & boost::serialization::make_array<float>(m_samplesStatisticsImages.m_covarImage.getDataPtr(),
 			m_samplesStatisticsImages.m_covarImage.getSize());
 
-	m_samplesStatisticsImages.m_histoImage.resize(m_width, m_height, 3 * m_histogramParameters.m_nbOfBins);
-	ar & boost::serialization::make_array<float>(m_samplesStatisticsImages.m_histoImage.getDataPtr(),
-			m_samplesStatisticsImages.m_histoImage.getSize());
+	if (m_compactHistogram) {
+		AllocCompactHistogram();
+		ar & boost::serialization::make_array<u_short>(&m_compactHistoBins[0],
+				m_compactHistoBins.size());
+		ar & boost::serialization::make_array<float>(&m_compactHistoScales[0],
+				m_compactHistoScales.size());
+	} else {
+		m_samplesStatisticsImages.m_histoImage.resize(m_width, m_height, 3 * m_histogramParameters.m_nbOfBins);
+		ar & boost::serialization::make_array<float>(m_samplesStatisticsImages.m_histoImage.getDataPtr(),
+				m_samplesStatisticsImages.m_histoImage.getSize());
+	}
 
 	m_samplesStatisticsImages.m_meanImage.resize(m_width, m_height, 3);
 	ar & boost::serialization::make_array<float>(m_samplesStatisticsImages.m_meanImage.getDataPtr(),
@@ -86,6 +86,7 @@ Film::Film() : filmDenoiser(this) {
 
 	convTest = nullptr;
 	noiseEstimation = nullptr;
+	noiseChannelVersion = 0;
 	haltTime = 0.0;
 	haltSPP = 0;
 	haltSPP_PixelNormalized = 0;
@@ -158,6 +159,7 @@ Film::Film(const u_int w, const u_int h, const u_int *sr) : filmDenoiser(this) {
 
 	convTest = nullptr;
 	noiseEstimation = nullptr;
+	noiseChannelVersion = 0;
 	haltTime = 0.0;
 
 	haltSPP = 0;
@@ -573,6 +575,7 @@ void Film::Resize(const u_int w, const u_int h) {
 	if (HasChannel(NOISE)) {
 		channel_NOISE = new GenericFrameBuffer<1, 0, float>(width, height);
 		channel_NOISE->Clear(numeric_limits<float>::infinity());
+		++noiseChannelVersion;
 		hasDataChannel = true;
 	}
 	if (HasChannel(USER_IMPORTANCE)) {
@@ -707,7 +710,8 @@ template <bool overwrite>
 void Film::AddFilmImpl(const Film &film,
 		const u_int srcOffsetX, const u_int srcOffsetY,
 		const u_int srcWidth, const u_int srcHeight,
-		const u_int dstOffsetX, const u_int dstOffsetY) {
+		const u_int dstOffsetX, const u_int dstOffsetY,
+		const float weight, const bool parallel) {
 	const double additional_SampleCount = film.samplesCounts.GetSampleCount();
 	double additional_RADIANCE_PER_PIXEL_NORMALIZED_SampleCount = 0;
 	double additional_RADIANCE_PER_SCREEN_NORMALIZED_SampleCount = 0;
@@ -716,15 +720,8 @@ void Film::AddFilmImpl(const Film &film,
 		additional_RADIANCE_PER_PIXEL_NORMALIZED_SampleCount = film.samplesCounts.GetSampleCount_RADIANCE_PER_PIXEL_NORMALIZED();
 
 		for (u_int i = 0; i < Min(radianceGroupCount, film.radianceGroupCount); ++i) {
-			for (u_int y = 0; y < srcHeight; ++y) {
-				for (u_int x = 0; x < srcWidth; ++x) {
-					const float *srcPixel = film.channel_RADIANCE_PER_PIXEL_NORMALIZEDs[i]->GetPixel(srcOffsetX + x, srcOffsetY + y);
-					if (overwrite)
-						channel_RADIANCE_PER_PIXEL_NORMALIZEDs[i]->SetPixel(dstOffsetX + x, dstOffsetY + y, srcPixel);
-					else
-						channel_RADIANCE_PER_PIXEL_NORMALIZEDs[i]->AddPixel(dstOffsetX + x, dstOffsetY + y, srcPixel);
-				}
-			}
+			channel_RADIANCE_PER_PIXEL_NORMALIZEDs[i]->AddFrameBuffer<overwrite>(*film.channel_RADIANCE_PER_PIXEL_NORMALIZEDs[i],
+					srcOffsetX, srcOffsetY, srcWidth, srcHeight, dstOffsetX, dstOffsetY, weight, parallel);
 		}
 	}
 
@@ -732,32 +729,18 @@ void Film::AddFilmImpl(const Film &film,
 		additional_RADIANCE_PER_SCREEN_NORMALIZED_SampleCount = film.samplesCounts.GetSampleCount_RADIANCE_PER_SCREEN_NORMALIZED();
 
 		for (u_int i = 0; i < Min(radianceGroupCount, film.radianceGroupCount); ++i) {
-			for (u_int y = 0; y < srcHeight; ++y) {
-				for (u_int x = 0; x < srcWidth; ++x) {
-					const float *srcPixel = film.channel_RADIANCE_PER_SCREEN_NORMALIZEDs[i]->GetPixel(srcOffsetX + x, srcOffsetY + y);
-					if (overwrite)
-						channel_RADIANCE_PER_SCREEN_NORMALIZEDs[i]->SetPixel(dstOffsetX + x, dstOffsetY + y, srcPixel);
-					else
-						channel_RADIANCE_PER_SCREEN_NORMALIZEDs[i]->AddPixel(dstOffsetX + x, dstOffsetY + y, srcPixel);
-				}
-			}
+			channel_RADIANCE_PER_SCREEN_NORMALIZEDs[i]->AddFrameBuffer<overwrite>(*film.channel_RADIANCE_PER_SCREEN_NORMALIZEDs[i],
+					srcOffsetX, srcOffsetY, srcWidth, srcHeight, dstOffsetX, dstOffsetY, weight, parallel);
 		}
 	}
 
-	samplesCounts.AddSampleCount(additional_SampleCount,
-			additional_RADIANCE_PER_PIXEL_NORMALIZED_SampleCount,
-			additional_RADIANCE_PER_SCREEN_NORMALIZED_SampleCount);
+	samplesCounts.AddSampleCount(additional_SampleCount * weight,
+			additional_RADIANCE_PER_PIXEL_NORMALIZED_SampleCount * weight,
+			additional_RADIANCE_PER_SCREEN_NORMALIZED_SampleCount * weight);
 
 	if (HasChannel(ALPHA) && film.HasChannel(ALPHA)) {
-		for (u_int y = 0; y < srcHeight; ++y) {
-			for (u_int x = 0; x < srcWidth; ++x) {
-				const float *srcPixel = film.channel_ALPHA->GetPixel(srcOffsetX + x, srcOffsetY + y);
-				if (overwrite)
-					channel_ALPHA->SetPixel(dstOffsetX + x, dstOffsetY + y, srcPixel);
-				else
-					channel_ALPHA->AddPixel(dstOffsetX + x, dstOffsetY + y, srcPixel);
-			}
-		}
+		channel_ALPHA->AddFrameBuffer<overwrite>(*film.channel_ALPHA,
+				srcOffsetX, srcOffsetY, srcWidth, srcHeight, dstOffsetX, dstOffsetY, weight, parallel);
 	}
 
 	if (HasChannel(POSITION) && film.HasChannel(POSITION)) {
@@ -845,233 +828,103 @@ void Film::AddFilmImpl(const Film &film,
 	}
 
 	if (HasChannel(DIRECT_DIFFUSE) && film.HasChannel(DIRECT_DIFFUSE)) {
-		for (u_int y = 0; y < srcHeight; ++y) {
-			for (u_int x = 0; x < srcWidth; ++x) {
-				const float *srcPixel = film.channel_DIRECT_DIFFUSE->GetPixel(srcOffsetX + x, srcOffsetY + y);
-				if (overwrite)
-					channel_DIRECT_DIFFUSE->SetPixel(dstOffsetX + x, dstOffsetY + y, srcPixel);
-				else
-					channel_DIRECT_DIFFUSE->AddPixel(dstOffsetX + x, dstOffsetY + y, srcPixel);
-			}
-		}
+		channel_DIRECT_DIFFUSE->AddFrameBuffer<overwrite>(*film.channel_DIRECT_DIFFUSE,
+				srcOffsetX, srcOffsetY, srcWidth, srcHeight, dstOffsetX, dstOffsetY, weight, parallel);
 	}
 	if (HasChannel(DIRECT_DIFFUSE_REFLECT) && film.HasChannel(DIRECT_DIFFUSE_REFLECT)) {
-		for (u_int y = 0; y < srcHeight; ++y) {
-			for (u_int x = 0; x < srcWidth; ++x) {
-				const float *srcPixel = film.channel_DIRECT_DIFFUSE_REFLECT->GetPixel(srcOffsetX + x, srcOffsetY + y);
-				if (overwrite)
-					channel_DIRECT_DIFFUSE_REFLECT->SetPixel(dstOffsetX + x, dstOffsetY + y, srcPixel);
-				else
-					channel_DIRECT_DIFFUSE_REFLECT->AddPixel(dstOffsetX + x, dstOffsetY + y, srcPixel);
-			}
-		}
+		channel_DIRECT_DIFFUSE_REFLECT->AddFrameBuffer<overwrite>(*film.channel_DIRECT_DIFFUSE_REFLECT,
+				srcOffsetX, srcOffsetY, srcWidth, srcHeight, dstOffsetX, dstOffsetY, weight, parallel);
 	}
 
 	if (HasChannel(DIRECT_DIFFUSE_TRANSMIT) && film.HasChannel(DIRECT_DIFFUSE_TRANSMIT)) {
-		for (u_int y = 0; y < srcHeight; ++y) {
-			for (u_int x = 0; x < srcWidth; ++x) {
-				const float *srcPixel = film.channel_DIRECT_DIFFUSE_TRANSMIT->GetPixel(srcOffsetX + x, srcOffsetY + y);
-				if (overwrite)
-					channel_DIRECT_DIFFUSE_TRANSMIT->SetPixel(dstOffsetX + x, dstOffsetY + y, srcPixel);
-				else
-					channel_DIRECT_DIFFUSE_TRANSMIT->AddPixel(dstOffsetX + x, dstOffsetY + y, srcPixel);
-			}
-		}
+		channel_DIRECT_DIFFUSE_TRANSMIT->AddFrameBuffer<overwrite>(*film.channel_DIRECT_DIFFUSE_TRANSMIT,
+				srcOffsetX, srcOffsetY, srcWidth, srcHeight, dstOffsetX, dstOffsetY, weight, parallel);
 	}
 
 	if (HasChannel(DIRECT_GLOSSY) && film.HasChannel(DIRECT_GLOSSY)) {
-		for (u_int y = 0; y < srcHeight; ++y) {
-			for (u_int x = 0; x < srcWidth; ++x) {
-				const float *srcPixel = film.channel_DIRECT_GLOSSY->GetPixel(srcOffsetX + x, srcOffsetY + y);
-				if (overwrite)
-					channel_DIRECT_GLOSSY->SetPixel(dstOffsetX + x, dstOffsetY + y, srcPixel);
-				else
-					channel_DIRECT_GLOSSY->AddPixel(dstOffsetX + x, dstOffsetY + y, srcPixel);
-			}
-		}
+		channel_DIRECT_GLOSSY->AddFrameBuffer<overwrite>(*film.channel_DIRECT_GLOSSY,
+				srcOffsetX, srcOffsetY, srcWidth, srcHeight, dstOffsetX, dstOffsetY, weight, parallel);
 	}
 
 	if (HasChannel(DIRECT_GLOSSY_REFLECT) && film.HasChannel(DIRECT_GLOSSY_REFLECT)) {
-		for (u_int y = 0; y < srcHeight; ++y) {
-			for (u_int x = 0; x < srcWidth; ++x) {
-				const float *srcPixel = film.channel_DIRECT_GLOSSY_REFLECT->GetPixel(srcOffsetX + x, srcOffsetY + y);
-				if (overwrite)
-					channel_DIRECT_GLOSSY_REFLECT->SetPixel(dstOffsetX + x, dstOffsetY + y, srcPixel);
-				else
-					channel_DIRECT_GLOSSY_REFLECT->AddPixel(dstOffsetX + x, dstOffsetY + y, srcPixel);
-			}
-		}
+		channel_DIRECT_GLOSSY_REFLECT->AddFrameBuffer<overwrite>(*film.channel_DIRECT_GLOSSY_REFLECT,
+				srcOffsetX, srcOffsetY, srcWidth, srcHeight, dstOffsetX, dstOffsetY, weight, parallel);
 	}
 
 	if (HasChannel(DIRECT_GLOSSY_TRANSMIT) && film.HasChannel(DIRECT_GLOSSY_TRANSMIT)) {
-		for (u_int y = 0; y < srcHeight; ++y) {
-			for (u_int x = 0; x < srcWidth; ++x) {
-				const float *srcPixel = film.channel_DIRECT_GLOSSY_TRANSMIT->GetPixel(srcOffsetX + x, srcOffsetY + y);
-				if (overwrite)
-					channel_DIRECT_GLOSSY_TRANSMIT->SetPixel(dstOffsetX + x, dstOffsetY + y, srcPixel);
-				else
-					channel_DIRECT_GLOSSY_TRANSMIT->AddPixel(dstOffsetX + x, dstOffsetY + y, srcPixel);
-			}
-		}
+		channel_DIRECT_GLOSSY_TRANSMIT->AddFrameBuffer<overwrite>(*film.channel_DIRECT_GLOSSY_TRANSMIT,
+				srcOffsetX, srcOffsetY, srcWidth, srcHeight, dstOffsetX, dstOffsetY, weight, parallel);
 	}
 
 	if (HasChannel(EMISSION) && film.HasChannel(EMISSION)) {
-		for (u_int y = 0; y < srcHeight; ++y) {
-			for (u_int x = 0; x < srcWidth; ++x) {
-				const float *srcPixel = film.channel_EMISSION->GetPixel(srcOffsetX + x, srcOffsetY + y);
-				if (overwrite)
-					channel_EMISSION->SetPixel(dstOffsetX + x, dstOffsetY + y, srcPixel);
-				else
-					channel_EMISSION->AddPixel(dstOffsetX + x, dstOffsetY + y, srcPixel);
-			}
-		}
+		channel_EMISSION->AddFrameBuffer<overwrite>(*film.channel_EMISSION,
+				srcOffsetX, srcOffsetY, srcWidth, srcHeight, dstOffsetX, dstOffsetY, weight, parallel);
 	}
 
 	if (HasChannel(INDIRECT_DIFFUSE) && film.HasChannel(INDIRECT_DIFFUSE)) {
-		for (u_int y = 0; y < srcHeight; ++y) {
-			for (u_int x = 0; x < srcWidth; ++x) {
-				const float *srcPixel = film.channel_INDIRECT_DIFFUSE->GetPixel(srcOffsetX + x, srcOffsetY + y);
-				if (overwrite)
-					channel_INDIRECT_DIFFUSE->SetPixel(dstOffsetX + x, dstOffsetY + y, srcPixel);
-				else
-					channel_INDIRECT_DIFFUSE->AddPixel(dstOffsetX + x, dstOffsetY + y, srcPixel);
-			}
-		}
+		channel_INDIRECT_DIFFUSE->AddFrameBuffer<overwrite>(*film.channel_INDIRECT_DIFFUSE,
+				srcOffsetX, srcOffsetY, srcWidth, srcHeight, dstOffsetX, dstOffsetY, weight, parallel);
 	}
 
 	if (HasChannel(INDIRECT_DIFFUSE_REFLECT) && film.HasChannel(INDIRECT_DIFFUSE_REFLECT)) {
-		for (u_int y = 0; y < srcHeight; ++y) {
-			for (u_int x = 0; x < srcWidth; ++x) {
-				const float *srcPixel = film.channel_INDIRECT_DIFFUSE_REFLECT->GetPixel(srcOffsetX + x, srcOffsetY + y);
-				if (overwrite)
-					channel_INDIRECT_DIFFUSE_REFLECT->SetPixel(dstOffsetX + x, dstOffsetY + y, srcPixel);
-				else
-					channel_INDIRECT_DIFFUSE_REFLECT->AddPixel(dstOffsetX + x, dstOffsetY + y, srcPixel);
-			}
-		}
+		channel_INDIRECT_DIFFUSE_REFLECT->AddFrameBuffer<overwrite>(*film.channel_INDIRECT_DIFFUSE_REFLECT,
+				srcOffsetX, srcOffsetY, srcWidth, srcHeight, dstOffsetX, dstOffsetY, weight, parallel);
 	}
 
 	if (HasChannel(INDIRECT_DIFFUSE_TRANSMIT) && film.HasChannel(INDIRECT_DIFFUSE_TRANSMIT)) {
-		for (u_int y = 0; y < srcHeight; ++y) {
-			for (u_int x = 0; x < srcWidth; ++x) {
-				const float *srcPixel = film.channel_INDIRECT_DIFFUSE_TRANSMIT->GetPixel(srcOffsetX + x, srcOffsetY + y);
-				if (overwrite)
-					channel_INDIRECT_DIFFUSE_TRANSMIT->SetPixel(dstOffsetX + x, dstOffsetY + y, srcPixel);
-				else
-					channel_INDIRECT_DIFFUSE_TRANSMIT->AddPixel(dstOffsetX + x, dstOffsetY + y, srcPixel);
-			}
-		}
+		channel_INDIRECT_DIFFUSE_TRANSMIT->AddFrameBuffer<overwrite>(*film.channel_INDIRECT_DIFFUSE_TRANSMIT,
+				srcOffsetX, srcOffsetY, srcWidth, srcHeight, dstOffsetX, dstOffsetY, weight, parallel);
 	}
 
 	if (HasChannel(INDIRECT_GLOSSY) && film.HasChannel(INDIRECT_GLOSSY)) {
-		for (u_int y = 0; y < srcHeight; ++y) {
-			for (u_int x = 0; x < srcWidth; ++x) {
-				const float *srcPixel = film.channel_INDIRECT_GLOSSY->GetPixel(srcOffsetX + x, srcOffsetY + y);
-				if (overwrite)
-					channel_INDIRECT_GLOSSY->SetPixel(dstOffsetX + x, dstOffsetY + y, srcPixel);
-				else
-					channel_INDIRECT_GLOSSY->AddPixel(dstOffsetX + x, dstOffsetY + y, srcPixel);
-			}
-		}
+		channel_INDIRECT_GLOSSY->AddFrameBuffer<overwrite>(*film.channel_INDIRECT_GLOSSY,
+				srcOffsetX, srcOffsetY, srcWidth, srcHeight, dstOffsetX, dstOffsetY, weight, parallel);
 	}
 
 	if (HasChannel(INDIRECT_GLOSSY_REFLECT) && film.HasChannel(INDIRECT_GLOSSY_REFLECT)) {
-		for (u_int y = 0; y < srcHeight; ++y) {
-			for (u_int x = 0; x < srcWidth; ++x) {
-				const float *srcPixel = film.channel_INDIRECT_GLOSSY_REFLECT->GetPixel(srcOffsetX + x, srcOffsetY + y);
-				if (overwrite)
-					channel_INDIRECT_GLOSSY_REFLECT->SetPixel(dstOffsetX + x, dstOffsetY + y, srcPixel);
-				else
-					channel_INDIRECT_GLOSSY_REFLECT->AddPixel(dstOffsetX + x, dstOffsetY + y, srcPixel);
-			}
-		}
+		channel_INDIRECT_GLOSSY_REFLECT->AddFrameBuffer<overwrite>(*film.channel_INDIRECT_GLOSSY_REFLECT,
+				srcOffsetX, srcOffsetY, srcWidth, srcHeight, dstOffsetX, dstOffsetY, weight, parallel);
 	}
 
 	if (HasChannel(INDIRECT_GLOSSY_TRANSMIT) && film.HasChannel(INDIRECT_GLOSSY_TRANSMIT)) {
-		for (u_int y = 0; y < srcHeight; ++y) {
-			for (u_int x = 0; x < srcWidth; ++x) {
-				const float *srcPixel = film.channel_INDIRECT_GLOSSY_TRANSMIT->GetPixel(srcOffsetX + x, srcOffsetY + y);
-				if (overwrite)
-					channel_INDIRECT_GLOSSY_TRANSMIT->SetPixel(dstOffsetX + x, dstOffsetY + y, srcPixel);
-				else
-					channel_INDIRECT_GLOSSY_TRANSMIT->AddPixel(dstOffsetX + x, dstOffsetY + y, srcPixel);
-			}
-		}
+		channel_INDIRECT_GLOSSY_TRANSMIT->AddFrameBuffer<overwrite>(*film.channel_INDIRECT_GLOSSY_TRANSMIT,
+				srcOffsetX, srcOffsetY, srcWidth, srcHeight, dstOffsetX, dstOffsetY, weight, parallel);
 	}
 
 	if (HasChannel(INDIRECT_SPECULAR) && film.HasChannel(INDIRECT_SPECULAR)) {
-		for (u_int y = 0; y < srcHeight; ++y) {
-			for (u_int x = 0; x < srcWidth; ++x) {
-				const float *srcPixel = film.channel_INDIRECT_SPECULAR->GetPixel(srcOffsetX + x, srcOffsetY + y);
-				if (overwrite)
-					channel_INDIRECT_SPECULAR->SetPixel(dstOffsetX + x, dstOffsetY + y, srcPixel);
-				else
-					channel_INDIRECT_SPECULAR->AddPixel(dstOffsetX + x, dstOffsetY + y, srcPixel);
-			}
-		}
+		channel_INDIRECT_SPECULAR->AddFrameBuffer<overwrite>(*film.channel_INDIRECT_SPECULAR,
+				srcOffsetX, srcOffsetY, srcWidth, srcHeight, dstOffsetX, dstOffsetY, weight, parallel);
 	}
 
 	if (HasChannel(INDIRECT_SPECULAR_REFLECT) && film.HasChannel(INDIRECT_SPECULAR_REFLECT)) {
-		for (u_int y = 0; y < srcHeight; ++y) {
-			for (u_int x = 0; x < srcWidth; ++x) {
-				const float *srcPixel = film.channel_INDIRECT_SPECULAR_REFLECT->GetPixel(srcOffsetX + x, srcOffsetY + y);
-				if (overwrite)
-					channel_INDIRECT_SPECULAR_REFLECT->SetPixel(dstOffsetX + x, dstOffsetY + y, srcPixel);
-				else
-					channel_INDIRECT_SPECULAR_REFLECT->AddPixel(dstOffsetX + x, dstOffsetY + y, srcPixel);
-			}
-		}
+		channel_INDIRECT_SPECULAR_REFLECT->AddFrameBuffer<overwrite>(*film.channel_INDIRECT_SPECULAR_REFLECT,
+				srcOffsetX, srcOffsetY, srcWidth, srcHeight, dstOffsetX, dstOffsetY, weight, parallel);
 	}
 
 	if (HasChannel(INDIRECT_SPECULAR_TRANSMIT) && film.HasChannel(INDIRECT_SPECULAR_TRANSMIT)) {
-		for (u_int y = 0; y < srcHeight; ++y) {
-			for (u_int x = 0; x < srcWidth; ++x) {
-				const float *srcPixel = film.channel_INDIRECT_SPECULAR_TRANSMIT->GetPixel(srcOffsetX + x, srcOffsetY + y);
-				if (overwrite)
-					channel_INDIRECT_SPECULAR_TRANSMIT->SetPixel(dstOffsetX + x, dstOffsetY + y, srcPixel);
-				else
-					channel_INDIRECT_SPECULAR_TRANSMIT->AddPixel(dstOffsetX + x, dstOffsetY + y, srcPixel);
-			}
-		}
+		channel_INDIRECT_SPECULAR_TRANSMIT->AddFrameBuffer<overwrite>(*film.channel_INDIRECT_SPECULAR_TRANSMIT,
+				srcOffsetX, srcOffsetY, srcWidth, srcHeight, dstOffsetX, dstOffsetY, weight, parallel);
 	}
 
 	if (HasChannel(MATERIAL_ID_MASK) && film.HasChannel(MATERIAL_ID_MASK)) {
 		for (u_int i = 0; i < channel_MATERIAL_ID_MASKs.size(); ++i) {
 			for (u_int j = 0; j < film.maskMaterialIDs.size(); ++j) {
 				if (maskMaterialIDs[i] == film.maskMaterialIDs[j]) {
-					for (u_int y = 0; y < srcHeight; ++y) {
-						for (u_int x = 0; x < srcWidth; ++x) {
-							const float *srcPixel = film.channel_MATERIAL_ID_MASKs[j]->GetPixel(srcOffsetX + x, srcOffsetY + y);
-							if (overwrite)
-								channel_MATERIAL_ID_MASKs[i]->SetPixel(dstOffsetX + x, dstOffsetY + y, srcPixel);
-							else
-								channel_MATERIAL_ID_MASKs[i]->AddPixel(dstOffsetX + x, dstOffsetY + y, srcPixel);
-						}
-					}
+					channel_MATERIAL_ID_MASKs[i]->AddFrameBuffer<overwrite>(*film.channel_MATERIAL_ID_MASKs[j],
+							srcOffsetX, srcOffsetY, srcWidth, srcHeight, dstOffsetX, dstOffsetY, weight, parallel);
 				}
 			}
 		}
 	}
 
 	if (HasChannel(DIRECT_SHADOW_MASK) && film.HasChannel(DIRECT_SHADOW_MASK)) {
-		for (u_int y = 0; y < srcHeight; ++y) {
-			for (u_int x = 0; x < srcWidth; ++x) {
-				const float *srcPixel = film.channel_DIRECT_SHADOW_MASK->GetPixel(srcOffsetX + x, srcOffsetY + y);
-				if (overwrite)
-					channel_DIRECT_SHADOW_MASK->SetPixel(dstOffsetX + x, dstOffsetY + y, srcPixel);
-				else
-					channel_DIRECT_SHADOW_MASK->AddPixel(dstOffsetX + x, dstOffsetY + y, srcPixel);
-			}
-		}
+		channel_DIRECT_SHADOW_MASK->AddFrameBuffer<overwrite>(*film.channel_DIRECT_SHADOW_MASK,
+				srcOffsetX, srcOffsetY, srcWidth, srcHeight, dstOffsetX, dstOffsetY, weight, parallel);
 	}
 
 	if (HasChannel(INDIRECT_SHADOW_MASK) && film.HasChannel(INDIRECT_SHADOW_MASK)) {
-		for (u_int y = 0; y < srcHeight; ++y) {
-			for (u_int x = 0; x < srcWidth; ++x) {
-				const float *srcPixel = film.channel_INDIRECT_SHADOW_MASK->GetPixel(srcOffsetX + x, srcOffsetY + y);
-				channel_INDIRECT_SHADOW_MASK->AddPixel(dstOffsetX + x, dstOffsetY + y, srcPixel);
-			}
-		}
+		channel_INDIRECT_SHADOW_MASK->AddFrameBuffer<false>(*film.channel_INDIRECT_SHADOW_MASK,
+				srcOffsetX, srcOffsetY, srcWidth, srcHeight, dstOffsetX, dstOffsetY, weight, parallel);
 	}
 
 	if (HasChannel(UV) && film.HasChannel(UV)) {
@@ -1096,45 +949,24 @@ void Film::AddFilmImpl(const Film &film,
 	}
 
 	if (HasChannel(RAYCOUNT) && film.HasChannel(RAYCOUNT)) {
-		for (u_int y = 0; y < srcHeight; ++y) {
-			for (u_int x = 0; x < srcWidth; ++x) {
-				const float *srcPixel = film.channel_RAYCOUNT->GetPixel(srcOffsetX + x, srcOffsetY + y);
-				if (overwrite)
-					channel_RAYCOUNT->SetPixel(dstOffsetX + x, dstOffsetY + y, srcPixel);
-				else
-					channel_RAYCOUNT->AddPixel(dstOffsetX + x, dstOffsetY + y, srcPixel);
-			}
-		}
+		channel_RAYCOUNT->AddFrameBuffer<overwrite>(*film.channel_RAYCOUNT,
+				srcOffsetX, srcOffsetY, srcWidth, srcHeight, dstOffsetX, dstOffsetY, weight, parallel);
 	}
 
 	if (HasChannel(BY_MATERIAL_ID) && film.HasChannel(BY_MATERIAL_ID)) {
 		for (u_int i = 0; i < channel_BY_MATERIAL_IDs.size(); ++i) {
 			for (u_int j = 0; j < film.byMaterialIDs.size(); ++j) {
 				if (byMaterialIDs[i] == film.byMaterialIDs[j]) {
-					for (u_int y = 0; y < srcHeight; ++y) {
-						for (u_int x = 0; x < srcWidth; ++x) {
-							const float *srcPixel = film.channel_BY_MATERIAL_IDs[j]->GetPixel(srcOffsetX + x, srcOffsetY + y);
-							if (overwrite)
-								channel_BY_MATERIAL_IDs[i]->SetPixel(dstOffsetX + x, dstOffsetY + y, srcPixel);
-							else
-								channel_BY_MATERIAL_IDs[i]->AddPixel(dstOffsetX + x, dstOffsetY + y, srcPixel);
-						}
-					}
+					channel_BY_MATERIAL_IDs[i]->AddFrameBuffer<overwrite>(*film.channel_BY_MATERIAL_IDs[j],
+							srcOffsetX, srcOffsetY, srcWidth, srcHeight, dstOffsetX, dstOffsetY, weight, parallel);
 				}
 			}
 		}
 	}
 
 	if (HasChannel(IRRADIANCE) && film.HasChannel(IRRADIANCE)) {
-		for (u_int y = 0; y < srcHeight; ++y) {
-			for (u_int x = 0; x < srcWidth; ++x) {
-				const float *srcPixel = film.channel_IRRADIANCE->GetPixel(srcOffsetX + x, srcOffsetY + y);
-				if (overwrite)
-					channel_IRRADIANCE->SetPixel(dstOffsetX + x, dstOffsetY + y, srcPixel);
-				else
-					channel_IRRADIANCE->AddPixel(dstOffsetX + x, dstOffsetY + y, srcPixel);
-			}
-		}
+		channel_IRRADIANCE->AddFrameBuffer<overwrite>(*film.channel_IRRADIANCE,
+				srcOffsetX, srcOffsetY, srcWidth, srcHeight, dstOffsetX, dstOffsetY, weight, parallel);
 	}
 
 	if (HasChannel(OBJECT_ID) && film.HasChannel(OBJECT_ID)) {
@@ -1162,15 +994,8 @@ void Film::AddFilmImpl(const Film &film,
 		for (u_int i = 0; i < channel_OBJECT_ID_MASKs.size(); ++i) {
 			for (u_int j = 0; j < film.maskObjectIDs.size(); ++j) {
 				if (maskObjectIDs[i] == film.maskObjectIDs[j]) {
-					for (u_int y = 0; y < srcHeight; ++y) {
-						for (u_int x = 0; x < srcWidth; ++x) {
-							const float *srcPixel = film.channel_OBJECT_ID_MASKs[j]->GetPixel(srcOffsetX + x, srcOffsetY + y);
-							if (overwrite)
-								channel_OBJECT_ID_MASKs[i]->SetPixel(dstOffsetX + x, dstOffsetY + y, srcPixel);
-							else
-								channel_OBJECT_ID_MASKs[i]->AddPixel(dstOffsetX + x, dstOffsetY + y, srcPixel);
-						}
-					}
+					channel_OBJECT_ID_MASKs[i]->AddFrameBuffer<overwrite>(*film.channel_OBJECT_ID_MASKs[j],
+							srcOffsetX, srcOffsetY, srcWidth, srcHeight, dstOffsetX, dstOffsetY, weight, parallel);
 				}
 			}
 		}
@@ -1180,69 +1005,34 @@ void Film::AddFilmImpl(const Film &film,
 		for (u_int i = 0; i < channel_BY_OBJECT_IDs.size(); ++i) {
 			for (u_int j = 0; j < film.byObjectIDs.size(); ++j) {
 				if (byObjectIDs[i] == film.byObjectIDs[j]) {
-					for (u_int y = 0; y < srcHeight; ++y) {
-						for (u_int x = 0; x < srcWidth; ++x) {
-							const float *srcPixel = film.channel_BY_OBJECT_IDs[j]->GetPixel(srcOffsetX + x, srcOffsetY + y);
-							if (overwrite)
-								channel_BY_OBJECT_IDs[i]->SetPixel(dstOffsetX + x, dstOffsetY + y, srcPixel);
-							else
-								channel_BY_OBJECT_IDs[i]->AddPixel(dstOffsetX + x, dstOffsetY + y, srcPixel);
-						}
-					}
+					channel_BY_OBJECT_IDs[i]->AddFrameBuffer<overwrite>(*film.channel_BY_OBJECT_IDs[j],
+							srcOffsetX, srcOffsetY, srcWidth, srcHeight, dstOffsetX, dstOffsetY, weight, parallel);
 				}
 			}
 		}
 	}
 
 	if (HasChannel(SAMPLECOUNT) && film.HasChannel(SAMPLECOUNT)) {
-		for (u_int y = 0; y < srcHeight; ++y) {
-			for (u_int x = 0; x < srcWidth; ++x) {
-				const u_int *srcPixel = film.channel_SAMPLECOUNT->GetPixel(srcOffsetX + x, srcOffsetY + y);
-				if (overwrite)
-					channel_SAMPLECOUNT->SetPixel(dstOffsetX + x, dstOffsetY + y, srcPixel);
-				else
-					channel_SAMPLECOUNT->AddPixel(dstOffsetX + x, dstOffsetY + y, srcPixel);
-			}
-		}
+		channel_SAMPLECOUNT->AddFrameBuffer<overwrite>(*film.channel_SAMPLECOUNT,
+				srcOffsetX, srcOffsetY, srcWidth, srcHeight, dstOffsetX, dstOffsetY, 1.f, parallel);
 	}
 
 	// CONVERGENCE values can not really be added, they will be updated at the next test
 
 	if (HasChannel(MATERIAL_ID_COLOR) && film.HasChannel(MATERIAL_ID_COLOR)) {
-		for (u_int y = 0; y < srcHeight; ++y) {
-			for (u_int x = 0; x < srcWidth; ++x) {
-				const float *srcPixel = film.channel_MATERIAL_ID_COLOR->GetPixel(srcOffsetX + x, srcOffsetY + y);
-				if (overwrite)
-					channel_MATERIAL_ID_COLOR->SetPixel(dstOffsetX + x, dstOffsetY + y, srcPixel);
-				else
-					channel_MATERIAL_ID_COLOR->AddPixel(dstOffsetX + x, dstOffsetY + y, srcPixel);
-			}
-		}
+		channel_MATERIAL_ID_COLOR->AddFrameBuffer<overwrite>(*film.channel_MATERIAL_ID_COLOR,
+				srcOffsetX, srcOffsetY, srcWidth, srcHeight, dstOffsetX, dstOffsetY, weight, parallel);
 	}
 
 	if (HasChannel(ALBEDO) && film.HasChannel(ALBEDO)) {
-		for (u_int y = 0; y < srcHeight; ++y) {
-			for (u_int x = 0; x < srcWidth; ++x) {
-				const float *srcPixel = film.channel_ALBEDO->GetPixel(srcOffsetX + x, srcOffsetY + y);
-				if (overwrite)
-					channel_ALBEDO->SetPixel(dstOffsetX + x, dstOffsetY + y, srcPixel);
-				else
-					channel_ALBEDO->AddPixel(dstOffsetX + x, dstOffsetY + y, srcPixel);
-			}
-		}
+		channel_ALBEDO->AddFrameBuffer<overwrite>(*film.channel_ALBEDO,
+				srcOffsetX, srcOffsetY, srcWidth, srcHeight, dstOffsetX, dstOffsetY, weight, parallel);
 	}
 
 
 	if (HasChannel(AVG_SHADING_NORMAL) && film.HasChannel(AVG_SHADING_NORMAL)) {
-		for (u_int y = 0; y < srcHeight; ++y) {
-			for (u_int x = 0; x < srcWidth; ++x) {
-				const float *srcPixel = film.channel_AVG_SHADING_NORMAL->GetPixel(srcOffsetX + x, srcOffsetY + y);
-				if (overwrite)
-					channel_AVG_SHADING_NORMAL->SetPixel(dstOffsetX + x, dstOffsetY + y, srcPixel);
-				else
-					channel_AVG_SHADING_NORMAL->AddPixel(dstOffsetX + x, dstOffsetY + y, srcPixel);
-			}
-		}
+		channel_AVG_SHADING_NORMAL->AddFrameBuffer<overwrite>(*film.channel_AVG_SHADING_NORMAL,
+				srcOffsetX, srcOffsetY, srcWidth, srcHeight, dstOffsetX, dstOffsetY, weight, parallel);
 	}
 
 	// NOTE: update DEPTH channel last because it is used to merge other channels
@@ -1266,6 +1056,7 @@ void Film::AddFilmImpl(const Film &film,
 					channel_NOISE->SetPixel(dstOffsetX + x, dstOffsetY + y, srcPixel);
 				}
 			}
+			++noiseChannelVersion;
 		}
 	} else {
 		// NOISE values can not really be added, they will be updated at the next test
@@ -1297,7 +1088,7 @@ void Film::AddFilmImpl(const Film &film,
 		filmDenoiser.AddDenoiser(film.GetDenoiser(),
 				srcOffsetX, srcOffsetY,
 				srcWidth, srcHeight,
-				dstOffsetX, dstOffsetY);
+				dstOffsetX, dstOffsetY, weight);
 
 		// Check if the BCD denoiser warm up period is over
 		if (!filmDenoiser.IsWarmUpDone())
@@ -1310,22 +1101,25 @@ void Film::SetFilm(const Film &film,
 	const u_int srcWidth, const u_int srcHeight,
 	const u_int dstOffsetX, const u_int dstOffsetY) {
 	AddFilmImpl<true>(film, srcOffsetX, srcOffsetY,
-			srcWidth, srcHeight, dstOffsetX, dstOffsetY);
+			srcWidth, srcHeight, dstOffsetX, dstOffsetY, 1.f, false);
 }
 
 void Film::AddFilm(const Film &film,
 	const u_int srcOffsetX, const u_int srcOffsetY,
 	const u_int srcWidth, const u_int srcHeight,
-	const u_int dstOffsetX, const u_int dstOffsetY) {
+	const u_int dstOffsetX, const u_int dstOffsetY,
+	const float weight, const bool parallel) {
 	AddFilmImpl<false>(film, srcOffsetX, srcOffsetY,
-			srcWidth, srcHeight, dstOffsetX, dstOffsetY);
+			srcWidth, srcHeight, dstOffsetX, dstOffsetY, weight, parallel);
 }
 
 void Film::ResetTests() {
 	if (convTest)
 		convTest->Reset();
-	if (noiseEstimation)
+	if (noiseEstimation) {
 		noiseEstimation->Reset();
+		++noiseChannelVersion;
+	}
 }
 
 void Film::RunTests() {
@@ -1409,5 +1203,6 @@ void Film::RunTests() {
 		ExecuteImagePipeline(noiseEstimationImagePipelineIndex);
 		// Run the noise estimation test
 		noiseEstimation->Test();
+		++noiseChannelVersion;
 	}
 }
@@ -27,6 +27,7 @@
 #include "slg/film/sampleresult.h"
 #include "slg/utils/varianceclamping.h"
 #include "slg/film/denoiser/filmdenoiser.h"
+#include "slg/utils/profiler.h"
 
 using namespace std;
 using namespace luxrays;
@@ -249,6 +250,8 @@ void Film::AddSampleResultData(const u_int x, const u_int y,
 
 void Film::AddSample(const u_int x, const u_int y,
 		const SampleResult &sampleResult, const float weight) {
+	SLG_PROFILE(PROFILER_FILM_ADD_SAMPLE);
+
 	AddSampleResultColor(x, y, sampleResult, weight);
 	if (hasDataChannel)
 		AddSampleResultData(x, y, sampleResult);
@@ -220,6 +220,132 @@ u_int Film::GetChannelCount(const FilmChannelType type) const {
 	}
 }
 
+namespace {
+
+template<u_int CHANNELS, u_int WEIGHT_CHANNELS, class T> void *GetFrameBufferPixels(
+		GenericFrameBuffer<CHANNELS, WEIGHT_CHANNELS, T> *&buf, const u_int index,
+		const u_int width, const u_int height, size_t &size, const bool alloc) {
+	if ((index > 0) || (!buf && !alloc))
+		return nullptr;
+
+	if (!buf)
+		buf = new GenericFrameBuffer<CHANNELS, WEIGHT_CHANNELS, T>(width, height);
+
+	size = buf->GetSize();
+	return buf->GetPixels();
+}
+
+template<u_int CHANNELS, u_int WEIGHT_CHANNELS, class T> void *GetFrameBufferPixels(
+		vector<GenericFrameBuffer<CHANNELS, WEIGHT_CHANNELS, T> *> &bufs, const u_int index,
+		const u_int width, const u_int height, size_t &size, const bool alloc) {
+	if (index >= bufs.size()) {
+		if (!alloc)
+			return nullptr;
+		bufs.resize(index + 1, nullptr);
+	}
+
+	return GetFrameBufferPixels(bufs[index], 0, width, height, size, alloc);
+}
+
+}
+
+void *Film::GetChannelBufferPixels(const FilmChannelType type, const u_int index,
+		size_t &size, const bool alloc) {
+	switch (type) {
+		case RADIANCE_PER_PIXEL_NORMALIZED:
+			return GetFrameBufferPixels(channel_RADIANCE_PER_PIXEL_NORMALIZEDs, index, width, height, size, alloc);
+		case RADIANCE_PER_SCREEN_NORMALIZED:
+			return GetFrameBufferPixels(channel_RADIANCE_PER_SCREEN_NORMALIZEDs, index, width, height, size, alloc);
+		case ALPHA:
+			return GetFrameBufferPixels(channel_ALPHA, index, width, height, size, alloc);
+		case IMAGEPIPELINE:
+			return GetFrameBufferPixels(channel_IMAGEPIPELINEs, index, width, height, size, alloc);
+		case DEPTH:
+			return GetFrameBufferPixels(channel_DEPTH, index, width, height, size, alloc);
+		case POSITION:
+			return GetFrameBufferPixels(channel_POSITION, index, width, height, size, alloc);
+		case GEOMETRY_NORMAL:
+			return GetFrameBufferPixels(channel_GEOMETRY_NORMAL, index, width, height, size, alloc);
+		case SHADING_NORMAL:
+			return GetFrameBufferPixels(channel_SHADING_NORMAL, index, width, height, size, alloc);
+		case MATERIAL_ID:
+			return GetFrameBufferPixels(channel_MATERIAL_ID, index, width, height, size, alloc);
+		case DIRECT_DIFFUSE:
+			return GetFrameBufferPixels(channel_DIRECT_DIFFUSE, index, width, height, size, alloc);
+		case DIRECT_DIFFUSE_REFLECT:
+			return GetFrameBufferPixels(channel_DIRECT_DIFFUSE_REFLECT, index, width, height, size, alloc);
+		case DIRECT_DIFFUSE_TRANSMIT:
+			return GetFrameBufferPixels(channel_DIRECT_DIFFUSE_TRANSMIT, index, width, height, size, alloc);
+		case DIRECT_GLOSSY:
+			return GetFrameBufferPixels(channel_DIRECT_GLOSSY, index, width, height, size, alloc);
+		case DIRECT_GLOSSY_REFLECT:
+			return GetFrameBufferPixels(channel_DIRECT_GLOSSY_REFLECT, index, width, height, size, alloc);
+		case DIRECT_GLOSSY_TRANSMIT:
+			return GetFrameBufferPixels(channel_DIRECT_GLOSSY_TRANSMIT, index, width, height, size, alloc);
+		case EMISSION:
+			return GetFrameBufferPixels(channel_EMISSION, index, width, height, size, alloc);
+		case INDIRECT_DIFFUSE:
+			return GetFrameBufferPixels(channel_INDIRECT_DIFFUSE, index, width, height, size, alloc);
+		case INDIRECT_DIFFUSE_REFLECT:
+			return GetFrameBufferPixels(channel_INDIRECT_DIFFUSE_REFLECT, index, width, height, size, alloc);
+		case INDIRECT_DIFFUSE_TRANSMIT:
+			return GetFrameBufferPixels(channel_INDIRECT_DIFFUSE_TRANSMIT, index, width, height, size, alloc);
+		case INDIRECT_GLOSSY:
+			return GetFrameBufferPixels(channel_INDIRECT_GLOSSY, index, width, height, size, alloc);
+		case INDIRECT_GLOSSY_REFLECT:
+			return GetFrameBufferPixels(channel_INDIRECT_GLOSSY_REFLECT, index, width, height, size, alloc);
+		case INDIRECT_GLOSSY_TRANSMIT:
+			return GetFrameBufferPixels(channel_INDIRECT_GLOSSY_TRANSMIT, index, width, height, size, alloc);
+		case INDIRECT_SPECULAR:
+			return GetFrameBufferPixels(channel_INDIRECT_SPECULAR, index, width, height, size, alloc);
+		case INDIRECT_SPECULAR_REFLECT:
+			return GetFrameBufferPixels(channel_INDIRECT_SPECULAR_REFLECT, index, width, height, size, alloc);
+		case INDIRECT_SPECULAR_TRANSMIT:
+			return GetFrameBufferPixels(channel_INDIRECT_SPECULAR_TRANSMIT, index, width, height, size, alloc);
+		case MATERIAL_ID_MASK:
+			return GetFrameBufferPixels(channel_MATERIAL_ID_MASKs, index, width, height, size, alloc);
+		case DIRECT_SHADOW_MASK:
+			return GetFrameBufferPixels(channel_DIRECT_SHADOW_MASK, index, width, height, size, alloc);
+		case INDIRECT_SHADOW_MASK:
+			return GetFrameBufferPixels(channel_INDIRECT_SHADOW_MASK, index, width, height, size, alloc);
+		case UV:
+			return GetFrameBufferPixels(channel_UV, index, width, height, size, alloc);
+		case RAYCOUNT:
+			return GetFrameBufferPixels(channel_RAYCOUNT, index, width, height, size, alloc);
+		case BY_MATERIAL_ID:
+			return GetFrameBufferPixels(channel_BY_MATERIAL_IDs, index, width, height, size, alloc);
+		case IRRADIANCE:
+			return GetFrameBufferPixels(channel_IRRADIANCE, index, width, height, size, alloc);
+		case OBJECT_ID:
+			return GetFrameBufferPixels(channel_OBJECT_ID, index, width, height, size, alloc);
+		case OBJECT_ID_MASK:
+			return GetFrameBufferPixels(channel_OBJECT_ID_MASKs, index, width, height, size, alloc);
+		case BY_OBJECT_ID:
+			return GetFrameBufferPixels(channel_BY_OBJECT_IDs, index, width, height, size, alloc);
+		case SAMPLECOUNT:
+			return GetFrameBufferPixels(channel_SAMPLECOUNT, index, width, height, size, alloc);
+		case CONVERGENCE:
+			return GetFrameBufferPixels(channel_CONVERGENCE, index, width, height, size, alloc);
+		case MATERIAL_ID_COLOR:
+			return GetFrameBufferPixels(channel_MATERIAL_ID_COLOR, index, width, height, size, alloc);
+		case ALBEDO:
+			return GetFrameBufferPixels(channel_ALBEDO, index, width, height, size, alloc);
+		case AVG_SHADING_NORMAL:
+			return GetFrameBufferPixels(channel_AVG_SHADING_NORMAL, index, width, height, size, alloc);
+		case NOISE:
+			return GetFrameBufferPixels(channel_NOISE, index, width, height, size, alloc);
+		case USER_IMPORTANCE:
+			return GetFrameBufferPixels(channel_USER_IMPORTANCE, index, width, height, size, alloc);
+		default:
+			throw runtime_error("Unknown FilmChannelType in Film::GetChannelBufferPixels(): " + ToString(type));
+	}
+}
+
+const void *Film::GetChannelBufferPixels(const FilmChannelType type, const u_int index,
+		size_t &size) const {
+	return const_cast<Film *>(this)->GetChannelBufferPixels(type, index, size, false);
+}
+
 template<> float *Film::GetChannel<float>(const FilmChannelType type,
 		const u_int index, const bool executeImagePipeline) {
 	if (!HasChannel(type))
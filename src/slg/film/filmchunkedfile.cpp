@@ -0,0 +1,441 @@
+/***************************************************************************
+ * Copyright 1998-2020 by authors (see AUTHORS.txt)                        *
+ *                                                                         *
+ *   This file is part of LuxCoreRender.                                   *
+ *                                                                         *
+ * Licensed under the Apache License, Version 2.0 (the "License");         *
+ * you may not use this file except in compliance with the License.        *
+ * You may obtain a copy of the License at                                 *
+ *                                                                         *
+ *     http://www.apache.org/licenses/LICENSE-2.0                          *
+ *                                                                         *
+ * Unless required by applicable law or agreed to in writing, software     *
+ * distributed under the License is distributed on an "AS IS" BASIS,       *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.*
+ * See the License for the specific language governing permissions and     *
+ * limitations under the License.                                          *
+ ***************************************************************************/
+
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
+
+#include <cstring>
+#include <limits>
+#include <memory>
+
+#include <boost/atomic.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+#include <boost/iostreams/filter/zlib.hpp>
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+
+#include "luxrays/utils/serializationutils.h"
+#include "slg/film/filmchunkedfile.h"
+
+using namespace std;
+using namespace luxrays;
+using namespace slg;
+
+// Increment this number every time the container layout changes
+#define FILMCHUNKEDFILE_FORMAT_VERSION 1u
+// The size of a compressed block of pixels
+#define FILMCHUNKEDFILE_BLOCK_SIZE (1u << 20)
+// The same compression level used by SerializationOutputFile
+#define FILMCHUNKEDFILE_COMPRESSION_LEVEL 4
+
+namespace {
+
+static const char FILMCHUNKEDFILE_MAGIC[8] = { 'L', 'X', 'C', 'F', 'L', 'M', 'C', '\0' };
+
+//------------------------------------------------------------------------------
+// The on-disk header. It is followed by the compressed film parameters, by all
+// the channel blocks and, at the end of the file, by the channel directory
+//------------------------------------------------------------------------------
+
+struct FilmChunkedFileHeader {
+	char magic[8];
+	u_int version;
+	u_int width, height;
+	u_int channelCount, blockCount;
+	u_int pad;
+	u_longlong metadataOffset, metadataSize;
+	u_longlong directoryOffset;
+};
+
+void CompressBlock(const char *src, const size_t size, vector<char> &dst) {
+	dst.clear();
+
+	boost::iostreams::filtering_ostream outStream;
+	outStream.push(boost::iostreams::zlib_compressor(FILMCHUNKEDFILE_COMPRESSION_LEVEL));
+	outStream.push(boost::iostreams::back_inserter(dst));
+
+	outStream.write(src, size);
+	if (!outStream.good())
+		throw runtime_error("Error while compressing a film block");
+
+	// Flush and close the compressor
+	outStream.reset();
+}
+
+void DecompressBlock(const char *src, const size_t storedSize, char *dst, const size_t size) {
+	boost::iostreams::filtering_istream inStream;
+	inStream.push(boost::iostreams::zlib_decompressor());
+	inStream.push(boost::iostreams::array_source(src, storedSize));
+
+	inStream.read(dst, size);
+	if (inStream.gcount() != (streamsize)size)
+		throw runtime_error("Error while decompressing a film block");
+}
+
+}
+
+//------------------------------------------------------------------------------
+// FilmChunkedFile
+//------------------------------------------------------------------------------
+
+FilmChunkedFile::FilmChunkedFile(const string &fName) : fileName(fName) {
+	file.open(fileName);
+
+	const char *data = file.data();
+	const size_t fileSize = file.size();
+	if (fileSize < sizeof(FilmChunkedFileHeader))
+		throw runtime_error("Serialized film file too short: " + fileName);
+
+	FilmChunkedFileHeader header;
+	memcpy(&header, data, sizeof(FilmChunkedFileHeader));
+	if (memcmp(header.magic, FILMCHUNKEDFILE_MAGIC, sizeof(FILMCHUNKEDFILE_MAGIC)))
+		throw runtime_error("Not a chunked serialized film file: " + fileName);
+	if (header.version != FILMCHUNKEDFILE_FORMAT_VERSION)
+		throw runtime_error("Unsupported chunked serialized film version " +
+				ToString(header.version) + ": " + fileName);
+
+	filmWidth = header.width;
+	filmHeight = header.height;
+	metadataOffset = header.metadataOffset;
+	metadataSize = header.metadataSize;
+
+	// Read the channel directory
+	const u_longlong directorySize = header.channelCount * sizeof(ChannelInfo) +
+			header.blockCount * sizeof(BlockInfo);
+	if ((metadataOffset + metadataSize > fileSize) ||
+			(header.directoryOffset + directorySize > fileSize))
+		throw runtime_error("Corrupted chunked serialized film file: " + fileName);
+
+	channelInfos.resize(header.channelCount);
+	blockInfos.resize(header.blockCount);
+	const char *directory = data + header.directoryOffset;
+	if (header.channelCount > 0)
+		memcpy(&channelInfos[0], directory, header.channelCount * sizeof(ChannelInfo));
+	if (header.blockCount > 0)
+		memcpy(&blockInfos[0], directory + header.channelCount * sizeof(ChannelInfo),
+				header.blockCount * sizeof(BlockInfo));
+
+	// Validate the directory
+	for (auto const &ci : channelInfos) {
+		if (ci.firstBlock + ci.blockCount > blockInfos.size())
+			throw runtime_error("Corrupted chunked serialized film directory: " + fileName);
+	}
+	for (auto const &bi : blockInfos) {
+		if (bi.offset + bi.storedSize > fileSize)
+			throw runtime_error("Corrupted chunked serialized film block: " + fileName);
+	}
+}
+
+FilmChunkedFile::~FilmChunkedFile() {
+}
+
+bool FilmChunkedFile::IsChunkedFile(const string &fileName) {
+	boost::filesystem::ifstream inFile(boost::filesystem::path(fileName),
+			boost::filesystem::ifstream::binary);
+	if (!inFile.is_open())
+		return false;
+
+	char magic[sizeof(FILMCHUNKEDFILE_MAGIC)];
+	inFile.read(magic, sizeof(FILMCHUNKEDFILE_MAGIC));
+
+	return (inFile.gcount() == sizeof(FILMCHUNKEDFILE_MAGIC)) &&
+			!memcmp(magic, FILMCHUNKEDFILE_MAGIC, sizeof(FILMCHUNKEDFILE_MAGIC));
+}
+
+const FilmChunkedFile::ChannelInfo *FilmChunkedFile::GetChannelInfo(const Film::FilmChannelType type,
+		const u_int index) const {
+	for (auto const &ci : channelInfos) {
+		if ((ci.type == (u_int)type) && (ci.index == index))
+			return &ci;
+	}
+
+	return nullptr;
+}
+
+bool FilmChunkedFile::HasChannelBuffer(const Film::FilmChannelType type, const u_int index) const {
+	return GetChannelInfo(type, index) != nullptr;
+}
+
+size_t FilmChunkedFile::GetChannelBufferSize(const Film::FilmChannelType type, const u_int index) const {
+	const ChannelInfo *ci = GetChannelInfo(type, index);
+	if (!ci)
+		throw runtime_error("Unknown channel " + Film::FilmChannelType2String(type) + "/" +
+				ToString(index) + " in serialized film: " + fileName);
+
+	return ci->size;
+}
+
+void FilmChunkedFile::ReadChannelBuffer(const Film::FilmChannelType type, const u_int index,
+		void *pixels, const size_t size) const {
+	const ChannelInfo *ci = GetChannelInfo(type, index);
+	if (!ci)
+		throw runtime_error("Unknown channel " + Film::FilmChannelType2String(type) + "/" +
+				ToString(index) + " in serialized film: " + fileName);
+	if (ci->size != size)
+		throw runtime_error("Wrong buffer size for channel " + Film::FilmChannelType2String(type) + "/" +
+				ToString(index) + " in serialized film: " + fileName);
+
+	const char *data = file.data();
+	char *dst = (char *)pixels;
+
+	// Blocks are decompressed in parallel
+	boost::atomic<bool> error(false);
+	#pragma omp parallel for
+	for (
+			// Visual C++ 2013 supports only OpenMP 2.5
+#if _OPENMP >= 200805
+			unsigned
+#endif
+			int i = 0; i < ci->blockCount; ++i) {
+		const BlockInfo &bi = blockInfos[ci->firstBlock + i];
+		const size_t blockOffset = i * (size_t)FILMCHUNKEDFILE_BLOCK_SIZE;
+		if (blockOffset + bi.size > size) {
+			error = true;
+			continue;
+		}
+
+		if (bi.compressed) {
+			try {
+				DecompressBlock(data + bi.offset, bi.storedSize, dst + blockOffset, bi.size);
+			} catch (...) {
+				error = true;
+			}
+		} else
+			memcpy(dst + blockOffset, data + bi.offset, bi.size);
+	}
+
+	if (error)
+		throw runtime_error("Error while reading channel " + Film::FilmChannelType2String(type) + "/" +
+				ToString(index) + " in serialized film: " + fileName);
+}
+
+u_int FilmChunkedFile::GetChannelBlockCount(const Film::FilmChannelType type, const u_int index) const {
+	const ChannelInfo *ci = GetChannelInfo(type, index);
+
+	return ci ? ci->blockCount : 0;
+}
+
+size_t FilmChunkedFile::ReadChannelBlock(const Film::FilmChannelType type, const u_int index,
+		const u_int block, vector<char> &buffer) const {
+	const ChannelInfo *ci = GetChannelInfo(type, index);
+	if (!ci || (block >= ci->blockCount))
+		throw runtime_error("Unknown block " + ToString(block) + " of channel " + Film::FilmChannelType2String(type) + "/" +
+				ToString(index) + " in serialized film: " + fileName);
+
+	const BlockInfo &bi = blockInfos[ci->firstBlock + block];
+	buffer.resize(bi.size);
+
+	const char *data = file.data();
+	if (bi.compressed)
+		DecompressBlock(data + bi.offset, bi.storedSize, &buffer[0], bi.size);
+	else
+		memcpy(&buffer[0], data + bi.offset, bi.size);
+
+	return block * (size_t)FILMCHUNKEDFILE_BLOCK_SIZE;
+}
+
+Film *FilmChunkedFile::LoadFilm(const Film::FilmChannels *channelsFilter) const {
+	// Load the film parameters
+	Film *film;
+	{
+		boost::iostreams::filtering_istream inStream;
+		inStream.push(boost::iostreams::zlib_decompressor());
+		inStream.push(boost::iostreams::array_source(file.data() + metadataOffset, metadataSize));
+
+		Film::serializeChannelsData = false;
+		try {
+			LuxInputArchive inArchive(inStream);
+			inArchive >> film;
+		} catch (...) {
+			Film::serializeChannelsData = true;
+			throw;
+		}
+		Film::serializeChannelsData = true;
+
+		if (!inStream.good())
+			throw runtime_error("Error while loading serialized film parameters: " + fileName);
+	}
+
+	unique_ptr<Film> filmPtr(film);
+
+	// Remove the channels I'm not going to load
+	if (channelsFilter) {
+		const Film::FilmChannels allChannels = film->channels;
+		for (auto const type : allChannels) {
+			if (!channelsFilter->count(type))
+				film->channels.erase(type);
+		}
+	}
+
+	// Load the channels
+	for (auto const &ci : channelInfos) {
+		const Film::FilmChannelType type = (Film::FilmChannelType)ci.type;
+		if (!film->HasChannel(type))
+			continue;
+
+		size_t size;
+		void *pixels = film->GetChannelBufferPixels(type, ci.index, size, true);
+		ReadChannelBuffer(type, ci.index, pixels, size);
+	}
+
+	return filmPtr.release();
+}
+
+void FilmChunkedFile::Save(const string &fileName, const Film &film) {
+	// I can not really serialize the film while a pipeline is running
+	if (film.isAsyncImagePipelineRunning)
+		throw runtime_error("It is not possible to serialize a Film while an AsyncExecuteImagePipeline() is still running");
+
+	boost::filesystem::ofstream outFile;
+	outFile.exceptions(boost::filesystem::ofstream::failbit |
+			boost::filesystem::ofstream::badbit |
+			boost::filesystem::ofstream::eofbit);
+	// The use of boost::filesystem::path is required for UNICODE support: fileName
+	// is supposed to be UTF-8 encoded.
+	outFile.open(boost::filesystem::path(fileName),
+			boost::filesystem::ofstream::binary | boost::filesystem::ofstream::trunc);
+
+	FilmChunkedFileHeader header;
+	memset(&header, 0, sizeof(FilmChunkedFileHeader));
+	memcpy(header.magic, FILMCHUNKEDFILE_MAGIC, sizeof(FILMCHUNKEDFILE_MAGIC));
+	header.version = FILMCHUNKEDFILE_FORMAT_VERSION;
+	header.width = film.width;
+	header.height = film.height;
+
+	// The header is written again at the end
+	outFile.write((const char *)&header, sizeof(FilmChunkedFileHeader));
+
+	// Save the film parameters
+	{
+		vector<char> metadata;
+		{
+			boost::iostreams::filtering_ostream outStream;
+			outStream.push(boost::iostreams::zlib_compressor(FILMCHUNKEDFILE_COMPRESSION_LEVEL));
+			outStream.push(boost::iostreams::back_inserter(metadata));
+
+			const Film *filmPtr = &film;
+			Film::serializeChannelsData = false;
+			try {
+				LuxOutputArchive outArchive(outStream);
+				outArchive << filmPtr;
+			} catch (...) {
+				Film::serializeChannelsData = true;
+				throw;
+			}
+			Film::serializeChannelsData = true;
+
+			if (!outStream.good())
+				throw runtime_error("Error while saving serialized film parameters: " + fileName);
+			outStream.reset();
+		}
+
+		header.metadataOffset = sizeof(FilmChunkedFileHeader);
+		header.metadataSize = metadata.size();
+		outFile.write(&metadata[0], metadata.size());
+	}
+
+	// Save all channels, one at time to limit the memory usage
+	vector<ChannelInfo> channelInfos;
+	vector<BlockInfo> blockInfos;
+	u_longlong offset = header.metadataOffset + header.metadataSize;
+	for (auto const type : film.channels) {
+		for (u_int index = 0;; ++index) {
+			size_t size;
+			const char *pixels = (const char *)film.GetChannelBufferPixels(type, index, size);
+			if (!pixels)
+				break;
+
+			ChannelInfo ci;
+			ci.type = type;
+			ci.index = index;
+			ci.size = size;
+			ci.firstBlock = blockInfos.size();
+			ci.blockCount = (size + FILMCHUNKEDFILE_BLOCK_SIZE - 1) / FILMCHUNKEDFILE_BLOCK_SIZE;
+			channelInfos.push_back(ci);
+
+			// Compress all blocks in parallel
+			vector<vector<char> > blocks(ci.blockCount);
+			boost::atomic<bool> error(false);
+			#pragma omp parallel for
+			for (
+					// Visual C++ 2013 supports only OpenMP 2.5
+#if _OPENMP >= 200805
+					unsigned
+#endif
+					int i = 0; i < ci.blockCount; ++i) {
+				const size_t blockOffset = i * (size_t)FILMCHUNKEDFILE_BLOCK_SIZE;
+				const size_t blockSize = Min<size_t>(FILMCHUNKEDFILE_BLOCK_SIZE, size - blockOffset);
+
+				try {
+					CompressBlock(pixels + blockOffset, blockSize, blocks[i]);
+				} catch (...) {
+					error = true;
+				}
+			}
+			if (error)
+				throw runtime_error("Error while compressing channel " + Film::FilmChannelType2String(type) +
+						"/" + ToString(index) + " of serialized film: " + fileName);
+
+			// Write the blocks
+			for (u_int i = 0; i < ci.blockCount; ++i) {
+				const size_t blockOffset = i * (size_t)FILMCHUNKEDFILE_BLOCK_SIZE;
+
+				BlockInfo bi;
+				bi.offset = offset;
+				bi.size = Min<size_t>(FILMCHUNKEDFILE_BLOCK_SIZE, size - blockOffset);
+				bi.pad = 0;
+
+				// Store the block uncompressed if it is not worth it
+				if (blocks[i].size() < bi.size) {
+					bi.storedSize = blocks[i].size();
+					bi.compressed = 1;
+					outFile.write(&blocks[i][0], bi.storedSize);
+				} else {
+					bi.storedSize = bi.size;
+					bi.compressed = 0;
+					outFile.write(pixels + blockOffset, bi.storedSize);
+				}
+
+				offset += bi.storedSize;
+				blockInfos.push_back(bi);
+			}
+		}
+	}
+
+	// Write the directory
+	header.channelCount = channelInfos.size();
+	header.blockCount = blockInfos.size();
+	header.directoryOffset = offset;
+	if (channelInfos.size() > 0)
+		outFile.write((const char *)&channelInfos[0], channelInfos.size() * sizeof(ChannelInfo));
+	if (blockInfos.size() > 0)
+		outFile.write((const char *)&blockInfos[0], blockInfos.size() * sizeof(BlockInfo));
+
+	const u_longlong fileSize = offset + channelInfos.size() * sizeof(ChannelInfo) +
+			blockInfos.size() * sizeof(BlockInfo);
+
+	// Update the header
+	outFile.seekp(0);
+	outFile.write((const char *)&header, sizeof(FilmChunkedFileHeader));
+	outFile.close();
+
+	SLG_LOG("Film saved: " << (fileSize / 1024) << " Kbytes");
+}
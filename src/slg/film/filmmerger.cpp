@@ -0,0 +1,378 @@
+/***************************************************************************
+ * Copyright 1998-2020 by authors (see AUTHORS.txt)                        *
+ *                                                                         *
+ *   This file is part of LuxCoreRender.                                   *
+ *                                                                         *
+ * Licensed under the Apache License, Version 2.0 (the "License");         *
+ * you may not use this file except in compliance with the License.        *
+ * You may obtain a copy of the License at                                 *
+ *                                                                         *
+ *     http://www.apache.org/licenses/LICENSE-2.0                          *
+ *                                                                         *
+ * Unless required by applicable law or agreed to in writing, software     *
+ * distributed under the License is distributed on an "AS IS" BASIS,       *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.*
+ * See the License for the specific language governing permissions and     *
+ * limitations under the License.                                          *
+ ***************************************************************************/
+
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
+
+#include <memory>
+
+#include <boost/atomic.hpp>
+
+#include "slg/slg.h"
+#include "slg/film/filmmerger.h"
+#include "slg/film/filmchunkedfile.h"
+
+using namespace std;
+using namespace luxrays;
+using namespace slg;
+
+namespace {
+
+// The channels where the values of different films are simply added. The
+// radiance groups and the ID channels are handled apart.
+static const Film::FilmChannelType additiveChannels[] = {
+	Film::ALPHA,
+	Film::DIRECT_DIFFUSE,
+	Film::DIRECT_DIFFUSE_REFLECT,
+	Film::DIRECT_DIFFUSE_TRANSMIT,
+	Film::DIRECT_GLOSSY,
+	Film::DIRECT_GLOSSY_REFLECT,
+	Film::DIRECT_GLOSSY_TRANSMIT,
+	Film::EMISSION,
+	Film::INDIRECT_DIFFUSE,
+	Film::INDIRECT_DIFFUSE_REFLECT,
+	Film::INDIRECT_DIFFUSE_TRANSMIT,
+	Film::INDIRECT_GLOSSY,
+	Film::INDIRECT_GLOSSY_REFLECT,
+	Film::INDIRECT_GLOSSY_TRANSMIT,
+	Film::INDIRECT_SPECULAR,
+	Film::INDIRECT_SPECULAR_REFLECT,
+	Film::INDIRECT_SPECULAR_TRANSMIT,
+	Film::DIRECT_SHADOW_MASK,
+	Film::INDIRECT_SHADOW_MASK,
+	Film::RAYCOUNT,
+	Film::IRRADIANCE,
+	Film::MATERIAL_ID_COLOR,
+	Film::ALBEDO,
+	Film::AVG_SHADING_NORMAL
+};
+
+static const Film::FilmChannelType scaledChannels[] = {
+	Film::RADIANCE_PER_PIXEL_NORMALIZED,
+	Film::RADIANCE_PER_SCREEN_NORMALIZED,
+	Film::MATERIAL_ID_MASK,
+	Film::BY_MATERIAL_ID,
+	Film::OBJECT_ID_MASK,
+	Film::BY_OBJECT_ID
+};
+
+void MatchIDChannels(const vector<u_int> &dstIDs, const vector<u_int> &srcIDs,
+		vector<pair<u_int, u_int> > &indices) {
+	indices.clear();
+	for (u_int i = 0; i < dstIDs.size(); ++i) {
+		for (u_int j = 0; j < srcIDs.size(); ++j) {
+			if (dstIDs[i] == srcIDs[j])
+				indices.push_back(make_pair(i, j));
+		}
+	}
+}
+
+}
+
+//------------------------------------------------------------------------------
+// FilmMerger
+//------------------------------------------------------------------------------
+
+template<class T> void FilmMerger::AddChannel(Film &dstFilm, const FilmChunkedFile &srcFile,
+		const Film::FilmChannelType type, const u_int dstIndex, const u_int srcIndex,
+		const u_int srcOffsetX, const u_int srcOffsetY,
+		const u_int srcWidth, const u_int srcHeight,
+		const u_int dstOffsetX, const u_int dstOffsetY,
+		const float weight) {
+	if (!srcFile.HasChannelBuffer(type, srcIndex))
+		return;
+
+	size_t dstSize;
+	char *dstPixels = (char *)dstFilm.GetChannelBufferPixels(type, dstIndex, dstSize, false);
+	if (!dstPixels)
+		return;
+
+	const u_int srcFilmWidth = srcFile.GetWidth();
+	const u_int srcFilmHeight = srcFile.GetHeight();
+	const size_t srcSize = srcFile.GetChannelBufferSize(type, srcIndex);
+	const size_t pixelSize = srcSize / (srcFilmWidth * (size_t)srcFilmHeight);
+	if ((pixelSize != dstSize / (dstFilm.GetWidth() * (size_t)dstFilm.GetHeight())) ||
+			(pixelSize % sizeof(T) != 0))
+		throw runtime_error("Channel " + Film::FilmChannelType2String(type) + " has a different pixel layout in the film to merge");
+
+	if ((srcSize == dstSize) &&
+			(srcFilmWidth == dstFilm.GetWidth()) && (srcFilmHeight == dstFilm.GetHeight()) &&
+			(srcOffsetX == 0) && (srcOffsetY == 0) && (srcWidth == srcFilmWidth) && (srcHeight == srcFilmHeight) &&
+			(dstOffsetX == 0) && (dstOffsetY == 0)) {
+		// The whole channel has to be added: I can stream the compressed blocks
+		// and add each one as soon as it is decompressed
+		const u_int blockCount = srcFile.GetChannelBlockCount(type, srcIndex);
+
+		boost::atomic<bool> error(false);
+		#pragma omp parallel
+		{
+			vector<char> buffer;
+
+			#pragma omp for
+			for (
+					// Visual C++ 2013 supports only OpenMP 2.5
+#if _OPENMP >= 200805
+					unsigned
+#endif
+					int i = 0; i < blockCount; ++i) {
+				try {
+					const size_t offset = srcFile.ReadChannelBlock(type, srcIndex, i, buffer);
+					if (offset + buffer.size() > dstSize) {
+						error = true;
+						continue;
+					}
+
+					GenericFrameBuffer<1, 0, T>::AddValues((T *)(dstPixels + offset),
+							(const T *)&buffer[0], buffer.size() / sizeof(T), weight);
+				} catch (...) {
+					error = true;
+				}
+			}
+		}
+
+		if (error)
+			throw runtime_error("Error while merging channel " + Film::FilmChannelType2String(type) + "/" + ToString(srcIndex));
+	} else {
+		// Only a region has to be added, the channel is decompressed in a
+		// temporary buffer and added one row at time
+		vector<char> buffer(srcSize);
+		srcFile.ReadChannelBuffer(type, srcIndex, &buffer[0], srcSize);
+
+		const T *srcPixels = (const T *)&buffer[0];
+		T *dst = (T *)dstPixels;
+		const size_t pixelCount = pixelSize / sizeof(T);
+		const size_t rowCount = srcWidth * pixelCount;
+
+		#pragma omp parallel for
+		for (
+				// Visual C++ 2013 supports only OpenMP 2.5
+#if _OPENMP >= 200805
+				unsigned
+#endif
+				int y = 0; y < srcHeight; ++y) {
+			const T *srcRow = &srcPixels[((srcOffsetY + y) * (size_t)srcFilmWidth + srcOffsetX) * pixelCount];
+			T *dstRow = &dst[((dstOffsetY + y) * (size_t)dstFilm.GetWidth() + dstOffsetX) * pixelCount];
+
+			GenericFrameBuffer<1, 0, T>::AddValues(dstRow, srcRow, rowCount, weight);
+		}
+	}
+}
+
+void FilmMerger::AddChunkedFilm(Film &dstFilm, const FilmChunkedFile &srcFile,
+		const u_int srcOffsetX, const u_int srcOffsetY,
+		const u_int srcWidth, const u_int srcHeight,
+		const u_int dstOffsetX, const u_int dstOffsetY,
+		const float weight) {
+	if ((srcOffsetX + srcWidth > srcFile.GetWidth()) || (srcOffsetY + srcHeight > srcFile.GetHeight()) ||
+			(dstOffsetX + srcWidth > dstFilm.GetWidth()) || (dstOffsetY + srcHeight > dstFilm.GetHeight()))
+		throw runtime_error("Wrong region in FilmMerger::AddFilm()");
+
+	// Load the film parameters and only the channels that can not be simply
+	// added (they are merged using the DEPTH information)
+	Film::FilmChannels channelsFilter;
+	channelsFilter.insert(Film::DEPTH);
+	channelsFilter.insert(Film::POSITION);
+	channelsFilter.insert(Film::GEOMETRY_NORMAL);
+	channelsFilter.insert(Film::SHADING_NORMAL);
+	channelsFilter.insert(Film::MATERIAL_ID);
+	channelsFilter.insert(Film::UV);
+	channelsFilter.insert(Film::OBJECT_ID);
+	unique_ptr<Film> srcFilm(srcFile.LoadFilm(&channelsFilter));
+
+	// The sample counts depend on the channels available in the file
+	const double sampleCount = srcFilm->samplesCounts.GetSampleCount();
+	double RADIANCE_PER_PIXEL_NORMALIZED_SampleCount = 0.0;
+	double RADIANCE_PER_SCREEN_NORMALIZED_SampleCount = 0.0;
+	if (dstFilm.HasChannel(Film::RADIANCE_PER_PIXEL_NORMALIZED) && srcFile.HasChannelBuffer(Film::RADIANCE_PER_PIXEL_NORMALIZED, 0))
+		RADIANCE_PER_PIXEL_NORMALIZED_SampleCount = srcFilm->samplesCounts.GetSampleCount_RADIANCE_PER_PIXEL_NORMALIZED();
+	if (dstFilm.HasChannel(Film::RADIANCE_PER_SCREEN_NORMALIZED) && srcFile.HasChannelBuffer(Film::RADIANCE_PER_SCREEN_NORMALIZED, 0))
+		RADIANCE_PER_SCREEN_NORMALIZED_SampleCount = srcFilm->samplesCounts.GetSampleCount_RADIANCE_PER_SCREEN_NORMALIZED();
+	srcFilm->samplesCounts.Clear();
+
+	// Merge the non additive channels and the denoiser statistics
+	dstFilm.AddFilm(*srcFilm, srcOffsetX, srcOffsetY, srcWidth, srcHeight,
+			dstOffsetX, dstOffsetY, weight, true);
+
+	dstFilm.samplesCounts.AddSampleCount(sampleCount * weight,
+			RADIANCE_PER_PIXEL_NORMALIZED_SampleCount * weight,
+			RADIANCE_PER_SCREEN_NORMALIZED_SampleCount * weight);
+
+	// Stream all the additive channels
+	const u_int radianceGroupCount = Min(dstFilm.GetRadianceGroupCount(), srcFilm->GetRadianceGroupCount());
+	for (u_int i = 0; i < radianceGroupCount; ++i) {
+		AddChannel<float>(dstFilm, srcFile, Film::RADIANCE_PER_PIXEL_NORMALIZED, i, i,
+				srcOffsetX, srcOffsetY, srcWidth, srcHeight, dstOffsetX, dstOffsetY, weight);
+		AddChannel<float>(dstFilm, srcFile, Film::RADIANCE_PER_SCREEN_NORMALIZED, i, i,
+				srcOffsetX, srcOffsetY, srcWidth, srcHeight, dstOffsetX, dstOffsetY, weight);
+	}
+
+	for (auto const type : additiveChannels) {
+		AddChannel<float>(dstFilm, srcFile, type, 0, 0,
+				srcOffsetX, srcOffsetY, srcWidth, srcHeight, dstOffsetX, dstOffsetY, weight);
+	}
+
+	// The ID channels are matched by ID and not by index
+	vector<pair<u_int, u_int> > indices;
+	MatchIDChannels(dstFilm.maskMaterialIDs, srcFilm->maskMaterialIDs, indices);
+	for (auto const &idx : indices) {
+		AddChannel<float>(dstFilm, srcFile, Film::MATERIAL_ID_MASK, idx.first, idx.second,
+				srcOffsetX, srcOffsetY, srcWidth, srcHeight, dstOffsetX, dstOffsetY, weight);
+	}
+	MatchIDChannels(dstFilm.byMaterialIDs, srcFilm->byMaterialIDs, indices);
+	for (auto const &idx : indices) {
+		AddChannel<float>(dstFilm, srcFile, Film::BY_MATERIAL_ID, idx.first, idx.second,
+				srcOffsetX, srcOffsetY, srcWidth, srcHeight, dstOffsetX, dstOffsetY, weight);
+	}
+	MatchIDChannels(dstFilm.maskObjectIDs, srcFilm->maskObjectIDs, indices);
+	for (auto const &idx : indices) {
+		AddChannel<float>(dstFilm, srcFile, Film::OBJECT_ID_MASK, idx.first, idx.second,
+				srcOffsetX, srcOffsetY, srcWidth, srcHeight, dstOffsetX, dstOffsetY, weight);
+	}
+	MatchIDChannels(dstFilm.byObjectIDs, srcFilm->byObjectIDs, indices);
+	for (auto const &idx : indices) {
+		AddChannel<float>(dstFilm, srcFile, Film::BY_OBJECT_ID, idx.first, idx.second,
+				srcOffsetX, srcOffsetY, srcWidth, srcHeight, dstOffsetX, dstOffsetY, weight);
+	}
+
+	// The number of samples is never weighted
+	AddChannel<u_int>(dstFilm, srcFile, Film::SAMPLECOUNT, 0, 0,
+			srcOffsetX, srcOffsetY, srcWidth, srcHeight, dstOffsetX, dstOffsetY, 1.f);
+}
+
+bool FilmMerger::ClipRegion(const u_int srcFilmWidth, const u_int srcFilmHeight,
+		const u_int dstFilmWidth, const u_int dstFilmHeight,
+		const u_int srcOffsetX, const u_int srcOffsetY,
+		const u_int dstOffsetX, const u_int dstOffsetY,
+		u_int *srcWidth, u_int *srcHeight) {
+	// Check the cases where I have nothing to do
+	if ((srcOffsetX >= srcFilmWidth) || (srcOffsetY >= srcFilmHeight) ||
+			(dstOffsetX >= dstFilmWidth) || (dstOffsetY >= dstFilmHeight))
+		return false;
+
+	// Clip with the src film
+	*srcWidth = Min(srcOffsetX + *srcWidth, srcFilmWidth) - srcOffsetX;
+	// Clip with the dst film
+	*srcWidth = Min(dstOffsetX + *srcWidth, dstFilmWidth) - dstOffsetX;
+
+	// Clip with the src film
+	*srcHeight = Min(srcOffsetY + *srcHeight, srcFilmHeight) - srcOffsetY;
+	// Clip with the dst film
+	*srcHeight = Min(dstOffsetY + *srcHeight, dstFilmHeight) - dstOffsetY;
+
+	return (*srcWidth > 0) && (*srcHeight > 0);
+}
+
+void FilmMerger::AddFilm(Film &dstFilm, const string &fileName,
+		const u_int srcOffsetX, const u_int srcOffsetY,
+		const u_int srcWidth, const u_int srcHeight,
+		const u_int dstOffsetX, const u_int dstOffsetY,
+		const float weight) {
+	// The region is clipped like luxcore::Film::AddFilm() does with the films
+	// in memory
+	u_int clippedSrcWidth = srcWidth;
+	u_int clippedSrcHeight = srcHeight;
+
+	if (FilmChunkedFile::IsChunkedFile(fileName)) {
+		FilmChunkedFile srcFile(fileName);
+
+		if (!ClipRegion(srcFile.GetWidth(), srcFile.GetHeight(),
+				dstFilm.GetWidth(), dstFilm.GetHeight(),
+				srcOffsetX, srcOffsetY, dstOffsetX, dstOffsetY,
+				&clippedSrcWidth, &clippedSrcHeight))
+			return;
+
+		AddChunkedFilm(dstFilm, srcFile, srcOffsetX, srcOffsetY,
+				clippedSrcWidth, clippedSrcHeight, dstOffsetX, dstOffsetY, weight);
+	} else {
+		// Old file format, I have to load the whole film
+		unique_ptr<Film> srcFilm(Film::LoadSerialized(fileName));
+
+		if (!ClipRegion(srcFilm->GetWidth(), srcFilm->GetHeight(),
+				dstFilm.GetWidth(), dstFilm.GetHeight(),
+				srcOffsetX, srcOffsetY, dstOffsetX, dstOffsetY,
+				&clippedSrcWidth, &clippedSrcHeight))
+			return;
+
+		dstFilm.AddFilm(*srcFilm, srcOffsetX, srcOffsetY,
+				clippedSrcWidth, clippedSrcHeight, dstOffsetX, dstOffsetY, weight, true);
+	}
+}
+
+void FilmMerger::AddFilm(Film &dstFilm, const string &fileName, const float weight) {
+	if (FilmChunkedFile::IsChunkedFile(fileName)) {
+		FilmChunkedFile srcFile(fileName);
+
+		AddChunkedFilm(dstFilm, srcFile, 0, 0, srcFile.GetWidth(), srcFile.GetHeight(),
+				0, 0, weight);
+	} else {
+		// Old file format, I have to load the whole film
+		unique_ptr<Film> srcFilm(Film::LoadSerialized(fileName));
+
+		dstFilm.AddFilm(*srcFilm, 0, 0, srcFilm->GetWidth(), srcFilm->GetHeight(),
+				0, 0, weight, true);
+	}
+}
+
+Film *FilmMerger::Merge(const vector<string> &fileNames, const vector<float> &weights) {
+	if (fileNames.size() == 0)
+		throw runtime_error("No film to merge in FilmMerger::Merge()");
+	if ((weights.size() > 0) && (weights.size() != fileNames.size()))
+		throw runtime_error("Wrong number of weights in FilmMerger::Merge(): " + ToString(weights.size()));
+
+	SLG_LOG("Merging film: " << fileNames[0]);
+	unique_ptr<Film> film(Film::LoadSerialized(fileNames[0]));
+	if ((weights.size() > 0) && (weights[0] != 1.f))
+		ScaleFilm(*film, weights[0]);
+
+	for (u_int i = 1; i < fileNames.size(); ++i) {
+		SLG_LOG("Merging film: " << fileNames[i]);
+		AddFilm(*film, fileNames[i], (weights.size() > 0) ? weights[i] : 1.f);
+	}
+
+	return film.release();
+}
+
+void FilmMerger::ScaleFilm(Film &film, const float weight) {
+	for (auto const type : additiveChannels) {
+		size_t size;
+		float *pixels = (float *)film.GetChannelBufferPixels(type, 0, size, false);
+		if (pixels)
+			GenericFrameBuffer<1, 0, float>::ScaleValues(pixels, size / sizeof(float), weight);
+	}
+
+	for (auto const type : scaledChannels) {
+		for (u_int i = 0; i < film.GetChannelCount(type); ++i) {
+			size_t size;
+			float *pixels = (float *)film.GetChannelBufferPixels(type, i, size, false);
+			if (pixels)
+				GenericFrameBuffer<1, 0, float>::ScaleValues(pixels, size / sizeof(float), weight);
+		}
+	}
+
+	const double sampleCount = film.samplesCounts.GetSampleCount();
+	const double RADIANCE_PER_PIXEL_NORMALIZED_SampleCount = film.samplesCounts.GetSampleCount_RADIANCE_PER_PIXEL_NORMALIZED();
+	const double RADIANCE_PER_SCREEN_NORMALIZED_SampleCount = film.samplesCounts.GetSampleCount_RADIANCE_PER_SCREEN_NORMALIZED();
+	film.samplesCounts.Clear();
+	film.samplesCounts.AddSampleCount(sampleCount * weight,
+			RADIANCE_PER_PIXEL_NORMALIZED_SampleCount * weight,
+			RADIANCE_PER_SCREEN_NORMALIZED_SampleCount * weight);
+
+	// The BCD denoiser statistics must match the scaled radiance
+	film.filmDenoiser.Scale(weight);
+}
@@ -712,6 +712,7 @@ ImagePipeline *Film::CreateImagePipeline(const Properties &props, const string &
 				const bool filterSpikes = props.Get(Property(prefix + ".filterspikes")(false)).Get<bool>();
 				const bool applyDenoise = props.Get(Property(prefix + ".applydenoise")(true)).Get<bool>();
 				const float prefilterThresholdStDevFactor = props.Get(Property(prefix + ".spikestddev")(2.f)).Get<float>();
+				const u_int tileSize = props.Get(Property(prefix + ".tilesize")(0u)).Get<u_int>();
 
 				const int threadCount = (userThreadCount > 0) ? userThreadCount : GetHardwareThreadCount();
 				
@@ -727,7 +728,8 @@ ImagePipeline *Film::CreateImagePipeline(const Properties &props, const string &
 						scales,
 						filterSpikes,
 						applyDenoise,
-						prefilterThresholdStDevFactor));
+						prefilterThresholdStDevFactor,
+						tileSize));
 			} else if (type == "PATTERNS") {
 				const u_int type = props.Get(Property(prefix + ".index")(0)).Get<u_int>();
 				imagePipeline->AddPlugin(new PatternsPlugin(type));
@@ -23,6 +23,7 @@
 #include <boost/serialization/unordered_set.hpp>
 
 #include "slg/film/film.h"
+#include "slg/film/filmchunkedfile.h"
 #include "slg/film/imagepipeline/imagepipeline.h"
 
 using namespace std;
@@ -35,7 +36,16 @@ using namespace slg;
 
 BOOST_CLASS_EXPORT_IMPLEMENT(slg::Film)
 
+thread_local bool Film::serializeChannelsData = true;
+
 Film *Film::LoadSerialized(const string &fileName) {
+	if (FilmChunkedFile::IsChunkedFile(fileName)) {
+		FilmChunkedFile chunkedFile(fileName);
+
+		return chunkedFile.LoadFilm();
+	}
+
+	// The old single Boost archive format
 	SerializationInputFile sif(fileName);
 
 	Film *film;
@@ -47,61 +57,65 @@ Film *Film::LoadSerialized(const string &fileName) {
 	return film;
 }
 
-void Film::SaveSerialized(const string &fileName, const Film *film) {
-	SerializationOutputFile sof(fileName);
+Film *Film::LoadSerialized(const string &fileName, const FilmChannels &channelsFilter) {
+	if (!FilmChunkedFile::IsChunkedFile(fileName))
+		throw runtime_error("Only chunked serialized films support the partial loading of channels: " + fileName);
 
-	sof.GetArchive() << film;
+	FilmChunkedFile chunkedFile(fileName);
 
-	if (!sof.IsGood())
-		throw runtime_error("Error while saving serialized film: " + fileName);
+	return chunkedFile.LoadFilm(&channelsFilter);
+}
 
-	sof.Flush();
-	SLG_LOG("Film saved: " << (sof.GetPosition() / 1024) << " Kbytes");
+void Film::SaveSerialized(const string &fileName, const Film *film) {
+	FilmChunkedFile::Save(fileName, *film);
 }
 
 template<class Archive> void Film::load(Archive &ar, const u_int version) {
-	ar & channel_RADIANCE_PER_PIXEL_NORMALIZEDs;
-	ar & channel_RADIANCE_PER_SCREEN_NORMALIZEDs;
-	ar & channel_ALPHA;
-	ar & channel_IMAGEPIPELINEs;
-	ar & channel_DEPTH;
-	ar & channel_POSITION;
-	ar & channel_GEOMETRY_NORMAL;
-	ar & channel_SHADING_NORMAL;
-	ar & channel_AVG_SHADING_NORMAL;
-	ar & channel_MATERIAL_ID;
-	ar & channel_DIRECT_DIFFUSE;
-	ar & channel_DIRECT_DIFFUSE_REFLECT;
-	ar & channel_DIRECT_DIFFUSE_TRANSMIT;
-	ar & channel_DIRECT_GLOSSY;
-	ar & channel_DIRECT_GLOSSY_REFLECT;
-	ar & channel_DIRECT_GLOSSY_TRANSMIT;
-	ar & channel_EMISSION;
-	ar & channel_INDIRECT_DIFFUSE;
-	ar & channel_INDIRECT_DIFFUSE_REFLECT;
-	ar & channel_INDIRECT_DIFFUSE_TRANSMIT;
-	ar & channel_INDIRECT_GLOSSY;
-	ar & channel_INDIRECT_GLOSSY_REFLECT;
-	ar & channel_INDIRECT_GLOSSY_TRANSMIT;
-	ar & channel_INDIRECT_SPECULAR;
-	ar & channel_INDIRECT_SPECULAR_REFLECT;
-	ar & channel_INDIRECT_SPECULAR_TRANSMIT;
-	ar & channel_MATERIAL_ID_MASKs;
-	ar & channel_DIRECT_SHADOW_MASK;
-	ar & channel_INDIRECT_SHADOW_MASK;
-	ar & channel_UV;
-	ar & channel_RAYCOUNT;
-	ar & channel_BY_MATERIAL_IDs;
-	ar & channel_IRRADIANCE;
-	ar & channel_OBJECT_ID;
-	ar & channel_OBJECT_ID_MASKs;
-	ar & channel_BY_OBJECT_IDs;
-	ar & channel_SAMPLECOUNT;
-	ar & channel_CONVERGENCE;
-	ar & channel_MATERIAL_ID_COLOR;
-	ar & channel_ALBEDO;
-	ar & channel_NOISE;
-	ar & channel_USER_IMPORTANCE;
+	// The channels of a chunked file are stored outside the archive
+	if (serializeChannelsData) {
+		ar & channel_RADIANCE_PER_PIXEL_NORMALIZEDs;
+		ar & channel_RADIANCE_PER_SCREEN_NORMALIZEDs;
+		ar & channel_ALPHA;
+		ar & channel_IMAGEPIPELINEs;
+		ar & channel_DEPTH;
+		ar & channel_POSITION;
+		ar & channel_GEOMETRY_NORMAL;
+		ar & channel_SHADING_NORMAL;
+		ar & channel_AVG_SHADING_NORMAL;
+		ar & channel_MATERIAL_ID;
+		ar & channel_DIRECT_DIFFUSE;
+		ar & channel_DIRECT_DIFFUSE_REFLECT;
+		ar & channel_DIRECT_DIFFUSE_TRANSMIT;
+		ar & channel_DIRECT_GLOSSY;
+		ar & channel_DIRECT_GLOSSY_REFLECT;
+		ar & channel_DIRECT_GLOSSY_TRANSMIT;
+		ar & channel_EMISSION;
+		ar & channel_INDIRECT_DIFFUSE;
+		ar & channel_INDIRECT_DIFFUSE_REFLECT;
+		ar & channel_INDIRECT_DIFFUSE_TRANSMIT;
+		ar & channel_INDIRECT_GLOSSY;
+		ar & channel_INDIRECT_GLOSSY_REFLECT;
+		ar & channel_INDIRECT_GLOSSY_TRANSMIT;
+		ar & channel_INDIRECT_SPECULAR;
+		ar & channel_INDIRECT_SPECULAR_REFLECT;
+		ar & channel_INDIRECT_SPECULAR_TRANSMIT;
+		ar & channel_MATERIAL_ID_MASKs;
+		ar & channel_DIRECT_SHADOW_MASK;
+		ar & channel_INDIRECT_SHADOW_MASK;
+		ar & channel_UV;
+		ar & channel_RAYCOUNT;
+		ar & channel_BY_MATERIAL_IDs;
+		ar & channel_IRRADIANCE;
+		ar & channel_OBJECT_ID;
+		ar & channel_OBJECT_ID_MASKs;
+		ar & channel_BY_OBJECT_IDs;
+		ar & channel_SAMPLECOUNT;
+		ar & channel_CONVERGENCE;
+		ar & channel_MATERIAL_ID_COLOR;
+		ar & channel_ALBEDO;
+		ar & channel_NOISE;
+		ar & channel_USER_IMPORTANCE;
+	}
 
 	ar & channels;
 	ar & width;
@@ -150,48 +164,51 @@ template<class Archive> void Film::save(Archive &ar, const u_int version) const
 	if (isAsyncImagePipelineRunning)
 		throw runtime_error("It is not possible to serialize a Film while an AsyncExecuteImagePipeline() is still running");
 	
-	ar & channel_RADIANCE_PER_PIXEL_NORMALIZEDs;
-	ar & channel_RADIANCE_PER_SCREEN_NORMALIZEDs;
-	ar & channel_ALPHA;
-	ar & channel_IMAGEPIPELINEs;
-	ar & channel_DEPTH;
-	ar & channel_POSITION;
-	ar & channel_GEOMETRY_NORMAL;
-	ar & channel_SHADING_NORMAL;
-	ar & channel_AVG_SHADING_NORMAL;
-	ar & channel_MATERIAL_ID;
-	ar & channel_DIRECT_DIFFUSE;
-	ar & channel_DIRECT_DIFFUSE_REFLECT;
-	ar & channel_DIRECT_DIFFUSE_TRANSMIT;
-	ar & channel_DIRECT_GLOSSY;
-	ar & channel_DIRECT_GLOSSY_REFLECT;
-	ar & channel_DIRECT_GLOSSY_TRANSMIT;
-	ar & channel_EMISSION;
-	ar & channel_INDIRECT_DIFFUSE;
-	ar & channel_INDIRECT_DIFFUSE_REFLECT;
-	ar & channel_INDIRECT_DIFFUSE_TRANSMIT;
-	ar & channel_INDIRECT_GLOSSY;
-	ar & channel_INDIRECT_GLOSSY_REFLECT;
-	ar & channel_INDIRECT_GLOSSY_TRANSMIT;
-	ar & channel_INDIRECT_SPECULAR;
-	ar & channel_INDIRECT_SPECULAR_REFLECT;
-	ar & channel_INDIRECT_SPECULAR_TRANSMIT;
-	ar & channel_MATERIAL_ID_MASKs;
-	ar & channel_DIRECT_SHADOW_MASK;
-	ar & channel_INDIRECT_SHADOW_MASK;
-	ar & channel_UV;
-	ar & channel_RAYCOUNT;
-	ar & channel_BY_MATERIAL_IDs;
-	ar & channel_IRRADIANCE;
-	ar & channel_OBJECT_ID;
-	ar & channel_OBJECT_ID_MASKs;
-	ar & channel_BY_OBJECT_IDs;
-	ar & channel_SAMPLECOUNT;
-	ar & channel_CONVERGENCE;
-	ar & channel_MATERIAL_ID_COLOR;
-	ar & channel_ALBEDO;
-	ar & channel_NOISE;
-	ar & channel_USER_IMPORTANCE;
+	// The channels of a chunked file are stored outside the archive
+	if (serializeChannelsData) {
+		ar & channel_RADIANCE_PER_PIXEL_NORMALIZEDs;
+		ar & channel_RADIANCE_PER_SCREEN_NORMALIZEDs;
+		ar & channel_ALPHA;
+		ar & channel_IMAGEPIPELINEs;
+		ar & channel_DEPTH;
+		ar & channel_POSITION;
+		ar & channel_GEOMETRY_NORMAL;
+		ar & channel_SHADING_NORMAL;
+		ar & channel_AVG_SHADING_NORMAL;
+		ar & channel_MATERIAL_ID;
+		ar & channel_DIRECT_DIFFUSE;
+		ar & channel_DIRECT_DIFFUSE_REFLECT;
+		ar & channel_DIRECT_DIFFUSE_TRANSMIT;
+		ar & channel_DIRECT_GLOSSY;
+		ar & channel_DIRECT_GLOSSY_REFLECT;
+		ar & channel_DIRECT_GLOSSY_TRANSMIT;
+		ar & channel_EMISSION;
+		ar & channel_INDIRECT_DIFFUSE;
+		ar & channel_INDIRECT_DIFFUSE_REFLECT;
+		ar & channel_INDIRECT_DIFFUSE_TRANSMIT;
+		ar & channel_INDIRECT_GLOSSY;
+		ar & channel_INDIRECT_GLOSSY_REFLECT;
+		ar & channel_INDIRECT_GLOSSY_TRANSMIT;
+		ar & channel_INDIRECT_SPECULAR;
+		ar & channel_INDIRECT_SPECULAR_REFLECT;
+		ar & channel_INDIRECT_SPECULAR_TRANSMIT;
+		ar & channel_MATERIAL_ID_MASKs;
+		ar & channel_DIRECT_SHADOW_MASK;
+		ar & channel_INDIRECT_SHADOW_MASK;
+		ar & channel_UV;
+		ar & channel_RAYCOUNT;
+		ar & channel_BY_MATERIAL_IDs;
+		ar & channel_IRRADIANCE;
+		ar & channel_OBJECT_ID;
+		ar & channel_OBJECT_ID_MASKs;
+		ar & channel_BY_OBJECT_IDs;
+		ar & channel_SAMPLECOUNT;
+		ar & channel_CONVERGENCE;
+		ar & channel_MATERIAL_ID_COLOR;
+		ar & channel_ALBEDO;
+		ar & channel_NOISE;
+		ar & channel_USER_IMPORTANCE;
+	}
 
 	ar & channels;
 	ar & width;
@@ -85,7 +85,8 @@ BCDDenoiserPlugin::BCDDenoiserPlugin(
 		const int scalesVal,
 	    const bool filterSpikesVal,
 		const bool applyDenoiseVal,
-	    const float prefilterThresholdStDevFactorVal) :
+	    const float prefilterThresholdStDevFactorVal,
+		const u_int tileSizeVal) :
 		warmUpSamplesPerPixel(warmUpSamplesPerPixelVal),
 		histogramDistanceThreshold(histogramDistanceThresholdVal),
 		patchRadius(patchRadiusVal),
@@ -97,10 +98,11 @@ BCDDenoiserPlugin::BCDDenoiserPlugin(
 		scales(scalesVal),
 		filterSpikes(filterSpikesVal),
 		applyDenoise(applyDenoiseVal),
-		prefilterThresholdStDevFactor(prefilterThresholdStDevFactorVal) {
+		prefilterThresholdStDevFactor(prefilterThresholdStDevFactorVal),
+		tileSize(tileSizeVal) {
 }
 	
-BCDDenoiserPlugin::BCDDenoiserPlugin() {
+BCDDenoiserPlugin::BCDDenoiserPlugin() : tileSize(0) {
 }
 
 BCDDenoiserPlugin::~BCDDenoiserPlugin() {
@@ -119,7 +121,8 @@ ImagePipelinePlugin *BCDDenoiserPlugin::Copy() const {
 			scales,
 			filterSpikes,
 			applyDenoise,
-			prefilterThresholdStDevFactor);
+			prefilterThresholdStDevFactor,
+			tileSize);
 }
 
 //------------------------------------------------------------------------------
@@ -137,58 +140,125 @@ static void ProgressCallBack(const float progress) {
 }
 
 void BCDDenoiserPlugin::CopyOutputToFilm(const Film &film, const u_int index,
-		const bcd::DeepImage<float> &outputImg) const {
+		const bcd::DeepImage<float> &outputImg, const Tile &tile) const {
 	const u_int width = film.GetWidth();
 	const u_int height = film.GetHeight();	
 
 	const FilmDenoiser &filmDenoiser = film.GetDenoiser();
 	const float sampleScale = filmDenoiser.GetSampleScale();
 
-	// Copy to output pixels
+	// Copy to output pixels only the tile, without the region margin
 	Spectrum *dstPixels = (Spectrum *)film.channel_IMAGEPIPELINEs[index]->GetPixels();
 	const float invSampleScale = 1.f / sampleScale;
-	for(u_int y = 0; y < height; ++y) {
-		for(u_int x = 0; x < width; ++x) {
-			const u_int i = (height - y - 1) * width + x;
-			Spectrum *dstPixel = dstPixels + i;
-			
-			dstPixel->c[0] += outputImg.get(y, x, 0) * invSampleScale;
-			dstPixel->c[1] += outputImg.get(y, x, 1) * invSampleScale;
-			dstPixel->c[2] += outputImg.get(y, x, 2) * invSampleScale;
+	for(u_int line = tile.tileLine; line < tile.tileLine + tile.tileHeight; ++line) {
+		for(u_int column = tile.tileColumn; column < tile.tileColumn + tile.tileWidth; ++column) {
+			const u_int x = column;
+			const u_int y = height - line - 1;
+			Spectrum *dstPixel = dstPixels + (y * width + x);
+
+			const u_int outLine = line - tile.regionLine;
+			const u_int outColumn = column - tile.regionColumn;
+			dstPixel->c[0] += outputImg.get(outLine, outColumn, 0) * invSampleScale;
+			dstPixel->c[1] += outputImg.get(outLine, outColumn, 1) * invSampleScale;
+			dstPixel->c[2] += outputImg.get(outLine, outColumn, 2) * invSampleScale;
+		}
+	}
+}
+
+void BCDDenoiserPlugin::GetTiles(const u_int width, const u_int height, const u_int tileSize,
+		const int patchRadius, const int searchWindowRadius, const int scales,
+		vector<Tile> &tiles) {
+	tiles.clear();
+
+	// Each scale halves the image resolution: the tiles start on a pixel of
+	// the coarsest scale so the downsampled regions match the downsampled
+	// whole image
+	const u_int alignment = 1u << (scales - 1);
+
+	// The margin covers, at the coarsest scale, the patches of the pixels of
+	// the search window of the patches including a pixel of the tile, plus
+	// one pixel for the upsampling to the finer scales
+	const u_int margin = (searchWindowRadius + 2 * patchRadius + 1) << (scales - 1);
+
+	u_int tileWidth = (tileSize > 0) ? Min(tileSize, width) : width;
+	u_int tileHeight = (tileSize > 0) ? Min(tileSize, height) : height;
+	tileWidth = ((tileWidth + alignment - 1) / alignment) * alignment;
+	tileHeight = ((tileHeight + alignment - 1) / alignment) * alignment;
+
+	for (u_int tileLine = 0; tileLine < height; tileLine += tileHeight) {
+		for (u_int tileColumn = 0; tileColumn < width; tileColumn += tileWidth) {
+			Tile tile;
+			tile.tileLine = tileLine;
+			tile.tileColumn = tileColumn;
+			tile.tileWidth = Min(tileWidth, width - tileColumn);
+			tile.tileHeight = Min(tileHeight, height - tileLine);
+
+			tile.regionLine = (tileLine > margin) ? (tileLine - margin) : 0;
+			tile.regionColumn = (tileColumn > margin) ? (tileColumn - margin) : 0;
+			tile.regionWidth = Min(tileColumn + tile.tileWidth + margin, width) - tile.regionColumn;
+			tile.regionHeight = Min(tileLine + tile.tileHeight + margin, height) - tile.regionLine;
+
+			tiles.push_back(tile);
 		}
 	}
 }
 
 void BCDDenoiserPlugin::Apply(Film &film, const u_int index, const bool pixelNormalizedSampleAccumulator) {
+	const u_int width = film.GetWidth();
+	const u_int height = film.GetHeight();
+
+	const FilmDenoiser &filmDenoiser = film.GetDenoiser();
+	SLG_LOG("BCD sample scale: " << filmDenoiser.GetSampleScale());
+	SLG_LOG("BCD sample max. value: " << filmDenoiser.GetSampleMaxValue());
+
+	vector<Tile> tiles;
+	GetTiles(width, height, tileSize, patchRadius, searchWindowRadius, scales, tiles);
+	if (tiles.size() > 1)
+		SLG_LOG("BCD tiles: " << tiles.size());
+
+	for (auto const &tile : tiles) {
+		if (!ApplyTile(film, index, pixelNormalizedSampleAccumulator, tile))
+			return;
+	}
+}
+
+bool BCDDenoiserPlugin::ApplyTile(Film &film, const u_int index, const bool pixelNormalizedSampleAccumulator,
+		const Tile &tile) {
 	FilmDenoiser &filmDenoiser = film.GetDenoiser();
 
-	bcd::SamplesStatisticsImages stats = filmDenoiser.GetSamplesStatistics(pixelNormalizedSampleAccumulator);
+	const u_int regionLine = tile.regionLine;
+	const u_int regionColumn = tile.regionColumn;
+	const u_int regionWidth = tile.regionWidth;
+	const u_int regionHeight = tile.regionHeight;
+
+	bcd::SamplesStatisticsImages stats = filmDenoiser.GetSamplesStatistics(pixelNormalizedSampleAccumulator,
+			regionLine, regionColumn, regionWidth, regionHeight);
 	if (stats.m_nbOfSamplesImage.isEmpty()
 			|| stats.m_histoImage.isEmpty()
 			|| stats.m_covarImage.isEmpty()) {
 		SLG_LOG("WARNING: not enough samples to run BCDDenoiserPlugin. Warm up samples per pixel: " << warmUpSamplesPerPixel);
 
-		return;
+		return false;
 	}
 	
 	// Init inputs
 	
-	const u_int width = film.GetWidth();
 	const u_int height = film.GetHeight();	
-	bcd::DeepImage<float> inputColors(width, height, 3);
+	bcd::DeepImage<float> inputColors(regionWidth, regionHeight, 3);
 
 	const float sampleScale = filmDenoiser.GetSampleScale();
-	SLG_LOG("BCD sample scale: " << sampleScale);
 	const float sampleMaxValue = filmDenoiser.GetSampleMaxValue();
-	SLG_LOG("BCD sample max. value: " << sampleMaxValue);
 	// TODO alpha?
 	const bool use_RADIANCE_PER_PIXEL_NORMALIZEDs = pixelNormalizedSampleAccumulator;
 	const bool use_RADIANCE_PER_SCREEN_NORMALIZEDs = !pixelNormalizedSampleAccumulator;
 
 	const double RADIANCE_PER_SCREEN_NORMALIZED_SampleCount = film.GetTotalLightSampleCount();
 	
-	for(u_int y = 0; y < height; ++y) {
-		for(u_int x = 0; x < width; ++x) {
+	for(u_int line = 0; line < regionHeight; ++line) {
+		for(u_int column = 0; column < regionWidth; ++column) {
+			const u_int x = regionColumn + column;
+			const u_int y = height - (regionLine + line) - 1;
+
 			Spectrum color;
 			film.GetPixelFromMergedSampleBuffers(use_RADIANCE_PER_PIXEL_NORMALIZEDs,
 					use_RADIANCE_PER_SCREEN_NORMALIZEDs,
@@ -197,14 +267,12 @@ void BCDDenoiserPlugin::Apply(Film &film, const u_int index, const bool pixelNor
 					x, y, color.c);
 			
 			color = (color *  sampleScale).Clamp(0.f, sampleMaxValue);
-			const u_int column = x;
-			const u_int line = height - y - 1;
 			inputColors.set(line, column, 0, color.c[0]);
 			inputColors.set(line, column, 1, color.c[1]);
 			inputColors.set(line, column, 2, color.c[2]);
 		}
 	}
-	
+
 	if (filterSpikes)
 		bcd::SpikeRemovalFilter::filter(inputColors,
 										stats.m_nbOfSamplesImage,
@@ -242,7 +310,7 @@ void BCDDenoiserPlugin::Apply(Film &film, const u_int index, const bool pixelNor
 
 		// Init outputs
 
-		bcd::DeepImage<float> denoisedImg(width, height, 3);
+		bcd::DeepImage<float> denoisedImg(regionWidth, regionHeight, 3);
 		bcd::DenoiserOutputs outputs;
 		outputs.m_pDenoisedColors = &denoisedImg;
 
@@ -262,9 +330,11 @@ void BCDDenoiserPlugin::Apply(Film &film, const u_int index, const bool pixelNor
 
 		denoiser->denoise();
 		
-		CopyOutputToFilm(film, index, denoisedImg);
+		CopyOutputToFilm(film, index, denoisedImg, tile);
 	} else
-		CopyOutputToFilm(film, index, inputColors);
+		CopyOutputToFilm(film, index, inputColors, tile);
+
+	return true;
 }
 
 void BCDDenoiserPlugin::Apply(Film &film, const u_int index) {
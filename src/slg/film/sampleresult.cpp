@@ -28,7 +28,12 @@ using namespace slg;
 //------------------------------------------------------------------------------
 
 void SampleResult::Init(const Film::FilmChannels *chnls, const u_int radianceGroupCount) {
-	channels = chnls;
+	static_assert(Film::FILM_CHANNEL_TYPE_COUNT <= 64,
+			"SampleResult::channelsMask has not enough bits for all Film::FilmChannelType");
+
+	channelsMask = 0;
+	for (auto const &c : *chnls)
+		channelsMask |= 1ull << c;
 
 	if (HasChannel(Film::RADIANCE_PER_PIXEL_NORMALIZED) && HasChannel(Film::RADIANCE_PER_SCREEN_NORMALIZED))
 		throw runtime_error("RADIANCE_PER_PIXEL_NORMALIZED and RADIANCE_PER_SCREEN_NORMALIZED, both used in SampleResult");
@@ -769,12 +769,13 @@ void ImageMapConfig::FromProperties(const Properties &props, const string &prefi
 
 ImageMap::ImageMap() {
 	pixelStorage = nullptr;
+	pixelsVersion = 0;
 	instrumentationInfo = nullptr;
 }
 
 ImageMap::ImageMap(const string &fileName, const ImageMapConfig &cfg,
 		const u_int widthHint, const u_int heightHint) : NamedObject(fileName),
-		instrumentationInfo(nullptr) {
+		pixelsVersion(0), instrumentationInfo(nullptr) {
 	Init(fileName, cfg, widthHint, heightHint);
 }
 
@@ -782,6 +783,7 @@ ImageMap::ImageMap(ImageMapStorage *pixels, const float im, const float imy) {
 	pixelStorage = pixels;
 	imageMean = im;
 	imageMeanY = imy;
+	pixelsVersion = 0;
 	instrumentationInfo = nullptr;
 }
 
@@ -796,6 +798,7 @@ void ImageMap::Reload() {
 
 	delete pixelStorage;
 	Init(GetName(), instrumentationInfo->originalImgCfg, 0, 0);
+	++pixelsVersion;
 }
 
 void ImageMap::Reload(const string &fileName, const u_int widthHint, const u_int heightHint) {
@@ -804,6 +807,7 @@ void ImageMap::Reload(const string &fileName, const u_int widthHint, const u_int
 
 	delete pixelStorage;
 	Init(fileName, instrumentationInfo->originalImgCfg, widthHint, heightHint);
+	++pixelsVersion;
 }
 
 void ImageMap::Init(const string &fileName, const ImageMapConfig &cfg,
@@ -1086,6 +1090,7 @@ void ImageMap::SelectChannel(const ImageMapStorage::ChannelSelectionType selecti
 	if (newPixelStorage) {
 		delete pixelStorage;
 		pixelStorage = newPixelStorage;
+		++pixelsVersion;
 	}
 }
 
@@ -1153,6 +1158,7 @@ void ImageMap::ConvertStorage(const ImageMapStorage::StorageType newStorageType,
 	// I can delete the current image
 	delete pixelStorage;
 	pixelStorage = newPixelStorage;
+	++pixelsVersion;
 }
 
 void ImageMap::ConvertColorSpace(const string &configFileName,
@@ -1192,6 +1198,7 @@ void ImageMap::ConvertColorSpace(const string &configFileName,
 
 	// Convert back the image to the original storage type and channel count
 	ConvertStorage(storageType, channelCount);
+	++pixelsVersion;
 }
 
 void ImageMap::Resize(const u_int newWidth, const u_int newHeight) {
@@ -1252,6 +1259,7 @@ void ImageMap::Resize(const u_int newWidth, const u_int newHeight) {
 	}
 
 	dest.get_pixels(roi, baseType, pixelStorage->GetPixelsData());
+	++pixelsVersion;
 }
 
 string ImageMap::GetFileExtension() const {
@@ -146,6 +146,8 @@ void ImageMapCache::DefineImageMap(ImageMap *im) {
 		resizePolicyToApply.push_back(false);
 	} else {
 		// Overwrite the existing image definition
+		DeleteImageMapDistributions(it->second);
+
 		const u_int index = GetImageMapIndex(it->second);
 		delete maps[index];
 		maps[index] = im;
@@ -162,6 +164,8 @@ void ImageMapCache::DefineImageMap(ImageMap *im) {
 void ImageMapCache::DeleteImageMap(const ImageMap *im) {
 	for (boost::unordered_map<std::string, ImageMap *>::iterator it = mapByKey.begin(); it != mapByKey.end(); ++it) {
 		if (it->second == im) {
+			DeleteImageMapDistributions(im);
+
 			delete it->second;
 			mapByKey.erase(it);
 
@@ -179,6 +183,52 @@ void ImageMapCache::DeleteImageMap(const ImageMap *im) {
 	}
 }
 
+shared_ptr<const Distribution2D> ImageMapCache::GetImageMapDistribution(const ImageMap *im,
+		const u_int width, const u_int height, const bool upperHemisphereOnly) const {
+	for (auto const &d : distributions) {
+		if ((d.imageMap == im) && (d.imageMapPixelsVersion == im->GetPixelsVersion()) &&
+				(d.width == width) && (d.height == height) &&
+				(d.upperHemisphereOnly == upperHemisphereOnly))
+			return d.distribution;
+	}
+
+	return nullptr;
+}
+
+void ImageMapCache::DefineImageMapDistribution(const ImageMap *im,
+		const u_int width, const u_int height, const bool upperHemisphereOnly,
+		const shared_ptr<const Distribution2D> &dist) {
+	// Drop the distributions built before the image map was resized or
+	// reloaded, they will be never used again
+	for (u_int i = 0; i < distributions.size();) {
+		if ((distributions[i].imageMap == im) &&
+				(distributions[i].imageMapPixelsVersion != im->GetPixelsVersion()))
+			distributions.erase(distributions.begin() + i);
+		else
+			++i;
+	}
+
+	ImageMapDistribution d;
+	d.imageMap = im;
+	d.imageMapPixelsVersion = im->GetPixelsVersion();
+	d.width = width;
+	d.height = height;
+	d.upperHemisphereOnly = upperHemisphereOnly;
+	d.distribution = dist;
+
+	distributions.push_back(d);
+}
+
+void ImageMapCache::DeleteImageMapDistributions(const ImageMap *im) {
+	// The lights still using the distributions hold a reference to them
+	for (u_int i = 0; i < distributions.size();) {
+		if (distributions[i].imageMap == im)
+			distributions.erase(distributions.begin() + i);
+		else
+			++i;
+	}
+}
+
 string ImageMapCache::GetSequenceFileName(const ImageMap *im) const {
 	return ("imagemap-" + ((boost::format("%05d") % GetImageMapIndex(im)).str()) +
 			"." + im->GetFileExtension());
@@ -68,22 +68,34 @@ ImageMap::InstrumentationInfo::InstrumentationInfo(const u_int w, const u_int h,
 }
 
 ImageMap::InstrumentationInfo::~InstrumentationInfo() {
-	for (auto k : threadInfo)
-		delete k.second;
+	for (auto ti : threadInfo)
+		delete ti;
 }
 
-void ImageMap::InstrumentationInfo::ThreadSetUp() {
-//	cout << "ImageMap::InstrumentationInfo::ThreadSetUp() [" << this << "]" << endl;
+thread_local u_int ImageMap::InstrumentationInfo::currentThreadIndex = NULL_INDEX;
 
-	boost::unique_lock<boost::mutex> lock(classLock);
-	threadInfo[boost::this_thread::get_id()] = new ThreadData();
+void ImageMap::InstrumentationInfo::SetUpThreads(const u_int threadCount) {
+	for (auto ti : threadInfo)
+		delete ti;
+	threadInfo.clear();
+	threadInfo.resize(threadCount, nullptr);
+}
+
+void ImageMap::InstrumentationInfo::ThreadSetUp(const u_int threadIndex) {
+//	cout << "ImageMap::InstrumentationInfo::ThreadSetUp(" << threadIndex << ") [" << this << "]" << endl;
+
+	// Each thread allocates its own data so it is local to the thread
+	currentThreadIndex = threadIndex;
+	threadInfo[threadIndex] = new ThreadData();
 }
 
 void ImageMap::InstrumentationInfo::ThreadFinalize() {
 //	cout << "ImageMap::InstrumentationInfo::ThreadFinalize() [" << this << "]" << endl;
 	
-	boost::unique_lock<boost::mutex> lock(classLock);
-	ThreadData *ti = threadInfo[boost::this_thread::get_id()];
+	ThreadData *ti = GetThreadData();
+	if (!ti)
+		return;
+
 	if (ti->samplesCount > 0) {
 //		cout << "Min. U distance in pixel: " << (ti->minDistance * originalWidth) << endl;
 //		cout << "Min. V distance in pixel: " << (ti->minDistance * originalHeigth) << endl;
@@ -93,33 +105,40 @@ void ImageMap::InstrumentationInfo::ThreadFinalize() {
 			const u_int w = (u_int)(originalWidth / (ti->minDistance * originalWidth));
 			const u_int h = (u_int)(originalHeigth / (ti->minDistance * originalHeigth));
 
+			// Reduce the result of all threads
 			AtomicMax(&optimalWidth, w);
 			AtomicMax(&optimalHeigth, h);
 		}
 	}
 
 	delete ti;
-	threadInfo.erase(boost::this_thread::get_id());
+	threadInfo[currentThreadIndex] = nullptr;
 }
 
 void ImageMap::InstrumentationInfo::ThreadSetSampleIndex(const InstrumentationSampleIndex index) {
 //	cout << "ImageMap::InstrumentationInfo::ThreadSetSampleIndex(" << index << ") [" << this << "]" << endl;
 
-	ThreadData *ti = threadInfo[boost::this_thread::get_id()];
-	ti->currentSamplesIndex = (u_int)index;
+	ThreadData *ti = GetThreadData();
+	if (ti)
+		ti->currentSamplesIndex = (u_int)index;
 }
 
 void ImageMap::InstrumentationInfo::ThreadAddSample(const luxrays::UV &uv) {
-//	cout << "ImageMap::InstrumentationInfo::ThreadAddSample(" << uv << ") [" << this << ", " << ti->currentSamplesIndex << "]" << endl;
+//	cout << "ImageMap::InstrumentationInfo::ThreadAddSample(" << uv << ") [" << this << "]" << endl;
 
-	ThreadData *ti = threadInfo[boost::this_thread::get_id()];
-	ti->samples[ti->currentSamplesIndex].push_back(uv);
+	// Samples from threads not doing the instrumentation are ignored
+	ThreadData *ti = GetThreadData();
+	if (ti)
+		ti->samples[ti->currentSamplesIndex].push_back(uv);
 }
 
 void ImageMap::InstrumentationInfo::ThreadAccumulateSamples() {
 //	cout << "ImageMap::InstrumentationInfo::ThreadAccumulateSamples() [" << this << "]" << endl;
 
-	ThreadData *ti = threadInfo[boost::this_thread::get_id()];
+	ThreadData *ti = GetThreadData();
+	if (!ti)
+		return;
+
 	if ((ti->samples[0].size() > 0) &&
 			(ti->samples[0].size() == ti->samples[1].size()) &&
 			(ti->samples[0].size() == ti->samples[2].size())) {
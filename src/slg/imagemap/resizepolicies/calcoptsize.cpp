@@ -71,7 +71,7 @@ void ImageMapResizePolicy::RenderFunc(const u_int threadIndex,
 
 	// Setup thread image maps instrumentation
 	for (auto i : *imgMapsIndices)
-		imc->maps[i]->instrumentationInfo->ThreadSetUp();
+		imc->maps[i]->instrumentationInfo->ThreadSetUp(threadIndex);
 	
 	threadsSyncBarrier->wait();
 
@@ -80,7 +80,7 @@ void ImageMapResizePolicy::RenderFunc(const u_int threadIndex,
 	// Initialize the sampler
 	RandomGenerator rnd(1 + threadIndex);
 	SobolSampler sampler(&rnd, NULL, NULL, true, 0.f, 0.f,
-			16, 16, 1, 1,
+			16, 16, 1, 1, false,
 			sobolSharedData);
 	
 	// Request the samples
@@ -258,6 +258,10 @@ void ImageMapResizePolicy::CalcOptimalImageMapSizes(ImageMapCache &imc, const Sc
 	boost::barrier threadsSyncBarrier(renderThreadCount);
 	
 	SobolSamplerSharedData sobolSharedData(131, nullptr);
+
+	// Setup image maps instrumentation
+	for (auto i : imgMapsIndices)
+		imc.maps[i]->instrumentationInfo->SetUpThreads(renderThreadCount);
 	
 	// Start the preprocessing threads
 	u_int workCounter = 0;
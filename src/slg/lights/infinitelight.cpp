@@ -17,6 +17,7 @@
  ***************************************************************************/
 
 #include <memory>
+#include <atomic>
 
 #include "slg/bsdf/bsdf.h"
 #include "slg/scene/scene.h"
@@ -31,48 +32,113 @@ using namespace slg;
 //------------------------------------------------------------------------------
 
 InfiniteLight::InfiniteLight() :
-	imageMap(NULL), imageMapDistribution(nullptr), visibilityMapCache(nullptr) {
+	imageMap(NULL), distributionWidth(0), distributionHeight(0), imageMapCache(NULL),
+	visibilityMapCache(nullptr) {
 }
 
 InfiniteLight::~InfiniteLight() {
-	delete imageMapDistribution;
 	delete visibilityMapCache;
 }
 
+Distribution2D *InfiniteLight::BuildDistribution(const u_int width, const u_int height) const {
+	const ImageMapStorage *imageMapStorage = imageMap->GetStorage();
+	const u_int imageWidth = imageMap->GetWidth();
+	const u_int imageHeight = imageMap->GetHeight();
+
+	// Each element of the distribution is the average of the image pixels it
+	// covers, weighted by the covered area, so the PDF over the (u, v) domain
+	// is the same of the full resolution one, just filtered.
+	const float scaleX = imageWidth / (float)width;
+	const float scaleY = imageHeight / (float)height;
+
+	vector<float> data(width * height);
+	atomic<bool> invalidPixel(false);
+	u_int invalidX = 0, invalidY = 0;
+	float invalidValue = 0.f;
+	#pragma omp parallel for
+	for (
+			// Visual C++ 2013 supports only OpenMP 2.5
+#if _OPENMP >= 200805
+			unsigned
+#endif
+			int y = 0; y < height; ++y) {
+		const float y0 = y * scaleY;
+		const float y1 = (y + 1) * scaleY;
+		const u_int py0 = Floor2UInt(y0);
+		const u_int py1 = Min(Ceil2UInt(y1), imageHeight);
+
+		for (u_int x = 0; x < width; ++x) {
+			const float x0 = x * scaleX;
+			const float x1 = (x + 1) * scaleX;
+			const u_int px0 = Floor2UInt(x0);
+			const u_int px1 = Min(Ceil2UInt(x1), imageWidth);
+
+			float value = 0.f;
+			float weightSum = 0.f;
+			for (u_int py = py0; py < py1; ++py) {
+				const float weightY = Min(y1, py + 1.f) - Max(y0, (float)py);
+
+				for (u_int px = px0; px < px1; ++px) {
+					const float weight = weightY * (Min(x1, px + 1.f) - Max(x0, (float)px));
+					weightSum += weight;
+
+					// The pixels of the lower hemisphere are not sampled (and
+					// not checked) if sampleUpperHemisphereOnly is true
+					if (sampleUpperHemisphereOnly && (py > imageHeight / 2))
+						continue;
+
+					const u_int index = px + py * imageWidth;
+					const float pixelValue = imageMapStorage->GetFloat(index);
+
+					if (!IsValid(pixelValue)) {
+						#pragma omp critical
+						{
+							invalidPixel = true;
+							invalidX = px;
+							invalidY = py;
+							invalidValue = pixelValue;
+						}
+					}
+
+					value += weight * pixelValue;
+				}
+			}
+
+			data[x + y * width] = (weightSum > 0.f) ? (value / weightSum) : 0.f;
+		}
+	}
+
+	if (invalidPixel)
+		throw runtime_error("Pixel (" + ToString(invalidX) + ", " + ToString(invalidY) + ") in infinite light has an invalid value: " + ToString(invalidValue));
+
+	return new Distribution2D(&data[0], width, height);
+}
+
 void InfiniteLight::Preprocess() {
 	EnvLightSource::Preprocess();
 
-	const ImageMapStorage *imageMapStorage = imageMap->GetStorage();
-
-	vector<float> data(imageMap->GetWidth() * imageMap->GetHeight());
-	//float maxVal = -INFINITY;
-	//float minVal = INFINITY;
-	for (u_int y = 0; y < imageMap->GetHeight(); ++y) {
-		for (u_int x = 0; x < imageMap->GetWidth(); ++x) {
-			const u_int index = x + y * imageMap->GetWidth();
+	// Very large images are importance sampled at a lower resolution by default
+	const u_int width = (distributionWidth > 0) ? distributionWidth : Min(imageMap->GetWidth(), 4096u);
+	const u_int height = (distributionHeight > 0) ? distributionHeight : Min(imageMap->GetHeight(), 2048u);
 
-			if (sampleUpperHemisphereOnly && (y > imageMap->GetHeight() / 2))
-				data[index] = 0.f;
-			else
-				data[index] = imageMapStorage->GetFloat(index);
+	imageMapDistribution.reset();
+	if (imageMapCache)
+		imageMapDistribution = imageMapCache->GetImageMapDistribution(imageMap,
+				width, height, sampleUpperHemisphereOnly);
 
-			if (!IsValid(data[index]))
-				throw runtime_error("Pixel (" + ToString(x) + ", " + ToString(y) + ") in infinite light has an invalid value: " + ToString(data[index]));
+	if (!imageMapDistribution) {
+		imageMapDistribution.reset(BuildDistribution(width, height));
 
-			//maxVal = Max(data[index], maxVal);
-			//minVal = Min(data[index], minVal);
-		}
+		if (imageMapCache)
+			imageMapCache->DefineImageMapDistribution(imageMap,
+					width, height, sampleUpperHemisphereOnly, imageMapDistribution);
 	}
-	
-	//SLG_LOG("InfiniteLight luminance  Max=" << maxVal << " Min=" << minVal);
-
-	imageMapDistribution = new Distribution2D(&data[0], imageMap->GetWidth(), imageMap->GetHeight());
 }
 
 void InfiniteLight::GetPreprocessedData(const Distribution2D **imageMapDistributionData,
 		const EnvLightVisibilityCache **elvc) const {
 	if (imageMapDistributionData)
-		*imageMapDistributionData = imageMapDistribution;
+		*imageMapDistributionData = imageMapDistribution.get();
 	if (elvc)
 		*elvc = visibilityMapCache;
 }
@@ -254,6 +320,8 @@ Properties InfiniteLight::ToProperties(const ImageMapCache &imgMapCache, const b
 	props.Set(imageMap->ToProperties(prefix, false));
 	props.Set(Property(prefix + ".gamma")(1.f));
 	props.Set(Property(prefix + ".sampleupperhemisphereonly")(sampleUpperHemisphereOnly));
+	props.Set(Property(prefix + ".distribution.width")(distributionWidth));
+	props.Set(Property(prefix + ".distribution.height")(distributionHeight));
 
 	props.Set(Property(prefix + ".visibilitymapcache.enable")(useVisibilityMapCache));
 	if (useVisibilityMapCache)
@@ -171,7 +171,22 @@ void LightSourceDefinitions::UpdateVolumeReferences(const Volume *oldVol, const
 
 }
 
+void LightSourceDefinitions::StopPreprocess() {
+	emitLightStrategy->StopPreprocess();
+	illuminateLightStrategy->StopPreprocess();
+	infiniteLightStrategy->StopPreprocess();
+}
+
+void LightSourceDefinitions::ResumePreprocess() {
+	emitLightStrategy->ResumePreprocess();
+	illuminateLightStrategy->ResumePreprocess();
+	infiniteLightStrategy->ResumePreprocess();
+}
+
 void LightSourceDefinitions::Preprocess(const Scene *scene, const bool useRTMode) {
+	// The light strategies background work uses the following fields
+	StopPreprocess();
+
 	// Update lightGroupCount, envLightSources, intersectableLightSources,
 	// lightIndexOffsetByMeshIndex, lightsDistribution, etc.
 
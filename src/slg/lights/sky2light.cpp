@@ -16,6 +16,12 @@
  * limitations under the License.                                          *
  ***************************************************************************/
 
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include <boost/thread/mutex.hpp>
+
 #include "slg/bsdf/bsdf.h"
 #include "slg/scene/scene.h"
 #include "slg/lights/sky2light.h"
@@ -142,15 +148,133 @@ static void ComputeModel(float turbidity, const Spectrum &albedo, float elevatio
 	}
 }
 
+//------------------------------------------------------------------------------
+// SkyLight2 baked tables
+//
+// The sampling distribution and the radiance table are cached and shared by
+// all SkyLight2 with the same parameters. The light is re-created at each
+// scene edit so they are re-baked only when the sun direction, the turbidity,
+// etc. change.
+//------------------------------------------------------------------------------
+
+namespace slg {
+
+class SkyLight2BakedDistribution {
+public:
+	bool IsSame(const SkyLight2BakedDistribution &d) const {
+		return (absoluteSunDir == d.absoluteSunDir) && (absoluteUpDir == d.absoluteUpDir) &&
+				(turbidity == d.turbidity) && (groundAlbedo == d.groundAlbedo) &&
+				(skyScale == d.skyScale) && (scaledGroundColor == d.scaledGroundColor) &&
+				(hasGround == d.hasGround) && (isGroundBlack == d.isGroundBlack) &&
+				(width == d.width) && (height == d.height);
+	}
+
+	// The parameters used to bake the distribution
+	Vector absoluteSunDir, absoluteUpDir;
+	float turbidity;
+	Spectrum groundAlbedo, skyScale, scaledGroundColor;
+	bool hasGround, isGroundBlack;
+	u_int width, height;
+
+	unique_ptr<Distribution2D> distribution;
+	// The mean luminance of the sky, used by GetPower()
+	float meanY;
+};
+
+class SkyLight2BakedRadiance {
+public:
+	bool IsSame(const SkyLight2BakedRadiance &r) const {
+		return (absoluteSunDir == r.absoluteSunDir) && (turbidity == r.turbidity) &&
+				(groundAlbedo == r.groundAlbedo) &&
+				(width == r.width) && (height == r.height);
+	}
+
+	// Bilinear look up of the lat-long mapped table
+	Spectrum GetRadiance(const Vector &w) const {
+		float s, t;
+		EnvLightSource::ToLatLongMapping(w, &s, &t);
+
+		const float fx = s * width - .5f;
+		const float fy = Clamp(t * height - .5f, 0.f, height - 1.f);
+		const int x0 = Floor2Int(fx);
+		const u_int y0 = Min(Floor2UInt(fy), height - 1);
+		const float dx = fx - x0;
+		const float dy = fy - y0;
+
+		const u_int xa = Mod<int>(x0, width);
+		const u_int xb = (xa + 1) % width;
+		const u_int ya = y0;
+		const u_int yb = Min(y0 + 1, height - 1);
+
+		return Lerp(dy,
+				Lerp(dx, pixels[xa + ya * width], pixels[xb + ya * width]),
+				Lerp(dx, pixels[xa + yb * width], pixels[xb + yb * width]));
+	}
+
+	// The parameters used to bake the table
+	Vector absoluteSunDir;
+	float turbidity;
+	Spectrum groundAlbedo;
+	u_int width, height;
+
+	// The sky radiance, without temperature scale and gain, in lat-long mapping
+	vector<Spectrum> pixels;
+};
+
+}
+
+// The baked data is shared by all the SkyLight2 with the same parameters (i.e.
+// multiple scenes or a scene edit not changing the sky). The cache holds only
+// weak references so the data is freed with the last light using it.
+template <class T> class SkyLight2BakedCache {
+public:
+	SkyLight2BakedCache() { }
+
+	shared_ptr<const T> Get(const T &params) {
+		boost::unique_lock<boost::mutex> lock(entriesMutex);
+
+		RemoveExpiredEntries();
+
+		for (auto const &e : entries) {
+			shared_ptr<const T> entry = e.lock();
+			if (entry && entry->IsSame(params))
+				return entry;
+		}
+
+		return nullptr;
+	}
+
+	void Add(const shared_ptr<const T> &entry) {
+		boost::unique_lock<boost::mutex> lock(entriesMutex);
+
+		RemoveExpiredEntries();
+
+		entries.push_back(entry);
+	}
+
+private:
+	void RemoveExpiredEntries() {
+		entries.erase(remove_if(entries.begin(), entries.end(),
+				[](const weak_ptr<const T> &e) { return e.expired(); }),
+				entries.end());
+	}
+
+	boost::mutex entriesMutex;
+	vector<weak_ptr<const T> > entries;
+};
+
+static SkyLight2BakedCache<SkyLight2BakedDistribution> bakedDistributionCache;
+static SkyLight2BakedCache<SkyLight2BakedRadiance> bakedRadianceCache;
+
 SkyLight2::SkyLight2() : localSunDir(0.f, 0.f, 1.f), turbidity(2.2f),
 		groundAlbedo(0.f, 0.f, 0.f), groundColor(0.f, 0.f, 0.f),
 		hasGround(false), hasGroundAutoScale(true),
 		distributionWidth(512), distributionHeight(256),
-		skyDistribution(nullptr), visibilityMapCache(nullptr) {
+		useRadianceTable(false), radianceTableWidth(1024), radianceTableHeight(512),
+		visibilityMapCache(nullptr) {
 }
 
 SkyLight2::~SkyLight2() {
-	delete skyDistribution;
 	delete visibilityMapCache;
 }
 
@@ -172,6 +296,14 @@ Spectrum SkyLight2::ComputeSkyRadiance(const Vector &w) const {
 }
 
 Spectrum SkyLight2::ComputeRadiance(const Vector &w) const {
+	// The ground is handled by ComputeExactRadiance()
+	if (skyRadianceTable && (!hasGround || (Dot(w, absoluteUpDir) >= 0.f)))
+		return temperatureScale * gain * skyRadianceTable->GetRadiance(w);
+	else
+		return ComputeExactRadiance(w);
+}
+
+Spectrum SkyLight2::ComputeExactRadiance(const Vector &w) const {
 	if (hasGround && (Dot(w, absoluteUpDir) < 0.f)) {
 		// Lower hemisphere
 		return scaledGroundColor;
@@ -179,6 +311,65 @@ Spectrum SkyLight2::ComputeRadiance(const Vector &w) const {
 		return temperatureScale * gain * ComputeSkyRadiance(w);
 }
 
+void SkyLight2::BakeDistribution(SkyLight2BakedDistribution &bakedDist) const {
+	const u_int width = bakedDist.width;
+	const u_int height = bakedDist.height;
+
+	vector<float> data(width * height);
+	vector<float> rowsY(height);
+	#pragma omp parallel for
+	for (
+			// Visual C++ 2013 supports only OpenMP 2.5
+#if _OPENMP >= 200805
+			unsigned
+#endif
+			int y = 0; y < height; ++y) {
+		float rowY = 0.f;
+		for (u_int x = 0; x < width; ++x) {
+			const u_int index = x + y * width;
+
+			const float luminance = ComputeExactRadiance(UniformSampleSphere(
+					(y + .5f) / height,
+					(x + .5f) / width)).Y();
+			rowY += luminance;
+
+			if (isGroundBlack && (y > height / 2))
+				data[index] = 0.f;
+			else
+				data[index] = luminance;
+		}
+		rowsY[y] = rowY;
+	}
+
+	float meanY = 0.f;
+	for (u_int y = 0; y < height; ++y)
+		meanY += rowsY[y];
+	bakedDist.meanY = meanY / (width * height);
+
+	bakedDist.distribution.reset(new Distribution2D(&data[0], width, height));
+}
+
+void SkyLight2::BakeRadianceTable(SkyLight2BakedRadiance &bakedRadiance) const {
+	const u_int width = bakedRadiance.width;
+	const u_int height = bakedRadiance.height;
+
+	bakedRadiance.pixels.resize(width * height);
+	#pragma omp parallel for
+	for (
+			// Visual C++ 2013 supports only OpenMP 2.5
+#if _OPENMP >= 200805
+			unsigned
+#endif
+			int y = 0; y < height; ++y) {
+		for (u_int x = 0; x < width; ++x) {
+			Vector w;
+			FromLatLongMapping((x + .5f) / width, (y + .5f) / height, &w);
+
+			bakedRadiance.pixels[x + y * width] = ComputeSkyRadiance(w);
+		}
+	}
+}
+
 void SkyLight2::Preprocess() {
 	EnvLightSource::Preprocess();
 
@@ -204,22 +395,45 @@ void SkyLight2::Preprocess() {
 		scaledGroundColor = groundColor;
 
 	isGroundBlack = (hasGround && groundColor.Black());
-	
-	vector<float> data(distributionWidth * distributionHeight);
-	for (u_int y = 0; y < distributionHeight; ++y) {
-		for (u_int x = 0; x < distributionWidth; ++x) {
-			const u_int index = x + y * distributionWidth;
 
-			if (isGroundBlack && (y > distributionHeight / 2))
-				data[index] = 0.f;
-			else
-				data[index] = ComputeRadiance(UniformSampleSphere(
-						(y + .5f) / distributionHeight,
-						(x + .5f) / distributionWidth)).Y();
-		}
+	// The sampling distribution is always baked with the exact model
+	shared_ptr<SkyLight2BakedDistribution> bakedDist(new SkyLight2BakedDistribution());
+	bakedDist->absoluteSunDir = absoluteSunDir;
+	bakedDist->absoluteUpDir = absoluteUpDir;
+	bakedDist->turbidity = turbidity;
+	bakedDist->groundAlbedo = groundAlbedo;
+	bakedDist->skyScale = temperatureScale * gain;
+	bakedDist->scaledGroundColor = scaledGroundColor;
+	bakedDist->hasGround = hasGround;
+	bakedDist->isGroundBlack = isGroundBlack;
+	bakedDist->width = distributionWidth;
+	bakedDist->height = distributionHeight;
+
+	skyDistribution = bakedDistributionCache.Get(*bakedDist);
+	if (!skyDistribution) {
+		BakeDistribution(*bakedDist);
+		bakedDistributionCache.Add(bakedDist);
+		skyDistribution = bakedDist;
 	}
 
-	skyDistribution = new Distribution2D(&data[0], distributionWidth, distributionHeight);
+	skyRadianceTable.reset();
+	if (useRadianceTable) {
+		shared_ptr<SkyLight2BakedRadiance> bakedRadiance(new SkyLight2BakedRadiance());
+		bakedRadiance->absoluteSunDir = absoluteSunDir;
+		bakedRadiance->turbidity = turbidity;
+		bakedRadiance->groundAlbedo = groundAlbedo;
+		bakedRadiance->width = radianceTableWidth;
+		bakedRadiance->height = radianceTableHeight;
+
+		shared_ptr<const SkyLight2BakedRadiance> cachedRadiance = bakedRadianceCache.Get(*bakedRadiance);
+		if (!cachedRadiance) {
+			BakeRadianceTable(*bakedRadiance);
+			bakedRadianceCache.Add(bakedRadiance);
+			cachedRadiance = bakedRadiance;
+		}
+
+		skyRadianceTable = cachedRadiance;
+	}
 }
 
 void SkyLight2::GetPreprocessedData(float *absoluteSunDirData, float *absoluteUpDirData,
@@ -311,22 +525,16 @@ void SkyLight2::GetPreprocessedData(float *absoluteSunDirData, float *absoluteUp
 	}
 	
 	if (skyDistributionData)
-		*skyDistributionData = skyDistribution;
+		*skyDistributionData = skyDistribution->distribution.get();
 	if (elvc)
 		*elvc = visibilityMapCache;
 }
 
 float SkyLight2::GetPower(const Scene &scene) const {
 	const float envRadius = GetEnvRadius(scene);
-	
-	float power = 0.f;
-	for (u_int y = 0; y < distributionHeight; ++y) {
-		for (u_int x = 0; x < distributionWidth; ++x)
-			power += ComputeRadiance(UniformSampleSphere(
-					(y + .5f) / distributionHeight,
-					(x + .5f) / distributionWidth)).Y();
-	}
-	power /= distributionWidth * distributionHeight;
+
+	// The mean luminance is computed when the distribution is baked
+	const float power = skyDistribution->meanY;
 
 	return power * (4.f * M_PI * envRadius * envRadius) * 2.f * M_PI;
 }
@@ -340,7 +548,7 @@ Spectrum SkyLight2::GetRadiance(const Scene &scene,
 	if (latLongMappingPdf == 0.f)
 		return Spectrum();
 	
-	const float distPdf = skyDistribution->Pdf(u, v);
+	const float distPdf = skyDistribution->distribution->Pdf(u, v);
 	if (directPdfA) {
 		if (!bsdf)
 			*directPdfA = 0.f;
@@ -365,7 +573,7 @@ Spectrum SkyLight2::Emit(const Scene &scene,
 		float *directPdfA, float *cosThetaAtLight) const {
 	float uv[2];
 	float distPdf;
-	skyDistribution->SampleContinuous(u0, u1, uv, &distPdf);
+	skyDistribution->distribution->SampleContinuous(u0, u1, uv, &distPdf);
 	if (distPdf == 0.f)
 		return Spectrum();
 	
@@ -415,7 +623,7 @@ Spectrum SkyLight2::Illuminate(const Scene &scene, const BSDF &bsdf,
 	if (visibilityMapCache && visibilityMapCache->IsCacheEnabled(bsdf))
 		visibilityMapCache->Sample(bsdf, u0, u1, uv, &distPdf);
 	else
-		skyDistribution->SampleContinuous(u0, u1, uv, &distPdf);
+		skyDistribution->distribution->SampleContinuous(u0, u1, uv, &distPdf);
 	if (distPdf == 0.f)
 		return Spectrum();
 
@@ -480,7 +688,13 @@ void SkyLight2::UpdateVisibilityMap(const Scene *scene, const bool useRTMode) {
 				ImageMapConfig()));
 
 		float *pixels = (float *)luminanceMapImage->GetStorage()->GetPixelsData();
-		for (u_int y = 0; y < EnvLightVisibilityCache::defaultLuminanceMapHeight; ++y) {
+		#pragma omp parallel for
+		for (
+				// Visual C++ 2013 supports only OpenMP 2.5
+#if _OPENMP >= 200805
+				unsigned
+#endif
+				int y = 0; y < EnvLightVisibilityCache::defaultLuminanceMapHeight; ++y) {
 			for (u_int x = 0; x < EnvLightVisibilityCache::defaultLuminanceMapWidth; ++x)
 				pixels[x + y * EnvLightVisibilityCache::defaultLuminanceMapWidth] = ComputeRadiance(UniformSampleSphere(
 						(y + .5f) / EnvLightVisibilityCache::defaultLuminanceMapHeight,
@@ -506,6 +720,9 @@ Properties SkyLight2::ToProperties(const ImageMapCache &imgMapCache, const bool
 	props.Set(Property(prefix + ".ground.autoscale")(hasGroundAutoScale));
 	props.Set(Property(prefix + ".distribution.width")(distributionWidth));
 	props.Set(Property(prefix + ".distribution.height")(distributionHeight));
+	props.Set(Property(prefix + ".radiancetable.enable")(useRadianceTable));
+	props.Set(Property(prefix + ".radiancetable.width")(radianceTableWidth));
+	props.Set(Property(prefix + ".radiancetable.height")(radianceTableHeight));
 
 	props.Set(Property(prefix + ".visibilitymapcache.enable")(useVisibilityMapCache));
 	if (useVisibilityMapCache)
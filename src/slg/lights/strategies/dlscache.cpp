@@ -46,6 +46,14 @@ void LightStrategyDLSCache::Preprocess(const Scene *scn, const LightStrategyTask
 		DLSCache.Build(scn);
 }
 
+void LightStrategyDLSCache::StopPreprocess() {
+	DLSCache.StopBuild();
+}
+
+void LightStrategyDLSCache::ResumePreprocess() {
+	DLSCache.ResumeBuild();
+}
+
 LightSource *LightStrategyDLSCache::SampleLights(const float u,
 			const Point &p, const Normal &n,
 			const bool isVolume,
@@ -100,7 +108,8 @@ Properties LightStrategyDLSCache::ToProperties() const {
 			Property("lightstrategy.maxdepth")(params.visibility.maxPathDepth) <<
 			Property("lightstrategy.maxsamplescount")(params.visibility.maxSampleCount) <<
 			Property("lightstrategy.persistent.file")(params.persistent.fileName) <<
-			Property("lightstrategy.persistent.safesave")(params.persistent.safeSave);
+			Property("lightstrategy.persistent.safesave")(params.persistent.safeSave) <<
+			Property("lightstrategy.progressive.enable")(params.progressive);
 }
 
 // Static methods used by LightStrategyRegistry
@@ -117,7 +126,8 @@ Properties LightStrategyDLSCache::ToProperties(const Properties &cfg) {
 			cfg.Get(GetDefaultProps().Get("lightstrategy.maxdepth")) <<
 			cfg.Get(GetDefaultProps().Get("lightstrategy.maxsamplescount")) <<
 			cfg.Get(GetDefaultProps().Get("lightstrategy.persistent.file")) <<
-			cfg.Get(GetDefaultProps().Get("lightstrategy.persistent.safesave"));
+			cfg.Get(GetDefaultProps().Get("lightstrategy.persistent.safesave")) <<
+			cfg.Get(GetDefaultProps().Get("lightstrategy.progressive.enable"));
 }
 
 LightStrategy *LightStrategyDLSCache::FromProperties(const Properties &cfg) {
@@ -136,6 +146,8 @@ LightStrategy *LightStrategyDLSCache::FromProperties(const Properties &cfg) {
 	params.persistent.fileName = cfg.Get(GetDefaultProps().Get("lightstrategy.persistent.file")).Get<string>();
 	params.persistent.safeSave = cfg.Get(GetDefaultProps().Get("lightstrategy.persistent.safesave")).Get<bool>();
 
+	params.progressive = cfg.Get(GetDefaultProps().Get("lightstrategy.progressive.enable")).Get<bool>();
+
 	return new LightStrategyDLSCache(params);
 }
 
@@ -152,7 +164,8 @@ const Properties &LightStrategyDLSCache::GetDefaultProps() {
 			Property("lightstrategy.maxdepth")(4) <<
 			Property("lightstrategy.maxsamplescount")(10000000) <<
 			Property("lightstrategy.persistent.file")("") <<
-			Property("lightstrategy.persistent.safesave")(true);
+			Property("lightstrategy.persistent.safesave")(true) <<
+			Property("lightstrategy.progressive.enable")(false);
 
 	return props;
 }
@@ -40,16 +40,23 @@ using namespace luxrays;
 using namespace slg;
 
 #define NEIGHBORS_RADIUS_SCALE 1.5f
+// Number of light sources evaluated by a single received luminance work item
+#define LIGHTS_BLOCK_SIZE 64
+// Number of entries (in bvh leaf order) filled before publishing them
+#define REGION_SIZE (64 * INDEXBVH_QUERY_BATCH_SIZE)
 
 //------------------------------------------------------------------------------
 // DirectLightSamplingCache
 //------------------------------------------------------------------------------
 
 DirectLightSamplingCache::DirectLightSamplingCache(const DLSCParams &p) :
-		params(p), cacheEntriesBVH(nullptr) {
+		params(p), cacheEntriesBVH(nullptr), buildThread(nullptr),
+		buildInProgress(false), buildStopFlag(false), fillNextRegionStart(0) {
 }
 
 DirectLightSamplingCache::~DirectLightSamplingCache() {
+	StopBuild();
+
 	delete cacheEntriesBVH;
 }
 
@@ -123,42 +130,28 @@ protected:
 	virtual bool ProcessHitPoint(const BSDF &bsdf, const PathVolumeInfo &volInfo,
 			vector<DLSCVisibilityParticle> &visibilityParticles) const {
 		if (dslc.IsCacheEnabled(bsdf))
-			visibilityParticles.push_back(DLSCVisibilityParticle(bsdf, volInfo));
+			visibilityParticles.push_back(DLSCVisibilityParticle(*scene, bsdf, volInfo));
 
 		return true;
 	}
 
-	virtual bool ProcessVisibilityParticle(const DLSCVisibilityParticle &vp,
-			vector<DLSCVisibilityParticle> &visibilityParticles,
-			IndexOctree<DLSCVisibilityParticle> *octree, const float maxDistance2) const {
-		DLSCOctree *particlesOctree = (DLSCOctree *)octree;
+	virtual u_int GetNearestEntry(const DLSCVisibilityParticle &vp,
+			const IndexOctree<DLSCVisibilityParticle> *octree, float *distance2) const {
+		const DLSCOctree *particlesOctree = (const DLSCOctree *)octree;
 
 		// Check if a cache entry is available for this point
-		const u_int entryIndex = particlesOctree->GetNearestEntry(vp.bsdfList[0].hitPoint.p,
-				vp.bsdfList[0].hitPoint.GetLandingShadeN(), vp.bsdfList[0].IsVolume());
-
-		if (entryIndex == NULL_INDEX) {
-			// Add as a new entry
-			visibilityParticles.push_back(vp);
-			particlesOctree->Add(visibilityParticles.size() - 1);
-
-			return false;
-		} else {
-			DLSCVisibilityParticle &entry = visibilityParticles[entryIndex];
-			const float distance2 = DistanceSquared(vp.bsdfList[0].hitPoint.p, entry.bsdfList[0].hitPoint.p);
-
-			if (distance2 > maxDistance2) {
-				// Add as a new entry
-				visibilityParticles.push_back(vp);
-				particlesOctree->Add(visibilityParticles.size() - 1);
-				
-				return false;
-			} else {
-				entry.Add(vp);
-				
-				return true;
-			}
-		}
+		const VisibilityPoint &point = vp.pointList.GetPoint(0);
+		const u_int entryIndex = particlesOctree->GetNearestEntry(point.p,
+				point.GetLandingShadeN(), point.IsVolume());
+		if (entryIndex != NULL_INDEX)
+			*distance2 = DistanceSquared(point.p, visibilityParticles[entryIndex].pointList.GetPoint(0).p);
+
+		return entryIndex;
+	}
+
+	virtual void AddToEntry(DLSCVisibilityParticle &entry, const DLSCVisibilityParticle &vp,
+			const float distance2) const {
+		entry.Add(vp);
 	}
 	
 	DirectLightSamplingCache &dslc;
@@ -182,7 +175,7 @@ void DirectLightSamplingCache::TraceVisibilityParticles() {
 //------------------------------------------------------------------------------
 
 void DirectLightSamplingCache::InitCacheEntry(const u_int entryIndex) {
-	cacheEntries[entryIndex] = DLSCacheEntry(visibilityParticles[entryIndex].bsdfList[0]);
+	cacheEntries[entryIndex] = DLSCacheEntry(visibilityParticles[entryIndex].pointList.GetPoint(0));
 }
 
 float DirectLightSamplingCache::SampleLight(const DLSCVisibilityParticle &visibilityParticle,
@@ -194,9 +187,11 @@ float DirectLightSamplingCache::SampleLight(const DLSCVisibilityParticle &visibi
 	const float time = RadicalInverse(pass, 13);
 
 	// Select a sampling point
-	const size_t bsdfListSize = visibilityParticle.bsdfList.size();
-	const u_int bsdfListIndexIndex = Min<u_int>(Floor2UInt(u4 * bsdfListSize), bsdfListSize - 1);
-	const BSDF &samplingBSDF = visibilityParticle.bsdfList[bsdfListIndexIndex];
+	const VisibilityPointList &pointList = visibilityParticle.pointList;
+	const size_t pointListSize = pointList.GetSize();
+	const u_int pointIndex = Min<u_int>(Floor2UInt(u4 * pointListSize), pointListSize - 1);
+	BSDF samplingBSDF;
+	pointList.GetPoint(pointIndex).GetBSDF(*scene, samplingBSDF);
 
 	Ray shadowRay;
 	float directPdfW;
@@ -215,7 +210,7 @@ float DirectLightSamplingCache::SampleLight(const DLSCVisibilityParticle &visibi
 		Spectrum connectionThroughput;
 
 		// Check if the light source is visible
-		PathVolumeInfo volInfo = visibilityParticle.volInfoList[bsdfListIndexIndex];
+		PathVolumeInfo volInfo = pointList.GetVolInfo(pointIndex);
 		if (!scene->Intersect(nullptr, EYE_RAY | SHADOW_RAY, &volInfo, u5, &shadowRay,
 				&shadowRayHit, &shadowBsdf, &connectionThroughput, nullptr,
 				nullptr, true)) {
@@ -231,7 +226,8 @@ float DirectLightSamplingCache::SampleLight(const DLSCVisibilityParticle &visibi
 	return 0.f;
 }
 
-void DirectLightSamplingCache::ComputeCacheEntryReceivedLuminance(const u_int entryIndex) {
+void DirectLightSamplingCache::ComputeCacheEntryReceivedLuminance(const u_int entryIndex,
+		const u_int lightIndexStart, const u_int lightIndexEnd) {
 	const DLSCVisibilityParticle &visibilityParticle = visibilityParticles[entryIndex];
 	const vector<LightSource *> &lights = scene->lightDefs.GetLightSources();
 
@@ -244,7 +240,7 @@ void DirectLightSamplingCache::ComputeCacheEntryReceivedLuminance(const u_int en
 	// For some Debugging
 	//SLG_LOG("DLSC entry #" << entryIndex);
 
-	for (u_int lightIndex = 0; lightIndex < lights.size(); ++lightIndex) {
+	for (u_int lightIndex = lightIndexStart; lightIndex < lightIndexEnd; ++lightIndex) {
 		const LightSource *light = lights[lightIndex];
 	
 		// Check if the light source uses direct light sampling
@@ -255,8 +251,8 @@ void DirectLightSamplingCache::ComputeCacheEntryReceivedLuminance(const u_int en
 
 		// Check if I can avoid to trace all shadow rays
 		bool isAlwaysInShadow = true;
-		for (const BSDF &bsdf : visibilityParticle.bsdfList) {
-			if (!light->IsAlwaysInShadow(*scene, bsdf.hitPoint.p, bsdf.hitPoint.GetLandingShadeN())) {
+		for (const VisibilityPoint &vp : visibilityParticle.pointList) {
+			if (!light->IsAlwaysInShadow(*scene, vp.p, vp.GetLandingShadeN())) {
 				isAlwaysInShadow = false;
 				break;
 			}
@@ -311,15 +307,11 @@ void DirectLightSamplingCache::ComputeCacheEntryReceivedLuminance(const u_int en
 	}
 }
 
-void DirectLightSamplingCache::BuildCacheEntryLightDistribution(const u_int entryIndex, const DLSCBvh &bvh) {
+void DirectLightSamplingCache::BuildCacheEntryLightDistribution(const u_int entryIndex,
+		const vector<u_int> &allNearEntryIndices) {
 	const vector<LightSource *> &lights = scene->lightDefs.GetLightSources();
 
-	DLSCacheEntry &entry = cacheEntries[entryIndex];
 	vector<float> entryReceivedLuminance(lights.size(), 0.f);
-	
-	// Look for all neighbor particles
-	vector<u_int> allNearEntryIndices;
-	bvh.GetAllNearEntries(allNearEntryIndices, entry.p, entry.n, entry.isVolume);
 
 	// Merge near entries (including my self)
 	for (auto index : allNearEntryIndices) {
@@ -352,7 +344,16 @@ void DirectLightSamplingCache::BuildCacheEntryLightDistribution(const u_int entr
 	}
 }
 
-void DirectLightSamplingCache::BuildCacheEntries() {
+void DirectLightSamplingCache::InitCacheEntries() {
+	cacheEntries.resize(visibilityParticles.size());
+	cacheEntriesReady.reset(new boost::atomic<bool>[cacheEntries.size()]);
+	for (u_int i = 0; i < cacheEntries.size(); ++i) {
+		InitCacheEntry(i);
+		cacheEntriesReady[i] = false;
+	}
+}
+
+void DirectLightSamplingCache::FillCacheEntries() {
 	//--------------------------------------------------------------------------
 	// Print the number of light with enabled direct light sampling
 	//--------------------------------------------------------------------------
@@ -366,107 +367,227 @@ void DirectLightSamplingCache::BuildCacheEntries() {
 		if (light->IsDirectLightSamplingEnabled())
 			++dlsLightCount;
 	}
-	SLG_LOG("Building direct light sampling cache: filling cache entries with " << dlsLightCount << " light sources");
 
-	//--------------------------------------------------------------------------
-	// Initialize visibilityParticlesReceivedLuminance vector
-	//--------------------------------------------------------------------------
+	// Build a bvh to find all neighbor entries (i.e. distance < NEIGHBORS_RADIUS_SCALE * radius)
+	DLSCBvh bvh(&cacheEntries, NEIGHBORS_RADIUS_SCALE * params.visibility.lookUpRadius,
+			params.visibility.lookUpNormalAngle);
+
+	if (fillLeafOrderEntryIndices.size() == 0) {
+		SLG_LOG("Building direct light sampling cache: filling cache entries with " << dlsLightCount << " light sources");
+
+		//----------------------------------------------------------------------
+		// Initialize visibilityParticlesReceivedLuminance vector
+		//----------------------------------------------------------------------
+
+		cacheEntriesReceivedLuminance.resize(visibilityParticles.size());
+		for (u_int visibilityParticleIndex = 0; visibilityParticleIndex < visibilityParticles.size(); ++visibilityParticleIndex)
+			cacheEntriesReceivedLuminance[visibilityParticleIndex].resize(lights.size(), 0.f);
+
+		bvh.GetLeafOrderEntryIndices(fillLeafOrderEntryIndices);
+		fillReceivedLuminanceDone.resize(fillLeafOrderEntryIndices.size(), false);
+		fillNextRegionStart = 0;
+	} else
+		SLG_LOG("Building direct light sampling cache: resuming the fill of cache entries from " << fillNextRegionStart);
 
-	cacheEntriesReceivedLuminance.resize(visibilityParticles.size());
-	for (u_int visibilityParticleIndex = 0; visibilityParticleIndex < visibilityParticles.size(); ++visibilityParticleIndex)
-		cacheEntriesReceivedLuminance[visibilityParticleIndex].resize(lights.size(), 0.f);
-		
 	//--------------------------------------------------------------------------
-	// Initialize compute the cache entries received luminance
+	// Fill the cache entries, one region of spatially close entries (i.e. in
+	// the bvh leaf order) at time. The entries of a region are available for
+	// the rendering as soon as the region is done.
 	//--------------------------------------------------------------------------
 
-	{
-		const double startTime = WallClockTime();
-		double lastPrintTime = startTime;
-		atomic<u_int> counter(0);
+	const vector<u_int> &leafOrderEntryIndices = fillLeafOrderEntryIndices;
+	const u_int entryCount = leafOrderEntryIndices.size();
+
+	// The received luminance work is split in (entry, block of lights) items
+	// in order to balance the load with scenes with many light sources
+	const u_int lightsBlockCount = (lights.size() + LIGHTS_BLOCK_SIZE - 1) / LIGHTS_BLOCK_SIZE;
+	vector<bool> &receivedLuminanceDone = fillReceivedLuminanceDone;
 
-		cacheEntries.resize(visibilityParticles.size());
+	const double startTime = WallClockTime();
+	const u_int startRegion = fillNextRegionStart;
+	double lastPrintTime = startTime;
+	for (u_int regionStart = fillNextRegionStart; regionStart < entryCount; regionStart += REGION_SIZE) {
+		const u_int regionSize = Min<u_int>(entryCount - regionStart, REGION_SIZE);
+		const u_int batchCount = (regionSize + INDEXBVH_QUERY_BATCH_SIZE - 1) / INDEXBVH_QUERY_BATCH_SIZE;
+
+		// Look for all neighbor entries
+		vector<vector<u_int> > allNearEntryIndices(regionSize);
 		#pragma omp parallel for
 		for (
 				// Visual C++ 2013 supports only OpenMP 2.5
 #if _OPENMP >= 200805
 				unsigned
 #endif
-				int i = 0; i < visibilityParticles.size(); ++i) {
-			const int tid =
-#if defined(_OPENMP)
-				omp_get_thread_num()
-#else
-				0
-#endif
-				;
-
-			if (tid == 0) {
-				const double now = WallClockTime();
-				if (now - lastPrintTime > 2.0) {
-					SLG_LOG("DirectLightSamplingCache compute received luminance: " << counter << "/" << visibilityParticles.size() <<" (" <<
-							(boost::format("%.2f entries/sec, ") % (counter / (now - startTime))) <<
-							(u_int)((100.0 * counter) / visibilityParticles.size()) << "%)");
-					lastPrintTime = now;
+				int i = 0; i < batchCount; ++i) {
+			const u_int batchStart = i * INDEXBVH_QUERY_BATCH_SIZE;
+			const u_int batchSize = Min<u_int>(regionSize - batchStart, INDEXBVH_QUERY_BATCH_SIZE);
+
+			bvh.GetAllNearEntries(&allNearEntryIndices[batchStart],
+					&leafOrderEntryIndices[regionStart + batchStart], batchSize);
+		}
+
+		// Compute the received luminance of the region entries and of their
+		// neighbors if it has not been already done
+		vector<u_int> todoEntryIndices;
+		for (auto const &nearEntryIndices : allNearEntryIndices) {
+			for (auto index : nearEntryIndices) {
+				if (!receivedLuminanceDone[index]) {
+					receivedLuminanceDone[index] = true;
+					todoEntryIndices.push_back(index);
 				}
 			}
+		}
 
-			InitCacheEntry(i);
-			ComputeCacheEntryReceivedLuminance(i);
+		const u_int workCount = todoEntryIndices.size() * lightsBlockCount;
+		#pragma omp parallel for schedule(dynamic, 1)
+		for (
+				// Visual C++ 2013 supports only OpenMP 2.5
+#if _OPENMP >= 200805
+				unsigned
+#endif
+				int i = 0; i < workCount; ++i) {
+			if (buildStopFlag)
+				continue;
 
-			++counter;
-		}
-	}
-	//--------------------------------------------------------------------------
-	// Merge cache entries received luminance and initialize light distributions
-	//--------------------------------------------------------------------------
+			const u_int entryIndex = todoEntryIndices[i / lightsBlockCount];
+			const u_int lightIndexStart = (i % lightsBlockCount) * LIGHTS_BLOCK_SIZE;
+			const u_int lightIndexEnd = Min<u_int>(lightIndexStart + LIGHTS_BLOCK_SIZE, lights.size());
 
-	{
-		// Build a bvh to find all neighbor entries (i.e. distance < NEIGHBORS_RADIUS_SCALE * radius)
-		DLSCBvh bvh(&cacheEntries, NEIGHBORS_RADIUS_SCALE * params.visibility.lookUpRadius,
-				params.visibility.lookUpNormalAngle);
+			ComputeCacheEntryReceivedLuminance(entryIndex, lightIndexStart, lightIndexEnd);
+		}
 
-		const double startTime = WallClockTime();
-		double lastPrintTime = startTime;
-		atomic<u_int> counter(0);
+		if (buildStopFlag) {
+			// The work of the region has been interrupted so it has to be
+			// done again when the build is resumed
+			for (auto index : todoEntryIndices)
+				receivedLuminanceDone[index] = false;
+			return;
+		}
 
+		// Merge cache entries received luminance and initialize light distributions
 		#pragma omp parallel for
 		for (
 				// Visual C++ 2013 supports only OpenMP 2.5
 #if _OPENMP >= 200805
 				unsigned
 #endif
-				int i = 0; i < visibilityParticles.size(); ++i) {
-			const int tid =
-#if defined(_OPENMP)
-				omp_get_thread_num()
-#else
-				0
-#endif
-				;
-
-			if (tid == 0) {
-				const double now = WallClockTime();
-				if (now - lastPrintTime > 2.0) {
-					SLG_LOG("DirectLightSamplingCache build light distribution: " << counter << "/" << visibilityParticles.size() <<" (" <<
-							(boost::format("%.2f entries/sec, ") % (counter / (now - startTime))) <<
-							(u_int)((100.0 * counter) / visibilityParticles.size()) << "%)");
-					lastPrintTime = now;
-				}
-			}
+				int i = 0; i < regionSize; ++i) {
+			const u_int entryIndex = leafOrderEntryIndices[regionStart + i];
+
+			BuildCacheEntryLightDistribution(entryIndex, allNearEntryIndices[i]);
+
+			// Publish the entry
+			cacheEntriesReady[entryIndex].store(true, boost::memory_order_release);
+		}
+
+		fillNextRegionStart = regionStart + regionSize;
+
+		const double now = WallClockTime();
+		if (now - lastPrintTime > 2.0) {
+			const u_int counter = regionStart + regionSize;
+			SLG_LOG("DirectLightSamplingCache filled entries: " << counter << "/" << entryCount <<" (" <<
+					(boost::format("%.2f entries/sec, ") % ((counter - startRegion) / (now - startTime))) <<
+					(u_int)((100.0 * counter) / entryCount) << "%)");
+			lastPrintTime = now;
+		}
+	}
+}
+
+void DirectLightSamplingCache::FinishBuild() {
+	//--------------------------------------------------------------------------
+	// Free memory
+	//--------------------------------------------------------------------------
 
-			BuildCacheEntryLightDistribution(i, bvh);
+	visibilityParticles.clear();
+	visibilityParticles.shrink_to_fit();
+	cacheEntriesReceivedLuminance.clear();
+	cacheEntriesReceivedLuminance.shrink_to_fit();
+	fillLeafOrderEntryIndices.clear();
+	fillLeafOrderEntryIndices.shrink_to_fit();
+	fillReceivedLuminanceDone.clear();
+	fillReceivedLuminanceDone.shrink_to_fit();
 
-			++counter;
+	//--------------------------------------------------------------------------
+	// Check if I have to save the persistent cache
+	//--------------------------------------------------------------------------
+
+	if (params.persistent.fileName != "")
+		SavePersistentCache(params.persistent.fileName);
+
+	// Export the entries for debugging
+	//DebugExport("entries-point.scn", entryRadius * .05f);
+}
+
+void DirectLightSamplingCache::BuildThreadFunc() {
+	const double startTime = WallClockTime();
+
+	try {
+		FillCacheEntries();
+
+		if (buildStopFlag) {
+			// The build can be resumed later
+			SLG_LOG("DirectLightSamplingCache background build stopped");
+			return;
 		}
+
+		FinishBuild();
+	} catch (exception &e) {
+		SLG_LOG("Error while building DirectLightSamplingCache: " << e.what());
+	}
+
+	const double dt = WallClockTime() - startTime;
+	SLG_LOG("DirectLightSamplingCache background build done in: " << std::setprecision(3) << dt << " secs");
+
+	// All the filled entries are now visible without checking cacheEntriesReady
+	buildInProgress.store(false, boost::memory_order_release);
+}
+
+void DirectLightSamplingCache::StopBuild() {
+	boost::unique_lock<boost::mutex> lock(buildThreadMutex);
+
+	if (buildThread) {
+		buildStopFlag = true;
+		if (buildThread->joinable())
+			buildThread->join();
+
+		delete buildThread;
+		buildThread = nullptr;
+	}
+}
+
+void DirectLightSamplingCache::ResumeBuild() {
+	boost::unique_lock<boost::mutex> lock(buildThreadMutex);
+
+	// Check if there is a stopped progressive build to complete
+	if (buildInProgress && !buildThread) {
+		buildStopFlag = false;
+		buildThread = new boost::thread(&DirectLightSamplingCache::BuildThreadFunc, this);
 	}
 }
 
+void DirectLightSamplingCache::WaitForBuild() const {
+	boost::unique_lock<boost::mutex> lock(buildThreadMutex);
+
+	if (buildThread && buildThread->joinable())
+		buildThread->join();
+}
+
 //------------------------------------------------------------------------------
 // Build
 //------------------------------------------------------------------------------
 
 void DirectLightSamplingCache::Build(const Scene *scn) {
+	// Stop any previous progressive build and free the old cache
+	StopBuild();
+	buildStopFlag = false;
+	buildInProgress = false;
+	delete cacheEntriesBVH;
+	cacheEntriesBVH = nullptr;
+	cacheEntries.clear();
+	fillLeafOrderEntryIndices.clear();
+	fillReceivedLuminanceDone.clear();
+	fillNextRegionStart = 0;
+
 	scene = scn;
 
 	if (scene->lightDefs.GetSize() == 0)
@@ -506,24 +627,11 @@ void DirectLightSamplingCache::Build(const Scene *scn) {
 	TraceVisibilityParticles();
 
 	//--------------------------------------------------------------------------
-	// Build cache entries
+	// Initialize cache entries and their BVH
 	//--------------------------------------------------------------------------
 
 	if (visibilityParticles.size() > 0)
-		BuildCacheEntries();
-
-	//--------------------------------------------------------------------------
-	// Free memory
-	//--------------------------------------------------------------------------
-
-	visibilityParticles.clear();
-	visibilityParticles.shrink_to_fit();
-	cacheEntriesReceivedLuminance.clear();
-	cacheEntriesReceivedLuminance.shrink_to_fit();
-
-	//--------------------------------------------------------------------------
-	// Build cache entries BVH
-	//--------------------------------------------------------------------------
+		InitCacheEntries();
 
 	if (cacheEntries.size() > 0) {
 		SLG_LOG("DirectLightSamplingCache building cache entries BVH");
@@ -533,14 +641,25 @@ void DirectLightSamplingCache::Build(const Scene *scn) {
 		SLG_LOG("WARNING: DirectLightSamplingCache has an empty cache");
 
 	//--------------------------------------------------------------------------
-	// Check if I have to save the persistent cache
+	// Fill cache entries
 	//--------------------------------------------------------------------------
 
-	if (params.persistent.fileName != "")
-		SavePersistentCache(params.persistent.fileName);
+	if (params.progressive && (cacheEntries.size() > 0)) {
+		// Start the rendering with the power based light sampling and fill
+		// the entries in background
+		SLG_LOG("DirectLightSamplingCache filling cache entries in background");
 
-	// Export the entries for debugging
-	//DebugExport("entries-point.scn", entryRadius * .05f);
+		boost::unique_lock<boost::mutex> lock(buildThreadMutex);
+
+		buildStopFlag = false;
+		buildInProgress = true;
+		buildThread = new boost::thread(&DirectLightSamplingCache::BuildThreadFunc, this);
+	} else {
+		if (cacheEntries.size() > 0)
+			FillCacheEntries();
+
+		FinishBuild();
+	}
 }
 
 const Distribution1D *DirectLightSamplingCache::GetLightDistribution(const luxrays::Point &p,
@@ -548,8 +667,14 @@ const Distribution1D *DirectLightSamplingCache::GetLightDistribution(const luxra
 	if (cacheEntriesBVH) {
 		const DLSCacheEntry *entry = cacheEntriesBVH->GetNearestEntry(p, n, isVolume);
 
-		if (entry)
+		if (entry) {
+			// Check if the entry has already been filled by the progressive build
+			if (buildInProgress.load(boost::memory_order_acquire) &&
+					!cacheEntriesReady[entry - &cacheEntries[0]].load(boost::memory_order_acquire))
+				return nullptr;
+
 			return entry->lightsDistribution;
+		}
 	}
 	
 	return nullptr;
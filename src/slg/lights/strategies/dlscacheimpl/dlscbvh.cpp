@@ -43,76 +43,48 @@ const DLSCacheEntry *DLSCBvh::GetNearestEntry(const Point &p, const Normal &n, c
 	const DLSCacheEntry *nearestEntry = nullptr;
 	float nearestDistance2 = entryRadius2;
 
-	u_int currentNode = 0; // Root Node
-	const u_int stopNode = BVHNodeData_GetSkipIndex(arrayNodes[0].nodeData); // Non-existent
-
-	while (currentNode < stopNode) {
-		const luxrays::ocl::IndexBVHArrayNode &node = arrayNodes[currentNode];
-
-		const u_int nodeData = node.nodeData;
-		if (BVHNodeData_IsLeaf(nodeData)) {
-			// It is a leaf, check the entry
-			const DLSCacheEntry *entry = &((*allEntries)[node.entryLeaf.entryIndex]);
-
-			const float distance2 = DistanceSquared(p, entry->p);
-			if ((distance2 < nearestDistance2) && (isVolume == entry->isVolume) &&
-					(isVolume || (Dot(n, entry->n) > normalCosAngle))) {
-				// I have found a valid nearer entry
-				nearestEntry = entry;
-				nearestDistance2 = distance2;
-			}
-
-			++currentNode;
-		} else {
-			// It is a node, check the bounding box
-			if (p.x >= node.bvhNode.bboxMin[0] && p.x <= node.bvhNode.bboxMax[0] &&
-					p.y >= node.bvhNode.bboxMin[1] && p.y <= node.bvhNode.bboxMax[1] &&
-					p.z >= node.bvhNode.bboxMin[2] && p.z <= node.bvhNode.bboxMax[2])
-				++currentNode;
-			else {
-				// I don't need to use IndexBVHNodeData_GetSkipIndex() here because
-				// I already know the leaf flag is 0
-				currentNode = nodeData;
-			}
+	ForEachNearEntry(p, [&](const u_int entryIndex, const float distance2) {
+		const DLSCacheEntry *entry = &((*allEntries)[entryIndex]);
+
+		if ((distance2 < nearestDistance2) && (isVolume == entry->isVolume) &&
+				(isVolume || (Dot(n, entry->n) > normalCosAngle))) {
+			// I have found a valid nearer entry
+			nearestEntry = entry;
+			nearestDistance2 = distance2;
 		}
-	}
+	});
 
 	return nearestEntry;
 }
 
 void DLSCBvh::GetAllNearEntries(vector<u_int> &allNearEntryIndices,
 		const Point &p, const Normal &n, const bool isVolume) const {
-	u_int currentNode = 0; // Root Node
-	const u_int stopNode = BVHNodeData_GetSkipIndex(arrayNodes[0].nodeData); // Non-existent
-
-	while (currentNode < stopNode) {
-		const luxrays::ocl::IndexBVHArrayNode &node = arrayNodes[currentNode];
-
-		const u_int nodeData = node.nodeData;
-		if (BVHNodeData_IsLeaf(nodeData)) {
-			// It is a leaf, check the entry
-			const u_int entryIndex = node.entryLeaf.entryIndex;
-			const DLSCacheEntry *entry = &((*allEntries)[entryIndex]);
-
-			const float distance2 = DistanceSquared(p, entry->p);
-			if ((distance2 < entryRadius2) && (isVolume == entry->isVolume) &&
-					(isVolume || (Dot(n, entry->n) > normalCosAngle))) {
-				// I have found a valid nearer entry
-				allNearEntryIndices.push_back(entryIndex);
-			}
-
-			++currentNode;
-		} else {
-			// It is a node, check the bounding box
-			if (p.x >= node.bvhNode.bboxMin[0] && p.x <= node.bvhNode.bboxMax[0] &&
-					p.y >= node.bvhNode.bboxMin[1] && p.y <= node.bvhNode.bboxMax[1] &&
-					p.z >= node.bvhNode.bboxMin[2] && p.z <= node.bvhNode.bboxMax[2])
-				++currentNode;
-			else {
-				// I don't need to use IndexBVHNodeData_GetSkipIndex() here because
-				// I already know the leaf flag is 0
-				currentNode = nodeData;
-			}
+	ForEachNearEntry(p, [&](const u_int entryIndex, const float) {
+		const DLSCacheEntry *entry = &((*allEntries)[entryIndex]);
+
+		if ((isVolume == entry->isVolume) &&
+				(isVolume || (Dot(n, entry->n) > normalCosAngle))) {
+			// I have found a valid near entry
+			allNearEntryIndices.push_back(entryIndex);
+		}
+	});
+}
+
+void DLSCBvh::GetAllNearEntries(vector<u_int> *allNearEntryIndices,
+		const u_int *queryEntryIndices, const u_int count) const {
+	vector<Point> queryPoints(count);
+	for (u_int i = 0; i < count; ++i)
+		queryPoints[i] = (*allEntries)[queryEntryIndices[i]].p;
+
+	ForEachNearEntry(&queryPoints[0], count, [&](const u_int queryIndex,
+			const u_int entryIndex, const float) {
+		const DLSCacheEntry &queryEntry = (*allEntries)[queryEntryIndices[queryIndex]];
+		const DLSCacheEntry &entry = (*allEntries)[entryIndex];
+
+		if ((queryEntry.isVolume == entry.isVolume) &&
+				(queryEntry.isVolume || (Dot(queryEntry.n, entry.n) > normalCosAngle))) {
+			// I have found a valid near entry
+			allNearEntryIndices[queryIndex].push_back(entryIndex);
 		}
-	}
+	});
 }
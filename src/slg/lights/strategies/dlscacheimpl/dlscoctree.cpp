@@ -67,11 +67,11 @@ void DLSCOctree::GetNearestEntryImpl(const IndexOctreeNode *node, const BBox &no
 	for (auto const &entryIndex : node->entriesIndex) {
 		const DLSCVisibilityParticle &entry = allEntries[entryIndex];
 
-		const BSDF &bsdf = entry.bsdfList[0];
-		const Normal landingNormal = bsdf.hitPoint.GetLandingShadeN();
-		const float distance2 = DistanceSquared(p, bsdf.hitPoint.p);
-		if ((distance2 < nearestDistance2) && (isVolume == bsdf.IsVolume()) &&
-				(bsdf.IsVolume() || (Dot(n, landingNormal) >= entryNormalCosAngle))) {
+		const VisibilityPoint &vp = entry.pointList.GetPoint(0);
+		const Normal landingNormal = vp.GetLandingShadeN();
+		const float distance2 = DistanceSquared(p, vp.p);
+		if ((distance2 < nearestDistance2) && (isVolume == vp.IsVolume()) &&
+				(vp.IsVolume() || (Dot(n, landingNormal) >= entryNormalCosAngle))) {
 			// I have found a valid nearer entry
 			nearestEntryIndex = entryIndex;
 			nearestDistance2 = distance2;
@@ -79,11 +79,11 @@ void ELVCOctree::GetNearestEntryImpl(const IndexOctreeNode *node, const BBox &no
 	for (auto const &entryIndex : node->entriesIndex) {
 		const ELVCVisibilityParticle &entry = allEntries[entryIndex];
 
-		const BSDF &bsdf = entry.bsdfList[0];
-		const Normal landingNormal = bsdf.hitPoint.GetLandingShadeN();
-		const float distance2 = DistanceSquared(p, bsdf.hitPoint.p);
-		if ((distance2 < nearestDistance2) && (isVolume == bsdf.IsVolume()) &&
-				(bsdf.IsVolume() || (Dot(n, landingNormal) >= entryNormalCosAngle))) {
+		const VisibilityPoint &vp = entry.pointList.GetPoint(0);
+		const Normal landingNormal = vp.GetLandingShadeN();
+		const float distance2 = DistanceSquared(p, vp.p);
+		if ((distance2 < nearestDistance2) && (isVolume == vp.IsVolume()) &&
+				(vp.IsVolume() || (Dot(n, landingNormal) >= entryNormalCosAngle))) {
 			// I have found a valid nearer entry
 			nearestEntryIndex = entryIndex;
 			nearestDistance2 = distance2;
@@ -227,42 +227,28 @@ protected:
 	virtual bool ProcessHitPoint(const BSDF &bsdf, const PathVolumeInfo &volInfo,
 			vector<ELVCVisibilityParticle> &visibilityParticles) const {
 		if (elvc.IsCacheEnabled(bsdf))
-			visibilityParticles.push_back(ELVCVisibilityParticle(bsdf, volInfo));
+			visibilityParticles.push_back(ELVCVisibilityParticle(*scene, bsdf, volInfo));
 
 		return true;
 	}
 
-	virtual bool ProcessVisibilityParticle(const ELVCVisibilityParticle &vp,
-			vector<ELVCVisibilityParticle> &visibilityParticles,
-			IndexOctree<ELVCVisibilityParticle> *octree, const float maxDistance2) const {
-		ELVCOctree *particlesOctree = (ELVCOctree *)octree;
+	virtual u_int GetNearestEntry(const ELVCVisibilityParticle &vp,
+			const IndexOctree<ELVCVisibilityParticle> *octree, float *distance2) const {
+		const ELVCOctree *particlesOctree = (const ELVCOctree *)octree;
 
 		// Check if a cache entry is available for this point
-		const u_int entryIndex = particlesOctree->GetNearestEntry(vp.bsdfList[0].hitPoint.p,
-				vp.bsdfList[0].hitPoint.GetLandingShadeN(), vp.bsdfList[0].IsVolume());
+		const VisibilityPoint &point = vp.pointList.GetPoint(0);
+		const u_int entryIndex = particlesOctree->GetNearestEntry(point.p,
+				point.GetLandingShadeN(), point.IsVolume());
+		if (entryIndex != NULL_INDEX)
+			*distance2 = DistanceSquared(point.p, visibilityParticles[entryIndex].pointList.GetPoint(0).p);
 
-		if (entryIndex == NULL_INDEX) {
-			// Add as a new entry
-			visibilityParticles.push_back(vp);
-			particlesOctree->Add(visibilityParticles.size() - 1);
-
-			return false;
-		} else {
-			ELVCVisibilityParticle &entry = visibilityParticles[entryIndex];
-			const float distance2 = DistanceSquared(vp.bsdfList[0].hitPoint.p, entry.bsdfList[0].hitPoint.p);
+		return entryIndex;
+	}
 
-			if (distance2 > maxDistance2) {
-				// Add as a new entry
-				visibilityParticles.push_back(vp);
-				particlesOctree->Add(visibilityParticles.size() - 1);
-				
-				return false;
-			} else {
-				entry.Add(vp);
-				
-				return true;
-			}
-		}
+	virtual void AddToEntry(ELVCVisibilityParticle &entry, const ELVCVisibilityParticle &vp,
+			const float distance2) const {
+		entry.Add(vp);
 	}
 	
 	EnvLightVisibilityCache &elvc;
@@ -285,17 +271,18 @@ void EnvLightVisibilityCache::TraceVisibilityParticles() {
 // Build cache entries
 //------------------------------------------------------------------------------
 
-void EnvLightVisibilityCache::BuildCacheEntry(const u_int entryIndex, const ImageMap *luminanceMapImageScaled) {
+void EnvLightVisibilityCache::BuildCacheEntry(const u_int entryIndex) {
 	//const double t1 = WallClockTime();
 
 	const ELVCVisibilityParticle &visibilityParticle = visibilityParticles[entryIndex];
 	ELVCacheEntry &cacheEntry = cacheEntries[entryIndex];
 
 	// Set up the default cache entry
-	const BSDF &firstBsdf = visibilityParticle.bsdfList[0];
-	cacheEntry.p = firstBsdf.hitPoint.p;
-	cacheEntry.n = firstBsdf.hitPoint.GetLandingShadeN();
-	cacheEntry.isVolume = firstBsdf.IsVolume();
+	const VisibilityPointList &pointList = visibilityParticle.pointList;
+	const VisibilityPoint &firstPoint = pointList.GetPoint(0);
+	cacheEntry.p = firstPoint.p;
+	cacheEntry.n = firstPoint.GetLandingShadeN();
+	cacheEntry.isVolume = firstPoint.IsVolume();
 	cacheEntry.visibilityMap = nullptr;
 
 	// Allocate the map storage
@@ -305,6 +292,11 @@ void EnvLightVisibilityCache::BuildCacheEntry(const u_int entryIndex, const Imag
 	fill(visibilityMap, visibilityMap + tilesXCount * tilesYCount, 0.f);
 	vector<u_int> sampleCount(tilesXCount * tilesYCount, 0);
 
+	// Rebuild the light sampling BSDFs only once
+	vector<BSDF> bsdfs(pointList.GetSize());
+	for (u_int i = 0; i < bsdfs.size(); ++i)
+		pointList.GetPoint(i).GetBSDF(*scene, bsdfs[i]);
+
 	// Trace all shadow rays
 	const u_int totSamples = tilesXCount * tilesYCount * params.map.tileSampleCount;
 	for (u_int pass = 1; pass <= totSamples; ++pass) {
@@ -316,10 +308,10 @@ void EnvLightVisibilityCache::BuildCacheEntry(const u_int entryIndex, const Imag
 		const float u4 = RadicalInverse(pass, 13);
 
 		// Pick a sampling point index
-		const u_int pointIndex = Min<u_int>(Floor2UInt(u0 * visibilityParticle.bsdfList.size()), visibilityParticle.bsdfList.size() - 1);
+		const u_int pointIndex = Min<u_int>(Floor2UInt(u0 * bsdfs.size()), bsdfs.size() - 1);
 
 		// Pick a sampling point
-		const BSDF &bsdf = visibilityParticle.bsdfList[pointIndex];
+		const BSDF &bsdf = bsdfs[pointIndex];
 
 		// Build local sampling direction
 		Vector localSamplingDir = bsdf.IsVolume() ?
@@ -366,7 +358,7 @@ void EnvLightVisibilityCache::BuildCacheEntry(const u_int entryIndex, const Imag
 		BSDF shadowBsdf;
 		Spectrum connectionThroughput;
 
-		PathVolumeInfo volInfo = visibilityParticle.volInfoList[pointIndex];
+		PathVolumeInfo volInfo = pointList.GetVolInfo(pointIndex);
 		if (!scene->Intersect(nullptr, EYE_RAY | SHADOW_RAY, &volInfo, u4, &shadowRay,
 				&shadowRayHit, &shadowBsdf, &connectionThroughput)) {
 			// Nothing was hit, the light source is visible
@@ -442,45 +434,6 @@ void EnvLightVisibilityCache::BuildCacheEntry(const u_int entryIndex, const Imag
 		visibilityMap[i] = normalizedVisVal;
 	}
 
-	if (luminanceMapImageScaled) {
-		const ImageMapStorage *luminanceMapStorageScaled = luminanceMapImageScaled->GetStorage();
-
-		// For some debug, save the map to a file
-		/*if (entryIndex % 30 == 0) {
-			ImageSpec spec(tilesXCount, tilesYCount, 3, TypeDesc::FLOAT);
-			ImageBuf buffer(spec);
-			float maxVal = -INFINITY;
-			float minVal = INFINITY;
-			for (ImageBuf::ConstIterator<float> it(buffer); !it.done(); ++it) {
-				u_int x = it.x();
-				u_int y = it.y();
-				float *pixel = (float *)buffer.pixeladdr(x, y, 0);
-				const float v = luminanceMapStorageScaled->GetFloat(x + y * tilesXCount);
-
-				maxVal = Max(v, maxVal);
-				minVal = Min(v, minVal);
-
-				pixel[0] = v;
-				pixel[1] = v;
-				pixel[2] = v;
-			}
-			buffer.write("luminance-" + ToString(entryIndex) + ".exr");
-
-			SLG_LOG("Luminance " << entryIndex << " Max=" << maxVal << " Min=" << minVal);
-		}*/
-
-		float luminanceMaxVal = 0.f;
-		for (u_int i = 0; i < mapPixelCount; ++i)
-			luminanceMaxVal = Max(visibilityMaxVal, luminanceMapStorageScaled->GetFloat(i));
-
-		const float invLuminanceMaxVal = 1.f / luminanceMaxVal;
-		for (u_int i = 0; i < mapPixelCount; ++i) {
-			const float normalizedLumiVal = luminanceMapStorageScaled->GetFloat(i) * invLuminanceMaxVal;
-
-			visibilityMap[i] *= normalizedLumiVal;
-		}
-	}
-
 	// For some debug, save the map to a file
 	/*if (entryIndex % 10 == 0) {
 		ImageSpec spec(tilesXCount, tilesYCount, 3, TypeDesc::FLOAT);
@@ -491,7 +444,7 @@ void EnvLightVisibilityCache::BuildCacheEntry(const u_int entryIndex, const Imag
 			u_int x = it.x();
 			u_int y = it.y();
 			float *pixel = (float *)buffer.pixeladdr(x, y, 0);
-			const float v = visibilityMap[x + y * tilesXCount];
+			const float v = visibilityMap[x + y * tilesXCount] * baseMap[x + y * tilesXCount];
 
 			maxVal = Max(v, maxVal);
 			minVal = Min(v, minVal);
@@ -505,7 +458,9 @@ void EnvLightVisibilityCache::BuildCacheEntry(const u_int entryIndex, const Imag
 		SLG_LOG("Map " << entryIndex << " Max=" << maxVal << " Min=" << minVal);
 	}*/
 
-	cacheEntry.visibilityMap = new Distribution2D(&visibilityMap[0], tilesXCount, tilesYCount);
+	// The luminance is applied at sampling time by the shared base map
+	cacheEntry.visibilityMap = ELVCVisibilityMap::Create(&visibilityMap[0], &baseMap[0],
+			tilesXCount, tilesYCount);
 	
 	//const double t3 = WallClockTime();
 	//SLG_LOG("Visibility map rendering times: " << int((t2 - t1) * 1000.0) << "ms + " << int((t3 - t2) * 1000.0) << "ms");
@@ -514,14 +469,20 @@ void EnvLightVisibilityCache::BuildCacheEntry(const u_int entryIndex, const Imag
 void EnvLightVisibilityCache::BuildCacheEntries() {
 	SLG_LOG("EnvLightVisibilityCache building cache entries: " << visibilityParticles.size());
 
-	// Scale the luminance image map to the requested size
-	unique_ptr<ImageMap> luminanceMapImageScaled(nullptr);
+	// Build the base map shared by all visibility maps: the luminance image map
+	// scaled to the tile resolution
+	baseMap.resize(tilesXCount * tilesYCount);
 	if (luminanceMapImage) {
 		// Scale the image
-		luminanceMapImageScaled.reset(ImageMap::Resample(luminanceMapImage, 1,
+		unique_ptr<ImageMap> luminanceMapImageScaled(ImageMap::Resample(luminanceMapImage, 1,
 				tilesXCount, tilesYCount));
 		luminanceMapImageScaled->Preprocess();
-	}
+
+		const ImageMapStorage *luminanceMapStorageScaled = luminanceMapImageScaled->GetStorage();
+		for (u_int i = 0; i < baseMap.size(); ++i)
+			baseMap[i] = Max(0.f, luminanceMapStorageScaled->GetFloat(i));
+	} else
+		fill(baseMap.begin(), baseMap.end(), 1.f);
 
 	const double startTime = WallClockTime();
 	double lastPrintTime = WallClockTime();
@@ -553,10 +514,17 @@ void EnvLightVisibilityCache::BuildCacheEntries() {
 			}
 		}
 
-		BuildCacheEntry(i, luminanceMapImageScaled.get());
+		BuildCacheEntry(i);
 
 		++counter;
 	}
+
+	size_t mapsMemoryUsage = baseMap.size() * sizeof(float);
+	for (auto const &cacheEntry : cacheEntries) {
+		if (cacheEntry.visibilityMap)
+			mapsMemoryUsage += cacheEntry.visibilityMap->GetMemoryUsage();
+	}
+	SLG_LOG("EnvLightVisibilityCache visibility maps memory usage: " << (mapsMemoryUsage / 1024) << " Kbytes");
 }
 
 //--------------------------------------------------------------------------
@@ -599,6 +567,108 @@ void EnvLightVisibilityCache::BuildTileDistributions() {
 	}
 }
 
+//------------------------------------------------------------------------------
+// ELVCVisibilityMap
+//------------------------------------------------------------------------------
+
+ELVCVisibilityMap *ELVCVisibilityMap::Create(const float *visibility, const float *baseMap,
+		const u_int width, const u_int height) {
+	unique_ptr<ELVCVisibilityMap> map(new ELVCVisibilityMap());
+	map->width = width;
+	map->height = height;
+
+	// Quantize the visibility, any visible tile keeps a non zero value
+	const u_int count = width * height;
+	map->visibility.resize(count);
+	for (u_int i = 0; i < count; ++i) {
+		const float v = Clamp(visibility[i], 0.f, 1.f);
+		map->visibility[i] = (v > 0.f) ? (u_char)Clamp(Round2UInt(v * 255.f), 1u, 255u) : 0;
+	}
+	map->visibility.shrink_to_fit();
+
+	// Compute the rows integral
+	vector<float> rowSums(height);
+	for (u_int y = 0; y < height; ++y) {
+		float rowSum = 0.f;
+		for (u_int x = 0; x < width; ++x)
+			rowSum += map->GetValue(baseMap, x + y * width);
+
+		rowSums[y] = rowSum;
+	}
+
+	map->marginalCDF.resize(height + 1);
+	ComputeStep1dCDF(&rowSums[0], height, &map->funcInt, &map->marginalCDF[0]);
+	if (map->funcInt <= 0.f)
+		return nullptr;
+	map->marginalCDF.shrink_to_fit();
+
+	// funcInt is the average of the row sums
+	map->funcInt /= width;
+
+	return map.release();
+}
+
+void ELVCVisibilityMap::SampleDiscrete(const float *baseMap, const float u0, const float u1,
+		u_int xy[2], float *pdf, float *du0, float *du1) const {
+	*pdf = 0.f;
+
+	// Pick the row
+	const float *cdfPtr = upper_bound(&marginalCDF[0], &marginalCDF[0] + height + 1, u1);
+	const u_int y = Clamp<int>(cdfPtr - &marginalCDF[0] - 1, 0, height - 1);
+	const float cdfDelta = marginalCDF[y + 1] - marginalCDF[y];
+	*du1 = (cdfDelta > 0.f) ? Clamp((u1 - marginalCDF[y]) / cdfDelta, 0.f, 1.f) : 0.f;
+
+	// Pick the column, the row is integrated on the fly
+	const u_int rowOffset = y * width;
+	float rowSum = 0.f;
+	for (u_int x = 0; x < width; ++x)
+		rowSum += GetValue(baseMap, rowOffset + x);
+	if (rowSum <= 0.f)
+		return;
+
+	const float target = u0 * rowSum;
+	float sum = 0.f;
+	u_int x = 0;
+	float value = 0.f;
+	bool found = false;
+	for (u_int i = 0; i < width; ++i) {
+		const float v = GetValue(baseMap, rowOffset + i);
+		if (v > 0.f) {
+			x = i;
+			value = v;
+
+			if (sum + v > target) {
+				found = true;
+				break;
+			}
+		}
+
+		sum += v;
+	}
+	// Because of float rounding, I may have run past the end of the row: use
+	// the last tile with a non zero value
+	if (!found)
+		sum -= value;
+
+	xy[0] = x;
+	xy[1] = y;
+	*du0 = Clamp((target - sum) / value, 0.f, 1.f);
+	*pdf = value / (funcInt * width * height);
+}
+
+float ELVCVisibilityMap::Pdf(const float *baseMap, const float u, const float v,
+		float *du, float *dv, u_int *offsetU, u_int *offsetV) const {
+	const u_int x = Min(width - 1, Floor2UInt(u * width));
+	const u_int y = Min(height - 1, Floor2UInt(v * height));
+
+	*du = u * width - x;
+	*dv = v * height - y;
+	*offsetU = x;
+	*offsetV = y;
+
+	return GetValue(baseMap, x + y * width) / funcInt;
+}
+
 //------------------------------------------------------------------------------
 // ELVCBvh
 //------------------------------------------------------------------------------
@@ -614,39 +684,16 @@ const ELVCacheEntry *ELVCBvh::GetNearestEntry(const Point &p, const Normal &n, c
 	const ELVCacheEntry *nearestEntry = nullptr;
 	float nearestDistance2 = entryRadius2;
 
-	u_int currentNode = 0; // Root Node
-	const u_int stopNode = BVHNodeData_GetSkipIndex(arrayNodes[0].nodeData); // Non-existent
-
-	while (currentNode < stopNode) {
-		const luxrays::ocl::IndexBVHArrayNode &node = arrayNodes[currentNode];
-
-		const u_int nodeData = node.nodeData;
-		if (BVHNodeData_IsLeaf(nodeData)) {
-			// It is a leaf, check the entry
-			const ELVCacheEntry *entry = &((*allEntries)[node.entryLeaf.entryIndex]);
+	ForEachNearEntry(p, [&](const u_int entryIndex, const float distance2) {
+		const ELVCacheEntry *entry = &((*allEntries)[entryIndex]);
 
-			const float distance2 = DistanceSquared(p, entry->p);
-			if ((distance2 < nearestDistance2) && (isVolume == entry->isVolume) &&
-					(isVolume || (Dot(n, entry->n) > normalCosAngle))) {
-				// I have found a valid nearer entry
-				nearestEntry = entry;
-				nearestDistance2 = distance2;
-			}
-
-			++currentNode;
-		} else {
-			// It is a node, check the bounding box
-			if (p.x >= node.bvhNode.bboxMin[0] && p.x <= node.bvhNode.bboxMax[0] &&
-					p.y >= node.bvhNode.bboxMin[1] && p.y <= node.bvhNode.bboxMax[1] &&
-					p.z >= node.bvhNode.bboxMin[2] && p.z <= node.bvhNode.bboxMax[2])
-				++currentNode;
-			else {
-				// I don't need to use IndexBVHNodeData_GetSkipIndex() here because
-				// I already know the leaf flag is 0
-				currentNode = nodeData;
-			}
+		if ((distance2 < nearestDistance2) && (isVolume == entry->isVolume) &&
+				(isVolume || (Dot(n, entry->n) > normalCosAngle))) {
+			// I have found a valid nearer entry
+			nearestEntry = entry;
+			nearestDistance2 = distance2;
 		}
-	}
+	});
 
 	return nearestEntry;
 }
@@ -732,7 +779,7 @@ void EnvLightVisibilityCache::Build() {
 // GetVisibilityMap
 //------------------------------------------------------------------------------
 
-const Distribution2D *EnvLightVisibilityCache::GetVisibilityMap(const BSDF &bsdf) const {
+const ELVCVisibilityMap *EnvLightVisibilityCache::GetVisibilityMap(const BSDF &bsdf) const {
 	if (cacheEntriesBVH) {
 		const ELVCacheEntry *entry = cacheEntriesBVH->GetNearestEntry(bsdf.hitPoint.p,
 				bsdf.hitPoint.GetLandingShadeN(), bsdf.IsVolume());
@@ -752,12 +799,12 @@ void EnvLightVisibilityCache::Sample(const BSDF &bsdf,
 		float uv[2], float *pdf) const {
 	*pdf = 0.f;
 
-	const Distribution2D *cacheDist = GetVisibilityMap(bsdf);
+	const ELVCVisibilityMap *cacheDist = GetVisibilityMap(bsdf);
 
 	if (cacheDist) {
 		u_int cacheDistXY[2];
 		float cacheDistPdf, du0, du1;
-		cacheDist->SampleDiscrete(u0, u1, cacheDistXY, &cacheDistPdf, &du0, &du1);
+		cacheDist->SampleDiscrete(&baseMap[0], u0, u1, cacheDistXY, &cacheDistPdf, &du0, &du1);
 
 		if (cacheDistPdf > 0.f) {
 			if (tileDistributions.size() > 0) {
@@ -790,12 +837,12 @@ void EnvLightVisibilityCache::Sample(const BSDF &bsdf,
 float EnvLightVisibilityCache::Pdf(const BSDF &bsdf, const float u, const float v) const {
 	float pdf = 0.f;
 
-	const Distribution2D *cacheDist = GetVisibilityMap(bsdf);
+	const ELVCVisibilityMap *cacheDist = GetVisibilityMap(bsdf);
 
 	if (cacheDist) {
 		u_int offsetU, offsetV;
 		float du, dv;
-		const float cacheDistPdf = cacheDist->Pdf(u, v, &du, &dv, &offsetU, &offsetV);
+		const float cacheDistPdf = cacheDist->Pdf(&baseMap[0], u, v, &du, &dv, &offsetU, &offsetV);
 
 		if (cacheDistPdf > 0.f) {
 			if (tileDistributions.size() > 0) {
@@ -874,6 +921,7 @@ void EnvLightVisibilityCache::LoadPersistentCache(const std::string &fileName) {
 
 	sif.GetArchive() >> params;
 
+	sif.GetArchive() >> baseMap;
 	sif.GetArchive() >> cacheEntries;
 	sif.GetArchive() >> cacheEntriesBVH;
 
@@ -899,6 +947,7 @@ void EnvLightVisibilityCache::SavePersistentCache(const std::string &fileName) {
 
 		sof.GetArchive() << params;
 
+		sof.GetArchive() << baseMap;
 		sof.GetArchive() << cacheEntries;
 		sof.GetArchive() << cacheEntriesBVH;
 
@@ -918,6 +967,7 @@ void EnvLightVisibilityCache::SavePersistentCache(const std::string &fileName) {
 		safeSave.Process();
 }
 
+BOOST_CLASS_EXPORT_IMPLEMENT(slg::ELVCVisibilityMap)
 BOOST_CLASS_EXPORT_IMPLEMENT(slg::ELVCacheEntry)
 BOOST_CLASS_EXPORT_IMPLEMENT(slg::ELVCBvh)
 BOOST_CLASS_EXPORT_IMPLEMENT(slg::ELVCParams)
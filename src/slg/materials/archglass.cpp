@@ -103,8 +103,8 @@ Spectrum ArchGlassMaterial::Sample(const HitPoint &hitPoint,
 	const Vector &localFixedDir, Vector *localSampledDir,
 	const float u0, const float u1, const float passThroughEvent,
 	float *pdfW, BSDFEvent *event) const {
-	const Spectrum kt = Kt->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f);
-	const Spectrum kr = Kr->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f);
+	const Spectrum kt = Kt->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f);
+	const Spectrum kr = Kr->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f);
 
 	const float nc = ExtractExteriorIors(hitPoint, exteriorIor);
 	const float nt = ExtractInteriorIors(hitPoint, interiorIor);
@@ -113,8 +113,8 @@ Spectrum ArchGlassMaterial::Sample(const HitPoint &hitPoint,
 	const Spectrum trans = EvalSpecularTransmission(hitPoint, localFixedDir,
 			kt, nc, nt, &transLocalSampledDir);
 	
-	const float localFilmThickness = filmThickness ? filmThickness->GetFloatValue(hitPoint) : 0.f;
-	const float localFilmIor = (localFilmThickness > 0.f && filmIor) ? filmIor->GetFloatValue(hitPoint) : 1.f;
+	const float localFilmThickness = filmThickness ? filmThickness->GetCachedFloatValue(hitPoint) : 0.f;
+	const float localFilmIor = (localFilmThickness > 0.f && filmIor) ? filmIor->GetCachedFloatValue(hitPoint) : 1.f;
 	Vector reflLocalSampledDir;
 	const Spectrum refl = EvalSpecularReflection(hitPoint, localFixedDir,
 			kr, nc, nt, &reflLocalSampledDir, localFilmThickness, localFilmIor);
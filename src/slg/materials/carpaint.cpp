@@ -39,7 +39,7 @@ CarPaintMaterial::CarPaintMaterial(const Texture *frontTransp, const Texture *ba
 }
 
 Spectrum CarPaintMaterial::Albedo(const HitPoint &hitPoint) const {
-	return Kd->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f);
+	return Kd->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f);
 }
 
 Spectrum CarPaintMaterial::Evaluate(const HitPoint &hitPoint,
@@ -63,42 +63,42 @@ Spectrum CarPaintMaterial::Evaluate(const HitPoint &hitPoint,
 	// Absorption
 	const float cosi = fabsf(localLightDir.z);
 	const float coso = fabsf(localEyeDir.z);
-	const Spectrum alpha = Ka->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f);
-	const float d = depth->GetFloatValue(hitPoint);
+	const Spectrum alpha = Ka->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f);
+	const float d = depth->GetCachedFloatValue(hitPoint);
 	const Spectrum absorption = CoatingAbsorption(cosi, coso, alpha, d);
 
 	// Diffuse layer
-	Spectrum result = absorption * Kd->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f) * INV_PI * fabsf(localLightDir.z);
+	Spectrum result = absorption * Kd->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f) * INV_PI * fabsf(localLightDir.z);
 
 	// 1st glossy layer
-	const Spectrum ks1 = Ks1->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f);
-	const float m1 = M1->GetFloatValue(hitPoint);
+	const Spectrum ks1 = Ks1->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f);
+	const float m1 = M1->GetCachedFloatValue(hitPoint);
 	if (ks1.Filter() > 0.f && m1 > 0.f)
 	{
 		const float rough1 = m1 * m1;
-		const float r1 = R1->GetFloatValue(hitPoint);
+		const float r1 = R1->GetCachedFloatValue(hitPoint);
 		result += (SchlickDistribution_D(rough1, H, 0.f) * SchlickDistribution_G(rough1, localLightDir, localEyeDir) / (4.f * coso)) *
 				(ks1 * FresnelTexture::SchlickEvaluate(r1, Dot(localEyeDir, H)));
 		pdf += SchlickDistribution_Pdf(rough1, H, 0.f);
 		++n;
 	}
-	const Spectrum ks2 = Ks2->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f);
-	const float m2 = M2->GetFloatValue(hitPoint);
+	const Spectrum ks2 = Ks2->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f);
+	const float m2 = M2->GetCachedFloatValue(hitPoint);
 	if (ks2.Filter() > 0.f && m2 > 0.f)
 	{
 		const float rough2 = m2 * m2;
-		const float r2 = R2->GetFloatValue(hitPoint);
+		const float r2 = R2->GetCachedFloatValue(hitPoint);
 		result += (SchlickDistribution_D(rough2, H, 0.f) * SchlickDistribution_G(rough2, localLightDir, localEyeDir) / (4.f * coso)) *
 				(ks2 * FresnelTexture::SchlickEvaluate(r2, Dot(localEyeDir, H)));
 		pdf += SchlickDistribution_Pdf(rough2, H, 0.f);
 		++n;
 	}
-	const Spectrum ks3 = Ks3->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f);
-	const float m3 = M3->GetFloatValue(hitPoint);
+	const Spectrum ks3 = Ks3->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f);
+	const float m3 = M3->GetCachedFloatValue(hitPoint);
 	if (ks3.Filter() > 0.f && m3 > 0.f)
 	{
 		const float rough3 = m3 * m3;
-		const float r3 = R3->GetFloatValue(hitPoint);
+		const float r3 = R3->GetCachedFloatValue(hitPoint);
 		result += (SchlickDistribution_D(rough3, H, 0.f) * SchlickDistribution_G(rough3, localLightDir, localEyeDir) / (4.f * coso)) *
 				(ks3 * FresnelTexture::SchlickEvaluate(r3, Dot(localEyeDir, H)));
 		pdf += SchlickDistribution_Pdf(rough3, H, 0.f);
@@ -134,24 +134,24 @@ Spectrum CarPaintMaterial::Sample(const HitPoint &hitPoint,
 	float pdf = 0.f;
 	bool l1 = false, l2 = false, l3 = false;
 	// 1st glossy layer
-	const Spectrum ks1 = Ks1->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f);
-	const float m1 = M1->GetFloatValue(hitPoint);
+	const Spectrum ks1 = Ks1->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f);
+	const float m1 = M1->GetCachedFloatValue(hitPoint);
 	if (ks1.Filter() > 0.f && m1 > 0.f)
 	{
 		l1 = true;
 		++n;
 	}
 	// 2nd glossy layer
-	const Spectrum ks2 = Ks2->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f);
-	const float m2 = M2->GetFloatValue(hitPoint);
+	const Spectrum ks2 = Ks2->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f);
+	const float m2 = M2->GetCachedFloatValue(hitPoint);
 	if (ks2.Filter() > 0.f && m2 > 0.f)
 	{
 		l2 = true;
 		++n;
 	}
 	// 3rd glossy layer
-	const Spectrum ks3 = Ks3->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f);
-	const float m3 = M3->GetFloatValue(hitPoint);
+	const Spectrum ks3 = Ks3->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f);
+	const float m3 = M3->GetCachedFloatValue(hitPoint);
 	if (ks3.Filter() > 0.f && m3 > 0.f) {
 		l3 = true;
 		++n;
@@ -168,12 +168,12 @@ Spectrum CarPaintMaterial::Sample(const HitPoint &hitPoint,
 		// Absorption
 		const float cosi = fabsf(localFixedDir.z);
 		const float coso = fabsf(localSampledDir->z);
-		const Spectrum alpha = Ka->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f);
-		const float d = depth->GetFloatValue(hitPoint);
+		const Spectrum alpha = Ka->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f);
+		const float d = depth->GetCachedFloatValue(hitPoint);
 		const Spectrum absorption = CoatingAbsorption(cosi, coso, alpha, d);
 
 		// Evaluate base BSDF
-		result = absorption * Kd->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f) * pdf;
+		result = absorption * Kd->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f) * pdf;
 
 		wh = Normalize(*localSampledDir + localFixedDir);
 		if (wh.z < 0.f)
@@ -197,7 +197,7 @@ Spectrum CarPaintMaterial::Sample(const HitPoint &hitPoint,
 		if (pdf <= 0.f)
 			return Spectrum();
 
-		result = ks1 * FresnelTexture::SchlickEvaluate(R1->GetFloatValue(hitPoint), cosWH);
+		result = ks1 * FresnelTexture::SchlickEvaluate(R1->GetCachedFloatValue(hitPoint), cosWH);
 
 		const float G = SchlickDistribution_G(rough1, localFixedDir, *localSampledDir);
 		if (!hitPoint.fromLight)
@@ -225,7 +225,7 @@ Spectrum CarPaintMaterial::Sample(const HitPoint &hitPoint,
 		if (pdf <= 0.f)
 			return Spectrum();
 
-		result = ks2 * FresnelTexture::SchlickEvaluate(R2->GetFloatValue(hitPoint), cosWH);
+		result = ks2 * FresnelTexture::SchlickEvaluate(R2->GetCachedFloatValue(hitPoint), cosWH);
 
 		const float G = SchlickDistribution_G(rough2, localFixedDir, *localSampledDir);
 		if (!hitPoint.fromLight)
@@ -252,7 +252,7 @@ Spectrum CarPaintMaterial::Sample(const HitPoint &hitPoint,
 		if (pdf <= 0.f)
 			return Spectrum();
 
-		result = ks3 * FresnelTexture::SchlickEvaluate(R3->GetFloatValue(hitPoint), cosWH);
+		result = ks3 * FresnelTexture::SchlickEvaluate(R3->GetCachedFloatValue(hitPoint), cosWH);
 
 		const float G = SchlickDistribution_G(rough3, localFixedDir, *localSampledDir);
 		if (!hitPoint.fromLight)
@@ -272,13 +272,13 @@ Spectrum CarPaintMaterial::Sample(const HitPoint &hitPoint,
 		// Absorption
 		const float cosi = fabsf(localFixedDir.z);
 		const float coso = fabsf(localSampledDir->z);
-		const Spectrum alpha = Ka->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f);
-		const float d = depth->GetFloatValue(hitPoint);
+		const Spectrum alpha = Ka->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f);
+		const float d = depth->GetCachedFloatValue(hitPoint);
 		const Spectrum absorption = CoatingAbsorption(cosi, coso, alpha, d);
 
 		const float pdf0 = fabsf((hitPoint.fromLight ? localFixedDir.z : localSampledDir->z) * INV_PI);
 		pdf += pdf0;
-		result += absorption * Kd->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f) * pdf0;
+		result += absorption * Kd->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f) * pdf0;
 	}
 	// 1st glossy
 	if (l1 && sampled != 1) {
@@ -289,7 +289,7 @@ Spectrum CarPaintMaterial::Sample(const HitPoint &hitPoint,
 			result += ks1 * (d1 *
 				SchlickDistribution_G(rough1, localFixedDir, *localSampledDir) /
 				(4.f * (hitPoint.fromLight ? fabsf(localSampledDir->z) : fabsf(localFixedDir.z)))) *
-				FresnelTexture::SchlickEvaluate(R1->GetFloatValue(hitPoint), cosWH);
+				FresnelTexture::SchlickEvaluate(R1->GetCachedFloatValue(hitPoint), cosWH);
 			pdf += pdf1;
 		}
 	}
@@ -302,7 +302,7 @@ Spectrum CarPaintMaterial::Sample(const HitPoint &hitPoint,
 			result += ks2 * (d2 *
 				SchlickDistribution_G(rough2, localFixedDir, *localSampledDir) /
 				(4.f * (hitPoint.fromLight ? fabsf(localSampledDir->z) : fabsf(localFixedDir.z)))) *
-				FresnelTexture::SchlickEvaluate(R2->GetFloatValue(hitPoint), cosWH);
+				FresnelTexture::SchlickEvaluate(R2->GetCachedFloatValue(hitPoint), cosWH);
 			pdf += pdf2;
 		}
 	}
@@ -315,7 +315,7 @@ Spectrum CarPaintMaterial::Sample(const HitPoint &hitPoint,
 			result += ks3 * (d3 *
 				SchlickDistribution_G(rough3, localFixedDir, *localSampledDir) /
 				(4.f * (hitPoint.fromLight ? fabsf(localSampledDir->z) : fabsf(localFixedDir.z)))) *
-				FresnelTexture::SchlickEvaluate(R3->GetFloatValue(hitPoint), cosWH);
+				FresnelTexture::SchlickEvaluate(R3->GetCachedFloatValue(hitPoint), cosWH);
 			pdf += pdf3;
 		}
 	}
@@ -343,8 +343,8 @@ void CarPaintMaterial::Pdf(const HitPoint &hitPoint,
 	int n = 1; // already counts the diffuse layer
 
 	// First specular lobe
-	const Spectrum ks1 = Ks1->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f);
-	const float m1 = M1->GetFloatValue(hitPoint);
+	const Spectrum ks1 = Ks1->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f);
+	const float m1 = M1->GetCachedFloatValue(hitPoint);
 	if (ks1.Filter() > 0.f && m1 > 0.f)
 	{
 		const float rough1 = m1 * m1;
@@ -353,8 +353,8 @@ void CarPaintMaterial::Pdf(const HitPoint &hitPoint,
 	}
 
 	// Second specular lobe
-	const Spectrum ks2 = Ks2->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f);
-	const float m2 = M2->GetFloatValue(hitPoint);
+	const Spectrum ks2 = Ks2->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f);
+	const float m2 = M2->GetCachedFloatValue(hitPoint);
 	if (ks2.Filter() > 0.f && m2 > 0.f)
 	{
 		const float rough2 = m2 * m2;
@@ -363,8 +363,8 @@ void CarPaintMaterial::Pdf(const HitPoint &hitPoint,
 	}
 
 	// Third specular lobe
-	const Spectrum ks3 = Ks3->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f);
-	const float m3 = M3->GetFloatValue(hitPoint);
+	const Spectrum ks3 = Ks3->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f);
+	const float m3 = M3->GetCachedFloatValue(hitPoint);
 	if (ks3.Filter() > 0.f && m3 > 0.f)
 	{
 		const float rough3 = m3 * m3;
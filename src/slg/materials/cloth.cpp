@@ -542,7 +542,7 @@ Spectrum ClothMaterial::Albedo(const HitPoint &hitPoint) const {
 	
 	const Texture *kd = yarn->yarn_type == slg::ocl::WARP ? Warp_Kd :  Weft_Kd;
 
-	return kd->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f);
+	return kd->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f);
 }
 
 Spectrum ClothMaterial::Evaluate(const HitPoint &hitPoint,
@@ -566,7 +566,7 @@ Spectrum ClothMaterial::Evaluate(const HitPoint &hitPoint,
 	const Texture *ks = yarn->yarn_type == slg::ocl::WARP ? Warp_Ks :  Weft_Ks;
 	const Texture *kd = yarn->yarn_type == slg::ocl::WARP ? Warp_Kd :  Weft_Kd;
 
-	return (kd->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f) + ks->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f) * scale) * INV_PI * fabsf(localLightDir.z);
+	return (kd->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f) + ks->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f) * scale) * INV_PI * fabsf(localLightDir.z);
 }
 
 Spectrum ClothMaterial::Sample(const HitPoint &hitPoint,
@@ -595,7 +595,7 @@ Spectrum ClothMaterial::Sample(const HitPoint &hitPoint,
 	const Texture *ks = (yarn->yarn_type == slg::ocl::WARP ? Warp_Ks :  Weft_Ks);
 	const Texture *kd = (yarn->yarn_type == slg::ocl::WARP ? Warp_Kd :  Weft_Kd);
 	
-	return kd->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f) + ks->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f) * scale;
+	return kd->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f) + ks->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f) * scale;
 }
 
 void ClothMaterial::Pdf(const HitPoint &hitPoint,
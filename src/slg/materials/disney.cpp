@@ -82,7 +82,7 @@ void DisneyMaterial::UpdateGlossiness() {
 }
 
 Spectrum DisneyMaterial::Albedo(const HitPoint &hitPoint) const {
-	return BaseColor->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f);
+	return BaseColor->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f);
 }
 
 Spectrum DisneyMaterial::Evaluate(
@@ -92,22 +92,22 @@ Spectrum DisneyMaterial::Evaluate(
 		BSDFEvent *event,
 		float *directPdfW,
 		float *reversePdfW) const  {
-	const Spectrum color = BaseColor->GetSpectrumValue(hitPoint).Clamp(0.0f, 1.0f);
-	const float subsurface = Clamp(Subsurface->GetFloatValue(hitPoint), 0.0f, 1.0f);
-	const float roughness = Clamp(Roughness->GetFloatValue(hitPoint), 0.0f, 1.0f);
-	const float metallic = Clamp(Metallic->GetFloatValue(hitPoint), 0.0f, 1.0f);
-	const float specular = Clamp(Specular->GetFloatValue(hitPoint), 0.0f, 1.0f);
-	const float specularTint = Clamp(SpecularTint->GetFloatValue(hitPoint), 0.0f, 1.0f);
-	const float clearcoat = Clamp(Clearcoat->GetFloatValue(hitPoint), 0.0f, 1.0f);
-	const float clearcoatGloss = Clamp(ClearcoatGloss->GetFloatValue(hitPoint), 0.0f, 1.0f);
-	const float anisotropicGloss = Clamp(Anisotropic->GetFloatValue(hitPoint), 0.0f, 1.0f);
+	const Spectrum color = BaseColor->GetCachedSpectrumValue(hitPoint).Clamp(0.0f, 1.0f);
+	const float subsurface = Clamp(Subsurface->GetCachedFloatValue(hitPoint), 0.0f, 1.0f);
+	const float roughness = Clamp(Roughness->GetCachedFloatValue(hitPoint), 0.0f, 1.0f);
+	const float metallic = Clamp(Metallic->GetCachedFloatValue(hitPoint), 0.0f, 1.0f);
+	const float specular = Clamp(Specular->GetCachedFloatValue(hitPoint), 0.0f, 1.0f);
+	const float specularTint = Clamp(SpecularTint->GetCachedFloatValue(hitPoint), 0.0f, 1.0f);
+	const float clearcoat = Clamp(Clearcoat->GetCachedFloatValue(hitPoint), 0.0f, 1.0f);
+	const float clearcoatGloss = Clamp(ClearcoatGloss->GetCachedFloatValue(hitPoint), 0.0f, 1.0f);
+	const float anisotropicGloss = Clamp(Anisotropic->GetCachedFloatValue(hitPoint), 0.0f, 1.0f);
 	// I allow sheen values > 1.0 to accentuate the effect. The result is still
 	// clamped between 0.0 and 1.0 to not break the energy conservation law.
-	const float sheen = Sheen->GetFloatValue(hitPoint);
-	const float sheenTint = Clamp(SheenTint->GetFloatValue(hitPoint), 0.0f, 1.0f);
-	const float localFilmAmount = filmAmount ? Clamp(filmAmount->GetFloatValue(hitPoint), 0.0f, 1.0f) : 1.f;
-	const float localFilmThickness = filmThickness ? filmThickness->GetFloatValue(hitPoint) : 0.f;
-	const float localFilmIor = (localFilmThickness > 0.f && filmIor) ? filmIor->GetFloatValue(hitPoint) : 1.f;
+	const float sheen = Sheen->GetCachedFloatValue(hitPoint);
+	const float sheenTint = Clamp(SheenTint->GetCachedFloatValue(hitPoint), 0.0f, 1.0f);
+	const float localFilmAmount = filmAmount ? Clamp(filmAmount->GetCachedFloatValue(hitPoint), 0.0f, 1.0f) : 1.f;
+	const float localFilmThickness = filmThickness ? filmThickness->GetCachedFloatValue(hitPoint) : 0.f;
+	const float localFilmIor = (localFilmThickness > 0.f && filmIor) ? filmIor->GetCachedFloatValue(hitPoint) : 1.f;
 
 	return DisneyEvaluate(hitPoint.fromLight, color, subsurface, roughness, metallic, specular, specularTint,
 			clearcoat, clearcoatGloss, anisotropicGloss, sheen, sheenTint, localFilmAmount, localFilmThickness, 
@@ -262,19 +262,19 @@ Spectrum DisneyMaterial::Sample(
 		const float passThroughEvent,
 		float *pdfW,
 		BSDFEvent *event) const {
-	const Spectrum color = BaseColor->GetSpectrumValue(hitPoint).Clamp(0.0f, 1.0f);
-	const float subsurface = Clamp(Subsurface->GetFloatValue(hitPoint), 0.0f, 1.0f);
-	const float roughness = Clamp(Roughness->GetFloatValue(hitPoint), 0.0f, 1.0f);
-	const float metallic = Clamp(Metallic->GetFloatValue(hitPoint), 0.0f, 1.0f);
-	const float specular = Clamp(Specular->GetFloatValue(hitPoint), 0.0f, 1.0f);
-	const float specularTint = Clamp(SpecularTint->GetFloatValue(hitPoint), 0.0f, 1.0f);
-	const float clearcoat = Clamp(Clearcoat->GetFloatValue(hitPoint), 0.0f, 1.0f);
-	const float clearcoatGloss = Clamp(ClearcoatGloss->GetFloatValue(hitPoint), 0.0f, 1.0f);
-	const float anisotropicGloss = Clamp(Anisotropic->GetFloatValue(hitPoint), 0.0f, 1.0f);
+	const Spectrum color = BaseColor->GetCachedSpectrumValue(hitPoint).Clamp(0.0f, 1.0f);
+	const float subsurface = Clamp(Subsurface->GetCachedFloatValue(hitPoint), 0.0f, 1.0f);
+	const float roughness = Clamp(Roughness->GetCachedFloatValue(hitPoint), 0.0f, 1.0f);
+	const float metallic = Clamp(Metallic->GetCachedFloatValue(hitPoint), 0.0f, 1.0f);
+	const float specular = Clamp(Specular->GetCachedFloatValue(hitPoint), 0.0f, 1.0f);
+	const float specularTint = Clamp(SpecularTint->GetCachedFloatValue(hitPoint), 0.0f, 1.0f);
+	const float clearcoat = Clamp(Clearcoat->GetCachedFloatValue(hitPoint), 0.0f, 1.0f);
+	const float clearcoatGloss = Clamp(ClearcoatGloss->GetCachedFloatValue(hitPoint), 0.0f, 1.0f);
+	const float anisotropicGloss = Clamp(Anisotropic->GetCachedFloatValue(hitPoint), 0.0f, 1.0f);
 	// I allow sheen values > 1.0 to accentuate the effect. The result is still
 	// clamped between 0.0 and 1.0 to not break the energy conservation law.
-	const float sheen = Sheen->GetFloatValue(hitPoint);
-	const float sheenTint = Clamp(SheenTint->GetFloatValue(hitPoint), 0.0f, 1.0f);
+	const float sheen = Sheen->GetCachedFloatValue(hitPoint);
+	const float sheenTint = Clamp(SheenTint->GetCachedFloatValue(hitPoint), 0.0f, 1.0f);
 
 	const Vector &wo = localFixedDir;
 
@@ -306,9 +306,9 @@ Spectrum DisneyMaterial::Sample(
 	DisneyPdf(hitPoint.fromLight, roughness, metallic, clearcoat, clearcoatGloss, anisotropicGloss,
 			localLightDir, localEyeDir, pdfW, nullptr);
 
-	const float localFilmAmount = filmAmount ? Clamp(filmAmount->GetFloatValue(hitPoint), 0.0f, 1.0f) : 1.f;
-	const float localFilmThickness = filmThickness ? filmThickness->GetFloatValue(hitPoint) : 0.f;
-	const float localFilmIor = (localFilmThickness > 0.f && filmIor) ? filmIor->GetFloatValue(hitPoint) : 1.f;
+	const float localFilmAmount = filmAmount ? Clamp(filmAmount->GetCachedFloatValue(hitPoint), 0.0f, 1.0f) : 1.f;
+	const float localFilmThickness = filmThickness ? filmThickness->GetCachedFloatValue(hitPoint) : 0.f;
+	const float localFilmIor = (localFilmThickness > 0.f && filmIor) ? filmIor->GetCachedFloatValue(hitPoint) : 1.f;
 
 	const Spectrum f = DisneyEvaluate(hitPoint.fromLight, color, subsurface, roughness,
 			metallic, specular, specularTint, clearcoat, clearcoatGloss,
@@ -367,11 +367,11 @@ void DisneyMaterial::Pdf(
 		const Vector &localEyeDir,
 		float *directPdfW, 
 		float *reversePdfW) const {
-	const float roughness = Clamp(Roughness->GetFloatValue(hitPoint), 0.0f, 1.0f);
-	const float metallic = Clamp(Metallic->GetFloatValue(hitPoint), 0.0f, 1.0f);
-	const float clearcoat = Clamp(SpecularTint->GetFloatValue(hitPoint), 0.0f, 1.0f);
-	const float clearcoatGloss = Clamp(ClearcoatGloss->GetFloatValue(hitPoint), 0.0f, 1.0f);
-	const float anisotropicGloss = Clamp(Anisotropic->GetFloatValue(hitPoint), 0.0f, 1.0f);
+	const float roughness = Clamp(Roughness->GetCachedFloatValue(hitPoint), 0.0f, 1.0f);
+	const float metallic = Clamp(Metallic->GetCachedFloatValue(hitPoint), 0.0f, 1.0f);
+	const float clearcoat = Clamp(SpecularTint->GetCachedFloatValue(hitPoint), 0.0f, 1.0f);
+	const float clearcoatGloss = Clamp(ClearcoatGloss->GetCachedFloatValue(hitPoint), 0.0f, 1.0f);
+	const float anisotropicGloss = Clamp(Anisotropic->GetCachedFloatValue(hitPoint), 0.0f, 1.0f);
 
 	DisneyPdf(hitPoint.fromLight, roughness, metallic, clearcoat, clearcoatGloss,
 			anisotropicGloss, localLightDir, localEyeDir, directPdfW, reversePdfW);
@@ -193,20 +193,20 @@ Spectrum GlassMaterial::Sample(const HitPoint &hitPoint,
 		const Vector &localFixedDir, Vector *localSampledDir,
 		const float u0, const float u1, const float passThroughEvent,
 		float *pdfW, BSDFEvent *event) const {
-	const Spectrum kr = Kr->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f);
-	const Spectrum kt = Kt->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f);
+	const Spectrum kr = Kr->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f);
+	const Spectrum kt = Kt->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f);
 
 	const float nc = ExtractExteriorIors(hitPoint, exteriorIor);
 	const float nt = ExtractInteriorIors(hitPoint, interiorIor);
 
-	const float cauchyBValue = cauchyB ? cauchyB->GetFloatValue(hitPoint) : 0.f;
+	const float cauchyBValue = cauchyB ? cauchyB->GetCachedFloatValue(hitPoint) : 0.f;
 
 	Vector transLocalSampledDir; 
 	const Spectrum trans = EvalSpecularTransmission(hitPoint, localFixedDir, u0,
 			kt, nc, nt, cauchyBValue, &transLocalSampledDir);
 	
-	const float localFilmThickness = filmThickness ? filmThickness->GetFloatValue(hitPoint) : 0.f;
-	const float localFilmIor = (localFilmThickness > 0.f && filmIor) ? filmIor->GetFloatValue(hitPoint) : 1.f;
+	const float localFilmThickness = filmThickness ? filmThickness->GetCachedFloatValue(hitPoint) : 0.f;
+	const float localFilmIor = (localFilmThickness > 0.f && filmIor) ? filmIor->GetCachedFloatValue(hitPoint) : 1.f;
 	Vector reflLocalSampledDir;
 	const Spectrum refl = EvalSpecularReflection(hitPoint, localFixedDir,
 			kr, nc, nt, &reflLocalSampledDir, localFilmThickness, localFilmIor);
@@ -39,7 +39,7 @@ Glossy2Material::Glossy2Material(const Texture *frontTransp, const Texture *back
 }
 
 Spectrum Glossy2Material::Albedo(const HitPoint &hitPoint) const {
-	return Kd->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f);
+	return Kd->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f);
 }
 
 Spectrum Glossy2Material::Evaluate(const HitPoint &hitPoint,
@@ -48,7 +48,7 @@ Spectrum Glossy2Material::Evaluate(const HitPoint &hitPoint,
 	const Vector &localFixedDir = hitPoint.fromLight ? localLightDir : localEyeDir;
 	const Vector &localSampledDir = hitPoint.fromLight ? localEyeDir : localLightDir;
 
-	const Spectrum baseF = Kd->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f) * INV_PI * fabsf(localLightDir.z);
+	const Spectrum baseF = Kd->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f) * INV_PI * fabsf(localLightDir.z);
 
 	if ((!doublesided) && (localEyeDir.z <= 0.f)) {
 		// Back face: no coating
@@ -66,16 +66,16 @@ Spectrum Glossy2Material::Evaluate(const HitPoint &hitPoint,
 	// Front face: coating+base
 	*event = GLOSSY | REFLECT;
 
-	Spectrum ks = Ks->GetSpectrumValue(hitPoint);
-	const float i = index->GetFloatValue(hitPoint);
+	Spectrum ks = Ks->GetCachedSpectrumValue(hitPoint);
+	const float i = index->GetCachedFloatValue(hitPoint);
 	if (i > 0.f) {
 		const float ti = (i - 1.f) / (i + 1.f);
 		ks *= ti * ti;
 	}
 	ks = ks.Clamp(0.f, 1.f);
 
-	const float u = Clamp(nu->GetFloatValue(hitPoint), 1e-9f, 1.f);
-	const float v = Clamp(nv->GetFloatValue(hitPoint), 1e-9f, 1.f);
+	const float u = Clamp(nu->GetCachedFloatValue(hitPoint), 1e-9f, 1.f);
+	const float v = Clamp(nv->GetCachedFloatValue(hitPoint), 1e-9f, 1.f);
 	const float u2 = u * u;
 	const float v2 = v * v;
 	const float anisotropy = (u2 < v2) ? (1.f - u2 / v2) : u2 > 0.f ? (v2 / u2 - 1.f) : 0.f;
@@ -118,8 +118,8 @@ Spectrum Glossy2Material::Evaluate(const HitPoint &hitPoint,
 	// Absorption
 	const float cosi = fabsf(localSampledDir.z);
 	const float coso = fabsf(localFixedDir.z);
-	const Spectrum alpha = Ka->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f);
-	const float d = depth->GetFloatValue(hitPoint);
+	const Spectrum alpha = Ka->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f);
+	const float d = depth->GetCachedFloatValue(hitPoint);
 	const Spectrum absorption = CoatingAbsorption(cosi, coso, alpha, d);
 
 	// Coating fresnel factor
@@ -150,21 +150,21 @@ Spectrum Glossy2Material::Sample(const HitPoint &hitPoint,
 			return Spectrum ();
 		*event = DIFFUSE | REFLECT;
 		if (hitPoint.fromLight)
-			return Kd->GetSpectrumValue (hitPoint) * fabsf (localFixedDir.z / absCosSampledDir);
+			return Kd->GetCachedSpectrumValue (hitPoint) * fabsf (localFixedDir.z / absCosSampledDir);
 		else
-			return Kd->GetSpectrumValue (hitPoint);
+			return Kd->GetCachedSpectrumValue (hitPoint);
 	}
 
-	Spectrum ks = Ks->GetSpectrumValue(hitPoint);
-	const float i = index->GetFloatValue(hitPoint);
+	Spectrum ks = Ks->GetCachedSpectrumValue(hitPoint);
+	const float i = index->GetCachedFloatValue(hitPoint);
 	if (i > 0.f) {
 		const float ti = (i - 1.f) / (i + 1.f);
 		ks *= ti * ti;
 	}
 	ks = ks.Clamp(0.f, 1.f);
 
-	const float u = Clamp(nu->GetFloatValue(hitPoint), 1e-9f, 1.f);
-	const float v = Clamp(nv->GetFloatValue(hitPoint), 1e-9f, 1.f);
+	const float u = Clamp(nu->GetCachedFloatValue(hitPoint), 1e-9f, 1.f);
+	const float v = Clamp(nv->GetCachedFloatValue(hitPoint), 1e-9f, 1.f);
 	const float u2 = u * u;
 	const float v2 = v * v;
 	const float anisotropy = (u2 < v2) ? (1.f - u2 / v2) : u2 > 0.f ? (v2 / u2 - 1.f) : 0.f;
@@ -185,7 +185,7 @@ Spectrum Glossy2Material::Sample(const HitPoint &hitPoint,
 		if (absCosSampledDir < DEFAULT_COS_EPSILON_STATIC)
 			return Spectrum();
 
-		baseF = Kd->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f) * INV_PI * fabsf(hitPoint.fromLight ? localFixedDir.z : absCosSampledDir);
+		baseF = Kd->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f) * INV_PI * fabsf(hitPoint.fromLight ? localFixedDir.z : absCosSampledDir);
 
 		// Evaluate coating BSDF (Schlick BSDF)
 		coatingF = SchlickBSDF_CoatingF(hitPoint.fromLight, ks, roughness, anisotropy, multibounce, localFixedDir, *localSampledDir);
@@ -205,7 +205,7 @@ Spectrum Glossy2Material::Sample(const HitPoint &hitPoint,
 
 		// Evaluate base BSDF (Matte BSDF)
 		basePdf = absCosSampledDir * INV_PI;
-		baseF = Kd->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f) * INV_PI * fabsf(hitPoint.fromLight ? localFixedDir.z : absCosSampledDir);
+		baseF = Kd->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f) * INV_PI * fabsf(hitPoint.fromLight ? localFixedDir.z : absCosSampledDir);
 	}
 
 	*event = GLOSSY | REFLECT;
@@ -215,8 +215,8 @@ Spectrum Glossy2Material::Sample(const HitPoint &hitPoint,
 	// Absorption
 	const float cosi = fabsf(localSampledDir->z);
 	const float coso = fabsf(localFixedDir.z);
-	const Spectrum alpha = Ka->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f);
-	const float d = depth->GetFloatValue(hitPoint);
+	const Spectrum alpha = Ka->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f);
+	const float d = depth->GetCachedFloatValue(hitPoint);
 	const Spectrum absorption = CoatingAbsorption(cosi, coso, alpha, d);
 
 	// Coating fresnel factor
@@ -235,16 +235,16 @@ void Glossy2Material::Pdf(const HitPoint &hitPoint,
 	const Vector &localFixedDir = hitPoint.fromLight ? localLightDir : localEyeDir;
 	const Vector &localSampledDir = hitPoint.fromLight ? localEyeDir : localLightDir;
 
-	Spectrum ks = Ks->GetSpectrumValue(hitPoint);
-	const float i = index->GetFloatValue(hitPoint);
+	Spectrum ks = Ks->GetCachedSpectrumValue(hitPoint);
+	const float i = index->GetCachedFloatValue(hitPoint);
 	if (i > 0.f) {
 		const float ti = (i - 1.f) / (i + 1.f);
 		ks *= ti * ti;
 	}
 	ks = ks.Clamp(0.f, 1.f);
 
-	const float u = Clamp(nu->GetFloatValue(hitPoint), 1e-9f, 1.f);
-	const float v = Clamp(nv->GetFloatValue(hitPoint), 1e-9f, 1.f);
+	const float u = Clamp(nu->GetCachedFloatValue(hitPoint), 1e-9f, 1.f);
+	const float v = Clamp(nv->GetCachedFloatValue(hitPoint), 1e-9f, 1.f);
 	const float u2 = u * u;
 	const float v2 = v * v;
 	const float anisotropy = (u2 < v2) ? (1.f - u2 / v2) : u2 > 0.f ? (v2 / u2 - 1.f) : 0.f;
@@ -116,16 +116,16 @@ Spectrum GlossyCoatingMaterial::Evaluate(const HitPoint &hitPoint,
 
 		// Front face: coating+base
 		*event |= GLOSSY | REFLECT;
-		Spectrum ks = Ks->GetSpectrumValue(hitPoint);
-		const float i = index->GetFloatValue(hitPoint);
+		Spectrum ks = Ks->GetCachedSpectrumValue(hitPoint);
+		const float i = index->GetCachedFloatValue(hitPoint);
 		if (i > 0.f) {
 			const float ti = (i - 1.f) / (i + 1.f);
 			ks *= ti * ti;
 		}
 		ks = ks.Clamp(0.f, 1.f);
 
-		const float u = Clamp(nu->GetFloatValue(hitPoint), 1e-9f, 1.f);
-		const float v = Clamp(nv->GetFloatValue(hitPoint), 1e-9f, 1.f);
+		const float u = Clamp(nu->GetCachedFloatValue(hitPoint), 1e-9f, 1.f);
+		const float v = Clamp(nv->GetCachedFloatValue(hitPoint), 1e-9f, 1.f);
 		const float u2 = u * u;
 		const float v2 = v * v;
 		const float anisotropy = (u2 < v2) ? (1.f - u2 / v2) : u2 > 0.f ? (v2 / u2 - 1.f) : 0.f;
@@ -148,8 +148,8 @@ Spectrum GlossyCoatingMaterial::Evaluate(const HitPoint &hitPoint,
 		}
 
 		// Absorption
-		const Spectrum alpha = Ka->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f);
-		const float d = depth->GetFloatValue(hitPoint);
+		const Spectrum alpha = Ka->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f);
+		const float d = depth->GetCachedFloatValue(hitPoint);
 		const Spectrum absorption = CoatingAbsorption(cosi, coso, alpha, d);
 
 		// Coating fresnel factor
@@ -185,8 +185,8 @@ Spectrum GlossyCoatingMaterial::Evaluate(const HitPoint &hitPoint,
 
 		*event |= GLOSSY | TRANSMIT;
 
-		Spectrum ks = Ks->GetSpectrumValue(hitPoint);
-		const float i = index->GetFloatValue(hitPoint);
+		Spectrum ks = Ks->GetCachedSpectrumValue(hitPoint);
+		const float i = index->GetCachedFloatValue(hitPoint);
 		if (i > 0.f) {
 			const float ti = (i - 1.f) / (i + 1.f);
 			ks *= ti * ti;
@@ -210,8 +210,8 @@ Spectrum GlossyCoatingMaterial::Evaluate(const HitPoint &hitPoint,
 		}
 
 		// Absorption
-		const Spectrum alpha = Ka->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f);
-		const float d = depth->GetFloatValue(hitPoint);
+		const Spectrum alpha = Ka->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f);
+		const float d = depth->GetCachedFloatValue(hitPoint);
 		const Spectrum absorption = CoatingAbsorption(cosi, coso, alpha, d);
 
 		// Coating fresnel factor
@@ -235,8 +235,8 @@ Spectrum GlossyCoatingMaterial::Sample(const HitPoint &hitPoint,
 		return Spectrum();
 
 	const Frame frame(hitPoint.GetFrame());
-	Spectrum ks = Ks->GetSpectrumValue(hitPoint);
-	const float i = index->GetFloatValue(hitPoint);
+	Spectrum ks = Ks->GetCachedSpectrumValue(hitPoint);
+	const float i = index->GetCachedFloatValue(hitPoint);
 	if (i > 0.f) {
 		const float ti = (i - 1.f) / (i + 1.f);
 		ks *= ti * ti;
@@ -246,8 +246,8 @@ Spectrum GlossyCoatingMaterial::Sample(const HitPoint &hitPoint,
 	const float wCoating = (localFixedDir.z > DEFAULT_COS_EPSILON_STATIC) ? SchlickBSDF_CoatingWeight(ks, localFixedDir) : 0.f;
 	const float wBase = 1.f - wCoating;
 
-	const float u = Clamp(nu->GetFloatValue(hitPoint), 1e-9f, 1.f);
-	const float v = Clamp(nv->GetFloatValue(hitPoint), 1e-9f, 1.f);
+	const float u = Clamp(nu->GetCachedFloatValue(hitPoint), 1e-9f, 1.f);
+	const float v = Clamp(nv->GetCachedFloatValue(hitPoint), 1e-9f, 1.f);
 	const float u2 = u * u;
 	const float v2 = v * v;
 	const float anisotropy = (u2 < v2) ? (1.f - u2 / v2) : u2 > 0.f ? (v2 / u2 - 1.f) : 0.f;
@@ -314,8 +314,8 @@ Spectrum GlossyCoatingMaterial::Sample(const HitPoint &hitPoint,
 	// Absorption
 	const float cosi = fabsf(localFixedDir.z);
 	const float coso = fabsf(localSampledDir->z);
-	const Spectrum alpha = Ka->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f);
-	const float d = depth->GetFloatValue(hitPoint);
+	const Spectrum alpha = Ka->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f);
+	const float d = depth->GetCachedFloatValue(hitPoint);
 	const Spectrum absorption = CoatingAbsorption(cosi, coso, alpha, d);
 
 	// If Dot(woW, ng) is too small, set sideTest to 0 to discard the result
@@ -389,16 +389,16 @@ void GlossyCoatingMaterial::Pdf(const HitPoint &hitPoint,
 	if (!(localFixedDir.z > 0.f))
 		return;
 
-	Spectrum ks = Ks->GetSpectrumValue(hitPoint);
-	const float i = index->GetFloatValue(hitPoint);
+	Spectrum ks = Ks->GetCachedSpectrumValue(hitPoint);
+	const float i = index->GetCachedFloatValue(hitPoint);
 	if (i > 0.f) {
 		const float ti = (i - 1.f) / (i + 1.f);
 		ks *= ti * ti;
 	}
 	ks = ks.Clamp(0.f, 1.f);
 
-	const float u = Clamp(nu->GetFloatValue(hitPoint), 1e-9f, 1.f);
-	const float v = Clamp(nv->GetFloatValue(hitPoint), 1e-9f, 1.f);
+	const float u = Clamp(nu->GetCachedFloatValue(hitPoint), 1e-9f, 1.f);
+	const float v = Clamp(nv->GetCachedFloatValue(hitPoint), 1e-9f, 1.f);
 	const float u2 = u * u;
 	const float v2 = v * v;
 	const float anisotropy = (u2 < v2) ? (1.f - u2 / v2) : u2 > 0.f ? (v2 / u2 - 1.f) : 0.f;
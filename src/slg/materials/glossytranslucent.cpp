@@ -42,7 +42,7 @@ GlossyTranslucentMaterial::GlossyTranslucentMaterial(const Texture *frontTransp,
 }
 
 Spectrum GlossyTranslucentMaterial::Albedo(const HitPoint &hitPoint) const {
-	return Kd->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f);
+	return Kd->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f);
 }
 
 Spectrum GlossyTranslucentMaterial::Evaluate(const HitPoint &hitPoint,
@@ -68,8 +68,8 @@ Spectrum GlossyTranslucentMaterial::Evaluate(const HitPoint &hitPoint,
 		const Vector H(Normalize(Vector(localLightDir.x + localEyeDir.x, localLightDir.y + localEyeDir.y,
 			localLightDir.z - localEyeDir.z)));
 		const float u = AbsDot(localLightDir, H);
-		Spectrum ks = Ks->GetSpectrumValue(hitPoint);
-		float i = index->GetFloatValue(hitPoint);
+		Spectrum ks = Ks->GetCachedSpectrumValue(hitPoint);
+		float i = index->GetCachedFloatValue(hitPoint);
 		if (i > 0.f) {
 			const float ti = (i - 1.f) / (i + 1.f);
 			ks *= ti * ti;
@@ -77,8 +77,8 @@ Spectrum GlossyTranslucentMaterial::Evaluate(const HitPoint &hitPoint,
 		ks = ks.Clamp(0.f, 1.f);
 		const Spectrum S1 = FresnelTexture::SchlickEvaluate(ks, u);
 
-		ks = Ks_bf->GetSpectrumValue(hitPoint);
-		i = index_bf->GetFloatValue(hitPoint);
+		ks = Ks_bf->GetCachedSpectrumValue(hitPoint);
+		i = index_bf->GetCachedFloatValue(hitPoint);
 		if (i > 0.f) {
 			const float ti = (i - 1.f) / (i + 1.f);
 			ks *= ti * ti;
@@ -87,38 +87,38 @@ Spectrum GlossyTranslucentMaterial::Evaluate(const HitPoint &hitPoint,
 		const Spectrum S2 = FresnelTexture::SchlickEvaluate(ks, u);
 		Spectrum S(Sqrt((Spectrum(1.f) - S1) * (Spectrum(1.f) - S2)));
 		if (localLightDir.z > 0.f) {
-			S *= Exp(Ka->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f) * -(depth->GetFloatValue(hitPoint) / cosi) +
-				Ka_bf->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f) * -(depth_bf->GetFloatValue(hitPoint) / coso));
+			S *= Exp(Ka->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f) * -(depth->GetCachedFloatValue(hitPoint) / cosi) +
+				Ka_bf->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f) * -(depth_bf->GetCachedFloatValue(hitPoint) / coso));
 		} else {
-			S *= Exp(Ka->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f) * -(depth->GetFloatValue(hitPoint) / coso) +
-				Ka_bf->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f) * -(depth_bf->GetFloatValue(hitPoint) / cosi));
+			S *= Exp(Ka->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f) * -(depth->GetCachedFloatValue(hitPoint) / coso) +
+				Ka_bf->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f) * -(depth_bf->GetCachedFloatValue(hitPoint) / cosi));
 		}
 
-		return (INV_PI * cosi) * S * Kt->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f) *
-			(Spectrum(1.f) - Kd->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f));
+		return (INV_PI * cosi) * S * Kt->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f) *
+			(Spectrum(1.f) - Kd->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f));
 	} else if (sideTest > DEFAULT_COS_EPSILON_STATIC) {
 		// Reflection
 		*event = GLOSSY | REFLECT;
 
-		const Spectrum baseF = Kd->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f) * INV_PI * cosi;
+		const Spectrum baseF = Kd->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f) * INV_PI * cosi;
 		Spectrum ks, alpha;
 		float i, u, v, d;
 		bool mbounce;
 		if (localEyeDir.z >= 0.f) {
-			ks = Ks->GetSpectrumValue(hitPoint);
-			i = index->GetFloatValue(hitPoint);
-			u = Clamp(nu->GetFloatValue(hitPoint), 1e-9f, 1.f);
-			v = Clamp(nv->GetFloatValue(hitPoint), 1e-9f, 1.f);
-			alpha = Ka->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f);
-			d = depth->GetFloatValue(hitPoint);
+			ks = Ks->GetCachedSpectrumValue(hitPoint);
+			i = index->GetCachedFloatValue(hitPoint);
+			u = Clamp(nu->GetCachedFloatValue(hitPoint), 1e-9f, 1.f);
+			v = Clamp(nv->GetCachedFloatValue(hitPoint), 1e-9f, 1.f);
+			alpha = Ka->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f);
+			d = depth->GetCachedFloatValue(hitPoint);
 			mbounce = multibounce;
 		} else {
-			ks = Ks_bf->GetSpectrumValue(hitPoint);
-			i = index_bf->GetFloatValue(hitPoint);
-			u = Clamp(nu_bf->GetFloatValue(hitPoint), 1e-9f, 1.f);
-			v = Clamp(nv_bf->GetFloatValue(hitPoint), 1e-9f, 1.f);
-			alpha = Ka_bf->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f);
-			d = depth_bf->GetFloatValue(hitPoint);
+			ks = Ks_bf->GetCachedSpectrumValue(hitPoint);
+			i = index_bf->GetCachedFloatValue(hitPoint);
+			u = Clamp(nu_bf->GetCachedFloatValue(hitPoint), 1e-9f, 1.f);
+			v = Clamp(nv_bf->GetCachedFloatValue(hitPoint), 1e-9f, 1.f);
+			alpha = Ka_bf->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f);
+			d = depth_bf->GetCachedFloatValue(hitPoint);
 			mbounce = multibounce_bf;
 		}
 
@@ -180,20 +180,20 @@ Spectrum GlossyTranslucentMaterial::Sample(const HitPoint &hitPoint,
 		float i, u, v, d;
 		bool mbounce;
 		if (localFixedDir.z >= 0.f) {
-			ks = Ks->GetSpectrumValue(hitPoint);
-			i = index->GetFloatValue(hitPoint);
-			u = Clamp(nu->GetFloatValue(hitPoint), 1e-9f, 1.f);
-			v = Clamp(nv->GetFloatValue(hitPoint), 1e-9f, 1.f);
-			alpha = Ka->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f);
-			d = depth->GetFloatValue(hitPoint);
+			ks = Ks->GetCachedSpectrumValue(hitPoint);
+			i = index->GetCachedFloatValue(hitPoint);
+			u = Clamp(nu->GetCachedFloatValue(hitPoint), 1e-9f, 1.f);
+			v = Clamp(nv->GetCachedFloatValue(hitPoint), 1e-9f, 1.f);
+			alpha = Ka->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f);
+			d = depth->GetCachedFloatValue(hitPoint);
 			mbounce = multibounce;
 		} else {
-			ks = Ks_bf->GetSpectrumValue(hitPoint);
-			i = index_bf->GetFloatValue(hitPoint);
-			u = Clamp(nu_bf->GetFloatValue(hitPoint), 1e-9f, 1.f);
-			v = Clamp(nv_bf->GetFloatValue(hitPoint), 1e-9f, 1.f);
-			alpha = Ka_bf->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f);
-			d = depth_bf->GetFloatValue(hitPoint);
+			ks = Ks_bf->GetCachedSpectrumValue(hitPoint);
+			i = index_bf->GetCachedFloatValue(hitPoint);
+			u = Clamp(nu_bf->GetCachedFloatValue(hitPoint), 1e-9f, 1.f);
+			v = Clamp(nv_bf->GetCachedFloatValue(hitPoint), 1e-9f, 1.f);
+			alpha = Ka_bf->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f);
+			d = depth_bf->GetCachedFloatValue(hitPoint);
 			mbounce = multibounce_bf;
 		}
 		if (i > 0.f) {
@@ -221,7 +221,7 @@ Spectrum GlossyTranslucentMaterial::Sample(const HitPoint &hitPoint,
 			if (absCosSampledDir < DEFAULT_COS_EPSILON_STATIC)
 				return Spectrum();
 
-			baseF = Kd->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f) * INV_PI * fabsf(hitPoint.fromLight ? localFixedDir.z : absCosSampledDir);
+			baseF = Kd->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f) * INV_PI * fabsf(hitPoint.fromLight ? localFixedDir.z : absCosSampledDir);
 
 			// Evaluate coating BSDF (Schlick BSDF)
 			coatingF = SchlickBSDF_CoatingF(hitPoint.fromLight, ks, roughness, anisotropy, mbounce,
@@ -242,7 +242,7 @@ Spectrum GlossyTranslucentMaterial::Sample(const HitPoint &hitPoint,
 
 			// Evaluate base BSDF (Matte BSDF)
 			basePdf = absCosSampledDir * INV_PI;
-			baseF = Kd->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f) * INV_PI * fabsf(hitPoint.fromLight ? localFixedDir.z : absCosSampledDir);
+			baseF = Kd->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f) * INV_PI * fabsf(hitPoint.fromLight ? localFixedDir.z : absCosSampledDir);
 		}
 		*event = GLOSSY | REFLECT;
 
@@ -307,15 +307,15 @@ void GlossyTranslucentMaterial::Pdf(const HitPoint &hitPoint,
 		Spectrum ks;
 		float i, u, v;
 		if (localEyeDir.z >= 0.f) {
-			ks = Ks->GetSpectrumValue(hitPoint);
-			i = index->GetFloatValue(hitPoint);
-			u = Clamp(nu->GetFloatValue(hitPoint), 1e-9f, 1.f);
-			v = Clamp(nv->GetFloatValue(hitPoint), 1e-9f, 1.f);
+			ks = Ks->GetCachedSpectrumValue(hitPoint);
+			i = index->GetCachedFloatValue(hitPoint);
+			u = Clamp(nu->GetCachedFloatValue(hitPoint), 1e-9f, 1.f);
+			v = Clamp(nv->GetCachedFloatValue(hitPoint), 1e-9f, 1.f);
 		} else {
-			ks = Ks_bf->GetSpectrumValue(hitPoint);
-			i = index_bf->GetFloatValue(hitPoint);
-			u = Clamp(nu_bf->GetFloatValue(hitPoint), 1e-9f, 1.f);
-			v = Clamp(nv_bf->GetFloatValue(hitPoint), 1e-9f, 1.f);
+			ks = Ks_bf->GetCachedSpectrumValue(hitPoint);
+			i = index_bf->GetCachedFloatValue(hitPoint);
+			u = Clamp(nu_bf->GetCachedFloatValue(hitPoint), 1e-9f, 1.f);
+			v = Clamp(nv_bf->GetCachedFloatValue(hitPoint), 1e-9f, 1.f);
 		}
 
 		if (i > 0.f) {
@@ -116,6 +116,10 @@ void Material::Bump(HitPoint *hitPoint) const {
 		// Update dpdu and dpdv so they are still orthogonal to shadeN 
 		hitPoint->dpdu = Cross(hitPoint->shadeN, Cross(hitPoint->dpdu, hitPoint->shadeN));
 		hitPoint->dpdv = Cross(hitPoint->shadeN, Cross(hitPoint->dpdv, hitPoint->shadeN));
+
+		// The texture values cached for the not bumped hit point can not be
+		// shared with this one
+		hitPoint->texValueCache = nullptr;
 	}
 }
 
@@ -348,7 +352,7 @@ float Material::ComputeGlossiness(const Texture *t1, const Texture *t2, const Te
 float slg::ExtractExteriorIors(const HitPoint &hitPoint, const Texture *exteriorIor) {
 	float nc = 1.f;
 	if (exteriorIor)
-		nc = exteriorIor->GetFloatValue(hitPoint);
+		nc = exteriorIor->GetCachedFloatValue(hitPoint);
 	else if (hitPoint.exteriorVolume)
 		nc = hitPoint.exteriorVolume->GetIOR(hitPoint);
 
@@ -358,7 +362,7 @@ float slg::ExtractExteriorIors(const HitPoint &hitPoint, const Texture *exterior
 float slg::ExtractInteriorIors(const HitPoint &hitPoint, const Texture *interiorIor) {
 	float nt = 1.f;
 	if (interiorIor)
-		nt = interiorIor->GetFloatValue(hitPoint);
+		nt = interiorIor->GetCachedFloatValue(hitPoint);
 	else if (hitPoint.interiorVolume)
 		nt = hitPoint.interiorVolume->GetIOR(hitPoint);
 
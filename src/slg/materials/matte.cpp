@@ -32,11 +32,11 @@ MatteMaterial::MatteMaterial(const Texture *frontTransp, const Texture *backTran
 }
 
 Spectrum MatteMaterial::Albedo(const HitPoint &hitPoint) const {
-	return Kd->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f);
+	return Kd->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f);
 }
 
 Spectrum MatteMaterial::EvaluateTotal(const HitPoint &hitPoint) const {
-	return Kd->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f);
+	return Kd->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f);
 }
 
 Spectrum MatteMaterial::Evaluate(const HitPoint &hitPoint,
@@ -49,7 +49,7 @@ Spectrum MatteMaterial::Evaluate(const HitPoint &hitPoint,
 		*reversePdfW = fabsf((hitPoint.fromLight ? localLightDir.z : localEyeDir.z) * INV_PI);
 
 	*event = DIFFUSE | REFLECT;
-	return Kd->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f) * (INV_PI * fabsf(localLightDir.z));
+	return Kd->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f) * (INV_PI * fabsf(localLightDir.z));
 }
 
 Spectrum MatteMaterial::Sample(const HitPoint &hitPoint,
@@ -65,9 +65,9 @@ Spectrum MatteMaterial::Sample(const HitPoint &hitPoint,
 
 	*event = DIFFUSE | REFLECT;
 	if (hitPoint.fromLight)
-		return Kd->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f) * fabsf(localFixedDir.z / localSampledDir->z);
+		return Kd->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f) * fabsf(localFixedDir.z / localSampledDir->z);
 	else
-		return Kd->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f);
+		return Kd->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f);
 }
 
 void MatteMaterial::Pdf(const HitPoint &hitPoint,
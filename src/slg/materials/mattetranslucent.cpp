@@ -34,8 +34,8 @@ MatteTranslucentMaterial::MatteTranslucentMaterial(const Texture *frontTransp, c
 }
 
 Spectrum MatteTranslucentMaterial::Albedo(const HitPoint &hitPoint) const {
-	const Spectrum r = Kr->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f);
-	const Spectrum t = Kt->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f) * 
+	const Spectrum r = Kr->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f);
+	const Spectrum t = Kt->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f) * 
 		// Energy conservation
 		(Spectrum(1.f) - r);
 
@@ -45,8 +45,8 @@ Spectrum MatteTranslucentMaterial::Albedo(const HitPoint &hitPoint) const {
 Spectrum MatteTranslucentMaterial::Evaluate(const HitPoint &hitPoint,
 	const Vector &localLightDir, const Vector &localEyeDir, BSDFEvent *event,
 	float *directPdfW, float *reversePdfW) const {
-	const Spectrum r = Kr->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f);
-	const Spectrum t = Kt->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f) * 
+	const Spectrum r = Kr->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f);
+	const Spectrum t = Kt->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f) * 
 		// Energy conservation
 		(Spectrum(1.f) - r);
 
@@ -102,8 +102,8 @@ Spectrum MatteTranslucentMaterial::Sample(const HitPoint &hitPoint,
 	if (absCosSampledDir < DEFAULT_COS_EPSILON_STATIC)
 		return Spectrum();
 
-	const Spectrum kr = Kr->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f);
-	const Spectrum kt = Kt->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f) * 
+	const Spectrum kr = Kr->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f);
+	const Spectrum kt = Kt->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f) * 
 		// Energy conservation
 		(Spectrum(1.f) - kr);
 
@@ -146,8 +146,8 @@ Spectrum MatteTranslucentMaterial::Sample(const HitPoint &hitPoint,
 void MatteTranslucentMaterial::Pdf(const HitPoint &hitPoint,
 		const Vector &localLightDir, const Vector &localEyeDir,
 		float *directPdfW, float *reversePdfW) const {
-	const Spectrum kr = Kr->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f);
-	const Spectrum kt = Kt->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f) * 
+	const Spectrum kr = Kr->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f);
+	const Spectrum kt = Kt->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f) * 
 		// Energy conservation
 		(Spectrum(1.f) - kr);
 
@@ -50,8 +50,8 @@ Spectrum Metal2Material::Albedo(const HitPoint &hitPoint) const {
 		F = fresnelTex->Evaluate(hitPoint, 1.f);
 	else {
 		// For compatibility with the past
-		const Spectrum etaVal = n->GetSpectrumValue(hitPoint).Clamp(.001f);
-		const Spectrum kVal = k->GetSpectrumValue(hitPoint).Clamp(.001f);
+		const Spectrum etaVal = n->GetCachedSpectrumValue(hitPoint).Clamp(.001f);
+		const Spectrum kVal = k->GetCachedSpectrumValue(hitPoint).Clamp(.001f);
 		F = FresnelTexture::GeneralEvaluate(etaVal, kVal, 1.f);
 	}
 	F.Clamp(0.f, 1.f);
@@ -62,8 +62,8 @@ Spectrum Metal2Material::Albedo(const HitPoint &hitPoint) const {
 Spectrum Metal2Material::Evaluate(const HitPoint &hitPoint,
 	const Vector &localLightDir, const Vector &localEyeDir, BSDFEvent *event,
 	float *directPdfW, float *reversePdfW) const {
-	const float u = Clamp(nu->GetFloatValue(hitPoint), 1e-9f, 1.f);
-	const float v = Clamp(nv->GetFloatValue(hitPoint), 1e-9f, 1.f);
+	const float u = Clamp(nu->GetCachedFloatValue(hitPoint), 1e-9f, 1.f);
+	const float v = Clamp(nv->GetCachedFloatValue(hitPoint), 1e-9f, 1.f);
 	const float u2 = u * u;
 	const float v2 = v * v;
 	const float anisotropy = (u2 < v2) ? (1.f - u2 / v2) : u2 > 0.f ? (v2 / u2 - 1.f) : 0.f;
@@ -83,8 +83,8 @@ Spectrum Metal2Material::Evaluate(const HitPoint &hitPoint,
 		F = fresnelTex->Evaluate(hitPoint, cosWH);
 	else {
 		// For compatibility with the past
-		const Spectrum etaVal = n->GetSpectrumValue(hitPoint).Clamp(.001f);
-		const Spectrum kVal = k->GetSpectrumValue(hitPoint).Clamp(.001f);
+		const Spectrum etaVal = n->GetCachedSpectrumValue(hitPoint).Clamp(.001f);
+		const Spectrum kVal = k->GetCachedSpectrumValue(hitPoint).Clamp(.001f);
 		F = FresnelTexture::GeneralEvaluate(etaVal, kVal, cosWH);
 	}
 	F.Clamp(0.f, 1.f);
@@ -102,8 +102,8 @@ Spectrum Metal2Material::Sample(const HitPoint &hitPoint,
 	if (fabsf(localFixedDir.z) < DEFAULT_COS_EPSILON_STATIC)
 		return Spectrum();
 
-	const float u = Clamp(nu->GetFloatValue(hitPoint), 1e-9f, 1.f);
-	const float v = Clamp(nv->GetFloatValue(hitPoint), 1e-9f, 1.f);
+	const float u = Clamp(nu->GetCachedFloatValue(hitPoint), 1e-9f, 1.f);
+	const float v = Clamp(nv->GetCachedFloatValue(hitPoint), 1e-9f, 1.f);
 	const float u2 = u * u;
 	const float v2 = v * v;
 	const float anisotropy = (u2 < v2) ? (1.f - u2 / v2) : u2 > 0.f ? (v2 / u2 - 1.f) : 0.f;
@@ -131,8 +131,8 @@ Spectrum Metal2Material::Sample(const HitPoint &hitPoint,
 		F = fresnelTex->Evaluate(hitPoint, cosWH);
 	else {
 		// For compatibility with the past
-		const Spectrum etaVal = n->GetSpectrumValue(hitPoint).Clamp(.001f);
-		const Spectrum kVal = k->GetSpectrumValue(hitPoint).Clamp(.001f);
+		const Spectrum etaVal = n->GetCachedSpectrumValue(hitPoint).Clamp(.001f);
+		const Spectrum kVal = k->GetCachedSpectrumValue(hitPoint).Clamp(.001f);
 		F = FresnelTexture::GeneralEvaluate(etaVal, kVal, cosWH);
 	}
 	F.Clamp(0.f, 1.f);
@@ -151,8 +151,8 @@ Spectrum Metal2Material::Sample(const HitPoint &hitPoint,
 void Metal2Material::Pdf(const HitPoint &hitPoint,
 		const Vector &localLightDir, const Vector &localEyeDir,
 		float *directPdfW, float *reversePdfW) const {
-	const float u = Clamp(nu->GetFloatValue(hitPoint), 1e-9f, 1.f);
-	const float v = Clamp(nv->GetFloatValue(hitPoint), 1e-9f, 1.f);
+	const float u = Clamp(nu->GetCachedFloatValue(hitPoint), 1e-9f, 1.f);
+	const float v = Clamp(nv->GetCachedFloatValue(hitPoint), 1e-9f, 1.f);
 	const float u2 = u * u;
 	const float v2 = v * v;
 	const float anisotropy = (u2 < v2) ? (1.f - u2 / v2) : u2 > 0.f ? (v2 / u2 - 1.f) : 0.f;
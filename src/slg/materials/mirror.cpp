@@ -46,7 +46,7 @@ Spectrum MirrorMaterial::Sample(const HitPoint &hitPoint,
 	*localSampledDir = Vector(-localFixedDir.x, -localFixedDir.y, localFixedDir.z);
 	*pdfW = 1.f;
 
-	return Kr->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f);
+	return Kr->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f);
 }
 
 void MirrorMaterial::AddReferencedTextures(boost::unordered_set<const Texture *> &referencedTexs) const {
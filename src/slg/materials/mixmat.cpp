@@ -157,7 +157,7 @@ Spectrum MixMaterial::GetEmittedRadiance(const HitPoint &hitPoint, const float o
 }
 
 Spectrum MixMaterial::Albedo(const HitPoint &hitPoint) const {
-	const float weight2 = Clamp(mixFactor->GetFloatValue(hitPoint), 0.f, 1.f);
+	const float weight2 = Clamp(mixFactor->GetCachedFloatValue(hitPoint), 0.f, 1.f);
 	const float weight1 = 1.f - weight2;
 
 	return weight1 * matA->Albedo(hitPoint) + weight2 * matB->Albedo(hitPoint);
@@ -173,7 +173,7 @@ Spectrum MixMaterial::Evaluate(const HitPoint &hitPoint,
 	// material referencing other materials
 	const float isTransmitEval = (Sgn(localLightDir.z) != Sgn(localEyeDir.z));
 	
-	const float weight2 = Clamp(mixFactor->GetFloatValue(hitPoint), 0.f, 1.f);
+	const float weight2 = Clamp(mixFactor->GetCachedFloatValue(hitPoint), 0.f, 1.f);
 	const float weight1 = 1.f - weight2;
 
 	if (directPdfW)
@@ -252,7 +252,7 @@ Spectrum MixMaterial::Sample(const HitPoint &hitPoint,
 	const Frame frameB(hitPointB.GetFrame());
 	const Vector fixedDirB = frameB.ToLocal(frame.ToWorld(localFixedDir));
 
-	const float weight2 = Clamp(mixFactor->GetFloatValue(hitPoint), 0.f, 1.f);
+	const float weight2 = Clamp(mixFactor->GetCachedFloatValue(hitPoint), 0.f, 1.f);
 	const float weight1 = 1.f - weight2;
 
 	const bool sampleMatA = (passThroughEvent < weight1);
@@ -317,7 +317,7 @@ void MixMaterial::Pdf(const HitPoint &hitPoint,
 		const Vector &localLightDir, const Vector &localEyeDir,
 		float *directPdfW, float *reversePdfW) const {
 	const Frame frame(hitPoint.GetFrame());
-	const float weight2 = Clamp(mixFactor->GetFloatValue(hitPoint), 0.f, 1.f);
+	const float weight2 = Clamp(mixFactor->GetCachedFloatValue(hitPoint), 0.f, 1.f);
 	const float weight1 = 1.f - weight2;
 
 	float directPdfWMatA = 1.f;
@@ -45,8 +45,8 @@ RoughGlassMaterial::RoughGlassMaterial(const Texture *frontTransp, const Texture
 Spectrum RoughGlassMaterial::Evaluate(const HitPoint &hitPoint,
 	const Vector &localLightDir, const Vector &localEyeDir, BSDFEvent *event,
 	float *directPdfW, float *reversePdfW) const {
-	const Spectrum kt = Kt->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f);
-	const Spectrum kr = Kr->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f);
+	const Spectrum kt = Kt->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f);
+	const Spectrum kr = Kr->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f);
 
 	const bool isKtBlack = kt.Black();
 	const bool isKrBlack = kr.Black();
@@ -57,8 +57,8 @@ Spectrum RoughGlassMaterial::Evaluate(const HitPoint &hitPoint,
 	const float nt = ExtractInteriorIors(hitPoint, interiorIor);
 	const float ntc = nt / nc;
 
-	const float u = Clamp(nu->GetFloatValue(hitPoint), 1e-9f, 1.f);
-	const float v = Clamp(nv->GetFloatValue(hitPoint), 1e-9f, 1.f);
+	const float u = Clamp(nu->GetCachedFloatValue(hitPoint), 1e-9f, 1.f);
+	const float v = Clamp(nv->GetCachedFloatValue(hitPoint), 1e-9f, 1.f);
 	const float u2 = u * u;
 	const float v2 = v * v;
 	const float anisotropy = (u2 < v2) ? (1.f - u2 / v2) : u2 > 0.f ? (v2 / u2 - 1.f) : 0.f;
@@ -130,9 +130,9 @@ Spectrum RoughGlassMaterial::Evaluate(const HitPoint &hitPoint,
 
 		*event = GLOSSY | REFLECT;
 		
-		const float localFilmThickness = filmThickness ? filmThickness->GetFloatValue(hitPoint) : 0.f;
+		const float localFilmThickness = filmThickness ? filmThickness->GetCachedFloatValue(hitPoint) : 0.f;
 		if (localFilmThickness > 0.f) {
-			const float localFilmIor = filmIor ? filmIor->GetFloatValue(hitPoint) : 1.f;
+			const float localFilmIor = filmIor ? filmIor->GetCachedFloatValue(hitPoint) : 1.f;
 			return result * CalcFilmColor(localEyeDir, localFilmThickness, localFilmIor);
 		}
 		return result;
@@ -146,16 +146,16 @@ Spectrum RoughGlassMaterial::Sample(const HitPoint &hitPoint,
 	if (fabsf(localFixedDir.z) < DEFAULT_COS_EPSILON_STATIC)
 		return Spectrum();
 
-	const Spectrum kt = Kt->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f);
-	const Spectrum kr = Kr->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f);
+	const Spectrum kt = Kt->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f);
+	const Spectrum kr = Kr->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f);
 
 	const bool isKtBlack = kt.Black();
 	const bool isKrBlack = kr.Black();
 	if (isKtBlack && isKrBlack)
 		return Spectrum();
 
-	const float u = Clamp(nu->GetFloatValue(hitPoint), 1e-9f, 1.f);
-	const float v = Clamp(nv->GetFloatValue(hitPoint), 1e-9f, 1.f);
+	const float u = Clamp(nu->GetCachedFloatValue(hitPoint), 1e-9f, 1.f);
+	const float v = Clamp(nv->GetCachedFloatValue(hitPoint), 1e-9f, 1.f);
 	const float u2 = u * u;
 	const float v2 = v * v;
 	const float anisotropy = (u2 < v2) ? (1.f - u2 / v2) : u2 > 0.f ? (v2 / u2 - 1.f) : 0.f;
@@ -243,9 +243,9 @@ Spectrum RoughGlassMaterial::Sample(const HitPoint &hitPoint,
 		factor /= (!hitPoint.fromLight) ? coso : cosi;
 		result = factor * F * kr;
 		
-		const float localFilmThickness = filmThickness ? filmThickness->GetFloatValue(hitPoint) : 0.f;
+		const float localFilmThickness = filmThickness ? filmThickness->GetCachedFloatValue(hitPoint) : 0.f;
 		if (localFilmThickness > 0.f) {
-			const float localFilmIor = filmIor ? filmIor->GetFloatValue(hitPoint) : 1.f;
+			const float localFilmIor = filmIor ? filmIor->GetCachedFloatValue(hitPoint) : 1.f;
 			result *= CalcFilmColor(localFixedDir, localFilmThickness, localFilmIor);
 		}
 
@@ -264,8 +264,8 @@ void RoughGlassMaterial::Pdf(const HitPoint &hitPoint,
 	if (reversePdfW)
 		*reversePdfW = 0.f;
 
-	const Spectrum kt = Kt->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f);
-	const Spectrum kr = Kr->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f);
+	const Spectrum kt = Kt->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f);
+	const Spectrum kr = Kr->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f);
 
 	const bool isKtBlack = kt.Black();
 	const bool isKrBlack = kr.Black();
@@ -276,8 +276,8 @@ void RoughGlassMaterial::Pdf(const HitPoint &hitPoint,
 	const float nt = ExtractInteriorIors(hitPoint, interiorIor);
 	const float ntc = nt / nc;
 
-	const float u = Clamp(nu->GetFloatValue(hitPoint), 1e-9f, 1.f);
-	const float v = Clamp(nv->GetFloatValue(hitPoint), 1e-9f, 1.f);
+	const float u = Clamp(nu->GetCachedFloatValue(hitPoint), 1e-9f, 1.f);
+	const float v = Clamp(nv->GetCachedFloatValue(hitPoint), 1e-9f, 1.f);
 	const float u2 = u * u;
 	const float v2 = v * v;
 	const float anisotropy = (u2 < v2) ? (1.f - u2 / v2) : u2 > 0.f ? (v2 / u2 - 1.f) : 0.f;
@@ -33,7 +33,7 @@ RoughMatteMaterial::RoughMatteMaterial(const Texture *frontTransp, const Texture
 }
 
 Spectrum RoughMatteMaterial::Albedo(const HitPoint &hitPoint) const {
-	return Kd->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f);
+	return Kd->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f);
 }
 
 Spectrum RoughMatteMaterial::Evaluate(const HitPoint &hitPoint,
@@ -46,7 +46,7 @@ Spectrum RoughMatteMaterial::Evaluate(const HitPoint &hitPoint,
 		*reversePdfW = fabsf((hitPoint.fromLight ? localLightDir.z : localEyeDir.z) * INV_PI);
 
 	*event = DIFFUSE | REFLECT;
-	const float s = sigma->GetFloatValue(hitPoint);
+	const float s = sigma->GetCachedFloatValue(hitPoint);
 	const float sigma2 = s * s;
 	const float A = 1.f - (sigma2 / (2.f * (sigma2 + 0.33f)));
 	const float B = 0.45f * sigma2 / (sigma2 + 0.09f);
@@ -58,7 +58,7 @@ Spectrum RoughMatteMaterial::Evaluate(const HitPoint &hitPoint,
 			SinPhi(localLightDir) * SinPhi(localEyeDir);
 		maxcos = max(0.f, dcos);
 	}
-	return Kd->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f) * (INV_PI * fabsf(localLightDir.z) *
+	return Kd->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f) * (INV_PI * fabsf(localLightDir.z) *
 		(A + B * maxcos * sinthetai * sinthetao / max(fabsf(CosTheta(localLightDir)), fabsf(CosTheta(localEyeDir)))));
 }
 
@@ -74,7 +74,7 @@ Spectrum RoughMatteMaterial::Sample(const HitPoint &hitPoint,
 		return Spectrum();
 
 	*event = DIFFUSE | REFLECT;
-	const float s = sigma->GetFloatValue(hitPoint);
+	const float s = sigma->GetCachedFloatValue(hitPoint);
 	const float sigma2 = s * s;
 	const float A = 1.f - (sigma2 / (2.f * (sigma2 + 0.33f)));
 	const float B = 0.45f * sigma2 / (sigma2 + 0.09f);
@@ -88,9 +88,9 @@ Spectrum RoughMatteMaterial::Sample(const HitPoint &hitPoint,
 	}
 	const float coef = (A + B * maxcos * sinthetai * sinthetao / max(fabsf(CosTheta(*localSampledDir)), fabsf(CosTheta(localFixedDir))));
 	if (hitPoint.fromLight)
-		return Kd->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f) * (coef * fabsf(localFixedDir.z / localSampledDir->z));
+		return Kd->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f) * (coef * fabsf(localFixedDir.z / localSampledDir->z));
 	else
-		return Kd->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f) * coef;
+		return Kd->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f) * coef;
 }
 
 void RoughMatteMaterial::Pdf(const HitPoint &hitPoint,
@@ -34,8 +34,8 @@ RoughMatteTranslucentMaterial::RoughMatteTranslucentMaterial(
 }
 
 Spectrum RoughMatteTranslucentMaterial::Albedo(const HitPoint &hitPoint) const {
-	const Spectrum r = Kr->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f);
-	const Spectrum t = Kt->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f) * 
+	const Spectrum r = Kr->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f);
+	const Spectrum t = Kt->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f) * 
 		// Energy conservation
 		(Spectrum(1.f) - r);
 
@@ -45,8 +45,8 @@ Spectrum RoughMatteTranslucentMaterial::Albedo(const HitPoint &hitPoint) const {
 Spectrum RoughMatteTranslucentMaterial::Evaluate(const HitPoint &hitPoint,
 	const Vector &localLightDir, const Vector &localEyeDir, BSDFEvent *event,
 	float *directPdfW, float *reversePdfW) const {
-	const Spectrum r = Kr->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f);
-	const Spectrum t = Kt->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f) * 
+	const Spectrum r = Kr->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f);
+	const Spectrum t = Kt->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f) * 
 		// Energy conservation
 		(Spectrum(1.f) - r);
 
@@ -81,7 +81,7 @@ Spectrum RoughMatteTranslucentMaterial::Evaluate(const HitPoint &hitPoint,
 	if (reversePdfW)
 		*reversePdfW = fabsf((hitPoint.fromLight ? CosTheta(localLightDir) : CosTheta(localEyeDir)) * (weight * INV_PI));
 
-	const float s = sigma->GetFloatValue(hitPoint);
+	const float s = sigma->GetCachedFloatValue(hitPoint);
 	const float sigma2 = s * s;
 	const float A = 1.f - (sigma2 / (2.f * (sigma2 + 0.33f)));
 	const float B = 0.45f * sigma2 / (sigma2 + 0.09f);
@@ -118,8 +118,8 @@ Spectrum RoughMatteTranslucentMaterial::Sample(const HitPoint &hitPoint,
 	if (absCosSampledDir < DEFAULT_COS_EPSILON_STATIC)
 		return Spectrum();
 
-	const Spectrum kr = Kr->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f);
-	const Spectrum kt = Kt->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f) * 
+	const Spectrum kr = Kr->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f);
+	const Spectrum kt = Kt->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f) * 
 		// Energy conservation
 		(Spectrum(1.f) - kr);
 
@@ -140,7 +140,7 @@ Spectrum RoughMatteTranslucentMaterial::Sample(const HitPoint &hitPoint,
 			return Spectrum();
 	}
 
-	const float s = sigma->GetFloatValue(hitPoint);
+	const float s = sigma->GetCachedFloatValue(hitPoint);
 	const float sigma2 = s * s;
 	const float A = 1.f - (sigma2 / (2.f * (sigma2 + 0.33f)));
 	const float B = 0.45f * sigma2 / (sigma2 + 0.09f);
@@ -176,8 +176,8 @@ Spectrum RoughMatteTranslucentMaterial::Sample(const HitPoint &hitPoint,
 void RoughMatteTranslucentMaterial::Pdf(const HitPoint &hitPoint,
 		const Vector &localLightDir, const Vector &localEyeDir,
 		float *directPdfW, float *reversePdfW) const {
-	const Spectrum kr = Kr->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f);
-	const Spectrum kt = Kt->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f) * 
+	const Spectrum kr = Kr->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f);
+	const Spectrum kt = Kt->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f) * 
 		// Energy conservation
 		(Spectrum(1.f) - kr);
 
@@ -36,7 +36,7 @@ VelvetMaterial::VelvetMaterial(const Texture *frontTransp, const Texture *backTr
 }
 
 Spectrum VelvetMaterial::Albedo(const HitPoint &hitPoint) const {
-	return Kd->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f);
+	return Kd->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f);
 }
 
 Spectrum VelvetMaterial::Evaluate(const HitPoint &hitPoint,
@@ -52,10 +52,10 @@ Spectrum VelvetMaterial::Evaluate(const HitPoint &hitPoint,
 
 	*event = DIFFUSE | REFLECT;
 	
-	const float A1 = P1->GetFloatValue(hitPoint);
-	const float A2 = P2->GetFloatValue(hitPoint);
-	const float A3 = P3->GetFloatValue(hitPoint);
-	const float delta = Thickness->GetFloatValue(hitPoint);
+	const float A1 = P1->GetCachedFloatValue(hitPoint);
+	const float A2 = P2->GetCachedFloatValue(hitPoint);
+	const float A3 = P3->GetCachedFloatValue(hitPoint);
+	const float delta = Thickness->GetCachedFloatValue(hitPoint);
 	
 	const float cosv = -Dot(localLightDir, localEyeDir);
 
@@ -74,7 +74,7 @@ Spectrum VelvetMaterial::Evaluate(const HitPoint &hitPoint,
 	else if (p < 0.0f)
 		p = 0.0f;
 
-	return Kd->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f) * p;
+	return Kd->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f) * p;
 }
 
 Spectrum VelvetMaterial::Sample(const HitPoint &hitPoint,
@@ -90,10 +90,10 @@ Spectrum VelvetMaterial::Sample(const HitPoint &hitPoint,
 
 	*event = DIFFUSE | REFLECT;
 	
-	float A1 = P1->GetFloatValue(hitPoint);
-	float A2 = P2->GetFloatValue(hitPoint);
-	float A3 = P3->GetFloatValue(hitPoint);
-	float delta = Thickness->GetFloatValue(hitPoint);
+	float A1 = P1->GetCachedFloatValue(hitPoint);
+	float A2 = P2->GetCachedFloatValue(hitPoint);
+	float A3 = P3->GetCachedFloatValue(hitPoint);
+	float delta = Thickness->GetCachedFloatValue(hitPoint);
 	
 	const float cosv = -Dot(localFixedDir, *localSampledDir);
 
@@ -112,7 +112,7 @@ Spectrum VelvetMaterial::Sample(const HitPoint &hitPoint,
 	else if (p < 0.0f)
 		p = 0.0f;
 	
-	return Kd->GetSpectrumValue(hitPoint).Clamp(0.f, 1.f) * (p / *pdfW);
+	return Kd->GetCachedSpectrumValue(hitPoint).Clamp(0.f, 1.f) * (p / *pdfW);
 }
 
 void VelvetMaterial::Pdf(const HitPoint &hitPoint,
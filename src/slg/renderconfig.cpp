@@ -363,6 +363,10 @@ Properties RenderConfig::ToProperties(const Properties &cfg) {
 	props << cfg.Get(Property("periodicsave.resumerendering.period")(0.f));
 	props << cfg.Get(Property("periodicsave.resumerendering.filename")("rendering.rsm"));
 
+	// Profiler timeline
+	props << cfg.Get(Property("profiler.timeline.file")(""));
+	props << cfg.Get(Property("profiler.timeline.maxevents")(100000u));
+
 	props << cfg.Get(Property("resumerendering.filesafe")(true));
 
 	// Debug
@@ -20,6 +20,7 @@
 
 #include "slg/rendersession.h"
 #include "slg/renderstate.h"
+#include "slg/utils/profiler.h"
 #include "luxrays/utils/safesave.h"
 
 using namespace std;
@@ -79,6 +80,10 @@ void RenderSession::Start() {
 		film = renderConfig->AllocFilm();
 	}
 
+	Profiler::Reset();
+	if (renderConfig->GetProperty("profiler.timeline.file").Get<string>() != "")
+		Profiler::StartTimeline(renderConfig->GetProperty("profiler.timeline.maxevents").Get<u_int>());
+
 	renderEngine->Start(film, &filmMutex);
 }
 
@@ -87,6 +92,11 @@ void RenderSession::Stop() {
 	CheckPeriodicSave(true);
 
 	renderEngine->Stop();
+
+	// The rendering threads are now stopped
+	const string timelineFileName = renderConfig->GetProperty("profiler.timeline.file").Get<string>();
+	if (timelineFileName != "")
+		Profiler::SaveTimeline(timelineFileName);
 }
 
 void RenderSession::BeginSceneEdit() {
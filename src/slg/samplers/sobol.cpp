@@ -27,18 +27,140 @@ using namespace std;
 using namespace luxrays;
 using namespace slg;
 
+//------------------------------------------------------------------------------
+// Transform a pixel bucket index in a film sub region pixel coordinate,
+// returns false if the pixel is out of the film sub region
+//------------------------------------------------------------------------------
+
+static inline bool BucketPixelToSubRegionPixel(const u_int pixelBucketIndex,
+		const u_int tileSize, const u_int tiletWidthCount,
+		const u_int subRegionWidth, const u_int subRegionHeight,
+		u_int *subRegionPixelX, u_int *subRegionPixelY) {
+	const u_int mortonCurveOffset = pixelBucketIndex % (tileSize * tileSize);
+	const u_int pixelTileIndex = pixelBucketIndex / (tileSize * tileSize);
+
+	*subRegionPixelX = (pixelTileIndex % tiletWidthCount) * tileSize + DecodeMorton2X(mortonCurveOffset);
+	*subRegionPixelY = (pixelTileIndex / tiletWidthCount) * tileSize + DecodeMorton2Y(mortonCurveOffset);
+
+	return (*subRegionPixelX < subRegionWidth) && (*subRegionPixelY < subRegionHeight);
+}
+
+//------------------------------------------------------------------------------
+// SobolAdaptiveDistribution
+//------------------------------------------------------------------------------
+
+SobolAdaptiveDistribution::SobolAdaptiveDistribution(const Film *film, const u_int *filmSubRegion,
+		const u_int bucketSz, const u_int tileSize,
+		const float adaptiveStrength, const float adaptiveUserImportanceWeight) :
+		bucketSize(bucketSz), bucketDistribution(nullptr) {
+	const u_int subRegionWidth = filmSubRegion[1] - filmSubRegion[0] + 1;
+	const u_int subRegionHeight = filmSubRegion[3] - filmSubRegion[2] + 1;
+
+	const u_int tiletWidthCount = (subRegionWidth + tileSize - 1) / tileSize;
+	const u_int tileHeightCount = (subRegionHeight + tileSize - 1) / tileSize;
+
+	const u_int pixelBucketCount = (tiletWidthCount * tileSize * tileHeightCount * tileSize + bucketSize - 1) / bucketSize;
+
+	pixelImportance.resize(pixelBucketCount * bucketSize, 0.f);
+
+	const bool hasUserImportance = film->HasChannel(Film::USER_IMPORTANCE);
+	float minImportance = numeric_limits<float>::infinity();
+	float maxImportance = 0.f;
+	for (u_int pixelBucketIndex = 0; pixelBucketIndex < pixelImportance.size(); ++pixelBucketIndex) {
+		u_int subRegionPixelX, subRegionPixelY;
+		if (!BucketPixelToSubRegionPixel(pixelBucketIndex, tileSize, tiletWidthCount,
+				subRegionWidth, subRegionHeight, &subRegionPixelX, &subRegionPixelY))
+			continue;
+
+		const u_int pixelX = filmSubRegion[0] + subRegionPixelX;
+		const u_int pixelY = filmSubRegion[2] + subRegionPixelY;
+
+		// Pixels are sampled in accordance with how far from convergence they are
+		const float noise = *(film->channel_NOISE->GetPixel(pixelX, pixelY));
+
+		// Factor user driven importance sampling too
+		float threshold;
+		if (hasUserImportance) {
+			const float userImportance = *(film->channel_USER_IMPORTANCE->GetPixel(pixelX, pixelY));
+
+			// Noise is initialized to INFINITY at start
+			if (isinf(noise))
+				threshold = userImportance;
+			else
+				threshold = (userImportance > 0.f) ? Lerp(adaptiveUserImportanceWeight, noise, userImportance) : 0.f;
+		} else
+			threshold = noise;
+
+		// The floor for the pixel importance is given by the adaptiveness strength
+		threshold = Max(threshold, 1.f - adaptiveStrength);
+
+		// The importance is the probability the pixel was accepted with the
+		// old rejection sampling
+		const float importance = Min(threshold, 1.f);
+
+		pixelImportance[pixelBucketIndex] = importance;
+		minImportance = Min(minImportance, importance);
+		maxImportance = Max(maxImportance, importance);
+	}
+
+	// A uniform distribution is sampled with a plain walk over the buckets
+	if (minImportance < maxImportance) {
+		vector<float> bucketImportance(pixelBucketCount, 0.f);
+		for (u_int pixelBucketIndex = 0; pixelBucketIndex < pixelImportance.size(); ++pixelBucketIndex)
+			bucketImportance[pixelBucketIndex / bucketSize] += pixelImportance[pixelBucketIndex];
+
+		bucketDistribution = new Distribution1D(&bucketImportance[0], pixelBucketCount);
+	}
+}
+
+SobolAdaptiveDistribution::~SobolAdaptiveDistribution() {
+	delete bucketDistribution;
+}
+
+u_int SobolAdaptiveDistribution::SampleBucket(const float u) const {
+	float pdf;
+	return bucketDistribution->SampleDiscrete(u, &pdf);
+}
+
+u_int SobolAdaptiveDistribution::SamplePixel(const u_int pixelBucketIndex, const float u) const {
+	const float *importance = &pixelImportance[pixelBucketIndex * bucketSize];
+
+	float importanceSum = 0.f;
+	for (u_int i = 0; i < bucketSize; ++i)
+		importanceSum += importance[i];
+
+	float target = u * importanceSum;
+	u_int lastValidOffset = 0;
+	for (u_int i = 0; i < bucketSize; ++i) {
+		if (importance[i] > 0.f) {
+			if (target < importance[i])
+				return i;
+
+			target -= importance[i];
+			lastValidOffset = i;
+		}
+	}
+
+	// Only in case of rounding errors
+	return lastValidOffset;
+}
+
 //------------------------------------------------------------------------------
 // SobolSamplerSharedData
 //------------------------------------------------------------------------------
 
-SobolSamplerSharedData::SobolSamplerSharedData(const u_int seed, Film *engineFlm) : SamplerSharedData() {
+SobolSamplerSharedData::SobolSamplerSharedData(const u_int seed, Film *engineFlm) :
+		SamplerSharedData(), adaptiveDistributionVersion(0),
+		adaptiveDistributionNoiseVersion(0) {
 	engineFilm = engineFlm;
 	seedBase = seed;
 	
 	Reset();
 }
 
-SobolSamplerSharedData::SobolSamplerSharedData(RandomGenerator *rndGen, Film *engineFlm) : SamplerSharedData() {
+SobolSamplerSharedData::SobolSamplerSharedData(RandomGenerator *rndGen, Film *engineFlm) :
+		SamplerSharedData(), adaptiveDistributionVersion(0),
+		adaptiveDistributionNoiseVersion(0) {
 	engineFilm = engineFlm;
 	seedBase = rndGen->uintValue() % (0xFFFFFFFFu - 1u) + 1u;
 
@@ -56,13 +178,42 @@ void SobolSamplerSharedData::Reset() {
 		passPerPixel.resize(1, SOBOL_STARTOFFSET);
 
 	bucketIndex = 0;
+
+	SetAdaptiveDistribution(nullptr, 0);
 }
 
 void SobolSamplerSharedData::GetNewBucket(const u_int bucketCount,
 		u_int *newBucketIndex, u_int *seed) {
 	*newBucketIndex = AtomicInc(&bucketIndex) % bucketCount;
 
-	*seed = (seedBase + *newBucketIndex) % (0xFFFFFFFFu - 1u) + 1u;
+	*seed = GetBucketSeed(*newBucketIndex);
+}
+
+u_int SobolSamplerSharedData::GetBucketSeed(const u_int index) const {
+	return (seedBase + index) % (0xFFFFFFFFu - 1u) + 1u;
+}
+
+shared_ptr<const SobolAdaptiveDistribution> SobolSamplerSharedData::GetAdaptiveDistribution(u_int *version) {
+	boost::unique_lock<boost::mutex> lock(adaptiveDistributionMutex);
+
+	*version = adaptiveDistributionVersion;
+	return adaptiveDistribution;
+}
+
+bool SobolSamplerSharedData::IsAdaptiveDistributionOutdated() {
+	boost::unique_lock<boost::mutex> lock(adaptiveDistributionMutex);
+
+	return !adaptiveDistribution ||
+			(adaptiveDistributionNoiseVersion != engineFilm->GetNoiseChannelVersion());
+}
+
+void SobolSamplerSharedData::SetAdaptiveDistribution(const shared_ptr<const SobolAdaptiveDistribution> &dist,
+		const u_int noiseChannelVersion) {
+	boost::unique_lock<boost::mutex> lock(adaptiveDistributionMutex);
+
+	adaptiveDistribution = dist;
+	adaptiveDistributionNoiseVersion = noiseChannelVersion;
+	++adaptiveDistributionVersion;
 }
 
 u_int SobolSamplerSharedData::GetNewPixelPass(const u_int pixelIndex) {
@@ -89,16 +240,79 @@ SobolSampler::SobolSampler(RandomGenerator *rnd, Film *flm,
 		const FilmSampleSplatter *flmSplatter, const bool imgSamplesEnable,
 		const float adaptiveStr, const float adaptiveUserImpWeight,
 		const u_int bucketSz, const u_int tileSz, const u_int superSmpl,
-		const u_int overlap, SobolSamplerSharedData *samplerSharedData) :
+		const u_int overlap, const bool owenScrambling,
+		SobolSamplerSharedData *samplerSharedData) :
 		Sampler(rnd, flm, flmSplatter, imgSamplesEnable),
 		sharedData(samplerSharedData), sobolSequence(), adaptiveStrength(adaptiveStr),
 		adaptiveUserImportanceWeight(adaptiveUserImpWeight), bucketSize(bucketSz),
-		tileSize(tileSz), superSampling(superSmpl), overlapping(overlap) {
+		tileSize(tileSz), superSampling(superSmpl), overlapping(overlap),
+		adaptiveDistributionVersion(0), adaptiveBucket(false), adaptivePixelOffset(0),
+		bucketRng0(bucketSz * superSmpl), bucketRng1(bucketSz * superSmpl),
+		bucketRngPass(bucketSz * superSmpl) {
+	sobolSequence.owenScrambling = owenScrambling;
 }
 
 SobolSampler::~SobolSampler() {
 }
 
+void SobolSampler::InitNewBucket(const u_int bucketCount, const u_int *filmSubRegion) {
+	u_int bucketSeed;
+	sharedData->GetNewBucket(bucketCount, &bucketIndex, &bucketSeed);
+
+	adaptiveBucket = false;
+	if (filmSubRegion && (adaptiveStrength > 0.f) && sharedData->engineFilm->HasChannel(Film::NOISE)) {
+		// The thread starting a new pass rebuilds the importance distribution
+		// if the NOISE channel has been updated in the meantime
+		if ((bucketIndex == 0) && sharedData->IsAdaptiveDistributionOutdated()) {
+			// Read the version first so an update during the build is not lost
+			const u_int noiseChannelVersion = sharedData->engineFilm->GetNoiseChannelVersion();
+
+			sharedData->SetAdaptiveDistribution(make_shared<const SobolAdaptiveDistribution>(
+					sharedData->engineFilm, filmSubRegion, bucketSize, tileSize,
+					adaptiveStrength, adaptiveUserImportanceWeight), noiseChannelVersion);
+		}
+
+		// Pick up the latest importance distribution
+		if (adaptiveDistributionVersion != sharedData->GetAdaptiveDistributionVersion())
+			adaptiveDistribution = sharedData->GetAdaptiveDistribution(&adaptiveDistributionVersion);
+
+		if (adaptiveDistribution && !adaptiveDistribution->IsUniform()) {
+			// Draw the bucket directly from the importance distribution
+			const u_int pixelBucketIndex = adaptiveDistribution->SampleBucket(rndGen->floatValue());
+
+			bucketIndex = pixelBucketIndex * overlapping + bucketIndex % overlapping;
+			bucketSeed = sharedData->GetBucketSeed(bucketIndex);
+
+			adaptiveBucket = true;
+		}
+	}
+
+	// Initialize the rng0, rng1 and rngPass generator
+	rngGenerator.init(bucketSeed);
+
+	if (adaptiveBucket) {
+		// Pixels are not visited in order so rng0, rng1 and rngPass of each
+		// sub-sample of each pixel are generated in advance, in the same order
+		// of a plain walk
+		const u_int subRegionWidth = filmSubRegion[1] - filmSubRegion[0] + 1;
+		const u_int subRegionHeight = filmSubRegion[3] - filmSubRegion[2] + 1;
+		const u_int tiletWidthCount = (subRegionWidth + tileSize - 1) / tileSize;
+
+		for (u_int i = 0; i < bucketSize; ++i) {
+			u_int subRegionPixelX, subRegionPixelY;
+			if (BucketPixelToSubRegionPixel((bucketIndex / overlapping) * bucketSize + i,
+					tileSize, tiletWidthCount, subRegionWidth, subRegionHeight,
+					&subRegionPixelX, &subRegionPixelY)) {
+				for (u_int j = i * superSampling; j < (i + 1) * superSampling; ++j) {
+					bucketRng0[j] = rngGenerator.floatValue();
+					bucketRng1[j] = rngGenerator.floatValue();
+					bucketRngPass[j] = rngGenerator.uintValue();
+				}
+			}
+		}
+	}
+}
+
 void SobolSampler::InitNewSample() {
 	const bool doImageSamples = (imageSamplesEnable && film);
 
@@ -115,8 +329,10 @@ void SobolSampler::InitNewSample() {
 		tileHeightCount = (subRegionHeight + tileSize - 1) / tileSize;
 
 		bucketCount = overlapping * (tiletWidthCount * tileSize * tileHeightCount * tileSize + bucketSize - 1) / bucketSize;
-	} else
+	} else {
+		filmSubRegion = nullptr;
 		bucketCount = 0xffffffffu;
+	}
 
 	// Update pixelIndexOffset
 
@@ -128,15 +344,16 @@ void SobolSampler::InitNewSample() {
 
 			if (pixelOffset >= bucketSize) {
 				// Ask for a new bucket
-				u_int bucketSeed;
-				sharedData->GetNewBucket(bucketCount,
-						&bucketIndex, &bucketSeed);
+				InitNewBucket(bucketCount, filmSubRegion);
 
 				pixelOffset = 0;
 				passOffset = 0;
+			}
 
-				// Initialize the rng0, rng1 and rngPass generator
-				rngGenerator.init(bucketSeed);
+			if (adaptiveBucket) {
+				// Pick the pixel of the bucket in accordance with its importance
+				adaptivePixelOffset = adaptiveDistribution->SamplePixel(bucketIndex / overlapping,
+						rndGen->floatValue());
 			}
 		}
 
@@ -146,13 +363,12 @@ void SobolSampler::InitNewSample() {
 		if (doImageSamples) {
 			// Transform the bucket index in a pixel coordinate
 
-			const u_int pixelBucketIndex = (bucketIndex / overlapping) * bucketSize + pixelOffset;
-			const u_int mortonCurveOffset = pixelBucketIndex % (tileSize * tileSize);
-			const u_int pixelTileIndex = pixelBucketIndex / (tileSize * tileSize);
+			const u_int pixelBucketIndex = (bucketIndex / overlapping) * bucketSize +
+					(adaptiveBucket ? adaptivePixelOffset : pixelOffset);
 
-			const u_int subRegionPixelX = (pixelTileIndex % tiletWidthCount) * tileSize + DecodeMorton2X(mortonCurveOffset);
-			const u_int subRegionPixelY = (pixelTileIndex / tiletWidthCount) * tileSize + DecodeMorton2Y(mortonCurveOffset);
-			if ((subRegionPixelX >= subRegionWidth) || (subRegionPixelY >= subRegionHeight)) {
+			u_int subRegionPixelX, subRegionPixelY;
+			if (!BucketPixelToSubRegionPixel(pixelBucketIndex, tileSize, tiletWidthCount,
+					subRegionWidth, subRegionHeight, &subRegionPixelX, &subRegionPixelY)) {
 				// Skip the pixels out of the film sub region
 				continue;
 			}
@@ -160,40 +376,6 @@ void SobolSampler::InitNewSample() {
 			pixelX = filmSubRegion[0] + subRegionPixelX;
 			pixelY = filmSubRegion[2] + subRegionPixelY;
 
-			// Check if the current pixel is over or under the convergence threshold
-			const Film *film = sharedData->engineFilm;
-			if ((adaptiveStrength > 0.f) && film->HasChannel(Film::NOISE)) {
-				// Pixels are sampled in accordance with how far from convergence they are
-				const float noise = *(film->channel_NOISE->GetPixel(pixelX, pixelY));
-
-				// Factor user driven importance sampling too
-				float threshold;
-				if (film->HasChannel(Film::USER_IMPORTANCE)) {
-					const float userImportance = *(film->channel_USER_IMPORTANCE->GetPixel(pixelX, pixelY));
-
-					// Noise is initialized to INFINITY at start
-					if (isinf(noise))
-						threshold = userImportance;
-					else
-						threshold = (userImportance > 0.f) ? Lerp(adaptiveUserImportanceWeight, noise, userImportance) : 0.f;
-				} else
-					threshold = noise;
-
-				// The floor for the pixel importance is given by the adaptiveness strength
-				threshold = Max(threshold, 1.f - adaptiveStrength);
-
-				if (rndGen->floatValue() > threshold) {
-
-					// Workaround for preserving random number distribution behavior
-					rngGenerator.floatValue();
-					rngGenerator.floatValue();
-					rngGenerator.uintValue();
-
-					// Skip this pixel and try the next one
-					continue;
-				}
-			}
-
 			pass = sharedData->GetNewPixelPass(subRegionPixelX + subRegionPixelY * subRegionWidth);
 		} else {
 			pixelX = 0;
@@ -204,9 +386,16 @@ void SobolSampler::InitNewSample() {
 
 		// Initialize rng0, rng1 and rngPass
 
-		sobolSequence.rng0 = rngGenerator.floatValue();
-		sobolSequence.rng1 = rngGenerator.floatValue();
-		sobolSequence.rngPass = rngGenerator.uintValue();
+		if (adaptiveBucket) {
+			const u_int rngIndex = adaptivePixelOffset * superSampling + passOffset;
+			sobolSequence.rng0 = bucketRng0[rngIndex];
+			sobolSequence.rng1 = bucketRng1[rngIndex];
+			sobolSequence.rngPass = bucketRngPass[rngIndex];
+		} else {
+			sobolSequence.rng0 = rngGenerator.floatValue();
+			sobolSequence.rng1 = rngGenerator.floatValue();
+			sobolSequence.rngPass = rngGenerator.uintValue();
+		}
 
 		sample0 = pixelX +  sobolSequence.GetSample(pass, 0);
 		sample1 = pixelY +  sobolSequence.GetSample(pass, 1);
@@ -287,7 +476,8 @@ Properties SobolSampler::ToProperties() const {
 			Property("sampler.sobol.bucketsize")(bucketSize) <<
 			Property("sampler.sobol.tilesize")(tileSize) <<
 			Property("sampler.sobol.supersampling")(superSampling) <<
-			Property("sampler.sobol.overlapping")(overlapping);
+			Property("sampler.sobol.overlapping")(overlapping) <<
+			Property("sampler.sobol.owenscrambling.enable")(sobolSequence.owenScrambling);
 }
 
 //------------------------------------------------------------------------------
@@ -303,7 +493,8 @@ Properties SobolSampler::ToProperties(const Properties &cfg) {
 			cfg.Get(GetDefaultProps().Get("sampler.sobol.bucketsize")) <<
 			cfg.Get(GetDefaultProps().Get("sampler.sobol.tilesize")) <<
 			cfg.Get(GetDefaultProps().Get("sampler.sobol.supersampling")) <<
-			cfg.Get(GetDefaultProps().Get("sampler.sobol.overlapping"));
+			cfg.Get(GetDefaultProps().Get("sampler.sobol.overlapping")) <<
+			cfg.Get(GetDefaultProps().Get("sampler.sobol.owenscrambling.enable"));
 }
 
 Sampler *SobolSampler::FromProperties(const Properties &cfg, RandomGenerator *rndGen,
@@ -316,10 +507,11 @@ Sampler *SobolSampler::FromProperties(const Properties &cfg, RandomGenerator *rn
 	const float tileSize = RoundUpPow2(cfg.Get(GetDefaultProps().Get("sampler.sobol.tilesize")).Get<u_int>());
 	const float superSampling = cfg.Get(GetDefaultProps().Get("sampler.sobol.supersampling")).Get<u_int>();
 	const float overlapping = cfg.Get(GetDefaultProps().Get("sampler.sobol.overlapping")).Get<u_int>();
+	const bool owenScrambling = cfg.Get(GetDefaultProps().Get("sampler.sobol.owenscrambling.enable")).Get<bool>();
 
 	return new SobolSampler(rndGen, film, flmSplatter, imageSamplesEnable,
 			adaptiveStrength, adaptiveUserImportanceWeight,
-			bucketSize, tileSize, superSampling, overlapping,
+			bucketSize, tileSize, superSampling, overlapping, owenScrambling,
 			(SobolSamplerSharedData *)sharedData);
 }
 
@@ -334,6 +526,10 @@ slg::ocl::Sampler *SobolSampler::FromPropertiesOCL(const Properties &cfg) {
 	oclSampler->sobol.superSampling = cfg.Get(GetDefaultProps().Get("sampler.sobol.supersampling")).Get<u_int>();
 	oclSampler->sobol.overlapping = cfg.Get(GetDefaultProps().Get("sampler.sobol.overlapping")).Get<u_int>();
 
+	// Owen scrambling is supported only by the CPU sampler
+	if (cfg.Get(GetDefaultProps().Get("sampler.sobol.owenscrambling.enable")).Get<bool>())
+		SLG_LOG("WARNING: sampler.sobol.owenscrambling.enable is not supported by OpenCL engines and is ignored");
+
 	return oclSampler;
 }
 
@@ -355,7 +551,8 @@ const Properties &SobolSampler::GetDefaultProps() {
 			Property("sampler.sobol.bucketsize")(16) <<
 			Property("sampler.sobol.tilesize")(16) <<
 			Property("sampler.sobol.supersampling")(1) <<
-			Property("sampler.sobol.overlapping")(1);
+			Property("sampler.sobol.overlapping")(1) <<
+			Property("sampler.sobol.owenscrambling.enable")(false);
 
 	return props;
 }
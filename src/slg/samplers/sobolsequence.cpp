@@ -17,6 +17,7 @@
  ***************************************************************************/
 
 #include <math.h>
+#include <algorithm>
 
 #include "slg/samplers/sobolsequence.h"
 
@@ -28,7 +29,46 @@ using namespace slg;
 // SobolSequence
 //------------------------------------------------------------------------------
 
-SobolSequence::SobolSequence() : directions(NULL) {
+//------------------------------------------------------------------------------
+// Hashed Owen scrambling
+//
+// From "Practical Hash-based Owen Scrambling" by Brent Burley
+//------------------------------------------------------------------------------
+
+static inline u_int ReverseBits(u_int x) {
+	x = ((x >> 1) & 0x55555555u) | ((x & 0x55555555u) << 1);
+	x = ((x >> 2) & 0x33333333u) | ((x & 0x33333333u) << 2);
+	x = ((x >> 4) & 0x0f0f0f0fu) | ((x & 0x0f0f0f0fu) << 4);
+	x = ((x >> 8) & 0x00ff00ffu) | ((x & 0x00ff00ffu) << 8);
+
+	return (x >> 16) | (x << 16);
+}
+
+static inline u_int LaineKarrasPermutation(u_int x, const u_int seed) {
+	x += seed;
+	x ^= x * 0x6c50b47cu;
+	x ^= x * 0xb82f1e52u;
+	x ^= x * 0xc7afe638u;
+	x ^= x * 0x8d22f6e6u;
+
+	return x;
+}
+
+static inline u_int NestedUniformScramble(const u_int x, const u_int seed) {
+	return ReverseBits(LaineKarrasPermutation(ReverseBits(x), seed));
+}
+
+static inline u_int HashCombine(const u_int seed, const u_int v) {
+	return seed ^ (v + (seed << 6) + (seed >> 2));
+}
+
+//------------------------------------------------------------------------------
+// SobolSequence
+//------------------------------------------------------------------------------
+
+SobolSequence::SobolSequence() : owenScrambling(false), dimensionCount(0),
+		directions(nullptr), directionTables(nullptr), values(nullptr),
+		valuesIndex(0), valuesValid(false) {
 	rngPass = 0;
 	rng0 = 0.f;
 	rng1 = 0.f;
@@ -36,11 +76,41 @@ SobolSequence::SobolSequence() : directions(NULL) {
 
 SobolSequence::~SobolSequence() {
 	delete[] directions;
+	delete[] directionTables;
+	delete[] values;
 }
 
 void SobolSequence::RequestSamples(const u_int size) {
+	dimensionCount = size;
+
+	delete[] directions;
 	directions = new u_int[size * SOBOL_BITS];
 	GenerateDirectionVectors(directions, size);
+
+	// Build the tables
+	delete[] directionTables;
+	directionTables = new u_int[SOBOL_TABLE_DIGITS * SOBOL_TABLE_DIGIT_VALUES * size];
+	for (u_int digit = 0; digit < SOBOL_TABLE_DIGITS; ++digit) {
+		for (u_int value = 0; value < SOBOL_TABLE_DIGIT_VALUES; ++value) {
+			u_int *table = &directionTables[(digit * SOBOL_TABLE_DIGIT_VALUES + value) * size];
+
+			for (u_int dimension = 0; dimension < size; ++dimension) {
+				const u_int *dimensionDirections = &directions[dimension * SOBOL_BITS + digit * SOBOL_TABLE_DIGIT_BITS];
+
+				u_int result = 0;
+				for (u_int j = 0; j < SOBOL_TABLE_DIGIT_BITS; ++j) {
+					if (value & (1u << j))
+						result ^= dimensionDirections[j];
+				}
+
+				table[dimension] = result;
+			}
+		}
+	}
+
+	delete[] values;
+	values = new u_int[size];
+	valuesValid = false;
 }
 
 u_int SobolSequence::SobolDimension(const u_int index, const u_int dimension) const {
@@ -56,14 +126,45 @@ u_int SobolSequence::SobolDimension(const u_int index, const u_int dimension) co
 	return result;
 }
 
+void SobolSequence::GenerateSamples(const u_int index, u_int *result) const {
+	fill(result, result + dimensionCount, 0u);
+
+	u_int i = index;
+	for (u_int digit = 0; i; i >>= SOBOL_TABLE_DIGIT_BITS, ++digit) {
+		const u_int value = i & (SOBOL_TABLE_DIGIT_VALUES - 1u);
+		if (value) {
+			const u_int *table = &directionTables[(digit * SOBOL_TABLE_DIGIT_VALUES + value) * dimensionCount];
+
+			for (u_int dimension = 0; dimension < dimensionCount; ++dimension)
+				result[dimension] ^= table[dimension];
+		}
+	}
+}
+
 float SobolSequence::GetSample(const u_int pass, const u_int index) {
 	// I scramble pass too in order avoid correlations visible with LIGHTCPU and BIDIRCPU
-	const u_int iResult = SobolDimension(pass + rngPass, index);
-	const float fResult = iResult * (1.f / 0xffffffffu);
-	
-	// Cranley-Patterson rotation to reduce visible regular patterns
-	const float shift = (index & 1) ? rng0 : rng1;
-	const float val = fResult + shift;
-
-	return val - floorf(val);
+	const u_int sobolIndex = pass + rngPass;
+	if (!valuesValid || (sobolIndex != valuesIndex)) {
+		GenerateSamples(sobolIndex, values);
+
+		valuesIndex = sobolIndex;
+		valuesValid = true;
+	}
+
+	const u_int iResult = values[index];
+
+	if (owenScrambling) {
+		const u_int seed = HashCombine(rngPass, index);
+
+		// Only 24 bits fit in a float mantissa
+		return (NestedUniformScramble(iResult, seed) >> 8) * (1.f / 16777216.f);
+	} else {
+		const float fResult = iResult * (1.f / 0xffffffffu);
+
+		// Cranley-Patterson rotation to reduce visible regular patterns
+		const float shift = (index & 1) ? rng0 : rng1;
+		const float val = fResult + shift;
+
+		return val - floorf(val);
+	}
 }
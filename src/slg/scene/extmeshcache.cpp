@@ -135,6 +135,30 @@ void ExtMeshCache::GetExtMeshNames(std::vector<std::string> &names) const {
 	meshes.GetNames(names);
 }
 
+size_t ExtMeshCache::GetMemoryUsage() const {
+	size_t size = 0;
+	for (u_int i = 0; i < meshes.GetSize(); ++i) {
+		const ExtMesh *mesh = static_cast<const ExtMesh *>(meshes.GetObj(i));
+
+		if (mesh->GetType() == TYPE_EXT_TRIANGLE)
+			size += static_cast<const ExtTriangleMesh *>(mesh)->GetMemoryUsage();
+	}
+
+	return size;
+}
+
+size_t ExtMeshCache::GetUncompressedMemoryUsage() const {
+	size_t size = 0;
+	for (u_int i = 0; i < meshes.GetSize(); ++i) {
+		const ExtMesh *mesh = static_cast<const ExtMesh *>(meshes.GetObj(i));
+
+		if (mesh->GetType() == TYPE_EXT_TRIANGLE)
+			size += static_cast<const ExtTriangleMesh *>(mesh)->GetUncompressedMemoryUsage();
+	}
+
+	return size;
+}
+
 ExtMesh *ExtMeshCache::GetExtMesh(const string &meshName) {
 	return static_cast<ExtMesh *>(meshes.GetObj(meshName));
 }
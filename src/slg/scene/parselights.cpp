@@ -249,6 +249,11 @@ LightSource *Scene::CreateLightSource(const string &name, const luxrays::Propert
 		sl->distributionWidth = props.Get(Property(propName + ".distribution.width")(512)).Get<u_int>();
 		sl->distributionHeight = props.Get(Property(propName + ".distribution.height")(256)).Get<u_int>();
 
+		// Baked radiance table related options
+		sl->useRadianceTable = props.Get(Property(propName + ".radiancetable.enable")(false)).Get<bool>();
+		sl->radianceTableWidth = Max(2u, props.Get(Property(propName + ".radiancetable.width")(1024)).Get<u_int>());
+		sl->radianceTableHeight = Max(2u, props.Get(Property(propName + ".radiancetable.height")(512)).Get<u_int>());
+
 		// Visibility map cache related options
 		sl->useVisibilityMapCache = props.Get(Property(propName + ".visibilitymapcache.enable")(false)).Get<bool>();
 		if (sl->useVisibilityMapCache)
@@ -267,6 +272,9 @@ LightSource *Scene::CreateLightSource(const string &name, const luxrays::Propert
 		il->lightToWorld = light2World;
 		il->imageMap = imgMap;
 		il->sampleUpperHemisphereOnly = props.Get(Property(propName + ".sampleupperhemisphereonly")(false)).Get<bool>();
+		il->distributionWidth = props.Get(Property(propName + ".distribution.width")(0)).Get<u_int>();
+		il->distributionHeight = props.Get(Property(propName + ".distribution.height")(0)).Get<u_int>();
+		il->imageMapCache = &imgMapCache;
 
 		il->SetIndirectDiffuseVisibility(props.Get(Property(propName + ".visibility.indirect.diffuse.enable")(true)).Get<bool>());
 		il->SetIndirectGlossyVisibility(props.Get(Property(propName + ".visibility.indirect.glossy.enable")(true)).Get<bool>());
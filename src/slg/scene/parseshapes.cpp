@@ -145,6 +145,27 @@ ExtTriangleMesh *Scene::CreateShape(const string &shapeName, const Properties &p
 
 	// Get the shape type
 	const string shapeType = props.Get(Property(propName + ".type")("mesh")).Get<string>();
+	const bool compress = props.Get(Property(propName + ".compress")(false)).Get<bool>();
+
+	// Check if the result of an expensive shape modifier is already available
+	// in the persistent cache
+	string shapeCacheKey;
+	if (shapeCache.IsEnabled()) {
+		shapeCacheKey = shapeCache.GetKey(this, shapeType, propName, props);
+
+		if (shapeCacheKey != "") {
+			ExtTriangleMesh *mesh = shapeCache.Load(shapeCacheKey);
+			if (mesh) {
+				SDL_LOG("Shape " << shapeName << " loaded from the shape cache: " << shapeCacheKey);
+
+				mesh->SetName(shapeName);
+				if (compress)
+					mesh->Compress();
+
+				return mesh;
+			}
+		}
+	}
 
 	// Define the shape
 	Shape *shape;
@@ -394,5 +415,19 @@ ExtTriangleMesh *Scene::CreateShape(const string &shapeName, const Properties &p
 	delete shape;
 	mesh->SetName(shapeName);
 
+	if (shapeCacheKey != "") {
+		try {
+			shapeCache.Save(shapeCacheKey, mesh);
+			SDL_LOG("Shape " << shapeName << " saved in the shape cache: " << shapeCacheKey);
+		} catch (runtime_error &err) {
+			// A failure of the cache is not fatal
+			SDL_LOG("Unable to save shape " << shapeName << " in the shape cache: " << err.what());
+		}
+	}
+
+	// Optional compression of vertex normals, UVs and colors
+	if (compress)
+		mesh->Compress();
+
 	return mesh;
 }
@@ -43,6 +43,7 @@
 #include "slg/textures/constfloat3.h"
 #include "slg/textures/imagemaptex.h"
 #include "slg/utils/pathinfo.h"
+#include "slg/utils/profiler.h"
 
 using namespace std;
 using namespace luxrays;
@@ -69,6 +70,10 @@ void Scene::Init(const luxrays::Properties *resizePolicyProps) {
 
 	dataSet = NULL;
 
+	preprocessTimes.dataSetTime = 0.0;
+	preprocessTimes.lightsTime = 0.0;
+	preprocessTimes.imageMapsTime = 0.0;
+
 	editActions.AddAllAction();
 	if (resizePolicyProps)
 		imgMapCache.SetImageResizePolicy(ImageMapResizePolicy::FromProperties(*resizePolicyProps));
@@ -338,6 +343,15 @@ void Scene::Parse(const Properties &props) {
 
 	ParseCamera(props);
 
+	//--------------------------------------------------------------------------
+	// Read the shape cache settings
+	//
+	// note: it must be done before parsing the shapes
+	//--------------------------------------------------------------------------
+
+	if (props.HaveNames("scene.shapecache."))
+		shapeCache.Init(props);
+
 	//--------------------------------------------------------------------------
 	// Read all shapes
 	//--------------------------------------------------------------------------
@@ -553,11 +567,82 @@ void Scene::DeleteLights(vector<string> &lightNames) {
 
 //------------------------------------------------------------------------------
 
+namespace {
+
+// The occlusion query reports the hits out of order (and can report them more
+// than once) so each shadow ray hit has its own pseudo-random pass-through
+// event. The complete Scene::Intersect() loop uses the same values when it is
+// run after the occlusion query, otherwise a stochastic pass-through hit could
+// be sampled twice.
+float ShadowRayHitPassThrough(const u_int seed, const RayHit &hit) {
+	TauswortheRandomGenerator rng(seed ^ (hit.meshIndex * 0x9e3779b9u) ^
+			(hit.triangleIndex * 0x85ebca6bu));
+
+	return rng.floatValue();
+}
+
+u_int ShadowRayPassThroughSeed(const float initialPassThrough) {
+	u_int seed;
+	memcpy(&seed, &initialPassThrough, sizeof(float));
+
+	return seed;
+}
+
+class ShadowRayOcclusionFilter : public OcclusionFilter {
+public:
+	ShadowRayOcclusionFilter(const Scene &scn, const PathVolumeInfo &vi,
+			const u_int passThroughSeed, const bool fromLight, const bool backTracing) :
+			scene(scn), volInfo(vi), seed(passThroughSeed), fixedFromLight(fromLight),
+			backTracingRay(backTracing), fullTraceRequired(false) {
+	}
+	virtual ~ShadowRayOcclusionFilter() { }
+
+	virtual bool IsOccluder(const Ray &ray, const RayHit &hit) {
+		switch (scene.objShadowTypes[hit.meshIndex]) {
+			case SHADOW_OPAQUE:
+				return true;
+			case SHADOW_PASSTHROUGH: {
+				const float passThrough = ShadowRayHitPassThrough(seed, hit);
+
+				BSDF bsdf;
+				PathVolumeInfo vi = volInfo;
+				bsdf.Init(fixedFromLight, false, scene, ray, hit, passThrough, &vi);
+
+				const Spectrum transp = bsdf.GetPassThroughTransparency(backTracingRay);
+				if (transp.Black())
+					return true;
+
+				// Only a fully transparent hit can be skipped in place
+				if (transp != Spectrum(1.f))
+					fullTraceRequired = true;
+				return false;
+			}
+			default:
+				fullTraceRequired = true;
+				return false;
+		}
+	}
+
+	bool IsFullTraceRequired() const { return fullTraceRequired; }
+
+private:
+	const Scene &scene;
+	const PathVolumeInfo &volInfo;
+	const u_int seed;
+	const bool fixedFromLight, backTracingRay;
+
+	bool fullTraceRequired;
+};
+
+}
+
 bool Scene::Intersect(IntersectionDevice *device,
 		const SceneRayType rayType, PathVolumeInfo *volInfo,
 		const float initialPassThrough, Ray *ray, RayHit *rayHit, BSDF *bsdf,
 		Spectrum *connectionThroughput, const Spectrum *pathThroughput,
 		SampleResult *sampleResult, const bool backTracing) const {
+	SLG_PROFILE(PROFILER_SCENE_INTERSECT);
+
 	*connectionThroughput = Spectrum(1.f);
 
 	// I need a sequence of pseudo-random numbers starting form a floating point
@@ -576,12 +661,37 @@ bool Scene::Intersect(IntersectionDevice *device,
 	// intersection (and not BSDF initialization)
 	bsdf->hitPoint.throughShadowTransparency = false;
 
+	// Shadow rays outside of any volume can use the occlusion query: the
+	// traversal stops at the first opaque hit and fully transparent hits are
+	// skipped without restarting the ray
+	bool hitPassThrough = false;
+	u_int hitPassThroughSeed = 0;
+	if (shadowRay && !cameraRay && !sampleResult &&
+			!defaultWorldVolume && !volInfo->GetCurrentVolume()) {
+		hitPassThroughSeed = ShadowRayPassThroughSeed(initialPassThrough);
+		ShadowRayOcclusionFilter filter(*this, *volInfo, hitPassThroughSeed, fromLight, backTracing);
+
+		const bool occluded = device ? device->TraceOcclusionRay(ray, &filter) :
+			dataSet->GetAccelerator(ACCEL_EMBREE)->Occluded(ray, &filter);
+		if (occluded)
+			return true;
+		if (!filter.IsFullTraceRequired())
+			return false;
+
+		// Some hit requires the complete evaluation. The pass-through events
+		// of the hits must be the same used by the occlusion query.
+		hitPassThrough = true;
+	}
+
 	for (;;) {
 		bool hit = device ? device->TraceRay(ray, rayHit) : dataSet->GetAccelerator(ACCEL_EMBREE)->Intersect(ray, rayHit);
 
 		bool bevelContinueToTrace = !hit;
 		const Volume *rayVolume = volInfo->GetCurrentVolume();
 		if (hit) {		
+			if (hitPassThrough)
+				passThrough = ShadowRayHitPassThrough(hitPassThroughSeed, *rayHit);
+
 			bsdf->Init(fromLight, throughShadowTransparency, *this, *ray, *rayHit, passThrough, volInfo);
 			rayVolume = bsdf->hitPoint.intoObject ? bsdf->hitPoint.exteriorVolume : bsdf->hitPoint.interiorVolume;
 
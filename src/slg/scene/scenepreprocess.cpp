@@ -16,6 +16,8 @@
  * limitations under the License.                                          *
  ***************************************************************************/
 
+#include <boost/unordered_set.hpp>
+
 #include "luxrays/core/dataset.h"
 #include "luxrays/core/intersectiondevice.h"
 #include "slg/core/sdl.h"
@@ -33,12 +35,47 @@ void Scene::PreprocessCamera(const u_int filmWidth, const u_int filmHeight, cons
 	camera->Update(filmWidth, filmHeight, filmSubRegion);
 }
 
+void Scene::PreprocessObjectShadowTypes() {
+	objShadowTypes.resize(objDefs.GetSize());
+
+	for (u_int i = 0; i < objDefs.GetSize(); ++i) {
+		const SceneObject *obj = objDefs.GetSceneObject(i);
+
+		SceneObjectShadowType type = SHADOW_OPAQUE;
+		if (obj->GetExtMesh()->GetBevelRadius() > 0.f)
+			type = SHADOW_COMPLEX;
+		else {
+			boost::unordered_set<const Material *> referencedMats;
+			obj->GetMaterial()->AddReferencedMaterials(referencedMats);
+
+			for (auto const mat : referencedMats) {
+				if (mat->GetInteriorVolume() || mat->GetExteriorVolume() ||
+						!mat->GetPassThroughShadowTransparency().Black()) {
+					type = SHADOW_COMPLEX;
+					break;
+				}
+
+				if (mat->GetFrontTransparencyTexture() || mat->GetBackTransparencyTexture() ||
+						(mat->GetType() == NULLMAT) || (mat->GetType() == ARCHGLASS))
+					type = SHADOW_PASSTHROUGH;
+			}
+		}
+
+		objShadowTypes[i] = type;
+	}
+}
+
 void Scene::Preprocess(Context *ctx, const u_int filmWidth, const u_int filmHeight,
 		const u_int *filmSubRegion, const bool useRTMode) {
+	preprocessTimes.dataSetTime = 0.0;
+	preprocessTimes.lightsTime = 0.0;
+	preprocessTimes.imageMapsTime = 0.0;
+
 	//--------------------------------------------------------------------------
 	// Check if I have to update geometry
 	//--------------------------------------------------------------------------
 
+	const double dataSetStartTime = WallClockTime();
 	if (!dataSet || editActions.Has(GEOMETRY_EDIT) ||
 			(editActions.Has(GEOMETRY_TRANS_EDIT) &&
 				!dataSet->DoesAllAcceleratorsSupportUpdate())) {
@@ -67,6 +104,7 @@ void Scene::Preprocess(Context *ctx, const u_int filmWidth, const u_int filmHeig
 		dataSet->UpdateBBoxes();
 		ctx->UpdateDataSet();
 	}
+	preprocessTimes.dataSetTime = WallClockTime() - dataSetStartTime;
 	
 	// Only at this point I can safely trace rays
 
@@ -84,10 +122,23 @@ void Scene::Preprocess(Context *ctx, const u_int filmWidth, const u_int filmHeig
 	const BBox sceneBBox = Union(dataSet->GetBBox(), camera->GetBBox());
 	sceneBSphere = sceneBBox.BoundingSphere();		
 	
+	//--------------------------------------------------------------------------
+	// Check if I have to update the shadow ray information
+	//--------------------------------------------------------------------------
+
+	// This has to be done before the light sources because the visibility
+	// caches trace shadow rays
+	if ((objShadowTypes.size() != objDefs.GetSize()) ||
+			editActions.Has(GEOMETRY_EDIT) ||
+			editActions.Has(MATERIALS_EDIT) ||
+			editActions.Has(MATERIAL_TYPES_EDIT))
+		PreprocessObjectShadowTypes();
+
 	//--------------------------------------------------------------------------
 	// Check if something has changed in light sources
 	//--------------------------------------------------------------------------
 
+	const double lightsStartTime = WallClockTime();
 	if (editActions.Has(GEOMETRY_EDIT) ||
 			editActions.Has(GEOMETRY_TRANS_EDIT) ||
 			editActions.Has(MATERIALS_EDIT) ||
@@ -100,12 +151,15 @@ void Scene::Preprocess(Context *ctx, const u_int filmWidth, const u_int filmHeig
 
 	// And for visibility maps
 	lightDefs.UpdateVisibilityMaps(this, useRTMode);
+	preprocessTimes.lightsTime = WallClockTime() - lightsStartTime;
 
 	//--------------------------------------------------------------------------
 	// Preprocess image maps according resize policy
 	//--------------------------------------------------------------------------
 
+	const double imageMapsStartTime = WallClockTime();
 	imgMapCache.Preprocess(this, useRTMode);
+	preprocessTimes.imageMapsTime = WallClockTime() - imageMapsStartTime;
 	
 	//--------------------------------------------------------------------------
 	// Reset the edit actions
@@ -0,0 +1,453 @@
+/***************************************************************************
+ * Copyright 1998-2020 by authors (see AUTHORS.txt)                        *
+ *                                                                         *
+ *   This file is part of LuxCoreRender.                                   *
+ *                                                                         *
+ * Licensed under the Apache License, Version 2.0 (the "License");         *
+ * you may not use this file except in compliance with the License.        *
+ * You may obtain a copy of the License at                                 *
+ *                                                                         *
+ *     http://www.apache.org/licenses/LICENSE-2.0                          *
+ *                                                                         *
+ * Unless required by applicable law or agreed to in writing, software     *
+ * distributed under the License is distributed on an "AS IS" BASIS,       *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.*
+ * See the License for the specific language governing permissions and     *
+ * limitations under the License.                                          *
+ ***************************************************************************/
+
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <boost/unordered_set.hpp>
+
+#include "luxrays/core/exttrianglemesh.h"
+#include "luxrays/utils/config.h"
+#include "luxrays/utils/safesave.h"
+#include "slg/shapes/shapecache.h"
+#include "slg/scene/scene.h"
+
+using namespace std;
+using namespace luxrays;
+using namespace slg;
+
+// Increment this number every time the file format or the output of one of
+// the cached shapes changes
+#define SHAPECACHE_FORMAT_VERSION 1u
+
+namespace {
+
+//------------------------------------------------------------------------------
+// A 64bit FNV-1a hash, it has to be stable across runs and platforms
+//------------------------------------------------------------------------------
+
+class ShapeCacheHash {
+public:
+	ShapeCacheHash() : hash(14695981039346656037ull) { }
+
+	void Add(const void *data, const size_t size) {
+		const u_char *bytes = (const u_char *)data;
+		for (size_t i = 0; i < size; ++i) {
+			hash ^= bytes[i];
+			hash *= 1099511628211ull;
+		}
+	}
+
+	template<class T> void Add(const T &v) {
+		Add(&v, sizeof(T));
+	}
+
+	void Add(const string &s) {
+		Add((u_int)s.length());
+		Add(s.c_str(), s.length());
+	}
+
+	u_longlong Get() const { return hash; }
+
+private:
+	u_longlong hash;
+};
+
+//------------------------------------------------------------------------------
+// The on-disk header, followed by all the arrays of the mesh
+//------------------------------------------------------------------------------
+
+struct ShapeCacheHeader {
+	char magic[8];
+	u_int version;
+
+	u_int vertCount, triCount;
+
+	u_int hasNormals;
+	// One bit for each data index
+	u_int uvsMask, colsMask, alphasMask, vertAOVMask, triAOVMask;
+
+	float bevelRadius;
+	float appliedTrans[4][4];
+};
+
+static const char SHAPECACHE_MAGIC[8] = { 'L', 'X', 'S', 'H', 'A', 'P', 'E', 'C' };
+
+}
+
+static void HashMesh(ShapeCacheHash &hash, const ExtTriangleMesh *mesh) {
+	const u_int vertCount = mesh->GetTotalVertexCount();
+	const u_int triCount = mesh->GetTotalTriangleCount();
+
+	hash.Add(vertCount);
+	hash.Add(triCount);
+	hash.Add(mesh->GetVertices(), sizeof(Point) * vertCount);
+	hash.Add(mesh->GetTriangles(), sizeof(Triangle) * triCount);
+
+	Transform appliedTrans;
+	mesh->GetLocal2World(0.f, appliedTrans);
+	hash.Add(appliedTrans.m.m, sizeof(appliedTrans.m.m));
+
+	// The per vertex accessors work with compressed meshes too
+	if (mesh->HasNormals()) {
+		hash.Add('N');
+		for (u_int i = 0; i < vertCount; ++i)
+			hash.Add(mesh->GetVertexNormal(i));
+	}
+
+	for (u_int dataIndex = 0; dataIndex < EXTMESH_MAX_DATA_COUNT; ++dataIndex) {
+		hash.Add(dataIndex);
+
+		if (mesh->HasUVs(dataIndex)) {
+			hash.Add('U');
+			for (u_int i = 0; i < vertCount; ++i)
+				hash.Add(mesh->GetVertexUV(i, dataIndex));
+		}
+		if (mesh->HasColors(dataIndex)) {
+			hash.Add('C');
+			for (u_int i = 0; i < vertCount; ++i)
+				hash.Add(mesh->GetVertexColor(i, dataIndex));
+		}
+		if (mesh->HasAlphas(dataIndex)) {
+			hash.Add('A');
+			hash.Add(mesh->GetAlphas(dataIndex), sizeof(float) * vertCount);
+		}
+		if (mesh->HasVertexAOV(dataIndex)) {
+			hash.Add('V');
+			hash.Add(mesh->GetVertexAOVs(dataIndex), sizeof(float) * vertCount);
+		}
+		if (mesh->HasTriAOV(dataIndex)) {
+			hash.Add('T');
+			hash.Add(mesh->GetTriAOVs(dataIndex), sizeof(float) * triCount);
+		}
+	}
+}
+
+static void HashTexture(ShapeCacheHash &hash, const Scene *scene, const Texture *tex) {
+	boost::unordered_set<const Texture *> referencedTexs;
+	tex->AddReferencedTextures(referencedTexs);
+
+	boost::unordered_set<const ImageMap *> referencedImgMaps;
+	vector<string> texDescs;
+	for (auto const t : referencedTexs) {
+		texDescs.push_back(t->ToProperties(scene->imgMapCache, true).ToString());
+		t->AddReferencedImageMaps(referencedImgMaps);
+	}
+
+	// The iteration order of an unordered_set of pointers is not stable
+	// across runs so everything is sorted before being hashed
+	sort(texDescs.begin(), texDescs.end());
+	for (auto const &s : texDescs)
+		hash.Add(s);
+
+	vector<u_longlong> imgMapHashes;
+	for (auto const im : referencedImgMaps) {
+		const ImageMapStorage *storage = im->GetStorage();
+
+		ShapeCacheHash imgMapHash;
+		imgMapHash.Add(storage->width);
+		imgMapHash.Add(storage->height);
+		imgMapHash.Add(storage->GetChannelCount());
+		imgMapHash.Add((u_int)storage->GetStorageType());
+		imgMapHash.Add(storage->GetPixelsData(), storage->GetMemorySize());
+
+		imgMapHashes.push_back(imgMapHash.Get());
+	}
+	sort(imgMapHashes.begin(), imgMapHashes.end());
+	for (auto const h : imgMapHashes)
+		hash.Add(h);
+}
+
+//------------------------------------------------------------------------------
+// ShapeCache
+//------------------------------------------------------------------------------
+
+ShapeCache::ShapeCache() : enabled(false) {
+}
+
+ShapeCache::~ShapeCache() {
+}
+
+void ShapeCache::Init(const Properties &cfg) {
+	enabled = cfg.Get(Property("scene.shapecache.enable")(false)).Get<bool>();
+
+	path = cfg.Get(Property("scene.shapecache.path")("")).Get<string>();
+	if (path == "")
+		path = (GetConfigDir() / "shape_cache").generic_string();
+}
+
+bool ShapeCache::IsCacheable(const string &shapeType) {
+	return (shapeType == "subdiv") ||
+			(shapeType == "displacement") ||
+			(shapeType == "simplify") ||
+			(shapeType == "pointiness");
+}
+
+string ShapeCache::GetKey(Scene *scene, const string &shapeType,
+		const string &propName, const Properties &props) const {
+	if (!IsCacheable(shapeType))
+		return "";
+
+	const string sourceMeshName = props.Get(Property(propName + ".source")("")).Get<string>();
+	if (!scene->extMeshCache.IsExtMeshDefined(sourceMeshName))
+		return "";
+
+	ShapeCacheHash hash;
+	hash.Add(SHAPECACHE_FORMAT_VERSION);
+	hash.Add(shapeType);
+
+	// The shape parameters, without the shape name
+	const string prefix = propName + ".";
+	const vector<string> names = props.GetAllNames(prefix);
+	for (auto const &name : names) {
+		hash.Add(name.substr(prefix.length()));
+		hash.Add(props.Get(name).GetValuesString());
+	}
+
+	// The source mesh data
+	HashMesh(hash, (const ExtTriangleMesh *)scene->extMeshCache.GetExtMesh(sourceMeshName));
+
+	if (shapeType == "displacement") {
+		// An implicit constant texture is already included in the shape
+		// parameters
+		const string texName = props.Get(Property(propName + ".map")(0.f)).GetValuesString();
+		if (scene->texDefs.IsTextureDefined(texName))
+			HashTexture(hash, scene, scene->texDefs.GetTexture(texName));
+	} else if ((shapeType == "subdiv") || (shapeType == "simplify")) {
+		// The result depends on the camera if the screen size options are used
+		const float screenSize = (shapeType == "subdiv") ?
+			props.Get(Property(propName + ".maxedgescreensize")(0.f)).Get<float>() :
+			props.Get(Property(propName + ".edgescreensize")(0.f)).Get<float>();
+		if ((screenSize > 0.f) && scene->camera)
+			hash.Add(scene->camera->ToProperties(scene->imgMapCache, true).ToString());
+	}
+
+	char buf[17];
+	sprintf(buf, "%016llx", hash.Get());
+
+	return string(buf);
+}
+
+string ShapeCache::GetFileName(const string &key) const {
+	return (boost::filesystem::path(path) / (key + ".shp")).generic_string();
+}
+
+ExtTriangleMesh *ShapeCache::Load(const string &key) const {
+	const string fileName = GetFileName(key);
+	if (!boost::filesystem::exists(fileName))
+		return nullptr;
+
+	boost::iostreams::mapped_file_source file;
+	try {
+		file.open(fileName);
+	} catch (...) {
+		return nullptr;
+	}
+
+	const char *data = file.data();
+	const size_t size = file.size();
+	if (size < sizeof(ShapeCacheHeader))
+		return nullptr;
+
+	ShapeCacheHeader header;
+	memcpy(&header, data, sizeof(ShapeCacheHeader));
+	if (memcmp(header.magic, SHAPECACHE_MAGIC, sizeof(SHAPECACHE_MAGIC)) ||
+			(header.version != SHAPECACHE_FORMAT_VERSION))
+		return nullptr;
+
+	// Check the file size before reading anything
+	const size_t vertCount = header.vertCount;
+	const size_t triCount = header.triCount;
+	size_t expectedSize = sizeof(ShapeCacheHeader) + vertCount * sizeof(Point) +
+			triCount * sizeof(Triangle);
+	if (header.hasNormals)
+		expectedSize += vertCount * sizeof(Normal);
+	for (u_int i = 0; i < EXTMESH_MAX_DATA_COUNT; ++i) {
+		const u_int bit = 1u << i;
+		if (header.uvsMask & bit)
+			expectedSize += vertCount * sizeof(UV);
+		if (header.colsMask & bit)
+			expectedSize += vertCount * sizeof(Spectrum);
+		if (header.alphasMask & bit)
+			expectedSize += vertCount * sizeof(float);
+		if (header.vertAOVMask & bit)
+			expectedSize += vertCount * sizeof(float);
+		if (header.triAOVMask & bit)
+			expectedSize += triCount * sizeof(float);
+	}
+	if (size != expectedSize)
+		return nullptr;
+
+	const char *ptr = data + sizeof(ShapeCacheHeader);
+	auto read = [&ptr](void *dst, const size_t bytes) {
+		memcpy(dst, ptr, bytes);
+		ptr += bytes;
+	};
+
+	Point *vertices = TriangleMesh::AllocVerticesBuffer(header.vertCount);
+	read(vertices, vertCount * sizeof(Point));
+	Triangle *tris = TriangleMesh::AllocTrianglesBuffer(header.triCount);
+	read(tris, triCount * sizeof(Triangle));
+
+	Normal *normals = nullptr;
+	if (header.hasNormals) {
+		normals = new Normal[vertCount];
+		read(normals, vertCount * sizeof(Normal));
+	}
+
+	array<UV *, EXTMESH_MAX_DATA_COUNT> uvs;
+	array<Spectrum *, EXTMESH_MAX_DATA_COUNT> cols;
+	array<float *, EXTMESH_MAX_DATA_COUNT> alphas;
+	array<float *, EXTMESH_MAX_DATA_COUNT> vertAOVs;
+	array<float *, EXTMESH_MAX_DATA_COUNT> triAOVs;
+	for (u_int i = 0; i < EXTMESH_MAX_DATA_COUNT; ++i) {
+		const u_int bit = 1u << i;
+
+		uvs[i] = nullptr;
+		if (header.uvsMask & bit) {
+			uvs[i] = new UV[vertCount];
+			read(uvs[i], vertCount * sizeof(UV));
+		}
+
+		cols[i] = nullptr;
+		if (header.colsMask & bit) {
+			cols[i] = new Spectrum[vertCount];
+			read(cols[i], vertCount * sizeof(Spectrum));
+		}
+
+		alphas[i] = nullptr;
+		if (header.alphasMask & bit) {
+			alphas[i] = new float[vertCount];
+			read(alphas[i], vertCount * sizeof(float));
+		}
+
+		vertAOVs[i] = nullptr;
+		if (header.vertAOVMask & bit) {
+			vertAOVs[i] = new float[vertCount];
+			read(vertAOVs[i], vertCount * sizeof(float));
+		}
+
+		triAOVs[i] = nullptr;
+		if (header.triAOVMask & bit) {
+			triAOVs[i] = new float[triCount];
+			read(triAOVs[i], triCount * sizeof(float));
+		}
+	}
+
+	ExtTriangleMesh *mesh = new ExtTriangleMesh(header.vertCount, header.triCount,
+			vertices, tris, normals, &uvs, &cols, &alphas, header.bevelRadius);
+	for (u_int i = 0; i < EXTMESH_MAX_DATA_COUNT; ++i) {
+		mesh->SetVertexAOV(i, vertAOVs[i]);
+		mesh->SetTriAOV(i, triAOVs[i]);
+	}
+
+	Matrix4x4 appliedTrans;
+	memcpy(appliedTrans.m, header.appliedTrans, sizeof(header.appliedTrans));
+	mesh->SetLocal2World(Transform(appliedTrans));
+
+	return mesh;
+}
+
+void ShapeCache::Save(const string &key, const ExtTriangleMesh *mesh) const {
+	const u_int vertCount = mesh->GetTotalVertexCount();
+	const u_int triCount = mesh->GetTotalTriangleCount();
+
+	ShapeCacheHeader header;
+	memset(&header, 0, sizeof(ShapeCacheHeader));
+	memcpy(header.magic, SHAPECACHE_MAGIC, sizeof(SHAPECACHE_MAGIC));
+	header.version = SHAPECACHE_FORMAT_VERSION;
+	header.vertCount = vertCount;
+	header.triCount = triCount;
+	header.hasNormals = mesh->HasNormals() ? 1u : 0u;
+	for (u_int i = 0; i < EXTMESH_MAX_DATA_COUNT; ++i) {
+		const u_int bit = 1u << i;
+
+		if (mesh->HasUVs(i))
+			header.uvsMask |= bit;
+		if (mesh->HasColors(i))
+			header.colsMask |= bit;
+		if (mesh->HasAlphas(i))
+			header.alphasMask |= bit;
+		if (mesh->HasVertexAOV(i))
+			header.vertAOVMask |= bit;
+		if (mesh->HasTriAOV(i))
+			header.triAOVMask |= bit;
+	}
+	header.bevelRadius = mesh->GetBevelRadius();
+
+	Transform appliedTrans;
+	mesh->GetLocal2World(0.f, appliedTrans);
+	memcpy(header.appliedTrans, appliedTrans.m.m, sizeof(header.appliedTrans));
+
+	boost::filesystem::create_directories(path);
+
+	// Write a temporary file first so a concurrent process never reads a
+	// partially written cache entry
+	SafeSave safeSave(GetFileName(key));
+	{
+		boost::filesystem::ofstream file(boost::filesystem::path(safeSave.GetSaveFileName()),
+				boost::filesystem::ofstream::out |
+				boost::filesystem::ofstream::binary |
+				boost::filesystem::ofstream::trunc);
+
+		file.write((const char *)&header, sizeof(ShapeCacheHeader));
+		file.write((const char *)mesh->GetVertices(), vertCount * sizeof(Point));
+		file.write((const char *)mesh->GetTriangles(), triCount * sizeof(Triangle));
+
+		// The per vertex accessors work with compressed meshes too
+		if (header.hasNormals) {
+			for (u_int i = 0; i < vertCount; ++i) {
+				const Normal n = mesh->GetVertexNormal(i);
+				file.write((const char *)&n, sizeof(Normal));
+			}
+		}
+
+		for (u_int dataIndex = 0; dataIndex < EXTMESH_MAX_DATA_COUNT; ++dataIndex) {
+			if (mesh->HasUVs(dataIndex)) {
+				for (u_int i = 0; i < vertCount; ++i) {
+					const UV uv = mesh->GetVertexUV(i, dataIndex);
+					file.write((const char *)&uv, sizeof(UV));
+				}
+			}
+			if (mesh->HasColors(dataIndex)) {
+				for (u_int i = 0; i < vertCount; ++i) {
+					const Spectrum c = mesh->GetVertexColor(i, dataIndex);
+					file.write((const char *)&c, sizeof(Spectrum));
+				}
+			}
+			if (mesh->HasAlphas(dataIndex))
+				file.write((const char *)mesh->GetAlphas(dataIndex), vertCount * sizeof(float));
+			if (mesh->HasVertexAOV(dataIndex))
+				file.write((const char *)mesh->GetVertexAOVs(dataIndex), vertCount * sizeof(float));
+			if (mesh->HasTriAOV(dataIndex))
+				file.write((const char *)mesh->GetTriAOVs(dataIndex), triCount * sizeof(float));
+		}
+
+		if (file.fail())
+			throw runtime_error("Unable to write shape cache file: " + safeSave.GetSaveFileName());
+
+		file.close();
+	}
+
+	safeSave.Process();
+}
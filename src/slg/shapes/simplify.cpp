@@ -146,28 +146,27 @@ public:
 		for (u_int i = 0; i < vertCount; ++i)
 			vertices[i].p = verts[i];
 		
+		// The vertex attributes of the source mesh may be compressed so they
+		// are read trough the per vertex accessors
 		if (srcMesh.HasNormals()) {
-			const Normal *norms = srcMesh.GetNormals();
 			for (u_int i = 0; i < vertCount; ++i)
-				vertices[i].norm = norms[i];
+				vertices[i].norm = srcMesh.GetVertexNormal(i);
 
 			hasNormals = true;
 		} else
 			hasNormals = false;
 		
 		if (srcMesh.HasUVs(0)) {
-			const UV *uvs = srcMesh.GetUVs(0);
 			for (u_int i = 0; i < vertCount; ++i)
-				vertices[i].uv = uvs[i];
+				vertices[i].uv = srcMesh.GetVertexUV(i, 0);
 
 			hasUVs = true;
 		} else
 			hasUVs = false;
 		
 		if (srcMesh.HasColors(0)) {
-			const Spectrum *cols = srcMesh.GetColors(0);
 			for (u_int i = 0; i < vertCount; ++i)
-				vertices[i].col = cols[i];
+				vertices[i].col = srcMesh.GetVertexColor(i, 0);
 
 			hasColors = true;
 		} else
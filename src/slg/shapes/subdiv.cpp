@@ -87,6 +87,44 @@ template <u_int DIMENSIONS> static Osd::CpuVertexBuffer *BuildBuffer(
 	return buffer;
 }
 
+// The vertex attributes of the source mesh may be compressed, in this case
+// they are decoded in the temporary buffer
+
+static const float *GetNormalsData(const ExtTriangleMesh *mesh, vector<Normal> &buffer) {
+	if (mesh->GetNormals())
+		return (const float *)mesh->GetNormals();
+
+	buffer.resize(mesh->GetTotalVertexCount());
+	for (u_int i = 0; i < buffer.size(); ++i)
+		buffer[i] = mesh->GetVertexNormal(i);
+
+	return (const float *)&buffer[0];
+}
+
+static const float *GetUVsData(const ExtTriangleMesh *mesh, const u_int dataIndex,
+		vector<UV> &buffer) {
+	if (mesh->GetUVs(dataIndex))
+		return (const float *)mesh->GetUVs(dataIndex);
+
+	buffer.resize(mesh->GetTotalVertexCount());
+	for (u_int i = 0; i < buffer.size(); ++i)
+		buffer[i] = mesh->GetVertexUV(i, dataIndex);
+
+	return (const float *)&buffer[0];
+}
+
+static const float *GetColorsData(const ExtTriangleMesh *mesh, const u_int dataIndex,
+		vector<Spectrum> &buffer) {
+	if (mesh->GetColors(dataIndex))
+		return (const float *)mesh->GetColors(dataIndex);
+
+	buffer.resize(mesh->GetTotalVertexCount());
+	for (u_int i = 0; i < buffer.size(); ++i)
+		buffer[i] = mesh->GetVertexColor(i, dataIndex);
+
+	return (const float *)&buffer[0];
+}
+
 float SubdivShape::MaxEdgeScreenSize(const Camera *camera, ExtTriangleMesh *srcMesh) {
 	const u_int triCount = srcMesh->GetTotalTriangleCount();
 	const Point *verts = srcMesh->GetVertices();
@@ -270,8 +308,9 @@ ExtTriangleMesh *SubdivShape::ApplySubdiv(ExtTriangleMesh *srcMesh, const u_int
 	// Normals
     Osd::CpuVertexBuffer *normsBuffer = nullptr;
 	if (srcMesh->HasNormals()) {
+		vector<Normal> decodedNormals;
         normsBuffer = BuildBuffer<3>(
-				stencilTable, (const float *)srcMesh->GetNormals(),
+				stencilTable, GetNormalsData(srcMesh, decodedNormals),
 				vertsCount, totalVertsCount);
 	}
 
@@ -279,8 +318,9 @@ ExtTriangleMesh *SubdivShape::ApplySubdiv(ExtTriangleMesh *srcMesh, const u_int
     vector<Osd::CpuVertexBuffer *> uvsBuffers(EXTMESH_MAX_DATA_COUNT, nullptr);
 	for (u_int i = 0; i < EXTMESH_MAX_DATA_COUNT; i++) {
 		if (srcMesh->HasUVs(i)) {
+			vector<UV> decodedUVs;
 			uvsBuffers[i] = BuildBuffer<2>(
-					stencilTable, (const float *)srcMesh->GetUVs(i),
+					stencilTable, GetUVsData(srcMesh, i, decodedUVs),
 					vertsCount, totalVertsCount);
 		}
 	}
@@ -289,8 +329,9 @@ ExtTriangleMesh *SubdivShape::ApplySubdiv(ExtTriangleMesh *srcMesh, const u_int
 	vector<Osd::CpuVertexBuffer *> colsBuffers(EXTMESH_MAX_DATA_COUNT, nullptr);
 	for (u_int i = 0; i < EXTMESH_MAX_DATA_COUNT; i++) {
 		if (srcMesh->HasColors(i)) {
+			vector<Spectrum> decodedCols;
 			colsBuffers[i] = BuildBuffer<3>(
-					stencilTable, (const float *)srcMesh->GetColors(i),
+					stencilTable, GetColorsData(srcMesh, i, decodedCols),
 					vertsCount, totalVertsCount);
 		}
 	}
@@ -16,6 +16,7 @@
  * limitations under the License.                                          *
  ***************************************************************************/
 
+#include "luxrays/utils/utils.h"
 #include "slg/core/sdl.h"
 #include "slg/textures/blender_noiselib.h"
 
@@ -1851,6 +1852,276 @@ float mg_VLNoise(float x, float y, float z, float distortion, BlenderNoiseBasis
 /* musgrave end */
 /****************/
 
+/*****************/
+/* BATCHED NOISE */
+/*****************/
+
+/* Packet versions of the noise basis functions. Each lane executes exactly the
+   same float operations of the scalar code, so the results are the same, while
+   the fixed trip count loops without branches can be mapped by the compiler on
+   SSE/AVX/NEON registers. Only the hash table lookups are done one lane at time. */
+
+template<u_int N> static inline void newPerlinPacket(const float *px, const float *py, const float *pz,
+		float *result)
+{
+	float x[N], y[N], z[N], u[N], v[N], w[N];
+	int X[N], Y[N], Z[N];
+
+	for (u_int i = 0; i < N; ++i) {
+		const float fx = floor(px[i]), fy = floor(py[i]), fz = floor(pz[i]);
+		X[i] = ((int)fx) & 255;
+		Y[i] = ((int)fy) & 255;
+		Z[i] = ((int)fz) & 255;
+		x[i] = px[i] - fx;
+		y[i] = py[i] - fy;
+		z[i] = pz[i] - fz;
+		u[i] = npfade(x[i]);
+		v[i] = npfade(y[i]);
+		w[i] = npfade(z[i]);
+	}
+
+	int hAA[N], hBA[N], hAB[N], hBB[N], hAA1[N], hBA1[N], hAB1[N], hBB1[N];
+	for (u_int i = 0; i < N; ++i) {
+		const int A = hash[X[i]] + Y[i], AA = hash[A] + Z[i], AB = hash[A + 1] + Z[i];
+		const int B = hash[X[i] + 1] + Y[i], BA = hash[B] + Z[i], BB = hash[B + 1] + Z[i];
+		hAA[i] = hash[AA];
+		hBA[i] = hash[BA];
+		hAB[i] = hash[AB];
+		hBB[i] = hash[BB];
+		hAA1[i] = hash[AA + 1];
+		hBA1[i] = hash[BA + 1];
+		hAB1[i] = hash[AB + 1];
+		hBB1[i] = hash[BB + 1];
+	}
+
+	for (u_int i = 0; i < N; ++i) {
+		const float x1 = x[i] - 1, y1 = y[i] - 1, z1 = z[i] - 1;
+		result[i] = lerp(w[i], lerp(v[i], lerp(u[i], grad(hAA[i], x[i], y[i], z[i]),
+								grad(hBA[i], x1, y[i], z[i])),
+						lerp(u[i], grad(hAB[i], x[i], y1, z[i]),
+								grad(hBB[i], x1, y1, z[i]))),
+				lerp(v[i], lerp(u[i], grad(hAA1[i], x[i], y[i], z1),
+								grad(hBA1[i], x1, y[i], z1)),
+						lerp(u[i], grad(hAB1[i], x[i], y1, z1),
+								grad(hBB1[i], x1, y1, z1))));
+	}
+}
+
+/* keeps the 4 nearest distances with the ACTUAL_DISTANCE metric, da is an array of 4 * N floats */
+template<u_int N> static inline void voronoiPacket(const float *x, const float *y, const float *z,
+		float *da)
+{
+	int xi[N], yi[N], zi[N];
+	float *da0 = &da[0], *da1 = &da[N], *da2 = &da[2 * N], *da3 = &da[3 * N];
+
+	for (u_int i = 0; i < N; ++i) {
+		xi[i] = (int)(floor(x[i]));
+		yi[i] = (int)(floor(y[i]));
+		zi[i] = (int)(floor(z[i]));
+		da0[i] = da1[i] = da2[i] = da3[i] = 1e10f;
+	}
+
+	// Same cell visiting order of the scalar code so ties are resolved the same way
+	for (int dx = -1; dx <= 1; ++dx) {
+		for (int dy = -1; dy <= 1; ++dy) {
+			for (int dz = -1; dz <= 1; ++dz) {
+				float cx[N], cy[N], cz[N];
+				for (u_int i = 0; i < N; ++i) {
+					const int xx = xi[i] + dx, yy = yi[i] + dy, zz = zi[i] + dz;
+					const float *p = HASHPNT(xx, yy, zz);
+					cx[i] = p[0] + xx;
+					cy[i] = p[1] + yy;
+					cz[i] = p[2] + zz;
+				}
+
+				for (u_int i = 0; i < N; ++i) {
+					const float xd = x[i] - cx[i];
+					const float yd = y[i] - cy[i];
+					const float zd = z[i] - cz[i];
+					const float d = sqrt(xd*xd + yd*yd + zd*zd);
+
+					// da is always sorted so this is the same insertion of the scalar code
+					const bool c0 = d < da0[i], c1 = d < da1[i], c2 = d < da2[i], c3 = d < da3[i];
+					da3[i] = c2 ? da2[i] : (c3 ? d : da3[i]);
+					da2[i] = c1 ? da1[i] : (c2 ? d : da2[i]);
+					da1[i] = c0 ? da0[i] : (c1 ? d : da1[i]);
+					da0[i] = c0 ? d : da0[i];
+				}
+			}
+		}
+	}
+}
+
+template<u_int N> static inline void cellNoiseUPacket(const float *x, const float *y, const float *z,
+		float *result)
+{
+	for (u_int i = 0; i < N; ++i) {
+		const int xi = (int)(floor(x[i]));
+		const int yi = (int)(floor(y[i]));
+		const int zi = (int)(floor(z[i]));
+		unsigned int n = xi + yi*1301 + zi*314159;
+		n ^= (n<<13);
+		result[i] = ((float)(n*(n*n*15731 + 789221) + 1376312589) / 4294967296.f);
+	}
+}
+
+template<u_int N> static inline void newPerlinBatch(u_int &index, const u_int count,
+		const float *x, const float *y, const float *z, float *result)
+{
+	for (; index + N <= count; index += N)
+		newPerlinPacket<N>(&x[index], &y[index], &z[index], &result[index]);
+}
+
+template<u_int N> static inline void voronoiBatch(u_int &index, const u_int count,
+		const float *x, const float *y, const float *z,
+		float *f1, float *f2, float *f3, float *f4)
+{
+	float da[4 * N];
+	for (; index + N <= count; index += N) {
+		voronoiPacket<N>(&x[index], &y[index], &z[index], da);
+
+		for (u_int i = 0; i < N; ++i) {
+			if (f1) f1[index + i] = da[i];
+			if (f2) f2[index + i] = da[N + i];
+			if (f3) f3[index + i] = da[2 * N + i];
+			if (f4) f4[index + i] = da[3 * N + i];
+		}
+	}
+}
+
+template<u_int N> static inline void cellNoiseUBatch(u_int &index, const u_int count,
+		const float *x, const float *y, const float *z, float *result)
+{
+	for (; index + N <= count; index += N)
+		cellNoiseUPacket<N>(&x[index], &y[index], &z[index], &result[index]);
+}
+
+void newPerlin(const u_int count, const float *x, const float *y, const float *z, float *result)
+{
+	u_int index = 0;
+	newPerlinBatch<16>(index, count, x, y, z, result);
+	newPerlinBatch<8>(index, count, x, y, z, result);
+	newPerlinBatch<4>(index, count, x, y, z, result);
+	newPerlinBatch<1>(index, count, x, y, z, result);
+}
+
+void voronoi(const u_int count, const float *x, const float *y, const float *z,
+		float *f1, float *f2, float *f3, float *f4)
+{
+	u_int index = 0;
+	voronoiBatch<16>(index, count, x, y, z, f1, f2, f3, f4);
+	voronoiBatch<8>(index, count, x, y, z, f1, f2, f3, f4);
+	voronoiBatch<4>(index, count, x, y, z, f1, f2, f3, f4);
+	voronoiBatch<1>(index, count, x, y, z, f1, f2, f3, f4);
+}
+
+static void cellNoiseU(const u_int count, const float *x, const float *y, const float *z, float *result)
+{
+	u_int index = 0;
+	cellNoiseUBatch<16>(index, count, x, y, z, result);
+	cellNoiseUBatch<8>(index, count, x, y, z, result);
+	cellNoiseUBatch<4>(index, count, x, y, z, result);
+	cellNoiseUBatch<1>(index, count, x, y, z, result);
+}
+
+void cellNoise(const u_int count, const float *x, const float *y, const float *z, float *result)
+{
+	cellNoiseU(count, x, y, z, result);
+	for (u_int i = 0; i < count; ++i)
+		result[i] = (2.f*result[i]-1.f);
+}
+
+/* batched BLI_gNoise(), the noise basis without a packet version are evaluated one point at time */
+void BLI_gNoise(float noisesize, const u_int count, const float *x, const float *y, const float *z,
+		int hard, BlenderNoiseBasis noisebasis, float *result)
+{
+	switch (noisebasis) {
+		case IMPROVED_PERLIN:
+		case VORONOI_F1:
+		case VORONOI_F2:
+		case VORONOI_F3:
+		case VORONOI_F4:
+		case VORONOI_F2_F1:
+		case VORONOI_CRACKLE:
+		case CELL_NOISE:
+			break;
+		default: {
+			for (u_int i = 0; i < count; ++i)
+				result[i] = BLI_gNoise(noisesize, x[i], y[i], z[i], hard, noisebasis);
+			return;
+		}
+	}
+
+	const bool scale = (noisesize != 0.f);
+	if (scale)
+		noisesize = 1.f/noisesize;
+
+	// Points are scaled and evaluated in chunks to keep the work arrays on the stack
+	const u_int chunkSize = 64;
+	float sx[chunkSize], sy[chunkSize], sz[chunkSize], da[chunkSize];
+	for (u_int first = 0; first < count; first += chunkSize) {
+		const u_int n = luxrays::Min(chunkSize, count - first);
+		const float *cx = &x[first], *cy = &y[first], *cz = &z[first];
+		float *r = &result[first];
+
+		if (scale) {
+			for (u_int i = 0; i < n; ++i) {
+				sx[i] = cx[i] * noisesize;
+				sy[i] = cy[i] * noisesize;
+				sz[i] = cz[i] * noisesize;
+			}
+			cx = sx;
+			cy = sy;
+			cz = sz;
+		}
+
+		switch (noisebasis) {
+			case IMPROVED_PERLIN:
+				newPerlin(n, cx, cy, cz, r);
+				for (u_int i = 0; i < n; ++i)
+					r[i] = (0.5f+0.5f*r[i]);
+				break;
+			case VORONOI_F1:
+				voronoi(n, cx, cy, cz, r, NULL, NULL, NULL);
+				break;
+			case VORONOI_F2:
+				voronoi(n, cx, cy, cz, NULL, r, NULL, NULL);
+				break;
+			case VORONOI_F3:
+				voronoi(n, cx, cy, cz, NULL, NULL, r, NULL);
+				break;
+			case VORONOI_F4:
+				voronoi(n, cx, cy, cz, NULL, NULL, NULL, r);
+				break;
+			case VORONOI_F2_F1:
+			case VORONOI_CRACKLE:
+				voronoi(n, cx, cy, cz, da, r, NULL, NULL);
+				for (u_int i = 0; i < n; ++i)
+					r[i] = (r[i]-da[i]);
+				if (noisebasis == VORONOI_CRACKLE) {
+					for (u_int i = 0; i < n; ++i) {
+						const float t = 10.f*r[i];
+						r[i] = (t>1.f) ? 1.f : t;
+					}
+				}
+				break;
+			case CELL_NOISE:
+			default:
+				cellNoiseU(n, cx, cy, cz, r);
+				break;
+		}
+
+		if (hard) {
+			for (u_int i = 0; i < n; ++i)
+				r[i] = fabs(2.f*r[i]-1.f);
+		}
+	}
+}
+
+/*********************/
+/* batched noise end */
+/*********************/
+
 } // namespace blender
 
 } // namespace slg
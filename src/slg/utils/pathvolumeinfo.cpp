@@ -226,6 +226,20 @@ void  PathVolumeInfo::SetHitPointVolumes(HitPoint &hitPoint,
 	}
 }
 
+bool PathVolumeInfo::operator==(const PathVolumeInfo &pvi) const {
+	if ((currentVolume != pvi.currentVolume) ||
+			(volumeListSize != pvi.volumeListSize) ||
+			(scatteredStart != pvi.scatteredStart))
+		return false;
+
+	for (u_int i = 0; i < volumeListSize; ++i) {
+		if (volumeList[i] != pvi.volumeList[i])
+			return false;
+	}
+
+	return true;
+}
+
 namespace slg {
 
 ostream &operator<<(ostream &os, const PathVolumeInfo &pvi) {
@@ -0,0 +1,306 @@
+/***************************************************************************
+ * Copyright 1998-2020 by authors (see AUTHORS.txt)                        *
+ *                                                                         *
+ *   This file is part of LuxCoreRender.                                   *
+ *                                                                         *
+ * Licensed under the Apache License, Version 2.0 (the "License");         *
+ * you may not use this file except in compliance with the License.        *
+ * You may obtain a copy of the License at                                 *
+ *                                                                         *
+ *     http://www.apache.org/licenses/LICENSE-2.0                          *
+ *                                                                         *
+ * Unless required by applicable law or agreed to in writing, software     *
+ * distributed under the License is distributed on an "AS IS" BASIS,       *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.*
+ * See the License for the specific language governing permissions and     *
+ * limitations under the License.                                          *
+ ***************************************************************************/
+
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+
+#include <boost/thread/mutex.hpp>
+
+#include "luxrays/utils/utils.h"
+#include "luxrays/utils/strutils.h"
+#include "slg/slg.h"
+#include "slg/utils/profiler.h"
+
+using namespace std;
+using namespace luxrays;
+using namespace slg;
+
+//------------------------------------------------------------------------------
+// ProfilerThreadData
+//------------------------------------------------------------------------------
+
+namespace {
+
+class ProfilerThreadData {
+public:
+	typedef struct {
+		ProfilerCounterType type;
+		u_longlong startCycles, endCycles;
+	} TimelineEvent;
+
+	ProfilerThreadData(const u_int index) : timelineGeneration(0), threadIndex(index) {
+		for (u_int i = 0; i < PROFILER_COUNTER_COUNT; ++i) {
+			counts[i].store(0, memory_order_relaxed);
+			cycles[i].store(0, memory_order_relaxed);
+			countsBase[i] = 0;
+			cyclesBase[i] = 0;
+		}
+	}
+
+	// Only the owner thread writes the counters so a relaxed load and store
+	// pair is enough: readers may only see a slightly stale value
+	atomic<u_longlong> counts[PROFILER_COUNTER_COUNT];
+	atomic<u_longlong> cycles[PROFILER_COUNTER_COUNT];
+	// The counter values at the last Profiler::Reset(), they are read and
+	// written only with the registry mutex locked. The counters themselves
+	// are never written by other threads.
+	u_longlong countsBase[PROFILER_COUNTER_COUNT];
+	u_longlong cyclesBase[PROFILER_COUNTER_COUNT];
+
+	// Written only by the owner thread, the events of an old timeline
+	// generation are dropped by the owner itself
+	vector<TimelineEvent> timelineEvents;
+	u_int timelineGeneration;
+
+	const u_int threadIndex;
+};
+
+class ProfilerRegistry {
+public:
+	ProfilerRegistry() : timelineMaxEvents(0), timelineGeneration(0) {
+		startCycles = Profiler::ReadCycleCounter();
+		startTime = WallClockTime();
+	}
+
+	ProfilerThreadData *Acquire() {
+		boost::unique_lock<boost::mutex> lock(registryMutex);
+
+		if (freeThreadData.size() > 0) {
+			ProfilerThreadData *td = freeThreadData.back();
+			freeThreadData.pop_back();
+
+			return td;
+		}
+
+		threadData.push_back(unique_ptr<ProfilerThreadData>(new ProfilerThreadData(threadData.size())));
+		return threadData.back().get();
+	}
+
+	void Release(ProfilerThreadData *td) {
+		// The counters are retained so totals include finished threads
+		boost::unique_lock<boost::mutex> lock(registryMutex);
+		freeThreadData.push_back(td);
+	}
+
+	double GetCyclesPerSecond() const {
+		const double elapsed = WallClockTime() - startTime;
+		if (elapsed <= 0.0)
+			return 0.0;
+
+		return (Profiler::ReadCycleCounter() - startCycles) / elapsed;
+	}
+
+	boost::mutex registryMutex;
+	vector<unique_ptr<ProfilerThreadData> > threadData;
+	vector<ProfilerThreadData *> freeThreadData;
+
+	atomic<u_int> timelineMaxEvents;
+	// Incremented each time a new timeline is started
+	atomic<u_int> timelineGeneration;
+
+	u_longlong startCycles;
+	double startTime;
+};
+
+ProfilerRegistry &GetRegistry() {
+	static ProfilerRegistry registry;
+
+	return registry;
+}
+
+class ProfilerThreadDataHolder {
+public:
+	ProfilerThreadDataHolder() : threadData(GetRegistry().Acquire()) { }
+	~ProfilerThreadDataHolder() { GetRegistry().Release(threadData); }
+
+	ProfilerThreadData *threadData;
+};
+
+}
+
+//------------------------------------------------------------------------------
+// Profiler
+//------------------------------------------------------------------------------
+
+bool Profiler::IsEnabled() {
+#if defined(SLG_ENABLE_PROFILER)
+	return true;
+#else
+	return false;
+#endif
+}
+
+string Profiler::CounterType2String(const ProfilerCounterType type) {
+	switch (type) {
+		case PROFILER_PATH_EYE:
+			return "patheye";
+		case PROFILER_SCENE_INTERSECT:
+			return "sceneintersect";
+		case PROFILER_BSDF_INIT:
+			return "bsdfinit";
+		case PROFILER_LIGHT_SAMPLING:
+			return "lightsampling";
+		case PROFILER_VOLUME_SCATTER:
+			return "volumescatter";
+		case PROFILER_FILM_ADD_SAMPLE:
+			return "filmaddsample";
+		default:
+			throw runtime_error("Unknown profiler counter type in Profiler::CounterType2String(): " + ToString(type));
+	}
+}
+
+void Profiler::AddSample(const ProfilerCounterType type,
+		const u_longlong startCycles, const u_longlong endCycles) {
+	static thread_local ProfilerThreadDataHolder holder;
+	ProfilerThreadData *td = holder.threadData;
+
+	td->counts[type].store(td->counts[type].load(memory_order_relaxed) + 1, memory_order_relaxed);
+	td->cycles[type].store(td->cycles[type].load(memory_order_relaxed) + (endCycles - startCycles), memory_order_relaxed);
+
+	ProfilerRegistry &registry = GetRegistry();
+	const u_int maxEvents = registry.timelineMaxEvents.load(memory_order_acquire);
+	if (maxEvents > 0) {
+		// Drop the events of a previous timeline
+		const u_int generation = registry.timelineGeneration.load(memory_order_relaxed);
+		if (td->timelineGeneration != generation) {
+			td->timelineEvents.clear();
+			td->timelineGeneration = generation;
+		}
+
+		if (td->timelineEvents.size() < maxEvents) {
+			ProfilerThreadData::TimelineEvent e = { type, startCycles, endCycles };
+			td->timelineEvents.push_back(e);
+		}
+	}
+}
+
+void Profiler::Reset() {
+	ProfilerRegistry &registry = GetRegistry();
+	boost::unique_lock<boost::mutex> lock(registry.registryMutex);
+
+	// The counters of the other threads are not written here: the current
+	// values are only recorded as the new starting point
+	for (auto &td : registry.threadData) {
+		for (u_int i = 0; i < PROFILER_COUNTER_COUNT; ++i) {
+			td->countsBase[i] = td->counts[i].load(memory_order_relaxed);
+			td->cyclesBase[i] = td->cycles[i].load(memory_order_relaxed);
+		}
+	}
+
+	// Any recorded timeline event is dropped by the owner threads
+	registry.timelineMaxEvents.store(0);
+	++registry.timelineGeneration;
+}
+
+void Profiler::GetStats(Properties &stats) {
+	ProfilerRegistry &registry = GetRegistry();
+
+	stats.Set(Property("stats.profiler.enabled")(IsEnabled()));
+	if (!IsEnabled())
+		return;
+
+	u_longlong counts[PROFILER_COUNTER_COUNT] = { 0 };
+	u_longlong cycles[PROFILER_COUNTER_COUNT] = { 0 };
+	{
+		boost::unique_lock<boost::mutex> lock(registry.registryMutex);
+
+		for (auto &td : registry.threadData) {
+			for (u_int i = 0; i < PROFILER_COUNTER_COUNT; ++i) {
+				counts[i] += td->counts[i].load(memory_order_relaxed) - td->countsBase[i];
+				cycles[i] += td->cycles[i].load(memory_order_relaxed) - td->cyclesBase[i];
+			}
+		}
+	}
+
+	const double cyclesPerSecond = registry.GetCyclesPerSecond();
+	for (u_int i = 0; i < PROFILER_COUNTER_COUNT; ++i) {
+		const string prefix = "stats.profiler." + CounterType2String((ProfilerCounterType)i);
+
+		stats.Set(Property(prefix + ".count")(counts[i]));
+		stats.Set(Property(prefix + ".cycles")(cycles[i]));
+		// Accumulated over all threads
+		stats.Set(Property(prefix + ".time")((cyclesPerSecond > 0.0) ? (cycles[i] / cyclesPerSecond) : 0.0));
+	}
+}
+
+void Profiler::StartTimeline(const u_int maxEvents) {
+	if (!IsEnabled()) {
+		SLG_LOG("[Profiler] Timeline requested but the profiler is not enabled at compile time");
+		return;
+	}
+
+	ProfilerRegistry &registry = GetRegistry();
+	boost::unique_lock<boost::mutex> lock(registry.registryMutex);
+
+	// The events of the previous timeline are dropped by each owner thread
+	// when it records its first new event
+	++registry.timelineGeneration;
+	registry.timelineMaxEvents.store(maxEvents, memory_order_release);
+}
+
+void Profiler::SaveTimeline(const string &fileName) {
+	if (!IsEnabled())
+		return;
+
+	ProfilerRegistry &registry = GetRegistry();
+	boost::unique_lock<boost::mutex> lock(registry.registryMutex);
+
+	// Stop recording new events
+	registry.timelineMaxEvents.store(0);
+
+	ofstream outFile(fileName.c_str(), ofstream::out | ofstream::trunc);
+	if (!outFile.is_open())
+		throw runtime_error("Unable to open profiler timeline file: " + fileName);
+
+	const double cyclesPerSecond = registry.GetCyclesPerSecond();
+	const double cycles2Usec = (cyclesPerSecond > 0.0) ? (1000000.0 / cyclesPerSecond) : 0.0;
+
+	const u_int generation = registry.timelineGeneration.load();
+
+	u_longlong eventCount = 0;
+	outFile << fixed << setprecision(3);
+	outFile << "{\"traceEvents\":[";
+	for (auto &td : registry.threadData) {
+		// Skip the threads that have not recorded anything in this timeline
+		if (td->timelineGeneration != generation)
+			continue;
+
+		for (auto const &e : td->timelineEvents) {
+			// Events recorded before the registry start have a "negative" time
+			const double ts = (e.startCycles > registry.startCycles) ?
+				((e.startCycles - registry.startCycles) * cycles2Usec) : 0.0;
+
+			outFile << ((eventCount > 0) ? ",\n" : "\n") <<
+					"{\"name\":\"" << CounterType2String(e.type) << "\",\"ph\":\"X\"," <<
+					"\"ts\":" << ts << ",\"dur\":" << ((e.endCycles - e.startCycles) * cycles2Usec) << "," <<
+					"\"pid\":0,\"tid\":" << td->threadIndex << "}";
+			++eventCount;
+		}
+	}
+	outFile << "\n]}\n";
+
+	if (!outFile.good())
+		throw runtime_error("Error while writing profiler timeline file: " + fileName);
+
+	SLG_LOG("[Profiler] Timeline saved: " << fileName << " (" << eventCount << " events)");
+}
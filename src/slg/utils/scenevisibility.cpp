@@ -20,6 +20,7 @@
 #include <boost/format.hpp>
 #include <boost/thread.hpp>
 #include <boost/thread/mutex.hpp>
+#include <boost/thread/shared_mutex.hpp>
 
 #include "luxrays/utils/thread.h"
 
@@ -47,7 +48,7 @@ using namespace slg;
 template <class T>
 SceneVisibility<T>::TraceVisibilityThread::TraceVisibilityThread(SceneVisibility<T> &svis, const u_int index,
 		SobolSamplerSharedData &sobolSharedData,
-		IndexOctree<T> *octree, boost::mutex &octreeMutex,
+		IndexOctree<T> *octree, boost::shared_mutex &octreeMutex,
 		boost::atomic<u_int> &gParticlesCount,
 		u_int &cacheLookUp, u_int &cacheHits,
 		bool &warmUp) :
@@ -117,7 +118,7 @@ void SceneVisibility<T>::TraceVisibilityThread::RenderFunc() {
 	// Initialize the sampler
 	RandomGenerator rnd(1 + threadIndex);
 	SobolSampler sampler(&rnd, NULL, NULL, true, 0.f, 0.f,
-			16, 16, 1, 1,
+			16, 16, 1, 1, false,
 			&visibilitySobolSharedData);
 	
 	// Request the samples
@@ -144,6 +145,8 @@ void SceneVisibility<T>::TraceVisibilityThread::RenderFunc() {
 	maxPathDepthInfo.specularDepth = sv.maxPathDepth;
 
 	vector<T> visibilityParticles;
+	vector<u_int> nearestEntryIndices;
+	vector<float> nearestEntryDistances2;
 
 	//--------------------------------------------------------------------------
 	// Get a bucket of work to do
@@ -265,20 +268,48 @@ void SceneVisibility<T>::TraceVisibilityThread::RenderFunc() {
 		}
 
 		//----------------------------------------------------------------------
-		// Add all visibility particles to the Octree (under a mutex)
+		// Add all visibility particles to the Octree
 		//----------------------------------------------------------------------
 		
 		if (visibilityParticles.size() > 0) {
-			boost::unique_lock<boost::mutex> lock(particlesOctreeMutex);
-
-			u_int cacheLookUp = 0;
-			u_int cacheHits = 0;
 			// I need some overlap between entries to avoid very small and
 			// hard to find regions. I use a 10% overlap.
 			const float maxDistance2 = Sqr(sv.lookUpRadius * 0.9f);
-			for (auto const &vp : visibilityParticles) {
-				const bool cacheHit = sv.ProcessVisibilityParticle(vp, sv.visibilityParticles,
-						particlesOctree, maxDistance2);
+
+			// Look for the nearest entries under a shared lock, in parallel
+			// with the other threads. It is the most expensive part of the
+			// work and most particles end up being cache hits.
+			nearestEntryIndices.resize(visibilityParticles.size());
+			nearestEntryDistances2.resize(visibilityParticles.size());
+			{
+				boost::shared_lock<boost::shared_mutex> lock(particlesOctreeMutex);
+
+				for (u_int i = 0; i < visibilityParticles.size(); ++i) {
+					nearestEntryIndices[i] = sv.GetNearestEntry(visibilityParticles[i],
+							particlesOctree, &nearestEntryDistances2[i]);
+				}
+			}
+
+			// Update the cache under an exclusive lock. Entries are never
+			// removed so the cache hits found above are still valid while
+			// the misses have to be checked again because other threads
+			// may have added new entries in the meantime.
+			boost::unique_lock<boost::shared_mutex> lock(particlesOctreeMutex);
+
+			u_int cacheLookUp = 0;
+			u_int cacheHits = 0;
+			for (u_int i = 0; i < visibilityParticles.size(); ++i) {
+				const T &vp = visibilityParticles[i];
+
+				bool cacheHit;
+				if ((nearestEntryIndices[i] != NULL_INDEX) && (nearestEntryDistances2[i] <= maxDistance2)) {
+					sv.AddToEntry(sv.visibilityParticles[nearestEntryIndices[i]], vp, nearestEntryDistances2[i]);
+					cacheHit = true;
+				} else {
+					cacheHit = sv.ProcessVisibilityParticle(vp, sv.visibilityParticles,
+							particlesOctree, maxDistance2);
+				}
+
 				if (cacheHit)
 					++cacheHits;
 
@@ -344,6 +375,26 @@ template <class T>
 SceneVisibility<T>::~SceneVisibility() {
 }
 
+template <class T>
+bool SceneVisibility<T>::ProcessVisibilityParticle(const T &vp, vector<T> &visibilityParticles,
+		IndexOctree<T> *particlesOctree, const float maxDistance2) const {
+	// Check if a cache entry is available for this point
+	float distance2;
+	const u_int entryIndex = GetNearestEntry(vp, particlesOctree, &distance2);
+
+	if ((entryIndex == NULL_INDEX) || (distance2 > maxDistance2)) {
+		// Add as a new entry
+		visibilityParticles.push_back(vp);
+		particlesOctree->Add(visibilityParticles.size() - 1);
+
+		return false;
+	} else {
+		AddToEntry(visibilityParticles[entryIndex], vp, distance2);
+
+		return true;
+	}
+}
+
 template <class T>
 void SceneVisibility<T>::Build() {
 	const size_t renderThreadCount = GetHardwareThreadCount();
@@ -354,7 +405,7 @@ void SceneVisibility<T>::Build() {
 	//
 	// Note: I use an Octree because it can be built at runtime.
 	unique_ptr<IndexOctree<T> > particlesOctree(AllocOctree());
-	boost::mutex particlesOctreeMutex;
+	boost::shared_mutex particlesOctreeMutex;
 
 	SobolSamplerSharedData visibilitySobolSharedData(131, nullptr);
 
@@ -0,0 +1,84 @@
+/***************************************************************************
+ * Copyright 1998-2020 by authors (see AUTHORS.txt)                        *
+ *                                                                         *
+ *   This file is part of LuxCoreRender.                                   *
+ *                                                                         *
+ * Licensed under the Apache License, Version 2.0 (the "License");         *
+ * you may not use this file except in compliance with the License.        *
+ * You may obtain a copy of the License at                                 *
+ *                                                                         *
+ *     http://www.apache.org/licenses/LICENSE-2.0                          *
+ *                                                                         *
+ * Unless required by applicable law or agreed to in writing, software     *
+ * distributed under the License is distributed on an "AS IS" BASIS,       *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.*
+ * See the License for the specific language governing permissions and     *
+ * limitations under the License.                                          *
+ ***************************************************************************/
+
+#include <limits>
+
+#include "slg/utils/visibilitypoint.h"
+#include "slg/scene/scene.h"
+
+using namespace std;
+using namespace luxrays;
+using namespace slg;
+
+//------------------------------------------------------------------------------
+// VisibilityPoint
+//------------------------------------------------------------------------------
+
+VisibilityPoint::VisibilityPoint(const Scene &scene, const BSDF &bsdf,
+		const u_int volInfoIdx) {
+	p = bsdf.hitPoint.p;
+	packedGeometryN = PackOctahedralNormal(bsdf.hitPoint.geometryN);
+	packedShadeN = PackOctahedralNormal(bsdf.hitPoint.shadeN);
+	materialIndex = scene.matDefs.GetMaterialIndex(bsdf.GetMaterial());
+	volInfoIndex = (u_short)volInfoIdx;
+
+	flags = (bsdf.IsVolume() ? VOLUME : 0) |
+			(bsdf.hitPoint.intoObject ? INTO_OBJECT : 0);
+}
+
+void VisibilityPoint::GetBSDF(const Scene &scene, BSDF &bsdf) const {
+	bsdf.Init(p, GetGeometryN(), GetShadeN(), IsIntoObject(),
+			scene.matDefs.GetMaterial(materialIndex));
+}
+
+//------------------------------------------------------------------------------
+// VisibilityPointList
+//------------------------------------------------------------------------------
+
+u_short VisibilityPointList::AddVolInfo(const PathVolumeInfo &volInfo) {
+	// The list is usually very short so a linear search is fine
+	for (u_int i = 0; i < volInfos.size(); ++i) {
+		if (volInfos[i] == volInfo)
+			return (u_short)i;
+	}
+
+	if (volInfos.size() > numeric_limits<u_short>::max())
+		throw runtime_error("Too many different PathVolumeInfo in VisibilityPointList::AddVolInfo()");
+
+	volInfos.push_back(volInfo);
+
+	return (u_short)(volInfos.size() - 1);
+}
+
+void VisibilityPointList::Add(const Scene &scene, const BSDF &bsdf,
+		const PathVolumeInfo &volInfo) {
+	const u_short volInfoIndex = AddVolInfo(volInfo);
+
+	points.push_back(VisibilityPoint(scene, bsdf, volInfoIndex));
+}
+
+void VisibilityPointList::Add(const VisibilityPointList &list) {
+	points.reserve(points.size() + list.points.size());
+
+	for (auto const &pt : list.points) {
+		VisibilityPoint newPoint = pt;
+		newPoint.volInfoIndex = AddVolInfo(list.volInfos[pt.volInfoIndex]);
+
+		points.push_back(newPoint);
+	}
+}
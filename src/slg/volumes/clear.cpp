@@ -20,6 +20,7 @@
 
 #include "slg/volumes/clear.h"
 #include "slg/bsdf/bsdf.h"
+#include "slg/utils/profiler.h"
 
 using namespace std;
 using namespace luxrays;
@@ -45,6 +46,8 @@ Spectrum ClearVolume::SigmaS(const HitPoint &hitPoint) const {
 float ClearVolume::Scatter(const Ray &ray, const float u,
 		const bool scatteredStart, Spectrum *connectionThroughput,
 		Spectrum *connectionEmission) const {
+	SLG_PROFILE(PROFILER_VOLUME_SCATTER);
+
 	// Point where to evaluate the volume
 	HitPoint hitPoint;
 	hitPoint.Init();
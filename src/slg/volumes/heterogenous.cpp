@@ -21,6 +21,7 @@
 #include "slg/volumes/homogenous.h"
 #include "slg/volumes/heterogenous.h"
 #include "slg/bsdf/bsdf.h"
+#include "slg/utils/profiler.h"
 
 using namespace std;
 using namespace luxrays;
@@ -51,6 +52,8 @@ Spectrum HeterogeneousVolume::SigmaS(const HitPoint &hitPoint) const {
 float HeterogeneousVolume::Scatter(const Ray &ray, const float u,
 		const bool scatteredStart, Spectrum *connectionThroughput,
 		Spectrum *connectionEmission) const {
+	SLG_PROFILE(PROFILER_VOLUME_SCATTER);
+
 	// I need a sequence of pseudo-random numbers starting form a floating point
 	// pseudo-random number
 	TauswortheRandomGenerator rng(u);
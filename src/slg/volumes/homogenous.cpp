@@ -20,6 +20,7 @@
 
 #include "slg/volumes/homogenous.h"
 #include "slg/bsdf/bsdf.h"
+#include "slg/utils/profiler.h"
 
 using namespace std;
 using namespace luxrays;
@@ -101,6 +102,8 @@ Spectrum HomogeneousVolume::SigmaS(const HitPoint &hitPoint) const {
 float HomogeneousVolume::Scatter(const Ray &ray, const float u,
 		const bool scatteredStart, Spectrum *connectionThroughput,
 		Spectrum *connectionEmission) const {
+	SLG_PROFILE(PROFILER_VOLUME_SCATTER);
+
 	const float segmentLength = ray.maxt - ray.mint;
 
 	// Check if I have to support multi-scattering
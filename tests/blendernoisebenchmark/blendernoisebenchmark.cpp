@@ -0,0 +1,103 @@
+/***************************************************************************
+ * Copyright 1998-2020 by authors (see AUTHORS.txt)                        *
+ *                                                                         *
+ *   This file is part of LuxCoreRender.                                   *
+ *                                                                         *
+ * Licensed under the Apache License, Version 2.0 (the "License");         *
+ * you may not use this file except in compliance with the License.        *
+ * You may obtain a copy of the License at                                 *
+ *                                                                         *
+ *     http://www.apache.org/licenses/LICENSE-2.0                          *
+ *                                                                         *
+ * Unless required by applicable law or agreed to in writing, software     *
+ * distributed under the License is distributed on an "AS IS" BASIS,       *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.*
+ * See the License for the specific language governing permissions and     *
+ * limitations under the License.                                          *
+ ***************************************************************************/
+
+// This is a throughput benchmark of SLG internal Blender procedural noise
+// library. The code used here is not part of LuxCore API and should be ignored
+// aside from LuxCoreRender core developers.
+//
+// Usage: blendernoisebenchmark [points count]
+
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+
+#include "luxrays/core/randomgen.h"
+#include "luxrays/utils/strutils.h"
+#include "luxrays/utils/utils.h"
+#include "slg/textures/blender_noiselib.h"
+
+using namespace std;
+using namespace luxrays;
+using namespace slg::blender;
+
+int main(int argc, char *argv[]) {
+	try {
+		const u_int pointsCount = (argc > 1) ? atoi(argv[1]) : 1000000;
+
+		TauswortheRandomGenerator rndGen(131u);
+		vector<float> x(pointsCount), y(pointsCount), z(pointsCount);
+		for (u_int i = 0; i < pointsCount; ++i) {
+			x[i] = (rndGen.floatValue() - .5f) * 200.f;
+			y[i] = (rndGen.floatValue() - .5f) * 200.f;
+			z[i] = (rndGen.floatValue() - .5f) * 200.f;
+		}
+
+		const BlenderNoiseBasis noiseBasis[] = {
+			BLENDER_ORIGINAL, ORIGINAL_PERLIN, IMPROVED_PERLIN,
+			VORONOI_F1, VORONOI_F2, VORONOI_F3, VORONOI_F4, VORONOI_F2_F1,
+			VORONOI_CRACKLE, CELL_NOISE
+		};
+		const u_int noiseBasisCount = sizeof(noiseBasis) / sizeof(noiseBasis[0]);
+
+		vector<float> values(pointsCount);
+		double sum = 0.0;
+		for (u_int b = 0; b < noiseBasisCount; ++b) {
+			// Check the results of the two implementations, they can differ
+			// only for the rounding of the FMA instructions
+
+			BLI_gNoise(.7f, pointsCount, &x[0], &y[0], &z[0], 0, noiseBasis[b], &values[0]);
+			for (u_int i = 0; i < pointsCount; ++i) {
+				const float value = BLI_gNoise(.7f, x[i], y[i], z[i], 0, noiseBasis[b]);
+
+				if (fabsf(values[i] - value) > 1e-5f * Max(1.f, fabsf(value)))
+					throw runtime_error("Wrong value for noise basis " + ToString(noiseBasis[b]) +
+							" point " + ToString(i) + ": " + ToString(values[i]) + " instead of " + ToString(value));
+			}
+
+			// Benchmark the one point at time implementation
+
+			double startTime = WallClockTime();
+			for (u_int i = 0; i < pointsCount; ++i)
+				sum += BLI_gNoise(.7f, x[i], y[i], z[i], 0, noiseBasis[b]);
+			const double scalarTime = WallClockTime() - startTime;
+
+			// Benchmark the batched implementation
+
+			startTime = WallClockTime();
+			BLI_gNoise(.7f, pointsCount, &x[0], &y[0], &z[0], 0, noiseBasis[b], &values[0]);
+			const double batchTime = WallClockTime() - startTime;
+			for (u_int i = 0; i < pointsCount; ++i)
+				sum += values[i];
+
+			cout << "Noise basis " << noiseBasis[b] << ": " <<
+					(pointsCount / scalarTime) / 1000000.0 << " Mpoints/sec one point at time, " <<
+					(pointsCount / batchTime) / 1000000.0 << " Mpoints/sec batched" << endl;
+		}
+
+		// Printed only to avoid the compiler optimizing out the loops
+		cout << "Checksum: " << sum << endl;
+	} catch (runtime_error &err) {
+		cerr << "RUNTIME ERROR: " << err.what() << endl;
+		return EXIT_FAILURE;
+	} catch (exception &err) {
+		cerr << "ERROR: " << err.what() << endl;
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,311 @@
+/***************************************************************************
+ * Copyright 1998-2020 by authors (see AUTHORS.txt)                        *
+ *                                                                         *
+ *   This file is part of LuxCoreRender.                                   *
+ *                                                                         *
+ * Licensed under the Apache License, Version 2.0 (the "License");         *
+ * you may not use this file except in compliance with the License.        *
+ * You may obtain a copy of the License at                                 *
+ *                                                                         *
+ *     http://www.apache.org/licenses/LICENSE-2.0                          *
+ *                                                                         *
+ * Unless required by applicable law or agreed to in writing, software     *
+ * distributed under the License is distributed on an "AS IS" BASIS,       *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.*
+ * See the License for the specific language governing permissions and     *
+ * limitations under the License.                                          *
+ ***************************************************************************/
+
+// This test checks that the steady-state render loop of PATHCPU doesn't
+// allocate heap memory. Global operator new is replaced with a counting
+// version. While counting is enabled, only the allocations of the threads
+// other than the main one are counted: with a single rendering thread and
+// no background cache, it is the render thread only. The count must be zero.
+//
+// The SampleResult operations of the render loop are checked first on their
+// own, for all the radiance group counts stored without heap memory.
+//
+// Usage: pathtracerallocationtest [render time in secs]
+
+#include <iostream>
+#include <cstdlib>
+#include <new>
+#include <atomic>
+
+#include <boost/thread.hpp>
+
+#include <luxcore/luxcore.h>
+
+#include "luxrays/utils/strutils.h"
+#include "slg/film/sampleresult.h"
+
+using namespace std;
+using namespace luxrays;
+using namespace luxcore;
+
+//------------------------------------------------------------------------------
+// Counting allocator
+//------------------------------------------------------------------------------
+
+static atomic<bool> countAllocations(false);
+static atomic<unsigned long long> allocationsCount(0);
+
+// The main thread only waits and reads the statistics
+static thread_local bool isMainThread = false;
+
+static inline void CountAllocation() {
+	if (countAllocations.load(memory_order_relaxed) && !isMainThread)
+		++allocationsCount;
+}
+
+void *operator new(size_t size) {
+	CountAllocation();
+
+	void *p = malloc((size > 0) ? size : 1);
+	if (!p)
+		throw bad_alloc();
+
+	return p;
+}
+
+void *operator new[](size_t size) {
+	return operator new(size);
+}
+
+void *operator new(size_t size, const nothrow_t &) noexcept {
+	CountAllocation();
+
+	return malloc((size > 0) ? size : 1);
+}
+
+void *operator new[](size_t size, const nothrow_t &) noexcept {
+	return operator new(size, nothrow);
+}
+
+void operator delete(void *p) noexcept {
+	free(p);
+}
+
+void operator delete[](void *p) noexcept {
+	free(p);
+}
+
+void operator delete(void *p, size_t) noexcept {
+	free(p);
+}
+
+void operator delete[](void *p, size_t) noexcept {
+	free(p);
+}
+
+//------------------------------------------------------------------------------
+// Sample results test
+//------------------------------------------------------------------------------
+
+#define SAMPLERESULT_TEST_SAMPLES 100000
+#define SAMPLERESULT_TEST_PATH_DEPTH 6
+
+static const slg::Film::FilmChannels eyeTestChannels({
+	slg::Film::RADIANCE_PER_PIXEL_NORMALIZED,
+	slg::Film::ALPHA,
+	slg::Film::DEPTH,
+	slg::Film::SHADING_NORMAL,
+	slg::Film::ALBEDO,
+	slg::Film::DIRECT_DIFFUSE,
+	slg::Film::INDIRECT_GLOSSY
+});
+
+static const slg::Film::FilmChannels lightTestChannels({
+	slg::Film::RADIANCE_PER_SCREEN_NORMALIZED
+});
+
+// The same SampleResult operations of PathTracer render loop
+static void RenderSampleResults(const u_int radianceGroupCount,
+		unsigned long long *allocations) {
+	// The per-thread data, allocated at the render thread start
+	vector<slg::SampleResult> eyeSampleResults(1);
+	eyeSampleResults[0].Init(&eyeTestChannels, radianceGroupCount);
+	vector<slg::SampleResult> lightSampleResults;
+	lightSampleResults.reserve(SAMPLERESULT_TEST_PATH_DEPTH + 2);
+	slg::SampleResult sampleResultCopy;
+
+	allocationsCount = 0;
+	countAllocations = true;
+
+	for (u_int i = 0; i < SAMPLERESULT_TEST_SAMPLES; ++i) {
+		slg::SampleResult &eyeSampleResult = eyeSampleResults[0];
+		eyeSampleResult.emission = Spectrum();
+		eyeSampleResult.radiance.Clear();
+		eyeSampleResult.firstPathVertex = true;
+		for (u_int depth = 0; depth < SAMPLERESULT_TEST_PATH_DEPTH; ++depth) {
+			eyeSampleResult.AddDirectLight(depth % radianceGroupCount, slg::DIFFUSE | slg::REFLECT,
+					Spectrum(.5f), Spectrum(1.f), 1.f);
+			eyeSampleResult.AddEmission((depth + 1) % radianceGroupCount,
+					Spectrum(.5f), Spectrum(1.f));
+			eyeSampleResult.firstPathVertex = false;
+		}
+
+		lightSampleResults.clear();
+		for (u_int depth = 0; depth < SAMPLERESULT_TEST_PATH_DEPTH; ++depth) {
+			lightSampleResults.resize(lightSampleResults.size() + 1);
+			slg::SampleResult &lightSampleResult = lightSampleResults.back();
+			lightSampleResult.Init(&lightTestChannels, radianceGroupCount);
+			lightSampleResult.radiance[depth % radianceGroupCount] = Spectrum(1.f);
+		}
+
+		sampleResultCopy = eyeSampleResult;
+		sampleResultCopy = lightSampleResults[0];
+	}
+
+	countAllocations = false;
+	*allocations = allocationsCount;
+}
+
+static void TestSampleResults() {
+	for (u_int radianceGroupCount = 1; radianceGroupCount <= SPECTRUMGROUP_INLINE_SIZE; ++radianceGroupCount) {
+		// Only the allocations of the other threads are counted
+		unsigned long long allocations;
+		boost::thread renderThread(&RenderSampleResults, radianceGroupCount, &allocations);
+		renderThread.join();
+
+		cout << "Sample results heap allocations with " << radianceGroupCount <<
+				" radiance groups: " << allocations << endl;
+
+		if (allocations > 0)
+			throw runtime_error("The sample results are allocating heap memory: " +
+					ToString(allocations) + " allocations with " +
+					ToString(radianceGroupCount) + " radiance groups");
+	}
+}
+
+//------------------------------------------------------------------------------
+// Render loop test
+//------------------------------------------------------------------------------
+
+static void BuildScene(Scene *scene) {
+	scene->Parse(
+			Property("scene.camera.lookat.orig")(1.f , 6.f , 3.f) <<
+			Property("scene.camera.lookat.target")(0.f , 0.f , .5f) <<
+			Property("scene.camera.fieldofview")(60.f));
+
+	scene->Parse(
+			Property("scene.materials.whitelight.type")("matte") <<
+			Property("scene.materials.whitelight.emission")(100.f, 100.f, 100.f) <<
+			Property("scene.materials.whitelight.emission.id")(1) <<
+			Property("scene.materials.mat_white.type")("matte") <<
+			Property("scene.materials.mat_white.kd")(.7f, .7f, .7f) <<
+			Property("scene.materials.mat_red.type")("glossy2") <<
+			Property("scene.materials.mat_red.kd")(.75f, 0.f, 0.f));
+
+	// A ground, a tilted quad and an emitting quad
+	Properties props;
+	props.SetFromString(
+		"scene.shapes.ground.type = inlinedmesh\n"
+		"scene.shapes.ground.vertices = -3 -3 0 3 -3 0 3 3 0 -3 3 0\n"
+		"scene.shapes.ground.faces = 0 1 2 2 3 0\n"
+		"scene.shapes.wall.type = inlinedmesh\n"
+		"scene.shapes.wall.vertices = -1 -1 0 1 -1 0 1 -.5 1.5 -1 -.5 1.5\n"
+		"scene.shapes.wall.faces = 0 1 2 2 3 0\n"
+		"scene.shapes.light.type = inlinedmesh\n"
+		"scene.shapes.light.vertices = -.5 -.5 2.5 -.5 .5 2.5 .5 .5 2.5 .5 -.5 2.5\n"
+		"scene.shapes.light.faces = 0 1 2 2 3 0\n"
+		"scene.objects.ground.shape = ground\n"
+		"scene.objects.ground.material = mat_white\n"
+		"scene.objects.wall.shape = wall\n"
+		"scene.objects.wall.material = mat_red\n"
+		"scene.objects.light.shape = light\n"
+		"scene.objects.light.material = whitelight\n"
+		);
+	scene->Parse(props);
+
+	scene->Parse(
+			Property("scene.lights.skyl.type")("sky2") <<
+			Property("scene.lights.skyl.dir")(0.166974f, 0.59908f, 0.783085f) <<
+			Property("scene.lights.skyl.gain")(0.8f, 0.8f, 0.8f) <<
+			Property("scene.lights.skyl.id")(0));
+}
+
+static double GetSampleCount(RenderSession *session) {
+	session->UpdateStats();
+
+	return session->GetStats().Get("stats.renderengine.total.samplecount").Get<double>();
+}
+
+int main(int argc, char *argv[]) {
+	try {
+		isMainThread = true;
+
+		const u_int renderTime = (argc > 1) ? atoi(argv[1]) : 3;
+
+		TestSampleResults();
+
+		luxcore::Init();
+
+		Scene *scene = Scene::Create();
+		BuildScene(scene);
+
+		// A single rendering thread, two light groups and some AOV. The
+		// hybrid back/forward option enables the light tracing part of the
+		// path tracer too.
+		RenderConfig *config = RenderConfig::Create(
+				Property("renderengine.type")("PATHCPU") <<
+				Property("sampler.type")("SOBOL") <<
+				Property("native.threads.count")(1) <<
+				Property("path.pathdepth.total")(6) <<
+				Property("path.hybridbackforward.enable")(true) <<
+				Property("film.width")(320) <<
+				Property("film.height")(240) <<
+				Property("film.outputs.0.type")("RGB_IMAGEPIPELINE") <<
+				Property("film.outputs.0.filename")("image.png") <<
+				Property("film.outputs.1.type")("RADIANCE_GROUP") <<
+				Property("film.outputs.1.id")(1) <<
+				Property("film.outputs.1.filename")("radiance_group1.exr") <<
+				Property("film.outputs.2.type")("DEPTH") <<
+				Property("film.outputs.2.filename")("depth.exr") <<
+				Property("film.outputs.3.type")("SHADING_NORMAL") <<
+				Property("film.outputs.3.filename")("normal.exr") <<
+				Property("film.outputs.4.type")("ALBEDO") <<
+				Property("film.outputs.4.filename")("albedo.exr") <<
+				Property("batch.halttime")(0),
+				scene);
+		RenderSession *session = RenderSession::Create(config);
+
+		session->Start();
+
+		// Warm up: the first passes allocate the per-thread data
+		boost::this_thread::sleep(boost::posix_time::millisec(2000));
+
+		const double startSampleCount = GetSampleCount(session);
+		countAllocations = true;
+
+		boost::this_thread::sleep(boost::posix_time::millisec(renderTime * 1000));
+
+		countAllocations = false;
+		const unsigned long long allocations = allocationsCount;
+		const double samples = GetSampleCount(session) - startSampleCount;
+
+		session->Stop();
+
+		delete session;
+		delete config;
+		delete scene;
+
+		cout << "Samples rendered: " << samples << endl;
+		cout << "Render thread heap allocations: " << allocations << endl;
+
+		if (samples <= 0.0)
+			throw runtime_error("No sample rendered during the test");
+
+		if (allocations > 0)
+			throw runtime_error("The render loop is allocating heap memory: " +
+					ToString(allocations) + " allocations");
+	} catch (runtime_error &err) {
+		cerr << "RUNTIME ERROR: " << err.what() << endl;
+		return EXIT_FAILURE;
+	} catch (exception &err) {
+		cerr << "ERROR: " << err.what() << endl;
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
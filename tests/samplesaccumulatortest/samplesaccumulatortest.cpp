@@ -0,0 +1,480 @@
+/***************************************************************************
+ * Copyright 1998-2020 by authors (see AUTHORS.txt)                        *
+ *                                                                         *
+ *   This file is part of LuxCoreRender.                                   *
+ *                                                                         *
+ * Licensed under the Apache License, Version 2.0 (the "License");         *
+ * you may not use this file except in compliance with the License.        *
+ * You may obtain a copy of the License at                                 *
+ *                                                                         *
+ *     http://www.apache.org/licenses/LICENSE-2.0                          *
+ *                                                                         *
+ * Unless required by applicable law or agreed to in writing, software     *
+ * distributed under the License is distributed on an "AS IS" BASIS,       *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.*
+ * See the License for the specific language governing permissions and     *
+ * limitations under the License.                                          *
+ ***************************************************************************/
+
+// This test checks the BCD samples accumulator and the tiled BCD denoiser:
+//
+// - the compact layout of the histograms doesn't lose the small contributions
+//   of a long accumulation. The same samples are added to a float and to a
+//   compact accumulator and the histograms are compared;
+// - the samples added by multiple threads with AddSampleAtomic(), through the
+//   per-thread staging buffers, produce the same statistics of the samples
+//   added directly with AddSample();
+// - the BCD denoiser applied to the tiles of BCDDenoiserPlugin::GetTiles()
+//   produces the same image of the one applied to the whole image;
+// - the tiled BCD_DENOISER plugin produces the same image of the untiled one.
+//
+// Usage: samplesaccumulatortest [samples per pixel]
+
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+#include <vector>
+#include <memory>
+
+#include <boost/thread.hpp>
+
+#include <bcd/core/Denoiser.h>
+#include <bcd/core/MultiscaleDenoiser.h>
+
+#include <luxcore/luxcore.h>
+
+#include "luxrays/core/randomgen.h"
+#include "luxrays/utils/utils.h"
+#include "luxrays/utils/strutils.h"
+#include "slg/film/denoiser/samplesaccumulator.h"
+#include "slg/film/imagepipeline/plugins/bcddenoiser.h"
+
+using namespace std;
+using namespace luxrays;
+using namespace luxcore;
+using namespace slg;
+
+//------------------------------------------------------------------------------
+// Compact histograms test
+//------------------------------------------------------------------------------
+
+// The accumulators are small so a lot of samples can be added to each pixel
+#define TEST_WIDTH 4
+#define TEST_HEIGHT 4
+
+// Bins smaller than this fraction of the channel total are not compared
+#define TEST_MIN_BIN_FRACTION .01f
+#define TEST_MAX_BIN_ERROR .05f
+#define TEST_MAX_TOTAL_ERROR .01f
+
+static void TestCompactHistograms(const u_int samplesPerPixel) {
+	const bcd::HistogramParameters histogramParameters;
+	SamplesAccumulator floatAccumulator(TEST_WIDTH, TEST_HEIGHT, histogramParameters, false);
+	SamplesAccumulator compactAccumulator(TEST_WIDTH, TEST_HEIGHT, histogramParameters, true);
+
+	// Each sample is added on its own, it is the worst case for the
+	// rounding of the compact bins
+	RandomGenerator rndGen(131);
+	for (u_int pass = 0; pass < samplesPerPixel; ++pass) {
+		for (int line = 0; line < TEST_HEIGHT; ++line) {
+			for (int column = 0; column < TEST_WIDTH; ++column) {
+				// An exponential distribution with a different mean for
+				// each pixel
+				const float mean = .1f + .2f * (line * TEST_WIDTH + column);
+				const float r = -logf(1.f - rndGen.floatValue()) * mean;
+				const float g = -logf(1.f - rndGen.floatValue()) * mean;
+				const float b = -logf(1.f - rndGen.floatValue()) * mean;
+
+				floatAccumulator.AddSample(line, column, r, g, b);
+				compactAccumulator.AddSample(line, column, r, g, b);
+			}
+		}
+	}
+
+	const bcd::SamplesStatisticsImages floatStats = floatAccumulator.GetSamplesStatistics();
+	const bcd::SamplesStatisticsImages compactStats = compactAccumulator.GetSamplesStatistics();
+
+	const int nbOfBins = histogramParameters.m_nbOfBins;
+	float maxBinError = 0.f;
+	float maxTotalError = 0.f;
+	for (int line = 0; line < TEST_HEIGHT; ++line) {
+		for (int column = 0; column < TEST_WIDTH; ++column) {
+			for (int channelIndex = 0; channelIndex < 3; ++channelIndex) {
+				float floatTotal = 0.f;
+				float compactTotal = 0.f;
+				for (int binIndex = 0; binIndex < nbOfBins; ++binIndex) {
+					floatTotal += floatStats.m_histoImage.get(line, column, channelIndex * nbOfBins + binIndex);
+					compactTotal += compactStats.m_histoImage.get(line, column, channelIndex * nbOfBins + binIndex);
+				}
+
+				if (floatTotal <= 0.f)
+					throw runtime_error("Empty float histogram at pixel " +
+							ToString(column) + "x" + ToString(line));
+				maxTotalError = Max(maxTotalError, fabsf(compactTotal - floatTotal) / floatTotal);
+
+				for (int binIndex = 0; binIndex < nbOfBins; ++binIndex) {
+					const float floatBin = floatStats.m_histoImage.get(line, column, channelIndex * nbOfBins + binIndex);
+					const float compactBin = compactStats.m_histoImage.get(line, column, channelIndex * nbOfBins + binIndex);
+
+					if (floatBin >= TEST_MIN_BIN_FRACTION * floatTotal)
+						maxBinError = Max(maxBinError, fabsf(compactBin - floatBin) / floatBin);
+				}
+			}
+		}
+	}
+
+	cout << "Samples per pixel: " << samplesPerPixel << endl;
+	cout << "Max. histogram total relative error: " << maxTotalError << endl;
+	cout << "Max. histogram bin relative error: " << maxBinError << endl;
+
+	if (maxTotalError > TEST_MAX_TOTAL_ERROR)
+		throw runtime_error("The compact histograms are losing samples: " +
+				ToString(maxTotalError) + " total relative error");
+	if (maxBinError > TEST_MAX_BIN_ERROR)
+		throw runtime_error("The compact histograms are too different from the float ones: " +
+				ToString(maxBinError) + " bin relative error");
+}
+
+//------------------------------------------------------------------------------
+// Staged samples test
+//------------------------------------------------------------------------------
+
+// The image has more pixels than a staging buffer can hold, so the buffers
+// are flushed while the threads are still adding samples
+#define STAGING_TEST_WIDTH 64
+#define STAGING_TEST_HEIGHT 48
+#define STAGING_TEST_THREADS 4
+#define STAGING_TEST_PASSES 16
+// Only the order of the float sums changes
+#define STAGING_TEST_MAX_ERROR 5e-4f
+
+static void AddTestSamples(SamplesAccumulator *accumulator, const u_int threadIndex,
+		const bool atomic) {
+	RandomGenerator rndGen(threadIndex + 1);
+	for (u_int pass = 0; pass < STAGING_TEST_PASSES; ++pass) {
+		for (int line = 0; line < STAGING_TEST_HEIGHT; ++line) {
+			for (int column = 0; column < STAGING_TEST_WIDTH; ++column) {
+				const float r = rndGen.floatValue() * 2.f;
+				const float g = rndGen.floatValue();
+				const float b = rndGen.floatValue() * .5f;
+				const float weight = .5f + rndGen.floatValue();
+
+				if (atomic)
+					accumulator->AddSampleAtomic(line, column, r, g, b, weight);
+				else
+					accumulator->AddSample(line, column, r, g, b, weight);
+			}
+		}
+	}
+}
+
+// Values smaller than minValue are compared with an absolute error
+static float CompareImages(const bcd::DeepImage<float> &a, const bcd::DeepImage<float> &b,
+		const float minValue = 1e-3f) {
+	float maxError = 0.f;
+	for (int line = 0; line < a.getHeight(); ++line) {
+		for (int column = 0; column < a.getWidth(); ++column) {
+			for (int i = 0; i < a.getDepth(); ++i) {
+				const float va = a.get(line, column, i);
+				const float vb = b.get(line, column, i);
+				maxError = Max(maxError, fabsf(va - vb) / Max(fabsf(va), minValue));
+			}
+		}
+	}
+
+	return maxError;
+}
+
+static void TestStagedSamples() {
+	const bcd::HistogramParameters histogramParameters;
+	SamplesAccumulator directAccumulator(STAGING_TEST_WIDTH, STAGING_TEST_HEIGHT, histogramParameters, false);
+	SamplesAccumulator stagedAccumulator(STAGING_TEST_WIDTH, STAGING_TEST_HEIGHT, histogramParameters, false);
+
+	for (u_int i = 0; i < STAGING_TEST_THREADS; ++i)
+		AddTestSamples(&directAccumulator, i, false);
+
+	vector<unique_ptr<boost::thread> > threads;
+	for (u_int i = 0; i < STAGING_TEST_THREADS; ++i)
+		threads.push_back(unique_ptr<boost::thread>(new boost::thread(&AddTestSamples,
+				&stagedAccumulator, i, true)));
+	for (auto &thread : threads)
+		thread->join();
+
+	// GetSamplesStatistics() flushes the samples still in the staging buffers
+	const bcd::SamplesStatisticsImages directStats = directAccumulator.GetSamplesStatistics();
+	const bcd::SamplesStatisticsImages stagedStats = stagedAccumulator.GetSamplesStatistics();
+
+	// The covariances are computed with a subtraction, the ones close to 0
+	// are compared with the scale of the color variances
+	const float maxError = Max(Max(
+			CompareImages(directStats.m_nbOfSamplesImage, stagedStats.m_nbOfSamplesImage),
+			CompareImages(directStats.m_meanImage, stagedStats.m_meanImage)), Max(
+			CompareImages(directStats.m_covarImage, stagedStats.m_covarImage, .01f),
+			CompareImages(directStats.m_histoImage, stagedStats.m_histoImage)));
+
+	cout << "Max. staged samples statistics relative error: " << maxError << endl;
+
+	if (maxError > STAGING_TEST_MAX_ERROR)
+		throw runtime_error("The staged samples statistics are different from the direct ones: " +
+				ToString(maxError) + " relative error");
+}
+
+//------------------------------------------------------------------------------
+// BCD tiles test
+//------------------------------------------------------------------------------
+
+// The image is not a multiple of the tile sizes, so there are partial tiles
+#define TILES_TEST_WIDTH 100
+#define TILES_TEST_HEIGHT 72
+#define TILES_TEST_SAMPLES 32
+#define TILES_TEST_MAX_ERROR 1e-6f
+
+static bcd::DeepImage<float> DenoiseRegion(const SamplesAccumulator &accumulator,
+		const int patchRadius, const int searchWindowRadius, const int scales,
+		const BCDDenoiserPlugin::Tile &tile) {
+	bcd::SamplesStatisticsImages stats = accumulator.GetSamplesStatistics(
+			tile.regionLine, tile.regionColumn, tile.regionWidth, tile.regionHeight);
+
+	bcd::DeepImage<float> inputColors(tile.regionWidth, tile.regionHeight, 3);
+	for (u_int line = 0; line < tile.regionHeight; ++line)
+		for (u_int column = 0; column < tile.regionWidth; ++column)
+			for (u_int i = 0; i < 3; ++i)
+				inputColors.set(line, column, i, stats.m_meanImage.get(line, column, i));
+
+	bcd::DenoiserInputs inputs;
+	inputs.m_pColors = &inputColors;
+	inputs.m_pNbOfSamples = &stats.m_nbOfSamplesImage;
+	inputs.m_pHistograms = &stats.m_histoImage;
+	inputs.m_pSampleCovariances = &stats.m_covarImage;
+
+	// The denoiser must be deterministic
+	bcd::DenoiserParameters params;
+	params.m_patchRadius = patchRadius;
+	params.m_searchWindowRadius = searchWindowRadius;
+	params.m_useRandomPixelOrder = false;
+	params.m_markedPixelsSkippingProbability = 0.f;
+	params.m_nbOfCores = 1;
+	params.m_useCuda = false;
+
+	bcd::DeepImage<float> outputColors(tile.regionWidth, tile.regionHeight, 3);
+	bcd::DenoiserOutputs outputs;
+	outputs.m_pDenoisedColors = &outputColors;
+
+	unique_ptr<bcd::IDenoiser> denoiser;
+	if (scales > 1)
+		denoiser.reset(new bcd::MultiscaleDenoiser(scales));
+	else
+		denoiser.reset(new bcd::Denoiser());
+	denoiser->setInputs(inputs);
+	denoiser->setOutputs(outputs);
+	denoiser->setParameters(params);
+	denoiser->denoise();
+
+	return outputColors;
+}
+
+static void TestBCDTiles(const u_int tileSize, const int patchRadius,
+		const int searchWindowRadius, const int scales) {
+	const bcd::HistogramParameters histogramParameters;
+	SamplesAccumulator accumulator(TILES_TEST_WIDTH, TILES_TEST_HEIGHT, histogramParameters, true);
+
+	// Noisy samples of a pattern with edges
+	RandomGenerator rndGen(7);
+	for (u_int pass = 0; pass < TILES_TEST_SAMPLES; ++pass) {
+		for (int line = 0; line < TILES_TEST_HEIGHT; ++line) {
+			for (int column = 0; column < TILES_TEST_WIDTH; ++column) {
+				const float value = (((column / 12 + line / 10) % 2) ? .8f : .2f) *
+						(.5f + .5f * sinf(column * .1f));
+
+				accumulator.AddSample(line, column,
+						-logf(1.f - rndGen.floatValue()) * value,
+						-logf(1.f - rndGen.floatValue()) * value * .5f,
+						-logf(1.f - rndGen.floatValue()) * value * .3f);
+			}
+		}
+	}
+
+	vector<BCDDenoiserPlugin::Tile> wholeImage;
+	BCDDenoiserPlugin::GetTiles(TILES_TEST_WIDTH, TILES_TEST_HEIGHT, 0,
+			patchRadius, searchWindowRadius, scales, wholeImage);
+	const bcd::DeepImage<float> image = DenoiseRegion(accumulator,
+			patchRadius, searchWindowRadius, scales, wholeImage[0]);
+
+	vector<BCDDenoiserPlugin::Tile> tiles;
+	BCDDenoiserPlugin::GetTiles(TILES_TEST_WIDTH, TILES_TEST_HEIGHT, tileSize,
+			patchRadius, searchWindowRadius, scales, tiles);
+
+	float maxError = 0.f;
+	for (auto const &tile : tiles) {
+		const bcd::DeepImage<float> tileImage = DenoiseRegion(accumulator,
+				patchRadius, searchWindowRadius, scales, tile);
+
+		for (u_int line = tile.tileLine; line < tile.tileLine + tile.tileHeight; ++line) {
+			for (u_int column = tile.tileColumn; column < tile.tileColumn + tile.tileWidth; ++column) {
+				for (u_int i = 0; i < 3; ++i) {
+					const float v = image.get(line, column, i);
+					const float tv = tileImage.get(line - tile.regionLine, column - tile.regionColumn, i);
+
+					maxError = Max(maxError, fabsf(tv - v) / Max(fabsf(v), 1e-3f));
+				}
+			}
+		}
+	}
+
+	cout << "BCD tiles (tile size " << tileSize << ", patch radius " << patchRadius <<
+			", search window radius " << searchWindowRadius << ", scales " << scales <<
+			", tiles " << tiles.size() << ") max. relative error: " << maxError << endl;
+
+	if (maxError > TILES_TEST_MAX_ERROR)
+		throw runtime_error("The BCD tiles are different from the whole image: " +
+				ToString(maxError) + " relative error");
+}
+
+//------------------------------------------------------------------------------
+// Tiled denoiser test
+//------------------------------------------------------------------------------
+
+// The film is not a multiple of the tile size, so there are partial tiles
+#define DENOISER_TEST_WIDTH 100
+#define DENOISER_TEST_HEIGHT 72
+#define DENOISER_TEST_TILESIZE 32
+#define DENOISER_TEST_MAX_MEAN_ERROR 1e-5f
+#define DENOISER_TEST_MAX_ERROR 1e-4f
+
+static void BuildScene(luxcore::Scene *scene) {
+	scene->Parse(
+			Property("scene.camera.lookat.orig")(1.f , 6.f , 3.f) <<
+			Property("scene.camera.lookat.target")(0.f , 0.f , .5f) <<
+			Property("scene.camera.fieldofview")(60.f));
+
+	scene->Parse(
+			Property("scene.materials.whitelight.type")("matte") <<
+			Property("scene.materials.whitelight.emission")(100.f, 100.f, 100.f) <<
+			Property("scene.materials.mat_white.type")("matte") <<
+			Property("scene.materials.mat_white.kd")(.7f, .7f, .7f) <<
+			Property("scene.materials.mat_red.type")("matte") <<
+			Property("scene.materials.mat_red.kd")(.75f, 0.f, 0.f));
+
+	// A ground, a tilted quad and an emitting quad
+	Properties props;
+	props.SetFromString(
+		"scene.shapes.ground.type = inlinedmesh\n"
+		"scene.shapes.ground.vertices = -3 -3 0 3 -3 0 3 3 0 -3 3 0\n"
+		"scene.shapes.ground.faces = 0 1 2 2 3 0\n"
+		"scene.shapes.wall.type = inlinedmesh\n"
+		"scene.shapes.wall.vertices = -1 -1 0 1 -1 0 1 -.5 1.5 -1 -.5 1.5\n"
+		"scene.shapes.wall.faces = 0 1 2 2 3 0\n"
+		"scene.shapes.light.type = inlinedmesh\n"
+		"scene.shapes.light.vertices = -.5 -.5 2.5 -.5 .5 2.5 .5 .5 2.5 .5 -.5 2.5\n"
+		"scene.shapes.light.faces = 0 1 2 2 3 0\n"
+		"scene.objects.ground.shape = ground\n"
+		"scene.objects.ground.material = mat_white\n"
+		"scene.objects.wall.shape = wall\n"
+		"scene.objects.wall.material = mat_red\n"
+		"scene.objects.light.shape = light\n"
+		"scene.objects.light.material = whitelight\n"
+		);
+	scene->Parse(props);
+}
+
+static Properties DenoiserPipelineProps(const u_int index, const u_int tileSize) {
+	// The denoiser must be deterministic: a single thread, no random pixel
+	// order and no pixel skipping
+	const string prefix = "film.imagepipelines." + ToString(index);
+
+	return Property(prefix + ".0.type")("BCD_DENOISER") <<
+			Property(prefix + ".0.threadcount")(1) <<
+			Property(prefix + ".0.userandompixelorder")(false) <<
+			Property(prefix + ".0.markedpixelsskippingprobability")(0.f) <<
+			Property(prefix + ".0.tilesize")(tileSize) <<
+			Property(prefix + ".1.type")("TONEMAP_LINEAR") <<
+			Property(prefix + ".1.scale")(1.f);
+}
+
+static void TestTiledDenoiser() {
+	luxcore::Scene *scene = luxcore::Scene::Create();
+	BuildScene(scene);
+
+	// Image pipeline #0 denoises the whole image at once and #1 by tiles
+	luxcore::RenderConfig *config = luxcore::RenderConfig::Create(
+			Property("renderengine.type")("PATHCPU") <<
+			Property("sampler.type")("SOBOL") <<
+			Property("film.width")(DENOISER_TEST_WIDTH) <<
+			Property("film.height")(DENOISER_TEST_HEIGHT) <<
+			DenoiserPipelineProps(0, 0) <<
+			DenoiserPipelineProps(1, DENOISER_TEST_TILESIZE) <<
+			Property("film.outputs.0.type")("RGB_IMAGEPIPELINE") <<
+			Property("film.outputs.0.index")(0) <<
+			Property("film.outputs.0.filename")("denoised.png") <<
+			Property("film.outputs.1.type")("RGB_IMAGEPIPELINE") <<
+			Property("film.outputs.1.index")(1) <<
+			Property("film.outputs.1.filename")("denoised_tiled.png") <<
+			Property("batch.haltspp")(32),
+			scene);
+	luxcore::RenderSession *session = luxcore::RenderSession::Create(config);
+
+	session->Start();
+	session->WaitForDone();
+	session->Stop();
+
+	luxcore::Film &film = session->GetFilm();
+	const size_t size = film.GetOutputSize(luxcore::Film::OUTPUT_RGB_IMAGEPIPELINE);
+	vector<float> image(size), tiledImage(size);
+	film.GetOutput(luxcore::Film::OUTPUT_RGB_IMAGEPIPELINE, &image[0], 0);
+	film.GetOutput(luxcore::Film::OUTPUT_RGB_IMAGEPIPELINE, &tiledImage[0], 1);
+
+	delete session;
+	delete config;
+	delete scene;
+
+	double errorSum = 0.0;
+	double valueSum = 0.0;
+	float maxError = 0.f;
+	for (size_t i = 0; i < size; ++i) {
+		const float error = fabsf(tiledImage[i] - image[i]);
+
+		errorSum += error;
+		valueSum += fabsf(image[i]);
+		maxError = Max(maxError, error / Max(fabsf(image[i]), 1e-3f));
+	}
+	if (valueSum <= 0.0)
+		throw runtime_error("The denoised image is black");
+	const float meanError = errorSum / valueSum;
+
+	cout << "Tiled denoiser mean relative error: " << meanError << endl;
+	cout << "Tiled denoiser max. relative error: " << maxError << endl;
+
+	if (meanError > DENOISER_TEST_MAX_MEAN_ERROR)
+		throw runtime_error("The tiled denoiser image is different from the untiled one: " +
+				ToString(meanError) + " mean relative error");
+	if (maxError > DENOISER_TEST_MAX_ERROR)
+		throw runtime_error("The tiled denoiser image has a pixel different from the untiled one: " +
+				ToString(maxError) + " relative error");
+}
+
+//------------------------------------------------------------------------------
+
+int main(int argc, char *argv[]) {
+	try {
+		const u_int samplesPerPixel = (argc > 1) ? atoi(argv[1]) : 300000;
+
+		luxcore::Init();
+
+		TestCompactHistograms(samplesPerPixel);
+		TestStagedSamples();
+		// The default BCD parameters and a tile size not aligned to the
+		// coarsest scale
+		for (int scales = 1; scales <= 4; ++scales)
+			TestBCDTiles(30, 1, 6, scales);
+		TestBCDTiles(20, 2, 4, 2);
+		TestTiledDenoiser();
+	} catch (runtime_error &err) {
+		cerr << "RUNTIME ERROR: " << err.what() << endl;
+		return EXIT_FAILURE;
+	} catch (exception &err) {
+		cerr << "ERROR: " << err.what() << endl;
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
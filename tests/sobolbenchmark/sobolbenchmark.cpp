@@ -0,0 +1,122 @@
+/***************************************************************************
+ * Copyright 1998-2020 by authors (see AUTHORS.txt)                        *
+ *                                                                         *
+ *   This file is part of LuxCoreRender.                                   *
+ *                                                                         *
+ * Licensed under the Apache License, Version 2.0 (the "License");         *
+ * you may not use this file except in compliance with the License.        *
+ * You may obtain a copy of the License at                                 *
+ *                                                                         *
+ *     http://www.apache.org/licenses/LICENSE-2.0                          *
+ *                                                                         *
+ * Unless required by applicable law or agreed to in writing, software     *
+ * distributed under the License is distributed on an "AS IS" BASIS,       *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.*
+ * See the License for the specific language governing permissions and     *
+ * limitations under the License.                                          *
+ ***************************************************************************/
+
+// This is a throughput benchmark of SLG internal Sobol sequence generator. The
+// code used here is not part of LuxCore API and should be ignored aside from
+// LuxCoreRender core developers.
+//
+// Usage: sobolbenchmark [dimensions] [indices count]
+
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+
+#include "luxrays/core/randomgen.h"
+#include "luxrays/utils/utils.h"
+#include "slg/samplers/sobolsequence.h"
+
+using namespace std;
+using namespace luxrays;
+using namespace slg;
+
+int main(int argc, char *argv[]) {
+	try {
+		const u_int dimensions = (argc > 1) ? atoi(argv[1]) : 64;
+		const u_int indicesCount = (argc > 2) ? atoi(argv[2]) : 1000000;
+
+		SobolSequence sobolSequence;
+		sobolSequence.RequestSamples(dimensions);
+
+		// The indices used by the samplers are pass + a random 32bit offset
+		TauswortheRandomGenerator rndGen(131u);
+		vector<u_int> indices(indicesCount);
+		for (u_int i = 0; i < indicesCount; ++i)
+			indices[i] = i + rndGen.uintValue();
+
+		// Check the results of the two implementations
+
+		vector<u_int> values(dimensions);
+		for (u_int i = 0; i < Min(indicesCount, 10000u); ++i) {
+			sobolSequence.GenerateSamples(indices[i], &values[0]);
+
+			for (u_int d = 0; d < dimensions; ++d) {
+				if (values[d] != sobolSequence.SobolDimension(indices[i], d))
+					throw runtime_error("Wrong value for index " + ToString(indices[i]) + " dimension " + ToString(d));
+			}
+		}
+
+		// Benchmark the one dimension at time implementation
+
+		u_int checksum = 0;
+		double startTime = WallClockTime();
+		for (u_int i = 0; i < indicesCount; ++i) {
+			for (u_int d = 0; d < dimensions; ++d)
+				checksum += sobolSequence.SobolDimension(indices[i], d);
+		}
+		const double dimensionTime = WallClockTime() - startTime;
+
+		// Benchmark the table driven batch implementation
+
+		startTime = WallClockTime();
+		for (u_int i = 0; i < indicesCount; ++i) {
+			sobolSequence.GenerateSamples(indices[i], &values[0]);
+
+			for (u_int d = 0; d < dimensions; ++d)
+				checksum += values[d];
+		}
+		const double batchTime = WallClockTime() - startTime;
+
+		// Benchmark the sampler interface with both scrambling methods
+
+		double sum = 0.0;
+		startTime = WallClockTime();
+		for (u_int i = 0; i < indicesCount; ++i) {
+			sobolSequence.rngPass = indices[i] - i;
+			for (u_int d = 0; d < dimensions; ++d)
+				sum += sobolSequence.GetSample(i, d);
+		}
+		const double cpTime = WallClockTime() - startTime;
+
+		sobolSequence.owenScrambling = true;
+		startTime = WallClockTime();
+		for (u_int i = 0; i < indicesCount; ++i) {
+			sobolSequence.rngPass = indices[i] - i;
+			for (u_int d = 0; d < dimensions; ++d)
+				sum += sobolSequence.GetSample(i, d);
+		}
+		const double owenTime = WallClockTime() - startTime;
+
+		const double samplesCount = indicesCount * (double)dimensions;
+		cout << "Dimensions: " << dimensions << endl;
+		cout << "Indices: " << indicesCount << endl;
+		cout << "One dimension at time: " << (samplesCount / dimensionTime) / 1000000.0 << " Msamples/sec" << endl;
+		cout << "Table driven batch: " << (samplesCount / batchTime) / 1000000.0 << " Msamples/sec" << endl;
+		cout << "GetSample() with Cranley-Patterson rotation: " << (samplesCount / cpTime) / 1000000.0 << " Msamples/sec" << endl;
+		cout << "GetSample() with Owen scrambling: " << (samplesCount / owenTime) / 1000000.0 << " Msamples/sec" << endl;
+		// Printed only to avoid the compiler optimizing out the loops
+		cout << "Checksum: " << checksum << " " << sum << endl;
+	} catch (runtime_error &err) {
+		cerr << "RUNTIME ERROR: " << err.what() << endl;
+		return EXIT_FAILURE;
+	} catch (exception &err) {
+		cerr << "ERROR: " << err.what() << endl;
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}